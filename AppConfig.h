@@ -1,4 +1,4 @@
 #pragma once
 inline constexpr bool kFreeVersion    = false;
-inline constexpr int  kMaxChannels    = kFreeVersion ? 2 : 6;
+inline constexpr int  kMaxChannels    = kFreeVersion ? 2 : 16;   // strips shown at most (engine: MAX_CHANNELS)
 inline constexpr int  kMaxMuteGroups  = kFreeVersion ? 1 : 4;
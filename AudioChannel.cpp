@@ -1,8 +1,8 @@
 #include "AudioChannel.h"
 
 //==============================================================================
-AudioChannel::AudioChannel(int index)
-    : Channel(index, ChannelType::Audio)
+AudioChannel::AudioChannel(int index, ChannelHotState& hot, int slot)
+    : Channel(index, ChannelType::Audio, hot, slot)
 {
 }
 
@@ -12,13 +12,15 @@ AudioChannel::AudioChannel(int index)
 
 void AudioChannel::processBlock(const float* const* inputChannelData,
                                 float* const* outputChannelData,
-                                const juce::MidiBuffer& midiBuffer,
+                                juce::MidiBuffer& midiBuffer,
                                 int numSamples,
                                 juce::int64 playheadPosition,
                                 juce::int64 loopLength,
                                 int numInputChannels,
                                 int numOutputChannels)
 {
+    beginGainBlock(numSamples);
+
     // Oneshot channels use entirely independent processing
     if (oneShot.load(std::memory_order_relaxed))
     {
@@ -28,6 +30,7 @@ void AudioChannel::processBlock(const float* const* inputChannelData,
     }
 
     checkAndExecutePendingStop(playheadPosition, loopLength, numSamples);
+    applyPendingConsolidation(playheadPosition, loopLength, numSamples);
     checkOneShotStop(playheadPosition, loopLength, numSamples);
 
     // Clear working and output-mix buffers
@@ -42,74 +45,97 @@ void AudioChannel::processBlock(const float* const* inputChannelData,
     //==========================================================================
     // 1. ROUTE INPUT FROM HARDWARE (dry signal → workingBuffer)
     //==========================================================================
-    routeInput(inputChannelData, numInputChannels, numSamples);
-
-    // Compute input peaks
     {
-        auto rangeL = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(0), numSamples);
-        auto rangeR = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(1), numSamples);
-        inputPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-        inputPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelInput));
+        routeInput(inputChannelData, numInputChannels, numSamples);
     }
 
+    // Compute input levels
+    meterInput(numSamples);
+
     //==========================================================================
     // 2. RECORD DRY SIGNAL (before FX — loop always stores clean audio)
     //==========================================================================
     if (currentState == ChannelState::Recording)
-        recordToLoop(workingBuffer, playheadPosition, numSamples, false);
+    {
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelRecord));
+        recordToLoop(workingBuffer, recordPosition(playheadPosition, loopLength), numSamples, false, loopLength);
+    }
     else if (currentState == ChannelState::Overdubbing && loopLength > 0)
-        recordToLoop(workingBuffer, playheadPosition, numSamples, true);
+    {
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelRecord));
+        recordToLoop(workingBuffer, recordPosition(playheadPosition, loopLength), numSamples, true, loopLength);
+    }
 
     //==========================================================================
     // 3. BUILD OUTPUT MIX IN fxBuffer
     //    Monitoring: add dry input; Playback: add loop signal with gain.
     //    Both paths are combined before FX so the chain runs exactly once.
     //==========================================================================
+    float mixPeak = 0.0f;
     if (shouldMonitor())
     {
         for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
             fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
+        mixPeak = juce::jmax(inputPeakL.load(std::memory_order_relaxed),
+                             inputPeakR.load(std::memory_order_relaxed));
     }
 
     if ((currentState == ChannelState::Playing ||
          currentState == ChannelState::Overdubbing) &&
         loopLength > 0)
     {
-        // Reuse workingBuffer as a temporary read target for the loop
-        workingBuffer.clear(0, numSamples);
-        playFromLoop(workingBuffer, playheadPosition, numSamples);
-        applyGain(workingBuffer, numSamples);
-
-        // Compute loop peaks
-        {
-            auto rangeL = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(0), numSamples);
-            auto rangeR = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(1), numSamples);
-            loopPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-            loopPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
-        }
+        // Reuse workingBuffer as the loop read target — layers, gain and peaks in one pass
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelPlayback));
+        float peakL = 0.0f, peakR = 0.0f;
+        playFromLoopSmoothed(workingBuffer, playheadPosition, numSamples, peakL, peakR);
+        meterLoop(workingBuffer, numSamples, peakL, peakR);
+        mixPeak = juce::jmax(mixPeak, peakL, peakR);
 
         for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
             fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
     }
     else
     {
-        loopPeakL.store(0.0f, std::memory_order_relaxed);
-        loopPeakR.store(0.0f, std::memory_order_relaxed);
+        meterLoopSilent();
     }
+    publishMeters(playheadPosition, numSamples);
 
     //==========================================================================
     // 4. PROCESS FX CHAIN (applied once to combined output signal)
+    //    A channel that has been silent past the chain's tail skips it and
+    //    the output routing — its output would be silence.
     //==========================================================================
-    juce::MidiBuffer emptyMidi;
-    processFXChain(fxBuffer, numSamples, emptyMidi);
+    tapStem(false, numSamples);
+    if (isFxChainIdle(mixPeak, currentState))
+        return;
+
+    fxMidiBuffer.clear();
+    processFXChain(fxBuffer, numSamples, fxMidiBuffer);
+    compensateLatency(numSamples);
+    trackFxOutput(numSamples);
+    tapStem(true, numSamples);
 
     //==========================================================================
     // 5. ROUTE TO OUTPUT
     //==========================================================================
-    if (!isMutedNow)
+    if (applyMuteFade(fxBuffer, numSamples, isMutedNow))
         routeOutput(outputChannelData, fxBuffer, numOutputChannels, numSamples);
 }
 
+void AudioChannel::recordPreRoll(const float* const* inputChannelData, int numInputChannels,
+                                 int numSamples, juce::int64 loopPos)
+{
+    if (state.load(std::memory_order_relaxed) != ChannelState::Recording
+        || numSamples > workingBuffer.getNumSamples())
+        return;
+
+    // Dry, like step 2 of processBlock(); the next block overwrites workingBuffer anyway
+    workingBuffer.clear(0, numSamples);
+    routeInput(inputChannelData, numInputChannels, numSamples);
+    recordToLoop(workingBuffer, loopPos, numSamples, false);
+}
+
 //==============================================================================
 // Private Processing Stages
 //==============================================================================
@@ -213,23 +239,6 @@ void AudioChannel::routeOutput(float* const* outputChannelData,
     }
 }
 
-void AudioChannel::applyGain(juce::AudioBuffer<float>& buffer, int numSamples)
-{
-    const float gain = gainLinear.load(std::memory_order_relaxed);
-
-    if (gain == 0.0f)
-    {
-        buffer.clear(0, numSamples);
-        return;
-    }
-
-    if (gain == 1.0f)
-        return;  // Unity gain, no processing needed
-
-    // Apply gain to both channels
-    buffer.applyGain(0, numSamples, gain);
-}
-
 //==============================================================================
 void AudioChannel::processOneShotBlock(const float* const* inputChannelData,
                                        float* const* outputChannelData,
@@ -250,78 +259,61 @@ void AudioChannel::processOneShotBlock(const float* const* inputChannelData,
     // 1. Route input
     routeInput(inputChannelData, numInputChannels, numSamples);
 
-    // Input peaks
-    {
-        auto rangeL = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(0), numSamples);
-        auto rangeR = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(1), numSamples);
-        inputPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-        inputPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
-    }
+    // Input levels
+    meterInput(numSamples);
 
     // 2. Record using oneshot's own playhead
     if (currentState == ChannelState::Recording)
     {
         const juce::int64 pos = oneShotPlayhead.load(std::memory_order_relaxed);
         recordToLoop(workingBuffer, pos, numSamples, false);
+        oneShotVoices.noteRecordedPeak(pos, numSamples,
+                                       juce::jmax(inputPeakL.load(std::memory_order_relaxed),
+                                                  inputPeakR.load(std::memory_order_relaxed)));
         oneShotPlayhead.store(pos + numSamples, std::memory_order_release);
     }
 
     // 3. Monitor
+    float mixPeak = 0.0f;
     if (shouldMonitor())
     {
         for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
             fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
+        mixPeak = juce::jmax(inputPeakL.load(std::memory_order_relaxed),
+                             inputPeakR.load(std::memory_order_relaxed));
     }
 
-    // 4. Playback: sum all active voices
+    // 4. Playback: all voices gathered in one pass into workingBuffer
+    //    (the dry input is already in fxBuffer or not wanted)
     {
-        bool anyVoiceActive = false;
-        const juce::int64 len = oneShotLength.load(std::memory_order_relaxed);
-
-        if (len > 0)
+        float peakL = 0.0f, peakR = 0.0f;
+        if (playOneShotVoices(workingBuffer, numSamples, peakL, peakR))
         {
-            for (auto& voice : oneShotVoices)
-            {
-                juce::int64 pos = voice.load(std::memory_order_relaxed);
-                if (pos < 0 || pos >= len) continue;
-
-                anyVoiceActive = true;
-                workingBuffer.clear(0, numSamples);
-
-                // Read from loop at voice position (no wrap — oneshot doesn't loop)
-                const int samplesToRead = static_cast<int>(
-                    juce::jmin(static_cast<juce::int64>(numSamples), len - pos));
-                if (samplesToRead > 0)
-                    playFromLoop(workingBuffer, pos, samplesToRead);
-
-                applyGain(workingBuffer, numSamples);
-
-                for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
-                    fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
+            meterLoop(workingBuffer, numSamples, peakL, peakR);
+            mixPeak = juce::jmax(mixPeak, peakL, peakR);
 
-                voice.store(pos + numSamples, std::memory_order_release);
-            }
-        }
-
-        if (anyVoiceActive)
-        {
-            auto rangeL = juce::FloatVectorOperations::findMinAndMax(fxBuffer.getReadPointer(0), numSamples);
-            auto rangeR = juce::FloatVectorOperations::findMinAndMax(fxBuffer.getReadPointer(1), numSamples);
-            loopPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-            loopPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
+            for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
+                fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
         }
         else
         {
-            loopPeakL.store(0.0f, std::memory_order_relaxed);
-            loopPeakR.store(0.0f, std::memory_order_relaxed);
+            meterLoopSilent();
         }
     }
+    publishMeters(oneShotPlayhead.load(std::memory_order_relaxed), numSamples);
+
+    // 5. FX chain (skipped with the output routing while the channel is idle)
+    tapStem(false, numSamples);
+    if (isFxChainIdle(mixPeak, currentState))
+        return;
 
-    // 5. FX chain
-    juce::MidiBuffer emptyMidi;
-    processFXChain(fxBuffer, numSamples, emptyMidi);
+    fxMidiBuffer.clear();
+    processFXChain(fxBuffer, numSamples, fxMidiBuffer);
+    compensateLatency(numSamples);
+    trackFxOutput(numSamples);
+    tapStem(true, numSamples);
 
     // 6. Route to output
-    if (!isMutedNow)
+    if (applyMuteFade(fxBuffer, numSamples, isMutedNow))
         routeOutput(outputChannelData, fxBuffer, numOutputChannels, numSamples);
 }
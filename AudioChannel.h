@@ -30,8 +30,9 @@ public:
     /**
      * @brief Construct audio channel
      * @param channelIndex Channel number (0-5)
+     * @param hotSlot Slot of hotState this channel binds
      */
-    explicit AudioChannel(int channelIndex);
+    AudioChannel(int channelIndex, ChannelHotState& hotState, int hotSlot);
     
     ~AudioChannel() override = default;
     
@@ -53,12 +54,16 @@ public:
      */
     void processBlock(const float* const* inputChannelData,
                      float* const* outputChannelData,
-                     const juce::MidiBuffer& midiBuffer,
+                     juce::MidiBuffer& midiBuffer,
                      int numSamples,
                      juce::int64 playheadPosition,
                      juce::int64 loopLength,
                      int numInputChannels,
                      int numOutputChannels) override;
+
+    /** Route pre-roll input into the loop at loopPos (see Channel::recordPreRoll()). */
+    void recordPreRoll(const float* const* inputChannelData, int numInputChannels,
+                       int numSamples, juce::int64 loopPos) override;
     
 private:
     //==============================================================================
@@ -81,11 +86,6 @@ private:
                     int numOutputChannels,
                     int numSamples);
     
-    /**
-     * @brief Apply channel gain to buffer
-     */
-    void applyGain(juce::AudioBuffer<float>& buffer, int numSamples);
-
     /**
      * @brief Oneshot-specific processing: independent playhead, multi-voice overlap
      */
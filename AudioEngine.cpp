@@ -1,7 +1,36 @@
 #include "AudioEngine.h"
 #include "AudioChannel.h"
+#include "DenormalPolicy.h"
 #include "VSTiChannel.h"
 #include "PluginHostWrapper.h"
+#include <limits>
+
+namespace
+{
+    constexpr juce::int64 kNoMainButtonPress = std::numeric_limits<juce::int64>::min() / 2;
+
+    /** "2-5,7" -> bits 2..5 and 7; false if a part is not a core of this machine. */
+    bool parseCoreList(const juce::String& text, juce::uint32& mask)
+    {
+        const int numCores = juce::jmin(32, juce::SystemStats::getNumCpus());
+        mask = 0;
+        for (auto part : juce::StringArray::fromTokens(text.trim(), ",", {}))
+        {
+            part = part.trim();
+            const auto first = part.upToFirstOccurrenceOf("-", false, false).trim();
+            const auto last  = part.contains("-") ? part.fromFirstOccurrenceOf("-", false, false).trim() : first;
+            if (first.isEmpty() || last.isEmpty()
+                || !first.containsOnly("0123456789") || !last.containsOnly("0123456789"))
+                return false;
+
+            const int from = first.getIntValue(), to = last.getIntValue();
+            if (from > to || to >= numCores) return false;
+            for (int c = from; c <= to; ++c)
+                mask |= 1u << c;
+        }
+        return true;
+    }
+}
 
 //==============================================================================
 // Constructor / Destructor
@@ -13,18 +42,24 @@ AudioEngine::AudioEngine()
     loopEngine       = std::make_unique<LoopEngine>();
     metronome        = std::make_unique<Metronome>();
     pluginHost       = std::make_unique<PluginHostWrapper>();
+    pluginPool       = std::make_unique<PluginInstancePool>();
     midiLearnManager = std::make_unique<MidiLearnManager>(*this);
 
     for (int i = 0; i < NUM_SECTIONS; ++i)
         sectionLoopLengths[i].store(0, std::memory_order_relaxed);
 
-    for (int i = 0; i < 6; ++i)
-    {
-        channels[i]     = std::make_unique<AudioChannel>(i);
+    lastMidiMainButtonSample.fill(kNoMainButtonPress);
+    timedCommands.reserve(static_cast<size_t>(kMaxTimedCommands));
+
+    for (int i = 0; i < MAX_CHANNELS; ++i)
         channelNames[i] = "CH " + juce::String(i + 1);
-    }
+    for (int i = 0; i < channelCount; ++i)
+        installChannel(i, createChannel(i, ChannelType::Audio, hotState.slotOf(i)));
 
     deviceManager.addAudioCallback(this);
+
+    backgroundThread.addTimeSliceClient(this);
+    backgroundThread.startThread(juce::Thread::Priority::low);
 }
 
 AudioEngine::~AudioEngine()
@@ -36,8 +71,24 @@ AudioEngine::~AudioEngine()
     for (const auto& device : midiInputs)
         deviceManager.setMidiInputDeviceEnabled(device.identifier, false);
 
+    backgroundThread.removeTimeSliceClient(this);
+    backgroundThread.stopThread(2000);
+
     deviceManager.removeAudioCallback(this);
     deviceManager.closeAudioDevice();
+
+    // No audio thread any more: old channels and plugins can go now
+    reclaimer.reclaimAll();
+
+    cancelPendingUpdate();
+    for (auto& owner : channelOwners)
+        if (owner)
+            for (int slot = 0; slot < 3; ++slot)
+                if (auto* plugin = owner->getPlugin(slot))
+                    plugin->removeListener(this);
+
+    delete pendingStandbySong.exchange(nullptr);
+    delete retiredStandbySong.exchange(nullptr);
 }
 
 //==============================================================================
@@ -58,6 +109,28 @@ void AudioEngine::openMidiInputs()
     DBG("MIDI: " + juce::String(midiInputs.size()) + " device(s) found");
 }
 
+juce::Result AudioEngine::setMidiClockOutput(const juce::String& deviceIdentifier)
+{
+    if (deviceIdentifier == midiClock.getDeviceIdentifier())
+        return juce::Result::ok();
+
+    if (deviceIdentifier.isEmpty())
+    {
+        midiClock.setOutput(nullptr);
+        return juce::Result::ok();
+    }
+
+    auto output = juce::MidiOutput::openDevice(deviceIdentifier);
+    if (output == nullptr)
+    {
+        midiClock.setOutput(nullptr);
+        return juce::Result::fail("Cannot open MIDI output for clock: " + deviceIdentifier);
+    }
+
+    midiClock.setOutput(std::move(output));
+    return juce::Result::ok();
+}
+
 void AudioEngine::handleIncomingMidiMessage(juce::MidiInput* /*source*/,
                                              const juce::MidiMessage& message)
 {
@@ -119,7 +192,7 @@ juce::String AudioEngine::initialiseAudio(int inputChannels,
     if (error.isEmpty())
     {
         isInitialised.store(true, std::memory_order_release);
-        openMidiInputs();
+        // MIDI inputs are opened separately (openMidiInputs()), a startup task of their own
         // Note: currentSampleRate/currentBufferSize are populated in
         // audioDeviceAboutToStart(), which is where the device-ready log is printed.
     }
@@ -131,6 +204,18 @@ juce::String AudioEngine::initialiseAudio(int inputChannels,
     return error;
 }
 
+void AudioEngine::beginOfflineRendering(juce::AudioIODevice& device)
+{
+    audioDeviceAboutToStart(&device);
+    isInitialised.store(true, std::memory_order_release);
+}
+
+void AudioEngine::endOfflineRendering()
+{
+    isInitialised.store(false, std::memory_order_release);
+    audioDeviceStopped();
+}
+
 juce::File AudioEngine::getAudioSettingsFile() const
 {
     return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
@@ -166,25 +251,87 @@ void AudioEngine::audioDeviceAboutToStart(juce::AudioIODevice* device)
 
     // Loop engine
     loopEngine->setSampleRate(currentSampleRate);
+    profiler.prepare(currentSampleRate);
+
+    // The device counts its own xruns from when it opened; keep the earlier ones
+    earlierDeviceXruns += deviceXruns;
+    deviceXruns = 0;
+    xrunDevice  = device;
 
     // Metronome — prepare (do NOT re-create here, that would reset config)
     metronome->setBPM(loopEngine->getBPM());
-    metronome->prepareToPlay(currentSampleRate);
+    metronome->prepareToPlay(currentSampleRate, currentBufferSize * 2);
 
     // MIDI collector — must be reset when sample rate changes
     midiCollector.reset(currentSampleRate);
 
+    // Held commands and the clock anchor belong to the previous run of the device
+    timedCommands.clear();
+    writeClockAnchor(0, 0.0);
+
+    // Transport MIDI controls are dispatched from the callback from now on
+    lastMidiMainButtonSample.fill(kNoMainButtonPress);
+    if (midiLearnManager)
+        midiLearnManager->setRealtimeDispatchActive(true);
+
     // Working buffers
     inputBuffer .setSize(numInputChannels,  currentBufferSize * 2);
     outputBuffer.setSize(numOutputChannels, currentBufferSize * 2);
 
+    // Master gain ramps (20 ms), starting at the current value
+    masterGainSmoother.prepare(currentSampleRate, currentBufferSize * 2, 0.020, SmoothedGain::Curve::Exponential);
+    masterGainSmoother.reset(masterGain.load(std::memory_order_relaxed));
+
+    // Sub-block channel pointers and MIDI slice (no allocation in the callback)
+    subBlockInputs .assign(static_cast<size_t>(juce::jmax(1, numInputChannels)),  nullptr);
+    preRollInputs  .assign(static_cast<size_t>(juce::jmax(1, numInputChannels)),  nullptr);
+
+    // Auto-start pre-roll: kAutoStartPreRollMs plus one block, mirrored (see pushPreRoll())
+    preRollLength   = juce::roundToInt(currentSampleRate * kAutoStartPreRollMs / 1000.0);
+    preRollCapacity = preRollLength + currentBufferSize * 2;
+    preRollRing.setSize(juce::jmax(1, numInputChannels), 2 * preRollCapacity);
+    preRollRing.clear();
+    preRollWrite  = 0;
+    preRollFilled = 0;
+    subBlockOutputs.assign(static_cast<size_t>(juce::jmax(1, numOutputChannels)), nullptr);
+    for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
+    {
+        channelMidi[i] .ensureSize(static_cast<size_t>(kChannelMidiBytes));
+        subBlockMidi[i].ensureSize(static_cast<size_t>(kChannelMidiBytes));
+    }
+    blockMidi.ensureSize(static_cast<size_t>(kChannelMidiBytes));
+    parkedMidi.ensureSize(static_cast<size_t>(kChannelMidiBytes));
+
     // Master recording buffer (stereo)
     masterRecordBuffer.setSize(2, currentBufferSize * 2);
 
-    // Prepare channels (max loop = 10 min)
+    // Per-channel render blocks for the parallel path (channels that exist only)
+    for (size_t i = 0; i < channelRenderBuffers.size(); ++i)
+        channelRenderBuffers[i].setSize(i < static_cast<size_t>(channelCount) ? juce::jmax(1, numOutputChannels) : 0,
+                                        i < static_cast<size_t>(channelCount) ? currentBufferSize * 2 : 0);
+
+    // Loop page pool: keep ~2 s of pages per channel ready for the audio thread.
+    // Unused pages from a previous device/session are returned to the OS first.
+    loopPagePool.trim();
+    loopPagePool.prepare(channelCount
+                         * static_cast<int>(std::ceil(2.0 * currentSampleRate / LoopPagePool::kPageFrames)));
+
+    // Prepare channels (max loop = 10 min). Only the page tables are sized here;
+    // audio memory is mapped page by page while recording.
     const juce::int64 maxLoopSamples = static_cast<juce::int64>(600.0 * currentSampleRate);
-    for (auto& ch : channels)
-        if (ch) ch->prepareToPlay(currentSampleRate, currentBufferSize, maxLoopSamples);
+    {
+        const juce::ScopedLock sl(channelSwapLock);
+        for (auto& published : channels)
+            if (auto* ch = published.get()) ch->prepareToPlay(currentSampleRate, currentBufferSize, maxLoopSamples);
+    }
+
+    // Sections B/C are one button press away — size them before they are needed
+    requestSectionAllocation();
+
+    // Recordings line up with what the player heard: input + output latency
+    deviceInputLatency  = device->getInputLatencyInSamples();
+    deviceOutputLatency = device->getOutputLatencyInSamples();
+    updateRecordLatency();
 
     DBG("Audio device ready: " +
         juce::String(currentSampleRate) + " Hz, " +
@@ -197,9 +344,14 @@ void AudioEngine::audioDeviceStopped()
     if (masterRecordingActive.load(std::memory_order_relaxed))
         stopMasterRecording();
 
+    // No callback any more — the timer takes over all MIDI mappings
+    if (midiLearnManager)
+        midiLearnManager->setRealtimeDispatchActive(false);
+
     isPlayingFlag.store(false, std::memory_order_release);
-    for (auto& ch : channels)
-        if (ch) ch->releaseResources();
+    xrunDevice = nullptr;
+    for (auto& published : channels)
+        if (auto* ch = published.get()) ch->releaseResources();
     inputBuffer .clear();
     outputBuffer.clear();
     DBG("Audio device stopped");
@@ -212,25 +364,239 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
     int numOutputChannels,
     int numSamples,
     const juce::AudioIODeviceCallbackContext& /*context*/)
+{
+    // Diagnostic builds: allocations, locks and blocking calls from here on are logged
+    const RealtimeSafety::Scope realtime;
+
+    // An offline bounce owns the engine: the device only gets silence.
+    // Checked before the block epoch — the bounce thread brackets its own blocks.
+    if (bounceActive.load(std::memory_order_acquire))
+    {
+        clearOutputBuffer(outputChannelData, numOutputChannels, numSamples);
+
+        // The collector stays this thread's: live MIDI keeps being taken and dropped,
+        // so nothing stale is waiting when the bounce hands back
+        {
+            const RealtimeSafety::ScopedAllow collectorLock;
+            midiCollector.removeNextBlockOfMessages(parkedMidi, numSamples);
+        }
+        parkedMidi.clear();
+
+        bounceDeviceParked.store(true, std::memory_order_release);
+        return;
+    }
+
+    processDeviceBlock(inputChannelData, numInputChannels,
+                       outputChannelData, numOutputChannels, numSamples);
+}
+
+void AudioEngine::processDeviceBlock(const float* const* inputChannelData, int numInputChannels,
+                                     float* const* outputChannelData, int numOutputChannels,
+                                     int numSamples)
 {
     //==========================================================================
     // REAL-TIME AUDIO THREAD — NO ALLOCATIONS, NO LOCKS, NO BLOCKING
     //==========================================================================
 
+    // Everything this block can see stays alive until it returns
+    const EpochReclaimer::BlockScope blockEpoch(reclaimer);
+    const DenormalPolicy::Scope      noDenormals;
+
     if (numSamples <= 0 || !isInitialised.load(std::memory_order_relaxed))
     {
         clearOutputBuffer(outputChannelData, numOutputChannels, numSamples);
         return;
     }
 
+    // The live callback never gets here during a bounce: this is a bounce block
+    const bool offline = bounceActive.load(std::memory_order_relaxed);
+
+    profiler.beginBlock(numSamples);
+    auto stageTicks = juce::Time::getHighResolutionTicks();
+
+    // Wall-clock anchor for the MIDI clock ticks of this block
+    midiClock.beginBlock(currentSampleRate, numSamples);
+
     //--- 1. PROCESS COMMANDS ---------------------------------------------------
-    commandQueue.processCommands([this](const Command& cmd) {
-        processCommand(cmd);
-    });
+    // Untimed commands (and timed ones already due) apply at the block start;
+    // later ones wait in timedCommands for their sub-block.
+    const juce::int64 blockStart = totalSamplesProcessed.load(std::memory_order_relaxed);
+    if (!offline)
+        writeClockAnchor(blockStart, juce::Time::getMillisecondCounterHiRes());
+    // A bounce block leaves them queued: what the user does meanwhile applies
+    // to the live engine once the bounce has handed back, not to the file
+    if (!offline)
+        commandQueue.processCommands([this, blockStart](const Command& cmd) {
+            if (cmd.sampleTime <= blockStart || !holdTimedCommand(cmd))
+                processCommand(cmd);
+        });
+    stageTicks = profiler.lap(RealtimeProfiler::Commands, stageTicks);
+
+    //--- 1b. COLLECT MIDI ------------------------------------------------------
+    // Thread-safe: MIDI thread writes via addMessageToQueue(), audio thread
+    // reads here. Mapped transport controls (main button, play/stop, sections)
+    // are dispatched at their sample below; the buffer also goes to the VSTi
+    // channels, demultiplexed once per block.  In learn mode the message
+    // thread sees everything first.
+    juce::MidiBuffer& midiBuffer = blockMidi;
+    midiBuffer.clear();
+    if (!offline)   // a bounce renders the loops only; the parked callback drops live MIDI
+    {
+        // JUCE's collector locks briefly against the MIDI thread — known, accepted
+        const RealtimeSafety::ScopedAllow collectorLock;
+        midiCollector.removeNextBlockOfMessages(midiBuffer, numSamples);
+    }
+    demultiplexMidi(midiBuffer);
+
+    const RealtimeMidiTable* midiTable =
+        (midiLearnManager && !midiLearnManager->isLearning() && !midiBuffer.isEmpty())
+        ? midiLearnManager->getRealtimeTable() : nullptr;
+    auto nextMidi = midiBuffer.cbegin();
+
+    stageTicks = profiler.lap(RealtimeProfiler::Midi, stageTicks);
 
     //--- 2. CLEAR OUTPUT -------------------------------------------------------
     clearOutputBuffer(outputChannelData, numOutputChannels, numSamples);
 
+    //--- 2b. AUTO-START ONSET + PRE-ROLL -------------------------------------
+    // Armed and stopped: find the first input sample over the threshold; the
+    // block is split there so recording starts on that sample.
+    int autoStartAt = -1;
+    if (autoStartEnabled.load(std::memory_order_relaxed) && !offline)
+    {
+        if (!isPlayingFlag.load(std::memory_order_relaxed) && !autoStartTriggered
+            && !countInActive.load(std::memory_order_relaxed))
+            autoStartAt = findAutoStartOnset(inputChannelData, numInputChannels, numSamples);
+        pushPreRoll(inputChannelData, numInputChannels, numSamples);
+    }
+
+    //--- SUB-BLOCKS ------------------------------------------------------------
+    // Split the block at every timed command and mapped MIDI control so record
+    // start/stop and section switches land on their sample, not the block start.
+    // Without timed events this is a single pass over the whole block.
+    // A bounce leaves held commands and the sample clock to the live device.
+    for (int pos = 0; pos < numSamples; )
+    {
+        if (!offline)
+            fireDueCommands(blockStart + pos);
+        if (pos == autoStartAt)
+            triggerAutoStart(numSamples - pos);
+
+        int splitAt = numSamples;
+        if (autoStartAt > pos)
+            splitAt = autoStartAt;
+        if (!offline)
+            splitAt = juce::jmin(splitAt, nextTimedCommandOffset(blockStart, numSamples));
+        if (midiTable != nullptr)
+        {
+            for (; nextMidi != midiBuffer.cend(); ++nextMidi)
+            {
+                const auto metadata = *nextMidi;
+                if (!midiTable->hasMatch(metadata.data, metadata.numBytes)) continue;
+
+                // Releases never trigger anything — no reason to split for them
+                const float norm = MidiLearnManager::normalisedValue(metadata.data, metadata.numBytes);
+                if (norm < 0.5f) continue;
+
+                const int at = juce::jlimit(0, numSamples - 1, metadata.samplePosition);
+                if (at > pos)
+                {
+                    // Pad hits on one-shot channels start their voice at the
+                    // event's offset — a drum roll does not chop the block up
+                    if (at < splitAt && isOneShotRetrigger(*midiTable, metadata.data, metadata.numBytes))
+                    {
+                        midiTable->forEachMatch(metadata.data, metadata.numBytes,
+                                                [&](const RealtimeMidiTable::Entry& entry) {
+                                                    oneShotRetriggerTarget(entry)->triggerOneShotPlayback(at - pos);
+                                                });
+                        continue;
+                    }
+                    splitAt = juce::jmin(splitAt, at);
+                    break;
+                }
+
+                midiTable->forEachMatch(metadata.data, metadata.numBytes,
+                                        [&](const RealtimeMidiTable::Entry& entry) {
+                                            executeRealtimeMidi(entry, norm);
+                                        });
+            }
+            stageTicks = profiler.lap(RealtimeProfiler::Midi, stageTicks);
+        }
+
+        const int len = splitAt - pos;
+        if (pos == 0 && len == numSamples)
+        {
+            renderSubBlock(inputChannelData, numInputChannels,
+                           outputChannelData, numOutputChannels,
+                           channelMidi.data(), numSamples, stageTicks);
+        }
+        else
+        {
+            const int numIns  = juce::jmin(numInputChannels,  static_cast<int>(subBlockInputs.size()));
+            const int numOuts = juce::jmin(numOutputChannels, static_cast<int>(subBlockOutputs.size()));
+            for (int ch = 0; ch < numIns; ++ch)
+                subBlockInputs[static_cast<size_t>(ch)]  = inputChannelData[ch]  != nullptr ? inputChannelData[ch]  + pos : nullptr;
+            for (int ch = 0; ch < numOuts; ++ch)
+                subBlockOutputs[static_cast<size_t>(ch)] = outputChannelData[ch] != nullptr ? outputChannelData[ch] + pos : nullptr;
+
+            for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
+            {
+                subBlockMidi[i].clear();
+                if (!channelMidi[i].isEmpty())
+                    subBlockMidi[i].addEvents(channelMidi[i], pos, len, -pos);
+            }
+
+            renderSubBlock(subBlockInputs.data(), numIns,
+                           subBlockOutputs.data(), numOuts,
+                           subBlockMidi.data(), len, stageTicks);
+        }
+
+        if (!offline)
+            totalSamplesProcessed.fetch_add(len, std::memory_order_relaxed);
+        pos = splitAt;
+    }
+
+    //--- LATENCY PROBE ---------------------------------------------------------
+    // Measures on the raw input and the final output of the whole block
+    if (latencyProbe.isRunning())
+    {
+        const int active = activeChannelIndex.load(std::memory_order_relaxed);
+        const auto* activeCh = (active >= 0 && active < channelCount) ? channels[static_cast<size_t>(active)].get() : nullptr;
+        const int inL    = activeCh != nullptr ? activeCh->getRouting().inputChannelLeft : -1;
+        const int outL   = metronome->getOutputLeft();
+        const int outR   = metronome->getOutputRight();
+
+        latencyProbe.process((inL >= 0 && inL < numInputChannels) ? inputChannelData[inL] : nullptr,
+                             (outL >= 0 && outL < numOutputChannels) ? outputChannelData[outL] : nullptr,
+                             (outR >= 0 && outR < numOutputChannels && outR != outL) ? outputChannelData[outR] : nullptr,
+                             numSamples);
+    }
+
+    //--- JOURNAL: section lengths as this block left them ----------------------
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        recordJournal.publishSectionLength(s, sectionLoopLengths[s].load(std::memory_order_relaxed));
+
+    //--- DIAGNOSTICS -----------------------------------------------------------
+    // A bounce block has no realtime budget: the profiler is paused for it
+    profiler.endBlock();
+    if (offline) return;
+
+    // The device also sees xruns the callback's own time cannot (late scheduling,
+    // driver stalls); -1 = the device does not report them
+    if (xrunDevice != nullptr)
+        deviceXruns = juce::jmax(0, xrunDevice->getXRunCount());
+    xrunCount.store(profiler.getNumXruns() + earlierDeviceXruns + deviceXruns, std::memory_order_relaxed);
+}
+
+//==============================================================================
+// Sub-Block Rendering (Audio Thread)
+//==============================================================================
+
+void AudioEngine::renderSubBlock(const float* const* inputChannelData, int numInputChannels,
+                                 float* const* outputChannelData, int numOutputChannels,
+                                 juce::MidiBuffer* channelMidiBuffers, int numSamples,
+                                 juce::int64& stageTicks)
+{
     //--- 3. ADVANCE PLAYHEAD ---------------------------------------------------
     bool playing = isPlayingFlag.load(std::memory_order_relaxed);
 
@@ -242,6 +608,14 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
 
     loopEngine->processBlock(numSamples, playing);
 
+    // MIDI clock ticks of this sub-block, stamped with the time they are heard.
+    // A bounce is not heard: slaved gear sees the transport stop.
+    midiClock.process(playheadPos, loopLen, metronome->getBPM(),
+                      playing && !bounceActive.load(std::memory_order_relaxed), numSamples,
+                      pdcLatency.load(std::memory_order_relaxed) + deviceOutputLatency);
+
+    stageTicks = profiler.lap(RealtimeProfiler::Transport, stageTicks);
+
     //--- 3a. BAR-END PENDING STOP (metronome first-recording) -----------------
     if (pendingMetroBarEnd.load(std::memory_order_relaxed))
     {
@@ -257,21 +631,28 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
             sectionLoopLengths[activeGlobalSection.load(std::memory_order_relaxed)]
                 .store(barEndTargetSample, std::memory_order_release);
             loopEngine->setPlayhead(offset);   // 0 = normal, >0 = seamless snap-back
-            if (pch >= 0 && pch < 6 && channels[pch])
-                channels[pch]->stopRecording();
+            if (auto* ch = (pch >= 0 && pch < channelCount) ? channels[pch].get() : nullptr)
+                ch->stopRecording();
             DBG("Metronome: loop set to " + juce::String(barEndTargetSample) +
                 " samples, playhead = " + juce::String(offset) + " samples");
         }
     }
 
+    stageTicks = profiler.lap(RealtimeProfiler::BarEnd, stageTicks);
+
     //--- 3a2. PENDING SECTION SWITCH (latch mode: fires at loop boundary) -----
     {
         const int ps = pendingGlobalSection.load(std::memory_order_relaxed);
         if (ps >= 0 && loopLen > 0 && playing)
         {
-            // Fire at loop boundary: playhead wrapped in this block
+            // Fire at loop boundary: playhead wrapped in this block.
+            // A section still being unpacked waits for the next boundary, and so
+            // does one whose queued record would find its buffers not sized yet.
+            const int pendRecCh = pendingSectionRecordChannel.load(std::memory_order_relaxed);
+            auto* pendRec = (pendRecCh >= 0 && pendRecCh < channelCount) ? channels[pendRecCh].get() : nullptr;
             const juce::int64 curPos = loopEngine->getCurrentPlayhead();
-            if (curPos < static_cast<juce::int64>(numSamples))
+            if (curPos < static_cast<juce::int64>(numSamples) && isSectionResident(ps)
+                && (pendRec == nullptr || pendRec->isSectionAllocated(ps)))
             {
                 pendingGlobalSection.store(-1, std::memory_order_release);
 
@@ -297,16 +678,16 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
                 loopEngine->resetPlayhead();
 
                 // Start pending record if queued for this section switch
-                const int pendRecCh = pendingSectionRecordChannel.load(std::memory_order_relaxed);
                 if (pendRecCh >= 0)
                 {
                     pendingSectionRecordChannel.store(-1, std::memory_order_release);
-                    if (pendRecCh < 6 && channels[pendRecCh])
-                        channels[pendRecCh]->startRecording(pendingSectionRecordIsOverdub.load(std::memory_order_relaxed));
+                    if (pendRec != nullptr)
+                        pendRec->startRecording(pendingSectionRecordIsOverdub.load(std::memory_order_relaxed),
+                                                newLen);
                 }
 
-                for (auto& ch : channels)
-                    if (ch) ch->setActiveSection(ps);
+                for (auto& published : channels)
+                    if (auto* ch = published.get()) ch->setActiveSection(ps);
 
                 DBG("Section switch (latched) -> " + juce::String(ps) +
                     ", loopLen=" + juce::String(newLen));
@@ -314,6 +695,49 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
         }
     }
 
+    stageTicks = profiler.lap(RealtimeProfiler::SectionSwitch, stageTicks);
+
+    //--- 3a3. STANDBY SONG SWAP (preloaded song: fires at loop boundary) -----
+    if (pendingStandbySong.load(std::memory_order_relaxed) != nullptr
+        && retiredStandbySong.load(std::memory_order_acquire) == nullptr)
+    {
+        const bool atBoundary = !playing || loopLen <= 0
+                             || loopEngine->getCurrentPlayhead() < static_cast<juce::int64>(numSamples);
+        if (atBoundary)
+        {
+            if (auto* song = pendingStandbySong.exchange(nullptr, std::memory_order_acq_rel))
+            {
+                installStandbySong(*song);
+                retiredStandbySong.store(song, std::memory_order_release);   // now holds the old audio
+            }
+        }
+    }
+
+    stageTicks = profiler.lap(RealtimeProfiler::SongSwap, stageTicks);
+
+    //--- 3a4. SECTION STORAGE TIERS (packed sections out / unpacked ones in) --
+    {
+        const int ps = pendingGlobalSection.load(std::memory_order_relaxed);
+        const int ds = deferredGlobalSection.load(std::memory_order_relaxed);
+        int keepMask = 1 << activeGlobalSection.load(std::memory_order_relaxed);
+        if (ps >= 0) keepMask |= 1 << ps;
+        if (ds >= 0) keepMask |= 1 << ds;
+
+        for (auto& published : channels)
+            if (auto* ch = published.get()) ch->applySectionTiers(keepMask);
+
+        // Immediate switch that waited for its section to be unpacked
+        if (ds >= 0 && isSectionResident(ds))
+        {
+            Command c;
+            c.type      = CommandType::SetActiveSection;
+            c.intValue1 = ds;
+            processGlobalCommand(c);
+        }
+    }
+
+    stageTicks = profiler.lap(RealtimeProfiler::SectionSwitch, stageTicks);
+
     //--- 3b. STOP ALL CHANNELS WHEN TRANSPORT IS NOT RUNNING ------------------
     if (!playing)
     {
@@ -337,8 +761,9 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
         // Cancel pending section switch
         pendingGlobalSection.store(-1, std::memory_order_release);
 
-        for (auto& ch : channels)
+        for (auto& published : channels)
         {
+            auto* ch = published.get();
             if (!ch) continue;
             if (ch->isOneShot()) continue;  // oneshot is transport-independent
 
@@ -365,29 +790,9 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
         autoStartTriggered = false;
     }
 
-    //--- 3c. AUTO-START THRESHOLD CHECK ----------------------------------------
-    if (autoStartEnabled.load(std::memory_order_relaxed) && !playing && !autoStartTriggered
-        && !countInActive.load(std::memory_order_relaxed))
-    {
-        const float threshold = autoStartThresholdLinear.load(std::memory_order_relaxed);
-        float peak = 0.0f;
-        for (int ch = 0; ch < numInputChannels && peak < threshold; ++ch)
-        {
-            if (inputChannelData[ch])
-                for (int s = 0; s < numSamples; ++s)
-                    peak = juce::jmax(peak, std::abs(inputChannelData[ch][s]));
-        }
+    //--- 3c. AUTO-START: fired at its onset sample by the sub-block split -----
 
-        if (peak >= threshold)
-        {
-            autoStartTriggered = true;
-            const int activeIdx = activeChannelIndex.load(std::memory_order_relaxed);
-            Command cmd = Command::startRecord(activeIdx);
-            processCommand(cmd);
-            // Re-read the playing flag — StartRecord may have set it
-            playing = isPlayingFlag.load(std::memory_order_relaxed);
-        }
-    }
+    stageTicks = profiler.lap(RealtimeProfiler::Transport, stageTicks);
 
     //--- 3d. COUNT-IN COUNTDOWN ------------------------------------------------
     if (countInActive.load(std::memory_order_relaxed))
@@ -397,7 +802,7 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
         {
             countInActive.store(false, std::memory_order_release);
             const int pch = pendingRecordChannel.load(std::memory_order_relaxed);
-            if (pch >= 0 && pch < 6)
+            if (pch >= 0 && pch < channelCount)
             {
                 if (auto* ch = channels[pch].get())
                 {
@@ -435,8 +840,8 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
             fixedLengthActive.store(false,  std::memory_order_release);
             fixedLengthChannel.store(-1,    std::memory_order_release);
 
-            if (pch2 >= 0 && pch2 < 6 && channels[pch2] &&
-                channels[pch2]->getState() == ChannelState::Recording)
+            auto* fixedCh = (pch2 >= 0 && pch2 < channelCount) ? channels[pch2].get() : nullptr;
+            if (fixedCh != nullptr && fixedCh->getState() == ChannelState::Recording)
             {
                 // Establish loop length if this is the first recording
                 if (loopEngine->getLoopLength() == 0)
@@ -451,49 +856,85 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
                         .store(exactLen, std::memory_order_release);
                     loopEngine->resetPlayhead();
                 }
-                channels[pch2]->stopRecording();
+                fixedCh->stopRecording();
                 DBG("Fixed-length: auto-stopped recording on ch " + juce::String(pch2));
             }
         }
     }
 
-    //--- 4. COLLECT MIDI -------------------------------------------------------
-    // Thread-safe: MIDI thread writes via addMessageToQueue(),
-    // audio thread reads here via removeNextBlockOfMessages()
-    juce::MidiBuffer midiBuffer;
-    midiCollector.removeNextBlockOfMessages(midiBuffer, numSamples);
+    stageTicks = profiler.lap(RealtimeProfiler::CountIn, stageTicks);
 
-    //--- 4b. SOLO ENFORCEMENT + ACTIVE-CHANNEL FLAG ----------------------------
+    //--- 4. SOLO ENFORCEMENT + ACTIVE-CHANNEL FLAG ----------------------------
     {
-        bool anySolo = false;
-        for (auto& ch : channels)
-            if (ch && ch->isSolo()) { anySolo = true; break; }
-
-        const int activeIdx = activeChannelIndex.load(std::memory_order_relaxed);
-        for (int i = 0; i < 6; ++i)
+        // Flat passes over the hot-state arrays, no Channel is touched
+        const bool anySolo   = hotState.anySolo(channelCount);
+        const int  activeIdx = activeChannelIndex.load(std::memory_order_relaxed);
+        for (int i = 0; i < channelCount; ++i)
         {
-            if (!channels[i]) continue;
-            channels[i]->setSoloMuted(anySolo && !channels[i]->isSolo());
-            channels[i]->setIsActiveChannel(i == activeIdx);
+            const auto c = static_cast<size_t>(hotState.slotOf(i));
+            hotState.soloMuted[c].store(anySolo && !hotState.solo[c].load(std::memory_order_relaxed),
+                                        std::memory_order_release);
+            hotState.isActiveChannel[c].store(i == activeIdx, std::memory_order_release);
         }
     }
 
+    stageTicks = profiler.lap(RealtimeProfiler::Transport, stageTicks);
+
     //--- 5. PROCESS CHANNELS ---------------------------------------------------
-    for (auto& channel : channels)
+    const bool renderParallel = parallelProcessing.load(std::memory_order_relaxed)
+                             && renderPool.isRunning()
+                             && numSamples >= kMinParallelBlockSize
+                             && numSamples        <= channelRenderBuffers[0].getNumSamples()
+                             && numOutputChannels <= channelRenderBuffers[0].getNumChannels();
+
+    if (renderParallel)
+    {
+        renderContext.engine            = this;
+        renderContext.inputChannelData  = inputChannelData;
+        renderContext.channelMidi       = channelMidiBuffers;
+        renderContext.numSamples        = numSamples;
+        renderContext.playheadPos       = playheadPos;
+        renderContext.loopLen           = loopLen;
+        renderContext.numInputChannels  = numInputChannels;
+        renderContext.numOutputChannels = numOutputChannels;
+
+        renderPool.dispatch(&AudioEngine::renderChannelJob, &renderContext, channelCount);
+
+        // Deterministic sum: always channel 0..N-1, independent of which thread rendered what
+        for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
+        {
+            if (!channels[i]) continue;
+            for (int ch = 0; ch < numOutputChannels; ++ch)
+                if (outputChannelData[ch])
+                    juce::FloatVectorOperations::add(outputChannelData[ch],
+                                                     channelRenderBuffers[i].getReadPointer(ch),
+                                                     numSamples);
+        }
+    }
+    else
     {
-        if (channel)
+        for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
         {
-            channel->processBlock(inputChannelData,
-                                  outputChannelData,
-                                  midiBuffer,
-                                  numSamples,
-                                  playheadPos,
-                                  loopLen,
-                                  numInputChannels,
-                                  numOutputChannels);
+            if (auto* channel = channels[i].get())
+            {
+                channel->processBlock(inputChannelData,
+                                      outputChannelData,
+                                      channelMidiBuffers[i],
+                                      numSamples,
+                                      playheadPos,
+                                      loopLen,
+                                      numInputChannels,
+                                      numOutputChannels);
+            }
         }
     }
 
+    stageTicks = profiler.lap(RealtimeProfiler::Channels, stageTicks);
+
+    // Master gain curve for this sub-block, shared by master record and output
+    const float* masterRamp = masterGainSmoother.process(masterGain.load(std::memory_order_relaxed), numSamples);
+    const float  masterNow  = masterGainSmoother.getCurrent();
+
     //--- 5b. MASTER RECORDING --------------------------------------------------
     if (masterRecordingActive.load(std::memory_order_acquire))
     {
@@ -504,11 +945,8 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
                     masterRecordBuffer.getWritePointer(ch & 1),
                     outputChannelData[ch], numSamples);
 
-        const float mg = masterGain.load(std::memory_order_relaxed);
-        if (mg != 1.0f)
-            for (int c = 0; c < 2; ++c)
-                juce::FloatVectorOperations::multiply(
-                    masterRecordBuffer.getWritePointer(c), mg, numSamples);
+        for (int c = 0; c < 2; ++c)
+            SmoothedGain::apply(masterRecordBuffer.getWritePointer(c), masterRamp, masterNow, numSamples);
 
         const float* const bufs[] = {
             masterRecordBuffer.getReadPointer(0),
@@ -517,107 +955,762 @@ void AudioEngine::audioDeviceIOCallbackWithContext(
         masterRecordWriter->write(bufs, numSamples);
     }
 
+    // Stems: silence for channels that did not tap this block, start/stop latch
+    stemRecorder.endBlock(numSamples);
+
+    stageTicks = profiler.lap(RealtimeProfiler::MasterRecord, stageTicks);
+
     //--- 6. METRONOME ----------------------------------------------------------
-    metronome->processBlock(outputChannelData,
-                            numOutputChannels,
-                            numSamples,
-                            playheadPos,
-                            playing);
+    // Shifted back by the PDC delay: clicks leave with the compensated channels.
+    // Not in a bounce — like the master recording, it holds the channels only.
+    if (!bounceActive.load(std::memory_order_relaxed))
+        metronome->processBlock(outputChannelData,
+                                numOutputChannels,
+                                numSamples,
+                                playheadPos - pdcLatency.load(std::memory_order_relaxed),
+                                playing);
+    stageTicks = profiler.lap(RealtimeProfiler::Metronome, stageTicks);
 
     //--- 7. MASTER GAIN -------------------------------------------------------
+    for (int ch = 0; ch < numOutputChannels; ++ch)
+        SmoothedGain::apply(outputChannelData[ch], masterRamp, masterNow, numSamples);
+
+    stageTicks = profiler.lap(RealtimeProfiler::Output, stageTicks);
+}
+
+bool AudioEngine::holdTimedCommand(const Command& cmd)
+{
+    // Full: caller applies it now rather than dropping it
+    if (timedCommands.size() >= static_cast<size_t>(kMaxTimedCommands))
+        return false;
+
+    timedCommands.push_back(cmd);   // capacity reserved in the constructor
+    return true;
+}
+
+void AudioEngine::fireDueCommands(juce::int64 now)
+{
+    // Earliest first; equal times keep their queue order
+    for (;;)
     {
-        const float mg = masterGain.load(std::memory_order_relaxed);
-        if (mg != 1.0f)
-        {
-            for (int ch = 0; ch < numOutputChannels; ++ch)
-                if (outputChannelData[ch])
-                    juce::FloatVectorOperations::multiply(outputChannelData[ch], mg, numSamples);
-        }
+        auto due = timedCommands.end();
+        for (auto it = timedCommands.begin(); it != timedCommands.end(); ++it)
+            if (it->sampleTime <= now && (due == timedCommands.end() || it->sampleTime < due->sampleTime))
+                due = it;
+
+        if (due == timedCommands.end()) return;
+
+        const Command cmd = *due;
+        timedCommands.erase(due);
+        processCommand(cmd);
     }
+}
 
-    //--- DIAGNOSTICS -----------------------------------------------------------
-    totalSamplesProcessed.fetch_add(numSamples, std::memory_order_relaxed);
+void AudioEngine::writeClockAnchor(juce::int64 samples, double ms) noexcept
+{
+    const auto seq = clockAnchorSeq.load(std::memory_order_relaxed);
+    clockAnchorSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    clockAnchorSamples.store(samples, std::memory_order_relaxed);
+    clockAnchorMs     .store(ms,      std::memory_order_relaxed);
+    clockAnchorSeq.store(seq + 2, std::memory_order_release);
 }
 
-//==============================================================================
-// Command Processing (Audio Thread)
-//==============================================================================
+juce::int64 AudioEngine::getSampleClockFor(double timeMs) const noexcept
+{
+    if (timeMs <= 0.0 || currentSampleRate <= 0.0) return -1;
 
-void AudioEngine::processCommand(const Command& cmd)
+    juce::int64 samples = 0;
+    double      anchorMs = 0.0;
+    for (;;)
+    {
+        // The writer holds it for two stores; retry if one landed in between
+        const auto before = clockAnchorSeq.load(std::memory_order_acquire);
+        samples  = clockAnchorSamples.load(std::memory_order_relaxed);
+        anchorMs = clockAnchorMs     .load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if ((before & 1) == 0 && before == clockAnchorSeq.load(std::memory_order_relaxed))
+            break;
+    }
+    if (anchorMs <= 0.0) return -1;
+
+    const auto sinceAnchor = static_cast<juce::int64>(std::llround((timeMs - anchorMs) * 0.001 * currentSampleRate));
+    return juce::jmax<juce::int64>(0, samples + sinceAnchor + currentBufferSize);
+}
+
+int AudioEngine::nextTimedCommandOffset(juce::int64 blockStart, int numSamples) const
 {
-    if (cmd.channelIndex >= 0 && cmd.channelIndex < 6)
-        processChannelCommand(cmd);
-    else
-        processGlobalCommand(cmd);
+    juce::int64 next = numSamples;
+    for (const auto& cmd : timedCommands)
+        next = juce::jmin(next, cmd.sampleTime - blockStart);
+    return static_cast<int>(juce::jmax<juce::int64>(1, next));
 }
 
-void AudioEngine::processGlobalCommand(const Command& cmd)
+//==============================================================================
+// MIDI Control Dispatch (Audio Thread)
+//==============================================================================
+
+void AudioEngine::executeRealtimeMidi(const RealtimeMidiTable::Entry& entry, float norm)
 {
-    switch (cmd.type)
+    // Every realtime target is a trigger (press, not release)
+    if (norm < 0.5f) return;
+
+    // Same redirection as MidiLearnManager::applyMapping(): in ActiveChannel
+    // mode channel-specific mappings follow the active channel.
+    const int effectiveChannel =
+        (midiLearnManager->getMidiLearnMode() == MidiLearnMode::ActiveChannel && entry.channelIndex >= 0)
+        ? activeChannelIndex.load(std::memory_order_relaxed)
+        : entry.channelIndex;
+
+    Channel* ch = (effectiveChannel >= 0 && effectiveChannel < channelCount) ? channels[effectiveChannel].get() : nullptr;
+
+    switch (entry.target)
     {
-        case CommandType::SetBPM:
+        case MidiControlTarget::MainButton:
         {
-            if (hasAnyRecordings()) { DBG("SetBPM ignored: recordings exist"); break; }
-            if (pendingMetroBarEnd.load(std::memory_order_relaxed))
-            { DBG("SetBPM ignored: bar-end snap pending"); break; }
-            const double bpm = static_cast<double>(cmd.floatValue);
-            loopEngine->setBPM(bpm);
-            metronome->setBPM(bpm);
-            // Loop length is determined by the first recording (bar-rounded in metronome mode),
-            // so changing BPM does NOT recalculate loop length here.
-            break;
+            // Double-press detection → undo last overdub, measured in samples
+            // (the clock is at the event's sample inside the block)
+            auto& last = lastMidiMainButtonSample[static_cast<size_t>(juce::jlimit(-1, MAX_CHANNELS - 1, entry.channelIndex) + 1)];
+            const juce::int64 now    = totalSamplesProcessed.load(std::memory_order_relaxed);
+            const juce::int64 window = static_cast<juce::int64>(
+                MidiLearnManager::doublePressWindowMs * 0.001 * currentSampleRate);
+
+            if (now - last < window)
+            {
+                last = kNoMainButtonPress;   // reset so triple-press doesn't re-trigger
+                Command undoCmd;
+                undoCmd.type         = CommandType::UndoOverdub;
+                undoCmd.channelIndex = effectiveChannel;
+                processCommand(undoCmd);
+                return;
+            }
+            last = now;
+
+            if (!ch) return;
+
+            if (hotState.hasPending(effectiveChannel))
+            {
+                Command cancelCmd;
+                cancelCmd.type         = CommandType::CancelPending;
+                cancelCmd.channelIndex = effectiveChannel;
+                processCommand(cancelCmd);
+                return;
+            }
+
+            const auto st = ch->getState();
+            activeChannelIndex.store(effectiveChannel, std::memory_order_release);
+
+            if (overdubMode.load(std::memory_order_relaxed) && st == ChannelState::Playing)
+            {
+                Command c;
+                c.type         = CommandType::StartOverdub;
+                c.channelIndex = effectiveChannel;
+                processCommand(c);
+            }
+            else if (st == ChannelState::Overdubbing || st == ChannelState::Recording)
+                processCommand(Command::stopRecord(effectiveChannel));
+            else if (!ch->hasLoop())
+                processCommand(Command::startRecord(effectiveChannel));
+            else if (st == ChannelState::Playing)
+                processCommand(Command::stopPlayback(effectiveChannel));
+            else
+                processCommand(Command::startPlayback(effectiveChannel));
+            return;
         }
 
-        case CommandType::SetBeatsPerLoop:
+        case MidiControlTarget::Record:
         {
-            if (isPlayingFlag.load(std::memory_order_relaxed)) { DBG("SetBeatsPerLoop ignored: playing"); break; }
-            loopEngine->setBeatsPerLoop(cmd.intValue1);
-            break;
+            if (!ch) return;
+            const auto st = ch->getState();
+            processCommand((st == ChannelState::Recording || st == ChannelState::Overdubbing)
+                           ? Command::stopRecord(effectiveChannel)
+                           : Command::startRecord(effectiveChannel));
+            return;
         }
 
-        case CommandType::SetLoopLength:
+        case MidiControlTarget::Play:
         {
-            loopEngine->setLoopLength(cmd.getLoopLength());
-            break;
+            if (!ch) return;
+            processCommand(ch->getState() == ChannelState::Playing
+                           ? Command::stopPlayback(effectiveChannel)
+                           : Command::startPlayback(effectiveChannel));
+            return;
         }
 
-        case CommandType::ResetPlayhead:
+        case MidiControlTarget::Overdub:
         {
-            loopEngine->resetPlayhead();
-            break;
+            if (!ch) return;
+            Command c;
+            c.type         = (ch->getState() == ChannelState::Overdubbing)
+                             ? CommandType::StopOverdub : CommandType::StartOverdub;
+            c.channelIndex = effectiveChannel;
+            processCommand(c);
+            return;
         }
 
-        case CommandType::SetGlobalOverdubMode:
+        case MidiControlTarget::GlobalPlayStop:
         {
-            overdubMode.store(cmd.boolValue, std::memory_order_release);
-            break;
+            Command c;
+            c.type      = CommandType::SetPlaying;
+            c.boolValue = !isPlayingFlag.load(std::memory_order_relaxed);
+            processCommand(c);
+            return;
         }
 
-        case CommandType::ChangeActiveChannel:
+        case MidiControlTarget::SectionA:
+        case MidiControlTarget::SectionB:
+        case MidiControlTarget::SectionC:
         {
-            // intValue1: +1 = next, -1 = prev, 0-5 = direkt
-            if (cmd.intValue1 == 1)
+            const int section = static_cast<int>(entry.target) - static_cast<int>(MidiControlTarget::SectionA);
+
+            // Same flow as setActiveSection()
+            if (section == activeGlobalSection.load(std::memory_order_relaxed))
             {
-                const int cur = activeChannelIndex.load(std::memory_order_relaxed);
-                activeChannelIndex.store((cur + 1) % 6, std::memory_order_release);
+                pendingGlobalSection.store(-1, std::memory_order_release);
+                pendingSectionRecordChannel.store(-1, std::memory_order_release);
+                return;
             }
-            else if (cmd.intValue1 == -1)
+
+            // First use of this section: the background thread picks it up on its next slice
+            sectionAllocRequests.fetch_or(1 << section, std::memory_order_acq_rel);
+
+            for (int i = 0; i < channelCount; ++i)
             {
-                const int cur = activeChannelIndex.load(std::memory_order_relaxed);
-                activeChannelIndex.store((cur + 5) % 6, std::memory_order_release);
+                auto* c = channels[i].get();
+                if (!c) continue;
+                const auto cs = c->getState();
+                if (cs == ChannelState::Recording || cs == ChannelState::Overdubbing)
+                    processCommand(Command::stopRecord(i));
             }
-            else if (cmd.intValue1 >= 0 && cmd.intValue1 < 6)
+
+            if (latchMode.load(std::memory_order_relaxed)
+                && isPlayingFlag.load(std::memory_order_relaxed)
+                && loopEngine->getLoopLength() > 0)
             {
-                activeChannelIndex.store(cmd.intValue1, std::memory_order_release);
+                pendingGlobalSection.store(section, std::memory_order_release);
             }
-            break;
+            else
+            {
+                Command c;
+                c.type      = CommandType::SetActiveSection;
+                c.intValue1 = section;
+                processCommand(c);
+            }
+            return;
         }
 
-        case CommandType::SetMetronomeOutput:
-        {
-            metronome->setOutputChannels(cmd.intValue1, cmd.intValue2);
-            break;
-        }
+        default:
+            return;
+    }
+}
+
+Channel* AudioEngine::oneShotRetriggerTarget(const RealtimeMidiTable::Entry& entry) const
+{
+    if (entry.target != MidiControlTarget::Play) return nullptr;
+
+    // Same channel redirection as executeRealtimeMidi()
+    const int effectiveChannel =
+        (midiLearnManager->getMidiLearnMode() == MidiLearnMode::ActiveChannel && entry.channelIndex >= 0)
+        ? activeChannelIndex.load(std::memory_order_relaxed)
+        : entry.channelIndex;
+
+    Channel* ch = (effectiveChannel >= 0 && effectiveChannel < channelCount) ? channels[effectiveChannel].get() : nullptr;
+    if (ch == nullptr || !ch->isOneShot() || ch->getOneShotLength() <= 0
+        || ch->getState() == ChannelState::Recording)
+        return nullptr;
+    return ch;
+}
+
+bool AudioEngine::isOneShotRetrigger(const RealtimeMidiTable& table, const juce::uint8* data, int numBytes) const
+{
+    // Only when every mapping of the message is a one-shot retrigger
+    bool any = false, all = true;
+    table.forEachMatch(data, numBytes, [&](const RealtimeMidiTable::Entry& entry) {
+        any = true;
+        all = all && oneShotRetriggerTarget(entry) != nullptr;
+    });
+    return any && all;
+}
+
+//==============================================================================
+// MIDI Demultiplexing (Audio Thread)
+//==============================================================================
+
+void AudioEngine::demultiplexMidi(const juce::MidiBuffer& source) noexcept
+{
+    for (auto& buffer : channelMidi)
+        buffer.clear();
+
+    if (source.isEmpty())
+        return;
+
+    // Routing table for this block: bit i of route[n] = channel i receives MIDI
+    // channel n (1-16); route[0] is for system messages, which every VSTi gets
+    std::array<juce::uint32, 17> route {};
+    for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
+    {
+        auto* channel = channels[i].get();
+        if (channel == nullptr || channel->getType() != ChannelType::VSTi) continue;
+
+        const auto bit    = static_cast<juce::uint32>(1u << i);
+        const int  filter = static_cast<VSTiChannel*>(channel)->getMIDIChannelFilter();
+        if (filter < 0 || filter > 16)
+            continue;   // not a MIDI channel: route nothing rather than write past the table
+
+        if (filter == 0)
+        {
+            for (auto& r : route) r |= bit;
+        }
+        else
+        {
+            route[0]                           |= bit;
+            route[static_cast<size_t>(filter)] |= bit;
+        }
+    }
+
+    // Bytes each buffer holds — an event that would not fit is dropped rather
+    // than letting the MidiBuffer grow on the audio thread
+    std::array<int, MAX_CHANNELS> used {};
+
+    for (const auto metadata : source)
+    {
+        if (metadata.numBytes <= 0) continue;
+
+        const auto status  = metadata.data[0];
+        const auto midiCh  = (status >= 0x80 && status < 0xF0) ? (status & 0x0F) + 1 : 0;
+        const auto cost    = metadata.numBytes + kMidiEventOverhead;
+
+        const auto mask    = route[static_cast<size_t>(midiCh)];
+        if (mask == 0) continue;
+
+        for (size_t i = 0; i < static_cast<size_t>(channelCount); ++i)
+        {
+            if ((mask & (1u << i)) == 0 || used[i] + cost > kChannelMidiBytes) continue;
+
+            channelMidi[i].addEvent(metadata.data, metadata.numBytes, metadata.samplePosition);
+            used[i] += cost;
+        }
+    }
+}
+
+//==============================================================================
+// Parallel Channel Rendering
+//==============================================================================
+
+void AudioEngine::renderChannelJob(void* context, int channelIndex)
+{
+    // Runs on the audio thread or a render worker — same rules as the callback.
+    const auto& ctx = *static_cast<const RenderContext*>(context);
+    auto& engine    = *ctx.engine;
+
+    auto* channel = engine.channels[static_cast<size_t>(channelIndex)].get();
+    if (!channel) return;
+
+    auto& block = engine.channelRenderBuffers[static_cast<size_t>(channelIndex)];
+    block.clear(0, ctx.numSamples);
+
+    channel->processBlock(ctx.inputChannelData,
+                          block.getArrayOfWritePointers(),
+                          ctx.channelMidi[channelIndex],
+                          ctx.numSamples,
+                          ctx.playheadPos,
+                          ctx.loopLen,
+                          ctx.numInputChannels,
+                          ctx.numOutputChannels);
+}
+
+void AudioEngine::setParallelProcessing(bool enabled)
+{
+    if (enabled)
+    {
+        // One job per channel; the audio thread itself renders one of them.
+        // Pinned workers get a core each.
+        int numWorkers = juce::jlimit(1, juce::jmax(1, channelCount - 1),
+                                      juce::SystemStats::getNumCpus() - 1);
+        if (renderWorkerCores != 0)
+            numWorkers = juce::jmin(numWorkers, juce::countNumberOfBits(renderWorkerCores));
+        if (!renderPool.isRunning())
+            renderPool.start(numWorkers, renderWorkerCores);
+        parallelProcessing.store(true, std::memory_order_release);
+    }
+    else
+    {
+        parallelProcessing.store(false, std::memory_order_release);
+        renderPool.stop();
+    }
+}
+
+juce::Result AudioEngine::setRenderWorkerCores(const juce::String& cores)
+{
+    juce::uint32 mask = 0;
+    if (!parseCoreList(cores, mask))
+        return juce::Result::fail("Worker cores must be core numbers from 0 to "
+                                  + juce::String(juce::jmin(32, juce::SystemStats::getNumCpus()) - 1)
+                                  + ", e.g. 2-5 or 2,4,6 (got \"" + cores.trim() + "\")");
+    if (mask == renderWorkerCores)
+        return juce::Result::ok();
+
+    renderWorkerCores = mask;
+    if (renderPool.isRunning())
+    {
+        // Serial rendering while the workers restart
+        parallelProcessing.store(false, std::memory_order_release);
+        renderPool.stop();
+        setParallelProcessing(true);
+    }
+    return juce::Result::ok();
+}
+
+void AudioEngine::setOverdubConsolidation(int maxLayers, int undoDepth)
+{
+    const juce::ScopedLock sl(channelSwapLock);
+    for (auto& published : channels)
+        if (auto* ch = published.get()) ch->setLayerConsolidation(maxLayers, undoDepth);
+}
+
+void AudioEngine::setSectionCompression(bool enabled)
+{
+    sectionCompression.store(enabled, std::memory_order_release);
+    backgroundThread.moveToFrontOfQueue(this);   // unpacking starts on the next slice
+}
+
+bool AudioEngine::isSectionResident(int s) const noexcept
+{
+    for (const auto& published : channels)
+        if (auto* ch = published.get(); ch && !ch->isSectionResident(s))
+            return false;
+    return true;
+}
+
+juce::int64 AudioEngine::getPackedLoopBytes() const
+{
+    juce::int64 total = 0;
+    for (const auto& published : channels)
+        if (auto* ch = published.get()) total += ch->getPackedBytes();
+    return total;
+}
+
+void AudioEngine::queueStandbySong(std::unique_ptr<StandbySong> song)
+{
+    delete pendingStandbySong.exchange(song.release(), std::memory_order_acq_rel);
+}
+
+void AudioEngine::cancelStandbySong()
+{
+    delete pendingStandbySong.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+void AudioEngine::installStandbySong(StandbySong& song) noexcept
+{
+    pendingGlobalSection       .store(-1, std::memory_order_release);
+    deferredGlobalSection      .store(-1, std::memory_order_release);
+    pendingSectionRecordChannel.store(-1, std::memory_order_release);
+
+    const int newSec = juce::jlimit(0, NUM_SECTIONS - 1, song.activeSection);
+
+    for (int i = 0; i < channelCount; ++i)
+    {
+        auto* ch = channels[i].get();
+        if (!ch) continue;
+
+        const auto cs = ch->getState();
+        if (cs == ChannelState::Recording || cs == ChannelState::Overdubbing)
+            ch->stopRecording();
+
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+            ch->swapInStandbySection(s, song.channels[static_cast<size_t>(i)][static_cast<size_t>(s)]);
+        ch->setActiveSection(newSec);
+    }
+
+    // Swap loop lengths so the retired object describes the old song
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        song.sectionLoopLengths[static_cast<size_t>(s)] =
+            sectionLoopLengths[s].exchange(song.sectionLoopLengths[static_cast<size_t>(s)],
+                                           std::memory_order_acq_rel);
+
+    activeGlobalSection.store(newSec, std::memory_order_release);
+    loopEngine->setLoopLength(song.loopLength);
+    loopEngine->resetPlayhead();
+
+    if (song.hasSettings)
+        applyStandbySettings(song.settings);
+
+    DBG("Standby song installed, loopLen=" + juce::String(song.loopLength));
+}
+
+void AudioEngine::applyStandbySettings(const StandbySettings& settings) noexcept
+{
+    // Atomic stores only, plus routing, which the audio thread owns (see SetInputRouting)
+    loopEngine->setBPM(settings.bpm);
+    loopEngine->setBeatsPerLoop(settings.beatsPerLoop);
+    metronome->setEnabled(settings.metronomeEnabled);
+    metronome->setBPM(settings.bpm);
+    metronome->setOutputChannels(settings.metronomeOutputL, settings.metronomeOutputR);
+    metronome->setBeatsPerBar(settings.metronomeBeatsPerBar);
+    metronome->setMasterGain(settings.metronomeGain);
+    masterGain.store(juce::jlimit(0.0f, 1.0f, settings.masterGain), std::memory_order_release);
+
+    for (int i = 0; i < channelCount; ++i)
+    {
+        auto* ch = channels[i].get();
+        if (!ch) continue;
+
+        const auto& mix = settings.channels[static_cast<size_t>(i)];
+        ch->setGainDb     (mix.gainDb);
+        ch->setMonitorMode(mix.monitorMode);
+        ch->setMuted      (mix.muted);
+        ch->setSolo       (mix.solo);
+        ch->setOneShot    (mix.oneShot);
+        ch->setRouting    (mix.routing);
+    }
+}
+
+int AudioEngine::useTimeSlice()
+{
+    // Old audio from a song switch: page tables are freed here, not on the audio thread
+    delete retiredStandbySong.exchange(nullptr, std::memory_order_acq_rel);
+
+    // An FX plugin reported new latency off the message thread
+    if (fxLatencyChanged.exchange(false, std::memory_order_acq_rel))
+        triggerAsyncUpdate();
+
+    const juce::ScopedLock sl(channelSwapLock);
+
+    const int curSec = activeGlobalSection.load(std::memory_order_relaxed);
+    bool didWork = false;
+
+    // Section buffers that became reachable: size them before anyone records there
+    if (const int requests = sectionAllocRequests.exchange(0, std::memory_order_acq_rel))
+    {
+        for (auto& published : channels)
+        {
+            auto* ch = published.get();
+            if (!ch) continue;
+            for (int s = 0; s < NUM_SECTIONS; ++s)
+            {
+                if ((requests & (1 << s)) == 0 || ch->isSectionAllocated(s)) continue;
+                ch->allocateSection(s);
+                didWork = true;
+            }
+        }
+    }
+
+    for (auto& published : channels)
+    {
+        auto* ch = published.get();
+        if (!ch) continue;
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            // The active section's length lives in the loop engine until the next switch
+            const juce::int64 len = (s == curSec) ? loopEngine->getLoopLength()
+                                                  : getSectionLoopLength(s);
+            didWork |= ch->prepareLayerConsolidation(s, len);
+        }
+
+        // Waveform overviews follow recording within one slice
+        didWork |= ch->updateWaveformOverviews();
+    }
+
+    //--- Storage tiers: unpack what may play next, pack what has been idle a while ---
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        const int ps = pendingGlobalSection.load(std::memory_order_relaxed);
+        const int ds = deferredGlobalSection.load(std::memory_order_relaxed);
+
+        int keepMask = 1 << curSec;
+        if (ps >= 0) keepMask |= 1 << ps;
+        if (ds >= 0) keepMask |= 1 << ds;
+        if (!sectionCompression.load(std::memory_order_relaxed))
+            keepMask = (1 << NUM_SECTIONS) - 1;
+
+        int packMask = 0;
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            if ((keepMask & (1 << s)) != 0 || sectionLastUsedMs[static_cast<size_t>(s)] == 0)
+                sectionLastUsedMs[static_cast<size_t>(s)] = now;
+            else if (now - sectionLastUsedMs[static_cast<size_t>(s)] >= kSectionPackDelayMs)
+                packMask |= 1 << s;
+        }
+
+        std::vector<Channel::TierBatch> batches;
+        for (auto& published : channels)
+            if (auto* ch = published.get()) didWork |= ch->updateSectionTiers(keepMask, packMask,
+                                                          kPackPagesPerSlice, kUnpackPagesPerSlice, batches);
+
+        // Encoding and decoding only touch the pool: channels may be replaced meanwhile
+        if (!batches.empty())
+        {
+            {
+                const juce::ScopedUnlock ul(channelSwapLock);
+                for (auto& batch : batches)
+                    batch.run(loopPagePool);
+            }
+
+            for (auto& batch : batches)
+            {
+                const bool stillPublished = std::any_of(channels.begin(), channels.end(),
+                                                        [&](const auto& published) { return published.get() == batch.channel; });
+                if (stillPublished)
+                    batch.channel->finishTierBatch(batch);
+                else
+                    batch.releasePages(loopPagePool);
+            }
+        }
+
+        // Released pages only leave the pool when trimmed
+        if (loopPagePool.getNumFreePages() > 2 * loopPagePool.getReserve())
+            loopPagePool.trim();
+    }
+
+    //--- Residency of what is playing: pages the OS has paged out would fault on read ---
+    {
+        const auto now = juce::Time::getMillisecondCounter();
+        if (now - lastResidencyCheckMs >= kResidencyCheckMs)
+        {
+            lastResidencyCheckMs = now;
+
+            int mapped = 0, resident = 0;
+            for (const auto& published : channels)
+                if (auto* ch = published.get()) ch->countResidentPages(curSec, mapped, resident);
+
+            activeLoopBytes    .store(mapped   * LoopPagePool::kPageBytes, std::memory_order_relaxed);
+            activeResidentBytes.store(resident * LoopPagePool::kPageBytes, std::memory_order_relaxed);
+
+            publishChannelMetrics();
+        }
+    }
+
+    return didWork ? 10 : 50;
+}
+
+void AudioEngine::publishChannelMetrics()
+{
+    // Here the sections cannot be packed, unpacked or resized underneath us
+    for (int i = 0; i < MAX_CHANNELS; ++i)
+    {
+        auto&       m  = channelMetrics[static_cast<size_t>(i)];
+        const auto* ch = channels[static_cast<size_t>(i)].get();
+        if (ch == nullptr)
+        {
+            m.present.store(false, std::memory_order_relaxed);
+            continue;
+        }
+
+        m.section    .store(ch->getActiveSection(),     std::memory_order_relaxed);
+        m.layers     .store(ch->getOverdubLayerCount(), std::memory_order_relaxed);
+        m.packedBytes.store(ch->getPackedBytes(),       std::memory_order_relaxed);
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            juce::int64 baseBytes = 0, layerBytes = 0;
+            ch->getSectionMemory(s, baseBytes, layerBytes);
+            m.baseBytes [static_cast<size_t>(s)].store(baseBytes,  std::memory_order_relaxed);
+            m.layerBytes[static_cast<size_t>(s)].store(layerBytes, std::memory_order_relaxed);
+        }
+        m.present.store(true, std::memory_order_release);
+    }
+}
+
+AudioEngine::ChannelMetrics AudioEngine::getChannelMetrics(int index) const
+{
+    ChannelMetrics out;
+    if (index < 0 || index >= MAX_CHANNELS) return out;
+
+    const auto& m = channelMetrics[static_cast<size_t>(index)];
+    out.present = m.present.load(std::memory_order_acquire);
+    if (!out.present) return out;
+
+    // The state is live: hot-state slots outlive every channel
+    out.state       = hotState.state[static_cast<size_t>(hotState.slotOf(index))].load(std::memory_order_relaxed);
+    out.section     = m.section    .load(std::memory_order_relaxed);
+    out.layers      = m.layers     .load(std::memory_order_relaxed);
+    out.packedBytes = m.packedBytes.load(std::memory_order_relaxed);
+    for (size_t s = 0; s < NUM_SECTIONS; ++s)
+    {
+        out.baseBytes [s] = m.baseBytes [s].load(std::memory_order_relaxed);
+        out.layerBytes[s] = m.layerBytes[s].load(std::memory_order_relaxed);
+    }
+    return out;
+}
+
+//==============================================================================
+// Command Processing (Audio Thread)
+//==============================================================================
+
+void AudioEngine::processCommand(const Command& cmd)
+{
+    if (cmd.channelIndex >= 0 && cmd.channelIndex < channelCount)
+        processChannelCommand(cmd);
+    else
+        processGlobalCommand(cmd);
+}
+
+void AudioEngine::processGlobalCommand(const Command& cmd)
+{
+    switch (cmd.type)
+    {
+        case CommandType::SetBPM:
+        {
+            if (hasAnyRecordings()) { DBG("SetBPM ignored: recordings exist"); break; }
+            if (pendingMetroBarEnd.load(std::memory_order_relaxed))
+            { DBG("SetBPM ignored: bar-end snap pending"); break; }
+            const double bpm = static_cast<double>(cmd.floatValue);
+            loopEngine->setBPM(bpm);
+            metronome->setBPM(bpm);
+            // Loop length is determined by the first recording (bar-rounded in metronome mode),
+            // so changing BPM does NOT recalculate loop length here.
+            break;
+        }
+
+        case CommandType::SetBeatsPerLoop:
+        {
+            if (isPlayingFlag.load(std::memory_order_relaxed)) { DBG("SetBeatsPerLoop ignored: playing"); break; }
+            loopEngine->setBeatsPerLoop(cmd.intValue1);
+            break;
+        }
+
+        case CommandType::SetLoopLength:
+        {
+            loopEngine->setLoopLength(cmd.getLoopLength());
+            break;
+        }
+
+        case CommandType::ResetPlayhead:
+        {
+            loopEngine->resetPlayhead();
+            break;
+        }
+
+        case CommandType::SetGlobalOverdubMode:
+        {
+            overdubMode.store(cmd.boolValue, std::memory_order_release);
+            break;
+        }
+
+        case CommandType::ChangeActiveChannel:
+        {
+            // intValue1: +1 = next, -1 = prev, 0..N-1 = direkt
+            if (cmd.intValue1 == 1)
+            {
+                const int cur = activeChannelIndex.load(std::memory_order_relaxed);
+                activeChannelIndex.store((cur + 1) % channelCount, std::memory_order_release);
+            }
+            else if (cmd.intValue1 == -1)
+            {
+                const int cur = activeChannelIndex.load(std::memory_order_relaxed);
+                activeChannelIndex.store((cur + channelCount - 1) % channelCount, std::memory_order_release);
+            }
+            else if (cmd.intValue1 >= 0 && cmd.intValue1 < channelCount)
+            {
+                activeChannelIndex.store(cmd.intValue1, std::memory_order_release);
+            }
+            break;
+        }
+
+        case CommandType::SetMetronomeOutput:
+        {
+            metronome->setOutputChannels(cmd.intValue1, cmd.intValue2);
+            break;
+        }
 
         case CommandType::SetMetronomeMute:
         {
@@ -636,9 +1729,10 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             fixedLengthChannel.store(-1,   std::memory_order_release);
             fixedLengthSamplesRemaining = 0;
             pendingGlobalSection.store(-1, std::memory_order_release);
+            deferredGlobalSection.store(-1, std::memory_order_release);
             pendingSectionRecordChannel.store(-1, std::memory_order_release);
-            for (auto& ch : channels)
-                if (ch) ch->clearAllSections();
+            for (auto& published : channels)
+                if (auto* ch = published.get()) ch->clearAllSections();
 
             activeGlobalSection.store(0, std::memory_order_release);
             for (int s = 0; s < NUM_SECTIONS; ++s)
@@ -651,6 +1745,27 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             break;
         }
 
+        case CommandType::SetPlaying:
+        {
+            // Audio-thread twin of setPlaying()
+            if (!cmd.boolValue)
+                lastActiveChannels.store(hotState.playingMask(channelCount), std::memory_order_release);
+
+            if (!hasAnyRecordings())
+                loopEngine->resetPlayhead();
+
+            isPlayingFlag.store(cmd.boolValue, std::memory_order_release);
+
+            if (cmd.boolValue)
+                for (int i = 0; i < channelCount; ++i)
+                {
+                    const auto* ch = channels[i].get();
+                    if (ch && ch->hasLoop() && !ch->isOneShot())
+                        processChannelCommand(Command::startPlayback(i));
+                }
+            break;
+        }
+
         case CommandType::EmergencyStop:
         {
             pendingMetroBarEnd.store(false, std::memory_order_release);
@@ -665,8 +1780,9 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             pendingSectionRecordChannel.store(-1, std::memory_order_release);
             isPlayingFlag.store(false, std::memory_order_release);
             loopEngine->resetPlayhead();
-            for (auto& ch : channels)
+            for (auto& published : channels)
             {
+                auto* ch = published.get();
                 if (!ch) continue;
                 const auto cs = ch->getState();
                 if (cs == ChannelState::Recording || cs == ChannelState::Overdubbing)
@@ -683,8 +1799,8 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             if (loopLen <= 0) break;
 
             const int curSec = activeGlobalSection.load(std::memory_order_relaxed);
-            for (auto& ch : channels)
-                if (ch) ch->doubleBuffer(curSec, loopLen);
+            for (auto& published : channels)
+                if (auto* ch = published.get()) ch->doubleBuffer(curSec, loopLen);
 
             loopEngine->setLoopLength(loopLen * 2);
             sectionLoopLengths[curSec].store(loopLen * 2, std::memory_order_release);
@@ -698,17 +1814,27 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             if (newSec < 0 || newSec >= NUM_SECTIONS) break;
 
             const int curSec = activeGlobalSection.load(std::memory_order_relaxed);
+            deferredGlobalSection.store(-1, std::memory_order_release);
             if (newSec == curSec) break;
 
             // Stop any recording/overdubbing first
-            for (auto& ch : channels)
+            for (auto& published : channels)
             {
+                auto* ch = published.get();
                 if (!ch) continue;
                 const auto cs = ch->getState();
                 if (cs == ChannelState::Recording || cs == ChannelState::Overdubbing)
                     ch->stopRecording();
             }
 
+            // Packed section: the background thread unpacks it, step 3a4 switches then
+            if (!isSectionResident(newSec))
+            {
+                deferredGlobalSection.store(newSec, std::memory_order_release);
+                DBG("Section switch -> " + juce::String(newSec) + " waits for unpacking");
+                break;
+            }
+
             // Save current loop length
             sectionLoopLengths[curSec].store(loopEngine->getLoopLength(), std::memory_order_release);
 
@@ -729,8 +1855,8 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
             loopEngine->setLoopLength(newLen);
             loopEngine->resetPlayhead();
 
-            for (auto& ch : channels)
-                if (ch) ch->setActiveSection(newSec);
+            for (auto& published : channels)
+                if (auto* ch = published.get()) ch->setActiveSection(newSec);
 
             DBG("Section switch -> " + juce::String(newSec) +
                 ", loopLen=" + juce::String(newLen));
@@ -745,7 +1871,7 @@ void AudioEngine::processGlobalCommand(const Command& cmd)
 
 void AudioEngine::processChannelCommand(const Command& cmd)
 {
-    if (cmd.channelIndex < 0 || cmd.channelIndex >= 6) return;
+    if (cmd.channelIndex < 0 || cmd.channelIndex >= channelCount) return;
 
     Channel* channel = channels[cmd.channelIndex].get();
     if (!channel) return;
@@ -1013,7 +2139,7 @@ void AudioEngine::processChannelCommand(const Command& cmd)
             if (latchMode.load(std::memory_order_relaxed) && loopLen > 0)
                 channel->requestOverdubAtLoopEnd();
             else
-                channel->startRecording(true);
+                channel->startRecording(true, loopLen);
             break;
         }
 
@@ -1075,14 +2201,9 @@ void AudioEngine::processChannelCommand(const Command& cmd)
             break;
 
         case CommandType::UnloadPlugin:
-        {
-            const int slot = cmd.intValue1;
-            if (slot == -1 && channel->getType() == ChannelType::VSTi)
-                static_cast<VSTiChannel*>(channel)->removeVSTi();
-            else if (slot >= 0 && slot < 3)
-                channel->removePlugin(slot);
+            // Unloading happens on message thread via removePlugin() (the old
+            // instance must outlive this block)
             break;
-        }
 
         case CommandType::ClearChannel:
         {
@@ -1091,8 +2212,8 @@ void AudioEngine::processChannelCommand(const Command& cmd)
             // Reset this section's loop length when no channels have content in it
             {
                 bool anyContent = false;
-                for (auto& ch : channels)
-                    if (ch && ch->sectionHasContent(curSec)) { anyContent = true; break; }
+                for (auto& published : channels)
+                    if (auto* ch = published.get(); ch && ch->sectionHasContent(curSec)) { anyContent = true; break; }
                 if (!anyContent)
                 {
                     sectionLoopLengths[curSec].store(0, std::memory_order_release);
@@ -1127,20 +2248,19 @@ void AudioEngine::processChannelCommand(const Command& cmd)
 
 bool AudioEngine::sendCommand(const Command& cmd)
 {
-    // Pre-allocate overdub buffer on message thread before queuing
-    if (cmd.type == CommandType::StartOverdub)
-    {
-        auto* ch = getChannel(cmd.channelIndex);
-        if (ch)
-            ch->stageOverdubBuffer(loopEngine->getLoopLength());
-    }
-
-    // Pre-allocate active section buffer before recording
+    // Never size section buffers here: if the background thread has not
+    // prepared the active section yet, the record fails instead of blocking
     if (cmd.type == CommandType::StartRecord || cmd.type == CommandType::StartOverdub)
     {
         auto* ch = getChannel(cmd.channelIndex);
-        if (ch)
-            ch->allocateSection(ch->getActiveSection());
+        if (ch && !ch->isSectionAllocated(ch->getActiveSection()))
+        {
+            requestSectionAllocation(1 << ch->getActiveSection());
+            hotState.noteRefusedRecord(cmd.channelIndex);
+            DBG("Record refused: section buffers of channel " + juce::String(cmd.channelIndex) +
+                " not ready yet");
+            return false;
+        }
     }
 
     if (!commandQueue.pushCommand(cmd))
@@ -1153,22 +2273,9 @@ bool AudioEngine::sendCommand(const Command& cmd)
 
 void AudioEngine::setPlaying(bool shouldPlay)
 {
+    // Memorize which channels are currently playing or overdubbing (skip oneshot)
     if (!shouldPlay)
-    {
-        // Memorize which channels are currently playing or overdubbing (skip oneshot)
-        uint8_t mask = 0;
-        for (int i = 0; i < 6; ++i)
-        {
-            auto* ch = channels[i].get();
-            if (ch && !ch->isOneShot())
-            {
-                const auto st = ch->getState();
-                if (st == ChannelState::Playing || st == ChannelState::Overdubbing)
-                    mask |= static_cast<uint8_t>(1u << i);
-            }
-        }
-        lastActiveChannels.store(mask, std::memory_order_release);
-    }
+        lastActiveChannels.store(hotState.playingMask(channelCount), std::memory_order_release);
 
     // When all channels are empty, always start (and stop) from position 0.
     if (!hasAnyRecordings())
@@ -1179,9 +2286,12 @@ void AudioEngine::setPlaying(bool shouldPlay)
     if (shouldPlay)
     {
         // Start all channels that have recordings (skip oneshot — they're independent)
-        for (int i = 0; i < 6; ++i)
-            if (channels[i] && channels[i]->hasLoop() && !channels[i]->isOneShot())
+        for (int i = 0; i < channelCount; ++i)
+        {
+            const auto* ch = channels[i].get();
+            if (ch && ch->hasLoop() && !ch->isOneShot())
                 sendCommand(Command::startPlayback(i));
+        }
     }
 }
 
@@ -1214,64 +2324,116 @@ void AudioEngine::doubleLoopLength()
 
 void AudioEngine::setActiveChannel(int index)
 {
-    activeChannelIndex.store(juce::jlimit(0, 5, index), std::memory_order_release);
+    activeChannelIndex.store(juce::jlimit(0, channelCount - 1, index), std::memory_order_release);
+}
+
+void AudioEngine::nextChannel()
+{
+    const int cur = activeChannelIndex.load(std::memory_order_relaxed);
+    activeChannelIndex.store((cur + 1) % channelCount, std::memory_order_release);
+}
+
+void AudioEngine::prevChannel()
+{
+    const int cur = activeChannelIndex.load(std::memory_order_relaxed);
+    activeChannelIndex.store((cur + channelCount - 1) % channelCount, std::memory_order_release);
 }
 
-void AudioEngine::nextChannel()
-{
-    const int cur = activeChannelIndex.load(std::memory_order_relaxed);
-    activeChannelIndex.store((cur + 1) % 6, std::memory_order_release);
+//==============================================================================
+// Utility
+//==============================================================================
+
+void AudioEngine::clearOutputBuffer(float* const* outputChannelData,
+                                    int numChannels, int numSamples)
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+        if (outputChannelData[ch])
+            juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+}
+
+//==============================================================================
+// Channel Management (Message Thread)
+//==============================================================================
+
+void AudioEngine::setNumChannels(int numChannels)
+{
+    numChannels = juce::jlimit(1, MAX_CHANNELS, numChannels);
+    if (numChannels == channelCount) return;
+
+    // The callback and the render pool size everything for channelCount when the device starts
+    if (isInitialised.load(std::memory_order_relaxed))
+    {
+        jassertfalse;
+        DBG("setNumChannels: ignored while the audio device runs");
+        return;
+    }
+
+    for (int i = numChannels; i < channelCount; ++i)
+    {
+        installChannel(i, nullptr);
+        channelMuteGroup[i] = 0;
+    }
+    for (int i = channelCount; i < numChannels; ++i)
+    {
+        hotState.reset(i);
+        hotState.setLiveSlot(i, i);
+        installChannel(i, createChannel(i, ChannelType::Audio, i));
+    }
+
+    channelCount = numChannels;
+    if (activeChannelIndex.load(std::memory_order_relaxed) >= channelCount)
+        activeChannelIndex.store(0, std::memory_order_relaxed);
+    DBG("Channels: " + juce::String(channelCount));
 }
 
-void AudioEngine::prevChannel()
+std::unique_ptr<Channel> AudioEngine::createChannel(int index, ChannelType type, int hotSlot)
 {
-    const int cur = activeChannelIndex.load(std::memory_order_relaxed);
-    activeChannelIndex.store((cur + 5) % 6, std::memory_order_release);
+    auto channel = (type == ChannelType::Audio)
+                   ? std::unique_ptr<Channel>(std::make_unique<AudioChannel>(index, hotState, hotSlot))
+                   : std::unique_ptr<Channel>(std::make_unique<VSTiChannel>(index, hotState, hotSlot));
+    channel->setLoopPagePool(&loopPagePool);
+    channel->setProfiler(&profiler);
+    channel->setReclaimer(&reclaimer);
+    channel->setStemRecorder(&stemRecorder);
+    channel->setRecordJournal(&recordJournal);
+    return channel;
 }
 
-//==============================================================================
-// Utility
-//==============================================================================
-
-void AudioEngine::clearOutputBuffer(float* const* outputChannelData,
-                                    int numChannels, int numSamples)
+void AudioEngine::installChannel(int index, std::unique_ptr<Channel> channel)
 {
-    for (int ch = 0; ch < numChannels; ++ch)
-        if (outputChannelData[ch])
-            juce::FloatVectorOperations::clear(outputChannelData[ch], numSamples);
+    const juce::ScopedLock sl(channelSwapLock);
+    channels[static_cast<size_t>(index)].publish(channel.get());
+    channelOwners[static_cast<size_t>(index)] = std::move(channel);
 }
 
-//==============================================================================
-// Channel Management (Message Thread)
-//==============================================================================
-
 Channel* AudioEngine::getChannel(int index)
 {
-    return (index >= 0 && index < 6) ? channels[index].get() : nullptr;
+    return (index >= 0 && index < channelCount) ? channels[index].get() : nullptr;
 }
 
 void AudioEngine::setChannelType(int index, ChannelType type)
 {
-    if (index < 0 || index >= 6) return;
-    if (channels[index] && channels[index]->getType() == type) return;
-
-    const bool wasPlaying = isPlaying();
-    if (wasPlaying) setPlaying(false);
-
-    // Wait for the audio thread to finish any in-flight processBlock() on the old
-    // channel before we destroy it.  setPlaying(false) only sets a flag — the IO
-    // callback continues running.  Sleep for two block periods to ensure at least
-    // one full callback completes after the flag was set.
-    const int blockMs = (currentBufferSize > 0 && currentSampleRate > 0)
-                      ? static_cast<int>(currentBufferSize * 1000.0 / currentSampleRate) + 5
-                      : 15;
-    juce::Thread::sleep(blockMs * 2);
+    if (index < 0 || index >= channelCount) return;
+    const auto* current = channelOwners[index].get();   // message thread: the owner is authoritative
+    if (current && current->getType() == type) return;
+
+    // The new channel binds the spare hot-state slot: the old one keeps writing
+    // its own until it has left the audio block.  The spare's previous owner
+    // must be gone — after two swaps within one block, finish this one once it is.
+    const int oldSlot = hotState.slotOf(index);
+    const int newSlot = hotState.spareSlotOf(index);
+    reclaimer.reclaim();
+    if (hotSlotRetiring[static_cast<size_t>(newSlot)])
+    {
+        DBG("Channel " + juce::String(index) + ": previous swap still in the audio block, type change deferred");
+        reclaimer.whenSafe([this, index, type] { setChannelType(index, type); });
+        return;
+    }
+    hotState.reset(newSlot);   // fresh defaults, as a new object would have
 
     // Create and fully prepare the new channel BEFORE installing it, so the audio
     // thread never encounters it with uninitialised (zero-size) buffers.
-    auto newChannel = (type == ChannelType::Audio)
-                      ? std::unique_ptr<Channel>(std::make_unique<AudioChannel>(index))
-                      : std::unique_ptr<Channel>(std::make_unique<VSTiChannel>(index));
+    auto newChannel = createChannel(index, type, newSlot);
 
     if (isInitialised.load(std::memory_order_relaxed))
     {
@@ -1279,9 +2441,37 @@ void AudioEngine::setChannelType(int index, ChannelType type)
         newChannel->prepareToPlay(currentSampleRate, currentBufferSize, maxSamples);
     }
 
-    channels[index] = std::move(newChannel);
+    std::unique_ptr<Channel> oldChannel;
+    {
+        const juce::ScopedLock sl(channelSwapLock);
+        if (current)
+            newChannel->setLayerConsolidation(current->getMaxOverdubLayers(), current->getUndoDepth());
+        hotState.setLiveSlot(index, newSlot);
+        channels[index].publish(newChannel.get());   // release: the prepared channel, never a null slot
+        oldChannel           = std::move(channelOwners[index]);
+        channelOwners[index] = std::move(newChannel);
+    }
+
+    requestSectionAllocation();
+
+    // The audio thread may still be processing the old channel in this block.
+    // Once it has finished, keep its plugins for reuse (e.g. the next song's VSTi).
+    hotSlotRetiring[static_cast<size_t>(oldSlot)] = true;
+    reclaimer.retire(std::move(oldChannel), [this, oldSlot](std::unique_ptr<Channel> old)
+    {
+        hotSlotRetiring[static_cast<size_t>(oldSlot)] = false;
+        if (old->getType() == ChannelType::VSTi)
+            pluginPool->park(static_cast<VSTiChannel*>(old.get())->detachVSTi());
+        for (int slot = 0; slot < 3; ++slot)
+        {
+            auto plugin = old->detachPlugin(slot);
+            if (plugin) plugin->removeListener(this);
+            pluginPool->park(std::move(plugin));
+        }
+    });
 
-    if (wasPlaying) setPlaying(true);
+    updateDelayCompensation();   // the new channel starts without plugins
+    updateRecordLatency();
 
     DBG("Channel " + juce::String(index) + " → " +
         (type == ChannelType::Audio ? "Audio" : "VSTi"));
@@ -1289,9 +2479,8 @@ void AudioEngine::setChannelType(int index, ChannelType type)
 
 ChannelType AudioEngine::getChannelType(int index) const
 {
-    return (index >= 0 && index < 6 && channels[index])
-           ? channels[index]->getType()
-           : ChannelType::Audio;
+    const auto* ch = (index >= 0 && index < channelCount) ? channels[index].get() : nullptr;
+    return ch ? ch->getType() : ChannelType::Audio;
 }
 
 //==============================================================================
@@ -1301,10 +2490,10 @@ ChannelType AudioEngine::getChannelType(int index) const
 void AudioEngine::loadPluginAsync(int channelIndex,
                                    int slotIndex,
                                    const juce::String& pluginIdentifier,
-                                   const juce::String& stateBase64,
+                                   const PluginStateSource& state,
                                    bool bypassed)
 {
-    if (channelIndex < 0 || channelIndex >= 6)
+    if (channelIndex < 0 || channelIndex >= channelCount)
     {
         DBG("loadPluginAsync: invalid channel " + juce::String(channelIndex));
         return;
@@ -1321,77 +2510,187 @@ void AudioEngine::loadPluginAsync(int channelIndex,
         return;
     }
 
+    const bool hasState = !state.isEmpty();
     DBG("loadPluginAsync: " + description.name +
         " → ch " + juce::String(channelIndex) +
         " slot " + juce::String(slotIndex) +
-        (stateBase64.isNotEmpty() ? " (with saved state)" : ""));
+        (hasState ? " (with saved state)" : ""));
 
     ++pendingPluginLoads;
     if (onPluginLoadStart)
         onPluginLoadStart(channelIndex, slotIndex, description.name);
 
-    pluginHost->loadPluginAsync(
-        description,
-        currentSampleRate,
-        currentBufferSize,
-        [this, channelIndex, slotIndex, stateBase64, bypassed, descName = description.name]
-        (std::unique_ptr<juce::AudioPluginInstance> plugin, const juce::String& error)
+    // The state is read while the instance is being created or freed up
+    const auto stateBlock = hasState ? readPluginStateAsync(state) : std::shared_future<juce::MemoryBlock>();
+
+    // A fresh instance whose state did not restore plays its default patch: say so
+    auto onRestored = [this, channelIndex, slotIndex, bypassed]
+                      (std::unique_ptr<juce::AudioPluginInstance> plugin, bool restored)
+    {
+        if (!restored)
         {
-            if (!plugin)
-            {
-                --pendingPluginLoads;
-                DBG("loadPluginAsync: failed — " + error);
-                if (onPluginLoadError)
-                    onPluginLoadError(channelIndex, slotIndex,
-                                      "Could not load: " + descName);
-                return;
-            }
+            DBG("loadPluginAsync: state restore failed — ch " +
+                juce::String(channelIndex) + " slot " + juce::String(slotIndex));
+            if (onPluginLoadError)
+                onPluginLoadError(channelIndex, slotIndex,
+                                  "Saved settings could not be restored: " + plugin->getName());
+        }
 
-            // Restore saved state BEFORE handing off to channel
-            if (stateBase64.isNotEmpty())
+        --pendingPluginLoads;
+        installPlugin(channelIndex, slotIndex, std::move(plugin), bypassed);
+    };
+
+    auto loadFresh = [this, channelIndex, slotIndex, hasState, stateBlock, onRestored, bypassed, description]
+    {
+        pluginHost->loadPluginAsync(
+            description,
+            currentSampleRate,
+            currentBufferSize,
+            [this, channelIndex, slotIndex, hasState, stateBlock, onRestored, bypassed, descName = description.name]
+            (std::unique_ptr<juce::AudioPluginInstance> plugin, const juce::String& error)
             {
-                const auto stateBlock = PluginHostWrapper::base64ToMemoryBlock(stateBase64);
-                if (!pluginHost->loadPluginState(plugin.get(), stateBlock))
-                    DBG("loadPluginAsync: state restore failed — ch " +
-                        juce::String(channelIndex) + " slot " + juce::String(slotIndex));
-            }
+                if (!plugin)
+                {
+                    --pendingPluginLoads;
+                    DBG("loadPluginAsync: failed — " + error);
+                    if (onPluginLoadError)
+                        onPluginLoadError(channelIndex, slotIndex,
+                                          "Could not load: " + descName);
+                    return;
+                }
 
-            --pendingPluginLoads;
+                // Restore saved state BEFORE handing off to channel
+                if (hasState)
+                {
+                    pluginPool->restoreStateAsync(std::move(plugin), stateBlock, onRestored);
+                    return;
+                }
 
-            auto* channel = channels[channelIndex].get();
-            if (!channel)
-            {
-                DBG("loadPluginAsync: channel " + juce::String(channelIndex) +
-                    " no longer exists");
-                return;
-            }
+                --pendingPluginLoads;
+                installPlugin(channelIndex, slotIndex, std::move(plugin), bypassed);
+            });
+    };
+
+    // Reuse: an instance of this plugin already exists — only push the new state
+    if (hasState)
+    {
+        if (auto reused = takeReusablePlugin(channelIndex, slotIndex, pluginIdentifier))
+        {
+            DBG("loadPluginAsync: reusing " + reused->getName());
 
-            if (slotIndex == -1)
+            // Not restored, it would still hold the previous song's state: a fresh instance instead
+            auto onReusedRestored = [onRestored, loadFresh]
+                                    (std::unique_ptr<juce::AudioPluginInstance> plugin, bool restored)
             {
-                if (channel->getType() == ChannelType::VSTi)
+                if (restored)
                 {
-                    static_cast<VSTiChannel*>(channel)->setVSTi(std::move(plugin));
-                    DBG("VSTi loaded -> ch " + juce::String(channelIndex));
+                    onRestored(std::move(plugin), true);
+                    return;
                 }
-                else
+                DBG("loadPluginAsync: reused " + plugin->getName() + " did not take the state, loading anew");
+                plugin.reset();
+                loadFresh();
+            };
+
+            // Taken out of the slot it played in: restore only after that block has ended
+            reclaimer.retire(std::move(reused),
+                [this, stateBlock, onReusedRestored]
+                (std::unique_ptr<juce::AudioPluginInstance> instance)
                 {
-                    DBG("loadPluginAsync: cannot load VSTi into Audio channel");
-                }
-            }
-            else
+                    pluginPool->restoreStateAsync(std::move(instance), stateBlock, onReusedRestored);
+                });
+            return;
+        }
+    }
+
+    loadFresh();
+}
+
+std::shared_future<juce::MemoryBlock> AudioEngine::readPluginStateAsync(const PluginStateSource& state)
+{
+    auto task = std::make_shared<std::packaged_task<juce::MemoryBlock()>>([state] { return state.load(); });
+    auto result = task->get_future().share();
+    pluginStateReaders.addJob([task] { (*task)(); });
+    return result;
+}
+
+std::unique_ptr<juce::AudioPluginInstance> AudioEngine::takeReusablePlugin(int channelIndex,
+                                                                           int slotIndex,
+                                                                           const juce::String& identifier)
+{
+    // The instance already in this slot is the cheapest one to reuse: take it
+    // out so its state is never written while the audio thread processes it
+    if (auto* channel = channels[channelIndex].get())
+    {
+        if (slotIndex == -1)
+        {
+            if (channel->getType() == ChannelType::VSTi)
             {
-                channel->addPlugin(slotIndex, std::move(plugin));
-                if (bypassed)
-                    channel->setPluginBypassed(slotIndex, true);
-                DBG("FX loaded → ch " + juce::String(channelIndex) +
-                    " slot " + juce::String(slotIndex));
+                auto* vstiChannel = static_cast<VSTiChannel*>(channel);
+                if (auto* current = vstiChannel->getVSTi();
+                    current != nullptr && PluginInstancePool::identifierOf(*current) == identifier)
+                    return vstiChannel->detachVSTi();
             }
-        });
+        }
+        else if (auto* current = channel->getPlugin(slotIndex);
+                 current != nullptr && PluginInstancePool::identifierOf(*current) == identifier)
+        {
+            return channel->detachPlugin(slotIndex);
+        }
+    }
+
+    return pluginPool->take(identifier);
+}
+
+void AudioEngine::installPlugin(int channelIndex, int slotIndex,
+                                std::unique_ptr<juce::AudioPluginInstance> plugin, bool bypassed)
+{
+    auto* channel = channels[channelIndex].get();
+    if (!channel)
+    {
+        DBG("loadPluginAsync: channel " + juce::String(channelIndex) +
+            " no longer exists");
+        pluginPool->park(std::move(plugin));
+        return;
+    }
+
+    if (slotIndex == -1)
+    {
+        if (channel->getType() == ChannelType::VSTi)
+        {
+            retireToPool(static_cast<VSTiChannel*>(channel)->setVSTi(std::move(plugin)));
+            DBG("VSTi loaded -> ch " + juce::String(channelIndex));
+        }
+        else
+        {
+            DBG("loadPluginAsync: cannot load VSTi into Audio channel");
+            pluginPool->park(std::move(plugin));
+        }
+    }
+    else
+    {
+        plugin->addListener(this);   // latency it reports later, see audioProcessorChanged()
+        retireToPool(channel->addPlugin(slotIndex, std::move(plugin)));
+        if (bypassed)
+            channel->setPluginBypassed(slotIndex, true);
+        DBG("FX loaded → ch " + juce::String(channelIndex) +
+            " slot " + juce::String(slotIndex));
+        updateDelayCompensation();
+    }
+}
+
+void AudioEngine::retireToPool(std::unique_ptr<juce::AudioPluginInstance> plugin)
+{
+    if (plugin) plugin->removeListener(this);
+    reclaimer.retire(std::move(plugin), [this](std::unique_ptr<juce::AudioPluginInstance> p)
+    {
+        pluginPool->park(std::move(p));
+    });
 }
 
 void AudioEngine::removePlugin(int channelIndex, int slotIndex)
 {
-    if (channelIndex < 0 || channelIndex >= 6) return;
+    if (channelIndex < 0 || channelIndex >= channelCount) return;
     auto* channel = channels[channelIndex].get();
     if (!channel) return;
 
@@ -1399,16 +2698,92 @@ void AudioEngine::removePlugin(int channelIndex, int slotIndex)
     {
         if (channel->getType() == ChannelType::VSTi)
         {
-            static_cast<VSTiChannel*>(channel)->removeVSTi();
+            retireToPool(static_cast<VSTiChannel*>(channel)->detachVSTi());
             DBG("VSTi removed from ch " + juce::String(channelIndex));
         }
     }
     else if (slotIndex >= 0 && slotIndex < 3)
     {
-        channel->removePlugin(slotIndex);
+        retireToPool(channel->detachPlugin(slotIndex));
         DBG("FX removed from ch " + juce::String(channelIndex) +
             " slot " + juce::String(slotIndex));
     }
+    updateDelayCompensation();
+}
+
+void AudioEngine::updateDelayCompensation()
+{
+    bool changed = false;
+    int  slowest = 0;
+    for (int i = 0; i < channelCount; ++i)
+    {
+        if (auto* ch = channels[static_cast<size_t>(i)].get())
+        {
+            changed |= ch->updateFxLatency();
+            slowest  = juce::jmax(slowest, ch->getFxLatencySamples());
+        }
+    }
+
+    // Chains beyond the delay line's reach are aligned as far as it goes
+    slowest = juce::jmin(slowest, CompensationDelay::kMaxDelaySamples);
+    const bool engineChanged = pdcLatency.exchange(slowest, std::memory_order_relaxed) != slowest;
+
+    // Always set: a channel that was just created reports no change of its own
+    for (int i = 0; i < channelCount; ++i)
+        if (auto* ch = channels[static_cast<size_t>(i)].get())
+            ch->setCompensationDelay(slowest - ch->getFxLatencySamples());
+
+    if (engineChanged)
+        updateRecordLatency();   // the player hears the loop this much later too
+    if (changed || engineChanged)
+        DBG("PDC: engine latency " + juce::String(slowest) + " samples");
+}
+
+void AudioEngine::audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails& details)
+{
+    if (!details.latencyChanged) return;
+
+    // Any thread, the audio thread included: posting a message may lock there
+    if (juce::MessageManager::existsAndIsCurrentThread())
+        triggerAsyncUpdate();
+    else
+        fxLatencyChanged.store(true, std::memory_order_release);
+}
+
+void AudioEngine::handleAsyncUpdate()
+{
+    updateDelayCompensation();
+}
+
+void AudioEngine::setRecordLatencyOverride(int samples)
+{
+    recordLatencyOverride = juce::jmax(-1, samples);
+    updateRecordLatency();
+}
+
+void AudioEngine::updateRecordLatency()
+{
+    const int pdc       = pdcLatency.load(std::memory_order_relaxed);
+    const int roundTrip = recordLatencyOverride >= 0 ? recordLatencyOverride
+                                                     : deviceInputLatency + deviceOutputLatency;
+    const int audioShift = roundTrip + pdc;
+    const int vstiShift  = deviceOutputLatency + pdc;   // MIDI in has no audio input latency
+
+    recordLatencySamples.store(audioShift, std::memory_order_relaxed);
+    for (int i = 0; i < channelCount; ++i)
+        if (auto* ch = channels[static_cast<size_t>(i)].get())
+            ch->setRecordLatency(ch->getType() == ChannelType::VSTi ? vstiShift : audioShift);
+}
+
+void AudioEngine::startLatencyMeasurement()
+{
+    latencyProbe.start(currentSampleRate);
+}
+
+int AudioEngine::getLatencyMeasurement() const
+{
+    if (latencyProbe.isRunning()) return -2;
+    return latencyProbe.getState() == LatencyProbe::State::Done ? latencyProbe.getResult() : -1;
 }
 
 //==============================================================================
@@ -1473,6 +2848,12 @@ float AudioEngine::getMetronomeGain() const    { return metronome->getMasterGain
 void AudioEngine::setMasterGain(float gain)    { masterGain.store(juce::jlimit(0.0f, 1.0f, gain), std::memory_order_release); }
 float AudioEngine::getMasterGain() const       { return masterGain.load(std::memory_order_relaxed); }
 
+void AudioEngine::setChannelGain(int channelIndex, float gainDb)
+{
+    if (auto* ch = getChannel(channelIndex))
+        ch->setGainDb(gainDb);
+}
+
 //==============================================================================
 // Master Recording (Message Thread)
 //==============================================================================
@@ -1485,7 +2866,8 @@ bool AudioEngine::startMasterRecording(const juce::File& directory)
     if (!directory.createDirectory())
         return false;
 
-    auto filename = "master_" + juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S") + ".wav";
+    const auto stamp = juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S");
+    auto filename = "master_" + stamp + ".wav";
     masterRecordFile = directory.getChildFile(filename);
 
     juce::WavAudioFormat wavFormat;
@@ -1502,6 +2884,15 @@ bool AudioEngine::startMasterRecording(const juce::File& directory)
     masterRecordThread.startThread();
     masterRecordWriter.reset(new juce::AudioFormatWriter::ThreadedWriter(writer, masterRecordThread, 65536));
     masterRecordingActive.store(true, std::memory_order_release);
+
+    // Stems start on the next block boundary; a failure leaves the master running
+    if (recordStems)
+    {
+        const auto r = stemRecorder.start(directory.getChildFile("stems_" + stamp), "stem", currentSampleRate,
+                                          channelCount);
+        if (r.failed())
+            DBG("Stem recording not started: " + r.getErrorMessage());
+    }
     return true;
 }
 
@@ -1510,6 +2901,7 @@ void AudioEngine::stopMasterRecording()
     masterRecordingActive.store(false, std::memory_order_release);
     masterRecordWriter.reset();
     masterRecordThread.stopThread(2000);
+    stemRecorder.stop();
 }
 
 bool AudioEngine::isMasterRecording() const
@@ -1522,14 +2914,257 @@ juce::File AudioEngine::getMasterRecordFile() const
     return masterRecordFile;
 }
 
+//==============================================================================
+// Offline Bounce (Bounce Thread)
+//==============================================================================
+
+juce::Result AudioEngine::bounceOffline(const BounceSettings& settings,
+                                        const std::function<bool(double)>& progress)
+{
+    //--- 1. CHECK + OPEN THE MIXDOWN -------------------------------------------
+    if (!isInitialised.load(std::memory_order_acquire) || currentSampleRate <= 0.0)
+        return juce::Result::fail("No audio device");
+    if (bounceActive.load(std::memory_order_relaxed))
+        return juce::Result::fail("A bounce is already running");
+    if (isPlayingFlag.load(std::memory_order_relaxed) || countInActive.load(std::memory_order_relaxed)
+        || masterRecordingActive.load(std::memory_order_relaxed))
+        return juce::Result::fail("Stop the transport and the master recording first");
+
+    const int startSection = activeGlobalSection.load(std::memory_order_relaxed);
+    std::array<juce::int64, NUM_SECTIONS> lengths {};
+    juce::int64 loopFrames = 0;
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        // The active section's length lives in the loop engine until the next switch
+        lengths[s] = (s == startSection) ? loopEngine->getLoopLength() : getSectionLoopLength(s);
+        if (lengths[s] > 0 && settings.loops[s] > 0)
+            loopFrames += lengths[s] * settings.loops[s];
+    }
+    if (loopFrames <= 0)
+        return juce::Result::fail("Nothing to bounce: the chosen sections are empty");
+
+    if (!settings.directory.createDirectory())
+        return juce::Result::fail("Cannot create: " + settings.directory.getFullPathName());
+
+    const auto stamp = juce::Time::getCurrentTime().formatted("%Y-%m-%d_%H-%M-%S");
+    const auto file  = settings.directory.getChildFile("bounce_" + stamp + ".wav");
+    const double sampleRate = currentSampleRate;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer;
+    {
+        juce::WavAudioFormat wavFormat;
+        auto fileStream = file.createOutputStream(StemRecorder::kDiskBufferBytes);
+        if (fileStream)
+            writer.reset(wavFormat.createWriterFor(fileStream.get(), sampleRate, 2, 24, {}, 0));
+        if (!writer)
+            return juce::Result::fail("Cannot create: " + file.getFullPathName());
+        fileStream.release();   // writer now owns the stream
+    }
+
+    //--- 2. TAKE THE ENGINE OVER FROM THE DEVICE -------------------------------
+    auto* device = deviceManager.getCurrentAudioDevice();
+    bounceDeviceParked.store(false, std::memory_order_relaxed);
+    bounceActive.store(true, std::memory_order_release);
+
+    // The callback parks at the start of its next block, so the one it was in has ended
+    if (device != nullptr && device->isPlaying())
+    {
+        for (int i = 0; i < 1000 && !bounceDeviceParked.load(std::memory_order_acquire); ++i)
+            juce::Thread::sleep(1);
+
+        if (!bounceDeviceParked.load(std::memory_order_acquire))
+        {
+            bounceActive.store(false, std::memory_order_release);
+            writer.reset();
+            file.deleteFile();
+            return juce::Result::fail("The audio device does not respond");
+        }
+    }
+
+    // Every section stays unpacked while the bounce runs
+    const bool compression = sectionCompression.exchange(false, std::memory_order_acq_rel);
+
+    const int numOuts   = juce::jmax(2, numOutputChannels);
+    const int blockSize = prepareForBounce(settings);
+
+    for (auto& published : channels)
+        if (auto* ch = published.get()) ch->setNonRealtime(true);
+
+    // Channels render in parallel even if the live engine runs them serially
+    const bool wasParallel = parallelProcessing.load(std::memory_order_relaxed);
+    if (!wasParallel)
+        setParallelProcessing(true);
+
+    juce::String error;
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        if (settings.loops[s] > 0 && lengths[s] > 0 && !isSectionResident(s))
+            error = "Section " + juce::String::charToString(static_cast<juce::juce_wchar>('A' + s))
+                  + " could not be unpacked";
+
+    if (error.isEmpty() && settings.stems)
+    {
+        const auto r = stemRecorder.start(settings.directory.getChildFile("bounce_" + stamp + "_stems"),
+                                          "bounce", sampleRate, channelCount);
+        if (r.failed())
+            error = r.getErrorMessage();
+        else
+            stemRecorder.endBlock(0);   // we are the audio thread: capture from the first block on
+    }
+
+    //--- 3. RENDER -------------------------------------------------------------
+    const int pdc = pdcLatency.load(std::memory_order_relaxed);
+    const juce::int64 tailFrames  = static_cast<juce::int64>(juce::jmax(0.0, settings.tailSeconds) * sampleRate);
+    const juce::int64 totalFrames = loopFrames + tailFrames + pdc;
+    juce::int64 rendered = 0;   // PDC head included
+
+    juce::AudioBuffer<float> block(numOuts, blockSize);
+    juce::AudioBuffer<float> mix  (2,       blockSize);
+
+    auto renderFrames = [&](juce::int64 numFrames)
+    {
+        while (numFrames > 0 && error.isEmpty())
+        {
+            const int n = static_cast<int>(juce::jmin<juce::int64>(blockSize, numFrames));
+
+            // Stems: wait for the writer thread instead of dropping
+            if (settings.stems)
+                for (int i = 0; i < 5000 && stemRecorder.getMinFreeSpace() < n; ++i)
+                    juce::Thread::sleep(1);
+
+            processDeviceBlock(nullptr, 0, block.getArrayOfWritePointers(), numOuts, n);
+
+            // Folded to stereo as for the master recording; master gain is already in
+            mix.clear();
+            for (int ch = 0; ch < numOuts; ++ch)
+                mix.addFrom(ch & 1, 0, block, ch, 0, n);
+
+            // The first pdc frames are the compensation delay, not the song
+            const int skip = static_cast<int>(juce::jlimit<juce::int64>(0, n, pdc - rendered));
+            if (skip < n)
+            {
+                const float* part[] = { mix.getReadPointer(0, skip), mix.getReadPointer(1, skip) };
+                if (!writer->writeFromFloatArrays(part, 2, n - skip))
+                    error = "Write failed: " + file.getFullPathName();
+            }
+
+            rendered  += n;
+            numFrames -= n;
+            if (progress && !progress(static_cast<double>(rendered) / static_cast<double>(totalFrames)))
+                error = "Bounce cancelled";
+        }
+    };
+
+    bool first = true;
+    for (int s = 0; s < NUM_SECTIONS && error.isEmpty(); ++s)
+    {
+        if (settings.loops[s] <= 0 || lengths[s] <= 0) continue;
+
+        // Right at the previous section's last loop end, as a live switch would land
+        Command c;
+        c.type      = CommandType::SetActiveSection;
+        c.intValue1 = s;
+        processGlobalCommand(c);
+        if (first)
+            loopEngine->resetPlayhead();
+        first = false;
+
+        isPlayingFlag.store(true, std::memory_order_release);
+        for (auto& published : channels)
+            if (auto* ch = published.get(); ch && !ch->isOneShot() && ch->sectionHasContent(s) && ch->getState() != ChannelState::Playing)
+                ch->startPlayback();
+
+        renderFrames(lengths[s] * settings.loops[s]);
+    }
+
+    // Stopped as with the Stop button; the FX tails (and the PDC delay) ring out
+    isPlayingFlag.store(false, std::memory_order_release);
+    renderFrames(tailFrames + pdc);
+
+    //--- 4. HAND BACK TO THE DEVICE --------------------------------------------
+    for (auto& published : channels)
+        if (auto* ch = published.get(); ch && ch->getState() == ChannelState::Playing)
+            ch->stopPlayback();   // a cancelled bounce stops mid-loop
+
+    Command c;
+    c.type      = CommandType::SetActiveSection;
+    c.intValue1 = startSection;
+    processGlobalCommand(c);
+    loopEngine->resetPlayhead();
+
+    if (settings.stems)
+    {
+        stemRecorder.stop();
+        stemRecorder.endBlock(0);                  // we are the audio thread: capture ends here
+        if (!stemRecorder.waitUntilClosed(10000))
+            DBG("Bounce: stem files still being written");
+    }
+    writer.reset();   // flush & close
+
+    if (!wasParallel)
+        setParallelProcessing(false);
+    for (auto& published : channels)
+        if (auto* ch = published.get()) ch->setNonRealtime(false);
+    sectionCompression.store(compression, std::memory_order_release);
+
+    restoreAfterBounce();
+    bounceActive.store(false, std::memory_order_release);
+
+    if (error.isNotEmpty())
+    {
+        file.deleteFile();
+        if (settings.stems)
+            settings.directory.getChildFile("bounce_" + stamp + "_stems").deleteRecursively();
+        DBG("Bounce failed: " + error);
+        return juce::Result::fail(error);
+    }
+
+    bounceFile = file;
+    DBG("Bounced " + juce::String(static_cast<double>(rendered - pdc) / sampleRate, 1) + " s to "
+        + file.getFullPathName());
+    return juce::Result::ok();
+}
+
+int AudioEngine::prepareForBounce(const BounceSettings& settings)
+{
+    // Unpack what will play; compression is off until restoreAfterBounce()
+    {
+        const juce::ScopedLock sl(channelSwapLock);
+        for (auto& published : channels)
+            if (auto* ch = published.get())
+                for (int s = 0; s < NUM_SECTIONS; ++s)
+                    if (settings.loops[s] > 0)
+                        ch->restoreSectionNow(s);
+    }
+
+    // Offline blocks neither advance the sample clock nor touch held commands,
+    // the MIDI collector or the clock anchor (see processDeviceBlock())
+    bounceSampleClock = totalSamplesProcessed.load(std::memory_order_relaxed);
+    bounceStartMs     = juce::Time::getMillisecondCounterHiRes();
+    profiler.setPaused(true);   // offline blocks have no realtime budget
+
+    // Channels and plugins stay prepared for the device block; a bounce block never exceeds it
+    return juce::jlimit(1, juce::jmax(1, currentBufferSize), settings.blockSize);
+}
+
+void AudioEngine::restoreAfterBounce()
+{
+    profiler.setPaused(false);
+
+    // The device clock ran on while parked: commands stamped meanwhile are due now
+    const auto parkedMs = juce::Time::getMillisecondCounterHiRes() - bounceStartMs;
+    totalSamplesProcessed.store(bounceSampleClock
+                                    + static_cast<juce::int64>(juce::jmax(0.0, parkedMs) * 0.001 * currentSampleRate),
+                                std::memory_order_relaxed);
+}
+
 //==============================================================================
 // Song Reset (Message Thread)
 //==============================================================================
 
 bool AudioEngine::hasAnyRecordings() const
 {
-    for (const auto& ch : channels)
-        if (ch && ch->hasContentInAnySection())
+    for (const auto& published : channels)
+        if (auto* ch = published.get(); ch && ch->hasContentInAnySection())
             return true;
     return false;
 }
@@ -1556,7 +3191,7 @@ void AudioEngine::resetSong()
 
 void AudioEngine::setChannelMuteGroup(int channelIndex, int group)
 {
-    if (channelIndex < 0 || channelIndex >= 6) return;
+    if (channelIndex < 0 || channelIndex >= channelCount) return;
     if (group < 0 || group > 4) return;
 
     const int oldGroup = channelMuteGroup[channelIndex];
@@ -1574,7 +3209,7 @@ void AudioEngine::setChannelMuteGroup(int channelIndex, int group)
 
 int AudioEngine::getChannelMuteGroup(int channelIndex) const
 {
-    if (channelIndex < 0 || channelIndex >= 6) return 0;
+    if (channelIndex < 0 || channelIndex >= channelCount) return 0;
     return channelMuteGroup[channelIndex];
 }
 
@@ -1596,7 +3231,7 @@ void AudioEngine::setMuteGroupActive(int groupIndex, bool active)
     muteGroupActive[groupIndex] = active;
 
     const int group = groupIndex + 1;  // 1-based
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < channelCount; ++i)
     {
         if (channelMuteGroup[i] == group)
         {
@@ -1610,6 +3245,118 @@ void AudioEngine::setMuteGroupActive(int groupIndex, bool active)
 // Auto-Start (Message Thread)
 //==============================================================================
 
+//==============================================================================
+// Auto-Start (Audio Thread)
+//==============================================================================
+
+namespace
+{
+    /** Index of the first |x| >= threshold in data, or num. Scans 64-sample tiles with SIMD min/max. */
+    int findFirstOver(const float* data, int num, float threshold) noexcept
+    {
+        constexpr int kTile = 64;
+        for (int i = 0; i < num; i += kTile)
+        {
+            const int n = juce::jmin(kTile, num - i);
+            const auto r = juce::FloatVectorOperations::findMinAndMax(data + i, n);
+            if (r.getEnd() < threshold && -r.getStart() < threshold)
+                continue;
+
+            for (int j = i; j < i + n; ++j)
+                if (std::abs(data[j]) >= threshold)
+                    return j;
+        }
+        return num;
+    }
+}
+
+int AudioEngine::findAutoStartOnset(const float* const* inputs, int numIns, int numSamples) const noexcept
+{
+    const float threshold = autoStartThresholdLinear.load(std::memory_order_relaxed);
+
+    // Earliest crossing over all inputs; later channels only search before it
+    int onset = numSamples;
+    for (int ch = 0; ch < numIns && onset > 0; ++ch)
+        if (inputs[ch])
+            onset = findFirstOver(inputs[ch], onset, threshold);
+
+    return onset < numSamples ? onset : -1;
+}
+
+void AudioEngine::pushPreRoll(const float* const* inputs, int numIns, int numSamples) noexcept
+{
+    if (preRollCapacity <= 0) return;
+    numIns = juce::jmin(numIns, preRollRing.getNumChannels());
+
+    // Only the newest preRollCapacity samples can ever be used
+    const int skip = juce::jmax(0, numSamples - preRollCapacity);
+
+    // Every sample goes to [w] and [w + capacity]: any window up to the capacity is contiguous
+    for (int done = skip; done < numSamples;)
+    {
+        const int n = juce::jmin(numSamples - done, preRollCapacity - preRollWrite);
+        for (int ch = 0; ch < numIns; ++ch)
+        {
+            if (inputs[ch])
+            {
+                preRollRing.copyFrom(ch, preRollWrite,                   inputs[ch] + done, n);
+                preRollRing.copyFrom(ch, preRollWrite + preRollCapacity, inputs[ch] + done, n);
+            }
+            else
+            {
+                preRollRing.clear(ch, preRollWrite, n);
+                preRollRing.clear(ch, preRollWrite + preRollCapacity, n);
+            }
+        }
+        preRollWrite = (preRollWrite + n) % preRollCapacity;
+        done += n;
+    }
+    preRollFilled = juce::jmin(preRollCapacity, preRollFilled + numSamples - skip);
+}
+
+void AudioEngine::triggerAutoStart(int samplesFromOnset)
+{
+    // A timed command at the same sample may have started the transport already
+    if (isPlayingFlag.load(std::memory_order_relaxed) || countInActive.load(std::memory_order_relaxed))
+        return;
+    autoStartTriggered = true;
+
+    const int activeIdx = activeChannelIndex.load(std::memory_order_relaxed);
+    auto* ch = (activeIdx >= 0 && activeIdx < channelCount) ? channels[activeIdx].get() : nullptr;
+
+    // Pre-roll only for a free first take: on a metronome grid beat 1 is the onset itself
+    const bool freeFirstTake = loopEngine->getLoopLength() == 0 && !metronome->getEnabled();
+
+    Command cmd = Command::startRecord(activeIdx);
+    processCommand(cmd);
+
+    if (!freeFirstTake || ch == nullptr || ch->isOneShot()
+        || ch->getState() != ChannelState::Recording || countInActive.load(std::memory_order_relaxed))
+        return;
+
+    // The ring already holds this block; the window ends at the onset sample
+    const int len = juce::jmin(preRollLength, preRollFilled - samplesFromOnset);
+    if (len <= 0) return;
+
+    const int end   = (preRollWrite - samplesFromOnset + preRollCapacity) % preRollCapacity;
+    const int first = end + preRollCapacity - len;
+    const int numIns = juce::jmin(numInputChannels, preRollRing.getNumChannels(),
+                                  static_cast<int>(preRollInputs.size()));
+
+    // Splice in block-sized pieces (the channel routes them like live input)
+    for (int done = 0; done < len;)
+    {
+        const int n = juce::jmin(len - done, currentBufferSize);
+        for (int i = 0; i < numIns; ++i)
+            preRollInputs[static_cast<size_t>(i)] = preRollRing.getReadPointer(i, first + done);
+        ch->recordPreRoll(preRollInputs.data(), numIns, n, done);
+        done += n;
+    }
+
+    // Loop position len is the onset: live recording continues right after the pre-roll
+    loopEngine->setPlayhead(len);
+}
+
 void AudioEngine::setAutoStart(bool enabled, float thresholdDb)
 {
     autoStartEnabled.store(enabled, std::memory_order_release);
@@ -1642,12 +3389,12 @@ int  AudioEngine::getFixedLengthBars() const   { return fixedLengthBars.load(std
 
 juce::String AudioEngine::getChannelName(int index) const
 {
-    return (index >= 0 && index < 6) ? channelNames[index] : juce::String();
+    return (index >= 0 && index < channelCount) ? channelNames[index] : juce::String();
 }
 
 void AudioEngine::setChannelName(int index, const juce::String& name)
 {
-    if (index >= 0 && index < 6)
+    if (index >= 0 && index < channelCount)
         channelNames[index] = name.trim().isEmpty()
                               ? "CH " + juce::String(index + 1)
                               : name.trim();
@@ -1669,7 +3416,7 @@ void AudioEngine::setActiveSection(int section)
     }
 
     // Stop any recording/overdubbing channels first
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < channelCount; ++i)
     {
         auto* ch = channels[i].get();
         if (!ch) continue;
@@ -1678,9 +3425,8 @@ void AudioEngine::setActiveSection(int section)
             sendCommand(Command::stopRecord(i));
     }
 
-    // Pre-allocate section buffers for all channels
-    for (auto& ch : channels)
-        if (ch) ch->allocateSection(section);
+    // Section buffers are sized in the background; the switch itself does not wait
+    requestSectionAllocation(1 << section);
 
     const bool latch = latchMode.load(std::memory_order_relaxed);
     const bool playing = isPlayingFlag.load(std::memory_order_relaxed);
@@ -1713,9 +3459,15 @@ void AudioEngine::setSectionLoopLength(int s, juce::int64 len)
         sectionLoopLengths[s].store(len, std::memory_order_release);
 }
 
+void AudioEngine::requestSectionAllocation(int sectionMask) noexcept
+{
+    sectionAllocRequests.fetch_or(sectionMask & ((1 << NUM_SECTIONS) - 1), std::memory_order_acq_rel);
+    backgroundThread.moveToFrontOfQueue(this);
+}
+
 void AudioEngine::queueRecordForPendingSection(int channelIndex, bool isOverdub)
 {
-    if (channelIndex < 0 || channelIndex >= 6) return;
+    if (channelIndex < 0 || channelIndex >= channelCount) return;
     if (pendingGlobalSection.load(std::memory_order_relaxed) < 0) return;  // no pending section
 
     pendingSectionRecordIsOverdub.store(isOverdub, std::memory_order_release);
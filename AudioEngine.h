@@ -2,17 +2,93 @@
 
 #include <JuceHeader.h>
 #include <array>
+#include <functional>
+#include <future>
 #include <memory>
+#include <vector>
 #include "Command.h"
 #include "LoopEngine.h"
 #include "Metronome.h"
 #include "PluginHostWrapper.h"
+#include "PluginInstancePool.h"
 #include "Channel.h"
+#include "EpochReclaimer.h"
+#include "LatencyProbe.h"
+#include "MidiClockGenerator.h"
 #include "MidiLearnManager.h"
+#include "ChannelRenderPool.h"
+#include "RealtimeProfiler.h"
+#include "RealtimeSafety.h"
+#include "RecordJournal.h"
+#include "StemRecorder.h"
 
 class AudioChannel;
 class VSTiChannel;
 
+//==============================================================================
+/**
+ * @brief What AudioEngine::bounceOffline() renders.
+ *
+ * The sections play back to back in A/B/C order, each for its number of
+ * loop passes, followed by the tail.
+ */
+struct BounceSettings
+{
+    juce::File directory;                      ///< bounce_<time>.wav (and the stems folder) go here
+    std::array<int, NUM_SECTIONS> loops {};    ///< passes per section; 0 = not in the bounce
+    bool   stems       {false};                ///< also write every channel's dry and post-FX stem
+    double tailSeconds {2.0};                  ///< rendered after the last pass, for FX tails
+    int    blockSize   {4096};                 ///< at most; capped at the device block the plugins are prepared for
+};
+
+//==============================================================================
+/**
+ * @brief Tempo and mix of a preloaded song, set by the audio thread in the
+ * block that swaps its audio in — the old song keeps its own until then.
+ */
+struct StandbySettings
+{
+    struct ChannelMix
+    {
+        float         gainDb      {0.0f};
+        MonitorMode   monitorMode {MonitorMode::WhenTrackActive};
+        bool          muted       {false};
+        bool          solo        {false};
+        bool          oneShot     {false};
+        RoutingConfig routing;
+    };
+
+    double bpm                 {120.0};
+    int    beatsPerLoop        {4};
+    bool   metronomeEnabled    {false};
+    int    metronomeOutputL    {0};
+    int    metronomeOutputR    {1};
+    int    metronomeBeatsPerBar{4};
+    float  metronomeGain       {1.0f};
+    float  masterGain          {1.0f};
+    std::array<ChannelMix, MAX_CHANNELS> channels;
+};
+
+//==============================================================================
+/**
+ * @brief Loop audio of a complete song, preloaded off the message thread.
+ *
+ * Handed to AudioEngine::queueStandbySong(); the audio thread exchanges it
+ * with the live channel sections at the next loop boundary.
+ */
+struct StandbySong
+{
+    std::array<std::array<StandbySection, NUM_SECTIONS>, MAX_CHANNELS> channels;
+    std::array<juce::int64, NUM_SECTIONS> sectionLoopLengths {};
+    juce::int64 loopLength     {0};
+    int         activeSection  {0};
+    juce::int64 loopBufferSize {0};   // channel buffer size the page tables were sized for
+    double      sampleRate     {0.0}; // rate the audio was converted to (0 = as recorded)
+
+    bool            hasSettings {false};   // false: the live tempo and mix stay
+    StandbySettings settings;
+};
+
 //==============================================================================
 /**
  * @file AudioEngine.h
@@ -24,7 +100,10 @@ class VSTiChannel;
  *   Message thread: everything else
  */
 class AudioEngine : public juce::AudioIODeviceCallback,
-                    public juce::MidiInputCallback
+                    public juce::MidiInputCallback,
+                    private juce::TimeSliceClient,
+                    private juce::AudioProcessorListener,
+                    private juce::AsyncUpdater
 {
 public:
     AudioEngine();
@@ -52,8 +131,27 @@ public:
     void handleIncomingMidiMessage(juce::MidiInput* source,
                                    const juce::MidiMessage& message) override;
 
+    /** Enable and listen to every MIDI input; after initialiseAudio(), message thread. */
     void openMidiInputs();
 
+    //==========================================================================
+    // MIDI Clock Out (message thread)
+
+    /**
+     * @brief Send 24-PPQN clock, Song Position and Start/Stop/Continue to a MIDI output.
+     *
+     * Ticks are placed on the loop samples by the audio thread and sent by a
+     * realtime thread at the time those samples leave the interface (PDC and
+     * driver output latency included), see MidiClockGenerator.
+     * @param deviceIdentifier  MidiOutput identifier, empty = off.
+     */
+    juce::Result setMidiClockOutput(const juce::String& deviceIdentifier);
+    juce::String getMidiClockOutput() const { return midiClock.getDeviceIdentifier(); }
+
+    /** Send-time error of the clock since the output was set (or resetMidiClockStats()). */
+    MidiClockGenerator::Stats getMidiClockStats() const { return midiClock.getStats(); }
+    void resetMidiClockStats() { midiClock.resetStats(); }
+
     //==========================================================================
     // Initialization
     //==========================================================================
@@ -63,12 +161,42 @@ public:
                                  double sampleRate  = 0.0,
                                  int bufferSize     = 0);
 
+    /**
+     * @brief Prepare for callbacks driven by the caller instead of a sound card.
+     *
+     * The device only supplies sample rate, block size and channel counts; the
+     * caller then invokes audioDeviceIOCallbackWithContext() itself (benchmark,
+     * offline rendering). Do not combine with initialiseAudio().
+     */
+    void beginOfflineRendering(juce::AudioIODevice& device);
+    void endOfflineRendering();
+
     //==========================================================================
     // Command Queue
     //==========================================================================
 
+    /**
+     * @brief Queue a command for the audio thread.
+     *
+     * A command with sampleTime >= 0 is held until the engine sample clock
+     * reaches it and the block is split there, so it lands on that sample.
+     */
     bool sendCommand(const Command& cmd);
 
+    /** Samples rendered since start — the clock Command::sampleTime refers to. */
+    juce::int64 getSampleClock() const { return totalSamplesProcessed.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Command::sampleTime for an event that happened at timeMs (Time::getMillisecondCounterHiRes()).
+     *
+     * One block after the event, the way the MIDI collector places live MIDI,
+     * so the command lands with a fixed delay instead of at the start of
+     * whichever block picks it up.  -1 without a timestamp or a running device.
+     */
+    juce::int64 getSampleClockFor(double timeMs) const noexcept;
+
+    static constexpr int kMaxTimedCommands = 128;
+
     //==========================================================================
     // Device Info
     //==========================================================================
@@ -83,6 +211,16 @@ public:
     // Channel Management
     //==========================================================================
 
+    /**
+     * @brief Number of channels (1…MAX_CHANNELS, default DEFAULT_CHANNELS).
+     *
+     * Set once at startup, before initialiseAudio(): channels are created or
+     * dropped here and the per-channel buffers are sized for this count when
+     * the device starts.  Ignored while the device runs.  Message thread.
+     */
+    void setNumChannels(int numChannels);
+    int  getNumChannels() const noexcept { return channelCount; }
+
     Channel*    getChannel(int index);
     void        setChannelType(int index, ChannelType type);
     ChannelType getChannelType(int index) const;
@@ -91,6 +229,67 @@ public:
     juce::String getChannelName(int index) const;
     void         setChannelName(int index, const juce::String& name);
 
+    /**
+     * @brief Opt-in: render channels in parallel on a pool of realtime worker threads.
+     *
+     * Each channel renders into its own block buffer; the results are summed into
+     * the device output in channel order, so the mix is identical to the serial path.
+     * Blocks shorter than kMinParallelBlockSize are always rendered serially.
+     * Message thread only.
+     */
+    void setParallelProcessing(bool enabled);
+    bool isParallelProcessingEnabled() const { return parallelProcessing.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Cores the render workers are pinned to, e.g. "2-5" or "2,4,6"; empty = not pinned.
+     *
+     * The device's audio thread runs wherever the OS puts it, so only the user
+     * knows which cores are free of it (isolated cores, a driver that pins its
+     * thread).  A running pool restarts with the new cores.  Message thread only.
+     */
+    juce::Result setRenderWorkerCores(const juce::String& cores);
+
+    static constexpr int kMinParallelBlockSize = 32;
+
+    /**
+     * @brief Keep at most maxLayers overdub layers per section playing separately.
+     *
+     * Older layers beyond the newest undoDepth are mixed into the base take on a
+     * background thread and swapped in at the next loop boundary, so playback
+     * cost stays bounded no matter how often a loop is overdubbed.
+     * Message thread only.
+     */
+    void setOverdubConsolidation(int maxLayers, int undoDepth);
+
+    /**
+     * @brief Keep sections that are not playing losslessly packed in RAM.
+     *
+     * A section that has been neither active nor pending for
+     * kSectionPackDelayMs is packed on the background thread; selecting it
+     * unpacks it at once (a latched switch waits for its boundary anyway, an
+     * immediate one fires as soon as every channel is unpacked).  Turning it
+     * off unpacks everything.  Message thread only.
+     */
+    void setSectionCompression(bool enabled);
+    bool isSectionCompressionEnabled() const { return sectionCompression.load(std::memory_order_relaxed); }
+
+    static constexpr juce::uint32 kSectionPackDelayMs   = 20000;
+    static constexpr int          kPackPagesPerSlice    = 8;    // per channel, ~2 MB of audio
+    static constexpr int          kUnpackPagesPerSlice  = 64;   // a switch may be waiting
+
+    /**
+     * @brief Pin up to budgetBytes of loop and layer pages in RAM (0 = off).
+     *
+     * Loop pages are pre-faulted when the pool allocates them; locking keeps
+     * the OS from paging out a section that has been idle, so the first read
+     * after a switch cannot fault inside the callback.  The background thread
+     * checks once per kResidencyCheckMs how much of the active sections is in
+     * RAM (getActiveLoopBytes() / getActiveResidentBytes()).  Message thread only.
+     */
+    void setLockedLoopMemory(juce::int64 budgetBytes) { loopPagePool.setLockBudget(budgetBytes); }
+
+    static constexpr juce::uint32 kResidencyCheckMs = 1000;
+
     //==========================================================================
     // Plugin Management
     //==========================================================================
@@ -100,15 +299,23 @@ public:
 
     /**
      * @brief Load plugin asynchronously, optionally restoring saved state.
-     * @param stateBase64  Base64-encoded plugin state. Applied after load. Empty = default state.
+     * @param state  Saved plugin state (sidecar file or Base64). Empty = default state.
+     *
+     * The state is read on a reader thread while the instance is created, so
+     * the plugins of a song load and read their states in parallel; it is
+     * pushed into the instance on the instance pool's worker thread.
+     *
+     * With a saved state an existing instance of the same plugin is reused — the
+     * one already in this slot, or an idle one from the instance pool.  Without
+     * a state a fresh instance is created, so the plugin starts from its defaults.
      */
     void loadPluginAsync(int channelIndex,
                          int slotIndex,
                          const juce::String& pluginIdentifier,
-                         const juce::String& stateBase64 = {},
+                         const PluginStateSource& state = {},
                          bool bypassed = false);
 
-    /** Called on the message thread when a plugin fails to load. Set before loading. */
+    /** Called on the message thread when a plugin fails to load or to restore its saved state. Set before loading. */
     std::function<void(int channelIndex, int slotIndex, const juce::String& error)>
         onPluginLoadError;
 
@@ -119,8 +326,50 @@ public:
     /** Number of plugins currently being loaded asynchronously. */
     int getPendingPluginLoads() const { return pendingPluginLoads.load(std::memory_order_relaxed); }
 
+    /** Remove a plugin; the instance is parked in the pool for later reuse. */
     void removePlugin(int channelIndex, int slotIndex);
 
+    /**
+     * @brief Plugin delay compensation: re-read every FX chain's latency and
+     * delay each channel so all outputs line up with the slowest chain.
+     *
+     * Called after plugin changes, scheduled again whenever an installed FX
+     * plugin reports new latency on its own (lookahead, oversampling), and
+     * polled from the UI tick for bypassed or crashed slots.  The metronome is
+     * shifted by the same amount.  Message thread.
+     */
+    void updateDelayCompensation();
+
+    /** Output delay PDC adds to the whole engine (the slowest chain), in samples. */
+    int getCompensationLatency() const { return pdcLatency.load(std::memory_order_relaxed); }
+
+    //==========================================================================
+    // Recording latency compensation (message thread)
+
+    /**
+     * @brief Round trip moved off recordings and overdubs into a running loop.
+     * @param samples  -1 = input + output latency as reported by the driver,
+     *                 otherwise a manual or measured round trip in samples.
+     * PDC is added on top; VSTi channels only use the output side (no audio input).
+     */
+    void setRecordLatencyOverride(int samples);
+    int  getRecordLatencyOverride() const { return recordLatencyOverride; }
+
+    /** Shift applied to audio-channel recordings right now, in samples. */
+    int  getRecordLatency() const { return recordLatencySamples.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Ping-loopback measurement: a pulse on the metronome outputs,
+     * listened for on the active channel's left input (cable one to the other).
+     */
+    void startLatencyMeasurement();
+
+    /** -2 while measuring, -1 failed (or none started), else the round trip in samples. */
+    int  getLatencyMeasurement() const;
+
+    /** Idle plugin instances kept for reuse (Message Thread). */
+    PluginInstancePool& getPluginPool() { return *pluginPool; }
+
     //==========================================================================
     // Global Playback State
     //==========================================================================
@@ -150,6 +399,19 @@ public:
     void setSectionLoopLength(int s, juce::int64 len);
     int  getPendingSection() const { return pendingGlobalSection.load(std::memory_order_relaxed); }
 
+    /** false while any channel still holds the section packed (see setSectionCompression()). */
+    bool isSectionResident(int s) const noexcept;
+
+    /**
+     * @brief Have the background thread size section buffers of all channels.
+     *
+     * Call as soon as a section becomes reachable (song loaded, section
+     * selected).  Returns immediately; a record on a section that is not ready
+     * yet is refused by sendCommand().  Never the audio thread (it sets
+     * sectionAllocRequests directly).
+     */
+    void requestSectionAllocation(int sectionMask = (1 << NUM_SECTIONS) - 1) noexcept;
+
     /** Queue a record/overdub to start when the pending section switch fires. */
     void queueRecordForPendingSection(int channelIndex, bool isOverdub);
     /** Cancel a queued record-ahead. */
@@ -157,11 +419,38 @@ public:
     /** Get channel queued for record-ahead (-1 = none). */
     int  getPendingSectionRecordChannel() const { return pendingSectionRecordChannel.load(std::memory_order_relaxed); }
 
+    //==========================================================================
+    // Song Switching (preloaded songs)
+    //==========================================================================
+
+    /**
+     * @brief Install a preloaded song's loop audio at the next loop boundary.
+     *
+     * Immediately when the transport is stopped. Replaces a swap that has not
+     * fired yet. The previous audio is released on the engine background thread.
+     * Its settings (if any) are applied in the same block.
+     */
+    void queueStandbySong(std::unique_ptr<StandbySong> song);
+
+    /** Drop a queued swap that has not fired yet (e.g. before a synchronous song load). */
+    void cancelStandbySong();
+    bool isStandbySongPending() const { return pendingStandbySong.load(std::memory_order_acquire) != nullptr; }
+
+    /** Page pool the standby buffers must be built from. */
+    LoopPagePool& getLoopPagePool() { return loopPagePool; }
+
     //==========================================================================
     // Auto-Start (input threshold trigger)
     //==========================================================================
 
-    /** Enable/disable auto-start and set the trigger threshold in dB. */
+    /**
+     * @brief Enable/disable auto-start and set the trigger threshold in dB.
+     *
+     * While stopped, the first input sample over the threshold starts recording
+     * on the active channel at that exact sample (the block is split there).
+     * A free first take also gets the kAutoStartPreRollMs before the onset, so
+     * the attack that tripped the threshold is part of the loop.
+     */
     void  setAutoStart(bool enabled, float thresholdDb);
     bool  isAutoStartEnabled()    const { return autoStartEnabled.load(std::memory_order_relaxed); }
     float getAutoStartThresholdDb() const;
@@ -246,6 +535,15 @@ public:
     void  setMasterGain(float gain);
     float getMasterGain() const;
 
+    /**
+     * @brief Channel fader in dB, written straight to the channel's gain atomic.
+     *
+     * Continuous controls (fader drags, MIDI CC streams) bypass the command
+     * queue: the audio thread always reads the latest value, intermediate
+     * values simply coalesce. Message thread.
+     */
+    void setChannelGain(int channelIndex, float gainDb);
+
     //==========================================================================
     // Master Recording
     //==========================================================================
@@ -255,6 +553,48 @@ public:
     bool isMasterRecording() const;
     juce::File getMasterRecordFile() const;
 
+    /**
+     * @brief Record every channel's dry and post-FX signal with the master.
+     *
+     * Takes effect at the next startMasterRecording(): the stems go to a
+     * `stems_<time>` folder next to the master file (see StemRecorder).
+     * Message thread.
+     */
+    void setRecordStems(bool enabled) { recordStems = enabled; }
+    bool getRecordStems() const       { return recordStems; }
+    const StemRecorder& getStemRecorder() const { return stemRecorder; }
+
+    //==========================================================================
+    // Offline Bounce
+    //==========================================================================
+
+    /**
+     * @brief Render the loops to WAV faster than real time, through the full channel path.
+     *
+     * The calling thread takes the audio thread's place.  The device callback
+     * is parked on silence, the engine is re-prepared for settings.blockSize
+     * with no inputs, and the blocks are driven through the normal callback:
+     * FX chains, PDC, mute/solo, master gain and the parallel render pool.
+     * The metronome and live MIDI stay out.
+     *
+     * The mixdown is trimmed by the PDC latency, and everything is
+     * re-prepared for the device afterwards.  Requires a stopped transport.
+     * Blocking: call it from a worker thread, never the message or audio thread.
+     *
+     * @param progress  Called between blocks with 0…1; returning false cancels.
+     */
+    juce::Result bounceOffline(const BounceSettings& settings,
+                               const std::function<bool(double)>& progress = nullptr);
+
+    bool isBouncing() const { return bounceActive.load(std::memory_order_relaxed); }
+
+    /** Mixdown written by the last successful bounceOffline(). */
+    juce::File getBounceFile() const { return bounceFile; }
+
+    /** Crash-recovery journal of everything recorded into the loops (see RecordJournal). */
+    RecordJournal&       getRecordJournal()       { return recordJournal; }
+    const RecordJournal& getRecordJournal() const { return recordJournal; }
+
     //==========================================================================
     // Mute Groups (message thread only)
     //==========================================================================
@@ -285,8 +625,44 @@ public:
     juce::AudioFormatManager& getFormatManager() { return formatManager; }
 
     double getCPUUsage()           const { return deviceManager.getCpuUsage() * 100.0; }
+    juce::int64 getLoopMemoryBytes() const { return loopPagePool.getAllocatedBytes(); }
+    juce::int64 getPackedLoopBytes() const;   // idle sections held compressed
+    juce::int64 getLockedLoopBytes() const { return loopPagePool.getLockedBytes(); }
+    bool        isLoopLockRefused()  const { return loopPagePool.hasLockFailed(); }   // OS limit reached
+    juce::int64 getActiveLoopBytes()    const { return activeLoopBytes.load(std::memory_order_relaxed); }
+    juce::int64 getActiveResidentBytes() const { return activeResidentBytes.load(std::memory_order_relaxed); }
+    int    getLoopPageUnderruns()  const { return loopPagePool.getNumFailedAcquires(); }
     int    getNumPendingCommands() const { return commandQueue.getNumPending(); }
+    /** Callbacks over budget plus the under/overruns the device itself reported. */
+    int    getXrunCount()          const { return xrunCount.load(std::memory_order_relaxed); }
+
+    /** Records refused (section buffers not sized yet, or no free overdub layer), the last channel and why. */
+    juce::uint32 getNumRefusedRecords()        const { return hotState.refusedRecords.load(std::memory_order_acquire); }
+    int          getLastRefusedRecordChannel() const { return hotState.lastRefusedChannel.load(std::memory_order_relaxed); }
+    ChannelHotState::Refusal getLastRecordRefusal() const
+    {
+        return static_cast<ChannelHotState::Refusal>(hotState.lastRefusal.load(std::memory_order_relaxed));
+    }
+
+    /** Per-stage callback timing (worst/p99 per channel and plugin slot, xrun attribution). */
+    const RealtimeProfiler& getProfiler() const { return profiler; }
+
+    /** A channel's figures as last published by the background thread (once per kResidencyCheckMs). */
+    struct ChannelMetrics
+    {
+        bool         present     {false};   // false: no channel in this slot
+        ChannelState state       {ChannelState::Idle};
+        int          section     {0};
+        int          layers      {0};       // overdub layers of the active section
+        juce::int64  packedBytes {0};
+        std::array<juce::int64, NUM_SECTIONS> baseBytes  {};   // mapped page bytes, 0 while packed
+        std::array<juce::int64, NUM_SECTIONS> layerBytes {};
+    };
+
+    /** Any thread: reads only atomics, never a Channel (it may be replaced meanwhile). */
+    ChannelMetrics getChannelMetrics(int index) const;
     bool   isCommandQueueFull()    const { return commandQueue.isFull(); }
+    int    getDroppedCommands()    const { return commandQueue.getNumDropped(); }
 
     MidiLearnManager& getMidiLearnManager() { return *midiLearnManager; }
 
@@ -308,15 +684,76 @@ private:
     std::unique_ptr<LoopEngine>    loopEngine;
     std::unique_ptr<Metronome>     metronome;
     std::unique_ptr<PluginHostWrapper> pluginHost;
+    std::unique_ptr<PluginInstancePool> pluginPool;   // outlives channels (declared before)
+    ChannelHotState hotState;                         // hot per-block channel flags; outlives every channel
+    EpochReclaimer reclaimer;                         // old channels/plugins, until the audio block ends
     std::unique_ptr<MidiLearnManager> midiLearnManager;
     CommandQueue commandQueue;
 
-    // 6 stereo channels
-    std::array<std::unique_ptr<Channel>, 6> channels;
+    // Page storage for all loop buffers — declared before channels so it outlives them
+    LoopPagePool loopPagePool;
+
+    /**
+     * A channel as the audio thread, the render workers and the background
+     * thread see it: published with a release store once it is fully prepared,
+     * read with an acquire load.  A replaced channel is unpublished here first
+     * and retired through the reclaimer; channelOwners keeps it alive until then.
+     */
+    class PublishedChannel
+    {
+    public:
+        Channel* get() const noexcept                { return ptr.load(std::memory_order_acquire); }
+        Channel* operator->() const noexcept         { return get(); }
+        explicit operator bool() const noexcept      { return get() != nullptr; }
+        void     publish(Channel* channel) noexcept  { ptr.store(channel, std::memory_order_release); }
+
+    private:
+        std::atomic<Channel*> ptr {nullptr};
+    };
+
+    // Stereo channels [0, channelCount); the rest stay empty
+    std::array<std::unique_ptr<Channel>, MAX_CHANNELS> channelOwners;   // message thread
+    std::array<PublishedChannel, MAX_CHANNELS>         channels;
+    int channelCount {DEFAULT_CHANNELS};   // fixed while the device runs
+
+    /** Own and publish a channel in slot index (nullptr = empty). Message thread, device stopped. */
+    void installChannel(int index, std::unique_ptr<Channel> channel);
+
+    std::unique_ptr<Channel> createChannel(int index, ChannelType type, int hotSlot);
+
+    // Hot-state slots of replaced channels not yet reclaimed (message thread)
+    std::array<bool, ChannelHotState::kSlots> hotSlotRetiring {};
 
     // MIDI: thread-safe bridge between MIDI thread and audio thread
     juce::MidiMessageCollector midiCollector;
 
+    // MIDI for this block, once in total and once per channel after the routing
+    // filter (preallocated in audioDeviceAboutToStart, audio thread only)
+    static constexpr int kChannelMidiBytes  = 4096;
+    static constexpr int kMidiEventOverhead = 8;    // timestamp + size stored with each event
+    juce::MidiBuffer                  blockMidi;
+    std::array<juce::MidiBuffer, MAX_CHANNELS> channelMidi;
+    void demultiplexMidi(const juce::MidiBuffer& source) noexcept;
+
+    // Sub-block views into the device buffers (sized in audioDeviceAboutToStart)
+    std::vector<const float*> subBlockInputs;
+    std::vector<float*>       subBlockOutputs;
+    std::array<juce::MidiBuffer, MAX_CHANNELS> subBlockMidi;   // per-channel MIDI slice
+
+    // Commands waiting for their sampleTime (audio thread only, capacity reserved)
+    std::vector<Command> timedCommands;
+
+    // Sample clock and wall-clock time of the current block's start, for
+    // getSampleClockFor().  Seqlock: odd while the audio thread writes it.
+    std::atomic<juce::uint32> clockAnchorSeq     {0};
+    std::atomic<juce::int64>  clockAnchorSamples {0};
+    std::atomic<double>       clockAnchorMs      {0.0};   // 0 = no block since the device started
+    void writeClockAnchor(juce::int64 samples, double ms) noexcept;
+
+    // MainButton double-press detection for audio-thread MIDI dispatch,
+    // in engine samples; index = mapping channelIndex + 1 (audio thread only)
+    std::array<juce::int64, MAX_CHANNELS + 1> lastMidiMainButtonSample;
+
     //==========================================================================
     // Audio thread state (written only from audioDeviceAboutToStart)
     int    numInputChannels  {0};
@@ -332,11 +769,13 @@ private:
     std::atomic<int>   activeChannelIndex   {0};
 
     // Play/stop channel memory — bitmask of channels that were playing when stop was pressed
-    std::atomic<uint8_t> lastActiveChannels     {0};
+    std::atomic<juce::uint32> lastActiveChannels {0};
+    static_assert(MAX_CHANNELS <= 32, "lastActiveChannels holds one bit per channel");
 
     // A/B/C sections
     std::atomic<int> activeGlobalSection        {0};
     std::atomic<int> pendingGlobalSection       {-1};   // -1 = none pending
+    std::atomic<int> deferredGlobalSection      {-1};   // immediate switch waiting for its section to unpack
     std::array<std::atomic<juce::int64>, NUM_SECTIONS> sectionLoopLengths;  // initialized in ctor
 
     // Latch record-ahead: queue recording to start when pending section activates
@@ -348,6 +787,21 @@ private:
     std::atomic<float> autoStartThresholdLinear {0.031623f};   // ~-30 dB
     bool               autoStartTriggered       {false};       // audio thread only
 
+    // Auto-start onset and input pre-roll (sized in audioDeviceAboutToStart, audio thread only).
+    // The ring keeps the newest kAutoStartPreRollMs of every input so the attack that
+    // crossed the threshold is spliced in at the start of the take.
+    static constexpr int kAutoStartPreRollMs = 10;
+    juce::AudioBuffer<float>  preRollRing;        // 2 x preRollCapacity, mirrored
+    std::vector<const float*> preRollInputs;
+    int preRollLength   {0};
+    int preRollCapacity {0};
+    int preRollWrite    {0};
+    int preRollFilled   {0};
+
+    int  findAutoStartOnset(const float* const* inputs, int numIns, int numSamples) const noexcept;
+    void pushPreRoll(const float* const* inputs, int numIns, int numSamples) noexcept;
+    void triggerAutoStart(int samplesFromOnset);
+
     // Count-in
     std::atomic<int>   countInBeats            {0};
     std::atomic<bool>  countInActive           {false};   // written audio thread, read UI thread
@@ -369,6 +823,7 @@ private:
 
     // Master output volume
     std::atomic<float> masterGain              {1.0f};
+    SmoothedGain       masterGainSmoother;               // audio thread (prepared on device start)
 
     // Master recording
     std::atomic<bool> masterRecordingActive {false};
@@ -377,22 +832,141 @@ private:
     juce::TimeSliceThread masterRecordThread {"Master Record Thread"};
     juce::File masterRecordFile;  // message thread only
 
+    // Stem recording (writer thread inside; taps in Channel, block end in renderSubBlock)
+    StemRecorder stemRecorder;
+    bool         recordStems {false};   // message thread only
+
+    // Offline bounce: while active the device callback only outputs silence
+    // (and acknowledges via bounceDeviceParked), the bounce thread renders
+    std::atomic<bool> bounceActive       {false};
+    std::atomic<bool> bounceDeviceParked {false};
+    juce::File        bounceFile;   // bounce thread, read once bounceOffline() returned
+    juce::MidiBuffer  parkedMidi;   // live MIDI the parked callback drains and drops
+
+    // The bounce borrows the live setup: same rate, blocks no larger than the
+    // device's, so no plugin is re-prepared and no device state is touched
+    juce::int64 bounceSampleClock {0};     // sample clock when the bounce took over
+    double      bounceStartMs     {0.0};
+    int  prepareForBounce(const BounceSettings& settings);   // returns the offline block size
+    void restoreAfterBounce();
+
+    // Crash-recovery journal (writer thread inside; records from Channel, section lengths per callback)
+    RecordJournal recordJournal;
+
     // Working buffers (audio thread only)
     juce::AudioBuffer<float> inputBuffer;
     juce::AudioBuffer<float> outputBuffer;
 
+    // Parallel channel rendering
+    ChannelRenderPool renderPool;
+    std::atomic<bool> parallelProcessing {false};
+    juce::uint32      renderWorkerCores  {0};   // core mask, 0 = not pinned (message thread)
+    std::array<juce::AudioBuffer<float>, MAX_CHANNELS> channelRenderBuffers;  // per-channel output block
+
+    /** Per-block arguments shared with the render workers (audio thread writes before dispatch). */
+    struct RenderContext
+    {
+        AudioEngine*            engine            {nullptr};
+        const float* const*     inputChannelData  {nullptr};
+        juce::MidiBuffer*       channelMidi       {nullptr};   // one buffer per channel
+        int                     numSamples        {0};
+        juce::int64             playheadPos       {0};
+        juce::int64             loopLen           {0};
+        int                     numInputChannels  {0};
+        int                     numOutputChannels {0};
+    };
+    RenderContext renderContext;
+
+    static void renderChannelJob(void* context, int channelIndex);
+
+    // Background work off the audio thread (section allocation, overdub layer consolidation)
+    juce::TimeSliceThread backgroundThread {"Engine Background"};
+    juce::CriticalSection channelSwapLock;   // background thread vs. channel replacement
+    std::atomic<int>      sectionAllocRequests {0};   // bit per section, served by useTimeSlice()
+
+    // Section storage tiers (background thread; see setSectionCompression())
+    std::atomic<bool> sectionCompression {true};
+    std::array<juce::uint32, NUM_SECTIONS> sectionLastUsedMs {};
+
+    // Residency of the active sections' pages (background thread, see setLockedLoopMemory())
+    juce::uint32             lastResidencyCheckMs {0};
+    std::atomic<int>         pdcLatency           {0};   // slowest FX chain, see updateDelayCompensation()
+    std::atomic<bool>        fxLatencyChanged     {false};   // set by any thread, picked up by useTimeSlice()
+
+    // Recording latency compensation: device figures are taken at device start
+    int              deviceInputLatency    {0};
+    int              deviceOutputLatency   {0};
+    int              recordLatencyOverride {-1};
+    std::atomic<int> recordLatencySamples  {0};
+    LatencyProbe     latencyProbe;
+
+    // MIDI clock out: fed in renderSubBlock(), next to the loop engine
+    MidiClockGenerator midiClock;
+
+    /** Push the record shift to every channel (device round trip or override, plus PDC). */
+    void updateRecordLatency();
+    std::atomic<juce::int64> activeLoopBytes      {0};
+    std::atomic<juce::int64> activeResidentBytes  {0};
+
+    // getChannelMetrics(): copied from the channels in the residency pass
+    struct PublishedMetrics
+    {
+        std::atomic<bool>        present     {false};
+        std::atomic<int>         section     {0};
+        std::atomic<int>         layers      {0};
+        std::atomic<juce::int64> packedBytes {0};
+        std::array<std::atomic<juce::int64>, NUM_SECTIONS> baseBytes  {};
+        std::array<std::atomic<juce::int64>, NUM_SECTIONS> layerBytes {};
+    };
+    std::array<PublishedMetrics, MAX_CHANNELS> channelMetrics;
+
+    /** Background thread, under channelSwapLock. */
+    void publishChannelMetrics();
+    int useTimeSlice() override;
+
+    // FX latency changes: plugins may report from the audio thread, so the
+    // listener only flags them; updateDelayCompensation() runs on the message thread
+    void audioProcessorParameterChanged(juce::AudioProcessor*, int, float) override {}
+    void audioProcessorChanged(juce::AudioProcessor*, const ChangeDetails& details) override;
+    void handleAsyncUpdate() override;
+
+    // Song switching: message thread publishes, audio thread swaps and retires,
+    // background thread frees the retired (old) audio
+    std::atomic<StandbySong*> pendingStandbySong {nullptr};
+    std::atomic<StandbySong*> retiredStandbySong {nullptr};
+    void installStandbySong(StandbySong& song) noexcept;
+    void applyStandbySettings(const StandbySettings& settings) noexcept;
+
     // Plugin load tracking
     std::atomic<int> pendingPluginLoads {0};
 
+    // Saved plugin states are read (file or Base64) here, in parallel with instance creation
+    juce::ThreadPool pluginStateReaders { juce::ThreadPoolOptions{}
+                                              .withThreadName("Plugin State Reader")
+                                              .withNumberOfThreads(4) };
+    std::shared_future<juce::MemoryBlock> readPluginStateAsync(const PluginStateSource& state);
+
+    // Plugin installation (message thread): displaced instances go to the pool
+    void installPlugin(int channelIndex, int slotIndex,
+                       std::unique_ptr<juce::AudioPluginInstance> plugin, bool bypassed);
+    /** Park an instance the audio thread may still be using, once its block has ended. */
+    void retireToPool(std::unique_ptr<juce::AudioPluginInstance> plugin);
+    std::unique_ptr<juce::AudioPluginInstance> takeReusablePlugin(int channelIndex, int slotIndex,
+                                                                  const juce::String& identifier);
+
     // Diagnostics
     std::atomic<juce::int64>  totalSamplesProcessed {0};
-    std::atomic<juce::int32>  xrunCount             {0};
+    std::atomic<juce::int32>  xrunCount             {0};   // profiler + device xruns, since start
+    juce::AudioIODevice*      xrunDevice            {nullptr};   // set before callbacks start, cleared after
+    juce::int32               deviceXruns           {0};   // reported by xrunDevice (audio thread)
+    juce::int32               earlierDeviceXruns    {0};   // reported by devices closed since start
+    RealtimeProfiler          profiler;
 
     // Channel display names (message thread only)
-    std::array<juce::String, 6> channelNames;
+    std::array<juce::String, MAX_CHANNELS> channelNames;
 
     // Mute groups (message thread only)
-    std::array<int, 6>  channelMuteGroup  {0, 0, 0, 0, 0, 0};   // 0=none, 1-4
+    std::array<int, MAX_CHANNELS> channelMuteGroup {};   // 0=none, 1-4
     std::array<bool, 4> muteGroupActive   {false, false, false, false};
 
     //==========================================================================
@@ -401,6 +975,29 @@ private:
     void processGlobalCommand (const Command& cmd);
     void processChannelCommand(const Command& cmd);
 
+    // MIDI control dispatch (audio thread) — transport targets of the realtime table
+    void executeRealtimeMidi(const RealtimeMidiTable::Entry& entry, float norm);
+
+    // One-shot pads: a mapped Play on a one-shot channel retriggers at its
+    // sample offset inside the current sub-block instead of splitting it
+    Channel* oneShotRetriggerTarget(const RealtimeMidiTable::Entry& entry) const;
+    bool     isOneShotRetrigger(const RealtimeMidiTable& table, const juce::uint8* data, int numBytes) const;
+
+    /** The callback proper; the device's or, during a bounce, the bounce thread's. */
+    void processDeviceBlock(const float* const* inputChannelData, int numInputChannels,
+                            float* const* outputChannelData, int numOutputChannels,
+                            int numSamples);
+
+    // Sub-block rendering (audio thread): the callback is split at every timed
+    // command and mapped MIDI control, steps 3-7 run once per sub-block
+    void renderSubBlock(const float* const* inputChannelData, int numInputChannels,
+                        float* const* outputChannelData, int numOutputChannels,
+                        juce::MidiBuffer* channelMidiBuffers, int numSamples,
+                        juce::int64& stageTicks);
+    bool holdTimedCommand(const Command& cmd);
+    void fireDueCommands(juce::int64 now);
+    int  nextTimedCommandOffset(juce::int64 blockStart, int numSamples) const;
+
     void clearOutputBuffer(float* const* outputChannelData, int numChannels, int numSamples);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(AudioEngine)
@@ -1,4 +1,14 @@
 #include "Channel.h"
+#include "DenormalPolicy.h"
+#include "LoopPageCodec.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static_assert(RecordJournal::kNumSections == NUM_SECTIONS, "journal and channel sections differ");
+static_assert(RecordJournal::kNumChannels    == MAX_CHANNELS, "journal lanes and channels differ");
+static_assert(StemRecorder::kNumChannels     == MAX_CHANNELS, "stem count and channels differ");
+static_assert(RealtimeProfiler::kNumChannels == MAX_CHANNELS, "profiler stages and channels differ");
 
 // SEH-protected plugin helpers — see VSTiChannel.cpp for rationale.
 #if JUCE_WINDOWS
@@ -39,48 +49,60 @@ static bool pluginCallProcessBlock (juce::AudioPluginInstance* p,
 #endif
 
 //==============================================================================
-Channel::Channel(int index, ChannelType type)
-    : channelIndex(index), channelType(type)
+Channel::Channel(int index, ChannelType type, ChannelHotState& hot, int slot)
+    : channelIndex(index), channelType(type),
+      state          (hot.state          [static_cast<size_t>(slot)]),
+      muted          (hot.muted          [static_cast<size_t>(slot)]),
+      solo           (hot.solo           [static_cast<size_t>(slot)]),
+      soloMuted      (hot.soloMuted      [static_cast<size_t>(slot)]),
+      stopPending    (hot.stopPending    [static_cast<size_t>(slot)]),
+      recordPending  (hot.recordPending  [static_cast<size_t>(slot)]),
+      overdubPending (hot.overdubPending [static_cast<size_t>(slot)]),
+      playPending    (hot.playPending    [static_cast<size_t>(slot)]),
+      isActiveChannel(hot.isActiveChannel[static_cast<size_t>(slot)]),
+      oneShot        (hot.oneShot        [static_cast<size_t>(slot)]),
+      gainLinear     (hot.gainLinear     [static_cast<size_t>(slot)]),
+      hotState       (hot)
 {
-    for (auto& v : oneShotVoices)
-        v.store(-1, std::memory_order_relaxed);
+    jassert(index >= 0 && index < MAX_CHANNELS);
+    jassert(slot == index || slot == index + MAX_CHANNELS);
 }
 
 //==============================================================================
 void Channel::prepareToPlay(double newSampleRate, int newMaxBlockSize,
                             juce::int64 maxLoopLengthSamples)
 {
+    // Packed sections would not match re-sized page tables
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        restoreSectionNow(s);
+
     sampleRate     = newSampleRate;
     maxBlockSize   = newMaxBlockSize;
     loopBufferSize = maxLoopLengthSamples;
 
-    // Section 0 is always allocated
-    auto& sec0 = sections[0];
-    const bool hasContent0 = sec0.loopHasContent.load(std::memory_order_relaxed);
-    sec0.loopBuffer.setSize(2, static_cast<int>(maxLoopLengthSamples),
-                       hasContent0, true, false);
-    if (!hasContent0)
-        sec0.loopBuffer.clear();
-    sec0.overdubLayers.reserve(32);
-    sec0.allocated = true;
+    const juce::ScopedLock sl(sectionAllocLock);
+
+    // Section 0 is always allocated. Loop buffers are paged — setting the
+    // capacity only sizes the page table, audio pages are mapped on write.
+    sizeSectionStorage(sections[0]);
+    sections[0].allocated.store(true, std::memory_order_release);
 
     // Sections 1/2: only resize if already allocated (lazy)
     for (int s = 1; s < NUM_SECTIONS; ++s)
-    {
-        auto& sec = sections[s];
-        if (sec.allocated)
-        {
-            const bool hasContent = sec.loopHasContent.load(std::memory_order_relaxed);
-            sec.loopBuffer.setSize(2, static_cast<int>(maxLoopLengthSamples),
-                                   hasContent, true, false);
-            if (!hasContent)
-                sec.loopBuffer.clear();
-            sec.overdubLayers.reserve(32);
-        }
-    }
+        if (sections[s].allocated.load(std::memory_order_acquire))
+            sizeSectionStorage(sections[s]);
 
     workingBuffer.setSize(2, newMaxBlockSize * 2, false, true, true);
     fxBuffer     .setSize(2, newMaxBlockSize * 2, false, true, true);
+    fxMidiBuffer .ensureSize(1024);
+    latencyDelay .prepare(newMaxBlockSize * 2);
+
+    // 20 ms fader ramps, 5 ms mute/solo fades; start at the current values
+    gainSmoother.prepare(sampleRate, newMaxBlockSize * 2, 0.020, SmoothedGain::Curve::Exponential);
+    muteFade    .prepare(sampleRate, newMaxBlockSize * 2, 0.005, SmoothedGain::Curve::Linear);
+    gainSmoother.reset(gainLinear.load(std::memory_order_relaxed));
+    muteFade    .reset((muted.load(std::memory_order_relaxed) || soloMuted.load(std::memory_order_relaxed)) ? 0.0f : 1.0f);
+    gainRamp = nullptr;
     workingBuffer.clear();
     fxBuffer     .clear();
 
@@ -92,6 +114,9 @@ void Channel::prepareToPlay(double newSampleRate, int newMaxBlockSize,
             catch (...) { slot.crashed.store(true, std::memory_order_release); }
         }
     }
+
+    fxIdle.wake();
+    updateFxTail();
 }
 
 void Channel::releaseResources()
@@ -103,22 +128,75 @@ void Channel::releaseResources()
             catch (...) { slot.crashed.store(true, std::memory_order_release); }
         }
 
-    for (auto& sec : sections)
     {
-        sec.loopBuffer.setSize(0, 0);
-        sec.overdubLayers.clear();
-        sec.activeOverdubLayerIdx = -1;
-        auto* staged = sec.stagedOverdubBuffer.exchange(nullptr, std::memory_order_acquire);
-        delete staged;
-        sec.loopHasContent.store(false, std::memory_order_relaxed);
-        sec.allocated = false;
+        const juce::ScopedLock tl(tierLock);
+        for (auto& tier : tiers)
+        {
+            tier.state.store(TierState::Resident, std::memory_order_release);
+            discardTier(tier);
+        }
+    }
+
+    {
+        const juce::ScopedLock sl(sectionAllocLock);
+        for (auto& sec : sections)
+        {
+            sec.loopBuffer.clear();
+            sec.clearOverdubLayers();
+            sec.loopHasContent.store(false, std::memory_order_relaxed);
+            sec.allocated.store(false, std::memory_order_release);
+        }
+        sections[0].allocated.store(true, std::memory_order_release);  // section 0 is always "allocated"
     }
-    sections[0].allocated = true;  // section 0 is always "allocated"
 
     workingBuffer.setSize(0, 0);
     fxBuffer     .setSize(0, 0);
 }
 
+void Channel::setLoopPagePool(LoopPagePool* pool)
+{
+    for (auto& sec : sections)
+    {
+        sec.loopBuffer.setPool(pool);
+        sec.flattenBuffer.setPool(pool);
+        for (auto& layer : sec.overdubLayers)
+            layer.setPool(pool);
+    }
+
+    for (auto& tier : tiers)
+    {
+        tier.swap.base.setPool(pool);
+        for (auto& layer : tier.swap.layers)
+            layer.setPool(pool);
+    }
+}
+
+void Channel::sizeSectionStorage(SectionBufferSet& sec)
+{
+    // Only page tables are sized here — audio memory is mapped on write.
+    sec.loopBuffer.setCapacity(loopBufferSize);
+    if (!sec.loopHasContent.load(std::memory_order_relaxed))
+        sec.loopBuffer.clear();
+
+    // Layers in use keep their loop length; free slots get a full-size table
+    // so any later overdub can set its length without allocating.
+    const int numLayers = sec.numOverdubLayers.load(std::memory_order_relaxed);
+    for (int i = 0; i < MAX_OVERDUB_LAYERS; ++i)
+    {
+        auto& layer = sec.overdubLayers[static_cast<size_t>(i)];
+        const juce::int64 len = layer.getCapacity();
+        layer.setCapacity(loopBufferSize);
+        if (i < numLayers && len > 0)
+            layer.setLength(len);
+        else
+            layer.clear();
+    }
+
+    sec.flattenBuffer.setCapacity(loopBufferSize);
+    sec.flattenBuffer.clear();
+    sec.flattenMergedLayers.store(0, std::memory_order_release);
+}
+
 //==============================================================================
 // State Management
 //==============================================================================
@@ -131,47 +209,48 @@ void Channel::clearPendingActions()
     playPending   .store(false, std::memory_order_release);
 }
 
-void Channel::startRecording(bool isOverdub)
+void Channel::startRecording(bool isOverdub, juce::int64 loopLength)
 {
     const int s = activeSection.load(std::memory_order_relaxed);
     auto& sec = sections[s];
 
+    // Page tables not sized yet (background thread still on it): refuse instead of allocating
+    if (!sec.allocated.load(std::memory_order_acquire))
+    {
+        hotState.noteRefusedRecord(channelIndex);
+        return;
+    }
+
     if (isOverdub && sec.loopHasContent.load(std::memory_order_relaxed))
     {
-        auto* staged = sec.stagedOverdubBuffer.exchange(nullptr, std::memory_order_acquire);
-        if (staged)
-        {
-            // Validate staged buffer size matches current loop buffer capacity.
-            // If mismatched (e.g. BPM changed after staging), re-allocate.
-            if (staged->getNumSamples() != static_cast<int>(loopBufferSize) && loopBufferSize > 0)
-            {
-                delete staged;
-                staged = nullptr;
-            }
-        }
-        if (staged)
-        {
-            sec.overdubLayers.push_back(std::move(*staged));
-            delete staged;
-        }
-        else
+        const int n = sec.numOverdubLayers.load(std::memory_order_relaxed);
+        if (n >= MAX_OVERDUB_LAYERS)
         {
-            sec.overdubLayers.emplace_back(2, static_cast<int>(loopBufferSize));
-            sec.overdubLayers.back().clear();
+            // All slots used and the oldest not merged yet: keep playing, say so
+            hotState.noteRefusedRecord(channelIndex, ChannelHotState::Refusal::LayersFull);
+            return;
         }
-        sec.activeOverdubLayerIdx = static_cast<int>(sec.overdubLayers.size()) - 1;
+
+        // Slot pages were released when it was last retired; only the wrap length changes.
+        auto& layer = sec.overdubLayers[static_cast<size_t>(n)];
+        layer.clear();
+        layer.setLength(loopLength > 0 ? loopLength : loopBufferSize);
+
+        sec.activeOverdubLayerIdx = n;
+        sec.markLayerAdded(n);
+        sec.numOverdubLayers.store(n + 1, std::memory_order_release);
+        sec.bumpLayout();
         state.store(ChannelState::Overdubbing, std::memory_order_release);
+        if (recordJournal != nullptr)
+            recordJournal->takeStarted(channelIndex, s, true, layer.getCapacity());
     }
     else
     {
-        // Reset overdub layers without deallocating vector capacity.
-        // AudioBuffer destructors still run (freeing sample data), which is
-        // a heap operation on the audio thread. This is a known RT constraint
-        // violation mitigated by the low frequency of this path (once per
-        // fresh recording).
-        sec.overdubLayers.clear();
-        sec.activeOverdubLayerIdx = -1;
+        // Retiring layers only returns their pages to the pool — no heap frees here.
+        sec.clearOverdubLayers();
         state.store(ChannelState::Recording, std::memory_order_release);
+        if (recordJournal != nullptr)
+            recordJournal->takeStarted(channelIndex, s, false, 0);
     }
 }
 
@@ -185,6 +264,8 @@ void Channel::stopRecording()
         sec.activeOverdubLayerIdx = -1;
         sec.loopHasContent.store(true, std::memory_order_release);
         state.store(ChannelState::Playing, std::memory_order_release);
+        if (recordJournal != nullptr)
+            recordJournal->takeEnded(channelIndex, s);
     }
 }
 
@@ -223,8 +304,14 @@ void Channel::startOneShotRecord()
 {
     const int s = activeSection.load(std::memory_order_relaxed);
     auto& sec = sections[s];
-    sec.overdubLayers.clear();
-    sec.activeOverdubLayerIdx = -1;
+    if (!sec.allocated.load(std::memory_order_acquire))
+    {
+        hotState.noteRefusedRecord(channelIndex);   // see startRecording()
+        return;
+    }
+    sec.clearOverdubLayers();
+    oneShotVoices.stopAll();        // the take under them is about to be overwritten
+    oneShotVoices.clearEnvelope();
     oneShotPlayhead.store(0, std::memory_order_release);
     oneShotLength.store(0, std::memory_order_release);
     state.store(ChannelState::Recording, std::memory_order_release);
@@ -241,48 +328,19 @@ void Channel::stopOneShotRecord(juce::int64 recordedSamples)
     state.store(ChannelState::Idle, std::memory_order_release);
 }
 
-void Channel::triggerOneShotPlayback()
+void Channel::triggerOneShotPlayback(int sampleOffset)
 {
-    const juce::int64 len = oneShotLength.load(std::memory_order_relaxed);
-    if (len <= 0) return;
-
-    // Find first inactive voice slot
-    for (auto& v : oneShotVoices)
-    {
-        if (v.load(std::memory_order_relaxed) < 0)
-        {
-            v.store(0, std::memory_order_release);
-            return;
-        }
-    }
-
-    // All slots busy — steal the oldest (highest playhead)
-    int oldestIdx = 0;
-    juce::int64 oldestPos = 0;
-    for (int i = 0; i < kMaxOneShotVoices; ++i)
-    {
-        juce::int64 pos = oneShotVoices[i].load(std::memory_order_relaxed);
-        if (pos > oldestPos)
-        {
-            oldestPos = pos;
-            oldestIdx = i;
-        }
-    }
-    oneShotVoices[oldestIdx].store(0, std::memory_order_release);
+    oneShotVoices.trigger(sampleOffset, oneShotLength.load(std::memory_order_relaxed));
 }
 
 void Channel::stopAllOneShotVoices()
 {
-    for (auto& v : oneShotVoices)
-        v.store(-1, std::memory_order_release);
+    oneShotVoices.stopAll();
 }
 
 bool Channel::isOneShotPlaying() const
 {
-    for (const auto& v : oneShotVoices)
-        if (v.load(std::memory_order_relaxed) >= 0)
-            return true;
-    return false;
+    return oneShotVoices.isPlaying();
 }
 
 void Channel::checkOneShotStop(juce::int64 playheadPosition,
@@ -290,16 +348,11 @@ void Channel::checkOneShotStop(juce::int64 playheadPosition,
 {
     if (!oneShot.load(std::memory_order_relaxed)) return;
 
-    // For oneshot channels, check each voice against oneShotLength
+    // For oneshot channels, retire every voice that has passed oneShotLength
     const juce::int64 len = oneShotLength.load(std::memory_order_relaxed);
     if (len <= 0) return;
 
-    for (auto& v : oneShotVoices)
-    {
-        juce::int64 pos = v.load(std::memory_order_relaxed);
-        if (pos >= 0 && pos >= len)
-            v.store(-1, std::memory_order_release);
-    }
+    oneShotVoices.retireFinished(len);
 }
 
 void Channel::checkAndExecutePendingStop(juce::int64 playheadPosition,
@@ -334,7 +387,7 @@ void Channel::checkAndExecutePendingStop(juce::int64 playheadPosition,
     if (overdubPending.load(std::memory_order_relaxed))
     {
         overdubPending.store(false, std::memory_order_release);
-        startRecording(true);
+        startRecording(true, loopLength);
     }
 
     if (playPending.load(std::memory_order_relaxed))
@@ -351,18 +404,27 @@ void Channel::doubleBuffer(int sectionIndex, juce::int64 currentLoopLength)
     if (!sec.loopHasContent.load(std::memory_order_relaxed)) return;
     if (currentLoopLength <= 0 || currentLoopLength * 2 > loopBufferSize) return;
 
-    const int len = static_cast<int>(currentLoopLength);
+    const juce::int64 len = currentLoopLength;
 
-    for (int ch = 0; ch < juce::jmin(2, sec.loopBuffer.getNumChannels()); ++ch)
-        sec.loopBuffer.copyFrom(ch, len, sec.loopBuffer, ch, 0, len);
+    // The second half only repeats the first: no audio is copied here, a page is
+    // filled when a take or overdub first writes to it. copyWithin() is the
+    // fallback for a layout the buffer cannot express as a repeat.
+    if (!sec.loopBuffer.repeatPrefix(len))
+        sec.loopBuffer.copyWithin(0, len, len);
 
-    for (auto& layer : sec.overdubLayers)
+    const int numLayers = sec.numOverdubLayers.load(std::memory_order_relaxed);
+    for (int i = 0; i < numLayers; ++i)
     {
-        const int layerLen = juce::jmin(len, layer.getNumSamples() - len);
+        auto& layer = sec.overdubLayers[static_cast<size_t>(i)];
+        const juce::int64 layerLen = juce::jmin(len, layer.getCapacity());
         if (layerLen <= 0) continue;
-        for (int ch = 0; ch < juce::jmin(2, layer.getNumChannels()); ++ch)
-            layer.copyFrom(ch, len, layer, ch, 0, layerLen);
+        layer.setLength(layerLen * 2);
+        if (!layer.repeatPrefix(layerLen))
+            layer.copyWithin(0, layerLen, layerLen);
     }
+    sec.bumpContent();
+    if (recordJournal != nullptr)
+        recordJournal->sectionDoubled(channelIndex, sectionIndex, len);
 }
 
 void Channel::doubleBuffer(juce::int64 currentLoopLength)
@@ -392,13 +454,10 @@ void Channel::clearSection(int s)
     auto& sec = sections[s];
     sec.loopHasContent.store(false, std::memory_order_release);
     sec.loopBuffer.clear();
-    // NOTE: overdubLayers.clear() frees AudioBuffer sample data on the audio thread.
-    // This is a known RT violation mitigated by the low frequency of clear operations.
-    // Vector capacity is preserved so subsequent push_back won't reallocate (up to reserve limit).
-    sec.overdubLayers.clear();
-    sec.activeOverdubLayerIdx = -1;
-    auto* staged = sec.stagedOverdubBuffer.exchange(nullptr, std::memory_order_acquire);
-    delete staged;
+    sec.clearOverdubLayers();   // pages return to the pool lock-free
+    resetTier(s);
+    if (recordJournal != nullptr)
+        recordJournal->sectionCleared(channelIndex, s);
 }
 
 void Channel::clearAllSections()
@@ -414,10 +473,10 @@ void Channel::clearAllSections()
         auto& sec = sections[s];
         sec.loopHasContent.store(false, std::memory_order_release);
         sec.loopBuffer.clear();
-        sec.overdubLayers.clear();  // see clearSection() note about RT safety
-        sec.activeOverdubLayerIdx = -1;
-        auto* staged = sec.stagedOverdubBuffer.exchange(nullptr, std::memory_order_acquire);
-        delete staged;
+        sec.clearOverdubLayers();
+        resetTier(s);
+        if (recordJournal != nullptr)
+            recordJournal->sectionCleared(channelIndex, s);
     }
 }
 
@@ -459,12 +518,13 @@ bool Channel::hasLoop() const
 void Channel::allocateSection(int s)
 {
     if (s < 0 || s >= NUM_SECTIONS) return;
-    if (sections[s].allocated) return;
+    if (sections[s].allocated.load(std::memory_order_acquire)) return;
+
+    const juce::ScopedLock sl(sectionAllocLock);
+    if (sections[s].allocated.load(std::memory_order_acquire)) return;   // raced with another thread
 
-    sections[s].loopBuffer.setSize(2, static_cast<int>(loopBufferSize), false, true, false);
-    sections[s].loopBuffer.clear();
-    sections[s].overdubLayers.reserve(32);
-    sections[s].allocated = true;
+    sizeSectionStorage(sections[s]);
+    sections[s].allocated.store(true, std::memory_order_release);
 }
 
 //==============================================================================
@@ -488,50 +548,47 @@ void        Channel::setRouting(const RoutingConfig& c) { routing = c; }
 // Plugin Management
 //==============================================================================
 
-void Channel::addPlugin(int slotIndex, std::unique_ptr<juce::AudioPluginInstance> plugin)
+std::unique_ptr<juce::AudioPluginInstance> Channel::addPlugin(int slotIndex,
+                                                           std::unique_ptr<juce::AudioPluginInstance> plugin)
 {
     jassert(slotIndex >= 0 && slotIndex < 3);
     auto& slot = fxChain[slotIndex];
 
-    slot.bypassed.store(true, std::memory_order_release);
-    const int blockMs = (sampleRate > 0.0 && maxBlockSize > 0)
-                      ? static_cast<int>(maxBlockSize * 1000.0 / sampleRate) + 5
-                      : 20;
-    juce::Thread::sleep(blockMs);
+    // Prepare while the audio thread cannot see the new instance yet
+    const bool prepared = plugin != nullptr
+                       && pluginCallPrepareToPlay (plugin.get(), sampleRate, maxBlockSize);
 
-    if (slot.plugin) { slot.plugin->releaseResources(); slot.plugin.reset(); }
+    auto previous = std::move(slot.plugin);
+    slot.plugin   = std::move(plugin);
 
-    slot.plugin = std::move(plugin);
-    slot.crashed.store(false, std::memory_order_release);
+    slot.crashed .store(slot.plugin != nullptr && !prepared, std::memory_order_release);
+    slot.bypassed.store(!prepared,                           std::memory_order_release);
 
-    if (slot.plugin)
-    {
-        if (pluginCallPrepareToPlay (slot.plugin.get(), sampleRate, maxBlockSize))
-            slot.bypassed.store(false, std::memory_order_release);
-        else
-            slot.crashed.store(true, std::memory_order_release);
-    }
+    // Publish: the audio thread may still finish its current block with the old one
+    slot.active.store(prepared ? slot.plugin.get() : nullptr, std::memory_order_release);
+    updateFxTail();
+
+    return previous;
 }
 
-void Channel::removePlugin(int slotIndex)
+std::unique_ptr<juce::AudioPluginInstance> Channel::detachPlugin(int slotIndex)
 {
     jassert(slotIndex >= 0 && slotIndex < 3);
     auto& slot = fxChain[slotIndex];
-    if (!slot.plugin) return;
-    slot.bypassed.store(true, std::memory_order_release);
-    const int blockMs = (sampleRate > 0.0 && maxBlockSize > 0)
-                      ? static_cast<int>(maxBlockSize * 1000.0 / sampleRate) + 5
-                      : 20;
-    juce::Thread::sleep(blockMs);
-    slot.plugin->releaseResources();
-    slot.plugin.reset();
+    if (!slot.plugin) return nullptr;
+    slot.bypassed.store(true,    std::memory_order_release);
+    slot.active  .store(nullptr, std::memory_order_release);
+    auto plugin = std::move(slot.plugin);
     slot.crashed.store(false, std::memory_order_release);
+    updateFxTail();
+    return plugin;
 }
 
 void Channel::setPluginBypassed(int slotIndex, bool bypassed)
 {
     jassert(slotIndex >= 0 && slotIndex < 3);
     fxChain[slotIndex].bypassed.store(bypassed, std::memory_order_release);
+    updateFxTail();
 }
 
 bool Channel::isPluginBypassed(int slotIndex) const
@@ -548,6 +605,153 @@ juce::AudioPluginInstance* Channel::getPlugin(int slotIndex) const
     return slot.plugin.get();
 }
 
+//==============================================================================
+// Idle Detection
+//==============================================================================
+
+int Channel::pluginTailSamples(juce::AudioPluginInstance& plugin, double sr)
+{
+    double tail = 0.0;
+    try   { tail = plugin.getTailLengthSeconds(); }
+    catch (...) { return -1; }
+
+    // Infinite (or absurd) tails keep the processor awake for good
+    if (!std::isfinite(tail) || tail * sr >= static_cast<double>(std::numeric_limits<int>::max()))
+        return -1;
+    return juce::jmax(0, static_cast<int>(std::ceil(tail * sr)));
+}
+
+juce::int64 Channel::idleDelaySamples(int tailSamples) const noexcept
+{
+    if (tailSamples < 0) return -1;
+    return juce::jmax(static_cast<juce::int64>(tailSamples),
+                      static_cast<juce::int64>(kIdleHoldSeconds * sampleRate));
+}
+
+void Channel::updateFxTail()
+{
+    int tail = 0;
+    for (auto& slot : fxChain)
+    {
+        if (!slot.plugin || slot.bypassed.load(std::memory_order_relaxed)
+                         || slot.crashed .load(std::memory_order_relaxed))
+            continue;
+
+        const int t = pluginTailSamples(*slot.plugin, sampleRate);
+        tail = (t < 0 || tail < 0) ? -1 : juce::jmax(tail, t);
+    }
+
+    fxTailSamples.store(tail, std::memory_order_release);
+    fxWakeRequested.store(true, std::memory_order_release);
+}
+
+bool Channel::updateFxLatency()
+{
+    // Bypassed and crashed slots are skipped by processFXChain() — no delay
+    int latency = 0;
+    for (auto& slot : fxChain)
+    {
+        if (!slot.plugin || slot.active.load(std::memory_order_relaxed) == nullptr
+                         || slot.bypassed.load(std::memory_order_relaxed)
+                         || slot.crashed .load(std::memory_order_relaxed))
+            continue;
+
+        try   { latency += juce::jmax(0, slot.plugin->getLatencySamples()); }
+        catch (...) {}
+    }
+
+    return fxLatencySamples.exchange(latency, std::memory_order_relaxed) != latency;
+}
+
+void Channel::setNonRealtime(bool isNonRealtime)
+{
+    for (auto& slot : fxChain)
+        if (slot.plugin && !slot.crashed.load(std::memory_order_relaxed))
+        {
+            try   { slot.plugin->setNonRealtime(isNonRealtime); }
+            catch (...) { slot.crashed.store(true, std::memory_order_release); }
+        }
+}
+
+bool Channel::isFxChainIdle(float mixPeak, ChannelState currentState) noexcept
+{
+    const bool wakeUp = mixPeak > SilenceTracker::kFloor
+                     || currentState != lastBlockState
+                     || (fxWakeRequested.load(std::memory_order_relaxed)
+                         && fxWakeRequested.exchange(false, std::memory_order_acq_rel));
+    lastBlockState = currentState;
+
+    if (wakeUp)
+        fxIdle.wake();
+
+    fxSuspended.store(fxIdle.asleep, std::memory_order_relaxed);
+    return fxIdle.asleep;
+}
+
+void Channel::trackFxOutput(int numSamples) noexcept
+{
+    float peak = 0.0f;
+    for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
+    {
+        const auto range = juce::FloatVectorOperations::findMinAndMax(fxBuffer.getReadPointer(ch), numSamples);
+        peak = juce::jmax(peak, std::abs(range.getStart()), std::abs(range.getEnd()));
+    }
+
+    fxIdle.update(peak, numSamples, idleDelaySamples(fxTailSamples.load(std::memory_order_relaxed)));
+}
+
+//==============================================================================
+// Metering
+//==============================================================================
+
+void Channel::meterInput(int numSamples) noexcept
+{
+    std::atomic<float>* peakStores[] = { &inputPeakL, &inputPeakR };
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        const float* d   = workingBuffer.getReadPointer(ch);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(d, numSamples);
+        const float peak = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
+
+        peakStores[ch]->store(peak, std::memory_order_relaxed);
+        blockFrame.inputPeak [ch] = peak;
+        blockFrame.inputSumSq[ch] = MeterFrame::sumOfSquares(d, numSamples);
+
+        if (peak >= 1.0f)
+            blockFrame.flags |= MeterFrame::InputClip;
+    }
+}
+
+void Channel::meterLoop(const juce::AudioBuffer<float>& buf, int numSamples, float peakL, float peakR) noexcept
+{
+    loopPeakL.store(peakL, std::memory_order_relaxed);
+    loopPeakR.store(peakR, std::memory_order_relaxed);
+
+    blockFrame.loopPeak[0]  = peakL;
+    blockFrame.loopPeak[1]  = peakR;
+    blockFrame.loopSumSq[0] = MeterFrame::sumOfSquares(buf.getReadPointer(0), numSamples);
+    blockFrame.loopSumSq[1] = MeterFrame::sumOfSquares(buf.getReadPointer(1), numSamples);
+    blockFrame.flags |= MeterFrame::LoopLive;
+
+    if (juce::jmax(peakL, peakR) >= 1.0f)
+        blockFrame.flags |= MeterFrame::LoopClip;
+}
+
+void Channel::meterLoopSilent() noexcept
+{
+    loopPeakL.store(0.0f, std::memory_order_relaxed);
+    loopPeakR.store(0.0f, std::memory_order_relaxed);
+}
+
+void Channel::publishMeters(juce::int64 playhead, int numSamples) noexcept
+{
+    blockFrame.playhead   = playhead;
+    blockFrame.numSamples = static_cast<juce::uint32>(numSamples);
+    telemetry.push(blockFrame);   // dropped if the GUI is not draining
+    blockFrame = MeterFrame();
+}
+
 //==============================================================================
 // Loop Buffer I/O (Message Thread)
 //==============================================================================
@@ -565,8 +769,9 @@ bool Channel::loadLoopData(int section, const juce::AudioBuffer<float>& source,
 
     if (loopBufferSize == 0) return false;
 
-    // Ensure section is allocated
+    // Ensure section is allocated (and its layers unpacked — they stay)
     allocateSection(section);
+    restoreSectionNow(section);
 
     auto& sec = sections[section];
     const juce::int64 samplesToLoad = juce::jmin(numSamples, loopBufferSize);
@@ -574,8 +779,8 @@ bool Channel::loadLoopData(int section, const juce::AudioBuffer<float>& source,
     if (source.getNumSamples() < static_cast<int>(samplesToLoad)) return false;
 
     sec.loopBuffer.clear();
-    for (int ch = 0; ch < 2; ++ch)
-        sec.loopBuffer.copyFrom(ch, 0, source, ch, 0, static_cast<int>(samplesToLoad));
+    sec.loopBuffer.write(source, 0, 0, static_cast<int>(samplesToLoad), false, false);
+    sec.bumpContent();
 
     sec.loopHasContent.store(true, std::memory_order_release);
     return true;
@@ -589,16 +794,19 @@ void Channel::processFXChain(juce::AudioBuffer<float>& buffer,
                              int numSamples,
                              juce::MidiBuffer& midiBuffer)
 {
-    for (auto& slot : fxChain)
+    for (size_t i = 0; i < fxChain.size(); ++i)
     {
+        auto& slot = fxChain[i];
         if (slot.bypassed.load(std::memory_order_acquire)) continue;
         if (slot.crashed .load(std::memory_order_acquire)) continue;
-        if (!slot.plugin)                                   continue;
+        auto* plugin = slot.active.load(std::memory_order_acquire);
+        if (plugin == nullptr)                              continue;
         {
+            RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelFx1 + static_cast<int>(i)));
             juce::AudioBuffer<float> view (buffer.getArrayOfWritePointers(),
                                            buffer.getNumChannels(),
                                            numSamples);
-            if (!pluginCallProcessBlock (slot.plugin.get(), view, midiBuffer))
+            if (!pluginCallProcessBlock (plugin, view, midiBuffer))
             {
                 slot.crashed.store (true, std::memory_order_release);
                 DBG ("FX plugin crashed in channel " + juce::String (channelIndex));
@@ -608,7 +816,8 @@ void Channel::processFXChain(juce::AudioBuffer<float>& buffer,
 }
 
 void Channel::recordToLoop(const juce::AudioBuffer<float>& source,
-                           juce::int64 startPosition, int numSamples, bool isOverdub)
+                           juce::int64 startPosition, int numSamples, bool isOverdub,
+                           juce::int64 loopLength)
 {
     if (numSamples <= 0 || startPosition < 0) return;
     if (source.getNumSamples() < numSamples) return;
@@ -617,158 +826,383 @@ void Channel::recordToLoop(const juce::AudioBuffer<float>& source,
     auto& sec = sections[s];
 
     if (isOverdub && sec.activeOverdubLayerIdx >= 0 &&
-        sec.activeOverdubLayerIdx < static_cast<int>(sec.overdubLayers.size()))
+        sec.activeOverdubLayerIdx < sec.numOverdubLayers.load(std::memory_order_relaxed))
     {
-        auto& layer = sec.overdubLayers[sec.activeOverdubLayerIdx];
-        writeBufferWrapped(layer, layer.getNumSamples(), source, startPosition, numSamples, true);
+        auto& layer = sec.overdubLayers[static_cast<size_t>(sec.activeOverdubLayerIdx)];
+        layer.writeWrapped(source, startPosition, numSamples, true);
+        queueWaveformDirty(s, sec.activeOverdubLayerIdx, startPosition, numSamples);
+        if (recordJournal != nullptr)
+            recordJournal->audioWritten(channelIndex, s, true, source, 0, startPosition, numSamples);
     }
     else
     {
         if (loopBufferSize <= 0) return;
-        writeBufferWrapped(sec.loopBuffer, loopBufferSize, source, startPosition, numSamples, false);
+
+        // The buffer wraps at its capacity, the loop at loopLength: a block
+        // running over the loop end goes on at its start, like the playhead
+        const juce::int64 wrap = loopLength > 0 ? juce::jmin(loopLength, loopBufferSize) : loopBufferSize;
+        juce::int64 pos = startPosition % wrap;
+        for (int done = 0; done < numSamples;)
+        {
+            const int n = static_cast<int>(juce::jmin<juce::int64>(numSamples - done, wrap - pos));
+            sec.loopBuffer.write(source, done, pos, n, false);
+            queueWaveformDirty(s, -1, pos, n);
+            if (recordJournal != nullptr)
+                recordJournal->audioWritten(channelIndex, s, false, source, done, pos, n);
+            done += n;
+            pos = 0;
+        }
+    }
+}
+
+// dest[i] = gain * sum(srcs[k][i]) for k < numSrcs; returns max |dest[i]|.
+// Works on fixed-size tiles so the accumulator stays in registers and the
+// compiler can vectorise every inner loop — dest is touched exactly once.
+static float mixSourcesWithGain(float* dest, const float* const* srcs, int numSrcs,
+                                int num, float gain) noexcept
+{
+    constexpr int kTile = 16;
+
+    if (numSrcs <= 0)
+    {
+        juce::FloatVectorOperations::clear(dest, num);
+        return 0.0f;
+    }
+
+    float lanePeak[kTile] = {};
+    int i = 0;
+
+    for (; i + kTile <= num; i += kTile)
+    {
+        float acc[kTile];
+        for (int j = 0; j < kTile; ++j) acc[j] = srcs[0][i + j];
+
+        for (int k = 1; k < numSrcs; ++k)
+        {
+            const float* src = srcs[k] + i;
+            for (int j = 0; j < kTile; ++j) acc[j] += src[j];
+        }
+
+        for (int j = 0; j < kTile; ++j)
+        {
+            const float v = acc[j] * gain;
+            dest[i + j]   = v;
+            lanePeak[j]   = juce::jmax(lanePeak[j], std::abs(v));
+        }
+    }
+
+    float peak = 0.0f;
+    for (int j = 0; j < kTile; ++j) peak = juce::jmax(peak, lanePeak[j]);
+
+    for (; i < num; ++i)
+    {
+        float acc = srcs[0][i];
+        for (int k = 1; k < numSrcs; ++k) acc += srcs[k][i];
+        dest[i] = acc * gain;
+        peak    = juce::jmax(peak, std::abs(dest[i]));
     }
+
+    return peak;
 }
 
 void Channel::playFromLoop(juce::AudioBuffer<float>& dest,
-                           juce::int64 startPosition, int numSamples)
+                           juce::int64 startPosition, int numSamples,
+                           float gain, float& peakL, float& peakR)
 {
-    if (numSamples <= 0 || startPosition < 0 || loopBufferSize <= 0) return;
+    peakL = peakR = 0.0f;
+    if (numSamples <= 0 || dest.getNumChannels() < 2) return;
 
     int s = activeSection.load(std::memory_order_relaxed);
 
     // Fallback: if active section has no content, try previous sections
     while (s > 0 && !sections[s].loopHasContent.load(std::memory_order_relaxed))
         --s;
-    if (!sections[s].loopHasContent.load(std::memory_order_relaxed))
+    if (startPosition < 0 || loopBufferSize <= 0
+        || !sections[s].loopHasContent.load(std::memory_order_relaxed))
+    {
+        dest.clear(0, numSamples);
         return;
+    }
 
     auto& sec = sections[s];
 
-    // Base layer (copyFrom)
-    readBufferWrapped(sec.loopBuffer, loopBufferSize, dest, startPosition, numSamples, false);
+    // Base + overdub layers; each wraps at its own length
+    const PagedLoopBuffer* layers[MAX_OVERDUB_LAYERS + 1];
+    juce::int64            readPos[MAX_OVERDUB_LAYERS + 1];
+    int numSources = 0;
 
-    // Overdub layers (addFrom)
-    for (auto& layer : sec.overdubLayers)
+    auto addSource = [&](const PagedLoopBuffer& b)
     {
-        const juce::int64 layerSize = layer.getNumSamples();
-        if (layerSize > 0)
-            readBufferWrapped(layer, layerSize, dest, startPosition, numSamples, true);
-    }
-}
+        if (b.getCapacity() <= 0) return;
+        layers [numSources] = &b;
+        readPos[numSources] = startPosition % b.getCapacity();
+        ++numSources;
+    };
+
+    addSource(sec.loopBuffer);
+    const int numLayers = sec.numOverdubLayers.load(std::memory_order_acquire);
+    for (int i = 0; i < numLayers; ++i)
+        addSource(sec.overdubLayers[static_cast<size_t>(i)]);
+
+    float* outL = dest.getWritePointer(0);
+    float* outR = dest.getWritePointer(1);
+
+    // Walk the block in segments over which every source is contiguous
+    // (no page edge, no wrap), then mix both channels in one pass each.
+    int done = 0;
+    int numDenormals = 0;
+    while (done < numSamples)
+    {
+        const float* srcL[MAX_OVERDUB_LAYERS + 1];
+        const float* srcR[MAX_OVERDUB_LAYERS + 1];
+        int numLive = 0;
+        int seg     = numSamples - done;
 
-//==============================================================================
-// Buffer I/O helpers with wrap-around
-//==============================================================================
+        for (int k = 0; k < numSources; ++k)
+        {
+            int avail = 0;
+            const float* l = layers[k]->getReadSpan(0, readPos[k], avail);
+            avail = static_cast<int>(juce::jmin(static_cast<juce::int64>(avail),
+                                                layers[k]->getCapacity() - readPos[k]));
+            seg = juce::jmin(seg, avail);
 
-void Channel::readBufferWrapped(const juce::AudioBuffer<float>& src, juce::int64 bufSize,
-                                juce::AudioBuffer<float>& dest, juce::int64 startPos,
-                                int numSamples, bool addToDest)
-{
-    if (bufSize <= 0) return;
+            if (l != nullptr)   // unmapped page = silence
+            {
+                int unused = 0;
+                srcL[numLive] = l;
+                srcR[numLive] = layers[k]->getReadSpan(1, readPos[k], unused);
+                ++numLive;
+            }
+        }
+
+        peakL = juce::jmax(peakL, mixSourcesWithGain(outL + done, srcL, numLive, seg, gain));
+        peakR = juce::jmax(peakR, mixSourcesWithGain(outR + done, srcR, numLive, seg, gain));
 
-    juce::int64 readPos   = startPos % bufSize;
-    int         destPos   = 0;
-    int         remaining = numSamples;
+        if (numLive > 0)
+            numDenormals += DenormalPolicy::countDenormals(outL + done, seg)
+                          + DenormalPolicy::countDenormals(outR + done, seg);
+
+        done += seg;
+        for (int k = 0; k < numSources; ++k)
+            readPos[k] = (readPos[k] + seg) % layers[k]->getCapacity();
+    }
+
+    DenormalPolicy::noteLoopDenormals(numDenormals);
+}
 
-    while (remaining > 0)
+void Channel::playFromLoopSmoothed(juce::AudioBuffer<float>& dest,
+                                   juce::int64 startPosition, int numSamples,
+                                   float& peakL, float& peakR)
+{
+    // Steady fader: gain folds into the layer mix as before
+    if (gainRamp == nullptr)
     {
-        const int thisBlock = static_cast<int>(
-            juce::jmin(static_cast<juce::int64>(remaining), bufSize - readPos));
-        if (thisBlock <= 0 || destPos + thisBlock > dest.getNumSamples()) break;
+        playFromLoop(dest, startPosition, numSamples, gainSmoother.getCurrent(), peakL, peakR);
+        return;
+    }
 
-        for (int ch = 0; ch < juce::jmin(2, dest.getNumChannels()); ++ch)
-        {
-            if (addToDest)
-                dest.addFrom(ch, destPos, src, ch, static_cast<int>(readPos), thisBlock);
-            else
-                dest.copyFrom(ch, destPos, src, ch, static_cast<int>(readPos), thisBlock);
-        }
+    playFromLoop(dest, startPosition, numSamples, 1.0f, peakL, peakR);
 
-        destPos   += thisBlock;
-        remaining -= thisBlock;
-        readPos    = (readPos + thisBlock) % bufSize;
+    float* peaks[] = { &peakL, &peakR };
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        float* d = dest.getWritePointer(ch);
+        juce::FloatVectorOperations::multiply(d, gainRamp, numSamples);
+        const auto range = juce::FloatVectorOperations::findMinAndMax(d, numSamples);
+        *peaks[ch] = juce::jmax(std::abs(range.getStart()), std::abs(range.getEnd()));
     }
 }
 
-void Channel::writeBufferWrapped(juce::AudioBuffer<float>& dst, juce::int64 bufSize,
-                                 const juce::AudioBuffer<float>& src, juce::int64 startPos,
-                                 int numSamples, bool addToBuffer)
+bool Channel::playOneShotVoices(juce::AudioBuffer<float>& dest, int numSamples,
+                                float& peakL, float& peakR)
 {
-    if (bufSize <= 0) return;
+    peakL = peakR = 0.0f;
+    auto& voices = oneShotVoices;
+    const juce::int64 len = oneShotLength.load(std::memory_order_relaxed);
+    if (len <= 0 || numSamples <= 0 || dest.getNumChannels() < 2
+        || voices.getNumActive() + voices.getNumReleasing() == 0)
+        return false;
+
+    // Same section fallback as playFromLoop()
+    int s = activeSection.load(std::memory_order_relaxed);
+    while (s > 0 && !sections[s].loopHasContent.load(std::memory_order_relaxed))
+        --s;
+    if (!sections[s].loopHasContent.load(std::memory_order_relaxed))
+    {
+        voices.stopAll();
+        return false;
+    }
+
+    // One-shot takes never overdub (startOneShotRecord() clears the layers): base buffer only
+    const PagedLoopBuffer& take = sections[s].loopBuffer;
+    const float steady = (gainRamp == nullptr) ? gainSmoother.getCurrent() : 1.0f;
 
-    juce::int64 writePos = startPos % bufSize;
-    int         srcPos   = 0;
-    int         remaining = numSamples;
+    float* outL = dest.getWritePointer(0);
+    float* outR = dest.getWritePointer(1);
 
-    while (remaining > 0)
+    //--- 1. FUSED VOICE PASS ---
+    // Segments over which every voice is contiguous (no page edge, no start,
+    // no end); each segment gathers all live voices and sums them once.
+    juce::int64* pos = voices.getPositions();
+    const int numVoices = voices.getNumActive();
+
+    int done = 0;
+    int numDenormals = 0;
+    while (done < numSamples)
     {
-        const int thisBlock = static_cast<int>(
-            juce::jmin(static_cast<juce::int64>(remaining), bufSize - writePos));
-        if (thisBlock <= 0) break;
+        const float* srcL[OneShotVoicePool::kMaxVoices];
+        const float* srcR[OneShotVoicePool::kMaxVoices];
+        int numLive = 0;
+        int seg     = numSamples - done;
 
-        for (int ch = 0; ch < juce::jmin(2, src.getNumChannels()); ++ch)
+        for (int v = 0; v < numVoices; ++v)
         {
-            if (addToBuffer)
-                dst.addFrom(ch, static_cast<int>(writePos), src, ch, srcPos, thisBlock);
-            else
-                dst.copyFrom(ch, static_cast<int>(writePos), src, ch, srcPos, thisBlock);
+            const juce::int64 p = pos[v];
+            if (p < 0)                      // triggered later in this block
+            {
+                seg = static_cast<int>(juce::jmin(static_cast<juce::int64>(seg), -p));
+                continue;
+            }
+            if (p >= len) continue;         // finished, retired below
+
+            int avail = 0;
+            const float* l = take.getReadSpan(0, p, avail);
+            if (avail <= 0) { pos[v] = len; continue; }
+            seg = static_cast<int>(juce::jmin(static_cast<juce::int64>(seg),
+                                              juce::jmin(static_cast<juce::int64>(avail), len - p)));
+
+            if (l != nullptr)   // unmapped page = silence
+            {
+                int unused = 0;
+                srcL[numLive] = l;
+                srcR[numLive] = take.getReadSpan(1, p, unused);
+                ++numLive;
+            }
         }
 
-        srcPos    += thisBlock;
-        remaining -= thisBlock;
-        writePos   = (writePos + thisBlock) % bufSize;
+        peakL = juce::jmax(peakL, mixSourcesWithGain(outL + done, srcL, numLive, seg, steady));
+        peakR = juce::jmax(peakR, mixSourcesWithGain(outR + done, srcR, numLive, seg, steady));
+
+        if (numLive > 0)
+            numDenormals += DenormalPolicy::countDenormals(outL + done, seg)
+                          + DenormalPolicy::countDenormals(outR + done, seg);
+
+        done += seg;
+        for (int v = 0; v < numVoices; ++v)
+            pos[v] += seg;
     }
-}
+    DenormalPolicy::noteLoopDenormals(numDenormals);
 
-//==============================================================================
-// Overdub Layer Management
-//==============================================================================
+    //--- 2. STOLEN VOICES ---
+    // Rare (only after a steal) and short — plain per-sample fade on top.
+    const bool anyRelease = voices.getNumReleasing() > 0;
+    for (int r = 0; r < voices.getNumReleasing(); ++r)
+    {
+        auto& rel = voices.getRelease(r);
+        for (int i = 0; i < numSamples && rel.fadeLeft > 0 && rel.position < len;)
+        {
+            int avail = 0, unused = 0;
+            const float* l  = take.getReadSpan(0, rel.position, avail);
+            const float* rr = take.getReadSpan(1, rel.position, unused);
+            const int n = static_cast<int>(juce::jmin(static_cast<juce::int64>(numSamples - i),
+                                                      juce::jmin(static_cast<juce::int64>(avail),
+                                                                 len - rel.position)));
+            if (n <= 0) { rel.fadeLeft = 0; break; }
+
+            for (int k = 0; k < n; ++k, ++i)
+            {
+                float g = steady;
+                if (rel.delay > 0)
+                    --rel.delay;
+                else if (rel.fadeLeft > 0)
+                    g *= static_cast<float>(rel.fadeLeft--) / static_cast<float>(OneShotVoicePool::kStealFadeSamples);
+                else
+                    g = 0.0f;
+
+                if (l != nullptr)
+                {
+                    outL[i] += l[k]  * g;
+                    outR[i] += rr[k] * g;
+                }
+            }
+            rel.position += n;
+        }
+    }
 
-void Channel::stageOverdubBuffer(juce::int64 loopLength)
-{
-    stageOverdubBuffer(loopLength, activeSection.load(std::memory_order_relaxed));
+    //--- 3. FADER RAMP + PEAKS ---
+    if (gainRamp != nullptr)
+    {
+        juce::FloatVectorOperations::multiply(outL, gainRamp, numSamples);
+        juce::FloatVectorOperations::multiply(outR, gainRamp, numSamples);
+    }
+    if (gainRamp != nullptr || anyRelease)
+    {
+        const auto rangeL = juce::FloatVectorOperations::findMinAndMax(outL, numSamples);
+        const auto rangeR = juce::FloatVectorOperations::findMinAndMax(outR, numSamples);
+        peakL = juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd()));
+        peakR = juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd()));
+    }
+
+    voices.retireFinished(len);
+    return true;
 }
 
-void Channel::stageOverdubBuffer(juce::int64 loopLength, int section)
+bool Channel::applyMuteFade(juce::AudioBuffer<float>& buffer, int numSamples, bool mutedNow) noexcept
 {
-    if (loopLength <= 0 || section < 0 || section >= NUM_SECTIONS) return;
-    auto* buf = new juce::AudioBuffer<float>(2, static_cast<int>(loopLength));
-    buf->clear();
-    auto* old = sections[section].stagedOverdubBuffer.exchange(buf, std::memory_order_release);
-    delete old;
+    const float* ramp = muteFade.process(mutedNow ? 0.0f : 1.0f, numSamples);
+    if (ramp == nullptr)
+        return muteFade.getCurrent() > 0.0f;
+
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        juce::FloatVectorOperations::multiply(buffer.getWritePointer(ch), ramp, numSamples);
+    return true;
 }
 
+//==============================================================================
+// Overdub Layer Management
+//==============================================================================
+
 void Channel::undoLastOverdub()
 {
     const int s = activeSection.load(std::memory_order_relaxed);
     auto& sec = sections[s];
 
-    if (sec.overdubLayers.empty()) return;
+    const int n = sec.numOverdubLayers.load(std::memory_order_relaxed);
+    if (n <= 0) return;
 
     const auto cur = state.load(std::memory_order_relaxed);
-    if (cur == ChannelState::Overdubbing &&
-        sec.activeOverdubLayerIdx == static_cast<int>(sec.overdubLayers.size()) - 1)
+    if (cur == ChannelState::Overdubbing && sec.activeOverdubLayerIdx == n - 1)
     {
         sec.activeOverdubLayerIdx = -1;
-        sec.overdubLayers.pop_back();
+        sec.numOverdubLayers.store(n - 1, std::memory_order_release);
+        sec.overdubLayers[static_cast<size_t>(n - 1)].clear();
+        sec.bumpLayout();
         state.store(ChannelState::Playing, std::memory_order_release);
     }
     else if (cur != ChannelState::Overdubbing)
     {
-        sec.overdubLayers.pop_back();
+        sec.numOverdubLayers.store(n - 1, std::memory_order_release);
+        sec.overdubLayers[static_cast<size_t>(n - 1)].clear();
+        sec.bumpLayout();
     }
+    else
+    {
+        return;   // overdubbing on a layer below the top: nothing undone
+    }
+
+    if (recordJournal != nullptr)
+        recordJournal->layerUndone(channelIndex, s);
 }
 
 int Channel::getOverdubLayerCount() const
 {
     const int s = activeSection.load(std::memory_order_relaxed);
-    return static_cast<int>(sections[s].overdubLayers.size());
+    return sections[s].numOverdubLayers.load(std::memory_order_relaxed);
 }
 
 bool Channel::canUndoOverdub() const
 {
-    const int s = activeSection.load(std::memory_order_relaxed);
-    return !sections[s].overdubLayers.empty();
+    return getOverdubLayerCount() > 0;
 }
 
 bool Channel::loadOverdubLayer(const juce::AudioBuffer<float>& source, juce::int64 numSamples)
@@ -780,21 +1214,1030 @@ bool Channel::loadOverdubLayer(int section, const juce::AudioBuffer<float>& sour
 {
     if (section < 0 || section >= NUM_SECTIONS) return false;
     if (numSamples <= 0 || source.getNumChannels() < 2) return false;
+    if (loopBufferSize == 0) return false;
 
     allocateSection(section);
+    restoreSectionNow(section);
     auto& sec = sections[section];
-    sec.overdubLayers.emplace_back(2, static_cast<int>(numSamples));
-    auto& layer = sec.overdubLayers.back();
-    for (int ch = 0; ch < 2; ++ch)
-        layer.copyFrom(ch, 0, source, ch, 0, static_cast<int>(numSamples));
 
+    const int n = sec.numOverdubLayers.load(std::memory_order_relaxed);
+    if (n >= MAX_OVERDUB_LAYERS) return false;
+
+    auto& layer = sec.overdubLayers[static_cast<size_t>(n)];
+    const juce::int64 len = juce::jmin(numSamples, loopBufferSize,
+                                       static_cast<juce::int64>(source.getNumSamples()));
+    layer.clear();
+    layer.setLength(len);
+    layer.write(source, 0, 0, static_cast<int>(len), false, false);
+
+    sec.markLayerAdded(n);
+    sec.numOverdubLayers.store(n + 1, std::memory_order_release);
+    sec.bumpLayout();
     return true;
 }
 
-const std::vector<juce::AudioBuffer<float>>& Channel::getOverdubLayers() const
+void Channel::swapInStandbySection(int section, StandbySection& standby) noexcept
 {
-    const int s = activeSection.load(std::memory_order_relaxed);
-    return sections[s].overdubLayers;
+    if (section < 0 || section >= NUM_SECTIONS) return;
+    swapSectionStorage(section, standby);
+    resetTier(section);   // anything packed belonged to the old audio
+}
+
+void Channel::swapSectionStorage(int section, StandbySection& standby) noexcept
+{
+    auto& sec = sections[section];
+
+    const int oldLayers = sec.numOverdubLayers.load(std::memory_order_relaxed);
+    const int count     = juce::jmax(oldLayers, standby.numLayers);
+
+    sec.bumpContent();   // before and after, so snapshotSection() sees the swap in progress
+    sec.loopBuffer.swapWith(standby.base);
+    for (int i = 0; i < count; ++i)
+        sec.overdubLayers[static_cast<size_t>(i)].swapWith(standby.layers[static_cast<size_t>(i)]);
+
+    sec.numOverdubLayers.store(standby.numLayers, std::memory_order_release);
+    standby.numLayers = oldLayers;
+
+    const bool hadContent = sec.loopHasContent.load(std::memory_order_relaxed);
+    sec.loopHasContent.store(standby.hasContent, std::memory_order_release);
+    standby.hasContent = hadContent;
+
+    sec.activeOverdubLayerIdx = -1;
+
+    // A consolidation prepared for the old audio is stale now
+    if (sec.flattenMergedLayers.load(std::memory_order_acquire) > 0)
+    {
+        sec.flattenBuffer.clear();
+        sec.flattenMergedLayers.store(0, std::memory_order_release);
+    }
+    sec.bumpLayout();
+}
+
+//==============================================================================
+// Layer Consolidation
+//==============================================================================
+
+void Channel::setLayerConsolidation(int maxLayers, int depth)
+{
+    const int maxL = juce::jlimit(1, MAX_OVERDUB_LAYERS, maxLayers);
+    maxOverdubLayers.store(maxL, std::memory_order_release);
+    undoDepth.store(juce::jlimit(1, maxL, depth), std::memory_order_release);
+}
+
+bool Channel::prepareLayerConsolidation(int section, juce::int64 sectionLoopLength)
+{
+    if (section < 0 || section >= NUM_SECTIONS || sectionLoopLength <= 0) return false;
+    auto& sec = sections[section];
+    const DenormalPolicy::Scope noDenormals;
+
+    if (!sec.allocated.load(std::memory_order_acquire) || !sec.loopHasContent.load(std::memory_order_acquire)) return false;
+    if (sec.flattenMergedLayers.load(std::memory_order_acquire) != 0) return false;  // swap pending
+    if (tiers[section].state.load(std::memory_order_acquire) != TierState::Resident) return false;  // packed or being packed
+
+    const juce::uint32 epoch = sec.layoutEpoch.load(std::memory_order_acquire);
+    const int n    = sec.numOverdubLayers.load(std::memory_order_acquire);
+    const bool full = n >= MAX_OVERDUB_LAYERS;   // the next overdub would have no slot
+    if (n <= maxOverdubLayers.load(std::memory_order_relaxed) && !full) return false;
+    const int keep = full ? juce::jmin(undoDepth.load(std::memory_order_relaxed), MAX_OVERDUB_LAYERS - 1)
+                          : undoDepth.load(std::memory_order_relaxed);
+
+    // The newest `keep` layers stay undoable; keep >= 1 protects the layer being recorded
+    const int merge = n - keep;
+    if (merge <= 0) return false;
+
+    const juce::int64 len = juce::jmin(sectionLoopLength, sec.loopBuffer.getCapacity());
+    if (sec.flattenBuffer.getMaxLength() < sec.loopBuffer.getCapacity()) return false;
+    constexpr int chunk = LoopPagePool::kPageFrames;
+    juce::AudioBuffer<float> scratch(2, chunk);
+
+    sec.flattenBuffer.clear();
+    sec.flattenBuffer.setLength(sec.loopBuffer.getCapacity());
+
+    for (juce::int64 pos = 0; pos < len; pos += chunk)
+    {
+        const int num = static_cast<int>(juce::jmin<juce::int64>(chunk, len - pos));
+        sec.loopBuffer.read(scratch, 0, pos, num, false);
+        for (int i = 0; i < merge; ++i)
+            sec.overdubLayers[static_cast<size_t>(i)].readWrapped(scratch, pos, num, true);
+        sec.flattenBuffer.write(scratch, 0, pos, num, false, false);
+
+        // Abandon early if the layout changed underneath us (undo, clear, new take)
+        if (sec.layoutEpoch.load(std::memory_order_acquire) != epoch)
+        {
+            sec.flattenBuffer.clear();
+            return false;
+        }
+    }
+
+    // Base audio past the loop end is never mixed with layers — copy mapped pages as-is
+    for (juce::int64 pos = len; pos < sec.loopBuffer.getCapacity(); pos += chunk)
+    {
+        int avail = 0;
+        if (sec.loopBuffer.getReadSpan(0, pos, avail) == nullptr) continue;
+        const int num = static_cast<int>(juce::jmin<juce::int64>(chunk, sec.loopBuffer.getCapacity() - pos));
+        sec.loopBuffer.read(scratch, 0, pos, num, false);
+        sec.flattenBuffer.write(scratch, 0, pos, num, false, false);
+    }
+
+    sec.flattenEpoch = epoch;
+    sec.flattenMergedLayers.store(merge, std::memory_order_release);
+    return true;
+}
+
+void Channel::applyPendingConsolidation(juce::int64 playheadPosition,
+                                        juce::int64 loopLength, int numSamples) noexcept
+{
+    // Same boundary rule as the latched actions in checkAndExecutePendingStop()
+    if (loopLength <= 0 || loopLength <= static_cast<juce::int64>(numSamples)
+        || playheadPosition >= static_cast<juce::int64>(numSamples))
+        return;
+
+    for (auto& sec : sections)
+    {
+        const int merge = sec.flattenMergedLayers.load(std::memory_order_acquire);
+        if (merge <= 0) continue;
+
+        const int n = sec.numOverdubLayers.load(std::memory_order_relaxed);
+        if (sec.layoutEpoch.load(std::memory_order_acquire) == sec.flattenEpoch && merge < n)
+        {
+            // base' = base + layers[0..merge) — swap it in, shift the remaining layers down
+            sec.bumpContent();
+            sec.loopBuffer.swapWith(sec.flattenBuffer);
+            for (int i = 0; i + merge < n; ++i)
+                sec.overdubLayers[static_cast<size_t>(i)].swapWith(
+                    sec.overdubLayers[static_cast<size_t>(i + merge)]);
+            sec.numOverdubLayers.store(n - merge, std::memory_order_release);
+            for (int i = n - merge; i < n; ++i)
+                sec.overdubLayers[static_cast<size_t>(i)].clear();
+
+            if (sec.activeOverdubLayerIdx >= 0)
+                sec.activeOverdubLayerIdx -= merge;
+            sec.bumpLayout();
+            if (recordJournal != nullptr)
+                recordJournal->layersFlattened(channelIndex, static_cast<int>(&sec - sections.data()), merge);
+        }
+
+        // Old base (or a stale result) goes back to the pool; clearing the flag
+        // last hands the flatten buffer back to the background thread.
+        sec.flattenBuffer.clear();
+        sec.flattenMergedLayers.store(0, std::memory_order_release);
+    }
+}
+
+bool Channel::snapshotSection(int section, SectionSnapshot& out) const
+{
+    if (section < 0 || section >= NUM_SECTIONS) return false;
+    const auto& sec = sections[section];
+
+    for (int attempt = 0; attempt < 8; ++attempt)
+    {
+        // Packed: the live buffers hold no audio, the encoded pages do
+        if (!isSectionResident(section))
+        {
+            if (snapshotPacked(section, out))
+                return true;
+            continue;   // unpacked meanwhile: the resident path has it now
+        }
+
+        const juce::uint32 epoch = sec.layoutEpoch.load(std::memory_order_acquire);
+        const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+
+        out.base.setPool(sec.loopBuffer.getPool());
+        out.base.shareFrom(sec.loopBuffer);
+
+        out.layers.resize(static_cast<size_t>(n));
+        for (int i = 0; i < n; ++i)
+        {
+            auto& layer = out.layers[static_cast<size_t>(i)];
+            if (layer == nullptr) layer = std::make_unique<PagedLoopBuffer>();
+            layer->setPool(sec.loopBuffer.getPool());
+            layer->shareFrom(sec.overdubLayers[static_cast<size_t>(i)]);
+        }
+
+        if (sec.layoutEpoch.load(std::memory_order_acquire) == epoch)
+            return true;
+
+        // Layers moved underneath us.  Only the audio thread moves them, inside
+        // one block: copy again once the block running now has ended.
+        if (reclaimer != nullptr)
+            reclaimer->waitForBlockEnd(reclaimer->getBlockEpoch());
+    }
+
+    out.base.clear();
+    out.layers.clear();
+    return false;
+}
+
+//==============================================================================
+// Section Storage Tiers
+//==============================================================================
+
+namespace
+{
+    /** decode() into a fresh pool page; the caller owns the reference. -1 if the pool is full. */
+    int decodeToNewPage(LoopPagePool& pool, const juce::MemoryBlock& data)
+    {
+        const int page = pool.acquireOrAllocate();
+        if (page < 0) return -1;
+        if (!LoopPageCodec::decode(data, pool.getPage(page)))
+            DBG("LoopPageCodec: damaged page, restored as silence");
+        return page;
+    }
+}
+
+bool Channel::isSectionResident(int s) const noexcept
+{
+    if (s < 0 || s >= NUM_SECTIONS) return true;
+    const auto st = tiers[s].state.load(std::memory_order_acquire);
+    return st == TierState::Resident || st == TierState::EvictReady;
+}
+
+juce::int64 Channel::getPackedBytes() const noexcept
+{
+    juce::int64 total = 0;
+    for (const auto& tier : tiers)
+        total += tier.packedBytes.load(std::memory_order_relaxed);
+    return total;
+}
+
+void Channel::countResidentPages(int section, int& mapped, int& resident) const
+{
+    if (section < 0 || section >= NUM_SECTIONS) return;
+    const auto& sec = sections[section];
+    if (!sec.allocated.load(std::memory_order_acquire)) return;
+    if (tiers[section].state.load(std::memory_order_acquire) != TierState::Resident) return;
+
+    // Page ids only: a page released meanwhile just miscounts once, nothing is dereferenced
+    auto count = [&](const PagedLoopBuffer& buf)
+    {
+        const auto* pool = buf.getPool();
+        if (pool == nullptr) return;
+        for (int slot = 0; slot < buf.getNumPageSlots(); ++slot)
+        {
+            const int page = buf.getMappedPage(slot);
+            if (page < 0) continue;
+            ++mapped;
+            if (pool->isPageResident(page)) ++resident;
+        }
+    };
+
+    count(sec.loopBuffer);
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+        count(sec.overdubLayers[static_cast<size_t>(i)]);
+}
+
+void Channel::getSectionMemory(int section, juce::int64& baseBytes, juce::int64& layerBytes) const
+{
+    baseBytes = layerBytes = 0;
+    if (section < 0 || section >= NUM_SECTIONS) return;
+    const auto& sec = sections[section];
+    if (!sec.allocated.load(std::memory_order_acquire)) return;
+    if (tiers[section].state.load(std::memory_order_acquire) != TierState::Resident) return;
+
+    // Page ids only, as in countResidentPages()
+    baseBytes = static_cast<juce::int64>(sec.loopBuffer.getNumMappedPages()) * LoopPagePool::kPageBytes;
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+        layerBytes += static_cast<juce::int64>(sec.overdubLayers[static_cast<size_t>(i)].getNumMappedPages())
+                      * LoopPagePool::kPageBytes;
+}
+
+void Channel::resetTier(int section) noexcept
+{
+    // A message-thread restore in the middle of its table swap finishes as Resident anyway
+    auto& state = tiers[section].state;
+    auto st = state.load(std::memory_order_acquire);
+    while (st != TierState::Swapping
+           && !state.compare_exchange_weak(st, TierState::Resident, std::memory_order_acq_rel))
+    {
+    }
+}
+
+void Channel::discardTier(SectionTier& tier)
+{
+    if (tier.swapHoldsPages)
+    {
+        tier.swap.base.clear();
+        for (auto& layer : tier.swap.layers)
+            layer.clear();
+        tier.swap.numLayers  = 0;
+        tier.swap.hasContent = false;
+        tier.swapHoldsPages  = false;
+    }
+    tier.pages.clear();
+    tier.pages.shrink_to_fit();
+    tier.cursor = 0;
+    tier.packed = false;
+    tier.packedBytes.store(0, std::memory_order_relaxed);
+}
+
+void Channel::applySectionTiers(int keepMask) noexcept
+{
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        auto& tier = tiers[s];
+        auto st = tier.state.load(std::memory_order_acquire);
+
+        if (st == TierState::EvictReady)
+        {
+            // Wanted again, or the section changed since it was read: keep it resident
+            const bool stale = sections[s].layoutEpoch.load(std::memory_order_acquire) != tier.encodeEpoch;
+            if ((keepMask & (1 << s)) != 0 || stale)
+            {
+                tier.state.compare_exchange_strong(st, TierState::Resident, std::memory_order_acq_rel);
+                continue;
+            }
+            if (!tier.state.compare_exchange_strong(st, TierState::Swapping, std::memory_order_acq_rel))
+                continue;
+
+            swapSectionStorage(s, tier.swap);   // live gets the empty shell, swap the audio
+            tier.state.store(TierState::Compressed, std::memory_order_release);
+        }
+        else if (st == TierState::RestoreReady)
+        {
+            if (!tier.state.compare_exchange_strong(st, TierState::Swapping, std::memory_order_acq_rel))
+                continue;
+
+            swapSectionStorage(s, tier.swap);   // live gets the audio back, swap the shell
+            tier.state.store(TierState::Resident, std::memory_order_release);
+        }
+    }
+}
+
+void Channel::TierBatch::run(LoopPagePool& pool)
+{
+    if (!unpack)
+    {
+        data.resize(pages.size());
+        for (size_t i = 0; i < pages.size(); ++i)
+        {
+            LoopPageCodec::encode(pool.getPage(pages[i]), data[i]);
+            pool.release(pages[i]);
+        }
+        pages.clear();
+        return;
+    }
+
+    for (const auto& d : data)
+    {
+        const int page = decodeToNewPage(pool, d);
+        if (page < 0)
+        {
+            DBG("Section tiers: page pool full, section " + juce::String(section) + " stays packed");
+            break;
+        }
+        pages.push_back(page);
+    }
+}
+
+void Channel::TierBatch::releasePages(LoopPagePool& pool) noexcept
+{
+    for (const int page : pages)
+        pool.release(page);
+    pages.clear();
+}
+
+bool Channel::updateSectionTiers(int keepMask, int compressMask, int packBudget, int unpackBudget,
+                                 std::vector<TierBatch>& batches)
+{
+    const juce::ScopedLock sl(tierLock);
+    if (sections[0].loopBuffer.getPool() == nullptr) return false;
+
+    bool didWork = false;
+
+    //--- 1. Packed sections: free what the shell replaced, unpack the wanted ones first ---
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        auto& tier = tiers[s];
+        if (tier.state.load(std::memory_order_acquire) != TierState::Compressed) continue;
+
+        // The audio the shell replaced goes back to the pool — this is the saving
+        if (tier.swapHoldsPages && tier.cursor == 0)
+        {
+            tier.swap.base.clear();
+            for (auto& layer : tier.swap.layers)
+                layer.clear();
+            tier.swapHoldsPages = false;
+            didWork = true;
+        }
+
+        TierBatch batch;
+        if ((keepMask & (1 << s)) != 0 && unpackBudget > 0 && takeUnpackBatch(s, unpackBudget, batch))
+        {
+            batches.push_back(std::move(batch));
+            didWork = true;
+        }
+    }
+
+    //--- 2. Resident sections: drop stale packed data, pack the idle ones ---
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        auto& tier = tiers[s];
+        if (tier.state.load(std::memory_order_acquire) != TierState::Resident) continue;
+
+        // Unpacked, cancelled or replaced: nothing packed belongs to the section any more
+        if (tier.packed || tier.swapHoldsPages)
+        {
+            discardTier(tier);
+            didWork = true;
+        }
+
+        const int bit = 1 << s;
+        if ((compressMask & bit) != 0 && (keepMask & bit) == 0)
+        {
+            TierBatch batch;
+            if (packBudget > 0 && takePackBatch(s, packBudget, batch))
+            {
+                batches.push_back(std::move(batch));
+                didWork = true;
+            }
+        }
+        else if (!tier.pages.empty())
+        {
+            discardTier(tier);   // wanted again before packing finished
+        }
+    }
+    return didWork;
+}
+
+bool Channel::finishTierBatch(TierBatch& batch)
+{
+    const juce::ScopedLock sl(tierLock);
+    return publishTierBatch(batch);
+}
+
+bool Channel::takePackBatch(int section, int& pageBudget, TierBatch& batch)
+{
+    auto& sec  = sections[section];
+    auto& tier = tiers[section];
+    auto* pool = sec.loopBuffer.getPool();
+
+    if (!sec.allocated.load(std::memory_order_acquire) || !sec.loopHasContent.load(std::memory_order_acquire)
+        || sec.flattenMergedLayers.load(std::memory_order_acquire) != 0)
+    {
+        if (!tier.pages.empty()) discardTier(tier);
+        return false;
+    }
+
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+    auto bufferOf = [&](int b) -> const PagedLoopBuffer&
+    {
+        return b < 0 ? sec.loopBuffer : sec.overdubLayers[static_cast<size_t>(b)];
+    };
+
+    //--- 1. First call: list the mapped pages of base and layers ---
+    const juce::uint32 epoch = sec.layoutEpoch.load(std::memory_order_acquire);
+    if (tier.pages.empty() || tier.encodeEpoch != epoch)
+    {
+        tier.pages.clear();
+        tier.cursor      = 0;
+        tier.encodeEpoch = epoch;
+        for (int b = -1; b < n; ++b)
+            for (int slot = 0; slot < bufferOf(b).getNumPageSlots(); ++slot)
+                if (bufferOf(b).getMappedPage(slot) >= 0)
+                    tier.pages.push_back({ b, slot, {} });
+        if (tier.pages.empty()) return false;   // nothing mapped (all silence)
+    }
+
+    //--- 2. Retain the next pages within the budget; run() encodes them unlocked ---
+    batch.channel = this;
+    batch.section = section;
+    batch.unpack  = false;
+    batch.epoch   = tier.encodeEpoch;
+    batch.first   = tier.cursor;
+    batch.total   = tier.pages.size();
+
+    for (size_t i = tier.cursor; i < tier.pages.size() && pageBudget > 0; ++i)
+    {
+        const auto& p   = tier.pages[i];
+        const auto& buf = bufferOf(p.buffer);
+        const int page  = buf.getMappedPage(p.slot);
+        const bool retained = page >= 0 && pool->tryRetain(page);
+        if (!retained || buf.getMappedPage(p.slot) != page)
+        {
+            if (retained) pool->release(page);
+            batch.releasePages(*pool);
+            tier.pages.clear();   // layout moved underneath us — start over next slice
+            tier.cursor = 0;
+            return false;
+        }
+
+        batch.pages.push_back(page);
+        --pageBudget;
+    }
+    return !batch.pages.empty();
+}
+
+bool Channel::takeUnpackBatch(int section, int& pageBudget, TierBatch& batch)
+{
+    auto& tier = tiers[section];
+    if (!tier.packed || tier.cursor >= tier.pages.size()) return false;
+
+    batch.channel = this;
+    batch.section = section;
+    batch.unpack  = true;
+    batch.first   = tier.cursor;
+    batch.total   = tier.pages.size();
+
+    // A copy: restoreSectionNow() may still need the packed pages if this batch is dropped
+    for (size_t i = tier.cursor; i < tier.pages.size() && pageBudget > 0; ++i, --pageBudget)
+        batch.data.push_back(tier.pages[i].data);
+    return true;
+}
+
+bool Channel::publishTierBatch(TierBatch& batch)
+{
+    auto& sec  = sections[batch.section];
+    auto& tier = tiers[batch.section];
+    auto* pool = sec.loopBuffer.getPool();
+    const auto st = tier.state.load(std::memory_order_acquire);
+    const int n   = sec.numOverdubLayers.load(std::memory_order_acquire);
+
+    //--- 1. The section must be where the batch left it ---
+    const bool current = tier.cursor == batch.first && tier.pages.size() == batch.total
+                      && (batch.unpack ? (st == TierState::Compressed && tier.packed)
+                                       : (st == TierState::Resident && !tier.packed
+                                          && tier.encodeEpoch == batch.epoch
+                                          && sec.layoutEpoch.load(std::memory_order_acquire) == batch.epoch));
+    if (!current)
+    {
+        batch.releasePages(*pool);
+        return false;
+    }
+
+    if (batch.unpack)
+    {
+        auto bufferOf = [&](int b) -> PagedLoopBuffer&
+        {
+            return b < 0 ? tier.swap.base : tier.swap.layers[static_cast<size_t>(b)];
+        };
+
+        //--- 2a. First batch: same layout as the shell now live in the section ---
+        if (tier.cursor == 0)
+        {
+            tier.swap.base.copyLayoutFrom(sec.loopBuffer);
+            for (int i = 0; i < n; ++i)
+                tier.swap.layers[static_cast<size_t>(i)].copyLayoutFrom(sec.overdubLayers[static_cast<size_t>(i)]);
+            tier.swap.numLayers  = n;
+            tier.swap.hasContent = true;
+        }
+
+        for (const int page : batch.pages)
+        {
+            const auto& p = tier.pages[tier.cursor];
+            if (!bufferOf(p.buffer).adoptPage(p.slot, page))
+                pool->release(page);
+            ++tier.cursor;
+        }
+        batch.pages.clear();
+
+        if (tier.cursor < tier.pages.size())
+            return true;
+
+        //--- 3a. The audio thread swaps the unpacked set in ---
+        tier.swapHoldsPages = true;   // after the swap: the empty shell
+        auto expected = TierState::Compressed;
+        tier.state.compare_exchange_strong(expected, TierState::RestoreReady, std::memory_order_acq_rel);
+        return true;
+    }
+
+    //--- 2b. Keep the encoded pages ---
+    for (auto& d : batch.data)
+        tier.pages[tier.cursor++].data = std::move(d);
+    batch.data.clear();
+
+    if (tier.cursor < tier.pages.size())
+        return true;
+
+    //--- 3b. Shell with the same layout and no pages; the audio thread swaps it in ---
+    juce::int64 bytes = 0;
+    for (const auto& p : tier.pages)
+        bytes += static_cast<juce::int64>(p.data.getSize());
+
+    tier.swap.base.copyLayoutFrom(sec.loopBuffer);
+    for (int i = 0; i < n; ++i)
+        tier.swap.layers[static_cast<size_t>(i)].copyLayoutFrom(sec.overdubLayers[static_cast<size_t>(i)]);
+    tier.swap.numLayers  = n;
+    tier.swap.hasContent = true;
+
+    tier.packed         = true;
+    tier.swapHoldsPages = true;   // after the swap: the section's audio
+    tier.cursor         = 0;      // decode starts from the first page
+    tier.packedBytes.store(bytes, std::memory_order_relaxed);
+
+    auto expected = TierState::Resident;
+    tier.state.compare_exchange_strong(expected, TierState::EvictReady, std::memory_order_acq_rel);
+
+    DBG("Channel " + juce::String(channelIndex) + " section " + juce::String(batch.section) + ": packed "
+        + juce::String(tier.pages.size()) + " pages into " + juce::String(bytes / 1024) + " KB");
+    return true;
+}
+
+bool Channel::unpackSection(int section, int& pageBudget)
+{
+    TierBatch batch;
+    if (!takeUnpackBatch(section, pageBudget, batch)) return false;
+
+    batch.run(*sections[section].loopBuffer.getPool());
+    return publishTierBatch(batch);
+}
+
+void Channel::restoreSectionNow(int s)
+{
+    if (s < 0 || s >= NUM_SECTIONS) return;
+    const juce::ScopedLock sl(tierLock);
+    auto& tier = tiers[s];
+
+    for (;;)
+    {
+        auto st = tier.state.load(std::memory_order_acquire);
+        switch (st)
+        {
+            case TierState::Resident:
+                return;
+
+            case TierState::Swapping:   // the audio thread is exchanging tables right now
+                juce::Thread::yield();
+                break;
+
+            case TierState::EvictReady:
+                if (tier.state.compare_exchange_strong(st, TierState::Resident, std::memory_order_acq_rel))
+                    return;
+                break;
+
+            case TierState::Compressed:
+            {
+                int unlimited = std::numeric_limits<int>::max();
+                unpackSection(s, unlimited);
+                if (tier.state.load(std::memory_order_acquire) == TierState::Compressed)
+                {
+                    DBG("Channel " + juce::String(channelIndex) + ": section "
+                        + juce::String(s) + " could not be unpacked");
+                    return;
+                }
+                break;
+            }
+
+            case TierState::RestoreReady:
+                // The section is not active, so the audio thread does not read it —
+                // do its half of the handshake here instead of waiting a block
+                if (tier.state.compare_exchange_strong(st, TierState::Swapping, std::memory_order_acq_rel))
+                {
+                    swapSectionStorage(s, tier.swap);
+                    tier.state.store(TierState::Resident, std::memory_order_release);
+                    return;
+                }
+                break;
+        }
+    }
+}
+
+bool Channel::snapshotPacked(int section, SectionSnapshot& out) const
+{
+    const juce::ScopedLock sl(tierLock);
+    const auto& sec  = sections[section];
+    const auto& tier = tiers[section];
+    if (isSectionResident(section) || !tier.packed) return false;
+
+    auto* pool = sec.loopBuffer.getPool();
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+
+    out.base.setPool(pool);
+    out.base.copyLayoutFrom(sec.loopBuffer);
+    out.layers.resize(static_cast<size_t>(n));
+    for (int i = 0; i < n; ++i)
+    {
+        auto& layer = out.layers[static_cast<size_t>(i)];
+        if (layer == nullptr) layer = std::make_unique<PagedLoopBuffer>();
+        layer->setPool(pool);
+        layer->copyLayoutFrom(sec.overdubLayers[static_cast<size_t>(i)]);
+    }
+
+    for (const auto& p : tier.pages)
+    {
+        if (p.buffer >= n) continue;
+        auto& target = p.buffer < 0 ? out.base : *out.layers[static_cast<size_t>(p.buffer)];
+
+        const int page = decodeToNewPage(*pool, p.data);
+        if (page < 0) return false;
+        if (!target.adoptPage(p.slot, page))
+            pool->release(page);
+    }
+    return true;
+}
+
+//==============================================================================
+// Waveform Overviews
+//==============================================================================
+
+void Channel::queueWaveformDirty(int section, int layer, juce::int64 start, int num) noexcept
+{
+    int s1, n1, s2, n2;
+    waveformDirtyFifo.prepareToWrite(1, s1, n1, s2, n2);
+    if (n1 <= 0)
+    {
+        waveformDirtyOverflow.store(true, std::memory_order_relaxed);
+        return;
+    }
+    waveformDirty[static_cast<size_t>(s1)] = { section, layer, start, num };
+    waveformDirtyFifo.finishedWrite(1);
+}
+
+namespace
+{
+    /** Frames up to the end of the last mapped page — everything past it is silence. */
+    juce::int64 mappedExtent(const PagedLoopBuffer& buf) noexcept
+    {
+        juce::int64 extent = 0;
+        for (juce::int64 pos = 0; pos < buf.getCapacity(); pos += LoopPagePool::kPageFrames)
+        {
+            int avail = 0;
+            if (buf.getReadSpan(0, pos, avail) != nullptr)
+                extent = juce::jmin(buf.getCapacity(), pos + LoopPagePool::kPageFrames);
+        }
+        return extent;
+    }
+
+    /** Rescan a written range, split where it wraps at the buffer's length. */
+    void updateWrapped(WaveformOverview& ov, const PagedLoopBuffer& buf, juce::int64 start, juce::int64 num)
+    {
+        const juce::int64 wrap = buf.getCapacity();
+        if (wrap <= 0 || num <= 0) return;
+
+        num   = juce::jmin(num, wrap);
+        start = start % wrap;
+        const juce::int64 first = juce::jmin(num, wrap - start);
+        ov.update(buf, start, first);
+        if (first < num)
+            ov.update(buf, 0, num - first);
+    }
+
+    /** Min/max of [a, b) read from an overview that wraps at `wrap`. */
+    juce::Range<float> wrappedRange(const WaveformOverview& ov, juce::int64 wrap, juce::int64 a, juce::int64 b)
+    {
+        if (wrap <= 0) return {};
+        if (b - a >= wrap) return ov.getRange(0, wrap);
+
+        const juce::int64 span = b - a;
+        a %= wrap;
+        b = a + span;
+        if (b <= wrap) return ov.getRange(a, b);
+        return ov.getRange(a, wrap).getUnionWith(ov.getRange(0, b - wrap));
+    }
+
+    /** Scan the mapped pages of buf into a fresh overview. */
+    void scanBuffer(WaveformOverview& ov, juce::int64& wrap, const PagedLoopBuffer& buf)
+    {
+        wrap = buf.getCapacity();
+        const juce::int64 extent = mappedExtent(buf);
+        for (juce::int64 pos = 0; pos < extent; pos += LoopPagePool::kPageFrames)
+            ov.update(buf, pos, juce::jmin<juce::int64>(LoopPagePool::kPageFrames, extent - pos));
+    }
+}
+
+bool Channel::rebuildWaveform(int section, juce::uint32 epoch, juce::uint32 content)
+{
+    auto& sec = sections[section];
+
+    // Scan into a scratch set outside the lock; the GUI keeps drawing the old one
+    auto fresh = std::make_unique<SectionWaveform>();
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+
+    scanBuffer(fresh->base, fresh->baseWrap, sec.loopBuffer);
+    for (int i = 0; i < n; ++i)
+    {
+        fresh->layerSerial[static_cast<size_t>(i)] = sec.layerSerial[static_cast<size_t>(i)].load(std::memory_order_acquire);
+        scanBuffer(fresh->layers[static_cast<size_t>(i)], fresh->layerWrap[static_cast<size_t>(i)],
+                   sec.overdubLayers[static_cast<size_t>(i)]);
+    }
+
+    // Layers moved underneath us (same rule as prepareLayerConsolidation) — try again next slice
+    if (sec.layoutEpoch.load(std::memory_order_acquire) != epoch)
+        return false;
+
+    fresh->numLayers    = n;
+    fresh->builtEpoch   = epoch;
+    fresh->builtContent = content;
+    fresh->built        = true;
+
+    {
+        const juce::ScopedLock sl(waveformLock);
+        std::swap(waveforms[static_cast<size_t>(section)], *fresh);
+    }
+    waveformRevision.fetch_add(1, std::memory_order_acq_rel);
+    return true;   // old set is freed here, outside the lock
+}
+
+bool Channel::updateWaveformLayers(int section, juce::uint32 epoch)
+{
+    auto& sec = sections[section];
+    auto& wf  = waveforms[static_cast<size_t>(section)];
+    const int n = sec.numOverdubLayers.load(std::memory_order_acquire);
+
+    // Slots holding another layer than when drawn: new overdubs, loaded layers
+    struct Scanned
+    {
+        int              index;
+        juce::uint32     serial;
+        juce::int64      wrap {0};
+        WaveformOverview overview;
+    };
+    std::vector<Scanned> scanned;
+    {
+        const juce::ScopedLock sl(waveformLock);
+        for (int i = 0; i < n; ++i)
+        {
+            const auto serial = sec.layerSerial[static_cast<size_t>(i)].load(std::memory_order_acquire);
+            if (i >= wf.numLayers || wf.layerSerial[static_cast<size_t>(i)] != serial)
+                scanned.push_back({ i, serial, 0, {} });
+        }
+    }
+
+    // A layer just started is empty: only what it has recorded so far is scanned
+    for (auto& layer : scanned)
+        scanBuffer(layer.overview, layer.wrap, sec.overdubLayers[static_cast<size_t>(layer.index)]);
+
+    if (sec.layoutEpoch.load(std::memory_order_acquire) != epoch)
+        return false;
+
+    {
+        const juce::ScopedLock sl(waveformLock);
+        for (auto& layer : scanned)
+        {
+            const auto i = static_cast<size_t>(layer.index);
+            std::swap(wf.layers[i], layer.overview);
+            wf.layerWrap[i]   = layer.wrap;
+            wf.layerSerial[i] = layer.serial;
+        }
+        for (int i = n; i < wf.numLayers; ++i)
+            wf.layers[static_cast<size_t>(i)].clear();   // undone
+        wf.numLayers  = n;
+        wf.builtEpoch = epoch;
+    }
+    waveformRevision.fetch_add(1, std::memory_order_acq_rel);
+    return true;   // the overviews swapped out are freed here, outside the lock
+}
+
+bool Channel::updateWaveformOverviews()
+{
+    bool didWork = false;
+    const bool rebuildAll = waveformDirtyOverflow.exchange(false, std::memory_order_acq_rel);
+
+    //--- 1. Take the ranges the audio thread recorded ---
+    const int pending = waveformDirtyFifo.getNumReady();
+    int s1, n1, s2, n2;
+    waveformDirtyFifo.prepareToRead(pending, s1, n1, s2, n2);
+    std::vector<WaveformDirty> dirty;
+    dirty.reserve(static_cast<size_t>(n1 + n2));
+    for (int i = 0; i < n1; ++i) dirty.push_back(waveformDirty[static_cast<size_t>(s1 + i)]);
+    for (int i = 0; i < n2; ++i) dirty.push_back(waveformDirty[static_cast<size_t>(s2 + i)]);
+    waveformDirtyFifo.finishedRead(n1 + n2);
+
+    //--- 2. Sections that changed layout are rescanned whole ---
+    std::array<bool, NUM_SECTIONS> current {};
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        auto& sec = sections[s];
+        auto& wf  = waveforms[static_cast<size_t>(s)];
+
+        // loadWaveformOverview() may install a set from the message thread
+        auto isBuilt = [&](juce::uint32 epoch)
+        {
+            const juce::ScopedLock sl(waveformLock);
+            return wf.built && wf.builtEpoch == epoch;
+        };
+        auto isBuiltFrom = [&](juce::uint32 content)
+        {
+            const juce::ScopedLock sl(waveformLock);
+            return wf.built && wf.builtContent == content;
+        };
+
+        if (!sec.allocated.load(std::memory_order_acquire) || !sec.loopHasContent.load(std::memory_order_acquire))
+        {
+            // Empty section: drop what we drew (unless the first take is being recorded)
+            const bool recording = std::any_of(dirty.begin(), dirty.end(),
+                                               [s](const WaveformDirty& d) { return d.section == s; });
+            if (!recording)
+            {
+                bool shown = false;
+                {
+                    const juce::ScopedLock sl(waveformLock);
+                    shown = wf.built;
+                }
+                if (shown)
+                {
+                    auto old = std::make_unique<SectionWaveform>();
+                    {
+                        const juce::ScopedLock sl(waveformLock);
+                        std::swap(wf, *old);
+                    }
+                    waveformRevision.fetch_add(1, std::memory_order_acq_rel);
+                    didWork = true;
+                }
+                continue;
+            }
+        }
+
+        // Packed: nothing to scan — the overview drawn before packing stays
+        if (!isSectionResident(s))
+            continue;
+
+        // Layout first: bumpContent() moves the content epoch before it
+        const juce::uint32 epoch   = sec.layoutEpoch .load(std::memory_order_acquire);
+        const juce::uint32 content = sec.contentEpoch.load(std::memory_order_acquire);
+        if (rebuildAll || !isBuiltFrom(content))
+            didWork |= rebuildWaveform(s, epoch, content);
+        else if (!isBuilt(epoch))
+            didWork |= updateWaveformLayers(s, epoch);
+
+        current[static_cast<size_t>(s)] = isBuilt(epoch);
+    }
+
+    //--- 3. Incremental: only the bins under the recorded ranges ---
+    if (!dirty.empty())
+    {
+        const juce::ScopedLock sl(waveformLock);
+        for (const auto& d : dirty)
+        {
+            if (d.section < 0 || d.section >= NUM_SECTIONS || !current[static_cast<size_t>(d.section)])
+                continue;
+
+            auto& sec = sections[d.section];
+            auto& wf  = waveforms[static_cast<size_t>(d.section)];
+
+            if (d.layer < 0)
+            {
+                wf.baseWrap = sec.loopBuffer.getCapacity();
+                updateWrapped(wf.base, sec.loopBuffer, d.start, d.num);
+            }
+            else if (d.layer < wf.numLayers)
+            {
+                const auto& layer = sec.overdubLayers[static_cast<size_t>(d.layer)];
+                wf.layerWrap[static_cast<size_t>(d.layer)] = layer.getCapacity();
+                updateWrapped(wf.layers[static_cast<size_t>(d.layer)], layer, d.start, d.num);
+            }
+        }
+        waveformRevision.fetch_add(1, std::memory_order_acq_rel);
+        didWork = true;
+    }
+
+    return didWork;
+}
+
+void Channel::getWaveformColumns(int section, juce::int64 length,
+                                 juce::Range<float>* columns, int numColumns) const
+{
+    for (int c = 0; c < numColumns; ++c)
+        columns[c] = {};
+    if (section < 0 || section >= NUM_SECTIONS || length <= 0 || numColumns <= 0) return;
+
+    const juce::ScopedLock sl(waveformLock);
+    const auto& wf = waveforms[static_cast<size_t>(section)];
+    if (!wf.built) return;
+
+    for (int c = 0; c < numColumns; ++c)
+    {
+        const juce::int64 a = length * c / numColumns;
+        const juce::int64 b = juce::jmax(a + 1, length * (c + 1) / numColumns);
+
+        auto r = wrappedRange(wf.base, wf.baseWrap, a, b);
+        float lo = r.getStart(), hi = r.getEnd();
+        for (int k = 0; k < wf.numLayers; ++k)
+        {
+            r = wrappedRange(wf.layers[static_cast<size_t>(k)], wf.layerWrap[static_cast<size_t>(k)], a, b);
+            lo += r.getStart();
+            hi += r.getEnd();
+        }
+        columns[c] = { lo, hi };
+    }
+}
+
+bool Channel::loadWaveformOverview(int section, const juce::File& file)
+{
+    if (section < 0 || section >= NUM_SECTIONS) return false;
+    auto& sec = sections[section];
+    if (sec.numOverdubLayers.load(std::memory_order_acquire) != 0) return false;
+
+    auto fresh = std::make_unique<SectionWaveform>();
+    if (!fresh->base.readFrom(file))
+        return false;
+
+    // A stale file (audio longer than the overview) is rescanned instead
+    if (fresh->base.getLength() < mappedExtent(sec.loopBuffer) - LoopPagePool::kPageFrames)
+        return false;
+
+    fresh->baseWrap     = sec.loopBuffer.getCapacity();
+    fresh->builtEpoch   = sec.layoutEpoch.load(std::memory_order_acquire);
+    fresh->builtContent = sec.contentEpoch.load(std::memory_order_acquire);
+    fresh->built        = true;
+
+    {
+        const juce::ScopedLock sl(waveformLock);
+        std::swap(waveforms[static_cast<size_t>(section)], *fresh);
+    }
+    waveformRevision.fetch_add(1, std::memory_order_acq_rel);
+    return true;
 }
 
 //==============================================================================
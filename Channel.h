@@ -5,44 +5,275 @@
 #include <atomic>
 #include <vector>
 #include "Command.h"
+#include "CompensationDelay.h"
+#include "EpochReclaimer.h"
+#include "LoopPagePool.h"
+#include "MeterTelemetry.h"
+#include "OneShotVoicePool.h"
+#include "RealtimeProfiler.h"
+#include "RecordJournal.h"
+#include "SmoothedGain.h"
+#include "StemRecorder.h"
+#include "WaveformOverview.h"
 
 //==============================================================================
 enum class ChannelType  { Audio, VSTi };
 enum class ChannelState { Idle, Recording, Playing, Overdubbing };
 
-static constexpr int NUM_SECTIONS = 3;
+static constexpr int NUM_SECTIONS        = 3;
+static constexpr int MAX_OVERDUB_LAYERS  = 32;
+static constexpr int MAX_CHANNELS        = 16;   // AudioEngine::setNumChannels() upper bound
+static constexpr int DEFAULT_CHANNELS    = 6;
 
 //==============================================================================
+/**
+ * Per-block hot state of all channels as struct-of-arrays, owned by the engine.
+ *
+ * Every Channel binds references to its own slot, so channel code is unchanged;
+ * the engine's solo, pending and play-memory passes read one array — the flag
+ * of every channel in one or two cache lines — instead of one heap object per
+ * channel.
+ *
+ * Each channel index has two slots, ch and ch + MAX_CHANNELS, and liveSlot
+ * says which one the published channel binds.  A replacement channel takes the
+ * spare slot, so the channel it replaces keeps its own until it has left the
+ * audio block; a slot is reset before a channel takes it.
+ */
+struct alignas(64) ChannelHotState
+{
+    static constexpr int kSlots = MAX_CHANNELS * 2;
+
+    std::array<std::atomic<ChannelState>, kSlots> state;
+    std::array<std::atomic<float>,        kSlots> gainLinear;
+    std::array<std::atomic<bool>,         kSlots> muted;
+    std::array<std::atomic<bool>,         kSlots> solo;
+    std::array<std::atomic<bool>,         kSlots> soloMuted;
+    std::array<std::atomic<bool>,         kSlots> isActiveChannel;
+    std::array<std::atomic<bool>,         kSlots> oneShot;
+    std::array<std::atomic<bool>,         kSlots> stopPending;
+    std::array<std::atomic<bool>,         kSlots> recordPending;
+    std::array<std::atomic<bool>,         kSlots> overdubPending;
+    std::array<std::atomic<bool>,         kSlots> playPending;
+
+    std::array<std::atomic<int>, MAX_CHANNELS> liveSlot;   // per channel index: ch or ch + MAX_CHANNELS
+
+    // Records refused: section buffers not sized yet, or every overdub layer slot in use (shown by the UI)
+    enum class Refusal { SectionNotReady = 0, LayersFull };
+    std::atomic<juce::uint32> refusedRecords     {0};
+    std::atomic<int>          lastRefusedChannel {-1};
+    std::atomic<int>          lastRefusal        {0};
+
+    /** Any thread, lock-free. */
+    void noteRefusedRecord(int ch, Refusal why = Refusal::SectionNotReady) noexcept
+    {
+        lastRefusedChannel.store(ch, std::memory_order_relaxed);
+        lastRefusal.store(static_cast<int>(why), std::memory_order_relaxed);
+        refusedRecords.fetch_add(1, std::memory_order_release);
+    }
+
+    ChannelHotState() noexcept
+    {
+        for (int i = 0; i < kSlots; ++i)
+            reset(i);
+        for (int ch = 0; ch < MAX_CHANNELS; ++ch)
+            liveSlot[static_cast<size_t>(ch)].store(ch, std::memory_order_relaxed);
+    }
+
+    /** The slot the published channel ch binds. */
+    int slotOf(int ch) const noexcept
+    {
+        return liveSlot[static_cast<size_t>(ch)].load(std::memory_order_acquire);
+    }
+
+    /** The slot a replacement for channel ch takes. */
+    int spareSlotOf(int ch) const noexcept
+    {
+        return slotOf(ch) == ch ? ch + MAX_CHANNELS : ch;
+    }
+
+    /** Message thread, with the channel that binds slot published in the same step. */
+    void setLiveSlot(int ch, int slot) noexcept
+    {
+        jassert(slot == ch || slot == ch + MAX_CHANNELS);
+        liveSlot[static_cast<size_t>(ch)].store(slot, std::memory_order_release);
+    }
+
+    /** Defaults of a fresh channel. Message thread, before a channel binding slot is visible to the audio thread. */
+    void reset(int slot) noexcept
+    {
+        const auto i = static_cast<size_t>(slot);
+        state[i]          .store(ChannelState::Idle, std::memory_order_relaxed);
+        gainLinear[i]     .store(1.0f,  std::memory_order_relaxed);
+        muted[i]          .store(false, std::memory_order_relaxed);
+        solo[i]           .store(false, std::memory_order_relaxed);
+        soloMuted[i]      .store(false, std::memory_order_relaxed);
+        isActiveChannel[i].store(false, std::memory_order_relaxed);
+        oneShot[i]        .store(false, std::memory_order_relaxed);
+        stopPending[i]    .store(false, std::memory_order_relaxed);
+        recordPending[i]  .store(false, std::memory_order_relaxed);
+        overdubPending[i] .store(false, std::memory_order_relaxed);
+        playPending[i]    .store(false, std::memory_order_relaxed);
+    }
+
+    bool anySolo(int numChannels) const noexcept
+    {
+        for (int ch = 0; ch < numChannels; ++ch)
+            if (solo[static_cast<size_t>(slotOf(ch))].load(std::memory_order_relaxed))
+                return true;
+        return false;
+    }
+
+    bool hasPending(int ch) const noexcept
+    {
+        const auto i = static_cast<size_t>(slotOf(ch));
+        return recordPending[i] .load(std::memory_order_relaxed)
+            || overdubPending[i].load(std::memory_order_relaxed)
+            || playPending[i]   .load(std::memory_order_relaxed)
+            || stopPending[i]   .load(std::memory_order_relaxed);
+    }
+
+    /** Bit i set: channel i is Playing or Overdubbing and not a oneshot. */
+    juce::uint32 playingMask(int numChannels) const noexcept
+    {
+        juce::uint32 mask = 0;
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            const auto i  = static_cast<size_t>(slotOf(ch));
+            const auto st = state[i].load(std::memory_order_relaxed);
+            if ((st == ChannelState::Playing || st == ChannelState::Overdubbing)
+                && !oneShot[i].load(std::memory_order_relaxed))
+                mask |= 1u << ch;
+        }
+        return mask;
+    }
+};
+
+//==============================================================================
+/**
+ * Loop storage for one section.  Base take and overdub layers are all paged
+ * (see LoopPagePool): a layer only holds pages inside the loop length it was
+ * recorded against, and retiring a layer hands its pages back lock-free —
+ * the pool's refill thread zeroes and recycles them off the audio thread.
+ */
 struct SectionBufferSet
 {
-    juce::AudioBuffer<float> loopBuffer;
-    std::vector<juce::AudioBuffer<float>> overdubLayers;
+    PagedLoopBuffer loopBuffer;   // base take, pages mapped as recording advances
+
+    // Fixed layer slots; page tables are sized in prepareToPlay() so starting an
+    // overdub on the audio thread never allocates.
+    std::array<PagedLoopBuffer, MAX_OVERDUB_LAYERS> overdubLayers;
+    std::atomic<int> numOverdubLayers {0};
     int activeOverdubLayerIdx {-1};
-    std::atomic<juce::AudioBuffer<float>*> stagedOverdubBuffer {nullptr};
+
     std::atomic<bool> loopHasContent {false};
-    bool allocated {false};
+    std::atomic<bool> allocated {false};   // set after sizing (background/message thread), read by the audio thread
+
+    // Layer consolidation: the background thread mixes base + oldest layers into
+    // flattenBuffer; the audio thread swaps it in at the next loop boundary.
+    PagedLoopBuffer          flattenBuffer;
+    std::atomic<int>         flattenMergedLayers {0};   // >0 = flattenBuffer ready
+    juce::uint32             flattenEpoch        {0};
+    std::atomic<juce::uint32> layoutEpoch        {0};   // bumped on every structural change
+    std::atomic<juce::uint32> contentEpoch       {0};   // audio already there replaced or moved
+
+    // Which layer a slot holds: a new serial whenever a layer is added to it
+    std::array<std::atomic<juce::uint32>, MAX_OVERDUB_LAYERS> layerSerial {};
+    std::atomic<juce::uint32> nextLayerSerial {0};
 
-    ~SectionBufferSet()
+    void bumpLayout() noexcept { layoutEpoch.fetch_add(1, std::memory_order_acq_rel); }
+
+    /** Load, swap, consolidation, doubling — unlike adding or removing a layer at the end. */
+    void bumpContent() noexcept
     {
-        auto* staged = stagedOverdubBuffer.exchange(nullptr, std::memory_order_acquire);
-        delete staged;
+        contentEpoch.fetch_add(1, std::memory_order_acq_rel);
+        bumpLayout();
+    }
+
+    /** Layer n is about to be added; call before bumpLayout(). */
+    void markLayerAdded(int n) noexcept
+    {
+        layerSerial[static_cast<size_t>(n)].store(nextLayerSerial.fetch_add(1, std::memory_order_relaxed) + 1,
+                                                  std::memory_order_release);
+    }
+
+    /** Retire all overdub layers (pages go back to the pool). Lock-free. */
+    void clearOverdubLayers() noexcept
+    {
+        const int n = numOverdubLayers.exchange(0, std::memory_order_acq_rel);
+        for (int i = 0; i < n; ++i)
+            overdubLayers[static_cast<size_t>(i)].clear();
+        activeOverdubLayerIdx = -1;
+        bumpLayout();
     }
 };
 
+//==============================================================================
+/**
+ * Silence detector for skipping a processor that has nothing to do (audio thread).
+ * The processor sleeps once its output has stayed below kFloor for sleepAfter
+ * samples; the owner calls wake() on anything that could make it sound again.
+ */
+struct SilenceTracker
+{
+    static constexpr float kFloor = 1.0e-5f;   // -100 dBFS
+
+    juce::int64 silentSamples {0};
+    bool        asleep        {false};
+
+    void wake() noexcept { silentSamples = 0; asleep = false; }
+
+    /** @param sleepAfter  Silent samples before sleeping, < 0 = never sleep. */
+    void update(float outputPeak, int numSamples, juce::int64 sleepAfter) noexcept
+    {
+        if (outputPeak > kFloor) { silentSamples = 0; return; }
+        silentSamples += numSamples;
+        asleep = sleepAfter >= 0 && silentSamples >= sleepAfter;
+    }
+};
+
+//==============================================================================
+/**
+ * Loop audio for one section, filled off the audio thread (song preload) and
+ * handed to a channel with Channel::swapInStandbySection().  All page tables
+ * must be sized to the channel's loop buffer size so the swap is a pure
+ * pointer exchange.  After the swap it holds the channel's previous audio.
+ */
+struct StandbySection
+{
+    PagedLoopBuffer base;
+    std::array<PagedLoopBuffer, MAX_OVERDUB_LAYERS> layers;
+    int  numLayers  {0};
+    bool hasContent {false};
+};
+
+//==============================================================================
+/**
+ * Copy-on-write view of one section taken by Channel::snapshotSection().
+ * Shares pages with the live section; playback and overdubs keep running and
+ * copy a page only when they write to it. Used by the background song save.
+ */
+struct SectionSnapshot
+{
+    PagedLoopBuffer base;
+    std::vector<std::unique_ptr<PagedLoopBuffer>> layers;
+};
+
 //==============================================================================
 class Channel
 {
 public:
-    Channel(int channelIndex, ChannelType type);
+    /** hotState: the engine's block; this channel binds hotSlot of it (see ChannelHotState). */
+    Channel(int channelIndex, ChannelType type, ChannelHotState& hotState, int hotSlot);
     virtual ~Channel() = default;
 
     //==========================================================================
     // Audio Thread
     //==========================================================================
 
+    /** midiBuffer holds the MIDI routed to this channel only (the channel may modify it). */
     virtual void processBlock(const float* const* inputChannelData,
                               float* const*       outputChannelData,
-                              const juce::MidiBuffer& midiBuffer,
+                              juce::MidiBuffer&   midiBuffer,
                               int numSamples,
                               juce::int64 playheadPosition,
                               juce::int64 loopLength,
@@ -55,12 +286,37 @@ public:
 
     virtual void releaseResources();
 
+    /** Page pool backing the loop buffers. Set once by AudioEngine before prepareToPlay(). */
+    void setLoopPagePool(LoopPagePool* pool);
+
+    /** Stage timing sink (nullptr = not profiled). Set by AudioEngine before audio starts. */
+    void setProfiler(RealtimeProfiler* p) { profiler = p; }
+
+    /** Block epoch of the audio callback, for swaps that must wait for it. Set by AudioEngine. */
+    void setReclaimer(EpochReclaimer* r) { reclaimer = r; }
+
+    /** Stem taps (dry = pre-FX mix, post-FX = chain output). Set by AudioEngine. */
+    void setStemRecorder(StemRecorder* r) { stemRecorder = r; }
+
+    /** Crash-recovery journal fed with every take, write, undo and clear. Set by AudioEngine. */
+    void setRecordJournal(RecordJournal* j) { recordJournal = j; }
     //==========================================================================
     // State Management
     //==========================================================================
 
-    void startRecording(bool isOverdub = false);
+    /** @param loopLength  Current loop length; an overdub layer wraps at this length (0 = capacity). */
+    void startRecording(bool isOverdub = false, juce::int64 loopLength = 0);
     void stopRecording();
+
+    /**
+     * @brief Write hardware input captured before the take started at loopPos (auto-start pre-roll).
+     *
+     * Routed like live input; numSamples must fit the working buffer.  Only a
+     * channel in Recording state records.  Channels without hardware input
+     * ignore it.  Audio thread only.
+     */
+    virtual void recordPreRoll(const float* const* /*inputChannelData*/, int /*numInputChannels*/,
+                               int /*numSamples*/, juce::int64 /*loopPos*/) {}
     void startPlayback();
     void stopPlayback();
     void clearLoop();
@@ -97,13 +353,14 @@ public:
     // Oneshot independent playhead + multi-voice
     void startOneShotRecord();
     void stopOneShotRecord(juce::int64 recordedSamples);
-    void triggerOneShotPlayback();
+    /** Start a voice sampleOffset samples into the next rendered block (steals when full). */
+    void triggerOneShotPlayback(int sampleOffset = 0);
     void stopAllOneShotVoices();
     juce::int64 getOneShotLength() const   { return oneShotLength.load(std::memory_order_relaxed); }
     juce::int64 getOneShotPlayhead() const { return oneShotPlayhead.load(std::memory_order_relaxed); }
     bool isOneShotPlaying() const;
 
-    static constexpr int kMaxOneShotVoices = 8;
+    static constexpr int kMaxOneShotVoices = OneShotVoicePool::kMaxVoices;
 
     //==========================================================================
     // Routing
@@ -116,8 +373,17 @@ public:
     // Plugin Management
     //==========================================================================
 
-    void addPlugin(int slotIndex, std::unique_ptr<juce::AudioPluginInstance> plugin);
-    void removePlugin(int slotIndex);
+    /**
+     * Install a plugin (prepared here, before the audio thread can see it). Returns
+     * the instance it replaced, still prepared.  Message thread, never blocks.
+     *
+     * Returned instances may still be inside the current audio block — retire
+     * them through EpochReclaimer before touching them.
+     */
+    std::unique_ptr<juce::AudioPluginInstance> addPlugin(int slotIndex, std::unique_ptr<juce::AudioPluginInstance> plugin);
+
+    /** Take the plugin out of a slot without releasing it (for reuse). Same rules as addPlugin(). */
+    std::unique_ptr<juce::AudioPluginInstance> detachPlugin(int slotIndex);
     void setPluginBypassed(int slotIndex, bool bypassed);
     bool isPluginBypassed(int slotIndex) const;
 
@@ -135,6 +401,30 @@ public:
         return fxChain[slotIndex].crashed.load(std::memory_order_relaxed);
     }
 
+    //==========================================================================
+    // Plugin delay compensation
+
+    /** Re-read getLatencySamples() of the active FX slots. Message thread. @return true if it changed. */
+    bool updateFxLatency();
+
+    /** Summed latency of the active FX chain, as of the last updateFxLatency(). */
+    int  getFxLatencySamples() const    { return fxLatencySamples.load(std::memory_order_relaxed); }
+
+    /** Extra post-FX delay that aligns this channel to the slowest chain (set by the engine). */
+    void setCompensationDelay(int samples) { compensationDelay.store(juce::jlimit(0, CompensationDelay::kMaxDelaySamples, samples),
+                                                                     std::memory_order_relaxed); }
+    int  getCompensationDelay() const    { return compensationDelay.load(std::memory_order_relaxed); }
+
+    /** Tell the FX plugins they render faster than real time (offline bounce, audio callback parked). */
+    void setNonRealtime(bool isNonRealtime);
+
+    /**
+     * Round-trip latency subtracted from the write position of recordings into
+     * a running loop, so a take lands where the player heard the loop (set by the engine).
+     */
+    void setRecordLatency(int samples) { recordLatency.store(juce::jmax(0, samples), std::memory_order_relaxed); }
+    int  getRecordLatency() const      { return recordLatency.load(std::memory_order_relaxed); }
+
     /** Check if any plugin in the FX chain has crashed. */
     bool hasAnyCrashedPlugin() const
     {
@@ -157,8 +447,14 @@ public:
     float getLoopPeakL()   const { return loopPeakL.load(std::memory_order_relaxed); }
     float getLoopPeakR()   const { return loopPeakR.load(std::memory_order_relaxed); }
 
+    /** Everything metered since the last call (peak, RMS, clips). Message thread, one caller. */
+    MeterSummary drainMeterTelemetry() noexcept { return telemetry.drain(); }
+
     bool hasLoop()       const;
     bool isIdle()        const { return getState() == ChannelState::Idle; }
+
+    /** true while the FX chain and output routing are skipped because the channel is silent. */
+    bool isProcessingSuspended() const { return fxSuspended.load(std::memory_order_relaxed); }
     bool isRecording()   const { return getState() == ChannelState::Recording; }
     bool isPlaying()     const { return getState() == ChannelState::Playing; }
     bool isOverdubbing() const { return getState() == ChannelState::Overdubbing; }
@@ -171,7 +467,19 @@ public:
     int  getActiveSection() const { return activeSection.load(std::memory_order_relaxed); }
     bool sectionHasContent(int s) const;
     bool hasContentInAnySection() const;
+
+    /**
+     * Size the page tables of a section. Any thread except the audio thread —
+     * normally the engine's background thread, ahead of first use.  Until it
+     * has run, recording on the section is refused (see startRecording()).
+     */
     void allocateSection(int s);
+
+    /** true once allocateSection() has sized the section. Audio thread safe. */
+    bool isSectionAllocated(int s) const
+    {
+        return s >= 0 && s < NUM_SECTIONS && sections[s].allocated.load(std::memory_order_acquire);
+    }
     void clearSection(int s);
     void clearAllSections();
 
@@ -180,13 +488,16 @@ public:
     //==========================================================================
 
     /** Read-only access to loop buffer for active section. */
-    const juce::AudioBuffer<float>& getLoopBuffer() const { return sections[activeSection.load(std::memory_order_relaxed)].loopBuffer; }
+    const PagedLoopBuffer& getLoopBuffer() const { return sections[activeSection.load(std::memory_order_relaxed)].loopBuffer; }
 
     /** Read-only access to a specific section's loop buffer. */
-    const juce::AudioBuffer<float>& getSectionLoopBuffer(int s) const { return sections[s].loopBuffer; }
+    const PagedLoopBuffer& getSectionLoopBuffer(int s) const { return sections[s].loopBuffer; }
+
+    /** Number of overdub layers in a specific section. */
+    int getSectionOverdubLayerCount(int s) const { return sections[s].numOverdubLayers.load(std::memory_order_acquire); }
 
-    /** Read-only access to a specific section's overdub layers. */
-    const std::vector<juce::AudioBuffer<float>>& getSectionOverdubLayers(int s) const { return sections[s].overdubLayers; }
+    /** Read-only access to one overdub layer of a specific section. */
+    const PagedLoopBuffer& getSectionOverdubLayer(int s, int layer) const { return sections[s].overdubLayers[static_cast<size_t>(layer)]; }
 
     /** Max capacity in samples (0 if prepareToPlay not yet called). */
     juce::int64                     getLoopBufferSize() const { return loopBufferSize; }
@@ -198,14 +509,39 @@ public:
     bool loadLoopData(int section, const juce::AudioBuffer<float>& source, juce::int64 numSamples);
 
     //==========================================================================
-    // Overdub Layers
+    // Waveform Overviews (see WaveformOverview.h)
     //==========================================================================
 
-    /** Pre-allocate a buffer for the next overdub pass (call on message thread). */
-    void stageOverdubBuffer(juce::int64 loopLength);
+    /**
+     * @brief Rescan the ranges recorded since the last call. Background thread.
+     *
+     * A layer added or removed at the end (overdub, undo) only scans that
+     * layer; sections whose audio was replaced or moved (load, standby swap,
+     * consolidation, doubling) are rebuilt.
+     * @return true if anything was rescanned.
+     */
+    bool updateWaveformOverviews();
+
+    /**
+     * @brief Min/max for numColumns equal slices of [0, length) of a section.
+     * Base and layers are summed per slice (the envelope of what plays).
+     * Message thread; O(numColumns), never touches the audio.
+     */
+    void getWaveformColumns(int section, juce::int64 length,
+                            juce::Range<float>* columns, int numColumns) const;
+
+    /** Bumped whenever an overview changed. */
+    juce::uint32 getWaveformRevision() const { return waveformRevision.load(std::memory_order_acquire); }
 
-    /** Pre-allocate for a specific section. */
-    void stageOverdubBuffer(juce::int64 loopLength, int section);
+    /**
+     * @brief Use an overview saved with the song instead of rescanning the section.
+     * Only taken for a section without overdub layers. Message thread, after loading.
+     */
+    bool loadWaveformOverview(int section, const juce::File& file);
+
+    //==========================================================================
+    // Overdub Layers
+    //==========================================================================
 
     /** Remove the last overdub layer (or cancel active overdub). Audio thread. */
     void undoLastOverdub();
@@ -213,16 +549,125 @@ public:
     int  getOverdubLayerCount() const;
     bool canUndoOverdub()       const;
 
+    /**
+     * @brief Cap the number of separately played overdub layers.
+     *
+     * Once a section holds more than maxLayers layers, everything except the
+     * newest undoDepth layers is merged into the base take in the background.
+     * undoDepth is clamped to 1..maxLayers, so the layer being recorded is never merged.
+     * A section that uses all MAX_OVERDUB_LAYERS slots merges its oldest layer even
+     * when maxLayers allows them all, so the next overdub finds a free slot.
+     */
+    void setLayerConsolidation(int maxLayers, int undoDepth);
+    int  getMaxOverdubLayers() const { return maxOverdubLayers.load(std::memory_order_relaxed); }
+    int  getUndoDepth()        const { return undoDepth.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Mix eligible layers of one section into its flatten buffer. Background thread.
+     * @param sectionLoopLength  Loop length of that section (0 = skip).
+     * @return true if a consolidated take was prepared.
+     */
+    bool prepareLayerConsolidation(int section, juce::int64 sectionLoopLength);
+
     /** Append a pre-recorded overdub layer to active section (message thread, audio stopped). */
     bool loadOverdubLayer(const juce::AudioBuffer<float>& source, juce::int64 numSamples);
 
     /** Append a pre-recorded overdub layer to a specific section. */
     bool loadOverdubLayer(int section, const juce::AudioBuffer<float>& source, juce::int64 numSamples);
 
-    /** Read-only access to overdub layers for active section. */
-    const std::vector<juce::AudioBuffer<float>>& getOverdubLayers() const;
+    /**
+     * @brief Exchange a section's audio with preloaded standby storage. Audio thread only.
+     *
+     * Page tables change hands, nothing is copied or allocated. Recording on the
+     * channel must already be stopped.
+     */
+    void swapInStandbySection(int section, StandbySection& standby) noexcept;
+
+    /**
+     * @brief Take a copy-on-write snapshot of a section's base and layers. Message thread.
+     *
+     * If the audio thread restructures the section meanwhile (consolidation,
+     * standby swap), copies again once that block has ended.  Returns false
+     * if no consistent view could be taken.
+     */
+    bool snapshotSection(int section, SectionSnapshot& out) const;
+
+    //==========================================================================
+    // Section Storage Tiers
+    //==========================================================================
+
+    /**
+     * @brief Pages of one section to encode or decode outside the engine's locks.
+     *
+     * Taken by updateSectionTiers() with the page layout fixed, run() without
+     * any lock (it only touches the pool), then handed back to
+     * finishTierBatch().  A batch the section moved on from is dropped there.
+     */
+    struct TierBatch
+    {
+        Channel*     channel {nullptr};
+        int          section {-1};
+        bool         unpack {false};
+        juce::uint32 epoch {0};    // pack: layoutEpoch the pages were listed at
+        size_t       first {0};    // tier cursor the batch starts at
+        size_t       total {0};    // tier pages when it was taken
+        std::vector<int>               pages;   // pages held: pack = retained sources, unpack = decoded
+        std::vector<juce::MemoryBlock> data;    // pack = encoded output, unpack = copy of the packed pages
+
+        /** Encode (pack) or decode into new pages (unpack). Any thread but the audio thread. */
+        void run(LoopPagePool& pool);
+
+        /** Drop the pages the batch still holds. */
+        void releasePages(LoopPagePool& pool) noexcept;
+    };
+
+    /**
+     * @brief Pack idle sections losslessly, unpack the ones that may play next. Background thread.
+     *
+     * A packed section keeps its page tables, layers and repeats but no audio
+     * pages; the encoded pages live in RAM (see LoopPageCodec.h).  This call
+     * only picks a budget of pages per section and appends them to batches —
+     * the caller runs them without its locks and hands them to
+     * finishTierBatch(); the audio thread only exchanges page tables
+     * (applySectionTiers()).
+     *
+     * @param keepMask      Sections that must stay or become resident (active, pending switch).
+     * @param compressMask  Sections idle long enough to be packed.
+     * @param packBudget    Pages to encode in this round.
+     * @param unpackBudget  Pages to decode in this round (larger: a switch may be waiting).
+     * @param batches       Receives the work picked.
+     * @return true if any work was done or picked.
+     */
+    bool updateSectionTiers(int keepMask, int compressMask, int packBudget, int unpackBudget,
+                            std::vector<TierBatch>& batches);
+
+    /**
+     * Publish a run() batch: store the encoded pages / map the decoded ones, and
+     * hand the section to the audio thread once all its pages are done.  If the
+     * section changed since the batch was taken its pages are released instead.
+     * Background thread.  @return true if the batch was used.
+     */
+    bool finishTierBatch(TierBatch& batch);
+
+    /** Swap packed/unpacked storage in once the background is done. Audio thread, once per block. */
+    void applySectionTiers(int keepMask) noexcept;
 
-    /** Duplicate loop content for a specific section. Audio thread only. */
+    /** false while a section's audio is packed — it must not become active yet. Audio thread safe. */
+    bool isSectionResident(int s) const noexcept;
+
+    /** Unpack a section right away (load paths, device restart). Message thread. */
+    void restoreSectionNow(int s);
+
+    /** RAM used by packed sections of this channel. */
+    juce::int64 getPackedBytes() const noexcept;
+
+    /** Add the section's mapped pages (base + layers) and how many of them are in RAM. Background thread. */
+    void countResidentPages(int section, int& mapped, int& resident) const;
+
+    /** Page bytes mapped by a section's base take and by its overdub layers (0 while packed). Background thread. */
+    void getSectionMemory(int section, juce::int64& baseBytes, juce::int64& layerBytes) const;
+
+    /** Repeat the loop content once (virtual, no copy) for a specific section. Audio thread only. */
     void doubleBuffer(int sectionIndex, juce::int64 currentLoopLength);
 
     /** Duplicate loop content for active section (backward compat). */
@@ -232,34 +677,52 @@ protected:
     //==========================================================================
     int         channelIndex;
     ChannelType channelType;
-
-    std::atomic<ChannelState> state          {ChannelState::Idle};
-    std::atomic<bool>         muted          {false};
-    std::atomic<bool>         solo           {false};
-    std::atomic<bool>         soloMuted      {false};
-    std::atomic<bool>         stopPending    {false};
-    std::atomic<bool>         recordPending  {false};
-    std::atomic<bool>         overdubPending {false};
-    std::atomic<bool>         playPending    {false};
-    std::atomic<bool>         isActiveChannel{false};
-    std::atomic<bool>         oneShot        {false};
+    RealtimeProfiler* profiler  {nullptr};
+    EpochReclaimer*   reclaimer {nullptr};
+    StemRecorder*     stemRecorder {nullptr};
+    RecordJournal*    recordJournal {nullptr};
+
+    int profileStage(int stage) const noexcept { return RealtimeProfiler::channelStage(channelIndex, stage); }
+
+    // Hot flags: this channel's slot in the engine's ChannelHotState
+    std::atomic<ChannelState>& state;
+    std::atomic<bool>&         muted;
+    std::atomic<bool>&         solo;
+    std::atomic<bool>&         soloMuted;
+    std::atomic<bool>&         stopPending;
+    std::atomic<bool>&         recordPending;
+    std::atomic<bool>&         overdubPending;
+    std::atomic<bool>&         playPending;
+    std::atomic<bool>&         isActiveChannel;
+    std::atomic<bool>&         oneShot;
+
+    std::atomic<int>          maxOverdubLayers {12};
+    std::atomic<int>          undoDepth        {8};
 
     // Oneshot: independent playhead and multi-voice overlap
     std::atomic<juce::int64> oneShotPlayhead {0};
     std::atomic<juce::int64> oneShotLength   {0};
-    std::array<std::atomic<juce::int64>, 8> oneShotVoices {};  // -1 = inactive
+    OneShotVoicePool         oneShotVoices;
 
-    std::atomic<float>       gainLinear  {1.0f};
+    std::atomic<float>&      gainLinear;
+    ChannelHotState&         hotState;   // refused records are reported there
     std::atomic<MonitorMode> monitorMode {MonitorMode::WhenTrackActive};
 
+    // Smoothing (audio thread): fader ramp and mute/solo fade
+    SmoothedGain gainSmoother;
+    SmoothedGain muteFade;
+    const float* gainRamp {nullptr};   // this block's fader curve, nullptr = steady
+
     RoutingConfig routing;
 
     std::array<SectionBufferSet, NUM_SECTIONS> sections;
+    juce::CriticalSection sectionAllocLock;   // allocateSection() vs. prepare/release, never audio thread
     std::atomic<int> activeSection {0};
     juce::int64      loopBufferSize {0};
 
     juce::AudioBuffer<float> workingBuffer;
     juce::AudioBuffer<float> fxBuffer;
+    juce::MidiBuffer         fxMidiBuffer;   // for FX plugins (preallocated, cleared per block)
 
     // Peak meters (updated by audio thread, read by GUI)
     std::atomic<float> inputPeakL  {0.0f};
@@ -267,9 +730,103 @@ protected:
     std::atomic<float> loopPeakL   {0.0f};
     std::atomic<float> loopPeakR   {0.0f};
 
+    // Waveform overviews: recordToLoop() queues the written ranges, the background
+    // thread rescans them; the GUI reads the pyramids under waveformLock.
+    struct WaveformDirty
+    {
+        int         section;
+        int         layer;     // -1 = base
+        juce::int64 start;
+        int         num;
+    };
+    static constexpr int kWaveformDirtyCapacity = 2048;
+    juce::AbstractFifo waveformDirtyFifo {kWaveformDirtyCapacity};
+    std::array<WaveformDirty, kWaveformDirtyCapacity> waveformDirty;
+    std::atomic<bool> waveformDirtyOverflow {false};   // ranges lost — rebuild everything
+
+    struct SectionWaveform
+    {
+        WaveformOverview base;
+        std::array<WaveformOverview, MAX_OVERDUB_LAYERS> layers;
+        juce::int64  baseWrap {0};
+        std::array<juce::int64, MAX_OVERDUB_LAYERS> layerWrap {};
+        std::array<juce::uint32, MAX_OVERDUB_LAYERS> layerSerial {};   // SectionBufferSet::layerSerial scanned
+        int          numLayers    {0};
+        juce::uint32 builtEpoch   {0};
+        juce::uint32 builtContent {0};
+        bool         built        {false};
+    };
+    std::array<SectionWaveform, NUM_SECTIONS> waveforms;
+    juce::CriticalSection waveformLock;
+    std::atomic<juce::uint32> waveformRevision {0};
+
+    /** Audio thread: note a written range for the background rescan. */
+    void queueWaveformDirty(int section, int layer, juce::int64 start, int num) noexcept;
+
+    /** Background thread: rescan a whole section from the live buffers. */
+    bool rebuildWaveform(int section, juce::uint32 epoch, juce::uint32 content);
+
+    /** Background thread: scan the layers added since the overview was drawn, drop removed ones. */
+    bool updateWaveformLayers(int section, juce::uint32 epoch);
+
+    // Section storage tiers.  state is the handshake: the background thread moves
+    // Resident -> EvictReady and Compressed -> RestoreReady, the audio thread does
+    // the table swap (Swapping) and moves on to Compressed / Resident.
+    enum class TierState : int { Resident, EvictReady, Compressed, RestoreReady, Swapping };
+
+    struct PackedPage
+    {
+        int               buffer;   // -1 = base, else overdub layer
+        int               slot;
+        juce::MemoryBlock data;
+    };
+
+    struct SectionTier
+    {
+        std::atomic<TierState>  state {TierState::Resident};
+        StandbySection          swap;        // shell to evict with / unpacked audio; after a swap, what it replaced
+        std::vector<PackedPage> pages;       // background thread (and message thread under tierLock)
+        size_t                  cursor {0};  // pages encoded or decoded so far
+        bool                    packed {false};          // pages complete for the evicted layout
+        bool                    swapHoldsPages {false};  // swap must be released
+        juce::uint32            encodeEpoch {0};         // layoutEpoch the pages were read at
+        std::atomic<juce::int64> packedBytes {0};
+    };
+    std::array<SectionTier, NUM_SECTIONS> tiers;
+    mutable juce::CriticalSection tierLock;   // background vs. message thread, never the audio thread
+
+    /** Pick up to pageBudget pages of a section to encode (tierLock held). false if nothing to do. */
+    bool takePackBatch(int section, int& pageBudget, TierBatch& batch);
+
+    /** Pick up to pageBudget packed pages of a section to decode (tierLock held). */
+    bool takeUnpackBatch(int section, int& pageBudget, TierBatch& batch);
+
+    /** finishTierBatch() with tierLock held. */
+    bool publishTierBatch(TierBatch& batch);
+
+    /** Decode pageBudget pages into tier.swap right away (tierLock held); see restoreSectionNow(). */
+    bool unpackSection(int section, int& pageBudget);
+
+    /** snapshotSection() of a packed section: decode into the snapshot. false if it was unpacked meanwhile. */
+    bool snapshotPacked(int section, SectionSnapshot& out) const;
+
+    /** Drop packed pages and whatever tier.swap still holds (tierLock held). */
+    void discardTier(SectionTier& tier);
+
+    /** Section cleared or replaced: packed audio no longer belongs to it. Any thread. */
+    void resetTier(int section) noexcept;
+
+    /** Exchange section storage with a standby set (no allocation). Audio thread, or tierLock with the section inactive. */
+    void swapSectionStorage(int section, StandbySection& standby) noexcept;
+
+    // Per-block summaries for the GUI (see MeterTelemetry.h)
+    MeterTelemetry telemetry;
+    MeterFrame     blockFrame;        // filled during the block, pushed by publishMeters()
+
     struct PluginSlot
     {
-        std::unique_ptr<juce::AudioPluginInstance> plugin;
+        std::unique_ptr<juce::AudioPluginInstance> plugin;              // owner, message thread
+        std::atomic<juce::AudioPluginInstance*>    active {nullptr};    // what the audio thread processes
         std::atomic<bool> bypassed {false};
         std::atomic<bool> crashed  {false};
     };
@@ -278,11 +835,93 @@ protected:
     double sampleRate   {44100.0};
     int    maxBlockSize {512};
 
+    //==========================================================================
+    // Idle detection: once nothing reaches the FX chain and its tail has died
+    // away, the chain and output routing are skipped until the channel wakes.
+    static constexpr double kIdleHoldSeconds = 2.0;   // minimum silence — plugins under-report tails
+
+    SilenceTracker    fxIdle;
+    ChannelState      lastBlockState {ChannelState::Idle};
+    std::atomic<int>  fxTailSamples  {0};        // longest tail of the active chain, -1 = infinite
+    std::atomic<bool> fxWakeRequested{false};    // plugin change off the audio thread
+    std::atomic<bool> fxSuspended    {false};    // for the UI
+
+    /** getTailLengthSeconds() in samples, -1 for an infinite tail. Message thread. */
+    static int pluginTailSamples(juce::AudioPluginInstance& plugin, double sampleRate);
+
+    /** Silent samples after which a processor with this tail may sleep (-1 = never). */
+    juce::int64 idleDelaySamples(int tailSamples) const noexcept;
+
+    /** Recompute fxTailSamples from the active plugins and wake the chain. Message thread. */
+    void updateFxTail();
+
+    // PDC: post-FX delay line, fed every block the chain runs
+    CompensationDelay latencyDelay;
+    std::atomic<int>  fxLatencySamples  {0};
+    std::atomic<int>  compensationDelay {0};
+
+    std::atomic<int>  recordLatency     {0};
+
+    /**
+     * Loop position the input of this block belongs to: the playhead moved back
+     * by recordLatency, wrapped into the loop.  The first take (no loop length
+     * yet) has nothing to line up with and records at the playhead.
+     */
+    juce::int64 recordPosition(juce::int64 playheadPosition, juce::int64 loopLength) const noexcept
+    {
+        if (loopLength <= 0) return playheadPosition;
+        const juce::int64 pos = playheadPosition - recordLatency.load(std::memory_order_relaxed) % loopLength;
+        return pos < 0 ? pos + loopLength : pos;
+    }
+
+    /** Delay fxBuffer by compensationDelay. Call right after processFXChain(). */
+    void compensateLatency(int numSamples) noexcept
+    {
+        latencyDelay.process(fxBuffer, numSamples, compensationDelay.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief true if the FX chain and output routing can be skipped this block.
+     * @param mixPeak  Peak of the signal going into the chain.
+     * A non-silent mix, a state change or a plugin change wakes the channel.
+     */
+    bool isFxChainIdle(float mixPeak, ChannelState currentState) noexcept;
+
+    /** After the chain ran on fxBuffer: count silent output towards sleeping. */
+    void trackFxOutput(int numSamples) noexcept;
+
+    /** Hand fxBuffer to the stem recorder (before the chain: dry, after it: post-FX). */
+    void tapStem(bool postFx, int numSamples) noexcept
+    {
+        if (stemRecorder != nullptr && stemRecorder->isCapturing())
+            stemRecorder->write(StemRecorder::getStemIndex(channelIndex, postFx), fxBuffer, numSamples);
+    }
+
+    //==========================================================================
+    // Metering (audio thread) — peak atomics plus the telemetry frame
+
+    /** Input levels from workingBuffer (dry input, or the instrument for VSTi). */
+    void meterInput(int numSamples) noexcept;
+
+    /** Loop playback levels from buf; peaks already known from the mix pass. */
+    void meterLoop(const juce::AudioBuffer<float>& buf, int numSamples, float peakL, float peakR) noexcept;
+
+    /** No loop playback this block. */
+    void meterLoopSilent() noexcept;
+
+    /** Push this block's frame to the GUI. Call once per block, after the loop stage. */
+    void publishMeters(juce::int64 playhead, int numSamples) noexcept;
+
     //==========================================================================
     void checkAndExecutePendingStop(juce::int64 playheadPosition,
                                     juce::int64 loopLength,
                                     int numSamples);
 
+    /** Swap in consolidated takes prepared by the background thread (loop boundary only). */
+    void applyPendingConsolidation(juce::int64 playheadPosition,
+                                   juce::int64 loopLength,
+                                   int numSamples) noexcept;
+
     void checkOneShotStop(juce::int64 playheadPosition,
                           juce::int64 loopLength,
                           int numSamples);
@@ -291,24 +930,57 @@ protected:
                         int numSamples,
                         juce::MidiBuffer& midiBuffer);
 
+    /** loopLength > 0: the base take wraps there rather than at the buffer's capacity. */
     void recordToLoop(const juce::AudioBuffer<float>& source,
                       juce::int64 startPosition,
                       int numSamples,
-                      bool isOverdub);
+                      bool isOverdub,
+                      juce::int64 loopLength = 0);
 
+    /**
+     * @brief Mix base + all overdub layers into dest[0, numSamples), scaled by gain.
+     *
+     * One pass per output channel: wrap and page splits are resolved per segment,
+     * layers are summed in registers and the block peak is taken on the way out.
+     */
     void playFromLoop(juce::AudioBuffer<float>& dest,
                       juce::int64 startPosition,
-                      int numSamples);
+                      int numSamples,
+                      float gain,
+                      float& peakL,
+                      float& peakR);
+
+    /** Advance the fader smoother for this block. Call once at the top of processBlock. */
+    void beginGainBlock(int numSamples) noexcept
+    {
+        gainRamp = gainSmoother.process(gainLinear.load(std::memory_order_relaxed), numSamples);
+    }
+
+    /** playFromLoop() with this block's smoothed fader gain (see beginGainBlock()). */
+    void playFromLoopSmoothed(juce::AudioBuffer<float>& dest,
+                              juce::int64 startPosition,
+                              int numSamples,
+                              float& peakL,
+                              float& peakR);
+
+    /**
+     * @brief Render every one-shot voice into dest[0, numSamples), with this block's fader gain.
+     *
+     * One gather-and-sum pass per output channel over all voices; segments end
+     * at voice starts, page edges and take ends.  Stolen voices fade out on top.
+     * Advances and retires the voices. Returns false (dest untouched) when none sound.
+     */
+    bool playOneShotVoices(juce::AudioBuffer<float>& dest, int numSamples,
+                           float& peakL, float& peakR);
 
-    /** Read from a loop buffer with wrap-around. addToDest=false uses copyFrom, true uses addFrom. */
-    void readBufferWrapped(const juce::AudioBuffer<float>& src, juce::int64 bufSize,
-                           juce::AudioBuffer<float>& dest, juce::int64 startPos,
-                           int numSamples, bool addToDest);
+    /**
+     * @brief Fade buffer towards muted/unmuted.
+     * @return false when fully muted — nothing to route.
+     */
+    bool applyMuteFade(juce::AudioBuffer<float>& buffer, int numSamples, bool mutedNow) noexcept;
 
-    /** Write to a loop buffer with wrap-around. addToBuffer=false uses copyFrom, true uses addFrom. */
-    void writeBufferWrapped(juce::AudioBuffer<float>& dst, juce::int64 bufSize,
-                            const juce::AudioBuffer<float>& src, juce::int64 startPos,
-                            int numSamples, bool addToBuffer);
+    /** Size page tables of a section's base buffer and layer slots (holds sectionAllocLock). */
+    void sizeSectionStorage(SectionBufferSet& sec);
 
     bool shouldMonitor() const;
 
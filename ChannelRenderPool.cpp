@@ -0,0 +1,167 @@
+#include "ChannelRenderPool.h"
+#include "DenormalPolicy.h"
+#include "RealtimeSafety.h"
+#include <thread>
+
+//==============================================================================
+// Worker
+//==============================================================================
+
+class ChannelRenderPool::Worker : public juce::Thread
+{
+public:
+    Worker(ChannelRenderPool& p, int index, int core)
+        : juce::Thread("Channel Render " + juce::String(index + 1))
+        , pool(p)
+        , cpuIndex(core)
+    {}
+
+    ~Worker() override { stopThread(1000); }
+
+    void run() override
+    {
+        // Pinned only to a core the user set aside for the workers (see start())
+        if (cpuIndex >= 0 && cpuIndex < 32)
+            juce::Thread::setCurrentThreadAffinityMask(1u << cpuIndex);
+
+        auto seen     = pool.generation.load(std::memory_order_acquire);
+        auto lastWork = juce::Time::getMillisecondCounter();
+
+        while (!threadShouldExit())
+        {
+            const auto gen = pool.generation.load(std::memory_order_acquire);
+            if (gen != seen)
+            {
+                seen = gen;
+                pool.runJobs(gen);
+                lastWork = juce::Time::getMillisecondCounter();
+                continue;
+            }
+
+            // Spin while blocks keep arriving; back off once the device has gone
+            // quiet so an idle pool doesn't burn a core.  A sleeping worker only
+            // costs parallelism — the audio thread runs unclaimed jobs itself.
+            if (juce::Time::getMillisecondCounter() - lastWork < kSpinWindowMs)
+                std::this_thread::yield();
+            else
+                juce::Thread::sleep(1);
+        }
+    }
+
+private:
+    static constexpr juce::uint32 kSpinWindowMs = 200;
+
+    ChannelRenderPool& pool;
+    const int cpuIndex;   // -1 = not pinned
+};
+
+//==============================================================================
+// Lifecycle (Message Thread)
+//==============================================================================
+
+ChannelRenderPool::~ChannelRenderPool()
+{
+    stop();
+}
+
+void ChannelRenderPool::start(int numWorkers, juce::uint32 coreMask)
+{
+    stop();
+
+    numWorkers = juce::jlimit(1, kMaxWorkers, numWorkers);
+    workers.reserve(static_cast<size_t>(numWorkers));
+
+    std::vector<int> cores;
+    for (int c = 0; c < 32; ++c)
+        if ((coreMask & (1u << c)) != 0)
+            cores.push_back(c);
+
+    for (int i = 0; i < numWorkers; ++i)
+    {
+        const int core = cores.empty() ? -1 : cores[static_cast<size_t>(i) % cores.size()];
+        auto w = std::make_unique<Worker>(*this, i, core);
+
+        const auto opts = juce::Thread::RealtimeOptions{}.withPriority(9);
+        if (!w->startRealtimeThread(opts))
+        {
+            DBG("ChannelRenderPool: realtime priority unavailable, using highest");
+            w->startThread(juce::Thread::Priority::highest);
+        }
+        workers.push_back(std::move(w));
+    }
+
+    running.store(true, std::memory_order_release);
+    DBG("ChannelRenderPool: " + juce::String(numWorkers) + " worker(s) started"
+        + (cores.empty() ? ", not pinned" : ", pinned"));
+}
+
+void ChannelRenderPool::stop()
+{
+    running.store(false, std::memory_order_release);
+
+    for (auto& w : workers)
+        w->signalThreadShouldExit();
+
+    // A worker finishes any job it has already claimed before it exits,
+    // so an in-flight dispatch() still completes.
+    workers.clear();
+}
+
+//==============================================================================
+// Fork / Join (Audio Thread)
+//==============================================================================
+
+void ChannelRenderPool::dispatch(JobFn fn, void* context, int numJobs)
+{
+    if (fn == nullptr || numJobs <= 0) return;
+
+    jobFn      = fn;
+    jobContext = context;
+    numJobsInBatch.store(numJobs, std::memory_order_relaxed);
+    jobsDone      .store(0,       std::memory_order_relaxed);
+
+    const juce::uint32 gen = generation.load(std::memory_order_relaxed) + 1;
+    claimWord .store(static_cast<juce::uint64>(gen) << 32, std::memory_order_release);
+    generation.store(gen, std::memory_order_release);
+
+    // Take part in the batch — anything no worker has claimed runs here.
+    runJobs(gen);
+
+    // Join: only jobs that were actually claimed by a worker can still be running.
+    int spins = 0;
+    while (jobsDone.load(std::memory_order_acquire) < numJobs)
+    {
+        if (++spins > 64)
+        {
+            std::this_thread::yield();
+            spins = 0;
+        }
+    }
+}
+
+void ChannelRenderPool::runJobs(juce::uint32 gen)
+{
+    const DenormalPolicy::Scope noDenormals;
+    const RealtimeSafety::Scope realtime;   // workers are audio threads while they run jobs
+    const int n = numJobsInBatch.load(std::memory_order_acquire);
+
+    for (;;)
+    {
+        auto word = claimWord.load(std::memory_order_acquire);
+
+        if (static_cast<juce::uint32>(word >> 32) != gen)
+            return;   // batch already finished, a newer one is being published
+
+        const int idx = static_cast<int>(word & 0xFFFFFFFFu);
+        if (idx >= n)
+            return;
+
+        if (!claimWord.compare_exchange_weak(word, word + 1,
+                                             std::memory_order_acq_rel,
+                                             std::memory_order_relaxed))
+            continue;
+
+        jobFn(jobContext, idx);
+        jobsDone.fetch_add(1, std::memory_order_release);
+    }
+}
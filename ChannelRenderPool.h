@@ -0,0 +1,82 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file ChannelRenderPool.h
+ * @brief Small pool of realtime worker threads for fanning out per-channel rendering
+ *
+ * The audio thread publishes a batch of N jobs with dispatch(), works on the
+ * batch itself and returns once every job has finished (fork/join).  Jobs are
+ * claimed through a single atomic word that packs the batch generation with the
+ * next job index, so a worker that wakes up late can never steal a job from a
+ * newer batch.
+ *
+ * A worker that is asleep or descheduled never stalls the audio thread: any
+ * job nobody has claimed yet is simply run by the dispatching thread.
+ *
+ * Thread-safety:
+ *   Audio thread  : dispatch()
+ *   Message thread: start(), stop(), getNumWorkers()
+ */
+class ChannelRenderPool
+{
+public:
+    /** Job entry point — called once per job index, possibly from several threads at once. */
+    using JobFn = void (*)(void* context, int jobIndex);
+
+    ChannelRenderPool() = default;
+    ~ChannelRenderPool();
+
+    /**
+     * @brief Start numWorkers realtime threads (clamped to 1..kMaxWorkers). Message thread.
+     *
+     * With a coreMask, worker i is pinned to the i-th core set in it (wrapping
+     * round), which keeps its caches warm between blocks.  0 leaves placement to
+     * the OS: the device's audio thread is not pinned either, so no core is known
+     * to be free of it.
+     */
+    void start(int numWorkers, juce::uint32 coreMask = 0);
+
+    /** Stop and join all worker threads. Safe while the audio thread is dispatching. */
+    void stop();
+
+    bool isRunning()     const { return running.load(std::memory_order_acquire); }
+    int  getNumWorkers() const { return static_cast<int>(workers.size()); }
+
+    /**
+     * @brief Run jobs 0..numJobs-1 and block until all have completed. Audio thread only.
+     *
+     * No allocations, no locks. The calling thread takes part in the batch, so
+     * this also works (serially) when no worker picks anything up.
+     */
+    void dispatch(JobFn fn, void* context, int numJobs);
+
+    static constexpr int kMaxWorkers = 8;
+
+private:
+    class Worker;
+
+    //==========================================================================
+    // Batch state — written by dispatch() before the generation is published
+    JobFn jobFn      {nullptr};
+    void* jobContext {nullptr};
+    std::atomic<int>      numJobsInBatch {0};
+    std::atomic<int>      jobsDone       {0};
+
+    /** High 32 bits: batch generation, low 32 bits: next unclaimed job index. */
+    std::atomic<juce::uint64> claimWord  {0};
+    std::atomic<juce::uint32> generation {0};
+
+    std::atomic<bool> running {false};
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    /** Claim and run jobs of the given generation until none are left. */
+    void runJobs(juce::uint32 gen);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ChannelRenderPool)
+};
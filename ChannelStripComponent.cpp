@@ -4,8 +4,8 @@
 #include "AppConfig.h"
 
 //==============================================================================
-ChannelStripComponent::ChannelStripComponent(AudioEngine& engine, int index)
-    : audioEngine(engine), channelIndex(index)
+ChannelStripComponent::ChannelStripComponent(AudioEngine& engine, int index, UiRefreshClock& refreshClock)
+    : audioEngine(engine), channelIndex(index), uiClock(refreshClock)
 {
     //--------------------------------------------------------------------------
     // Channel label — double-click to rename
@@ -186,7 +186,7 @@ ChannelStripComponent::ChannelStripComponent(AudioEngine& engine, int index)
         muteGroupButtons[g].setWantsKeyboardFocus(false);
 
     updateMainButton();
-    startTimer(100);  // 10 Hz
+    uiClock.addClient(*this, 10);
 }
 
 ChannelStripComponent::~ChannelStripComponent()
@@ -195,7 +195,7 @@ ChannelStripComponent::~ChannelStripComponent()
     openFileButton.setLookAndFeel(nullptr);
     for (int g = 0; g < kMaxMuteGroups; ++g)
         muteGroupButtons[g].setLookAndFeel(nullptr);
-    stopTimer();
+    uiClock.removeClient(*this);
 }
 
 //==============================================================================
@@ -215,6 +215,8 @@ void ChannelStripComponent::paint(juce::Graphics& g)
         g.drawRect(getLocalBounds(), 1);
     }
 
+    paintWaveform(g);
+
     // dB scale to the left of meters
     {
         const auto meterBounds = inputMeter.getBounds().toFloat();
@@ -268,6 +270,50 @@ void ChannelStripComponent::paint(juce::Graphics& g)
     }
 }
 
+juce::int64 ChannelStripComponent::getShownLoopLength(int section) const
+{
+    // The active section's length lives in the loop engine until the next switch
+    return section == audioEngine.getActiveSection() ? audioEngine.getLoopEngine().getLoopLength()
+                                                     : audioEngine.getSectionLoopLength(section);
+}
+
+void ChannelStripComponent::paintWaveform(juce::Graphics& g)
+{
+    if (waveformArea.isEmpty()) return;
+
+    g.setColour(juce::Colour(0xFF1A1A1A));
+    g.fillRect(waveformArea);
+    g.setColour(juce::Colour(0xFF444444));
+    g.drawRect(waveformArea, 1);
+
+    auto* channel = audioEngine.getChannel(channelIndex);
+    const auto inner = waveformArea.reduced(1);
+    if (channel == nullptr || paintedWaveformLength <= 0 || inner.isEmpty()) return;
+
+    waveformColumns.resize(static_cast<size_t>(inner.getWidth()));
+    channel->getWaveformColumns(paintedWaveformSection, paintedWaveformLength,
+                                waveformColumns.data(), inner.getWidth());
+
+    const float midY = static_cast<float>(inner.getCentreY());
+    const float half = static_cast<float>(inner.getHeight()) * 0.5f;
+
+    g.setColour(juce::Colour(0xFF4A8FCC));
+    for (int x = 0; x < inner.getWidth(); ++x)
+    {
+        const auto& r = waveformColumns[static_cast<size_t>(x)];
+        const float top = midY - juce::jlimit(-1.0f, 1.0f, r.getEnd())   * half;
+        const float bot = midY - juce::jlimit(-1.0f, 1.0f, r.getStart()) * half;
+        g.drawVerticalLine(inner.getX() + x, top, juce::jmax(bot, top + 1.0f));
+    }
+
+    if (paintedPlayheadX >= 0)
+    {
+        g.setColour(juce::Colours::white.withAlpha(0.8f));
+        g.drawVerticalLine(inner.getX() + paintedPlayheadX,
+                           static_cast<float>(inner.getY()), static_cast<float>(inner.getBottom()));
+    }
+}
+
 void ChannelStripComponent::resized()
 {
     auto area = getLocalBounds().reduced(6);
@@ -296,6 +342,10 @@ void ChannelStripComponent::resized()
 
     // Monitor mode
     monitorModeBox.setBounds(area.removeFromTop(22));
+    area.removeFromTop(4);
+
+    // Loop waveform
+    waveformArea = area.removeFromTop(28);
     area.removeFromTop(2);
 
     // Reserve bottom for FILE + Oneshot (one row) + mute group section
@@ -367,10 +417,10 @@ void ChannelStripComponent::mouseDown(const juce::MouseEvent& e)
 }
 
 //==============================================================================
-// Timer
+// Refresh (10 Hz)
 //==============================================================================
 
-void ChannelStripComponent::timerCallback()
+void ChannelStripComponent::uiRefresh()
 {
     updateMainButton();
 
@@ -442,12 +492,40 @@ void ChannelStripComponent::timerCallback()
         stateLabel.setText(stateText, juce::dontSendNotification);
     }
 
-    // Update level meters
-    inputMeter.setLevel(juce::jmax(channel->getInputPeakL(), channel->getInputPeakR()));
-    loopMeter .setLevel(juce::jmax(channel->getLoopPeakL(),  channel->getLoopPeakR()));
+    // Update level meters from every block since the last refresh (no missed transients)
+    const auto levels = channel->drainMeterTelemetry();
+    inputMeter.setLevels(levels.inputPeak, levels.inputRms, levels.inputClipped);
+    loopMeter .setLevels(levels.loopPeak,  levels.loopRms,  levels.loopClipped);
 
-    // Repaint border when active state changes
-    repaint();
+    // Waveform: new audio in the overview, another section, or the playhead moved a pixel
+    {
+        const int section = channel->getActiveSection();
+        const juce::int64 len = getShownLoopLength(section);
+        int playheadX = -1;
+        if (len > 0 && audioEngine.isPlaying() && !waveformArea.isEmpty())
+        {
+            const juce::int64 pos = audioEngine.getLoopEngine().getCurrentPlayhead() % len;
+            playheadX = static_cast<int>(pos * (waveformArea.getWidth() - 2) / len);
+        }
+
+        const auto revision = channel->getWaveformRevision();
+        if (revision != paintedWaveformRevision || section != paintedWaveformSection
+            || len != paintedWaveformLength || playheadX != paintedPlayheadX)
+        {
+            paintedWaveformRevision = revision;
+            paintedWaveformSection  = section;
+            paintedWaveformLength   = len;
+            paintedPlayheadX        = playheadX;
+            repaint(waveformArea);
+        }
+    }
+
+    // Repaint border only when active state changes (meters repaint themselves)
+    if (isActiveChannel() != paintedActive)
+    {
+        paintedActive = !paintedActive;
+        repaint();
+    }
 }
 
 //==============================================================================
@@ -733,8 +811,7 @@ void ChannelStripComponent::soloClicked()
 
 void ChannelStripComponent::gainChanged()
 {
-    audioEngine.sendCommand(
-        Command::setGain(channelIndex, static_cast<float>(gainSlider.getValue())));
+    audioEngine.setChannelGain(channelIndex, static_cast<float>(gainSlider.getValue()));
 }
 
 void ChannelStripComponent::openFileClicked()
@@ -5,6 +5,7 @@
 #include "ContextMenuControls.h"
 #include "LevelMeterComponent.h"
 #include "CustomLookAndFeel.h"
+#include "UiRefreshClock.h"
 
 //==============================================================================
 /**
@@ -20,10 +21,10 @@
  *   Clicking anywhere on the strip sets it as the active channel.
  */
 class ChannelStripComponent : public juce::Component,
-                              private juce::Timer
+                              private UiRefreshClock::Client
 {
 public:
-    ChannelStripComponent(AudioEngine& engine, int channelIndex);
+    ChannelStripComponent(AudioEngine& engine, int channelIndex, UiRefreshClock& refreshClock);
     ~ChannelStripComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -33,6 +34,7 @@ public:
 private:
     AudioEngine& audioEngine;
     const int    channelIndex;
+    UiRefreshClock& uiClock;
 
     //==========================================================================
     // Main context-aware button (ContextMenuButton so right-click → context menu)
@@ -72,9 +74,20 @@ private:
     SquareButtonLookAndFeel squareBtnLnF;
     FolderIconButtonLookAndFeel folderBtnLnF;
     int muteGrpHeaderY = 0;
+    bool paintedActive = false;   // border state currently on screen
+
+    // Loop waveform (drawn from the channel's overview, O(pixels))
+    juce::Rectangle<int> waveformArea;
+    std::vector<juce::Range<float>> waveformColumns;
+    juce::uint32 paintedWaveformRevision {0};
+    int          paintedWaveformSection  {-1};
+    juce::int64  paintedWaveformLength   {0};
+    int          paintedPlayheadX        {-1};
+    juce::int64  getShownLoopLength(int section) const;
+    void paintWaveform(juce::Graphics& g);
 
     //==========================================================================
-    void timerCallback() override;
+    void uiRefresh() override;
     void updateMainButton();
 
     void mainButtonClicked();
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
 
 //==============================================================================
 enum class CommandType
@@ -25,6 +26,7 @@ enum class CommandType
     // Global
     SetGlobalOverdubMode, ChangeActiveChannel, ClearChannel,
     ResetSong,        ///< Alle Channels clearen + Loop-Länge zurücksetzen
+    SetPlaying,       ///< Transport start/stop (boolValue) — same as AudioEngine::setPlaying()
 
     // Metronome
     SetMetronomeOutput,
@@ -82,7 +84,8 @@ struct RoutingConfig
 };
 
 //==============================================================================
-struct Command
+/** One cache line per command: queue slots never share a line. */
+struct alignas(64) Command
 {
     CommandType type;
     int   channelIndex{-1};
@@ -91,14 +94,14 @@ struct Command
     int   intValue2   {0};
     bool  boolValue   {false};
 
+    /// Engine sample clock (AudioEngine::getSampleClock()) at which the command
+    /// takes effect; the callback splits its block there. -1 = start of the next block.
+    /// MIDI-mapped controls set it from the event time (AudioEngine::getSampleClockFor()).
+    juce::int64 sampleTime {-1};
+
     union ComplexData
     {
         RoutingConfig routing;
-        struct PluginData
-        {
-            int slotIndex; char identifier[256];
-            PluginData() : slotIndex(0), identifier{0} {}
-        } plugin;
         struct MetronomeData { int outputLeft{0}, outputRight{1}; } metronome;
         ComplexData()  : routing() {}
         ~ComplexData() {}
@@ -118,12 +121,6 @@ struct Command
     {
         Command c; c.type=CommandType::SetInputRouting; c.channelIndex=ch; c.data.routing=r; return c;
     }
-    static Command loadPlugin(int ch, int slot, const juce::String& id)
-    {
-        Command c; c.type=CommandType::LoadPlugin; c.channelIndex=ch; c.intValue1=slot;
-        const int len=juce::jmin(id.length(),255); id.copyToUTF8(c.data.plugin.identifier,len+1);
-        c.data.plugin.slotIndex=slot; return c;
-    }
     static Command unloadPlugin(int ch, int slot)
     { Command c; c.type=CommandType::UnloadPlugin; c.channelIndex=ch; c.intValue1=slot; return c; }
 
@@ -134,6 +131,8 @@ struct Command
     }
 };
 
+static_assert(sizeof(Command) == 64, "Command must stay one cache line");
+
 //==============================================================================
 class CommandQueue
 {
@@ -146,6 +145,7 @@ public:
         int s1,n1,s2,n2;
         fifo.prepareToWrite(1,s1,n1,s2,n2);
         if (n1>0) { commands[s1]=cmd; fifo.finishedWrite(n1); return true; }
+        dropped.fetch_add(1, std::memory_order_relaxed);
         return false;
     }
     template<typename F> void processCommands(F&& fn)
@@ -158,8 +158,10 @@ public:
     }
     int  getNumPending() const { return fifo.getNumReady(); }
     bool isFull()        const { return fifo.getFreeSpace()==0; }
+    int  getNumDropped() const { return dropped.load(std::memory_order_relaxed); }   // pushes refused, since start
 private:
     juce::AbstractFifo   fifo;
     std::vector<Command> commands;
+    std::atomic<int>     dropped {0};
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CommandQueue)
 };
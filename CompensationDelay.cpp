@@ -0,0 +1,49 @@
+#include "CompensationDelay.h"
+
+//==============================================================================
+void CompensationDelay::prepare(int maxBlockSize)
+{
+    ringSize = kMaxDelaySamples + juce::jmax(1, maxBlockSize);
+    ring.setSize(2, ringSize, false, true, false);
+    reset();
+}
+
+void CompensationDelay::reset() noexcept
+{
+    ring.clear();
+    writePos = 0;
+}
+
+void CompensationDelay::process(juce::AudioBuffer<float>& buffer, int numSamples, int delaySamples) noexcept
+{
+    if (ringSize <= 0 || numSamples <= 0 || numSamples > ringSize - kMaxDelaySamples)
+        return;
+
+    const int delay    = juce::jlimit(0, kMaxDelaySamples, delaySamples);
+    const int numChans = juce::jmin(2, buffer.getNumChannels());
+
+    // Read start: delay samples behind this block's write position
+    const int readPos = (writePos - delay + ringSize) % ringSize;
+
+    for (int ch = 0; ch < numChans; ++ch)
+    {
+        float* io = buffer.getWritePointer(ch);
+
+        // 1. Append the block (wrapping)
+        const int firstW = juce::jmin(numSamples, ringSize - writePos);
+        ring.copyFrom(ch, writePos, io, firstW);
+        if (firstW < numSamples)
+            ring.copyFrom(ch, 0, io + firstW, numSamples - firstW);
+
+        // 2. Read it back delayed; nothing to do without a delay
+        if (delay == 0) continue;
+
+        const float* r    = ring.getReadPointer(ch);
+        const int   firstR = juce::jmin(numSamples, ringSize - readPos);
+        juce::FloatVectorOperations::copy(io, r + readPos, firstR);
+        if (firstR < numSamples)
+            juce::FloatVectorOperations::copy(io + firstR, r, numSamples - firstR);
+    }
+
+    writePos = (writePos + numSamples) % ringSize;
+}
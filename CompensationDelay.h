@@ -0,0 +1,41 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * @file CompensationDelay.h
+ * @brief Stereo delay line for plugin delay compensation (PDC)
+ *
+ * Every channel delays its post-FX signal by the difference between the
+ * slowest FX chain in the engine and its own, so all channel outputs leave
+ * aligned.  The ring is sized once for kMaxDelaySamples plus a block; the
+ * audio thread only copies in and out of it.
+ *
+ * The ring is written every block, also while the delay is 0, so a latency
+ * change reads real history instead of stale audio (a short repeat or skip,
+ * as in any DAW when a plugin reports new latency).
+ *
+ * Thread-safety:
+ *   Device start : prepare()
+ *   Audio thread : reset(), process()
+ */
+class CompensationDelay
+{
+public:
+    /** Longest compensated chain difference (~340 ms at 48 kHz). */
+    static constexpr int kMaxDelaySamples = 16384;
+
+    /** Size the ring for blocks up to maxBlockSize and clear it. Not audio thread. */
+    void prepare(int maxBlockSize);
+
+    void reset() noexcept;
+
+    /** Delay channels 0/1 of buffer in place by delaySamples (clamped to kMaxDelaySamples). */
+    void process(juce::AudioBuffer<float>& buffer, int numSamples, int delaySamples) noexcept;
+
+private:
+    juce::AudioBuffer<float> ring;
+    int ringSize {0};
+    int writePos {0};
+};
@@ -0,0 +1,13 @@
+#include "DenormalPolicy.h"
+
+std::atomic<bool>         DenormalPolicy::flushEnabled  {true};
+std::atomic<juce::uint64> DenormalPolicy::loopDenormals {0};
+
+void DenormalPolicy::setFlushEnabled(bool enabled) noexcept
+{
+    // Threads pick the new policy up with their next Scope (next block or job)
+    flushEnabled.store(enabled, std::memory_order_relaxed);
+    resetLoopDenormalCount();
+
+    DBG("Denormal flushing " + juce::String(enabled ? "on" : "off"));
+}
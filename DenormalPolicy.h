@@ -0,0 +1,77 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <cstring>
+#include <optional>
+
+//==============================================================================
+/**
+ * @file DenormalPolicy.h
+ * @brief Process-wide flush-to-zero / denormals-are-zero policy
+ *
+ * Denormal floats (0 < |x| < FLT_MIN) make x86 arithmetic many times slower.
+ * Decaying reverb tails and quiet overdub sums produce them in long runs just
+ * when a song fades out.  Every thread that renders audio opens a Scope:
+ * the device callback, the channel render workers and the offline paths
+ * (mixdown, resampling, layer consolidation).  While the policy is on, the
+ * Scope enables FTZ/DAZ for its thread and restores the previous FP mode on exit.
+ *
+ * Loop playback counts the denormal samples it outputs.  This is a bit test
+ * that also works under DAZ, so the policy can be checked in the diagnostics
+ * line or under a profiler.
+ *
+ * Thread-safety: everything may be called from any thread.
+ */
+class DenormalPolicy
+{
+public:
+    /** The preference: flush denormals on all audio threads (default on). */
+    static void setFlushEnabled(bool enabled) noexcept;
+    static bool isFlushEnabled() noexcept { return flushEnabled.load(std::memory_order_relaxed); }
+
+    /** FTZ/DAZ for the current thread while the policy is on. Nests. */
+    class Scope
+    {
+    public:
+        Scope() noexcept
+        {
+            if (isFlushEnabled())
+                guard.emplace();
+        }
+
+    private:
+        std::optional<juce::ScopedNoDenormals> guard;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    /** Number of denormal samples in data (exponent bits zero, mantissa not). */
+    static int countDenormals(const float* data, int num) noexcept
+    {
+        int n = 0;
+        for (int i = 0; i < num; ++i)
+        {
+            juce::uint32 bits;
+            std::memcpy(&bits, data + i, sizeof(bits));
+            n += ((bits & 0x7F800000u) == 0 && (bits & 0x007FFFFFu) != 0) ? 1 : 0;
+        }
+        return n;
+    }
+
+    /** Add to the loop playback counter. Audio thread, lock-free. */
+    static void noteLoopDenormals(int count) noexcept
+    {
+        if (count > 0)
+            loopDenormals.fetch_add(static_cast<juce::uint64>(count), std::memory_order_relaxed);
+    }
+
+    static juce::uint64 getLoopDenormalCount() noexcept { return loopDenormals.load(std::memory_order_relaxed); }
+    static void         resetLoopDenormalCount() noexcept { loopDenormals.store(0, std::memory_order_relaxed); }
+
+private:
+    static std::atomic<bool>         flushEnabled;
+    static std::atomic<juce::uint64> loopDenormals;
+
+    DenormalPolicy() = delete;
+};
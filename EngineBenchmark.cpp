@@ -0,0 +1,380 @@
+#include "EngineBenchmark.h"
+#include "AudioEngine.h"
+#include "SongManager.h"
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#ifndef CHIEF_BENCHMARK_COUNT_ALLOCS
+ #define CHIEF_BENCHMARK_COUNT_ALLOCS 0
+#endif
+
+#if CHIEF_BENCHMARK_COUNT_ALLOCS && CHIEF_RT_SAFETY_REPLACES_NEW
+ #error "CHIEF_RT_SAFETY_CHECKS replaces operator new on this platform; build with one of the two"
+#endif
+
+//==============================================================================
+// Allocation counting (opt-in: replaces the global operator new)
+//==============================================================================
+
+#if CHIEF_BENCHMARK_COUNT_ALLOCS
+namespace
+{
+    thread_local bool        countAllocations = false;   // only the callback thread
+    std::atomic<juce::int64> numAllocations   {0};
+}
+
+void* operator new(std::size_t size)
+{
+    if (countAllocations)
+        numAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept              { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+namespace
+{
+    //==========================================================================
+    /** Stands in for a sound card: only reports the format, never runs. */
+    class NullAudioDevice : public juce::AudioIODevice
+    {
+    public:
+        NullAudioDevice(double rate, int blockSize, int numIns, int numOuts)
+            : juce::AudioIODevice("Null", "Benchmark")
+            , sampleRate(rate), bufferSize(blockSize)
+        {
+            ins .setRange(0, numIns,  true);
+            outs.setRange(0, numOuts, true);
+        }
+
+        juce::StringArray     getOutputChannelNames() override   { return { "L", "R" }; }
+        juce::StringArray     getInputChannelNames() override    { return { "L", "R" }; }
+        juce::Array<double>   getAvailableSampleRates() override { return { sampleRate }; }
+        juce::Array<int>      getAvailableBufferSizes() override { return { bufferSize }; }
+        int                   getDefaultBufferSize() override    { return bufferSize; }
+
+        juce::String open(const juce::BigInteger&, const juce::BigInteger&, double, int) override { return {}; }
+        void   close() override                       {}
+        bool   isOpen() override                      { return true; }
+        void   start(juce::AudioIODeviceCallback*) override {}
+        void   stop() override                        {}
+        bool   isPlaying() override                   { return false; }
+        juce::String getLastError() override          { return {}; }
+
+        int    getCurrentBufferSizeSamples() override { return bufferSize; }
+        double getCurrentSampleRate() override        { return sampleRate; }
+        int    getCurrentBitDepth() override          { return 32; }
+        juce::BigInteger getActiveOutputChannels() const override { return outs; }
+        juce::BigInteger getActiveInputChannels()  const override { return ins; }
+        int    getOutputLatencyInSamples() override   { return 0; }
+        int    getInputLatencyInSamples() override    { return 0; }
+
+    private:
+        double sampleRate;
+        int    bufferSize;
+        juce::BigInteger ins, outs;
+    };
+
+    //==========================================================================
+    struct Options
+    {
+        juce::Array<int> bufferSizes { 64, 128, 256, 512 };
+        juce::Array<int> layerCounts { 0, 4, 12 };
+        int    numChannels  {6};
+        int    numSections  {1};
+        bool   overdub      {false};
+        bool   parallel     {false};
+        double seconds      {10.0};
+        double sampleRate   {48000.0};
+        double loopSeconds  {4.0};
+        juce::File songDir;
+        juce::File outFile;
+    };
+
+    juce::String getArg(const juce::StringArray& args, const juce::String& name)
+    {
+        for (auto& a : args)
+            if (a.startsWith(name + "="))
+                return a.fromFirstOccurrenceOf("=", false, false).unquoted();
+        return {};
+    }
+
+    juce::Array<int> parseIntList(const juce::String& text, const juce::Array<int>& fallback)
+    {
+        if (text.isEmpty()) return fallback;
+
+        juce::Array<int> values;
+        for (auto& t : juce::StringArray::fromTokens(text, ",", ""))
+            if (t.trim().isNotEmpty() && t.trim().containsOnly("0123456789"))
+                values.add(t.trim().getIntValue());
+        return values.isEmpty() ? fallback : values;
+    }
+
+    Options parseOptions(const juce::String& commandLine)
+    {
+        const auto args = juce::StringArray::fromTokens(commandLine, true);
+        Options o;
+
+        o.bufferSizes = parseIntList(getArg(args, "--buffers"), o.bufferSizes);
+        o.layerCounts = parseIntList(getArg(args, "--layers"),  o.layerCounts);
+        o.numChannels = juce::jlimit(1, MAX_CHANNELS, getArg(args, "--channels").getIntValue() > 0
+                                              ? getArg(args, "--channels").getIntValue() : o.numChannels);
+        o.numSections = juce::jlimit(1, NUM_SECTIONS, getArg(args, "--sections").getIntValue() > 0
+                                              ? getArg(args, "--sections").getIntValue() : o.numSections);
+        if (getArg(args, "--seconds").getDoubleValue() > 0.0)
+            o.seconds = getArg(args, "--seconds").getDoubleValue();
+
+        o.overdub  = args.contains("--overdub");
+        o.parallel = args.contains("--parallel");
+
+        if (auto song = getArg(args, "--song"); song.isNotEmpty())
+            o.songDir = juce::File::getCurrentWorkingDirectory().getChildFile(song);
+        if (auto out = getArg(args, "--out"); out.isNotEmpty())
+            o.outFile = juce::File::getCurrentWorkingDirectory().getChildFile(out);
+
+        return o;
+    }
+
+    //==========================================================================
+    void fillNoise(juce::AudioBuffer<float>& buffer, float level, juce::Random& rng)
+    {
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            auto* d = buffer.getWritePointer(ch);
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+                d[i] = (rng.nextFloat() * 2.0f - 1.0f) * level;
+        }
+    }
+
+    /** Synthetic content: noise loops with the requested number of overdub layers. */
+    void fillSynthetic(AudioEngine& engine, const Options& o, int numLayers)
+    {
+        const auto loopLen = static_cast<juce::int64>(o.loopSeconds * o.sampleRate);
+        juce::AudioBuffer<float> take(2, static_cast<int>(loopLen));
+        juce::Random rng(1234);
+
+        for (int s = 0; s < o.numSections; ++s)
+            engine.setSectionLoopLength(s, loopLen);
+        engine.getLoopEngine().setLoopLength(loopLen);
+
+        for (int i = 0; i < o.numChannels; ++i)
+        {
+            auto* channel = engine.getChannel(i);
+            if (!channel) continue;
+
+            for (int s = 0; s < o.numSections; ++s)
+            {
+                fillNoise(take, 0.25f, rng);
+                channel->loadLoopData(s, take, loopLen);
+
+                for (int l = 0; l < numLayers; ++l)
+                {
+                    fillNoise(take, 0.05f, rng);
+                    channel->loadOverdubLayer(s, take, loopLen);
+                }
+            }
+        }
+    }
+
+    juce::Result loadSong(AudioEngine& engine, SongManager& songManager, const juce::File& dir)
+    {
+        const auto songFile = dir.isDirectory() ? dir.getChildFile("song.json") : dir;
+
+        Song song;
+        auto result = songManager.loadSong(songFile, song);
+        if (result.failed()) return result;
+
+        // No plugin scan in headless mode — measure the engine, not the plugins
+        for (auto& ch : song.channels)
+        {
+            ch.vstInstrument = {};
+            for (auto& fx : ch.fxPlugins) fx = {};
+        }
+
+        // Headless: convert in place instead of through the asynchronous apply
+        result = songManager.resampleSongFiles(song, engine.getSampleRate());
+        if (result.failed()) return result;
+        return songManager.applySongToEngine(song, engine);
+    }
+
+    //==========================================================================
+    struct Measurement
+    {
+        double      nsPerSample   {0.0};
+        double      p99Us         {0.0};
+        double      worstUs       {0.0};
+        double      budgetUs      {0.0};
+        double      allocsPerBlock{-1.0};   // -1 = not counted
+        int         rtViolations  {-1};     // -1 = checks not built in
+        int         overBudget    {0};
+    };
+
+    Measurement runConfiguration(const Options& o, int blockSize, int numLayers,
+                                 SongManager& songManager, juce::String& error)
+    {
+        Measurement m;
+
+        AudioEngine engine;
+        if (o.songDir == juce::File())
+            engine.setNumChannels(juce::jmax(o.numChannels, engine.getNumChannels()));   // before the device starts
+
+        NullAudioDevice device(o.sampleRate, blockSize, 2, 2);
+        engine.beginOfflineRendering(device);
+        engine.setParallelProcessing(o.parallel);
+
+        if (o.songDir != juce::File())
+        {
+            const auto r = loadSong(engine, songManager, o.songDir);
+            if (r.failed()) { error = r.getErrorMessage(); engine.endOfflineRendering(); return m; }
+        }
+        else
+        {
+            fillSynthetic(engine, o, numLayers);
+        }
+
+        for (int i = 0; i < engine.getNumChannels(); ++i)
+            if (auto* ch = engine.getChannel(i); ch && ch->sectionHasContent(engine.getActiveSection()))
+                engine.sendCommand(Command::startPlayback(i));
+
+        if (o.overdub)
+        {
+            Command c;
+            c.type         = CommandType::StartOverdub;
+            c.channelIndex = 0;
+            engine.sendCommand(c);
+        }
+        engine.setPlaying(true);
+
+        // I/O buffers: noise in, discarded out
+        juce::AudioBuffer<float> input (2, blockSize);
+        juce::AudioBuffer<float> output(2, blockSize);
+        juce::Random rng(99);
+        fillNoise(input, 0.1f, rng);
+
+        const juce::AudioIODeviceCallbackContext context {};
+        auto runBlock = [&]
+        {
+            engine.audioDeviceIOCallbackWithContext(input.getArrayOfReadPointers(), 2,
+                                                    output.getArrayOfWritePointers(), 2,
+                                                    blockSize, context);
+        };
+
+        // Warm up: commands, page pool refill, caches
+        for (int i = 0; i < 64; ++i)
+            runBlock();
+
+        const int numBlocks = juce::jmax(16, static_cast<int>(o.seconds * o.sampleRate / blockSize));
+        std::vector<juce::int64> blockTicks(static_cast<size_t>(numBlocks));
+
+       #if CHIEF_BENCHMARK_COUNT_ALLOCS
+        numAllocations.store(0, std::memory_order_relaxed);
+        countAllocations = true;
+       #endif
+
+        const int violationsBefore = RealtimeSafety::getNumViolations();
+
+        for (int b = 0; b < numBlocks; ++b)
+        {
+            const auto t0 = juce::Time::getHighResolutionTicks();
+            runBlock();
+            blockTicks[static_cast<size_t>(b)] = juce::Time::getHighResolutionTicks() - t0;
+        }
+
+       #if CHIEF_BENCHMARK_COUNT_ALLOCS
+        countAllocations = false;
+        m.allocsPerBlock = static_cast<double>(numAllocations.load(std::memory_order_relaxed)) / numBlocks;
+       #endif
+
+        if constexpr (RealtimeSafety::isEnabled())
+            m.rtViolations = RealtimeSafety::getNumViolations() - violationsBefore;
+
+        engine.setPlaying(false);
+        engine.endOfflineRendering();
+
+        const double ticksPerUs = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / 1.0e6;
+        juce::int64 total = 0;
+        for (auto t : blockTicks) total += t;
+
+        m.budgetUs    = blockSize / o.sampleRate * 1.0e6;
+        m.nsPerSample = static_cast<double>(total) / ticksPerUs * 1000.0
+                      / (static_cast<double>(numBlocks) * blockSize);
+
+        for (auto t : blockTicks)
+            if (static_cast<double>(t) / ticksPerUs > m.budgetUs) ++m.overBudget;
+
+        std::sort(blockTicks.begin(), blockTicks.end());
+        m.worstUs = static_cast<double>(blockTicks.back()) / ticksPerUs;
+        m.p99Us   = static_cast<double>(blockTicks[static_cast<size_t>((numBlocks - 1) * 99 / 100)]) / ticksPerUs;
+        return m;
+    }
+}
+
+//==============================================================================
+int EngineBenchmark::run(const juce::String& commandLine)
+{
+    const auto o = parseOptions(commandLine);
+    SongManager songManager;
+
+    juce::String report;
+    auto line = [&report](const juce::String& text)
+    {
+        std::cout << text << std::endl;
+        report << text << juce::newLine;
+    };
+
+    line("chief engine benchmark — " + juce::String(o.sampleRate, 0) + " Hz, "
+         + (o.songDir != juce::File() ? "song " + o.songDir.getFullPathName()
+                                      : juce::String(o.numChannels) + " ch x "
+                                        + juce::String(o.numSections) + " sec")
+         + (o.overdub  ? ", overdub ch1" : "")
+         + (o.parallel ? ", parallel"    : ""));
+    line("block  layers   ns/sample   p99 us  worst us  budget us  over  allocs/block  rt viol");
+
+    // A loaded song brings its own layers; the layer sweep applies to synthetic content only
+    const auto layerCounts = o.songDir != juce::File() ? juce::Array<int> { -1 } : o.layerCounts;
+
+    for (int blockSize : o.bufferSizes)
+    {
+        for (int layers : layerCounts)
+        {
+            juce::String error;
+            const auto m = runConfiguration(o, blockSize, juce::jmax(0, layers), songManager, error);
+            if (error.isNotEmpty())
+            {
+                line("error: " + error);
+                return 1;
+            }
+
+            line(juce::String(blockSize).paddedLeft(' ', 5)
+                 + (layers < 0 ? juce::String("song") : juce::String(layers)).paddedLeft(' ', 8)
+                 + juce::String(m.nsPerSample, 2).paddedLeft(' ', 12)
+                 + juce::String(m.p99Us, 1).paddedLeft(' ', 9)
+                 + juce::String(m.worstUs, 1).paddedLeft(' ', 10)
+                 + juce::String(m.budgetUs, 1).paddedLeft(' ', 11)
+                 + juce::String(m.overBudget).paddedLeft(' ', 6)
+                 + (m.allocsPerBlock < 0.0 ? juce::String("n/a")
+                                           : juce::String(m.allocsPerBlock, 2)).paddedLeft(' ', 14)
+                 + (m.rtViolations < 0 ? juce::String("n/a")
+                                       : juce::String(m.rtViolations)).paddedLeft(' ', 9));
+        }
+    }
+
+    // Where the violations came from (warm-up blocks included)
+    if (RealtimeSafety::getNumLogged() > 0)
+    {
+        line({});
+        line(RealtimeSafety::getReport(0, RealtimeSafety::kLogSize).trimEnd());
+    }
+
+    if (o.outFile != juce::File() && !o.outFile.replaceWithText(report))
+    {
+        std::cout << "could not write " << o.outFile.getFullPathName() << std::endl;
+        return 1;
+    }
+    return 0;
+}
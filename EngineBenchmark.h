@@ -0,0 +1,44 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+ * @file EngineBenchmark.h
+ * @brief Headless throughput benchmark for the audio callback
+ *
+ * Started with `chief --benchmark [options]` instead of the GUI.  Builds an
+ * AudioEngine on a null device (no sound card), fills it with synthetic loops
+ * or a saved song and drives audioDeviceIOCallbackWithContext() directly for
+ * every combination of the requested block sizes and layer counts.
+ *
+ * Options (lists are comma separated):
+ *   --buffers=64,128,256,512   block sizes
+ *   --channels=6               channels with loop content (1 - MAX_CHANNELS)
+ *   --sections=1               sections filled per channel (only the active one plays)
+ *   --layers=0,4,12            overdub layers per section
+ *   --overdub                  keep channel 1 overdubbing (exercises recordToLoop)
+ *   --parallel                 use the parallel channel renderer
+ *   --seconds=10               audio time rendered per configuration
+ *   --song=<song dir>          load loops through SongManager instead (plugins are skipped)
+ *   --out=<file>               also write the report to a file
+ *
+ * Reported per configuration: ns per sample (mean), p99/worst block time
+ * against the block budget, and heap allocations per block on the callback
+ * thread.  Allocation counting needs CHIEF_BENCHMARK_COUNT_ALLOCS=1 at build
+ * time because it replaces the global operator new.  Built with
+ * CHIEF_RT_SAFETY_CHECKS=1, the realtime-safety violations of the measured
+ * blocks are counted too, and the logged ones are printed with their stacks
+ * at the end (see RealtimeSafety).  Cache misses are best
+ * taken from the OS profiler, e.g. `perf stat -e cache-misses chief --benchmark`.
+ */
+class EngineBenchmark
+{
+public:
+    /** Run the benchmark described by the command line. Returns the process exit code. */
+    static int run(const juce::String& commandLine);
+
+    static bool isRequested(const juce::String& commandLine)
+    {
+        return commandLine.contains("--benchmark");
+    }
+};
@@ -0,0 +1,89 @@
+#include "EpochReclaimer.h"
+
+namespace
+{
+    constexpr int kReclaimIntervalMs = 20;
+}
+
+//==============================================================================
+EpochReclaimer::~EpochReclaimer()
+{
+    stopTimer();
+    reclaimAll();
+}
+
+juce::uint64 EpochReclaimer::readEpoch() const noexcept
+{
+    // Orders the caller's unpublishing store before the epoch read; pairs with
+    // the seq_cst increment at block start
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    return epoch.load(std::memory_order_seq_cst);
+}
+
+void EpochReclaimer::waitForBlockEnd(juce::uint64 blockEpoch) const noexcept
+{
+    if ((blockEpoch & 1) == 0) return;   // between blocks
+    while (epoch.load(std::memory_order_acquire) == blockEpoch)
+        juce::Thread::yield();
+}
+
+//==============================================================================
+void EpochReclaimer::whenSafe(SafeCallback onSafe)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    if (!onSafe) return;
+
+    const auto at = readEpoch();
+
+    // Between blocks (or no device running): nothing can still see it
+    if (isSafe(at) && retired.empty())
+    {
+        onSafe();
+        return;
+    }
+
+    retired.push_back({ at, std::move(onSafe) });
+    if (!isTimerRunning())
+        startTimer(kReclaimIntervalMs);
+}
+
+int EpochReclaimer::reclaim()
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    // Epochs only grow, so the safe entries are a prefix
+    size_t numSafe = 0;
+    while (numSafe < retired.size() && isSafe(retired[numSafe].epoch))
+        ++numSafe;
+
+    if (numSafe == 0)
+        return 0;
+
+    // Move out first: a callback may retire something new
+    std::vector<Retired> ready(std::make_move_iterator(retired.begin()),
+                               std::make_move_iterator(retired.begin() + static_cast<std::ptrdiff_t>(numSafe)));
+    retired.erase(retired.begin(), retired.begin() + static_cast<std::ptrdiff_t>(numSafe));
+
+    for (auto& r : ready)
+        r.onSafe();
+
+    return static_cast<int>(numSafe);
+}
+
+void EpochReclaimer::reclaimAll()
+{
+    while (!retired.empty())
+    {
+        auto all = std::move(retired);
+        retired.clear();
+        for (auto& r : all)
+            r.onSafe();
+    }
+}
+
+void EpochReclaimer::timerCallback()
+{
+    reclaim();
+    if (retired.empty())
+        stopTimer();
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file EpochReclaimer.h
+ * @brief Deferred release of objects the audio thread may still be using
+ *
+ * The audio callback brackets every block with a BlockScope, which bumps a
+ * 64-bit block epoch — odd while a block runs, even in between.  Code that
+ * swaps a channel or plugin first unpublishes the old object, then retires it
+ * here; the epoch is read right after.  The object is safe once that epoch was
+ * even (no block was running, the next one sees the new pointer) or the epoch
+ * has moved on (the block that could have seen it has ended).
+ *
+ * A stalled or missed callback only delays reclamation, it never frees early.
+ *
+ * Retired objects are released on the message thread, from a timer: plugin
+ * instances must be destroyed — or parked in the PluginInstancePool — there.
+ *
+ * Thread-safety:
+ *   Audio thread  : BlockScope (lock-free, two atomic increments per block)
+ *   Message thread: whenSafe(), retire(), reclaimAll()
+ *   Any thread    : getBlockEpoch(), waitForBlockEnd()
+ */
+class EpochReclaimer : private juce::Timer
+{
+public:
+    using SafeCallback = std::function<void()>;
+
+    /** Receives a retired object once it is safe (T deduced from the object only). */
+    template <typename T>
+    struct Handover { using Callback = std::function<void(std::unique_ptr<T>)>; };
+
+    EpochReclaimer() = default;
+    ~EpochReclaimer() override;
+
+    /** Marks one audio block. Construct first thing in the audio callback. */
+    struct BlockScope
+    {
+        explicit BlockScope(EpochReclaimer& r) noexcept : owner(r)
+        {
+            owner.epoch.fetch_add(1, std::memory_order_seq_cst);
+        }
+        ~BlockScope() { owner.epoch.fetch_add(1, std::memory_order_release); }
+
+        EpochReclaimer& owner;
+        JUCE_DECLARE_NON_COPYABLE(BlockScope)
+    };
+
+    /** Run onSafe once the audio thread can no longer see what was unpublished before this call. */
+    void whenSafe(SafeCallback onSafe);
+
+    /**
+     * @brief Hand an unpublished object to onSafe once it is safe.
+     *
+     * Without onSafe the object is just destroyed.  Null is ignored.
+     */
+    template <typename T>
+    void retire(std::unique_ptr<T> object, typename Handover<T>::Callback onSafe = nullptr)
+    {
+        if (object == nullptr) return;
+
+        // std::function must be copyable — share the single owner
+        auto holder = std::make_shared<std::unique_ptr<T>>(std::move(object));
+        whenSafe([holder, onSafe = std::move(onSafe)]
+        {
+            if (onSafe) onSafe(std::move(*holder));
+            else        holder->reset();
+        });
+    }
+
+    /** Run everything that is safe now. Returns the number of callbacks run. */
+    int reclaim();
+
+    /** Audio device closed: everything is safe, run it all. */
+    void reclaimAll();
+
+    /** The block epoch now: odd while an audio block runs. */
+    juce::uint64 getBlockEpoch() const noexcept { return readEpoch(); }
+
+    /**
+     * @brief Return once the block running at blockEpoch (if any) has ended.
+     *
+     * For a reader that saw the audio thread change something mid-copy: the
+     * change finishes inside that block.  Yields rather than sleeps, so it
+     * waits no longer than the rest of one callback.
+     */
+    void waitForBlockEnd(juce::uint64 blockEpoch) const noexcept;
+
+    int getNumPending() const { return static_cast<int>(retired.size()); }
+
+private:
+    struct Retired
+    {
+        juce::uint64 epoch;
+        SafeCallback onSafe;
+    };
+
+    std::atomic<juce::uint64> epoch {0};   // odd = audio block running
+    std::vector<Retired>      retired;     // message thread only, oldest first
+
+    juce::uint64 readEpoch() const noexcept;
+    bool isSafe(juce::uint64 retiredAt) const noexcept
+    {
+        return (retiredAt & 1) == 0 || epoch.load(std::memory_order_acquire) != retiredAt;
+    }
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(EpochReclaimer)
+};
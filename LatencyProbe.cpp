@@ -0,0 +1,75 @@
+#include "LatencyProbe.h"
+
+//==============================================================================
+void LatencyProbe::start(double sampleRate) noexcept
+{
+    // 200 ms of noise floor, then up to a second for the pulse to return
+    listenSamples .store(static_cast<int>(0.2 * sampleRate), std::memory_order_relaxed);
+    timeoutSamples.store(static_cast<int>(1.0 * sampleRate), std::memory_order_relaxed);
+    result.store(-1, std::memory_order_relaxed);
+    state.store(State::Armed, std::memory_order_release);
+}
+
+void LatencyProbe::process(const float* input, float* outL, float* outR, int numSamples) noexcept
+{
+    auto current = state.load(std::memory_order_acquire);
+    if (current == State::Idle || current == State::Done || current == State::Failed)
+        return;
+
+    if (current == State::Armed)
+    {
+        clock     = 0;
+        noisePeak = 0.0f;
+        state.store(current = State::Listening, std::memory_order_release);
+    }
+
+    //--- 1. NOISE FLOOR ---
+    if (current == State::Listening)
+    {
+        if (input != nullptr)
+        {
+            const auto range = juce::FloatVectorOperations::findMinAndMax(input, numSamples);
+            noisePeak = juce::jmax(noisePeak, std::abs(range.getStart()), std::abs(range.getEnd()));
+        }
+
+        clock += numSamples;
+        if (clock >= listenSamples.load(std::memory_order_relaxed))
+        {
+            pulseAt = clock;   // first sample of the next block
+            state.store(State::Pinging, std::memory_order_release);
+        }
+        return;
+    }
+
+    //--- 2. PULSE OUT, WAIT FOR IT TO COME BACK ---
+    if (input == nullptr)
+    {
+        state.store(State::Failed, std::memory_order_release);
+        return;
+    }
+
+    const float threshold = juce::jmax(kMinThreshold, noisePeak * 4.0f);
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const juce::int64 t = clock + i - pulseAt;
+
+        if (t < kPulseSamples)
+        {
+            const float v = kPulseLevel * std::sin(juce::MathConstants<float>::pi
+                                                   * static_cast<float>(t) / static_cast<float>(kPulseSamples));
+            if (outL != nullptr) outL[i] += v;
+            if (outR != nullptr) outR[i] += v;
+        }
+
+        if (std::abs(input[i]) > threshold)
+        {
+            result.store(static_cast<int>(t), std::memory_order_release);
+            state.store(State::Done, std::memory_order_release);
+            return;
+        }
+    }
+
+    clock += numSamples;
+    if (clock - pulseAt > timeoutSamples.load(std::memory_order_relaxed))
+        state.store(State::Failed, std::memory_order_release);
+}
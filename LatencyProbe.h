@@ -0,0 +1,61 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+//==============================================================================
+/**
+ * @file LatencyProbe.h
+ * @brief Ping-loopback measurement of the audio interface round trip
+ *
+ * With an output cabled (or routed in the interface mixer) back to an input,
+ * start() listens to the input for a moment to learn its noise floor, then
+ * sends a short pulse and waits for it to come back.  The result is the
+ * distance in engine samples between the sample the pulse left on and the
+ * sample it arrived on — exactly the shift recordings need, converters and
+ * driver buffers included.
+ *
+ * Thread-safety:
+ *   Message thread: start(), cancel(), getState(), getResult()
+ *   Audio thread  : process()
+ */
+class LatencyProbe
+{
+public:
+    enum class State { Idle, Armed, Listening, Pinging, Done, Failed };
+
+    /** Begin a measurement (restarts a running one). */
+    void start(double sampleRate) noexcept;
+    void cancel() noexcept { state.store(State::Idle, std::memory_order_release); }
+
+    State getState()  const noexcept { return state.load(std::memory_order_acquire); }
+    bool  isRunning() const noexcept
+    {
+        const auto s = getState();
+        return s == State::Armed || s == State::Listening || s == State::Pinging;
+    }
+
+    /** Round trip in samples once getState() == Done, -1 otherwise. */
+    int getResult() const noexcept { return result.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Listen on input, add the pulse to outL/outR (either may be nullptr).
+     * Call once per callback with the whole block, after the final output stage.
+     */
+    void process(const float* input, float* outL, float* outR, int numSamples) noexcept;
+
+private:
+    static constexpr int   kPulseSamples = 16;      // half-sine bump, broadband
+    static constexpr float kPulseLevel   = 0.5f;
+    static constexpr float kMinThreshold = 0.02f;   // -34 dBFS
+
+    std::atomic<State> state  {State::Idle};
+    std::atomic<int>   result {-1};
+    std::atomic<int>   listenSamples  {0};          // set by start()
+    std::atomic<int>   timeoutSamples {0};
+
+    // Audio thread
+    juce::int64 clock     {0};
+    juce::int64 pulseAt   {0};
+    float       noisePeak {0.0f};
+};
@@ -1,29 +1,81 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <limits>
 
 /**
  * Vertical level meter with logarithmic scale and seamless colour gradient.
  * Deep green → light green → yellow → orange → red.
- * Fast attack, slow decay.
+ * Fast attack, slow decay; a peak-hold tick, an RMS marker and a clip
+ * indicator on top.
+ *
+ * The gradient is rendered once per size into a cached image; paint() only
+ * blits the lit part of it.  setLevels() repaints just the rows that changed,
+ * and nothing at all if nothing moved by a whole pixel.
  */
 class LevelMeterComponent : public juce::Component
 {
 public:
+    LevelMeterComponent()
+    {
+        setOpaque(true);
+    }
+
     void setLevel(float newLevel)
+    {
+        setLevels(newLevel, 0.0f, false);
+    }
+
+    /** Peak and RMS since the last call (linear), clipped = a sample reached 0 dBFS. */
+    void setLevels(float peak, float rms, bool clipped)
     {
         // Fast attack, slow decay
-        if (newLevel >= displayLevel)
-            displayLevel = newLevel;
+        if (peak >= displayLevel)
+            displayLevel = peak;
         else
-            displayLevel = displayLevel * 0.85f + newLevel * 0.15f;
+            displayLevel = displayLevel * 0.85f + peak * 0.15f;
+
+        const auto now = juce::Time::getMillisecondCounter();
+        if (peak >= holdLevel || now >= holdUntilMs)
+        {
+            holdLevel   = peak;
+            holdUntilMs = now + kHoldMs;
+        }
+        if (clipped)
+            clipUntilMs = now + kClipMs;
+
+        Painted next;
+        next.fill = rowsFor(displayLevel);
+        next.rms  = rowsFor(rms);
+        next.hold = rowsFor(holdLevel);
+        next.clip = now < clipUntilMs;
+
+        // Dirty rows: every marker that moved, old and new position
+        int lo = std::numeric_limits<int>::max(), hi = -1;
+        auto touch = [&](int a, int b)
+        {
+            if (a == b) return;
+            lo = juce::jmin(lo, a, b);
+            hi = juce::jmax(hi, a, b);
+        };
+        touch(painted.fill, next.fill);
+        if (painted.rms  != next.rms)  { touch(painted.rms,  painted.rms  - 1); touch(next.rms,  next.rms  - 1); }
+        if (painted.hold != next.hold) { touch(painted.hold, painted.hold - 2); touch(next.hold, next.hold - 2); }
+
+        const auto inner = getLocalBounds().reduced(1);
+        if (painted.clip != next.clip)
+            touch(inner.getHeight(), inner.getHeight() - kClipRows);
 
-        repaint();
+        painted = next;
+        if (hi < 0) return;
+
+        lo = juce::jmax(0, lo);
+        repaint(inner.getX(), inner.getBottom() - hi, inner.getWidth(), hi - lo);
     }
 
     void paint(juce::Graphics& g) override
     {
-        auto b = getLocalBounds().toFloat();
+        auto b = getLocalBounds();
 
         // Dark background
         g.setColour(juce::Colour(0xFF1A1A1A));
@@ -31,41 +83,104 @@ public:
 
         // Border
         g.setColour(juce::Colour(0xFF444444));
-        g.drawRect(b, 1.0f);
+        g.drawRect(b, 1);
+
+        const auto inner = b.reduced(1);
+        const int  h     = inner.getHeight();
+
+        // Fill bottom-up from the cached gradient (logarithmic: -60 dB to 0 dB range)
+        const int fillH = juce::jmin(painted.fill, h);
+        if (fillH > 0 && gradientImage.isValid())
+        {
+            const int srcY = h - fillH;
+            g.drawImage(gradientImage,
+                        inner.getX(), inner.getY() + srcY, inner.getWidth(), fillH,
+                        0, srcY, inner.getWidth(), fillH);
+        }
+
+        // RMS: thin light line inside the bar
+        if (painted.rms > 0)
+        {
+            g.setColour(juce::Colours::white.withAlpha(0.45f));
+            g.fillRect(inner.getX(), inner.getBottom() - painted.rms, inner.getWidth(), 1);
+        }
 
-        // Fill bottom-up (logarithmic: -60 dB to 0 dB range)
-        const float linear = juce::jlimit(0.0f, 1.0f, displayLevel);
-        if (linear <= 0.0f) return;
+        // Peak hold: 2-pixel tick in the gradient colour of its height
+        if (painted.hold > 0)
+        {
+            g.setColour(gradientColour(static_cast<float>(painted.hold) / static_cast<float>(juce::jmax(1, h))));
+            g.fillRect(inner.getX(), inner.getBottom() - painted.hold, inner.getWidth(), 2);
+        }
+
+        // Clip indicator at the top
+        if (painted.clip)
+        {
+            g.setColour(juce::Colour(0xFFFF2020));
+            g.fillRect(inner.getX(), inner.getY(), inner.getWidth(), kClipRows);
+        }
+    }
+
+    void resized() override
+    {
+        const auto inner = getLocalBounds().reduced(1);
+        gradientImage = inner.isEmpty() ? juce::Image()
+                                        : renderGradient(inner.getWidth(), inner.getHeight());
+        painted.fill = rowsFor(displayLevel);
+        painted.hold = rowsFor(holdLevel);
+        painted.rms  = 0;
+    }
+
+private:
+    static constexpr juce::uint32 kHoldMs   = 1500;
+    static constexpr juce::uint32 kClipMs   = 2000;
+    static constexpr int          kClipRows = 3;
+
+    /** What is on screen, in rows from the bottom of the inner area. */
+    struct Painted
+    {
+        int  fill {0};
+        int  rms  {0};
+        int  hold {0};
+        bool clip {false};
+    };
+
+    float displayLevel = 0.0f;
+    float holdLevel    = 0.0f;
+    juce::uint32 holdUntilMs = 0;
+    juce::uint32 clipUntilMs = 0;
+    Painted painted;
+    juce::Image gradientImage;   // whole meter height, fully lit
+
+    /** Rows from the bottom for a linear level. */
+    int rowsFor(float level) const
+    {
+        const float linear = juce::jlimit(0.0f, 1.0f, level);
+        if (linear <= 0.0f) return 0;
 
         const float minDb = -60.0f;
         const float dB = juce::jlimit(minDb, 0.0f,
                              20.0f * std::log10(linear));
         const float norm = (dB - minDb) / (0.0f - minDb);  // 0..1
 
-        auto inner = b.reduced(1.0f);
-        const float innerH = inner.getHeight();
-        const float fillH = innerH * norm;
-        auto fillArea = inner;
-        fillArea = fillArea.removeFromBottom(fillH);
+        return juce::roundToInt(static_cast<float>(juce::jmax(0, getHeight() - 2)) * norm);
+    }
 
-        // Draw gradient fill: paint 1-pixel horizontal strips with interpolated colour
-        const float fillTop = fillArea.getY();
-        const float fillBot = fillArea.getBottom();
-        const float fillX = fillArea.getX();
-        const float fillW = fillArea.getWidth();
+    /** One row per pixel with the interpolated colour, bottom = quiet. */
+    static juce::Image renderGradient(int width, int height)
+    {
+        juce::Image img(juce::Image::RGB, width, height, false);
+        juce::Graphics g(img);
 
-        for (float py = fillBot - 1.0f; py >= fillTop; py -= 1.0f)
+        for (int row = 0; row < height; ++row)
         {
             // Position 0 = bottom (quiet), 1 = top (loud)
-            const float pos = (fillBot - py) / innerH;
+            const float pos = static_cast<float>(height - row) / static_cast<float>(height);
             g.setColour(gradientColour(pos));
-            g.fillRect(fillX, py, fillW, 1.0f);
+            g.fillRect(0, row, width, 1);
         }
+        return img;
     }
 
-private:
-    float displayLevel = 0.0f;
-
     /** Seamless gradient: deep green → light green → yellow → orange → red. */
     static juce::Colour gradientColour(float pos)
     {
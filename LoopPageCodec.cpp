@@ -0,0 +1,151 @@
+#include "LoopPageCodec.h"
+#include "LoopPagePool.h"
+#include <cstring>
+
+namespace
+{
+    enum Format : juce::uint8
+    {
+        Silent   = 0,   // no payload
+        Deflated = 1,   // XOR delta, byte planes, zlib
+        Raw      = 2    // page as is
+    };
+
+    constexpr int    kFrames  = LoopPagePool::kPageFrames;
+    constexpr int    kSamples = LoopPagePool::kPageFrames * LoopPagePool::kPageChannels;
+    constexpr size_t kBytes   = static_cast<size_t>(kSamples) * sizeof(float);
+
+    juce::uint32 toBits(float f) noexcept
+    {
+        juce::uint32 u;
+        std::memcpy(&u, &f, sizeof(u));
+        return u;
+    }
+
+    float fromBits(juce::uint32 u) noexcept
+    {
+        float f;
+        std::memcpy(&f, &u, sizeof(f));
+        return f;
+    }
+}
+
+size_t LoopPageCodec::getPageBytes() noexcept
+{
+    return kBytes;
+}
+
+//==============================================================================
+void LoopPageCodec::encode(const float* page, juce::MemoryBlock& out)
+{
+    // Bit patterns, not values: -0.0f must survive the round trip
+    bool silent = true;
+    for (int i = 0; i < kSamples && silent; ++i)
+        silent = toBits(page[i]) == 0;
+
+    if (silent)
+    {
+        const juce::uint8 tag = Silent;
+        out.replaceAll(&tag, 1);
+        return;
+    }
+
+    //--- 1. XOR delta per channel, one byte plane per byte of the sample ---
+    juce::HeapBlock<juce::uint8> planes(kBytes);
+    for (int ch = 0; ch < LoopPagePool::kPageChannels; ++ch)
+    {
+        juce::uint32 prev = 0;
+        for (int i = 0; i < kFrames; ++i)
+        {
+            const int idx = ch * kFrames + i;
+            const juce::uint32 bits = toBits(page[idx]);
+            const juce::uint32 x    = bits ^ prev;
+            prev = bits;
+
+            for (int b = 0; b < 4; ++b)
+                planes[static_cast<size_t>(b) * kSamples + static_cast<size_t>(idx)] =
+                    static_cast<juce::uint8>(x >> (8 * b));
+        }
+    }
+
+    //--- 2. Deflate (fastest level: packing runs during the show) ---
+    juce::MemoryOutputStream packed;
+    packed.writeByte(static_cast<char>(Deflated));
+    {
+        juce::GZIPCompressorOutputStream zip(packed, 1);
+        zip.write(planes.getData(), kBytes);
+        zip.flush();
+    }
+
+    if (packed.getDataSize() >= kBytes + 1)
+    {
+        // Noise-like audio: keep it raw instead of paying for the decode
+        out.setSize(kBytes + 1);
+        static_cast<juce::uint8*>(out.getData())[0] = Raw;
+        std::memcpy(static_cast<juce::uint8*>(out.getData()) + 1, page, kBytes);
+        return;
+    }
+
+    out.replaceAll(packed.getData(), packed.getDataSize());
+}
+
+//==============================================================================
+bool LoopPageCodec::decode(const juce::MemoryBlock& in, float* page)
+{
+    auto fail = [page]
+    {
+        juce::FloatVectorOperations::clear(page, kSamples);
+        return false;
+    };
+
+    if (in.getSize() < 1) return fail();
+    const auto* data = static_cast<const juce::uint8*>(in.getData());
+
+    switch (data[0])
+    {
+        case Silent:
+            juce::FloatVectorOperations::clear(page, kSamples);
+            return in.getSize() == 1;
+
+        case Raw:
+            if (in.getSize() != kBytes + 1) return fail();
+            std::memcpy(page, data + 1, kBytes);
+            return true;
+
+        case Deflated:
+            break;
+
+        default:
+            return fail();
+    }
+
+    juce::HeapBlock<juce::uint8> planes(kBytes);
+    {
+        juce::MemoryInputStream source(data + 1, in.getSize() - 1, false);
+        juce::GZIPDecompressorInputStream unzip(source);
+
+        size_t done = 0;
+        while (done < kBytes)
+        {
+            const int n = unzip.read(planes.getData() + done, static_cast<int>(kBytes - done));
+            if (n <= 0) return fail();
+            done += static_cast<size_t>(n);
+        }
+    }
+
+    for (int ch = 0; ch < LoopPagePool::kPageChannels; ++ch)
+    {
+        juce::uint32 prev = 0;
+        for (int i = 0; i < kFrames; ++i)
+        {
+            const int idx = ch * kFrames + i;
+            juce::uint32 x = 0;
+            for (int b = 0; b < 4; ++b)
+                x |= static_cast<juce::uint32>(planes[static_cast<size_t>(b) * kSamples + static_cast<size_t>(idx)]) << (8 * b);
+
+            prev ^= x;
+            page[idx] = fromBits(prev);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * @file LoopPageCodec.h
+ * @brief Lossless compression of one LoopPagePool page (both channels)
+ *
+ * Used to keep sections that are not playing packed in RAM (see the section
+ * tiers in Channel).  Float audio compresses poorly as raw bytes, so each
+ * sample's bit pattern is XORed with the previous one of its channel — close
+ * samples share sign, exponent and the top of the mantissa, which turns into
+ * zero bits — and the result is split into four byte planes before deflate.
+ * Decoding reproduces the page bit for bit (no dither, no rounding).
+ *
+ * Silent pages encode to a single byte; pages that would not shrink are
+ * stored raw.  Background/message thread only — both directions allocate.
+ */
+class LoopPageCodec
+{
+public:
+    /** Compress a page (LoopPagePool layout: channel 0, then channel 1) into out. */
+    static void encode(const float* page, juce::MemoryBlock& out);
+
+    /** Restore a page from encode() output. false (page cleared) if the data is damaged. */
+    static bool decode(const juce::MemoryBlock& in, float* page);
+
+    /** Bytes of one uncompressed page. */
+    static size_t getPageBytes() noexcept;
+};
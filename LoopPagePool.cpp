@@ -0,0 +1,873 @@
+#include "LoopPagePool.h"
+
+#if JUCE_WINDOWS
+ #ifndef NOMINMAX
+  #define NOMINMAX
+ #endif
+ #include <windows.h>
+ #include <psapi.h>
+#else
+ #include <sys/mman.h>
+ #include <sys/resource.h>
+ #include <unistd.h>
+#endif
+
+//==============================================================================
+// Memory locking (platform)
+//==============================================================================
+
+namespace
+{
+    bool lockMemory(void* mem, size_t bytes)
+    {
+       #if JUCE_WINDOWS
+        return VirtualLock(mem, bytes) != 0;
+       #else
+        return mlock(mem, bytes) == 0;
+       #endif
+    }
+
+    void unlockMemory(void* mem, size_t bytes)
+    {
+       #if JUCE_WINDOWS
+        VirtualUnlock(mem, bytes);
+       #else
+        munlock(mem, bytes);
+       #endif
+    }
+
+    /** Let the process lock `bytes` more than it needs by itself, as far as the OS allows. */
+    void raiseLockLimit(juce::int64 bytes)
+    {
+       #if JUCE_WINDOWS
+        // VirtualLock is limited by the minimum working set; grow it once from the original size
+        static SIZE_T baseMin = 0, baseMax = 0;
+        auto* process = GetCurrentProcess();
+        if (baseMin == 0 && !GetProcessWorkingSetSize(process, &baseMin, &baseMax))
+            return;
+        if (!SetProcessWorkingSetSize(process, baseMin + static_cast<SIZE_T>(bytes),
+                                               baseMax + static_cast<SIZE_T>(bytes)))
+            DBG("LoopPagePool: working set not raised (" + juce::String(static_cast<int>(GetLastError())) + ")");
+       #else
+        rlimit rl {};
+        if (getrlimit(RLIMIT_MEMLOCK, &rl) != 0 || rl.rlim_cur == RLIM_INFINITY)
+            return;
+
+        const auto wanted = static_cast<rlim_t>(bytes) + (8u << 20);   // slack for the page edges
+        if (rl.rlim_cur >= wanted) return;
+
+        rl.rlim_cur = (rl.rlim_max == RLIM_INFINITY) ? wanted : juce::jmin(wanted, rl.rlim_max);
+        if (setrlimit(RLIMIT_MEMLOCK, &rl) != 0 || rl.rlim_cur < wanted)
+            DBG("LoopPagePool: RLIMIT_MEMLOCK allows only " + juce::String(static_cast<juce::int64>(rl.rlim_cur >> 20)) + " MB");
+       #endif
+    }
+
+    /** Every OS page of [mem, mem + bytes) is in RAM. Does not touch the memory. */
+    bool isMemoryResident(const void* mem, size_t bytes)
+    {
+       #if JUCE_WINDOWS
+        constexpr size_t kOsPage = 4096;
+        const auto first = reinterpret_cast<uintptr_t>(mem) & ~(kOsPage - 1);
+        const auto last  = (reinterpret_cast<uintptr_t>(mem) + bytes - 1) & ~(kOsPage - 1);
+
+        PSAPI_WORKING_SET_EX_INFORMATION info[64];
+        for (auto addr = first; addr <= last;)
+        {
+            DWORD n = 0;
+            for (; n < 64 && addr <= last; ++n, addr += kOsPage)
+                info[n].VirtualAddress = reinterpret_cast<void*>(addr);
+
+            if (!QueryWorkingSetEx(GetCurrentProcess(), info, n * sizeof(info[0])))
+                return false;
+            for (DWORD i = 0; i < n; ++i)
+                if (!info[i].VirtualAttributes.Valid)
+                    return false;
+        }
+        return true;
+       #else
+        static const auto osPage = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        const auto first = reinterpret_cast<uintptr_t>(mem) & ~(osPage - 1);
+        const auto end   = reinterpret_cast<uintptr_t>(mem) + bytes;
+        const auto len   = static_cast<size_t>(end - first);
+
+        #if JUCE_MAC
+         char vec[256];
+        #else
+         unsigned char vec[256];
+        #endif
+        const size_t numOsPages = (len + osPage - 1) / osPage;
+        if (numOsPages > sizeof(vec)) return false;
+
+        if (mincore(reinterpret_cast<void*>(first), len, vec) != 0)
+            return false;
+        for (size_t i = 0; i < numOsPages; ++i)
+            if ((vec[i] & 1) == 0)
+                return false;
+        return true;
+       #endif
+    }
+}
+
+//==============================================================================
+// IndexStack
+//==============================================================================
+
+void LoopPagePool::IndexStack::push(int index, std::atomic<int>* linkArray) noexcept
+{
+    auto h = head.load(std::memory_order_relaxed);
+    juce::uint64 newHead;
+    do
+    {
+        linkArray[index].store(static_cast<int>(h & 0xFFFFFFFFu) - 1, std::memory_order_relaxed);
+        newHead = (((h >> 32) + 1) << 32) | static_cast<juce::uint64>(index + 1);
+    }
+    while (!head.compare_exchange_weak(h, newHead,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+    count.fetch_add(1, std::memory_order_relaxed);
+}
+
+int LoopPagePool::IndexStack::pop(std::atomic<int>* linkArray) noexcept
+{
+    auto h = head.load(std::memory_order_acquire);
+    for (;;)
+    {
+        const int index = static_cast<int>(h & 0xFFFFFFFFu) - 1;
+        if (index < 0) return -1;
+
+        const int next = linkArray[index].load(std::memory_order_relaxed);
+        const juce::uint64 newHead = (((h >> 32) + 1) << 32) | static_cast<juce::uint64>(next + 1);
+
+        if (head.compare_exchange_weak(h, newHead,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire))
+        {
+            count.fetch_sub(1, std::memory_order_relaxed);
+            return index;
+        }
+    }
+}
+
+//==============================================================================
+// LoopPagePool
+//==============================================================================
+
+LoopPagePool::LoopPagePool()
+    : juce::Thread("Loop Page Refill")
+    , pages(new std::atomic<float*>[kMaxPages])
+    , links(new std::atomic<int>[kMaxPages])
+    , refCounts(new std::atomic<int>[kMaxPages])
+    , locked(new bool[kMaxPages]())
+{
+    for (int i = 0; i < kMaxPages; ++i)
+    {
+        pages[static_cast<size_t>(i)].store(nullptr, std::memory_order_relaxed);
+        links[static_cast<size_t>(i)].store(-1, std::memory_order_relaxed);
+        refCounts[static_cast<size_t>(i)].store(0, std::memory_order_relaxed);
+    }
+}
+
+LoopPagePool::~LoopPagePool()
+{
+    stopThread(1000);
+
+    const juce::ScopedLock sl(allocLock);
+    for (int i = 0; i < kMaxPages; ++i)
+        freePage(i);
+}
+
+void LoopPagePool::prepare(int reservePages)
+{
+    setReserve(reservePages);
+
+    // Fill the reserve synchronously so the very first take has pages ready
+    while (getNumFreePages() < getReserve())
+    {
+        const int idx = allocatePage();
+        if (idx < 0) break;
+        freeStack.push(idx, links.get());
+    }
+
+    if (!isThreadRunning())
+        startThread(juce::Thread::Priority::low);
+}
+
+void LoopPagePool::setReserve(int reservePages)
+{
+    reserve.store(juce::jlimit(0, kMaxPages, reservePages), std::memory_order_release);
+}
+
+int LoopPagePool::acquire() noexcept
+{
+    const int idx = freeStack.pop(links.get());
+    if (idx < 0)
+        failedAcquires.fetch_add(1, std::memory_order_relaxed);
+    else
+        refCounts[static_cast<size_t>(idx)].store(1, std::memory_order_release);
+    return idx;
+}
+
+int LoopPagePool::acquireOrAllocate()
+{
+    int idx = freeStack.pop(links.get());
+    if (idx < 0) idx = allocatePage();
+    if (idx >= 0)
+        refCounts[static_cast<size_t>(idx)].store(1, std::memory_order_release);
+    return idx;
+}
+
+void LoopPagePool::release(int pageIndex) noexcept
+{
+    if (pageIndex < 0 || pageIndex >= kMaxPages) return;
+    if (refCounts[static_cast<size_t>(pageIndex)].fetch_sub(1, std::memory_order_acq_rel) == 1)
+        dirtyStack.push(pageIndex, links.get());
+}
+
+bool LoopPagePool::tryRetain(int pageIndex) noexcept
+{
+    if (pageIndex < 0 || pageIndex >= kMaxPages) return false;
+
+    auto& rc = refCounts[static_cast<size_t>(pageIndex)];
+    int n = rc.load(std::memory_order_acquire);
+    while (n > 0)
+        if (rc.compare_exchange_weak(n, n + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+            return true;
+    return false;
+}
+
+void LoopPagePool::trim()
+{
+    const juce::ScopedLock sl(allocLock);
+
+    while (getNumFreePages() > getReserve())
+    {
+        const int idx = freeStack.pop(links.get());
+        if (idx < 0) break;
+
+        freePage(idx);
+        numAllocated.fetch_sub(1, std::memory_order_relaxed);
+        vacantStack.push(idx, links.get());
+    }
+
+    DBG("LoopPagePool: " + juce::String(getNumAllocatedPages()) + " pages ("
+        + juce::String(getAllocatedBytes() / (1024 * 1024)) + " MB) after trim");
+}
+
+//==============================================================================
+// Locked memory
+//==============================================================================
+
+void LoopPagePool::setLockBudget(juce::int64 budgetBytes)
+{
+    budgetBytes = juce::jmax<juce::int64>(0, budgetBytes);
+    if (budgetBytes > 0)
+        raiseLockLimit(budgetBytes);
+
+    const juce::ScopedLock sl(allocLock);
+    lockBudget.store(budgetBytes, std::memory_order_relaxed);
+    lockFailed.store(false, std::memory_order_relaxed);
+
+    // Fit the pages that already exist: unlock the excess or lock up to the budget
+    const int used = nextUnusedIndex.load(std::memory_order_relaxed);
+    for (int i = used - 1; i >= 0 && getLockedBytes() > budgetBytes; --i)
+        unlockPage(i);
+    for (int i = 0; i < used && getLockedBytes() + kPageBytes <= budgetBytes && !hasLockFailed(); ++i)
+        lockPage(i);
+
+    DBG("LoopPagePool: " + juce::String(getLockedBytes() / (1024 * 1024)) + " of "
+        + juce::String(budgetBytes / (1024 * 1024)) + " MB locked");
+}
+
+bool LoopPagePool::isPageResident(int pageIndex) const
+{
+    if (pageIndex < 0 || pageIndex >= kMaxPages) return false;
+
+    const juce::ScopedLock sl(allocLock);   // keeps the page from being freed under mincore
+    const auto* mem = getPage(pageIndex);
+    if (mem == nullptr) return false;
+    if (locked[static_cast<size_t>(pageIndex)]) return true;
+    return isMemoryResident(mem, static_cast<size_t>(kPageBytes));
+}
+
+void LoopPagePool::lockPage(int pageIndex)
+{
+    auto* mem = getPage(pageIndex);
+    if (mem == nullptr || locked[static_cast<size_t>(pageIndex)] || hasLockFailed()) return;
+    if (getLockedBytes() + kPageBytes > getLockBudget()) return;
+
+    if (!lockMemory(mem, static_cast<size_t>(kPageBytes)))
+    {
+        // Out of locked-memory allowance: stop trying until the budget changes
+        lockFailed.store(true, std::memory_order_relaxed);
+        DBG("LoopPagePool: page lock refused at " + juce::String(getLockedBytes() / (1024 * 1024)) + " MB");
+        return;
+    }
+    locked[static_cast<size_t>(pageIndex)] = true;
+    numLocked.fetch_add(1, std::memory_order_relaxed);
+}
+
+void LoopPagePool::unlockPage(int pageIndex)
+{
+    if (!locked[static_cast<size_t>(pageIndex)]) return;
+
+    if (auto* mem = getPage(pageIndex))
+        unlockMemory(mem, static_cast<size_t>(kPageBytes));
+    locked[static_cast<size_t>(pageIndex)] = false;
+    numLocked.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void LoopPagePool::freePage(int pageIndex)
+{
+    unlockPage(pageIndex);
+    delete[] pages[static_cast<size_t>(pageIndex)].exchange(nullptr, std::memory_order_acq_rel);
+}
+
+//==============================================================================
+// Refill thread
+//==============================================================================
+
+void LoopPagePool::run()
+{
+    while (!threadShouldExit())
+    {
+        // 1. Zero released pages and make them available again
+        for (int idx = dirtyStack.pop(links.get()); idx >= 0; idx = dirtyStack.pop(links.get()))
+        {
+            zeroPage(idx);
+            freeStack.push(idx, links.get());
+        }
+
+        // 2. Top up the reserve
+        while (!threadShouldExit() && getNumFreePages() < getReserve())
+        {
+            const int idx = allocatePage();
+            if (idx < 0) break;   // table full
+            freeStack.push(idx, links.get());
+        }
+
+        wait(10);
+    }
+}
+
+int LoopPagePool::allocatePage()
+{
+    const juce::ScopedLock sl(allocLock);
+
+    int idx = vacantStack.pop(links.get());
+    if (idx < 0)
+    {
+        idx = nextUnusedIndex.load(std::memory_order_relaxed);
+        if (idx >= kMaxPages)
+        {
+            DBG("LoopPagePool: page table full");
+            return -1;
+        }
+        nextUnusedIndex.store(idx + 1, std::memory_order_relaxed);
+    }
+
+    // Zeroing also pre-faults: every OS page is touched before the audio thread sees it
+    auto* mem = new float[static_cast<size_t>(kPageFrames * kPageChannels)];
+    juce::FloatVectorOperations::clear(mem, kPageFrames * kPageChannels);
+    pages[static_cast<size_t>(idx)].store(mem, std::memory_order_release);
+    numAllocated.fetch_add(1, std::memory_order_relaxed);
+    lockPage(idx);
+    return idx;
+}
+
+void LoopPagePool::zeroPage(int pageIndex) noexcept
+{
+    if (auto* mem = getPage(pageIndex))
+        juce::FloatVectorOperations::clear(mem, kPageFrames * kPageChannels);
+}
+
+//==============================================================================
+// PagedLoopBuffer
+//==============================================================================
+
+void PagedLoopBuffer::setCapacity(juce::int64 frames)
+{
+    const int newSlots = static_cast<int>((juce::jmax<juce::int64>(0, frames)
+                                           + LoopPagePool::kPageFrames - 1)
+                                          / LoopPagePool::kPageFrames);
+
+    if (newSlots != numPageSlots)
+    {
+        std::unique_ptr<std::atomic<int>[]> newTable(newSlots > 0 ? new std::atomic<int>[newSlots]
+                                                                  : nullptr);
+        for (int i = 0; i < newSlots; ++i)
+        {
+            const int old = (i < numPageSlots) ? pageTable[i].load(std::memory_order_relaxed) : -1;
+            newTable[i].store(old, std::memory_order_relaxed);
+        }
+
+        // Pages beyond the new length go back to the pool
+        for (int i = newSlots; i < numPageSlots; ++i)
+        {
+            const int old = pageTable[i].exchange(-1, std::memory_order_acq_rel);
+            if (old >= 0 && pool) pool->release(old);
+        }
+
+        pageTable    = std::move(newTable);
+        numPageSlots = newSlots;
+    }
+
+    capacity = juce::jmax<juce::int64>(0, frames);
+    dropRepeatsPastCapacity();
+}
+
+void PagedLoopBuffer::setLength(juce::int64 frames) noexcept
+{
+    const juce::int64 maxFrames = static_cast<juce::int64>(numPageSlots) * LoopPagePool::kPageFrames;
+    capacity = juce::jlimit<juce::int64>(0, maxFrames, frames);
+
+    const int usedSlots = static_cast<int>((capacity + LoopPagePool::kPageFrames - 1)
+                                           / LoopPagePool::kPageFrames);
+    for (int i = usedSlots; i < numPageSlots; ++i)
+    {
+        const int page = pageTable[i].exchange(-1, std::memory_order_acq_rel);
+        if (page >= 0 && pool) pool->release(page);
+    }
+    dropRepeatsPastCapacity();
+}
+
+void PagedLoopBuffer::dropRepeatsPastCapacity() noexcept
+{
+    int n = numRepeats.load(std::memory_order_relaxed);
+    while (n > 0 && repeats[static_cast<size_t>(n - 1)].start >= capacity)
+        --n;
+    numRepeats.store(n, std::memory_order_release);
+}
+
+int PagedLoopBuffer::getNumMappedPages() const
+{
+    int n = 0;
+    for (int i = 0; i < numPageSlots; ++i)
+        if (pageTable[i].load(std::memory_order_relaxed) >= 0)
+            ++n;
+    return n;
+}
+
+//==============================================================================
+// Repeats
+//==============================================================================
+
+bool PagedLoopBuffer::repeatPrefix(juce::int64 length) noexcept
+{
+    const int n = numRepeats.load(std::memory_order_relaxed);
+    const juce::int64 end = length * 2;
+    if (length <= 0 || end > capacity || n >= kMaxRepeats) return false;
+    if (n > 0 && length < repeats[static_cast<size_t>(n - 1)].end) return false;
+
+    constexpr int K = LoopPagePool::kPageFrames;
+    const int firstSlot = static_cast<int>(length / K);
+    const int lastSlot  = static_cast<int>((end - 1) / K);
+
+    // Audio already stored in the range is replaced by the repeat, as a copy would.
+    // The page holding `length` keeps the frames before it; the rest of it is pending.
+    auto& r = repeats[static_cast<size_t>(n)];
+    r.start = length;
+    r.end   = end;
+    r.pending.store(length % K != 0 && isMapped(firstSlot), std::memory_order_relaxed);
+
+    for (int i = (length % K != 0) ? firstSlot + 1 : firstSlot; i <= lastSlot && i < numPageSlots; ++i)
+    {
+        const int page = pageTable[i].exchange(-1, std::memory_order_acq_rel);
+        if (page >= 0 && pool) pool->release(page);
+    }
+
+    numRepeats.store(n + 1, std::memory_order_release);
+    return true;
+}
+
+juce::int64 PagedLoopBuffer::resolve(juce::int64 pos, juce::int64& run) const noexcept
+{
+    constexpr int K = LoopPagePool::kPageFrames;
+
+    // Newest repeat first: a frame it resolves to may itself lie in an older repeat
+    for (int i = numRepeats.load(std::memory_order_acquire) - 1; i >= 0; --i)
+    {
+        const auto& r = repeats[static_cast<size_t>(i)];
+        if (pos >= r.end) break;
+        if (pos <  r.start)
+        {
+            run = juce::jmin(run, r.start - pos);   // stop where the repeat begins
+            continue;
+        }
+
+        run = juce::jmin(run, r.end - pos, static_cast<juce::int64>(K - pos % K));
+
+        const int slot = static_cast<int>(pos / K);
+        const bool virtualTail = slot == static_cast<int>(r.start / K)
+                              && r.pending.load(std::memory_order_acquire);
+        if (isMapped(slot) && !virtualTail)
+            return pos;   // written since the repeat was made
+
+        pos -= r.start;
+    }
+
+    run = juce::jmin(run, static_cast<juce::int64>(K - pos % K));
+    return pos;
+}
+
+bool PagedLoopBuffer::isRepeated(int slot) const noexcept
+{
+    const juce::int64 first = static_cast<juce::int64>(slot) * LoopPagePool::kPageFrames;
+    const juce::int64 last  = first + LoopPagePool::kPageFrames;
+    const int n = numRepeats.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+    {
+        const auto& r = repeats[static_cast<size_t>(i)];
+        if (r.start < last && r.end > first) return true;
+    }
+    return false;
+}
+
+bool PagedLoopBuffer::hasVirtualFrames(int slot) const noexcept
+{
+    if (!isMapped(slot)) return isRepeated(slot);
+
+    const int n = numRepeats.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+    {
+        const auto& r = repeats[static_cast<size_t>(i)];
+        if (r.start / LoopPagePool::kPageFrames == slot && r.pending.load(std::memory_order_acquire))
+            return true;
+    }
+    return false;
+}
+
+void PagedLoopBuffer::detachRepeatsOf(int slot, bool realtime) noexcept
+{
+    constexpr int K = LoopPagePool::kPageFrames;
+    const juce::int64 first = static_cast<juce::int64>(slot) * K;
+
+    for (int i = 0, n = numRepeats.load(std::memory_order_acquire); i < n; ++i)
+    {
+        const auto& r = repeats[static_cast<size_t>(i)];
+        const juce::int64 len = r.end - r.start;
+        if (first >= len) continue;   // not part of what this repeat shows
+
+        // The page's own virtual tail (very short loops) is filled by preparePage()
+        const int d0 = static_cast<int>((r.start + first) / K);
+        const int d1 = static_cast<int>((r.start + juce::jmin(first + K, len) - 1) / K);
+        for (int d = d0; d <= d1 && d < numPageSlots; ++d)
+            if (d != slot && hasVirtualFrames(d))
+                preparePage(d, realtime);
+    }
+}
+
+void PagedLoopBuffer::materialize(int slot, float* mem, juce::int64 from) const noexcept
+{
+    constexpr int K = LoopPagePool::kPageFrames;
+    const juce::int64 pageStart = static_cast<juce::int64>(slot) * K;
+    const juce::int64 pageEnd   = juce::jmin(pageStart + K, capacity);
+
+    // Source frames always lie before the destination (same page for very
+    // short loops) and never overlap it, so a forward copy in runs is safe.
+    for (juce::int64 pos = from; pos < pageEnd;)
+    {
+        juce::int64 run = pageEnd - pos;
+        const juce::int64 src = resolve(pos, run);
+        if (src != pos)
+        {
+            const int srcSlot = static_cast<int>(src / K);
+            const int srcPage = isMapped(srcSlot) ? pageTable[srcSlot].load(std::memory_order_acquire) : -1;
+            const float* s    = srcPage >= 0 ? pool->getPage(srcPage) : nullptr;
+
+            for (int ch = 0; ch < getNumChannels(); ++ch)
+            {
+                float* d = mem + ch * K + (pos - pageStart);
+                if (s != nullptr) juce::FloatVectorOperations::copy(d, s + ch * K + src % K, static_cast<int>(run));
+                else              juce::FloatVectorOperations::clear(d, static_cast<int>(run));
+            }
+        }
+        pos += run;
+    }
+}
+
+//==============================================================================
+const float* PagedLoopBuffer::getReadSpan(int channel, juce::int64 pos,
+                                          int& framesAvailable) const noexcept
+{
+    juce::int64 run = LoopPagePool::kPageFrames;
+    pos = resolve(pos, run);
+
+    const int slot   = static_cast<int>(pos / LoopPagePool::kPageFrames);
+    const int offset = static_cast<int>(pos % LoopPagePool::kPageFrames);
+    framesAvailable  = static_cast<int>(run);
+
+    if (pool == nullptr || slot < 0 || slot >= numPageSlots) return nullptr;
+
+    const int page = pageTable[slot].load(std::memory_order_acquire);
+    const float* mem = page >= 0 ? pool->getPage(page) : nullptr;
+    return mem ? mem + channel * LoopPagePool::kPageFrames + offset : nullptr;
+}
+
+float* PagedLoopBuffer::getWriteSpan(int channel, juce::int64 pos,
+                                     int& framesAvailable, bool realtime, bool mapUnmapped)
+{
+    const int slot   = static_cast<int>(pos / LoopPagePool::kPageFrames);
+    const int offset = static_cast<int>(pos % LoopPagePool::kPageFrames);
+    framesAvailable  = LoopPagePool::kPageFrames - offset;
+
+    if (pool == nullptr || slot < 0 || slot >= numPageSlots) return nullptr;
+
+    // An unmapped page inside a repeat is not silent — it is mapped to hold the repeated audio
+    if (!mapUnmapped && !isMapped(slot) && !isRepeated(slot)) return nullptr;
+
+    // Frames that repeat this page must keep the audio it holds before the write
+    detachRepeatsOf(slot, realtime);
+
+    float* mem = preparePage(slot, realtime);
+    return mem ? mem + channel * LoopPagePool::kPageFrames + offset : nullptr;
+}
+
+float* PagedLoopBuffer::preparePage(int slot, bool realtime) noexcept
+{
+    int page = pageTable[slot].load(std::memory_order_acquire);
+    if (page < 0)
+    {
+        page = realtime ? pool->acquire() : pool->acquireOrAllocate();
+        if (page < 0) return nullptr;
+        if (isRepeated(slot))
+            materialize(slot, pool->getPage(page), static_cast<juce::int64>(slot) * LoopPagePool::kPageFrames);
+        pageTable[slot].store(page, std::memory_order_release);
+    }
+    else if (pool->isShared(page))
+    {
+        // Copy-on-write: a snapshot still refers to this page. If no page is
+        // ready the write goes to the shared page and the snapshot sees it.
+        const int copy = realtime ? pool->acquire() : pool->acquireOrAllocate();
+        if (copy >= 0)
+        {
+            juce::FloatVectorOperations::copy(pool->getPage(copy), pool->getPage(page),
+                                              LoopPagePool::kPageFrames * LoopPagePool::kPageChannels);
+            pageTable[slot].store(copy, std::memory_order_release);
+            pool->release(page);
+            page = copy;
+        }
+    }
+
+    // First write to the page a repeat starts in: fill its virtual tail, oldest repeat first
+    for (int i = 0, n = numRepeats.load(std::memory_order_acquire); i < n; ++i)
+    {
+        auto& r = repeats[static_cast<size_t>(i)];
+        if (r.start / LoopPagePool::kPageFrames == slot && r.pending.load(std::memory_order_acquire))
+        {
+            materialize(slot, pool->getPage(page), r.start);
+            r.pending.store(false, std::memory_order_release);
+        }
+    }
+
+    return pool->getPage(page);
+}
+
+void PagedLoopBuffer::read(juce::AudioBuffer<float>& dest, int destStart,
+                           juce::int64 pos, int num, bool add) const noexcept
+{
+    const int numCh = juce::jmin(getNumChannels(), dest.getNumChannels());
+    num = static_cast<int>(juce::jmin(static_cast<juce::int64>(num), capacity - pos));
+    if (numCh <= 0 || num <= 0 || destStart + num > dest.getNumSamples()) return;
+
+    int done = 0;
+    while (done < num)
+    {
+        int avail = 0;
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            const float* src = getReadSpan(ch, pos + done, avail);
+            const int n = juce::jmin(avail, num - done);
+            float* d = dest.getWritePointer(ch, destStart + done);
+
+            if (src != nullptr)
+            {
+                if (add) juce::FloatVectorOperations::add (d, src, n);
+                else     juce::FloatVectorOperations::copy(d, src, n);
+            }
+            else if (!add)
+            {
+                juce::FloatVectorOperations::clear(d, n);
+            }
+        }
+        done += juce::jmin(avail, num - done);
+    }
+}
+
+void PagedLoopBuffer::write(const juce::AudioBuffer<float>& src, int srcStart,
+                            juce::int64 pos, int num, bool add, bool realtime)
+{
+    const int numCh = juce::jmin(getNumChannels(), src.getNumChannels());
+    num = static_cast<int>(juce::jmin(static_cast<juce::int64>(num), capacity - pos));
+    if (numCh <= 0 || num <= 0 || srcStart + num > src.getNumSamples()) return;
+
+    int done = 0;
+    while (done < num)
+    {
+        int avail = 0;
+        for (int ch = 0; ch < numCh; ++ch)
+        {
+            float* d = getWriteSpan(ch, pos + done, avail, realtime);
+            const int n = juce::jmin(avail, num - done);
+            if (d == nullptr) continue;   // pool exhausted — drop this span
+
+            const float* s = src.getReadPointer(ch, srcStart + done);
+            if (add) juce::FloatVectorOperations::add (d, s, n);
+            else     juce::FloatVectorOperations::copy(d, s, n);
+        }
+        done += juce::jmin(avail, num - done);
+    }
+}
+
+void PagedLoopBuffer::readWrapped(juce::AudioBuffer<float>& dest, juce::int64 startPos,
+                                  int num, bool add) const noexcept
+{
+    if (capacity <= 0) return;
+
+    juce::int64 readPos = startPos % capacity;
+    int destPos = 0;
+
+    while (destPos < num)
+    {
+        const int n = static_cast<int>(juce::jmin(static_cast<juce::int64>(num - destPos),
+                                                  capacity - readPos));
+        if (n <= 0) break;
+        read(dest, destPos, readPos, n, add);
+        destPos += n;
+        readPos  = (readPos + n) % capacity;
+    }
+}
+
+void PagedLoopBuffer::writeWrapped(const juce::AudioBuffer<float>& src, juce::int64 startPos,
+                                   int num, bool add, bool realtime)
+{
+    if (capacity <= 0) return;
+
+    juce::int64 writePos = startPos % capacity;
+    int srcPos = 0;
+
+    while (srcPos < num)
+    {
+        const int n = static_cast<int>(juce::jmin(static_cast<juce::int64>(num - srcPos),
+                                                  capacity - writePos));
+        if (n <= 0) break;
+        write(src, srcPos, writePos, n, add, realtime);
+        srcPos  += n;
+        writePos = (writePos + n) % capacity;
+    }
+}
+
+void PagedLoopBuffer::copyWithin(juce::int64 srcPos, juce::int64 dstPos, juce::int64 num) noexcept
+{
+    num = juce::jmin(num, capacity - srcPos, capacity - dstPos);
+
+    juce::int64 done = 0;
+    while (done < num)
+    {
+        int step = static_cast<int>(juce::jmin<juce::int64>(num - done, LoopPagePool::kPageFrames));
+        for (int ch = 0; ch < getNumChannels(); ++ch)
+        {
+            int srcAvail = 0, dstAvail = 0;
+            const float* s = getReadSpan(ch, srcPos + done, srcAvail);
+            step = juce::jmin(step, srcAvail);
+
+            if (s == nullptr)
+            {
+                // Silent source: only touch the destination if it already holds audio
+                if (auto* d = getWriteSpan(ch, dstPos + done, dstAvail, true, false))
+                    juce::FloatVectorOperations::clear(d, juce::jmin(step, dstAvail));
+                step = juce::jmin(step, dstAvail);
+                continue;
+            }
+
+            float* d = getWriteSpan(ch, dstPos + done, dstAvail, true);
+            step = juce::jmin(step, dstAvail);
+            if (d != nullptr)
+                juce::FloatVectorOperations::copy(d, s, step);
+        }
+        done += step;
+    }
+}
+
+void PagedLoopBuffer::clear() noexcept
+{
+    for (int i = 0; i < numPageSlots; ++i)
+    {
+        const int page = pageTable[i].exchange(-1, std::memory_order_acq_rel);
+        if (page >= 0 && pool) pool->release(page);
+    }
+    numRepeats.store(0, std::memory_order_release);
+}
+
+void PagedLoopBuffer::copyLayoutFrom(const PagedLoopBuffer& src)
+{
+    clear();
+    setCapacity(src.getMaxLength());
+    setLength(src.capacity);
+
+    const int n = src.numRepeats.load(std::memory_order_acquire);
+    for (int i = 0; i < n; ++i)
+    {
+        const auto& from = src.repeats[static_cast<size_t>(i)];
+        auto& to = repeats[static_cast<size_t>(i)];
+        to.start = from.start;
+        to.end   = from.end;
+        to.pending.store(from.pending.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+    numRepeats.store(n, std::memory_order_release);
+}
+
+bool PagedLoopBuffer::adoptPage(int slot, int page) noexcept
+{
+    if (slot < 0 || slot >= numPageSlots || page < 0) return false;
+    int expected = -1;
+    return pageTable[slot].compare_exchange_strong(expected, page, std::memory_order_acq_rel);
+}
+
+void PagedLoopBuffer::shareFrom(const PagedLoopBuffer& src)
+{
+    jassert(pool == src.pool);
+
+    copyLayoutFrom(src);
+
+    for (int i = 0; i < juce::jmin(numPageSlots, src.numPageSlots); ++i)
+    {
+        // The live side may release or replace the page while we look at it:
+        // only keep a reference that is still in its table after retaining.
+        for (;;)
+        {
+            const int page = src.pageTable[i].load(std::memory_order_acquire);
+            if (page < 0) break;
+            if (!pool->tryRetain(page)) continue;
+            if (src.pageTable[i].load(std::memory_order_acquire) == page)
+            {
+                pageTable[i].store(page, std::memory_order_release);
+                break;
+            }
+            pool->release(page);
+        }
+    }
+}
+
+void PagedLoopBuffer::swapWith(PagedLoopBuffer& other) noexcept
+{
+    jassert(pool == other.pool);
+    std::swap(capacity,     other.capacity);
+    std::swap(numPageSlots, other.numPageSlots);
+    std::swap(pageTable,    other.pageTable);
+
+    const int n = juce::jmax(numRepeats.load(std::memory_order_relaxed),
+                             other.numRepeats.load(std::memory_order_relaxed));
+    for (int i = 0; i < n; ++i)
+    {
+        auto& a = repeats[static_cast<size_t>(i)];
+        auto& b = other.repeats[static_cast<size_t>(i)];
+        std::swap(a.start, b.start);
+        std::swap(a.end,   b.end);
+        a.pending.store(b.pending.exchange(a.pending.load(std::memory_order_relaxed),
+                                           std::memory_order_relaxed),
+                        std::memory_order_relaxed);
+    }
+    const int mine = numRepeats.load(std::memory_order_relaxed);
+    numRepeats.store(other.numRepeats.load(std::memory_order_relaxed), std::memory_order_release);
+    other.numRepeats.store(mine, std::memory_order_release);
+}
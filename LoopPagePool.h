@@ -0,0 +1,313 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+ * @file LoopPagePool.h
+ * @brief Fixed-size sample pages for loop storage, handed out lock-free
+ *
+ * Loop audio is stored in pages of kPageFrames stereo frames instead of one
+ * contiguous 10-minute buffer per section.  Pages are taken from the pool as
+ * recording advances, so memory follows the real loop length.
+ *
+ * Three lock-free stacks share one link array:
+ *   free   — zeroed pages ready for the audio thread
+ *   dirty  — released pages waiting to be zeroed
+ *   vacant — page ids whose memory has been trimmed
+ *
+ * A background thread zeroes dirty pages and keeps at least `reserve` free
+ * pages available, so acquire() on the audio thread never allocates.
+ *
+ * Pages are reference counted so a snapshot can share them with a live
+ * buffer (PagedLoopBuffer::shareFrom); a page returns to the pool when the
+ * last holder releases it.  A holder that writes to a shared page first
+ * takes a private copy (copy-on-write).
+ *
+ * Page memory is pre-faulted (zeroed) when it is allocated, and up to a lock
+ * budget of it is pinned in RAM (mlock / VirtualLock) so the OS cannot page
+ * an idle section out — otherwise the first read after a switch faults
+ * inside the audio callback.
+ *
+ * Thread-safety:
+ *   Audio thread  : acquire(), release(), getPage(), isShared()
+ *   Message thread: prepare(), setReserve(), acquireOrAllocate(), trim(), tryRetain(),
+ *                   setLockBudget()
+ *                   (also the engine background thread: section tiers trim after packing)
+ */
+class LoopPagePool : private juce::Thread
+{
+public:
+    static constexpr int kPageFrames   = 32768;
+    static constexpr int kPageChannels = 2;
+    static constexpr int kMaxPages     = 65536;
+
+    LoopPagePool();
+    ~LoopPagePool() override;
+
+    /** Start the refill thread and make sure `reserve` zeroed pages exist. Message thread. */
+    void prepare(int reservePages);
+
+    /** Number of zeroed pages the refill thread keeps ready. */
+    void setReserve(int reservePages);
+    int  getReserve() const { return reserve.load(std::memory_order_relaxed); }
+
+    /** Pop a zeroed page. Returns -1 if none is ready. Audio thread, lock-free. */
+    int acquire() noexcept;
+
+    /** Like acquire() but allocates a new page when the free list is empty. Never audio thread. */
+    int acquireOrAllocate();
+
+    /** Drop one reference; the page returns to the pool with the last one. Any thread, lock-free. */
+    void release(int pageIndex) noexcept;
+
+    /** Add a reference to a page that is still held by someone. False if it was already released. */
+    bool tryRetain(int pageIndex) noexcept;
+
+    /** true if more than one buffer refers to the page (writes must copy first). */
+    bool isShared(int pageIndex) const noexcept
+    {
+        return pageIndex >= 0 && pageIndex < kMaxPages
+            && refCounts[static_cast<size_t>(pageIndex)].load(std::memory_order_acquire) > 1;
+    }
+
+    /** Page memory: channel 0 at [0, kPageFrames), channel 1 at [kPageFrames, 2*kPageFrames). */
+    float* getPage(int pageIndex) const noexcept
+    {
+        return (pageIndex >= 0 && pageIndex < kMaxPages)
+             ? pages[static_cast<size_t>(pageIndex)].load(std::memory_order_acquire)
+             : nullptr;
+    }
+
+    /** Free spare zeroed pages above the reserve. Never the audio thread. */
+    void trim();
+
+    /**
+     * @brief Keep up to budgetBytes of page memory locked in RAM. 0 = no locking.
+     *
+     * Raises the process limit (RLIMIT_MEMLOCK soft limit / working set size)
+     * as far as the OS allows, then locks or unlocks existing pages to fit
+     * the budget; pages allocated later are locked while it has room.  If the
+     * OS refuses a lock, locking stops until the budget is set again.
+     * Message thread.
+     */
+    void setLockBudget(juce::int64 budgetBytes);
+
+    /** true if the page's memory is in RAM right now (locked pages always are). Never the audio thread. */
+    bool isPageResident(int pageIndex) const;
+
+    //==========================================================================
+    // Diagnostics
+    int         getNumAllocatedPages() const { return numAllocated.load(std::memory_order_relaxed); }
+    int         getNumFreePages()      const { return freeStack.count.load(std::memory_order_relaxed); }
+    int         getNumFailedAcquires() const { return failedAcquires.load(std::memory_order_relaxed); }
+    juce::int64 getAllocatedBytes()    const
+    {
+        return static_cast<juce::int64>(getNumAllocatedPages()) * kPageBytes;
+    }
+    juce::int64 getLockBudget()        const { return lockBudget.load(std::memory_order_relaxed); }
+    juce::int64 getLockedBytes()       const { return static_cast<juce::int64>(numLocked.load(std::memory_order_relaxed)) * kPageBytes; }
+    bool        hasLockFailed()        const { return lockFailed.load(std::memory_order_relaxed); }
+
+    static constexpr juce::int64 kPageBytes = static_cast<juce::int64>(kPageFrames) * kPageChannels
+                                            * static_cast<juce::int64>(sizeof(float));
+
+private:
+    /** Treiber stack of page indices; head packs an ABA tag (high) and index + 1 (low). */
+    struct IndexStack
+    {
+        std::atomic<juce::uint64> head  {0};
+        std::atomic<int>          count {0};
+
+        void push(int index, std::atomic<int>* links) noexcept;
+        int  pop (std::atomic<int>* links) noexcept;
+    };
+
+    std::unique_ptr<std::atomic<float*>[]> pages;
+    std::unique_ptr<std::atomic<int>[]>    links;
+    std::unique_ptr<std::atomic<int>[]>    refCounts;
+    std::unique_ptr<bool[]>                locked;      // guarded by allocLock
+
+    IndexStack freeStack;
+    IndexStack dirtyStack;
+    IndexStack vacantStack;
+
+    std::atomic<int> nextUnusedIndex {0};
+    std::atomic<int> numAllocated    {0};
+    std::atomic<int> failedAcquires  {0};
+    std::atomic<int> reserve         {0};
+    std::atomic<int> numLocked       {0};
+
+    std::atomic<juce::int64> lockBudget {0};
+    std::atomic<bool>        lockFailed {false};
+
+    mutable juce::CriticalSection allocLock;   // refill thread vs. message thread, never audio thread
+
+    void run() override;
+    int  allocatePage();               // returns index or -1 when the table is full
+    void zeroPage(int pageIndex) noexcept;
+    void lockPage(int pageIndex);      // allocLock held; no-op past the budget
+    void unlockPage(int pageIndex);    // allocLock held
+    void freePage(int pageIndex);      // allocLock held
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LoopPagePool)
+};
+
+//==============================================================================
+/**
+ * @brief Stereo loop buffer backed by LoopPagePool pages.
+ *
+ * Unmapped pages read as silence.  Writes map pages on demand; on the audio
+ * thread a write into an unmapped page is dropped if the pool has nothing
+ * ready (counted in LoopPagePool::getNumFailedAcquires()).
+ *
+ * Loop doubling repeats the start of the buffer virtually (repeatPrefix()),
+ * so doubling costs nothing however long the loop is.
+ */
+class PagedLoopBuffer
+{
+public:
+    PagedLoopBuffer() = default;
+    ~PagedLoopBuffer() { clear(); }
+
+    void          setPool(LoopPagePool* newPool) { pool = newPool; }
+    LoopPagePool* getPool() const               { return pool; }
+
+    /** Set the addressable length in frames. Mapped pages inside the new length are kept. */
+    void        setCapacity(juce::int64 frames);
+
+    /**
+     * @brief Change the wrap length without resizing the page table (audio thread safe).
+     *
+     * Clamped to the size set by setCapacity(). Pages past the new length are released.
+     */
+    void        setLength(juce::int64 frames) noexcept;
+    juce::int64 getCapacity()    const { return capacity; }
+    juce::int64 getMaxLength()   const { return static_cast<juce::int64>(numPageSlots) * LoopPagePool::kPageFrames; }
+    int         getNumChannels() const { return LoopPagePool::kPageChannels; }
+    int         getNumMappedPages() const;
+
+    /** Read num frames starting at pos into dest (no wrap). add=false overwrites. */
+    void read(juce::AudioBuffer<float>& dest, int destStart,
+              juce::int64 pos, int num, bool add) const noexcept;
+
+    /** Write num frames from src at pos (no wrap). realtime=false may allocate pages. */
+    void write(const juce::AudioBuffer<float>& src, int srcStart,
+               juce::int64 pos, int num, bool add, bool realtime = true);
+
+    /** Read/write with wrap-around at the capacity. */
+    void readWrapped (juce::AudioBuffer<float>& dest, juce::int64 startPos,
+                      int num, bool add) const noexcept;
+    void writeWrapped(const juce::AudioBuffer<float>& src, juce::int64 startPos,
+                      int num, bool add, bool realtime = true);
+
+    /** Copy frames within this buffer (non-overlapping ranges). Audio thread safe. */
+    void copyWithin(juce::int64 srcPos, juce::int64 dstPos, juce::int64 num) noexcept;
+
+    /**
+     * @brief Make [length, 2*length) repeat [0, length) without copying audio.
+     *
+     * The repeated range is virtual: reads resolve into the original frames,
+     * and a page is only filled with real audio when something is written to
+     * it (same cost as a copy-on-write page).  Pages already mapped inside the
+     * range are released.  Audio thread safe.
+     *
+     * @return false if 2*length exceeds the capacity, the range would overlap
+     *         an earlier repeat or kMaxRepeats is reached — use copyWithin() then.
+     */
+    bool repeatPrefix(juce::int64 length) noexcept;
+    int  getNumRepeats() const noexcept { return numRepeats.load(std::memory_order_acquire); }
+
+    static constexpr int kMaxRepeats = 16;
+
+    /**
+     * @brief Direct read access to the page containing pos.
+     * @param framesAvailable  Set to the number of contiguous frames from pos.
+     * @return Pointer for the channel or nullptr if the page is unmapped (silence).
+     */
+    const float* getReadSpan(int channel, juce::int64 pos, int& framesAvailable) const noexcept;
+
+    /** Release every mapped page back to the pool and drop all repeats. Lock-free. */
+    void clear() noexcept;
+
+    /** Exchange page tables and length with another buffer on the same pool. No allocation. */
+    void swapWith(PagedLoopBuffer& other) noexcept;
+
+    /**
+     * @brief Become a copy-on-write snapshot of src: same pages, shared by reference.
+     *
+     * Costs one reference per mapped page, no audio is copied. Whichever side
+     * writes to a shared page afterwards copies it first. Never audio thread.
+     */
+    void shareFrom(const PagedLoopBuffer& src);
+
+    /** Take src's table size, length and repeats, but none of its pages. Never audio thread. */
+    void copyLayoutFrom(const PagedLoopBuffer& src);
+
+    /** Pool page mapped at a slot, -1 if unmapped. Slots cover kPageFrames frames each. */
+    int getNumPageSlots() const noexcept { return numPageSlots; }
+    int getMappedPage(int slot) const noexcept
+    {
+        return slot >= 0 && slot < numPageSlots ? pageTable[slot].load(std::memory_order_acquire) : -1;
+    }
+
+    /**
+     * @brief Map a page the caller holds a reference to into an unmapped slot.
+     *
+     * The buffer takes over the reference.  Repeats are not consulted — the page
+     * must already hold the frames the slot stores (see Channel section tiers).
+     * @return false (reference not taken) if the slot is out of range or mapped.
+     */
+    bool adoptPage(int slot, int page) noexcept;
+
+private:
+    LoopPagePool* pool {nullptr};
+    juce::int64   capacity {0};
+    int           numPageSlots {0};
+    std::unique_ptr<std::atomic<int>[]> pageTable;   // -1 = unmapped
+
+    /**
+     * [start, end) reads [0, end - start) until a write fills the page.  Repeats
+     * ascend and never overlap.  A page mapped inside a repeat holds real audio,
+     * except the page containing start while `pending` is set: its part from
+     * start on is still virtual.
+     */
+    struct Repeat
+    {
+        juce::int64       start {0};
+        juce::int64       end   {0};
+        std::atomic<bool> pending {false};
+    };
+    std::array<Repeat, kMaxRepeats> repeats;
+    std::atomic<int> numRepeats {0};
+
+    bool isMapped(int slot) const noexcept
+    {
+        return slot >= 0 && slot < numPageSlots && pageTable[slot].load(std::memory_order_acquire) >= 0;
+    }
+
+    /** Map pos to the frame that really holds its audio; shortens run to the contiguous part. */
+    juce::int64 resolve(juce::int64 pos, juce::int64& run) const noexcept;
+
+    /** Fill a page's virtual frames from `from` to the page end with the audio they repeat. */
+    void materialize(int slot, float* mem, juce::int64 from) const noexcept;
+
+    bool isRepeated(int slot) const noexcept;
+    bool hasVirtualFrames(int slot) const noexcept;
+
+    /** Materialize the pages that repeat this one before it is written. */
+    void detachRepeatsOf(int slot, bool realtime) noexcept;
+
+    /** Map, copy-on-write and materialize a page for writing. nullptr if the pool is empty. */
+    float* preparePage(int slot, bool realtime) noexcept;
+    void dropRepeatsPastCapacity() noexcept;
+
+    /** mapUnmapped=false returns nullptr for unmapped pages instead of mapping one. */
+    float* getWriteSpan(int channel, juce::int64 pos, int& framesAvailable, bool realtime,
+                        bool mapUnmapped = true);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PagedLoopBuffer)
+};
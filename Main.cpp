@@ -1,6 +1,8 @@
 #include <JuceHeader.h>
 #include "MainComponent.h"
 #include "SplashComponent.h"
+#include "EngineBenchmark.h"
+#include "ParallelPluginScanner.h"
 
 /**
  * @file Main.cpp
@@ -31,6 +33,22 @@ public:
 
     void initialise(const juce::String& commandLine) override
     {
+        // Headless engine benchmark: no window, no sound card
+        if (EngineBenchmark::isRequested(commandLine))
+        {
+            setApplicationReturnValue(EngineBenchmark::run(commandLine));
+            quit();
+            return;
+        }
+
+        // Plugin scan child: scan one file, write the result, exit
+        if (ParallelPluginScanner::isChildProcessRequest(commandLine))
+        {
+            setApplicationReturnValue(ParallelPluginScanner::runChildProcess(getCommandLineParameterArray()));
+            quit();
+            return;
+        }
+
         // 1. Show splash window immediately (before any heavy work)
         splashComponent = std::make_unique<SplashComponent>();
 
@@ -1,9 +1,12 @@
 #include "MainComponent.h"
 #include "AppConfig.h"
+#include "DenormalPolicy.h"
+#include "RealtimeSafety.h"
+#include "StartupGraph.h"
 
 //==============================================================================
 MainComponent::MainComponent(std::function<void(const juce::String&)> splashCallback)
-    : transportComponent(audioEngine)
+    : transportComponent(audioEngine, uiClock)
 {
     // Wire splash status before any heavy work so plugin load messages are visible
     onSplashStatus = std::move(splashCallback);
@@ -13,44 +16,29 @@ MainComponent::MainComponent(std::function<void(const juce::String&)> splashCall
 
     loadPreferences();
 
-    if (onSplashStatus) onSplashStatus("Initializing audio...");
+    // Channel count is fixed before the device opens
+    if constexpr (!kFreeVersion)
+        audioEngine.setNumChannels(numChannels);
+    audioEngine.setRecordLatencyOverride(recordLatencyOverride);
+    songManager->setResampleQuality(static_cast<PolyphaseResampler::Quality>(resampleQuality));
 
-    // --- Audio init first ---
-    initializeAudio();
-
-    // --- Transport ---
-    addAndMakeVisible(transportComponent);
-
-    // BUG A FIX: refreshAfterAudioInit() muss nach initializeAudio() aufgerufen werden,
-    // damit metroOutputBox die tatsächliche Kanal-Anzahl kennt.
-    transportComponent.refreshAfterAudioInit();
-    transportComponent.getMasterRecordPath = [this] { return masterRecordPath; };
-
-    // --- Channel strips ---
-    for (int i = 0; i < kMaxChannels; ++i)
+    // Show alert when a plugin fails to load (wired first: the last session loads during startup)
+    audioEngine.onPluginLoadError = [](int ch, int slot, const juce::String& msg)
     {
-        channelStrips[i] = std::make_unique<ChannelStripComponent>(audioEngine, i);
-        addAndMakeVisible(channelStrips[i].get());
-    }
-
-    // --- Show component ---
-    showComponent = std::make_unique<ShowComponent>(audioEngine,
-                                                    *songManager,
-                                                    *showManager);
-    showComponent->setAudioReady(true);
-    showComponent->setDefaultTemplateFunctions(
-        [this]              { return defaultTemplatePath; },
-        [this](const juce::String& p) { defaultTemplatePath = p; savePreferences(); });
-    addAndMakeVisible(showComponent.get());
+        juce::AlertWindow::showMessageBoxAsync(
+            juce::AlertWindow::WarningIcon, "Plugin Load Error",
+            "Ch" + juce::String(ch + 1) + " Slot " + juce::String(slot + 1) + ": " + msg);
+    };
 
-    // --- Auto-recall last session if preference is set ---
-    if (autoRecallLastSession)
+    // Wire plugin load progress to splash screen callback
+    audioEngine.onPluginLoadStart = [this](int, int, const juce::String& name)
     {
-        if (onSplashStatus) onSplashStatus("Restoring last session...");
-        auto result = songManager->loadCurrentSong(audioEngine);
-        if (!result.wasOk())
-            DBG("Auto-recall: " + result.getErrorMessage()); // silently ignore on first run
-    }
+        if (onSplashStatus)
+            onSplashStatus("Loading: " + name + "...");
+    };
+
+    // --- Device, files, interface and last session (StartupGraph) ---
+    runStartupGraph();
 
     // --- Info label ---
     infoLabel.setJustificationType(juce::Justification::centredLeft);
@@ -72,7 +60,98 @@ MainComponent::MainComponent(std::function<void(const juce::String&)> splashCall
             [this]       { return autoRecallLastSession; },
             [this](bool v) { autoRecallLastSession = v; savePreferences(); },
             [this]              { return masterRecordPath; },
-            [this](const juce::String& p) { masterRecordPath = p; savePreferences(); });
+            [this](const juce::String& p) { masterRecordPath = p; savePreferences(); },
+            [this]       { return parallelChannelProcessing; },
+            [this](bool v)
+            {
+                parallelChannelProcessing = v;
+                audioEngine.setParallelProcessing(v);
+                savePreferences();
+            },
+            [this]      { return overdubUndoDepth; },
+            [this](int v)
+            {
+                overdubUndoDepth = v;
+                audioEngine.setOverdubConsolidation(v + 4, v);
+                savePreferences();
+            },
+            [this]       { return flushDenormals; },
+            [this](bool v)
+            {
+                flushDenormals = v;
+                DenormalPolicy::setFlushEnabled(v);
+                savePreferences();
+            },
+            [this]       { return packIdleSections; },
+            [this](bool v)
+            {
+                packIdleSections = v;
+                audioEngine.setSectionCompression(v);
+                savePreferences();
+            },
+            [this]      { return lockedLoopMemoryMb; },
+            [this](int v)
+            {
+                lockedLoopMemoryMb = v;
+                audioEngine.setLockedLoopMemory(static_cast<juce::int64>(v) << 20);
+                savePreferences();
+            },
+            [this]       { return recordStems; },
+            [this](bool v)
+            {
+                recordStems = v;
+                audioEngine.setRecordStems(v);
+                savePreferences();
+            },
+            kFreeVersion ? std::function<int()>() : [this] { return numChannels; },
+            [this](int v) { numChannels = v; savePreferences(); },
+            [this]      { return recordLatencyOverride; },
+            [this](int v)
+            {
+                recordLatencyOverride = v;
+                audioEngine.setRecordLatencyOverride(v);
+                savePreferences();
+            },
+            [this]      { audioEngine.startLatencyMeasurement(); },
+            [this]      { return audioEngine.getLatencyMeasurement(); },
+            [this]      { return midiClockOutput; },
+            [this](const juce::String& id)
+            {
+                const auto result = audioEngine.setMidiClockOutput(id);
+                midiClockOutput = result.wasOk() ? id : juce::String();
+                savePreferences();
+                return result;
+            },
+            [this]      { return audioEngine.getMidiClockStats(); },
+            [this]      { return metricsTarget; },
+            [this](const juce::String& target)
+            {
+                const auto result = metricsExporter.setTarget(target);
+                if (result.wasOk())
+                {
+                    metricsTarget = target.trim();
+                    savePreferences();
+                }
+                return result;
+            },
+            [this]      { return resampleQuality; },
+            [this](int v)
+            {
+                resampleQuality = v;
+                songManager->setResampleQuality(static_cast<PolyphaseResampler::Quality>(v));
+                savePreferences();
+            },
+            [this]      { return renderWorkerCores; },
+            [this](const juce::String& cores)
+            {
+                const auto result = audioEngine.setRenderWorkerCores(cores);
+                if (result.wasOk())
+                {
+                    renderWorkerCores = cores.trim();
+                    savePreferences();
+                }
+                return result;
+            });
 
         juce::DialogWindow::LaunchOptions opts;
         opts.content.setOwned(prefs);
@@ -119,21 +198,6 @@ MainComponent::MainComponent(std::function<void(const juce::String&)> splashCall
             BinaryData::chief_lp6_logo_png,
             BinaryData::chief_lp6_logo_pngSize);
 
-    // Show alert when a plugin fails to load
-    audioEngine.onPluginLoadError = [](int ch, int slot, const juce::String& msg)
-    {
-        juce::AlertWindow::showMessageBoxAsync(
-            juce::AlertWindow::WarningIcon, "Plugin Load Error",
-            "Ch" + juce::String(ch + 1) + " Slot " + juce::String(slot + 1) + ": " + msg);
-    };
-
-    // Wire plugin load progress to splash screen callback
-    audioEngine.onPluginLoadStart = [this](int, int, const juce::String& name)
-    {
-        if (onSplashStatus)
-            onSplashStatus("Loading: " + name + "...");
-    };
-
     // Auto-save settings whenever the audio device configuration changes
     audioEngine.getDeviceManager().addChangeListener(this);
 
@@ -142,22 +206,240 @@ MainComponent::MainComponent(std::function<void(const juce::String&)> splashCall
     addKeyListener(this);
 
     setSize(1400, 780);
-    startTimerHz(20);  // 20 Hz for live status info in the info bar
+    uiClock.addClient(*this, 20);  // 20 Hz for live status info in the info bar
 }
 
 MainComponent::~MainComponent()
 {
-    stopTimer();
+    uiClock.removeClient(*this);
     audioEngine.getDeviceManager().removeChangeListener(this);
 
     // Stop audio device before reading loop buffers (required for thread safety)
     audioEngine.getDeviceManager().closeAudioDevice();
 
     // Auto-save current session (channel settings, VSTs, metronome, loops, routings)
-    songManager->saveCurrentSong(audioEngine);
+    const auto saved = songManager->saveCurrentSong(audioEngine);
+
+    // Everything is on disk: the crash journal is not needed any more
+    audioEngine.getRecordJournal().stop(saved.wasOk());
     savePreferences();
 }
 
+//==============================================================================
+// Startup
+//==============================================================================
+
+void MainComponent::runStartupGraph()
+{
+    // Which session comes back: a crash journal wins over the auto-saved song
+    const bool recover = RecordJournal::hasUnfinishedSession(RecordJournal::getDefaultDirectory());
+    const bool recall  = autoRecallLastSession && !recover;
+
+    Song song;
+    std::unique_ptr<StandbySong> songAudio;
+    bool songLoaded = false;
+    bool audioReady = false;
+
+    StartupGraph graph;
+
+    //--- 1. Independent: device (message thread), files (pool) ---
+    const auto device = graph.addMessageTask("Audio device", [this, &audioReady]
+    {
+        audioReady = initializeAudio();
+        if (const auto cores = audioEngine.setRenderWorkerCores(renderWorkerCores); cores.failed())
+        {
+            DBG(cores.getErrorMessage());   // fewer cores than when it was set: workers not pinned
+            renderWorkerCores = {};
+        }
+        audioEngine.setParallelProcessing(parallelChannelProcessing);
+        DenormalPolicy::setFlushEnabled(flushDenormals);
+        audioEngine.setSectionCompression(packIdleSections);
+        audioEngine.setLockedLoopMemory(static_cast<juce::int64>(lockedLoopMemoryMb) << 20);
+        audioEngine.setRecordStems(recordStems);
+        audioEngine.setOverdubConsolidation(overdubUndoDepth + 4, overdubUndoDepth);
+    });
+
+    const auto plugins = graph.addTask("Plugin list", [this]
+    {
+        audioEngine.getPluginHost().loadDefaultPluginList();
+    });
+
+    graph.addTask("MIDI mappings", [this]
+    {
+        audioEngine.getMidiLearnManager().loadAllMappings();
+    });
+
+    const auto songFile = graph.addTask("Song file", [this, recall, &song, &songLoaded]
+    {
+        if (!recall) return;
+        const auto result = songManager->loadSong(SongManager::getCurrentSongDirectory().getChildFile("song.json"),
+                                                  song);
+        songLoaded = result.wasOk();
+        if (!songLoaded)
+            DBG("Auto-recall: " + result.getErrorMessage()); // silently ignore on first run
+    });
+
+    //--- 2. After the device: MIDI inputs, metrics, interface, loop audio at the device rate ---
+    graph.addMessageTask("MIDI inputs", [this, &audioReady]
+    {
+        if (!audioReady) return;
+        audioEngine.openMidiInputs();
+
+        const auto clock = audioEngine.setMidiClockOutput(midiClockOutput);
+        if (clock.failed())
+            DBG(clock.getErrorMessage());   // port unplugged: stays off until picked again
+    }, { device });
+
+    graph.addMessageTask("Metrics export", [this, &audioReady]
+    {
+        if (!audioReady) return;
+        const auto result = metricsExporter.setTarget(metricsTarget);
+        if (result.failed())
+            DBG(result.getErrorMessage());
+    }, { device });
+
+    const auto ui = graph.addMessageTask("Interface", [this] { createInterface(); }, { device });
+
+    const auto loopAudio = graph.addTask("Song audio", [this, &song, &songLoaded, &songAudio]
+    {
+        auto* first = audioEngine.getChannel(0);
+        if (!songLoaded || first == nullptr) return;
+
+        auto standby = std::make_unique<StandbySong>();
+        const auto result = songManager->prepareStandbySong(song, *standby, audioEngine.getLoopPagePool(),
+                                                            first->getLoopBufferSize(),
+                                                            audioEngine.getSampleRate());
+        if (result.wasOk())
+            songAudio = std::move(standby);
+        else
+            DBG("Auto-recall preload: " + result.getErrorMessage());
+    }, { device, songFile });
+
+    //--- 3. Everything in place: apply the session, then journal it ---
+    const auto session = graph.addMessageTask("Last session", [this, &song, &songLoaded, &songAudio]
+    {
+        if (!songLoaded) return;
+
+        auto result = songAudio != nullptr ? songManager->applyPreloadedSong(song, std::move(songAudio), audioEngine)
+                                           : juce::Result::fail("Not preloaded");
+        if (result.wasOk()) return;
+
+        // Decodes on this thread; a rate conversion runs in the background first
+        songManager->applySongToEngineAsync(song, audioEngine, nullptr, [](juce::Result applied)
+        {
+            if (applied.failed())
+                DBG("Auto-recall: " + applied.getErrorMessage());
+        });
+    }, { plugins, ui, loopAudio });
+
+    graph.addMessageTask("Record journal", [this, recover]
+    {
+        if (recover)
+            offerJournalRecovery();   // starts the journal once answered
+        else
+            startRecordJournal(false);
+    }, { session });
+
+    graph.run([this](const juce::String& text)
+    {
+        if (onSplashStatus) onSplashStatus(text);
+    });
+    DBG("Startup took " + juce::String(graph.getTotalMs(), 0) + " ms");
+}
+
+void MainComponent::createInterface()
+{
+    // --- Transport ---
+    addAndMakeVisible(transportComponent);
+
+    // BUG A FIX: refreshAfterAudioInit() muss nach initializeAudio() aufgerufen werden,
+    // damit metroOutputBox die tatsächliche Kanal-Anzahl kennt.
+    transportComponent.refreshAfterAudioInit();
+    transportComponent.getMasterRecordPath = [this] { return masterRecordPath; };
+
+    // --- Channel strips ---
+    numStrips = juce::jmin(kMaxChannels, audioEngine.getNumChannels());
+    for (int i = 0; i < numStrips; ++i)
+    {
+        channelStrips[i] = std::make_unique<ChannelStripComponent>(audioEngine, i, uiClock);
+        addAndMakeVisible(channelStrips[i].get());
+    }
+
+    // --- Show component ---
+    showComponent = std::make_unique<ShowComponent>(audioEngine,
+                                                    *songManager,
+                                                    *showManager,
+                                                    uiClock);
+    showComponent->setAudioReady(true);
+    showComponent->setDefaultTemplateFunctions(
+        [this]              { return defaultTemplatePath; },
+        [this](const juce::String& p) { defaultTemplatePath = p; savePreferences(); });
+    addAndMakeVisible(showComponent.get());
+}
+
+//==============================================================================
+// Crash Recovery
+//==============================================================================
+
+void MainComponent::restoreSession()
+{
+    // Auto-recall last session if preference is set
+    if (autoRecallLastSession)
+    {
+        if (onSplashStatus) onSplashStatus("Restoring last session...");
+        auto result = songManager->loadCurrentSong(audioEngine);
+        if (!result.wasOk())
+            DBG("Auto-recall: " + result.getErrorMessage()); // silently ignore on first run
+    }
+}
+
+void MainComponent::offerJournalRecovery()
+{
+    juce::AlertWindow::showOkCancelBox(
+        juce::AlertWindow::WarningIcon,
+        "Recover Session",
+        "The last session did not end cleanly.\n\n"
+        "Recover the loops recorded since the last save?",
+        "Recover", "Discard", nullptr,
+        juce::ModalCallbackFunction::create([this](int choice)
+        {
+            if (choice == 0)
+            {
+                restoreSession();
+                startRecordJournal(false);
+                return;
+            }
+
+            const auto result = songManager->recoverFromJournal(audioEngine);
+            if (result.wasOk())
+            {
+                startRecordJournal(true);   // replayed segments stay until the next save
+                return;
+            }
+
+            // Keep the journal for a later attempt, start a fresh one next to it
+            const auto dir = RecordJournal::getDefaultDirectory();
+            const auto kept = dir.getSiblingFile("journal_unrecovered_"
+                                                 + juce::Time::getCurrentTime().formatted("%Y%m%d_%H%M%S"));
+            dir.moveFileTo(kept);
+            startRecordJournal(false);
+
+            juce::AlertWindow::showMessageBoxAsync(
+                juce::AlertWindow::WarningIcon, "Recover Session",
+                result.getErrorMessage() + "\n\nThe journal was kept in:\n" + kept.getFullPathName());
+        }));
+}
+
+void MainComponent::startRecordJournal(bool keepExisting)
+{
+    const auto result = audioEngine.getRecordJournal().start(RecordJournal::getDefaultDirectory(),
+                                                             audioEngine.getSampleRate(),
+                                                             audioEngine.getNumChannels(),
+                                                             keepExisting);
+    if (result.failed())
+        DBG("Record journal not started: " + result.getErrorMessage());
+}
+
 //==============================================================================
 void MainComponent::paint(juce::Graphics& g)
 {
@@ -189,19 +471,12 @@ void MainComponent::paint(juce::Graphics& g)
     // --- Loop progress bar ---
     if (!progressBarArea.isEmpty())
     {
-        auto& le = audioEngine.getLoopEngine();
-        const juce::int64 loopLen = le.getLoopLength();
-
         // Background
         g.setColour(juce::Colour(0xFF1A1A1A));
         g.fillRect(progressBarArea);
 
-        if (loopLen > 0 && audioEngine.isPlaying())
+        if (const int fillW = getProgressFillWidth(); fillW > 0)
         {
-            const juce::int64 pos = le.getCurrentPlayhead();
-            const float fraction = static_cast<float>(pos) / static_cast<float>(loopLen);
-            const int fillW = static_cast<int>(fraction * progressBarArea.getWidth());
-
             g.setColour(juce::Colour(0xFF2288AA));
             g.fillRect(progressBarArea.getX(), progressBarArea.getY(),
                        fillW, progressBarArea.getHeight());
@@ -240,8 +515,9 @@ void MainComponent::resized()
     progressRow.removeFromLeft(transportWidth);  // progress bar spans channel strips only
     progressBarArea = progressRow;
 
-    const int channelWidth = area.getWidth() / 6;  // always divide by 6 for consistent strip width
-    for (int i = 0; i < kMaxChannels; ++i)
+    // At least 6 slots so strips keep their width in small (and free) setups
+    const int channelWidth = area.getWidth() / juce::jmax(6, numStrips);
+    for (int i = 0; i < numStrips; ++i)
         channelStrips[i]->setBounds(area.removeFromLeft(channelWidth).reduced(3));
 
     // In free version, remaining space shows branding logo
@@ -263,17 +539,37 @@ void MainComponent::changeListenerCallback(juce::ChangeBroadcaster* source)
     }
 }
 
+int MainComponent::getProgressFillWidth()
+{
+    const auto& le = audioEngine.getLoopEngine();
+    const juce::int64 loopLen = le.getLoopLength();
+    if (loopLen <= 0 || !audioEngine.isPlaying()) return 0;
+
+    const float fraction = static_cast<float>(le.getCurrentPlayhead()) / static_cast<float>(loopLen);
+    return static_cast<int>(fraction * progressBarArea.getWidth());
+}
+
 void MainComponent::updateInfoLabel()
 {
-    // Called once on device change; timerCallback() keeps it live at 20 Hz.
-    timerCallback();
+    // Called once on device change; uiRefresh() keeps it live at 20 Hz.
+    uiRefresh();
 }
 
-void MainComponent::timerCallback()
+void MainComponent::uiRefresh()
 {
-    // Repaint the progress bar area each tick (20 Hz)
+    // Repaint the progress bar only when its fill moved by a pixel
     if (!progressBarArea.isEmpty())
-        repaint(progressBarArea);
+    {
+        const int fillW = getProgressFillWidth();
+        if (fillW != lastProgressFillW)
+        {
+            lastProgressFillW = fillW;
+            repaint(progressBarArea);
+        }
+    }
+
+    // Bypassed or crashed slots change a chain's latency without a plugin report
+    audioEngine.updateDelayCompensation();
 
     auto& le = audioEngine.getLoopEngine();
     const bool   metroActive = audioEngine.getMetronome().getEnabled();
@@ -315,16 +611,118 @@ void MainComponent::timerCallback()
                     + " ch" + juce::String(m.getChannel());
     }
 
+    // Realtime profiler: whole-callback p99/worst vs. budget, slowest stage, xrun culprit
+    const auto& prof    = audioEngine.getProfiler();
+    const auto  total   = prof.getStats(RealtimeProfiler::Total);
+    juce::String dspStr = juce::String(total.p99Us / 1000.0, 2) + "/" +
+                          juce::String(total.worstUs / 1000.0, 2) + " of " +
+                          juce::String(prof.getBudgetUs() / 1000.0, 2) + " ms";
+
+    const int worstStage = prof.getWorstStage();
+    if (worstStage >= 0)
+        dspStr += " (" + RealtimeProfiler::getStageName(worstStage) + " " +
+                  juce::String(prof.getStats(worstStage).worstUs / 1000.0, 2) + " ms)";
+
+    juce::String xrunStr = juce::String(audioEngine.getXrunCount());
+    {
+        int culprit = -1, most = 0;
+        for (int st = 0; st < RealtimeProfiler::kNumStages; ++st)
+        {
+            const int n = prof.getStats(st).xruns;
+            if (n > most) { most = n; culprit = st; }
+        }
+        if (culprit >= 0)
+            xrunStr += " (" + RealtimeProfiler::getStageName(culprit) + ")";
+    }
+
+    // Non-zero only if loop playback produced denormals (flushing off, or a plugin upstream)
+    juce::String denormalStr;
+    if (const auto denormals = DenormalPolicy::getLoopDenormalCount(); denormals > 0)
+        denormalStr = "  |  Denormals: " + juce::String(static_cast<juce::int64>(denormals));
+
+    // Diagnostic builds only: audio-thread allocations, locks and blocking calls.
+    // New log entries go to the debug output with their stacks.
+    juce::String rtSafetyStr;
+    if constexpr (RealtimeSafety::isEnabled())
+    {
+        rtSafetyStr = "  |  RT violations: " + juce::String(RealtimeSafety::getNumViolations());
+        if (const int logged = RealtimeSafety::getNumLogged(); logged > reportedRtViolations)
+        {
+            DBG(RealtimeSafety::getReport(reportedRtViolations, logged - reportedRtViolations));
+            reportedRtViolations = logged;
+        }
+    }
+
+    // Idle sections held compressed (shown once anything is packed)
+    juce::String packedStr;
+    if (const auto packed = audioEngine.getPackedLoopBytes(); packed > 0)
+        packedStr = "  |  Packed: " + juce::String(packed / (1024 * 1024)) + " MB";
+
+    // Active sections not fully in RAM would fault on read; locking refused = OS limit too low
+    juce::String residentStr;
+    if (const auto active = audioEngine.getActiveLoopBytes(); active > 0)
+    {
+        const auto resident = audioEngine.getActiveResidentBytes();
+        residentStr = "  |  RAM: " + juce::String(juce::jmin<juce::int64>(100, resident * 100 / active)) + "% resident, "
+                    + juce::String(audioEngine.getLockedLoopBytes() / (1024 * 1024)) + " MB locked";
+        if (audioEngine.isLoopLockRefused())
+            residentStr += " (limit)";
+    }
+
+    // Stem recording: dropouts mean the disk fell behind (gaps are filled with silence)
+    juce::String stemStr;
+    if (const auto& stems = audioEngine.getStemRecorder(); stems.isRecording())
+    {
+        stemStr = "  |  Stems: " + juce::String(juce::roundToInt(stems.getMaxFill() * 100.0f)) + "% buffer";
+        if (const int drops = stems.getNumDropouts(); drops > 0)
+            stemStr += ", " + juce::String(drops) + " dropouts";
+    }
+
+    // A refused record (section buffers not sized yet, or no free overdub layer): shown for a while
+    juce::String refusedStr;
+    {
+        constexpr juce::uint32 kRefusedNoticeMs = 4000;
+        const auto now = juce::Time::getMillisecondCounter();
+        if (const auto refused = audioEngine.getNumRefusedRecords(); refused != shownRefusedRecords)
+        {
+            shownRefusedRecords  = refused;
+            refusedNoticeUntilMs = now + kRefusedNoticeMs;
+        }
+        if (now < refusedNoticeUntilMs)
+            refusedStr = "  |  Record refused on Ch" + juce::String(audioEngine.getLastRefusedRecordChannel() + 1)
+                       + (audioEngine.getLastRecordRefusal() == ChannelHotState::Refusal::LayersFull
+                              ? ": all " + juce::String(MAX_OVERDUB_LAYERS) + " overdub layers in use, merging the oldest"
+                              : juce::String(": section memory not ready, try again"));
+    }
+
+    // Crash journal: only worth a mention when it is off or lost blocks
+    juce::String journalStr;
+    if (const auto& journal = audioEngine.getRecordJournal(); !journal.isRunning())
+        journalStr = "  |  Journal: off";
+    else if (const int drops = journal.getNumDropouts(); drops > 0)
+        journalStr = "  |  Journal: " + juce::String(drops) + " dropouts";
+
+    // Engine latency: one buffer plus the plugin delay compensation
+    const int pdc = audioEngine.getCompensationLatency();
+    juce::String latencyStr = "Latency: "
+        + juce::String((audioEngine.getBufferSize() + pdc) / juce::jmax(1.0, audioEngine.getSampleRate()) * 1000.0, 1)
+        + " ms";
+    if (pdc > 0)
+        latencyStr += " (PDC " + juce::String(pdc) + ")";
+
     infoLabel.setText(
         "Audio: " + juce::String(audioEngine.getSampleRate(), 0) + " Hz  |  " +
         juce::String(audioEngine.getBufferSize()) + " samples  |  " +
+        latencyStr + "  |  " +
         juce::String(audioEngine.getNumInputChannels()) + " in / " +
         juce::String(audioEngine.getNumOutputChannels()) + " out  |  " +
         "Mode: " + juce::String(metroActive ? "Metronome" : "Free") + "  |  " +
         "Loop: " + loopStr + "  |  " +
         "Pos: " + juce::String(le.getPlayheadSeconds(), 2) + "s  |  " +
         "CPU: " + juce::String(cpu, 1).paddedLeft(' ', 5) + "%  |  " +
-        "MIDI: " + midiStr,
+        "DSP p99/max: " + dspStr + "  |  " +
+        "Xruns: " + xrunStr + "  |  " +
+        "MIDI: " + midiStr + refusedStr + rtSafetyStr + denormalStr + packedStr + residentStr + stemStr + journalStr,
         juce::dontSendNotification);
 }
 
@@ -364,8 +762,8 @@ bool MainComponent::keyPressed(const juce::KeyPress& key, juce::Component*)
         return true;
     }
 
-    // 1-N — set active channel and trigger it
-    if (code >= '1' && code <= ('0' + kMaxChannels))
+    // 1-N — set active channel and trigger it (digit keys reach channel 9)
+    if (code >= '1' && code <= ('0' + juce::jmin(9, numStrips)))
     {
         const int ch = code - '1';
         audioEngine.setActiveChannel(ch);
@@ -527,6 +925,26 @@ void MainComponent::loadPreferences()
         autoRecallLastSession = (bool)obj->getProperty("auto_recall_last_session");
         defaultTemplatePath   = obj->getProperty("default_template_path").toString();
         masterRecordPath      = obj->getProperty("master_record_path").toString();
+        parallelChannelProcessing = (bool)obj->getProperty("parallel_channel_processing");
+        renderWorkerCores = obj->getProperty("render_worker_cores").toString();
+        if (obj->hasProperty("overdub_undo_depth"))
+            overdubUndoDepth = juce::jlimit(1, 24, (int)obj->getProperty("overdub_undo_depth"));
+        if (obj->hasProperty("flush_denormals"))
+            flushDenormals = (bool)obj->getProperty("flush_denormals");
+        if (obj->hasProperty("pack_idle_sections"))
+            packIdleSections = (bool)obj->getProperty("pack_idle_sections");
+        if (obj->hasProperty("locked_loop_memory_mb"))
+            lockedLoopMemoryMb = juce::jlimit(0, 65536, (int)obj->getProperty("locked_loop_memory_mb"));
+        if (obj->hasProperty("record_stems"))
+            recordStems = (bool)obj->getProperty("record_stems");
+        if (obj->hasProperty("num_channels"))
+            numChannels = juce::jlimit(1, MAX_CHANNELS, (int)obj->getProperty("num_channels"));
+        if (obj->hasProperty("record_latency_override"))
+            recordLatencyOverride = juce::jlimit(-1, 1 << 16, (int)obj->getProperty("record_latency_override"));
+        midiClockOutput = obj->getProperty("midi_clock_output").toString();
+        metricsTarget   = obj->getProperty("metrics_target").toString();
+        if (obj->hasProperty("resample_quality"))
+            resampleQuality = juce::jlimit(0, 2, (int)obj->getProperty("resample_quality"));
     }
 }
 
@@ -536,6 +954,18 @@ void MainComponent::savePreferences()
     obj->setProperty("auto_recall_last_session", autoRecallLastSession);
     obj->setProperty("default_template_path",    defaultTemplatePath);
     obj->setProperty("master_record_path",       masterRecordPath);
+    obj->setProperty("parallel_channel_processing", parallelChannelProcessing);
+    obj->setProperty("render_worker_cores",         renderWorkerCores);
+    obj->setProperty("overdub_undo_depth",          overdubUndoDepth);
+    obj->setProperty("flush_denormals",             flushDenormals);
+    obj->setProperty("pack_idle_sections",          packIdleSections);
+    obj->setProperty("locked_loop_memory_mb",       lockedLoopMemoryMb);
+    obj->setProperty("record_stems",                recordStems);
+    obj->setProperty("num_channels",                numChannels);
+    obj->setProperty("record_latency_override",     recordLatencyOverride);
+    obj->setProperty("midi_clock_output",           midiClockOutput);
+    obj->setProperty("metrics_target",              metricsTarget);
+    obj->setProperty("resample_quality",            resampleQuality);
 
     const auto file = getPreferencesFile();
     file.getParentDirectory().createDirectory();
@@ -565,7 +995,7 @@ void MainComponent::showShortcutsDialog()
     const juce::String text =
         "Space          Global Play / Stop\n"
         "R              Trigger active channel (record -> stop -> play -> stop ...)\n"
-        "1 - 6          Select + trigger channel N\n"
+        "1 - " + juce::String(juce::jmin(9, numStrips)) + "          Select + trigger channel N\n"
         "O              Toggle Overdub Mode\n"
         "L              Toggle Latch Mode\n"
         "M              Toggle Mute on active channel\n"
@@ -650,7 +1080,7 @@ void MainComponent::showAboutDialog()
 }
 
 //==============================================================================
-void MainComponent::initializeAudio()
+bool MainComponent::initializeAudio()
 {
     const juce::String error = audioEngine.initialiseAudio(32, 32, 44100.0, 512);
 
@@ -661,7 +1091,7 @@ void MainComponent::initializeAudio()
             "Audio Error",
             "Failed to initialize audio: " + error);
         infoLabel.setText("Audio Error: " + error, juce::dontSendNotification);
-        return;
+        return false;
     }
 
     // --- Global loop settings ---
@@ -673,4 +1103,5 @@ void MainComponent::initializeAudio()
     // Transport starts stopped; user must press Play or hit Record on a channel.
 
     updateInfoLabel();
+    return true;
 }
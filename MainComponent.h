@@ -2,12 +2,14 @@
 
 #include <JuceHeader.h>
 #include "AudioEngine.h"
+#include "MetricsExporter.h"
 #include "ChannelStripComponent.h"
 #include "TransportComponent.h"
 #include "ShowComponent.h"
 #include "SongManager.h"
 #include "ShowManager.h"
 #include "PreferencesComponent.h"
+#include "UiRefreshClock.h"
 
 /**
  * @file MainComponent.h
@@ -21,7 +23,7 @@
 class MainComponent : public juce::Component,
                       public juce::ChangeListener,
                       public juce::KeyListener,
-                      private juce::Timer
+                      private UiRefreshClock::Client
 {
 public:
     MainComponent(std::function<void(const juce::String&)> splashCallback = nullptr);
@@ -38,14 +40,17 @@ public:
 private:
     //==========================================================================
     AudioEngine audioEngine;
+    MetricsExporter metricsExporter {audioEngine};   // stops before the engine goes
 
     std::unique_ptr<SongManager> songManager;
     std::unique_ptr<ShowManager> showManager;
 
     //==========================================================================
-    // GUI
+    // GUI — the clock is declared first so it outlives every client
+    UiRefreshClock     uiClock {*this};
     TransportComponent transportComponent;
-    std::array<std::unique_ptr<ChannelStripComponent>, 6> channelStrips;
+    std::array<std::unique_ptr<ChannelStripComponent>, MAX_CHANNELS> channelStrips;
+    int numStrips {0};                    // channels shown (engine count, capped in the free version)
     std::unique_ptr<ShowComponent> showComponent;
 
     juce::Label      infoLabel;
@@ -60,9 +65,14 @@ private:
     juce::TooltipWindow tooltipWindow {this, 600};  // 600 ms hover delay
 
     //==========================================================================
-    void initializeAudio();
+    bool initializeAudio();                // false: no device (alert shown)
     void updateInfoLabel();
-    void timerCallback() override;
+    void uiRefresh() override;
+    int  reportedRtViolations {0};     // RealtimeSafety log entries already printed
+    juce::uint32 shownRefusedRecords {0};   // AudioEngine::getNumRefusedRecords() last noticed
+    juce::uint32 refusedNoticeUntilMs {0};  // the status bar names the refused record until then
+    int  lastProgressFillW {-1};
+    int  getProgressFillWidth();
 
     void changeListenerCallback(juce::ChangeBroadcaster* source) override;
 
@@ -75,10 +85,31 @@ private:
     bool autoRecallLastSession {false};
     juce::String defaultTemplatePath;
     juce::String masterRecordPath;
+    bool parallelChannelProcessing {false};
+    juce::String renderWorkerCores;       // cores for the render workers, e.g. "2-5"; empty = not pinned
+    bool flushDenormals {true};
+    bool packIdleSections {true};
+    int  lockedLoopMemoryMb {1024};   // 0 = no page locking
+    bool recordStems {false};         // stems alongside the master recording
+    int  overdubUndoDepth {8};
+    int  numChannels {DEFAULT_CHANNELS};  // applied at startup (AudioEngine::setNumChannels())
+    int  recordLatencyOverride {-1};      // samples, -1 = driver-reported round trip
+    juce::String midiClockOutput;         // MidiOutput identifier, empty = no clock out
+    juce::String metricsTarget;           // OSC collector "host:port", empty = no export
+    int  resampleQuality {1};             // PolyphaseResampler::Quality of song conversions (1 = normal)
     void loadPreferences();
     void savePreferences();
     juce::File getPreferencesFile() const;
 
+    // Startup (see StartupGraph): device, files and session in parallel
+    void runStartupGraph();
+    void createInterface();               // transport, channel strips, show view
+
+    // Crash recovery (record journal, see RecordJournal)
+    void restoreSession();
+    void offerJournalRecovery();
+    void startRecordJournal(bool keepExisting);
+
     // Help dialogs
     void showHelpMenu();
     void showShortcutsDialog();
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <cmath>
+
+//==============================================================================
+/**
+ * @file MeterTelemetry.h
+ * @brief Per-block level summaries from the audio thread to the GUI
+ *
+ * The peak atomics on Channel only hold the last block, so a GUI polling at
+ * 10–60 Hz misses every transient in between.  Instead the audio thread
+ * pushes one small MeterFrame per block into a single-producer /
+ * single-consumer ring, and the channel strip drains all frames that have
+ * arrived since its last refresh: the loudest peak, the RMS over the whole
+ * interval and any clip are all seen, whatever the GUI rate.
+ *
+ * Cost on the audio thread: the RMS sums plus one frame copy per block.
+ * When the GUI stops draining (window hidden) the ring fills up and new
+ * frames are dropped — the next drain simply starts from the oldest kept.
+ *
+ * Thread-safety:
+ *   Audio thread  : push()            (one producer — the channel's render)
+ *   Message thread: drain(), reset()  (one consumer — the channel strip)
+ */
+struct MeterFrame
+{
+    enum Flags : juce::uint32
+    {
+        InputClip = 1u << 0,   // |input| >= 1.0 somewhere in the block
+        LoopClip  = 1u << 1,   // |loop playback| >= 1.0 somewhere in the block
+        LoopLive  = 1u << 2    // loop playback ran this block
+    };
+
+    float inputPeak[2] {};
+    float inputSumSq[2] {};    // sum of squares — RMS over any number of frames
+    float loopPeak [2] {};
+    float loopSumSq[2] {};
+    juce::int64  playhead   {0};
+    juce::uint32 numSamples {0};
+    juce::uint32 flags      {0};
+
+    /** Sum of squares of one channel (for inputSumSq / loopSumSq). */
+    static float sumOfSquares(const float* data, int num) noexcept
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < num; ++i)
+            sum += data[i] * data[i];
+        return sum;
+    }
+};
+
+//==============================================================================
+/**
+ * @brief What the GUI sees after draining: everything since the last drain.
+ */
+struct MeterSummary
+{
+    float inputPeak {0.0f}, inputRms {0.0f};
+    float loopPeak  {0.0f}, loopRms  {0.0f};
+    bool  inputClipped {false};
+    bool  loopClipped  {false};
+    juce::int64 playhead {-1};   // of the newest frame, -1 if none arrived
+    int   numFrames {0};
+};
+
+//==============================================================================
+class MeterTelemetry
+{
+public:
+    static constexpr int kCapacity = 1024;   // ~0.7 s at 32-sample blocks / 48 kHz
+
+    MeterTelemetry() : fifo(kCapacity) {}
+
+    /** Audio thread. false (frame dropped) if the GUI has fallen behind. */
+    bool push(const MeterFrame& frame) noexcept
+    {
+        int s1, n1, s2, n2;
+        fifo.prepareToWrite(1, s1, n1, s2, n2);
+        if (n1 <= 0) return false;
+        frames[static_cast<size_t>(s1)] = frame;
+        fifo.finishedWrite(1);
+        return true;
+    }
+
+    /** Message thread: fold every pending frame into one summary. */
+    MeterSummary drain() noexcept
+    {
+        MeterSummary out;
+        const int n = fifo.getNumReady();
+        if (n == 0) return out;
+
+        double inSq = 0.0, loopSq = 0.0;
+        double inCount = 0.0, loopCount = 0.0;
+
+        auto fold = [&](const MeterFrame& f)
+        {
+            const double len = static_cast<double>(f.numSamples);
+            out.inputPeak = juce::jmax(out.inputPeak, f.inputPeak[0], f.inputPeak[1]);
+            inSq    += f.inputSumSq[0] + f.inputSumSq[1];
+            inCount += 2.0 * len;
+
+            if ((f.flags & MeterFrame::LoopLive) != 0)
+            {
+                out.loopPeak = juce::jmax(out.loopPeak, f.loopPeak[0], f.loopPeak[1]);
+                loopSq    += f.loopSumSq[0] + f.loopSumSq[1];
+                loopCount += 2.0 * len;
+            }
+
+            out.inputClipped |= (f.flags & MeterFrame::InputClip) != 0;
+            out.loopClipped  |= (f.flags & MeterFrame::LoopClip)  != 0;
+            out.playhead = f.playhead;
+        };
+
+        int s1, n1, s2, n2;
+        fifo.prepareToRead(n, s1, n1, s2, n2);
+        for (int i = 0; i < n1; ++i) fold(frames[static_cast<size_t>(s1 + i)]);
+        for (int i = 0; i < n2; ++i) fold(frames[static_cast<size_t>(s2 + i)]);
+        fifo.finishedRead(n1 + n2);
+
+        out.numFrames = n1 + n2;
+        out.inputRms  = inCount   > 0.0 ? static_cast<float>(std::sqrt(inSq   / inCount))   : 0.0f;
+        out.loopRms   = loopCount > 0.0 ? static_cast<float>(std::sqrt(loopSq / loopCount)) : 0.0f;
+        return out;
+    }
+
+    /** Message thread: discard pending frames. */
+    void reset() noexcept
+    {
+        fifo.finishedRead(fifo.getNumReady());
+    }
+
+private:
+    juce::AbstractFifo fifo;
+    std::array<MeterFrame, kCapacity> frames;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MeterTelemetry)
+};
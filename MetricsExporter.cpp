@@ -0,0 +1,293 @@
+#include "MetricsExporter.h"
+#include "AudioEngine.h"
+#include <array>
+#include <cstring>
+
+namespace
+{
+    //==========================================================================
+    /** One OSC message in a fixed buffer: big-endian arguments, 4-byte aligned. */
+    class OscMessage
+    {
+    public:
+        OscMessage(const juce::String& address, const char* types)
+        {
+            putString(address.toRawUTF8());
+            putChar(',');
+            putString(types);
+        }
+
+        OscMessage& i(int v)         { putBigEndian(static_cast<juce::uint32>(v)); return *this; }
+        OscMessage& h(juce::int64 v) { putBigEndian(static_cast<juce::uint64>(v)); return *this; }
+        OscMessage& f(double v)
+        {
+            const auto x = static_cast<float>(v);
+            juce::uint32 bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            putBigEndian(bits);
+            return *this;
+        }
+        OscMessage& s(const char* v) { putString(v); return *this; }
+
+        const char* getData() const noexcept { return data.data(); }
+        int         getSize() const noexcept { return size; }
+
+    private:
+        static constexpr int kCapacity = 256;
+
+        void putChar(char c) noexcept
+        {
+            if (size >= kCapacity) { jassertfalse; return; }   // address or arguments too long
+            data[static_cast<size_t>(size++)] = c;
+        }
+
+        /** String plus terminator, zero-padded until the message is 4-byte aligned again. */
+        void putString(const char* text) noexcept
+        {
+            while (*text != 0) putChar(*text++);
+            do putChar(0); while ((size & 3) != 0);
+        }
+
+        template <typename T>
+        void putBigEndian(T v) noexcept
+        {
+            for (int shift = static_cast<int>(sizeof(T) * 8) - 8; shift >= 0; shift -= 8)
+                putChar(static_cast<char>((v >> shift) & 0xff));
+        }
+
+        std::array<char, kCapacity> data {};
+        int size {0};
+    };
+
+    //==========================================================================
+    /** Collects messages into "#bundle" datagrams of at most kMaxPacketBytes. */
+    class BundleWriter
+    {
+    public:
+        BundleWriter(juce::DatagramSocket& s, const juce::String& h, int p)
+            : socket(s), host(h), port(p) {}
+
+        /** Start a pass: every bundle of it carries this time tag (NTP, 1900 epoch). */
+        void begin(juce::int64 unixMs) noexcept
+        {
+            const auto seconds  = static_cast<juce::uint64>(unixMs / 1000) + 2208988800ull;
+            const auto fraction = (static_cast<juce::uint64>(unixMs % 1000) << 32) / 1000;
+            timeTag = (seconds << 32) | fraction;
+            size = 0;
+        }
+
+        void add(const OscMessage& m)
+        {
+            if (size > 0 && size + 4 + m.getSize() > MetricsExporter::kMaxPacketBytes)
+                flush();
+
+            if (size == 0)
+            {
+                std::memcpy(packet.data(), "#bundle", 8);
+                size = 8;
+                put(static_cast<juce::uint32>(timeTag >> 32));
+                put(static_cast<juce::uint32>(timeTag));
+            }
+
+            put(static_cast<juce::uint32>(m.getSize()));
+            std::memcpy(packet.data() + size, m.getData(), static_cast<size_t>(m.getSize()));
+            size += m.getSize();
+        }
+
+        /** Send what is pending. Never waits for the socket: not ready = dropped. */
+        void flush()
+        {
+            if (size == 0) return;
+
+            if (socket.waitUntilReady(false, 0) == 1 && socket.write(host, port, packet.data(), size) == size)
+                ++sent;
+            else
+                ++dropped;
+            size = 0;
+        }
+
+        int sent {0}, dropped {0};
+
+    private:
+        void put(juce::uint32 v) noexcept
+        {
+            for (int shift = 24; shift >= 0; shift -= 8)
+                packet[static_cast<size_t>(size++)] = static_cast<char>((v >> shift) & 0xff);
+        }
+
+        juce::DatagramSocket& socket;
+        const juce::String&   host;
+        const int             port;
+        juce::uint64          timeTag {1};
+        std::array<char, MetricsExporter::kMaxPacketBytes> packet {};
+        int size {0};
+    };
+
+    const char* getStateName(ChannelState state) noexcept
+    {
+        switch (state)
+        {
+            case ChannelState::Recording:   return "recording";
+            case ChannelState::Playing:     return "playing";
+            case ChannelState::Overdubbing: return "overdubbing";
+            case ChannelState::Idle:        break;
+        }
+        return "idle";
+    }
+
+    /** "Master Rec" -> "master_rec", for an OSC address part. */
+    juce::String toAddressPart(const juce::String& name)
+    {
+        return name.toLowerCase().replaceCharacter(' ', '_');
+    }
+
+    //==========================================================================
+    void writeMetrics(AudioEngine& engine, BundleWriter& out)
+    {
+        //--- 1. ENGINE ---
+        out.add(OscMessage("/chief/engine/samples",     "h").h(engine.getSampleClock()));
+        out.add(OscMessage("/chief/engine/xruns",       "i").i(engine.getXrunCount()));
+        out.add(OscMessage("/chief/engine/cpu_percent", "f").f(engine.getCPUUsage()));
+
+        //--- 2. CALLBACK TIMING (completed profiler slots, last ~2 s) ---
+        const auto& profiler = engine.getProfiler();
+        const auto total = profiler.getStats(RealtimeProfiler::Total);
+        out.add(OscMessage("/chief/callback/blocks",    "h").h(total.count));
+        out.add(OscMessage("/chief/callback/budget_us", "f").f(profiler.getBudgetUs()));
+        out.add(OscMessage("/chief/callback/mean_us",   "f").f(total.meanUs));
+        out.add(OscMessage("/chief/callback/p50_us",    "f").f(total.p50Us));
+        out.add(OscMessage("/chief/callback/p99_us",    "f").f(total.p99Us));
+        out.add(OscMessage("/chief/callback/worst_us",  "f").f(total.worstUs));
+
+        for (int stage = 0; stage < RealtimeProfiler::Total; ++stage)
+        {
+            const auto st = profiler.getStats(stage);
+            out.add(OscMessage("/chief/stage/" + toAddressPart(RealtimeProfiler::getStageName(stage)), "ff")
+                        .f(st.p99Us).f(st.worstUs));
+        }
+
+        //--- 3. COMMAND QUEUE ---
+        out.add(OscMessage("/chief/commands/pending", "i").i(engine.getNumPendingCommands()));
+        out.add(OscMessage("/chief/commands/dropped", "i").i(engine.getDroppedCommands()));
+
+        //--- 4. CHANNELS (as the engine last published them, never a live Channel) ---
+        juce::int64 packedBytes = 0;
+        for (int ch = 0; ch < MAX_CHANNELS; ++ch)
+        {
+            const auto m = engine.getChannelMetrics(ch);
+            if (!m.present) continue;
+
+            const juce::String base = "/chief/channel/" + juce::String(ch + 1);
+            out.add(OscMessage(base + "/state",        "s").s(getStateName(m.state)));
+            out.add(OscMessage(base + "/section",      "i").i(m.section + 1));
+            out.add(OscMessage(base + "/layers",       "i").i(m.layers));
+            out.add(OscMessage(base + "/packed_bytes", "h").h(m.packedBytes));
+            packedBytes += m.packedBytes;
+
+            for (size_t s = 0; s < NUM_SECTIONS; ++s)
+                out.add(OscMessage(base + "/section/" + juce::String(static_cast<int>(s) + 1) + "/bytes", "hh")
+                            .h(m.baseBytes[s]).h(m.layerBytes[s]));
+        }
+
+        //--- 5. LOOP MEMORY ---
+        out.add(OscMessage("/chief/memory/allocated_bytes", "h").h(engine.getLoopMemoryBytes()));
+        out.add(OscMessage("/chief/memory/locked_bytes",    "h").h(engine.getLockedLoopBytes()));
+        out.add(OscMessage("/chief/memory/packed_bytes",    "h").h(packedBytes));
+        out.add(OscMessage("/chief/memory/active_bytes",    "h").h(engine.getActiveLoopBytes()));
+        out.add(OscMessage("/chief/memory/resident_bytes",  "h").h(engine.getActiveResidentBytes()));
+        out.add(OscMessage("/chief/memory/page_underruns",  "i").i(engine.getLoopPageUnderruns()));
+
+        //--- 6. DISK WRITERS: how far each ring is behind ---
+        const auto& stems = engine.getStemRecorder();
+        out.add(OscMessage("/chief/disk/stems/recording", "i").i(stems.isRecording() ? 1 : 0));
+        out.add(OscMessage("/chief/disk/stems/fill",      "f").f(stems.getFill()));
+        out.add(OscMessage("/chief/disk/stems/max_fill",  "f").f(stems.getMaxFill()));
+        out.add(OscMessage("/chief/disk/stems/dropouts",  "i").i(stems.getNumDropouts()));
+
+        const auto& journal = engine.getRecordJournal();
+        out.add(OscMessage("/chief/disk/journal/running",       "i").i(journal.isRunning() ? 1 : 0));
+        out.add(OscMessage("/chief/disk/journal/fill",          "f").f(journal.getFill()));
+        out.add(OscMessage("/chief/disk/journal/dropouts",      "i").i(journal.getNumDropouts()));
+        out.add(OscMessage("/chief/disk/journal/bytes_written", "h").h(journal.getBytesWritten()));
+    }
+}
+
+//==============================================================================
+MetricsExporter::MetricsExporter(AudioEngine& e)
+    : juce::Thread("Metrics Export"), engine(e)
+{
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    enabled.store(false, std::memory_order_release);
+    stopThread(5000);
+}
+
+//==============================================================================
+// Message thread
+//==============================================================================
+
+juce::Result MetricsExporter::setTarget(const juce::String& hostAndPort, int intervalMs)
+{
+    const auto trimmed     = hostAndPort.trim();
+    const int  newInterval = juce::jmax(kMinIntervalMs, intervalMs);
+    if (trimmed == target && newInterval == interval)
+        return juce::Result::ok();
+
+    // A malformed target leaves the running export alone
+    const auto newHost  = trimmed.upToLastOccurrenceOf(":", false, false).trim();
+    const auto portText = trimmed.fromLastOccurrenceOf(":", false, false).trim();
+    const int  newPort  = portText.getIntValue();
+    if (trimmed.isNotEmpty()
+        && (!trimmed.contains(":") || newHost.isEmpty() || portText.isEmpty()
+            || !portText.containsOnly("0123456789") || newPort < 1 || newPort > 65535))
+        return juce::Result::fail("Metrics target must be host:port, e.g. 192.168.1.20:9000 (got \""
+                                  + trimmed + "\")");
+
+    enabled.store(false, std::memory_order_release);
+    stopThread(5000);   // long enough for a name lookup in progress to time out
+
+    target   = trimmed;
+    host     = newHost;
+    port     = newPort;
+    interval = newInterval;
+    packetsSent.store(0, std::memory_order_relaxed);
+    packetsDropped.store(0, std::memory_order_relaxed);
+
+    if (target.isEmpty())
+    {
+        DBG("Metrics export: off");
+        return juce::Result::ok();
+    }
+
+    startThread(juce::Thread::Priority::low);
+    enabled.store(true, std::memory_order_release);
+    DBG("Metrics export: " + target + " every " + juce::String(interval) + " ms");
+    return juce::Result::ok();
+}
+
+//==============================================================================
+// Export thread
+//==============================================================================
+
+void MetricsExporter::run()
+{
+    juce::DatagramSocket socket;   // unbound: sends only, from an ephemeral port
+    BundleWriter out(socket, host, port);
+
+    while (!threadShouldExit())
+    {
+        const auto started = juce::Time::getMillisecondCounter();
+
+        out.begin(juce::Time::currentTimeMillis());
+        writeMetrics(engine, out);
+        out.flush();
+
+        packetsSent   .store(out.sent,    std::memory_order_relaxed);
+        packetsDropped.store(out.dropped, std::memory_order_relaxed);
+
+        const auto elapsed = static_cast<int>(juce::Time::getMillisecondCounter() - started);
+        wait(juce::jmax(1, interval - elapsed));
+    }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+class AudioEngine;
+
+//==============================================================================
+/**
+ * @file MetricsExporter.h
+ * @brief Engine counters to a remote collector, as OSC bundles over UDP
+ *
+ * A low-priority "Metrics Export" thread wakes every interval, reads the
+ * engine's counters and sends them as OSC 1.0 bundles (time tag = time of
+ * reading) to host:port.  Messages are packed into as few datagrams as fit
+ * kMaxPacketBytes.  A datagram the socket cannot take right away is dropped
+ * and counted, the next interval sends fresh values anyway.
+ *
+ * The audio thread is never involved: everything read is an atomic the
+ * engine already keeps or the profiler's completed ring slots.  Channel
+ * figures come from AudioEngine::getChannelMetrics(), which the background
+ * thread publishes once a second — never from a Channel, which a type change
+ * or device restart may free or resize meanwhile.
+ *
+ * Addresses (channels and sections from 1):
+ *   /chief/engine/samples h, /xruns i, /cpu_percent f
+ *   /chief/callback/blocks h, /budget_us /mean_us /p50_us /p99_us /worst_us f
+ *   /chief/stage/<name> ff            p99 and worst µs of each global stage
+ *   /chief/commands/pending i, /dropped i
+ *   /chief/channel/N/state s          idle, recording, playing, overdubbing
+ *   /chief/channel/N/section i, /layers i, /packed_bytes h
+ *   /chief/channel/N/section/S/bytes hh   base take and overdub layers
+ *   /chief/memory/allocated_bytes /locked_bytes /packed_bytes /active_bytes /resident_bytes h
+ *   /chief/memory/page_underruns i
+ *   /chief/disk/stems/recording i, /fill f, /max_fill f, /dropouts i
+ *   /chief/disk/journal/running i, /fill f, /dropouts i, /bytes_written h
+ *
+ * Thread-safety:
+ *   Message thread: setTarget(), getTarget()
+ *   Any thread    : isEnabled(), getNumPacketsSent(), getNumPacketsDropped()
+ */
+class MetricsExporter : private juce::Thread
+{
+public:
+    static constexpr int kDefaultIntervalMs = 1000;
+    static constexpr int kMinIntervalMs     = 50;
+    static constexpr int kMaxPacketBytes    = 1400;   // below a 1500 byte MTU: no IP fragments
+
+    explicit MetricsExporter(AudioEngine& engine);
+    ~MetricsExporter() override;
+
+    /**
+     * @brief Send to "host:port" every intervalMs from now on (empty = off).
+     *
+     * Only the format is checked here; the host is resolved by the export
+     * thread, so a slow name lookup never stalls the caller.  Message thread.
+     */
+    juce::Result setTarget(const juce::String& hostAndPort, int intervalMs = kDefaultIntervalMs);
+    juce::String getTarget() const { return target; }
+
+    bool isEnabled()            const noexcept { return enabled.load(std::memory_order_acquire); }
+    int  getNumPacketsSent()    const noexcept { return packetsSent.load(std::memory_order_relaxed); }
+    int  getNumPacketsDropped() const noexcept { return packetsDropped.load(std::memory_order_relaxed); }
+
+private:
+    void run() override;
+
+    AudioEngine& engine;
+
+    juce::String target;                  // message thread
+    juce::String host;                    // set while the thread is stopped
+    int          port {0};
+    int          interval {kDefaultIntervalMs};
+
+    std::atomic<bool> enabled        {false};
+    std::atomic<int>  packetsSent    {0};
+    std::atomic<int>  packetsDropped {0};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MetricsExporter)
+};
@@ -1,29 +1,41 @@
 #include "Metronome.h"
+#include "DenormalPolicy.h"
+#include "PolyphaseResampler.h"
+#include <cmath>
 
 //==============================================================================
 Metronome::Metronome()
 {
-    recalculate();
+    rebuildClicks();
+}
+
+Metronome::~Metronome()
+{
+    delete pendingClicks.exchange(nullptr, std::memory_order_acq_rel);
+    delete retiredClicks.exchange(nullptr, std::memory_order_acq_rel);
+    delete clicks;
 }
 
 //==============================================================================
-void Metronome::prepareToPlay(double newSampleRate)
+void Metronome::prepareToPlay(double newSampleRate, int maxBlockSize)
 {
     jassert(newSampleRate > 0.0);
     sampleRate.store(newSampleRate, std::memory_order_release);
+    gainSmoother.prepare(newSampleRate, maxBlockSize, 0.020, SmoothedGain::Curve::Exponential);
+    gainSmoother.reset(masterGain.load(std::memory_order_relaxed));
+    rampScratch.assign(static_cast<size_t>(juce::jmax(1, maxBlockSize)), 0.0f);
     reset();
-    recalculate();
+    rebuildClicks();
 
-    DBG("Metronome prepared: " + juce::String(sampleRate) + " Hz, " +
+    DBG("Metronome prepared: " + juce::String(newSampleRate) + " Hz, " +
         juce::String(currentBPM.load(), 1) + " BPM, " +
-        juce::String(samplesPerBeat, 1) + " samples/beat");
+        juce::String((60.0 / currentBPM.load()) * newSampleRate, 1) + " samples/beat");
 }
 
 void Metronome::reset()
 {
-    sinePhase            = 0.0;
-    beatPhaseAccumulator = 0.0;
-    clickSampleCountdown = 0;
+    clickData     = nullptr;
+    clickPosition = 0;
 }
 
 //==============================================================================
@@ -43,12 +55,139 @@ void Metronome::setClickFrequency(double hz)
 {
     jassert(hz > 0.0);
     clickFreqHz.store(hz, std::memory_order_release);
+    rebuildClicks();
 }
 
 void Metronome::setClickDurationMs(double ms)
 {
     jassert(ms > 0.0);
     clickDurationMs.store(ms, std::memory_order_release);
+    rebuildClicks();
+}
+
+void Metronome::setAccentFrequency(double hz)
+{
+    jassert(hz > 0.0);
+    accentFreqHz.store(hz, std::memory_order_release);
+    rebuildClicks();
+}
+
+//==============================================================================
+bool Metronome::loadClickSample(const juce::File& file, bool accent)
+{
+    juce::AudioFormatManager fm;
+    fm.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
+    if (reader == nullptr || reader->lengthInSamples <= 0 || reader->sampleRate <= 0.0
+        || reader->numChannels == 0)
+    {
+        DBG("Metronome: cannot read click sample " + file.getFullPathName());
+        return false;
+    }
+
+    const int numSamples  = static_cast<int>(juce::jmin(reader->lengthInSamples,
+                              static_cast<juce::int64>(kMaxClickSeconds * reader->sampleRate)));
+    const int numChannels = static_cast<int>(reader->numChannels);
+
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+    reader->read(&buffer, 0, numSamples, 0, true, true);
+
+    // Auf Mono mischen
+    ClickSource source;
+    source.sampleRate = reader->sampleRate;
+    source.samples.assign(static_cast<size_t>(numSamples), 0.0f);
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::addWithMultiply(source.samples.data(), buffer.getReadPointer(ch),
+                                                     1.0f / static_cast<float>(numChannels), numSamples);
+
+    {
+        const juce::ScopedLock sl(buildLock);
+        (accent ? accentSource : regularSource) = std::move(source);
+    }
+    rebuildClicks();
+
+    DBG("Metronome: " + juce::String(accent ? "accent" : "regular") + " click loaded from "
+        + file.getFileName() + " (" + juce::String(numSamples) + " samples)");
+    return true;
+}
+
+void Metronome::clearClickSamples()
+{
+    {
+        const juce::ScopedLock sl(buildLock);
+        regularSource = {};
+        accentSource  = {};
+    }
+    rebuildClicks();
+}
+
+bool Metronome::hasCustomClick() const
+{
+    const juce::ScopedLock sl(buildLock);
+    return !regularSource.samples.empty() || !accentSource.samples.empty();
+}
+
+//==============================================================================
+void Metronome::rebuildClicks()
+{
+    const juce::ScopedLock sl(buildLock);
+
+    const double sr = sampleRate.load(std::memory_order_acquire);
+    if (sr <= 0.0)
+        return;
+
+    auto set = std::make_unique<ClickSet>();
+    set->sampleRate = sr;
+
+    set->regular = regularSource.samples.empty()
+                 ? synthesizeClick(clickFreqHz.load(std::memory_order_relaxed), sr)
+                 : convertSource(regularSource, sr);
+
+    if (!accentSource.samples.empty())
+        set->accent = convertSource(accentSource, sr);
+    else if (!regularSource.samples.empty())
+        set->accent = set->regular;                // eigenes Sample auch als Accent (nur lauter)
+    else
+        set->accent = synthesizeClick(accentFreqHz.load(std::memory_order_relaxed), sr);
+
+    // Retired-Slot vorher und nachher leeren: der Audio-Thread übernimmt nur,
+    // wenn er leer ist.  Was dort liegt, liest der Audio-Thread nicht mehr.
+    delete retiredClicks.exchange(nullptr, std::memory_order_acq_rel);
+    delete pendingClicks.exchange(set.release(), std::memory_order_acq_rel);
+    delete retiredClicks.exchange(nullptr, std::memory_order_acq_rel);
+}
+
+std::vector<float> Metronome::synthesizeClick(double hz, double sr) const
+{
+    const double ms  = clickDurationMs.load(std::memory_order_relaxed);
+    const int    len = juce::jmax(1, static_cast<int>((ms / 1000.0) * sr));
+    const double inc = (juce::MathConstants<double>::twoPi * hz) / sr;
+
+    // Sinus mit linearem Decay
+    std::vector<float> table(static_cast<size_t>(len));
+    for (int i = 0; i < len; ++i)
+    {
+        const double env = static_cast<double>(len - i) / static_cast<double>(len);
+        table[static_cast<size_t>(i)] = static_cast<float>(std::sin(inc * i) * env);
+    }
+    return table;
+}
+
+std::vector<float> Metronome::convertSource(const ClickSource& src, double sr)
+{
+    if (src.sampleRate == sr)
+        return src.samples;
+
+    const DenormalPolicy::Scope noDenormals;
+
+    const PolyphaseResampler resampler(src.sampleRate, sr, PolyphaseResampler::Quality::Normal);
+    const auto numIn  = static_cast<juce::int64>(src.samples.size());
+    const auto numOut = juce::jmax(juce::int64(1), resampler.getOutputLength(numIn));
+
+    std::vector<float> out(static_cast<size_t>(numOut), 0.0f);
+    resampler.process(src.samples.data(), numIn, out.data(), numOut, false);
+    return out;
 }
 
 //==============================================================================
@@ -58,19 +197,37 @@ void Metronome::processBlock(float* const* outputChannelData,
                              juce::int64    globalPlayhead,
                              bool           isPlaying)
 {
+    // Neue Click-Tabellen übernehmen (nur wenn der Retired-Slot frei ist)
+    if (retiredClicks.load(std::memory_order_acquire) == nullptr)
+    {
+        if (auto* next = pendingClicks.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            clickData = nullptr;   // zeigt in die alten Tabellen
+            retiredClicks.store(clicks, std::memory_order_release);
+            clicks = next;
+        }
+    }
+
     // Timing läuft nur wenn enabled + playing
     if (!isEnabled.load(std::memory_order_relaxed) || !isPlaying)
     {
-        clickSampleCountdown = 0;
-        beatPhaseAccumulator  = 0.0;   // clean state for next start
-        sinePhase             = 0.0;
+        gainSmoother.reset(masterGain.load(std::memory_order_relaxed));   // silent: no ramp needed
+        clickData = nullptr;   // clean state for next start
         return;
     }
 
-    if (outputChannelData == nullptr || numSamples <= 0)
+    if (outputChannelData == nullptr || numSamples <= 0 || clicks == nullptr)
         return;
 
-    recalculate();
+    // samplesPerBeat nur bei BPM- oder Rate-Änderung neu berechnen
+    const double bpm = currentBPM.load(std::memory_order_relaxed);
+    const double sr  = sampleRate.load(std::memory_order_relaxed);
+    if (bpm != cachedBpm || sr != cachedRate)
+    {
+        cachedBpm      = bpm;
+        cachedRate     = sr;
+        samplesPerBeat = (bpm > 0.0 && sr > 0.0) ? (60.0 / bpm) * sr : 0.0;
+    }
     if (samplesPerBeat <= 0.0)
         return;
 
@@ -78,89 +235,79 @@ void Metronome::processBlock(float* const* outputChannelData,
     const int  outL    = outputLeft .load(std::memory_order_relaxed);
     const int  outR    = outputRight.load(std::memory_order_relaxed);
 
-    // Output-Pointer nur auflösen wenn Sound aktiv — verhindert Schreiben wenn muted
-    const bool hasL = soundOn && (outL >= 0) && (outL < numOutputChannels)
-                               && (outputChannelData[outL] != nullptr);
-    const bool hasR = soundOn && (outR >= 0) && (outR < numOutputChannels)
-                               && (outputChannelData[outR] != nullptr);
+    // Output-Pointer nur auflösen wenn Sound aktiv — verhindert Schreiben wenn muted.
+    // Muted: Click-Position läuft trotzdem weiter.
+    float* left  = (soundOn && outL >= 0 && outL < numOutputChannels) ? outputChannelData[outL] : nullptr;
+    float* right = (soundOn && outR >= 0 && outR < numOutputChannels) ? outputChannelData[outR] : nullptr;
 
-    // Beat-Phase mit globalem Playhead synchronisieren (bleibt im Takt nach Loop-Wrap)
-    beatPhaseAccumulator = std::fmod(static_cast<double>(globalPlayhead), samplesPerBeat);
+    // Lautstärke-Rampe für diesen Block (nullptr = konstant)
+    const float* gainRamp = gainSmoother.process(masterGain.load(std::memory_order_relaxed), numSamples);
+    const float  gainNow  = gainSmoother.getCurrent();
 
-    // For accent detection: samplesPerBar = samplesPerBeat * beatsPerBar
-    const int    bpb         = beatsPerBar.load(std::memory_order_relaxed);
-    const double samplesPerBar = samplesPerBeat * juce::jmax(1, bpb);
+    const int   bpb       = juce::jmax(1, beatsPerBar.load(std::memory_order_relaxed));
+    const float regAmp    = amplitude      .load(std::memory_order_relaxed);
+    const float accentAmp = accentAmplitude.load(std::memory_order_relaxed);
 
-    for (int i = 0; i < numSamples; ++i)
+    // Beat b beginnt bei Sample ceil(b * samplesPerBeat) — am globalen Playhead
+    // ausgerichtet, bleibt also im Takt nach Loop-Wrap
+    const auto beatStart = [this](juce::int64 b)
     {
-        // Beat-Grenze → neuen Click starten
-        if (beatPhaseAccumulator < 1.0)
-        {
-            // Determine whether this beat is the first beat of a bar (accent)
-            const juce::int64 samplePos = globalPlayhead + static_cast<juce::int64>(i);
-            const int barBeat = (samplesPerBar > 0.0)
-                ? static_cast<int>(std::fmod(static_cast<double>(samplePos), samplesPerBar)
-                                   / samplesPerBeat)
-                : 0;
-            const bool isAccent = (barBeat == 0);
-
-            sinePhase            = 0.0;
-            sinePhaseIncrement   = isAccent ? accentSinePhaseIncrement
-                                            : regularSinePhaseIncrement;
-            currentClickAmplitude = isAccent ? accentAmplitude.load(std::memory_order_relaxed)
-                                             : amplitude      .load(std::memory_order_relaxed);
-            clickSampleCountdown = clickDurationSamples;
-        }
+        return static_cast<juce::int64>(std::ceil(static_cast<double>(b) * samplesPerBeat));
+    };
 
-        if (clickSampleCountdown > 0)
-        {
-            // Sine-Phase IMMER weiterführen — auch wenn muted.
-            // So entsteht beim Unmute keine Phase-Diskontinuität.
-            const float s = nextSineSample();
-
-            if (hasL || hasR)
-            {
-                const float env = static_cast<float>(clickSampleCountdown) /
-                                  static_cast<float>(clickDurationSamples);
-                const float out = s * currentClickAmplitude * env
-                                    * masterGain.load(std::memory_order_relaxed);
-                if (hasL) outputChannelData[outL][i] += out;
-                if (hasR) outputChannelData[outR][i] += out;
-            }
-
-            --clickSampleCountdown;
-        }
+    const juce::int64 blockEnd = globalPlayhead + numSamples;
+    auto beat = static_cast<juce::int64>(std::floor(static_cast<double>(globalPlayhead) / samplesPerBeat));
+    if (beatStart(beat) < globalPlayhead)
+        ++beat;
+
+    int cursor = 0;
+    for (juce::int64 start = beatStart(beat); start < blockEnd; start = beatStart(++beat))
+    {
+        const int offset = static_cast<int>(start - globalPlayhead);
 
-        beatPhaseAccumulator += 1.0;
-        if (beatPhaseAccumulator >= samplesPerBeat)
-            beatPhaseAccumulator -= samplesPerBeat;
+        // Laufenden Click bis zum Beat ausspielen, dann neuen starten (schneidet ab)
+        renderClick(left, right, cursor, offset - cursor, gainRamp, gainNow);
+
+        const bool  isAccent = ((beat % bpb) + bpb) % bpb == 0;
+        const auto& table    = isAccent ? clicks->accent : clicks->regular;
+
+        clickData      = table.empty() ? nullptr : table.data();
+        clickLength    = static_cast<int>(table.size());
+        clickPosition  = 0;
+        clickAmplitude = isAccent ? accentAmp : regAmp;
+        cursor         = offset;
     }
+
+    renderClick(left, right, cursor, numSamples - cursor, gainRamp, gainNow);
 }
 
-//==============================================================================
-void Metronome::recalculate()
+void Metronome::renderClick(float* left, float* right, int offset, int count,
+                            const float* gainRamp, float gain)
 {
-    const double bpm = currentBPM    .load(std::memory_order_relaxed);
-    const double ms  = clickDurationMs.load(std::memory_order_relaxed);
-    const double hz  = clickFreqHz   .load(std::memory_order_relaxed);
-
-    const double sr = sampleRate.load(std::memory_order_relaxed);
-    if (sr <= 0.0 || bpm <= 0.0)
+    if (clickData == nullptr || count <= 0)
         return;
 
-    samplesPerBeat            = (60.0 / bpm) * sr;
-    clickDurationSamples      = juce::jmax(juce::int64(1),
-                                static_cast<juce::int64>((ms / 1000.0) * sr));
-    regularSinePhaseIncrement = (2.0 * juce::MathConstants<double>::pi * hz) / sr;
-    accentSinePhaseIncrement  = (2.0 * juce::MathConstants<double>::pi *
-                                  accentFreqHz.load(std::memory_order_relaxed)) / sr;
-}
+    const int    n   = juce::jmin(count, clickLength - clickPosition);
+    const float* src = clickData + clickPosition;
 
-float Metronome::nextSineSample()
-{
-    const float s = static_cast<float>(std::sin(sinePhase));
-    sinePhase += sinePhaseIncrement;
-    if (sinePhase >= juce::MathConstants<double>::twoPi)
-        sinePhase -= juce::MathConstants<double>::twoPi;
-    return s;
+    if (left != nullptr || right != nullptr)
+    {
+        if (gainRamp != nullptr && n <= static_cast<int>(rampScratch.size()))
+        {
+            float* scratch = rampScratch.data();
+            juce::FloatVectorOperations::multiply(scratch, src, gainRamp + offset, n);
+            if (left  != nullptr) juce::FloatVectorOperations::addWithMultiply(left  + offset, scratch, clickAmplitude, n);
+            if (right != nullptr) juce::FloatVectorOperations::addWithMultiply(right + offset, scratch, clickAmplitude, n);
+        }
+        else
+        {
+            const float g = clickAmplitude * gain;
+            if (left  != nullptr) juce::FloatVectorOperations::addWithMultiply(left  + offset, src, g, n);
+            if (right != nullptr) juce::FloatVectorOperations::addWithMultiply(right + offset, src, g, n);
+        }
+    }
+
+    clickPosition += n;
+    if (clickPosition >= clickLength)
+        clickData = nullptr;
 }
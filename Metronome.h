@@ -2,6 +2,8 @@
 
 #include <JuceHeader.h>
 #include <atomic>
+#include <vector>
+#include "SmoothedGain.h"
 
 /**
  * @file Metronome.h
@@ -14,6 +16,17 @@
  *   enabled=true,  muted=true   →  kein Sound, Timing läuft
  *   enabled=false               →  alles inaktiv
  *
+ * Click-Rendering:
+ *   Regular- und Accent-Click liegen als fertige Sample-Tabellen vor
+ *   (synthetisierter Sinus mit Decay oder geladene Click-Samples, auf die
+ *   Device-Rate konvertiert).  processBlock() berechnet die Beat-Positionen
+ *   einmal pro Block und kopiert die Tabellen an diese Offsets — keine
+ *   Per-Sample-Schleife, kein fmod.
+ *
+ *   Neue Tabellen baut der Message-Thread und übergibt sie über pendingClicks;
+ *   der Audio-Thread übernimmt sie am Blockanfang, die alte landet in
+ *   retiredClicks und wird beim nächsten Rebuild gelöscht.
+ *
  * Thread-safety:
  *   processBlock()  → Audio-Thread (real-time safe)
  *   Alle Setter     → Message-Thread (atomics)
@@ -22,11 +35,11 @@ class Metronome
 {
 public:
     Metronome();
-    ~Metronome() = default;
+    ~Metronome();
 
     //==========================================================================
     // Setup (vor Audio-Start oder bei Sample-Rate-Änderung aufrufen)
-    void prepareToPlay(double sampleRate);
+    void prepareToPlay(double sampleRate, int maxBlockSize);
 
     /** Phase auf 0 zurücksetzen (z.B. bei Song-Switch oder Playhead-Reset). */
     void reset();
@@ -49,6 +62,7 @@ public:
     int  getOutputLeft()  const { return outputLeft .load(std::memory_order_relaxed); }
     int  getOutputRight() const { return outputRight.load(std::memory_order_relaxed); }
 
+    /** Frequency / length of the synthesized regular click (rebuilds the click tables). */
     void setClickFrequency(double hz);
     void setClickDurationMs(double ms);
     void setAmplitude(float amp) { amplitude.store(amp, std::memory_order_release); }
@@ -58,7 +72,7 @@ public:
     int  getBeatsPerBar() const { return beatsPerBar.load(std::memory_order_relaxed); }
 
     /** Frequency for the accented (first-beat-of-bar) click. Default 1600 Hz. */
-    void setAccentFrequency(double hz) { accentFreqHz.store(hz, std::memory_order_release); }
+    void setAccentFrequency(double hz);
     /** Amplitude for the accented click (0-1). Default 1.0. */
     void setAccentAmplitude(float amp) { accentAmplitude.store(amp, std::memory_order_release); }
 
@@ -66,6 +80,25 @@ public:
     void  setMasterGain(float g) { masterGain.store(juce::jlimit(0.0f, 1.0f, g), std::memory_order_release); }
     float getMasterGain() const  { return masterGain.load(std::memory_order_relaxed); }
 
+    //==========================================================================
+    // Eigene Click-Sounds (Message-Thread)
+
+    /**
+     * @brief Use an audio file as regular or accent click instead of the sine.
+     *
+     * Mixed to mono, cut to kMaxClickSeconds and converted to the device rate.
+     * Without an accent sample the regular sample is used for both.
+     * @return false if the file cannot be read
+     */
+    bool loadClickSample(const juce::File& file, bool accent);
+
+    /** Back to the synthesized clicks. */
+    void clearClickSamples();
+
+    bool hasCustomClick() const;
+
+    static constexpr double kMaxClickSeconds = 2.0;
+
     //==========================================================================
     // Audio-Thread — jeden Block aufrufen
     void processBlock(float* const* outputChannelData,
@@ -90,21 +123,47 @@ private:
     std::atomic<float>  accentAmplitude {1.0f};    // slightly louder on bar beat 1
     std::atomic<float>  masterGain      {1.0f};    // overall click volume (0-1)
 
+    //==========================================================================
+    // Click-Tabellen (immutable nach dem Bauen)
+    struct ClickSet
+    {
+        std::vector<float> regular;
+        std::vector<float> accent;
+        double             sampleRate {0.0};
+    };
+
+    struct ClickSource                             // geladenes Sample, Original-Rate
+    {
+        std::vector<float> samples;
+        double             sampleRate {0.0};
+    };
+
+    std::atomic<ClickSet*> pendingClicks {nullptr};   // Message → Audio
+    std::atomic<ClickSet*> retiredClicks {nullptr};   // Audio → Message (gelöscht beim nächsten Rebuild)
+
+    // Nur Message-Thread
+    mutable juce::CriticalSection buildLock;
+    ClickSource regularSource, accentSource;
+
+    void rebuildClicks();
+    std::vector<float> synthesizeClick(double hz, double sr) const;
+    static std::vector<float> convertSource(const ClickSource& src, double sr);
+
     //==========================================================================
     // Audio-Thread only (keine Atomics nötig)
+    SmoothedGain gainSmoother;                        // ramps masterGain changes
     std::atomic<double> sampleRate           {44100.0};
+    ClickSet*   clicks                       {nullptr};  // aktive Tabellen
+    const float* clickData                   {nullptr};  // laufender Click (nullptr = keiner)
+    int         clickLength                  {0};
+    int         clickPosition                {0};
+    float       clickAmplitude               {0.7f};     // accent oder regular, pro Click gesetzt
     double      samplesPerBeat               {0.0};
-    double      sinePhase                    {0.0};
-    double      regularSinePhaseIncrement    {0.0};  // normal beat
-    double      accentSinePhaseIncrement     {0.0};  // bar beat 1
-    double      sinePhaseIncrement           {0.0};  // active for current click (set per-click)
-    juce::int64 clickSampleCountdown         {0};
-    juce::int64 clickDurationSamples         {0};
-    double      beatPhaseAccumulator         {0.0};
-    float       currentClickAmplitude        {0.7f}; // set per-click (accent or regular)
-
-    void  recalculate();
-    float nextSineSample();
+    double      cachedBpm                    {0.0};      // samplesPerBeat nur bei Änderung neu
+    double      cachedRate                   {0.0};
+    std::vector<float> rampScratch;                      // Click × Gain-Rampe
+
+    void renderClick(float* left, float* right, int offset, int count, const float* gainRamp, float gain);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Metronome)
 };
@@ -0,0 +1,343 @@
+#include "MidiClockGenerator.h"
+#include <thread>
+
+//==============================================================================
+MidiClockGenerator::MidiClockGenerator()
+    : juce::Thread("MIDI Clock Out")
+{
+}
+
+MidiClockGenerator::~MidiClockGenerator()
+{
+    setOutput(nullptr);
+}
+
+//==============================================================================
+// Message thread
+//==============================================================================
+
+void MidiClockGenerator::setOutput(std::unique_ptr<juce::MidiOutput> newOutput)
+{
+    // The audio thread queues a Stop once it sees enabled == false; the sender
+    // may be gone by then, so the old port gets one directly (twice is harmless)
+    const bool wasRunning = gearRunning.load(std::memory_order_acquire);
+    enabled.store(false, std::memory_order_release);
+    stopThread(500);
+
+    if (output != nullptr && wasRunning)
+        output->sendMessageNow(juce::MidiMessage::midiStop());
+
+    output = std::move(newOutput);
+    deviceIdentifier = output != nullptr ? output->getIdentifier() : juce::String();
+    generation.fetch_add(1, std::memory_order_acq_rel);   // events queued for the old port are dropped
+
+    eventsSent.store(0, std::memory_order_relaxed);
+    eventsDropped.store(0, std::memory_order_relaxed);
+    errorSumUs.store(0, std::memory_order_relaxed);
+    maxErrorUs.store(0, std::memory_order_relaxed);
+    maxBlockJitterUs.store(0, std::memory_order_relaxed);
+
+    if (output == nullptr)
+    {
+        DBG("MIDI clock out: off");
+        return;
+    }
+
+    const auto opts = juce::Thread::RealtimeOptions{}.withPriority(8);
+    if (!startRealtimeThread(opts))
+    {
+        DBG("MIDI clock out: realtime priority unavailable, using highest");
+        startThread(juce::Thread::Priority::highest);
+    }
+    enabled.store(true, std::memory_order_release);
+    DBG("MIDI clock out: " + output->getName());
+}
+
+juce::String MidiClockGenerator::getDeviceIdentifier() const
+{
+    return deviceIdentifier;
+}
+
+MidiClockGenerator::Stats MidiClockGenerator::getStats() const noexcept
+{
+    Stats s;
+    s.eventsSent       = eventsSent.load(std::memory_order_relaxed);
+    s.eventsDropped    = eventsDropped.load(std::memory_order_relaxed);
+    s.meanErrorUs      = s.eventsSent > 0
+                       ? static_cast<double>(errorSumUs.load(std::memory_order_relaxed)) / s.eventsSent : 0.0;
+    s.maxErrorUs       = maxErrorUs.load(std::memory_order_relaxed);
+    s.maxBlockJitterUs = maxBlockJitterUs.load(std::memory_order_relaxed);
+    return s;
+}
+
+//==============================================================================
+// Audio thread
+//==============================================================================
+
+void MidiClockGenerator::beginBlock(double newSampleRate, int numSamples) noexcept
+{
+    blockOffset = 0;
+    if (newSampleRate <= 0.0 || numSamples <= 0)
+        return;
+
+    // Callbacks wake up with the driver's jitter, the samples do not: follow
+    // the wall clock slowly, re-anchor after a gap (device restart, xrun, bounce)
+    const double now   = juce::Time::getMillisecondCounterHiRes();
+    const double error = now - nextBlockMs;
+
+    if (newSampleRate != sampleRate || nextBlockMs <= 0.0 || std::abs(error) > kResyncMs)
+    {
+        blockTimeMs = now;
+    }
+    else
+    {
+        blockTimeMs = nextBlockMs + kSmoothing * error;
+
+        const int us = juce::roundToInt(std::abs(error) * 1000.0);
+        if (us > maxBlockJitterUs.load(std::memory_order_relaxed))
+            maxBlockJitterUs.store(us, std::memory_order_relaxed);
+    }
+
+    sampleRate  = newSampleRate;
+    nextBlockMs = blockTimeMs + 1000.0 * numSamples / sampleRate;
+}
+
+void MidiClockGenerator::process(juce::int64 playhead, juce::int64 loopLength, double bpm,
+                                 bool playing, int numSamples, int latencySamples) noexcept
+{
+    const int offset = blockOffset;
+    blockOffset += numSamples;
+    if (sampleRate <= 0.0 || numSamples <= 0)
+        return;
+
+    // A new port has not been started yet, whatever the old one saw
+    const int gen = generation.load(std::memory_order_acquire);
+    if (gen != seenGeneration)
+    {
+        seenGeneration = gen;
+        gearStarted    = false;
+        startTick      = -1;
+    }
+
+    const bool   running     = playing && bpm > 0.0 && enabled.load(std::memory_order_acquire);
+    const double timeAtStart = blockTimeMs + 1000.0 * (offset + juce::jmax(0, latencySamples)) / sampleRate;
+
+    //--- 1. TRANSPORT ---
+    if (!running)
+    {
+        if (gearStarted)
+        {
+            push(timeAtStart, 0xFC);
+            gearStarted = false;
+            gearRunning.store(false, std::memory_order_release);
+        }
+        startTick = -1;
+        return;
+    }
+
+    const double samplesPerBeat = 60.0 / bpm * sampleRate;
+    const double samplesPerTick = samplesPerBeat / kPpqn;
+    updateGrid(loopLength, samplesPerBeat);
+
+    // A loop set or shortened under a pending start: resume on its downbeat
+    if (startTick >= 0 && loopLength > 0 && startTick >= ticksPerLoop)
+    {
+        startTick      = 0;
+        startSixteenth = 0;
+    }
+
+    juce::int64 from = juce::jmax<juce::int64>(0, playhead);
+    if (loopLength > 0)
+        from %= loopLength;
+
+    if (!gearStarted)
+    {
+        armStart(from, loopLength, samplesPerTick);
+        gearStarted = true;
+        gearRunning.store(true, std::memory_order_release);
+    }
+
+    //--- 2. TICKS (split at the loop wrap) ---
+    if (loopLength > 0 && from + numSamples > loopLength)
+    {
+        const juce::int64 first = loopLength - from;
+        queueTicks(from, loopLength, loopLength, samplesPerTick, timeAtStart);
+        queueTicks(0, juce::jmin(loopLength, numSamples - first), loopLength, samplesPerTick,
+                   timeAtStart + 1000.0 * static_cast<double>(first) / sampleRate);
+    }
+    else
+    {
+        queueTicks(from, from + numSamples, loopLength, samplesPerTick, timeAtStart);
+    }
+}
+
+void MidiClockGenerator::updateGrid(juce::int64 loopLength, double samplesPerBeat) noexcept
+{
+    if (loopLength == gridLoopLength && samplesPerBeat == gridBeat)
+        return;
+
+    if (loopLength <= 0)
+        ticksPerLoop = 0;
+    else if (loopLength == 2 * gridLoopLength && samplesPerBeat == gridBeat && ticksPerLoop > 0)
+        ticksPerLoop *= 2;   // DoubleLoopLength: the first half keeps its grid exactly
+    else
+        ticksPerLoop = juce::jmax<juce::int64>(1, juce::roundToInt(static_cast<double>(loopLength) / samplesPerBeat))
+                       * kPpqn;
+
+    gridLoopLength = loopLength;
+    gridBeat       = samplesPerBeat;
+}
+
+juce::int64 MidiClockGenerator::tickPosition(juce::int64 tick, juce::int64 loopLength,
+                                             double samplesPerTick) const noexcept
+{
+    if (loopLength > 0 && ticksPerLoop > 0)
+        return (tick * loopLength + ticksPerLoop - 1) / ticksPerLoop;   // ceil(tick * L / T)
+
+    return static_cast<juce::int64>(std::ceil(static_cast<double>(tick) * samplesPerTick));
+}
+
+juce::int64 MidiClockGenerator::firstTickAtOrAfter(juce::int64 pos, juce::int64 loopLength,
+                                                   double samplesPerTick) const noexcept
+{
+    juce::int64 tick = (loopLength > 0 && ticksPerLoop > 0)
+                     ? pos * ticksPerLoop / loopLength
+                     : static_cast<juce::int64>(std::floor(static_cast<double>(pos) / samplesPerTick));
+
+    while (tickPosition(tick, loopLength, samplesPerTick) < pos)
+        ++tick;
+    return tick;
+}
+
+void MidiClockGenerator::armStart(juce::int64 playhead, juce::int64 loopLength, double samplesPerTick) noexcept
+{
+    // Gear resumes on a sixteenth (6 ticks): hold the clock until the next one.
+    // The last sixteenth of a loop resumes as a Start on the wrap.
+    const juce::int64 tick = firstTickAtOrAfter(playhead, loopLength, samplesPerTick);
+    juce::int64 sixteenth  = (tick + 5) / 6;
+
+    if (loopLength > 0 && sixteenth * 6 >= ticksPerLoop)
+        sixteenth = 0;
+
+    startTick      = sixteenth * 6;
+    startSixteenth = static_cast<int>(juce::jmin<juce::int64>(sixteenth, 0x3FFF));
+}
+
+void MidiClockGenerator::queueTicks(juce::int64 from, juce::int64 to, juce::int64 loopLength,
+                                    double samplesPerTick, double timeAtFrom) noexcept
+{
+    for (juce::int64 tick = firstTickAtOrAfter(from, loopLength, samplesPerTick);; ++tick)
+    {
+        if (loopLength > 0 && tick >= ticksPerLoop)
+            break;
+
+        const juce::int64 pos = tickPosition(tick, loopLength, samplesPerTick);
+        if (pos >= to)
+            break;
+
+        const double timeMs = timeAtFrom + 1000.0 * static_cast<double>(pos - from) / sampleRate;
+
+        if (startTick >= 0)
+        {
+            if (tick != startTick)
+                continue;
+
+            if (startSixteenth == 0)
+            {
+                push(timeMs, 0xFA);
+            }
+            else
+            {
+                push(timeMs, 0xF2, static_cast<juce::uint8>(startSixteenth & 0x7F),
+                                   static_cast<juce::uint8>((startSixteenth >> 7) & 0x7F), 3);
+                push(timeMs, 0xFB);
+            }
+            startTick = -1;
+        }
+
+        push(timeMs, 0xF8);
+    }
+}
+
+void MidiClockGenerator::push(double timeMs, juce::uint8 b0, juce::uint8 b1, juce::uint8 b2, int size) noexcept
+{
+    if (fifo.getFreeSpace() < 1)
+    {
+        eventsDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int idx1, size1, idx2, size2;
+    fifo.prepareToWrite(1, idx1, size1, idx2, size2);
+
+    auto& e = queue[static_cast<size_t>(size1 > 0 ? idx1 : idx2)];
+    e.timeMs     = timeMs;
+    e.bytes[0]   = b0;
+    e.bytes[1]   = b1;
+    e.bytes[2]   = b2;
+    e.size       = size;
+    e.generation = seenGeneration;
+
+    fifo.finishedWrite(1);
+}
+
+//==============================================================================
+// Sender thread
+//==============================================================================
+
+void MidiClockGenerator::run()
+{
+    const int current = generation.load(std::memory_order_acquire);
+
+    while (!threadShouldExit())
+    {
+        if (resetRequested.exchange(false, std::memory_order_acq_rel))
+        {
+            eventsSent.store(0, std::memory_order_relaxed);
+            eventsDropped.store(0, std::memory_order_relaxed);
+            errorSumUs.store(0, std::memory_order_relaxed);
+            maxErrorUs.store(0, std::memory_order_relaxed);
+            maxBlockJitterUs.store(0, std::memory_order_relaxed);
+        }
+
+        int idx1, size1, idx2, size2;
+        fifo.prepareToRead(1, idx1, size1, idx2, size2);
+        if (size1 + size2 == 0)
+        {
+            wait(1);   // the audio thread does not signal — polling keeps it lock-free
+            continue;
+        }
+
+        const Event& e = queue[static_cast<size_t>(size1 > 0 ? idx1 : idx2)];
+        double now = juce::Time::getMillisecondCounterHiRes();
+
+        // Queued for another port, or so late it would only confuse the gear
+        if (e.generation != current || now - e.timeMs > kStaleMs)
+        {
+            fifo.finishedRead(1);
+            eventsDropped.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        // Sleep while that is accurate enough, spin the last stretch
+        if (e.timeMs - now > kSpinMs)
+        {
+            wait(juce::jmax(1, static_cast<int>(e.timeMs - now - kSpinMs)));
+            continue;
+        }
+        while (now < e.timeMs && !threadShouldExit())
+        {
+            std::this_thread::yield();
+            now = juce::Time::getMillisecondCounterHiRes();
+        }
+
+        const int us = juce::roundToInt(juce::jmax(0.0, now - e.timeMs) * 1000.0);
+        output->sendMessageNow(juce::MidiMessage(e.bytes, e.size));
+        fifo.finishedRead(1);
+
+        eventsSent.fetch_add(1, std::memory_order_relaxed);
+        errorSumUs.fetch_add(us, std::memory_order_relaxed);
+        if (us > maxErrorUs.load(std::memory_order_relaxed))
+            maxErrorUs.store(us, std::memory_order_relaxed);
+    }
+}
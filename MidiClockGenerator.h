@@ -0,0 +1,147 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+ * @file MidiClockGenerator.h
+ * @brief MIDI clock, song position and start/stop out, sample-accurate to the loop
+ *
+ * The audio thread works out where the 24-PPQN ticks fall in every
+ * (sub-)block, from the loop playhead and the metronome BPM, and queues
+ * them with the wall-clock time their sample leaves the interface.  A
+ * realtime "MIDI Clock Out" thread sleeps until shortly before each event,
+ * spins the rest of the way and sends it — jitter is the scheduling error
+ * of that last step, not the audio block size.
+ *
+ * Tick grid:
+ *   - With a loop, the loop is split into a whole number of ticks (the
+ *     metronome beats that fit, times 24) and tick k sits on sample
+ *     ceil(k * loopLength / ticks).  The grid restarts exactly at the loop
+ *     wrap, so slaved gear never sees a short or long tick there.  When the
+ *     loop doubles (DoubleLoopLength), the tick count doubles with it and
+ *     the ticks already played keep their samples.
+ *   - Without a loop (first recording), ticks follow the BPM from the
+ *     playhead, like the metronome.
+ *
+ * Transport: Start (playhead 0) or Song Position + Continue when the
+ * transport starts, Stop when it stops.
+ *
+ * Block times: the callback start time is smoothed against the sample
+ * count (a first-order filter), so callback wake-up jitter does not reach
+ * the clock; a jump beyond kResyncMs re-anchors it.
+ *
+ * Thread-safety:
+ *   Message thread: setOutput(), getDeviceIdentifier(), getStats(), resetStats()
+ *   Audio thread  : beginBlock(), process()
+ *   Sender thread : sends; owns the output while it runs
+ */
+class MidiClockGenerator : private juce::Thread
+{
+public:
+    static constexpr int    kPpqn        = 24;
+    static constexpr int    kQueueSize   = 1024;   // events; ~40 per block at 300 BPM / 8192 samples
+    static constexpr double kSpinMs      = 1.5;    // spin instead of sleep this close to an event
+    static constexpr double kResyncMs    = 20.0;   // block time error that re-anchors the filter
+    static constexpr double kSmoothing   = 0.02;   // share of the block time error taken per block
+    static constexpr double kStaleMs     = 100.0;  // events this late are dropped, not sent
+
+    /** Send-time error of the events sent since the last resetStats(). */
+    struct Stats
+    {
+        int    eventsSent    {0};
+        int    eventsDropped {0};   // queue full, or stale after an output change
+        double meanErrorUs   {0.0};
+        double maxErrorUs    {0.0};
+        double maxBlockJitterUs {0.0};   // callback wake-up error absorbed by the smoothing
+    };
+
+    MidiClockGenerator();
+    ~MidiClockGenerator() override;
+
+    /**
+     * @brief Send to output from now on (nullptr = off).
+     *
+     * Stops the sender, sends Stop to the old output if gear was running,
+     * and starts the sender on the new one.  Message thread.
+     */
+    void setOutput(std::unique_ptr<juce::MidiOutput> output);
+
+    juce::String getDeviceIdentifier() const;
+    bool         isEnabled() const noexcept { return enabled.load(std::memory_order_acquire); }
+
+    Stats getStats() const noexcept;
+    void  resetStats() noexcept { resetRequested.store(true, std::memory_order_release); }
+
+    //==========================================================================
+    // Audio thread
+
+    /** Start of a device callback: anchors the block on the wall clock. */
+    void beginBlock(double sampleRate, int numSamples) noexcept;
+
+    /**
+     * @brief Queue the ticks of the next numSamples of the block.
+     * @param playhead        Loop playhead at the first sample (before advancing)
+     * @param loopLength      Loop length in samples, 0 = no loop yet
+     * @param bpm             Metronome tempo
+     * @param playing         Transport state
+     * @param latencySamples  Distance from the playhead to the interface output (PDC + driver)
+     */
+    void process(juce::int64 playhead, juce::int64 loopLength, double bpm,
+                 bool playing, int numSamples, int latencySamples) noexcept;
+
+private:
+    struct Event
+    {
+        double       timeMs {0.0};   // Time::getMillisecondCounterHiRes() domain
+        juce::uint8  bytes[3] {};
+        int          size {0};
+        int          generation {0};
+    };
+
+    void run() override;
+
+    void push(double timeMs, juce::uint8 b0, juce::uint8 b1 = 0, juce::uint8 b2 = 0, int size = 1) noexcept;
+    void armStart(juce::int64 playhead, juce::int64 loopLength, double samplesPerTick) noexcept;
+    void updateGrid(juce::int64 loopLength, double samplesPerBeat) noexcept;
+    juce::int64 tickPosition(juce::int64 tick, juce::int64 loopLength, double samplesPerTick) const noexcept;
+    juce::int64 firstTickAtOrAfter(juce::int64 pos, juce::int64 loopLength, double samplesPerTick) const noexcept;
+    void queueTicks(juce::int64 from, juce::int64 to, juce::int64 loopLength, double samplesPerTick,
+                    double timeAtFrom) noexcept;
+
+    //==========================================================================
+    std::unique_ptr<juce::MidiOutput> output;         // sender thread while it runs
+    juce::String      deviceIdentifier;               // message thread
+    std::atomic<bool> enabled        {false};
+    std::atomic<bool> gearRunning    {false};         // last transport state queued (audio thread)
+    std::atomic<int>  generation     {0};             // bumped per setOutput()
+
+    juce::AbstractFifo    fifo { kQueueSize };
+    std::array<Event, kQueueSize> queue {};
+
+    // Audio thread
+    double      sampleRate    {0.0};
+    double      blockTimeMs   {0.0};                  // smoothed wall time of the block's first sample
+    double      nextBlockMs   {0.0};                  // predicted start of the next block
+    int         blockOffset   {0};                    // samples of the block already processed
+    int         seenGeneration {0};
+    bool        gearStarted   {false};
+    juce::int64 gridLoopLength {-1};
+    double      gridBeat      {0.0};                  // samplesPerBeat the grid was fitted for
+    juce::int64 ticksPerLoop  {0};
+    juce::int64 startTick     {-1};                   // Start/Continue goes out with this tick
+    int         startSixteenth {0};
+
+    // Statistics (written by the sender / audio thread, read anywhere)
+    std::atomic<int>         eventsSent    {0};
+    std::atomic<int>         eventsDropped {0};
+    std::atomic<juce::int64> errorSumUs    {0};
+    std::atomic<int>         maxErrorUs    {0};
+    std::atomic<int>         maxBlockJitterUs {0};
+    std::atomic<bool>        resetRequested {false};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MidiClockGenerator)
+};
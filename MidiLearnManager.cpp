@@ -1,10 +1,17 @@
 #include "MidiLearnManager.h"
 #include "AudioEngine.h"
 #include "Command.h"
+#include <map>
 
 //==============================================================================
 MidiLearnManager::MidiLearnManager(AudioEngine& engine)
     : audioEngine(engine)
+{
+    // Mappings come later via loadAllMappings() (startup graph, off the message thread)
+    startTimerHz(100);  // process MIDI queue at ~10 ms resolution
+}
+
+void MidiLearnManager::loadAllMappings()
 {
     // Load the active mode preference first, then populate the mappings map:
     //   1. Global mappings (channelIndex == -1) from midi_global.xml — always active,
@@ -13,13 +20,16 @@ MidiLearnManager::MidiLearnManager(AudioEngine& engine)
     loadPreferences();
     loadGlobalMappings();
     loadMappings(getMappingsFileForMode(getMidiLearnMode()));
-
-    startTimerHz(100);  // process MIDI queue at ~10 ms resolution
 }
 
 MidiLearnManager::~MidiLearnManager()
 {
     stopTimer();
+
+    // Audio device is closed by now (AudioEngine destructor)
+    delete pendingRealtimeTable.exchange(nullptr);
+    delete retiredRealtimeTable.exchange(nullptr);
+    delete activeRealtimeTable;
 }
 
 //==============================================================================
@@ -108,6 +118,7 @@ void MidiLearnManager::removeMapping(int channelIndex, MidiControlTarget target)
 
     juce::ScopedLock sl(mappingsLock);
     mappings.erase(dummy.getKey());
+    rebuildRealtimeTable();
     saveImmediately();
 }
 
@@ -116,6 +127,7 @@ void MidiLearnManager::removeAllMappings()
     juce::ScopedLock sl(mappingsLock);
     mappings.clear();
     lastMainButtonTriggerTime.clear();
+    rebuildRealtimeTable();
     saveImmediately();
 }
 
@@ -174,6 +186,9 @@ void MidiLearnManager::postMidiMessage(const juce::MidiMessage& msg)
 
 void MidiLearnManager::timerCallback()
 {
+    // Table the audio thread has stopped using
+    delete retiredRealtimeTable.exchange(nullptr, std::memory_order_acq_rel);
+
     int idx1, size1, idx2, size2;
     fifo.prepareToRead(fifo.getNumReady(), idx1, size1, idx2, size2);
 
@@ -276,6 +291,7 @@ void MidiLearnManager::processMidiMessage(const juce::MidiMessage& msg)
         {
             juce::ScopedLock sl(mappingsLock);
             mappings[newMapping.getKey()] = newMapping;
+            rebuildRealtimeTable();
         }
 
         learningActive.store(false, std::memory_order_release);
@@ -303,6 +319,9 @@ void MidiLearnManager::processMidiMessage(const juce::MidiMessage& msg)
         (msg.getControllerNumber() == 0 || msg.getControllerNumber() == 32))
         return;
 
+    // Transport targets are already handled sample-aligned on the audio thread
+    const bool skipRealtime = realtimeDispatch.load(std::memory_order_acquire);
+
     juce::ScopedLock sl(mappingsLock);
     for (auto& kv : mappings)
     {
@@ -310,6 +329,9 @@ void MidiLearnManager::processMidiMessage(const juce::MidiMessage& msg)
         if (!m.isValid())
             continue;
 
+        if (skipRealtime && isRealtimeTarget(m.target))
+            continue;
+
         // MIDI-Kanal prüfen
         if (m.midiChannel != 0 && m.midiChannel != msg.getChannel())
             continue;
@@ -341,31 +363,52 @@ void MidiLearnManager::processMidiMessage(const juce::MidiMessage& msg)
     }
 }
 
-void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessage& msg)
+float MidiLearnManager::normalisedValue(const juce::uint8* raw, int sz)
 {
     // Normalisierter Wert 0..1
-    float norm = 0.0f;
-    if (msg.isController())
-        norm = msg.getControllerValue() / 127.0f;
-    else if (msg.isNoteOn() || msg.isProgramChange())
-        norm = 1.0f;
-    else if (msg.isNoteOff())
-        norm = 0.0f;
-    else if (msg.isPitchWheel())
-        norm = (msg.getPitchWheelValue() + 8192) / 16383.0f;  // -8192..+8191 → 0..1
-    else if (msg.isChannelPressure())
-        norm = msg.getChannelPressureValue() / 127.0f;
-    else if (msg.isAftertouch())
-        norm = msg.getAfterTouchValue() / 127.0f;
-    else
+    if (sz < 1) return 0.0f;
+
+    const int  nibble = raw[0] >> 4;
+    const auto byte   = [&](int i) { return sz > i ? static_cast<int>(raw[i] & 0x7f) : 0; };
+
+    switch (nibble)
     {
-        // Generic: use the second or third raw byte as value.
-        const auto* raw = msg.getRawData();
-        const int sz = msg.getRawDataSize();
-        norm = sz > 2 ? raw[2] / 127.0f
-             : sz > 1 ? raw[1] / 127.0f
-             : 1.0f;
+        case 0xB: return byte(2) / 127.0f;                                   // controller
+        case 0x9: return byte(2) > 0 ? 1.0f : 0.0f;                          // note-on (vel 0 = off)
+        case 0x8: return 0.0f;                                               // note-off
+        case 0xC: return 1.0f;                                               // program change
+        case 0xE: return (byte(1) | (byte(2) << 7)) / 16383.0f;              // pitch wheel → 0..1
+        case 0xD: return byte(1) / 127.0f;                                   // channel pressure
+        case 0xA: return byte(2) / 127.0f;                                   // poly aftertouch
+        default:
+            // Generic: use the second or third raw byte as value.
+            return sz > 2 ? raw[2] / 127.0f
+                 : sz > 1 ? raw[1] / 127.0f
+                 : 1.0f;
     }
+}
+
+bool MidiLearnManager::isRealtimeTarget(MidiControlTarget t)
+{
+    switch (t)
+    {
+        case MidiControlTarget::MainButton:
+        case MidiControlTarget::Record:
+        case MidiControlTarget::Play:
+        case MidiControlTarget::Overdub:
+        case MidiControlTarget::GlobalPlayStop:
+        case MidiControlTarget::SectionA:
+        case MidiControlTarget::SectionB:
+        case MidiControlTarget::SectionC:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessage& msg)
+{
+    const float norm = normalisedValue(msg.getRawData(), msg.getRawDataSize());
 
     const float mapped = m.minValue + norm * (m.maxValue - m.minValue);
 
@@ -377,15 +420,23 @@ void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessag
         ? audioEngine.getActiveChannel()
         : m.channelIndex;
 
+    // Stamped with the MIDI event's time: lands one block after it, not at the next block start
+    const juce::int64 eventSample = audioEngine.getSampleClockFor(msg.getTimeStamp() * 1000.0);
+    auto send = [this, eventSample](Command c)
+    {
+        c.sampleTime = eventSample;
+        audioEngine.sendCommand(c);
+    };
+
     Command cmd;
     cmd.channelIndex = effectiveChannel;
 
     switch (m.target)
     {
         case MidiControlTarget::Gain:
-            cmd.type       = CommandType::SetGain;
-            cmd.floatValue = mapped;
-            break;
+            // Coalescing latest-value slot, not a queued command per CC step
+            audioEngine.setChannelGain(effectiveChannel, mapped);
+            return;
 
         case MidiControlTarget::Mute:
             cmd.type      = CommandType::SetMute;
@@ -456,7 +507,7 @@ void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessag
                     Command undoCmd;
                     undoCmd.type         = CommandType::UndoOverdub;
                     undoCmd.channelIndex = effectiveChannel;
-                    audioEngine.sendCommand(undoCmd);
+                    send(undoCmd);
                     return;
                 }
                 lastMainButtonTriggerTime[key] = now;
@@ -471,7 +522,7 @@ void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessag
                 Command cancelCmd;
                 cancelCmd.type         = CommandType::CancelPending;
                 cancelCmd.channelIndex = effectiveChannel;
-                audioEngine.sendCommand(cancelCmd);
+                send(cancelCmd);
                 return;
             }
 
@@ -486,16 +537,16 @@ void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessag
                 Command c;
                 c.type         = CommandType::StartOverdub;
                 c.channelIndex = effectiveChannel;
-                audioEngine.sendCommand(c);
+                send(c);
             }
             else if (st == ChannelState::Overdubbing || st == ChannelState::Recording)
-                audioEngine.sendCommand(Command::stopRecord(effectiveChannel));
+                send(Command::stopRecord(effectiveChannel));
             else if (!hasLoop)
-                audioEngine.sendCommand(Command::startRecord(effectiveChannel));
+                send(Command::startRecord(effectiveChannel));
             else if (st == ChannelState::Playing)
-                audioEngine.sendCommand(Command::stopPlayback(effectiveChannel));
+                send(Command::stopPlayback(effectiveChannel));
             else
-                audioEngine.sendCommand(Command::startPlayback(effectiveChannel));
+                send(Command::startPlayback(effectiveChannel));
 
             return;
         }
@@ -584,7 +635,87 @@ void MidiLearnManager::applyMapping(const MidiMapping& m, const juce::MidiMessag
             return;
     }
 
-    audioEngine.sendCommand(cmd);
+    send(cmd);
+}
+
+//==============================================================================
+// Realtime-Tabelle
+//==============================================================================
+
+void MidiLearnManager::rebuildRealtimeTable()
+{
+    auto table = std::make_unique<RealtimeMidiTable>();
+    std::vector<std::vector<juce::uint16>> perCell(RealtimeMidiTable::kNumCells);
+
+    {
+        juce::ScopedLock sl(mappingsLock);
+        for (auto& kv : mappings)
+        {
+            const auto& m = kv.second;
+            if (!m.isValid() || !isRealtimeTarget(m.target)) continue;
+            if (table->entries.size() >= 0xffff) break;
+
+            const auto entry = static_cast<juce::uint16>(table->entries.size());
+            table->entries.push_back({ m.target, m.channelIndex });
+
+            // Same matching rules as processMidiMessage()
+            const auto add = [&](int nibble, int data1)
+            {
+                // Bank Select never triggers mapped actions
+                if (nibble == 0xB && (data1 == 0 || data1 == 32)) return;
+
+                const int firstCh = m.midiChannel > 0 ? m.midiChannel - 1 : 0;
+                const int lastCh  = m.midiChannel > 0 ? m.midiChannel - 1 : 15;
+                for (int ch = firstCh; ch <= lastCh; ++ch)
+                    perCell[static_cast<size_t>(RealtimeMidiTable::cellIndex(nibble, ch, data1))].push_back(entry);
+            };
+
+            if (m.ccNumber      >= 0) add(0xB, m.ccNumber & 0x7f);
+            if (m.noteNumber    >= 0) { add(0x9, m.noteNumber & 0x7f); add(0x8, m.noteNumber & 0x7f); }
+            if (m.programNumber >= 0) add(0xC, m.programNumber & 0x7f);
+            if (m.rawStatusNibble >= 0x8 && m.rawStatusNibble <= 0xE)
+            {
+                if (m.rawData1 >= 0) add(m.rawStatusNibble, m.rawData1 & 0x7f);
+                else for (int d = 0; d < 128; ++d) add(m.rawStatusNibble, d);
+            }
+        }
+    }
+
+    // Cells with the same entry set share one run in `lists`
+    std::map<std::vector<juce::uint16>, juce::uint32> runs;
+    for (int c = 0; c < RealtimeMidiTable::kNumCells; ++c)
+    {
+        auto& list = perCell[static_cast<size_t>(c)];
+        if (list.empty()) continue;
+        list.erase(std::unique(list.begin(), list.end()), list.end());
+        if (list.size() > 0xff) list.resize(0xff);
+
+        auto it = runs.find(list);
+        if (it == runs.end())
+        {
+            const auto first = static_cast<juce::uint32>(table->lists.size());
+            table->lists.insert(table->lists.end(), list.begin(), list.end());
+            it = runs.emplace(list, first).first;
+        }
+        table->cells[static_cast<size_t>(c)] = (it->second << 8) | static_cast<juce::uint32>(list.size());
+    }
+
+    // An unclaimed previous table is simply replaced
+    delete pendingRealtimeTable.exchange(table.release(), std::memory_order_acq_rel);
+}
+
+const RealtimeMidiTable* MidiLearnManager::getRealtimeTable() noexcept
+{
+    // Only swap while the retired slot is free; the timer empties it
+    if (retiredRealtimeTable.load(std::memory_order_acquire) == nullptr)
+    {
+        if (auto* fresh = pendingRealtimeTable.exchange(nullptr, std::memory_order_acq_rel))
+        {
+            retiredRealtimeTable.store(activeRealtimeTable, std::memory_order_release);
+            activeRealtimeTable = fresh;
+        }
+    }
+    return activeRealtimeTable;
 }
 
 //==============================================================================
@@ -643,6 +774,7 @@ bool MidiLearnManager::loadMappings(const juce::File& file)
             else
                 ++it;
         }
+        rebuildRealtimeTable();
     }
 
     if (!file.existsAsFile())
@@ -675,9 +807,10 @@ bool MidiLearnManager::loadMappings(const juce::File& file)
                                  entry->getDoubleAttribute("maxValue", 1.0));
 
         // Only accept channel-specific entries here (globals come from loadGlobalMappings)
-        if (m.channelIndex >= 0 && m.channelIndex < 6 && m.isValid())
+        if (m.channelIndex >= 0 && m.channelIndex < MAX_CHANNELS && m.isValid())
             mappings[m.getKey()] = m;
     }
+    rebuildRealtimeTable();
 
     DBG("MIDI-Mappings (channel) loaded: " + juce::String(mappings.size()) +
         " total entries (incl. globals) after " + file.getFullPathName());
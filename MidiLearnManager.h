@@ -1,8 +1,11 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <array>
+#include <atomic>
 #include <map>
 #include <functional>
+#include <vector>
 
 /**
  * @file MidiLearnManager.h
@@ -13,6 +16,9 @@
  *  - MIDI-Messages kommen vom Audio/MIDI-Thread via lock-free Queue
  *  - Im Learn-Modus: nächste CC/Note → wird dem aktuellen Control zugewiesen
  *  - Im Normal-Modus: eingehende Messages → Commands an AudioEngine
+ *  - Transport-kritische Targets (MainButton, Play/Stop, Sections) werden
+ *    direkt im Audio-Thread über eine kompilierte Tabelle ausgelöst
+ *    (RealtimeMidiTable) — kein 10-ms-Timer-Jitter
  *  - Persistenz: sofortiges Speichern nach jeder Änderung (XML)
  */
 
@@ -96,6 +102,61 @@ struct MidiMapping
     }
 };
 
+//==============================================================================
+/**
+ * @brief Compiled lookup of the mappings the audio thread dispatches itself
+ *
+ * Flat cell array indexed by status nibble (0x8..0xE), MIDI channel and first
+ * data byte.  Each non-empty cell refers to a short run in `lists`, which holds
+ * indices into `entries`.  Built on the message thread whenever the mappings
+ * change, read by the audio thread without locks.
+ */
+struct RealtimeMidiTable
+{
+    struct Entry
+    {
+        MidiControlTarget target       {MidiControlTarget::MainButton};
+        int               channelIndex {-1};
+    };
+
+    static constexpr int kNumStatus = 7;                    // 0x8 .. 0xE
+    static constexpr int kNumCells  = kNumStatus * 16 * 128;
+
+    static int cellIndex(int statusNibble, int midiChannel0, int data1) noexcept
+    {
+        return ((statusNibble - 0x8) * 16 + midiChannel0) * 128 + data1;
+    }
+
+    std::vector<Entry>                   entries;
+    std::vector<juce::uint16>            lists;
+    std::array<juce::uint32, kNumCells>  cells {};          // (first << 8) | count, 0 = unmapped
+
+    /** Packed cell for a raw channel message (0 = no mapping). */
+    juce::uint32 lookup(const juce::uint8* data, int size) const noexcept
+    {
+        if (size < 1) return 0;
+        const int nibble = data[0] >> 4;
+        if (nibble < 0x8 || nibble > 0xE) return 0;
+
+        const int d1 = size > 1 ? (data[1] & 0x7f) : 0;
+        return cells[static_cast<size_t>(cellIndex(nibble, data[0] & 0x0f, d1))];
+    }
+
+    bool hasMatch(const juce::uint8* data, int size) const noexcept { return lookup(data, size) != 0; }
+
+    /** Calls fn(entry) for each mapping matching the raw channel message. */
+    template <typename Fn>
+    void forEachMatch(const juce::uint8* data, int size, Fn&& fn) const
+    {
+        const auto cell  = lookup(data, size);
+        const auto first = cell >> 8;
+        const auto count = cell & 0xffu;
+
+        for (juce::uint32 i = 0; i < count; ++i)
+            fn(entries[lists[first + i]]);
+    }
+};
+
 //==============================================================================
 /**
  * @brief Verwaltet MIDI-Learn-Modus und alle Mappings
@@ -194,6 +255,27 @@ public:
      */
     void postMidiMessage(const juce::MidiMessage& msg);
 
+    //==========================================================================
+    // Audio-Thread-Dispatch
+    //==========================================================================
+
+    /** Targets the audio thread fires itself (transport-critical, sample-aligned). */
+    static bool isRealtimeTarget(MidiControlTarget t);
+
+    /** Normalised 0..1 control value of a raw channel message. */
+    static float normalisedValue(const juce::uint8* data, int size);
+
+    /**
+     * @brief While enabled the timer skips realtime targets (the audio thread
+     *        already handled them). Set by AudioEngine on device start/stop.
+     */
+    void setRealtimeDispatchActive(bool active) { realtimeDispatch.store(active, std::memory_order_release); }
+
+    /** Latest compiled table, picking up a pending rebuild. Audio thread only; may be nullptr. */
+    const RealtimeMidiTable* getRealtimeTable() noexcept;
+
+    static constexpr double doublePressWindowMs = 400.0;
+
     //==========================================================================
     // Persistenz
     //==========================================================================
@@ -210,6 +292,12 @@ public:
      */
     bool loadMappings(const juce::File& file);
 
+    /**
+     * Modus-Präferenz, globale und kanalspezifische Mappings laden.
+     * Einmal beim Start — beliebiger Thread (Startup-Graph), bis dahin ist die Tabelle leer.
+     */
+    void loadAllMappings();
+
     /**
      * Returns the mappings file for the currently active mode.
      * Legacy name kept for call-site compatibility.
@@ -242,7 +330,14 @@ private:
 
     // Double-press detection for MainButton → UndoOverdub (message thread only)
     std::map<juce::String, double> lastMainButtonTriggerTime;
-    static constexpr double doublePressWindowMs = 400.0;
+
+    // Realtime table hand-over: message thread publishes into `pending`, the
+    // audio thread moves it to `active` and parks the old table in `retired`
+    // until the timer deletes it. A new table is only taken once `retired` is empty.
+    std::atomic<RealtimeMidiTable*> pendingRealtimeTable {nullptr};
+    std::atomic<RealtimeMidiTable*> retiredRealtimeTable {nullptr};
+    RealtimeMidiTable*              activeRealtimeTable  {nullptr};   // audio thread only
+    std::atomic<bool>               realtimeDispatch     {false};
 
     // Lock-free Queue für MIDI-Messages aus dem Audio-Thread
     juce::AbstractFifo fifo{256};
@@ -257,6 +352,7 @@ private:
     void timerCallback() override;
     void processMidiMessage(const juce::MidiMessage& msg);
     void applyMapping(const MidiMapping& mapping, const juce::MidiMessage& msg);
+    void rebuildRealtimeTable();                               // after every mapping change
 
     // Persistence helpers
     void saveImmediately();                                    // save mode file + global file
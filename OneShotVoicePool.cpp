@@ -0,0 +1,105 @@
+#include "OneShotVoicePool.h"
+
+//==============================================================================
+bool OneShotVoicePool::trigger(int offset, juce::int64 length) noexcept
+{
+    if (length <= 0) return false;
+
+    const juce::int64 start = -static_cast<juce::int64>(juce::jmax(0, offset));
+
+    if (numActive < kMaxVoices)
+    {
+        positions[static_cast<size_t>(numActive++)] = start;
+        publish();
+        return true;
+    }
+
+    const int victim = findVictim();
+    if (victim < 0) return false;
+
+    // Fade the stolen voice out from the new trigger's sample on; with the
+    // release list full the victim is cut, as before the pool existed.
+    if (numReleasing < kMaxReleasing)
+        releasing[static_cast<size_t>(numReleasing++)] = { positions[static_cast<size_t>(victim)],
+                                                           juce::jmax(0, offset),
+                                                           kStealFadeSamples };
+
+    positions[static_cast<size_t>(victim)] = start;
+    publish();
+    return true;
+}
+
+void OneShotVoicePool::stopAll() noexcept
+{
+    numActive    = 0;
+    numReleasing = 0;
+    publish();
+}
+
+void OneShotVoicePool::retireFinished(juce::int64 length) noexcept
+{
+    for (int i = numActive; --i >= 0;)
+        if (positions[static_cast<size_t>(i)] >= length)
+            removeVoice(i);
+
+    for (int i = numReleasing; --i >= 0;)
+        if (releasing[static_cast<size_t>(i)].position >= length
+            || releasing[static_cast<size_t>(i)].fadeLeft <= 0)
+            removeRelease(i);
+
+    publish();
+}
+
+void OneShotVoicePool::removeRelease(int i) noexcept
+{
+    releasing[static_cast<size_t>(i)] = releasing[static_cast<size_t>(--numReleasing)];
+}
+
+void OneShotVoicePool::removeVoice(int i) noexcept
+{
+    // Order does not matter to the kernel — swap with the last one
+    positions[static_cast<size_t>(i)] = positions[static_cast<size_t>(--numActive)];
+}
+
+//==============================================================================
+float OneShotVoicePool::levelAt(juce::int64 pos) const noexcept
+{
+    // A voice that has not started yet is about to play the attack
+    return pos < 0 ? std::numeric_limits<float>::max()
+                   : envelope[static_cast<size_t>(envelopeBin(pos))];
+}
+
+int OneShotVoicePool::findVictim() const noexcept
+{
+    int   victim      = -1;
+    float victimLevel = 0.0f;
+
+    for (int i = 0; i < numActive; ++i)
+    {
+        const juce::int64 pos   = positions[static_cast<size_t>(i)];
+        const float       level = levelAt(pos);
+
+        if (victim < 0 || level < victimLevel
+            || (level == victimLevel && pos > positions[static_cast<size_t>(victim)]))
+        {
+            victim      = i;
+            victimLevel = level;
+        }
+    }
+    return victim;
+}
+
+void OneShotVoicePool::clearEnvelope() noexcept
+{
+    envelope.fill(0.0f);
+}
+
+void OneShotVoicePool::noteRecordedPeak(juce::int64 pos, int numSamples, float peak) noexcept
+{
+    if (numSamples <= 0) return;
+
+    const int first = envelopeBin(pos);
+    const int last  = envelopeBin(pos + numSamples - 1);
+    for (int b = first; b <= last; ++b)
+        envelope[static_cast<size_t>(b)] = juce::jmax(envelope[static_cast<size_t>(b)], peak);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+
+//==============================================================================
+/**
+ * @file OneShotVoicePool.h
+ * @brief Fixed-capacity voice pool for one-shot channels
+ *
+ * Every voice is just a read position into the channel's one-shot take.  Live
+ * voices are kept packed in [0, getNumActive()) so the render kernel
+ * (Channel::playOneShotVoices) walks a dense array and gathers all of them in
+ * one pass over the output block.
+ *
+ * Triggers carry a sample offset inside the block: the voice starts at
+ * position -offset and the kernel holds it silent until it reaches 0, so a
+ * retrigger lands on its sample without splitting the block.
+ *
+ * When the pool is full the quietest voice is stolen — judged by a coarse
+ * peak envelope taken while the take was recorded — and among equally quiet
+ * ones the oldest.  The stolen voice is not cut: it moves to a small release
+ * list and fades out over kStealFadeSamples.
+ *
+ * Thread-safety:
+ *   Audio thread : everything except isPlaying()
+ *   Any thread   : isPlaying()
+ */
+class OneShotVoicePool
+{
+public:
+    static constexpr int kMaxVoices        = 32;
+    static constexpr int kMaxReleasing     = 4;
+    static constexpr int kStealFadeSamples = 128;
+
+    /** A voice that was stolen and is fading out. */
+    struct Release
+    {
+        juce::int64 position {0};
+        int         delay    {0};   ///< samples before the fade starts (the new trigger's offset)
+        int         fadeLeft {0};
+    };
+
+    /**
+     * @brief Start a voice offset samples into the next rendered block.
+     * @return false if the pool is full and nothing could be stolen (never for length > 0).
+     */
+    bool trigger(int offset, juce::int64 length) noexcept;
+
+    /** Drop every voice, releasing ones included. */
+    void stopAll() noexcept;
+
+    /** Drop voices that have played past length. */
+    void retireFinished(juce::int64 length) noexcept;
+
+    int          getNumActive() const noexcept           { return numActive; }
+    juce::int64* getPositions() noexcept                 { return positions.data(); }
+
+    int      getNumReleasing() const noexcept            { return numReleasing; }
+    Release& getRelease(int i) noexcept                  { return releasing[static_cast<size_t>(i)]; }
+    void     removeRelease(int i) noexcept;
+
+    /** Any voice sounding. Lock-free, safe from the message thread. */
+    bool isPlaying() const noexcept { return playing.load(std::memory_order_relaxed); }
+
+    /** Publish isPlaying() after render/retire. Audio thread. */
+    void publish() noexcept { playing.store(numActive + numReleasing > 0, std::memory_order_relaxed); }
+
+    //==========================================================================
+    // Take envelope (fed while recording, used to find the quietest voice)
+
+    void clearEnvelope() noexcept;
+
+    /** Note the peak of a recorded block [pos, pos + numSamples). */
+    void noteRecordedPeak(juce::int64 pos, int numSamples, float peak) noexcept;
+
+private:
+    static constexpr int kEnvelopeShift = 10;     // 1024 frames per bin
+    static constexpr int kEnvelopeBins  = 2048;   // ~44 s at 48 kHz, later frames share the last bin
+
+    static int envelopeBin(juce::int64 pos) noexcept
+    {
+        return static_cast<int>(juce::jlimit<juce::int64>(0, kEnvelopeBins - 1, pos >> kEnvelopeShift));
+    }
+
+    float levelAt(juce::int64 pos) const noexcept;
+    int   findVictim() const noexcept;
+    void  removeVoice(int i) noexcept;
+
+    std::array<juce::int64, kMaxVoices>  positions {};
+    int numActive {0};
+
+    std::array<Release, kMaxReleasing>   releasing {};
+    int numReleasing {0};
+
+    std::array<float, kEnvelopeBins>     envelope {};
+
+    std::atomic<bool> playing {false};
+};
@@ -0,0 +1,347 @@
+#include "ParallelPluginScanner.h"
+#include <memory>
+#include <vector>
+
+//==============================================================================
+// PluginScanCache
+//==============================================================================
+
+PluginScanCache::PluginScanCache(juce::File cacheFile)
+    : file(std::move(cacheFile))
+{
+}
+
+bool PluginScanCache::load()
+{
+    entries.clear();
+
+    if (!file.existsAsFile())
+        return false;
+
+    auto xml = juce::parseXML(file);
+    if (!xml || !xml->hasTagName("PLUGINSCANCACHE"))
+        return false;
+
+    for (auto* e : xml->getChildWithTagNameIterator("FILE"))
+    {
+        Entry entry;
+        entry.modTime = e->getStringAttribute("modTime").getLargeIntValue();
+        entry.size    = e->getStringAttribute("size").getLargeIntValue();
+        entry.failed  = e->getBoolAttribute("failed");
+        entry.timedOut = e->getBoolAttribute("timedOut");
+
+        for (auto* p : e->getChildWithTagNameIterator("PLUGIN"))
+        {
+            juce::PluginDescription desc;
+            if (desc.loadFromXml(*p))
+                entry.types.add(desc);
+        }
+
+        entries[e->getStringAttribute("path")] = std::move(entry);
+    }
+
+    DBG("Plugin scan cache: " + juce::String(static_cast<int>(entries.size())) + " files");
+    return true;
+}
+
+bool PluginScanCache::save() const
+{
+    juce::XmlElement xml("PLUGINSCANCACHE");
+    xml.setAttribute("version", 1);
+
+    for (const auto& [path, entry] : entries)
+    {
+        auto* e = xml.createNewChildElement("FILE");
+        e->setAttribute("path",    path);
+        e->setAttribute("modTime", juce::String(entry.modTime));
+        e->setAttribute("size",    juce::String(entry.size));
+        e->setAttribute("failed",  entry.failed);
+        if (entry.timedOut)
+            e->setAttribute("timedOut", true);
+
+        for (const auto& desc : entry.types)
+            e->addChildElement(desc.createXml().release());
+    }
+
+    file.getParentDirectory().createDirectory();
+    return xml.writeTo(file);
+}
+
+PluginScanCache::Entry PluginScanCache::fingerprint(const juce::File& pluginFile)
+{
+    Entry entry;
+
+    if (pluginFile.isDirectory())
+    {
+        // VST3 bundle: any file inside may be the one that changed
+        for (const auto& f : pluginFile.findChildFiles(juce::File::findFiles, true))
+        {
+            entry.modTime = juce::jmax(entry.modTime, f.getLastModificationTime().toMilliseconds());
+            entry.size   += f.getSize();
+        }
+    }
+    else
+    {
+        entry.modTime = pluginFile.getLastModificationTime().toMilliseconds();
+        entry.size    = pluginFile.getSize();
+    }
+    return entry;
+}
+
+const PluginScanCache::Entry* PluginScanCache::findCurrent(const juce::String& pluginPath) const
+{
+    const auto it = entries.find(pluginPath);
+    if (it == entries.end())
+        return nullptr;
+
+    const auto now = fingerprint(juce::File(pluginPath));
+    if (now.modTime != it->second.modTime || now.size != it->second.size)
+        return nullptr;
+
+    return &it->second;
+}
+
+void PluginScanCache::store(const juce::String& pluginPath, Entry entry)
+{
+    entries[pluginPath] = std::move(entry);
+}
+
+void PluginScanCache::retainOnly(const juce::StringArray& pluginPaths)
+{
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        if (pluginPaths.contains(it->first))
+            ++it;
+        else
+            it = entries.erase(it);
+    }
+}
+
+//==============================================================================
+// ParallelPluginScanner
+//==============================================================================
+
+namespace
+{
+    struct ScanJob
+    {
+        juce::String                       pluginPath;
+        PluginScanCache::Entry             entry;     // fingerprint taken before the scan
+        juce::File                         outFile;
+        std::unique_ptr<juce::ChildProcess> process;
+        juce::uint32                       startedMs {0};
+    };
+
+    /** Read the descriptions a child wrote; false if the file is missing or broken. */
+    bool readChildResult(const juce::File& outFile, juce::Array<juce::PluginDescription>& types)
+    {
+        auto xml = juce::parseXML(outFile);
+        if (!xml || !xml->hasTagName("SCANRESULT"))
+            return false;
+
+        for (auto* p : xml->getChildWithTagNameIterator("PLUGIN"))
+        {
+            juce::PluginDescription desc;
+            if (desc.loadFromXml(*p))
+                types.add(desc);
+        }
+        return true;
+    }
+}
+
+int ParallelPluginScanner::getDefaultNumWorkers()
+{
+    return juce::jlimit(1, 8, juce::SystemStats::getNumCpus());
+}
+
+ParallelPluginScanner::ParallelPluginScanner(juce::AudioPluginFormat& f, PluginScanCache& c,
+                                             int workers, int timeout)
+    : format(f), cache(c)
+    , numWorkers(juce::jmax(1, workers))
+    , timeoutMs(juce::jmax(1000, timeout))
+{
+}
+
+ParallelPluginScanner::Result ParallelPluginScanner::scan(const juce::FileSearchPath& searchPaths,
+                                                          juce::KnownPluginList& list,
+                                                          bool pruneCache,
+                                                          ProgressCallback onProgress,
+                                                          std::function<bool()> shouldExit)
+{
+    Result result;
+
+    const auto pluginPaths = format.searchPathsForPlugins(searchPaths, true, false);
+    result.numFiles = pluginPaths.size();
+
+    // --- 1. Split into cached and to-scan (a timeout gets another chance) ---
+    std::vector<ScanJob> pending;
+    for (const auto& path : pluginPaths)
+    {
+        const auto* cached = cache.findCurrent(path);
+        if (cached == nullptr || cached->timedOut)
+        {
+            ScanJob job;
+            job.pluginPath = path;
+            job.entry      = PluginScanCache::fingerprint(juce::File(path));
+            pending.push_back(std::move(job));
+        }
+    }
+
+    DBG("Plugin scan: " + juce::String(result.numFiles) + " files, " +
+        juce::String(static_cast<int>(pending.size())) + " new or changed, " +
+        juce::String(numWorkers) + " workers");
+
+    // --- 2. Run up to numWorkers children at a time ---
+    const auto exe     = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+    const auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    const int  total   = static_cast<int>(pending.size());
+    size_t     next    = 0;
+    int        done    = 0;
+    std::vector<ScanJob> running;
+
+    auto finish = [&](ScanJob& job, bool ok, bool timedOut)
+    {
+        if (ok)
+            ok = readChildResult(job.outFile, job.entry.types);
+        job.entry.failed   = !ok;
+        job.entry.timedOut = timedOut;
+        job.outFile.deleteFile();
+
+        if (timedOut)
+            DBG("Plugin scan timed out (retried next scan): " + job.pluginPath);
+        else if (!ok)
+            DBG("Plugin scan failed: " + job.pluginPath);
+
+        cache.store(job.pluginPath, std::move(job.entry));
+        ++result.numScanned;
+        ++done;
+        if (onProgress)
+            onProgress(job.pluginPath, done, total);
+    };
+
+    while (next < pending.size() || !running.empty())
+    {
+        const bool exiting = shouldExit && shouldExit();
+
+        while (!exiting && next < pending.size() && static_cast<int>(running.size()) < numWorkers)
+        {
+            auto job    = std::move(pending[next++]);
+            job.outFile = tempDir.getNonexistentChildFile("chief_scan", ".xml", false);
+            job.outFile.create();
+            job.process = std::make_unique<juce::ChildProcess>();
+
+            const juce::StringArray args { exe.getFullPathName(),
+                                           "--scan-plugin", job.pluginPath,
+                                           "--scan-format", format.getName(),
+                                           "--scan-out",    job.outFile.getFullPathName() };
+
+            if (job.process->start(args, 0))
+            {
+                job.startedMs = juce::Time::getMillisecondCounter();
+                running.push_back(std::move(job));
+            }
+            else
+            {
+                finish(job, false, false);
+            }
+        }
+
+        for (auto it = running.begin(); it != running.end();)
+        {
+            auto& job = *it;
+            if (!job.process->isRunning())
+            {
+                finish(job, job.process->getExitCode() == 0, false);
+                it = running.erase(it);
+            }
+            else if (exiting || juce::Time::getMillisecondCounter() - job.startedMs > static_cast<juce::uint32>(timeoutMs))
+            {
+                job.process->kill();
+                if (exiting)
+                    job.outFile.deleteFile();   // not scanned — leave uncached for next time
+                else
+                    finish(job, false, true);
+                it = running.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+
+        if (exiting && running.empty())
+            break;
+
+        juce::Thread::sleep(20);
+    }
+
+    // --- 3. Publish everything the cache knows about these files ---
+    for (const auto& path : pluginPaths)
+    {
+        const auto* entry = cache.findCurrent(path);
+        if (entry == nullptr)
+            continue;
+
+        if (entry->failed)
+        {
+            list.addToBlacklist(path);
+            ++result.numFailed;
+            continue;
+        }
+
+        list.removeFromBlacklist(path);
+        for (const auto& desc : entry->types)
+            list.addType(desc);
+    }
+
+    if (pruneCache)
+        cache.retainOnly(pluginPaths);
+    cache.save();
+
+    DBG("Plugin scan complete: " + juce::String(result.numScanned) + " scanned, " +
+        juce::String(result.numFailed) + " failed, " +
+        juce::String(list.getNumTypes()) + " plugins known");
+
+    return result;
+}
+
+//==============================================================================
+// Child process
+//==============================================================================
+
+int ParallelPluginScanner::runChildProcess(const juce::StringArray& args)
+{
+    auto argAfter = [&args](const char* name)
+    {
+        const int i = args.indexOf(name);
+        return (i >= 0 && i + 1 < args.size()) ? args[i + 1] : juce::String();
+    };
+
+    const auto pluginPath = argAfter("--scan-plugin");
+    const auto formatName = argAfter("--scan-format");
+    const juce::File outFile(argAfter("--scan-out"));
+
+    if (pluginPath.isEmpty() || outFile == juce::File())
+        return 2;
+
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    juce::AudioPluginFormat* scanFormat = nullptr;
+    for (int i = 0; i < formatManager.getNumFormats(); ++i)
+        if (formatManager.getFormat(i)->getName() == formatName)
+            scanFormat = formatManager.getFormat(i);
+
+    if (scanFormat == nullptr)
+        return 3;
+
+    // If the plugin crashes here only this process dies — the parent marks it failed
+    juce::OwnedArray<juce::PluginDescription> found;
+    scanFormat->findAllTypesForFile(found, pluginPath);
+
+    juce::XmlElement xml("SCANRESULT");
+    for (auto* desc : found)
+        xml.addChildElement(desc->createXml().release());
+
+    return xml.writeTo(outFile) ? 0 : 4;
+}
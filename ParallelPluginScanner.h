@@ -0,0 +1,124 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <map>
+
+//==============================================================================
+/**
+ * @file ParallelPluginScanner.h
+ * @brief Out-of-process, concurrent plugin scanning with a persistent cache
+ *
+ * Every plugin file is scanned by a child process — chief started again with
+ * `--scan-plugin <file> --scan-format <name> --scan-out <xml>` — so a plugin
+ * that crashes or hangs during scanning only takes its own child down.  Up to
+ * numWorkers children run at the same time.
+ *
+ * Results are kept in PluginScanCache (next to KnownPlugins.xml), keyed by the
+ * plugin path and fingerprinted by modification time and size.  A rescan only
+ * starts children for files that are new or changed; everything else, including
+ * plugins that crashed or could not be opened before, comes straight from the
+ * cache.  A plugin that only timed out (a licence dialog, a slow disk) is
+ * blacklisted until the next scan, which tries it again.
+ */
+
+//==============================================================================
+/**
+ * @brief Scan results per plugin file, persisted as XML
+ *
+ * Not thread-safe — used by one scan at a time.
+ */
+class PluginScanCache
+{
+public:
+    struct Entry
+    {
+        juce::int64 modTime {0};       // ms since epoch (newest file for bundles)
+        juce::int64 size    {0};       // bytes (all files for bundles)
+        bool        failed  {false};   // crashed, timed out or could not be opened
+        bool        timedOut {false};  // failed only because it was killed — scanned again next time
+        juce::Array<juce::PluginDescription> types;
+    };
+
+    explicit PluginScanCache(juce::File cacheFile);
+
+    bool load();
+    bool save() const;
+
+    /** Fingerprint of a plugin file or bundle directory (types left empty). */
+    static Entry fingerprint(const juce::File& pluginFile);
+
+    /** Cached entry if the file has not changed since it was scanned, else nullptr (timed-out entries included). */
+    const Entry* findCurrent(const juce::String& pluginPath) const;
+
+    void store(const juce::String& pluginPath, Entry entry);
+
+    /** Drop entries for plugins that no longer exist in the search paths. */
+    void retainOnly(const juce::StringArray& pluginPaths);
+
+    const juce::File& getFile() const { return file; }
+
+private:
+    juce::File file;
+    std::map<juce::String, Entry> entries;
+};
+
+//==============================================================================
+/**
+ * @brief Runs a scan of one plugin format over a set of search paths
+ */
+class ParallelPluginScanner
+{
+public:
+    struct Result
+    {
+        int numFiles   {0};   // plugin files found in the search paths
+        int numScanned {0};   // files scanned by a child process this time
+        int numFailed  {0};   // files that failed (now or before, from the cache)
+    };
+
+    /** Called after every finished file: path, files done, files to scan. */
+    using ProgressCallback = std::function<void(const juce::String& pluginPath, int done, int total)>;
+
+    static constexpr int kDefaultTimeoutMs = 60000;
+
+    static int getDefaultNumWorkers();
+
+    ParallelPluginScanner(juce::AudioPluginFormat& format, PluginScanCache& cache,
+                          int numWorkers = getDefaultNumWorkers(),
+                          int timeoutMs  = kDefaultTimeoutMs);
+
+    /**
+     * @brief Scan the search paths and add every plugin (cached or new) to the list.
+     *
+     * Blocks until all children have finished; shouldExit is polled between
+     * them (remaining children are killed).  Failed files are added to the
+     * list's blacklist.  Saves the cache.
+     *
+     * @param pruneCache  Also drop cache entries not under the search paths (full scans).
+     */
+    Result scan(const juce::FileSearchPath& searchPaths,
+                juce::KnownPluginList& list,
+                bool pruneCache,
+                ProgressCallback onProgress = nullptr,
+                std::function<bool()> shouldExit = nullptr);
+
+    //==========================================================================
+    // Child process side
+
+    static bool isChildProcessRequest(const juce::String& commandLine)
+    {
+        return commandLine.contains("--scan-plugin");
+    }
+
+    /** Entry point of a scan child. Returns the process exit code. Message thread. */
+    static int runChildProcess(const juce::StringArray& args);
+
+private:
+    juce::AudioPluginFormat& format;
+    PluginScanCache&         cache;
+    const int                numWorkers;
+    const int                timeoutMs;
+
+    JUCE_DECLARE_NON_COPYABLE(ParallelPluginScanner)
+};
@@ -1,23 +1,21 @@
 #include "PluginHostWrapper.h"
+#include "ParallelPluginScanner.h"
 
 //==============================================================================
 PluginHostWrapper::PluginHostWrapper()
 {
     setupFormatManager();
-    
-    // Try to load previously scanned plugins
-    auto defaultFile = getDefaultPluginListFile();
-    if (defaultFile.existsAsFile())
-    {
-        loadKnownPluginList(defaultFile);
-    }
+
+    // The scanned plugin list is read by loadDefaultPluginList() — at startup
+    // on a pool thread, in parallel with the audio device
 }
 
 PluginHostWrapper::~PluginHostWrapper()
 {
-    // Save known plugins list on exit
+    // Save known plugins list on exit — but never overwrite a list that was not read
     auto defaultFile = getDefaultPluginListFile();
-    saveKnownPluginList(defaultFile);
+    if (listLoaded.load(std::memory_order_acquire) || !defaultFile.existsAsFile())
+        saveKnownPluginList(defaultFile);
 }
 
 //==============================================================================
@@ -104,23 +102,17 @@ int PluginHostWrapper::scanForPlugins(bool showProgress)
     
     DBG("Using format: " + vst3Format->getName());
     
-    // Scan for VST3 plugins
-    juce::PluginDirectoryScanner scanner(knownPlugins,
-                                         *vst3Format,
-                                         searchPaths,
-                                         true,   // Search recursively
-                                         juce::File());
-    
-    juce::String pluginBeingScanned;
-    
-    while (scanner.scanNextFile(true, pluginBeingScanned))
-    {
-        if (showProgress)
-        {
-            DBG("Scanning: " + pluginBeingScanned + 
-                " (" + juce::String(knownPlugins.getNumTypes()) + " found)");
-        }
-    }
+    // Scan out of process; unchanged files come from the cache
+    PluginScanCache cache(getScanCacheFile());
+    cache.load();
+
+    ParallelPluginScanner scanner(*vst3Format, cache);
+    scanner.scan(searchPaths, knownPlugins, true,
+                 [showProgress](const juce::String& pluginPath, int done, int total)
+                 {
+                     if (showProgress)
+                         DBG("Scanned (" + juce::String(done) + "/" + juce::String(total) + "): " + pluginPath);
+                 });
     
     DBG("Plugin scan complete. Found " + juce::String(knownPlugins.getNumTypes()) + " plugins");
     
@@ -151,17 +143,11 @@ int PluginHostWrapper::scanDirectory(const juce::File& directory)
     juce::FileSearchPath searchPaths;
     searchPaths.add(directory);
 
-    juce::PluginDirectoryScanner scanner(knownPlugins,
-                                         *vst3Format,
-                                         searchPaths,
-                                         true,
-                                         juce::File());
+    PluginScanCache cache(getScanCacheFile());
+    cache.load();
 
-    juce::String pluginBeingScanned;
-    while (scanner.scanNextFile(true, pluginBeingScanned))
-    {
-        DBG("Scanning: " + pluginBeingScanned);
-    }
+    ParallelPluginScanner scanner(*vst3Format, cache);
+    scanner.scan(searchPaths, knownPlugins, false);
 
     const int found = knownPlugins.getNumTypes() - before;
     DBG("Custom scan complete. Found " + juce::String(found) + " new plugins in " +
@@ -299,6 +285,21 @@ bool PluginHostWrapper::loadPluginState(juce::AudioPluginInstance* plugin,
     }
 }
 
+juce::MemoryBlock PluginStateSource::load() const
+{
+    juce::MemoryBlock block;
+    if (file != juce::File())
+    {
+        if (!file.loadFileAsData(block))
+            DBG("Plugin state file not readable: " + file.getFullPathName());
+    }
+    else if (base64.isNotEmpty())
+    {
+        block.fromBase64Encoding(base64);
+    }
+    return block;
+}
+
 juce::String PluginHostWrapper::memoryBlockToBase64(const juce::MemoryBlock& block)
 {
     return block.toBase64Encoding();
@@ -354,6 +355,14 @@ bool PluginHostWrapper::loadKnownPluginList(const juce::File& file)
     return true;
 }
 
+bool PluginHostWrapper::loadDefaultPluginList()
+{
+    const auto defaultFile = getDefaultPluginListFile();
+    const bool loaded = loadKnownPluginList(defaultFile);
+    listLoaded.store(true, std::memory_order_release);   // also when there is none yet
+    return loaded;
+}
+
 juce::File PluginHostWrapper::getDefaultPluginListFile() const
 {
     return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
@@ -361,6 +370,11 @@ juce::File PluginHostWrapper::getDefaultPluginListFile() const
         .getChildFile("KnownPlugins.xml");
 }
 
+juce::File PluginHostWrapper::getScanCacheFile() const
+{
+    return getDefaultPluginListFile().getSiblingFile("PluginScanCache.xml");
+}
+
 //==============================================================================
 // Utilities
 //==============================================================================
@@ -391,11 +405,13 @@ void PluginHostWrapper::addCustomVST3Path(const juce::File& path)
 
 PluginScanner::PluginScanner(juce::KnownPluginList& listToUpdate,
                              juce::AudioPluginFormatManager& formatManager,
-                             const juce::FileSearchPath& paths)
+                             const juce::FileSearchPath& paths,
+                             const juce::File& scanCacheFile)
     : juce::Thread("PluginScanner")
     , knownPlugins(listToUpdate)
     , formats(formatManager)
     , searchPaths(paths)
+    , cacheFile(scanCacheFile)
 {
 }
 
@@ -408,7 +424,10 @@ void PluginScanner::run()
 {
     // Note: knownPlugins should be cleared by caller before starting thread
     // We don't clear here to avoid race conditions
-    
+
+    PluginScanCache cache(cacheFile);
+    cache.load();
+
     for (int formatIdx = 0; formatIdx < formats.getNumFormats(); ++formatIdx)
     {
         if (threadShouldExit())
@@ -417,24 +436,24 @@ void PluginScanner::run()
         auto* format = formats.getFormat(formatIdx);
         if (!format) continue;
 
-        juce::PluginDirectoryScanner scanner(knownPlugins,
-                                             *format,
-                                             searchPaths,
-                                             true,
-                                             juce::File());
-        
-        juce::String pluginName;
-        
-        while (!threadShouldExit() && scanner.scanNextFile(true, pluginName))
-        {
-            {
-                juce::ScopedLock lock(currentPluginLock);
-                currentPluginName = pluginName;
-            }
-            
-            numFound.store(knownPlugins.getNumTypes(), std::memory_order_release);
-            progress.store(scanner.getProgress(), std::memory_order_release);
-        }
+        ParallelPluginScanner scanner(*format, cache);
+        scanner.scan(searchPaths, knownPlugins, false,
+                     [this, formatIdx](const juce::String& pluginPath, int done, int total)
+                     {
+                         {
+                             juce::ScopedLock lock(currentPluginLock);
+                             currentPluginName = pluginPath;
+                         }
+
+                         const float perFormat = 1.0f / static_cast<float>(formats.getNumFormats());
+                         numFound.store(knownPlugins.getNumTypes(), std::memory_order_release);
+                         progress.store(perFormat * (static_cast<float>(formatIdx) +
+                                                     static_cast<float>(done) / static_cast<float>(juce::jmax(1, total))),
+                                        std::memory_order_release);
+                     },
+                     [this] { return threadShouldExit(); });
+
+        numFound.store(knownPlugins.getNumTypes(), std::memory_order_release);
     }
     
     finished.store(true, std::memory_order_release);
@@ -2,6 +2,7 @@
 
 #include <JuceHeader.h>
 #include <memory>
+#include <atomic>
 #include <functional>
 
 /**
@@ -11,7 +12,7 @@
  * This class handles:
  * - Plugin scanning and discovery
  * - Async plugin loading
- * - Plugin state serialization (Base64)
+ * - Plugin state serialization (Base64, binary sidecar files)
  * - Plugin description management
  * - Known plugins list persistence
  */
@@ -25,6 +26,24 @@
 using PluginLoadCallback = std::function<void(std::unique_ptr<juce::AudioPluginInstance>, 
                                                const juce::String& errorMessage)>;
 
+//==============================================================================
+/**
+ * @brief Where a saved plugin state comes from: a binary sidecar file or inline Base64.
+ *
+ * Songs since format 1.2.0 keep each state in its own file next to song.json;
+ * older songs and templates carry it as Base64.  Nothing is read until load().
+ */
+struct PluginStateSource
+{
+    juce::File   file;     ///< Sidecar with the raw state (preferred when set)
+    juce::String base64;   ///< Inline state of older songs
+
+    bool isEmpty() const { return file == juce::File() && base64.isEmpty(); }
+
+    /** Read or decode the state. Any thread; empty block if the file is missing. */
+    juce::MemoryBlock load() const;
+};
+
 //==============================================================================
 /**
  * @brief VST3 Plugin host wrapper
@@ -50,6 +69,9 @@ public:
     
     /**
      * @brief Scan for available VST3 plugins
+     *
+     * Files are scanned in parallel child processes; only new or changed files
+     * are scanned again (see getScanCacheFile()).
      * @param showProgress If true, displays progress window
      * @return Number of plugins found
      */
@@ -164,12 +186,23 @@ public:
      * @return true if loaded successfully
      */
     bool loadKnownPluginList(const juce::File& file);
+
+    /**
+     * @brief Load the list from getDefaultPluginListFile() (any thread, once at startup)
+     * @return true if a list was found and loaded
+     */
+    bool loadDefaultPluginList();
     
     /**
      * @brief Get default file for known plugins list
      * @return File in app data directory
      */
     juce::File getDefaultPluginListFile() const;
+
+    /**
+     * @brief Per-file scan results (path + mtime + size), next to the plugin list
+     */
+    juce::File getScanCacheFile() const;
     
     //==========================================================================
     // Utilities
@@ -212,6 +245,9 @@ private:
     
     // Custom plugin paths
     juce::StringArray customVST3Paths;
+
+    // loadDefaultPluginList() ran: the destructor may write the list back
+    std::atomic<bool> listLoaded {false};
     
     //==========================================================================
     // Helper methods
@@ -233,14 +269,17 @@ private:
 /**
  * @brief Plugin scanner with progress reporting
  * 
- * Used for background plugin scanning with UI feedback
+ * Used for background plugin scanning with UI feedback.  Files are scanned
+ * out of process and in parallel (see ParallelPluginScanner); unchanged files
+ * come from the scan cache.
  */
 class PluginScanner : public juce::Thread
 {
 public:
     PluginScanner(juce::KnownPluginList& listToUpdate,
                  juce::AudioPluginFormatManager& formatManager,
-                 const juce::FileSearchPath& paths);
+                 const juce::FileSearchPath& paths,
+                 const juce::File& scanCacheFile);
     
     ~PluginScanner() override;
     
@@ -256,6 +295,7 @@ private:
     juce::KnownPluginList& knownPlugins;
     juce::AudioPluginFormatManager& formats;
     juce::FileSearchPath searchPaths;
+    juce::File cacheFile;
     
     std::atomic<float> progress{0.0f};
     std::atomic<int> numFound{0};
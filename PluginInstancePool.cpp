@@ -0,0 +1,141 @@
+#include "PluginInstancePool.h"
+
+//==============================================================================
+PluginInstancePool::PluginInstancePool(int maxIdleInstances)
+    : maxIdle(juce::jmax(0, maxIdleInstances))
+    , workers(juce::ThreadPoolOptions{}
+                  .withThreadName("Plugin State")
+                  .withNumberOfThreads(1))
+{
+}
+
+PluginInstancePool::~PluginInstancePool()
+{
+    // A state restore in progress cannot be interrupted — wait for it
+    workers.removeAllJobs(true, 10000);
+    clear();
+}
+
+juce::String PluginInstancePool::identifierOf(const juce::AudioPluginInstance& instance)
+{
+    return instance.getPluginDescription().createIdentifierString();
+}
+
+//==============================================================================
+void PluginInstancePool::park(Instance instance)
+{
+    if (!instance) return;
+
+    Instance evicted;
+    {
+        const juce::ScopedLock sl(idleLock);
+        idle.push_back({ identifierOf(*instance), std::move(instance) });
+
+        if (static_cast<int>(idle.size()) > maxIdle)
+        {
+            evicted = std::move(idle.front().instance);
+            idle.erase(idle.begin());
+        }
+    }
+
+    if (evicted)
+    {
+        DBG("PluginInstancePool: evicting " + evicted->getName());
+        destroy(std::move(evicted));
+    }
+}
+
+PluginInstancePool::Instance PluginInstancePool::take(const juce::String& identifier)
+{
+    const juce::ScopedLock sl(idleLock);
+
+    // Newest first — the most recently used instance is the warmest
+    for (auto it = idle.rbegin(); it != idle.rend(); ++it)
+    {
+        if (it->identifier == identifier)
+        {
+            auto instance = std::move(it->instance);
+            idle.erase(std::next(it).base());
+            return instance;
+        }
+    }
+    return nullptr;
+}
+
+//==============================================================================
+void PluginInstancePool::restoreStateAsync(Instance instance, std::shared_future<juce::MemoryBlock> state,
+                                           ReadyCallback onReady)
+{
+    jassert(instance != nullptr);
+
+    // std::function needs copyable captures — the instance travels in a shared holder
+    struct Handoff
+    {
+        Instance                               instance;
+        std::shared_future<juce::MemoryBlock> state;
+        bool                                   restored {false};
+    };
+
+    auto handoff = std::make_shared<Handoff>();
+    handoff->instance = std::move(instance);
+    handoff->state    = std::move(state);
+
+    juce::WeakReference<PluginInstancePool> weakThis(this);
+
+    workers.addJob([handoff, weakThis, onReady]
+    {
+        // Usually read long ago — instance creation is the slow part
+        const juce::MemoryBlock* block = nullptr;
+        try   { if (handoff->state.valid()) block = &handoff->state.get(); }
+        catch (...) {}   // reader shut down before it got to this state
+        if (block != nullptr && !block->isEmpty())
+        {
+            try
+            {
+                handoff->instance->setStateInformation(block->getData(),
+                                                       static_cast<int>(block->getSize()));
+                handoff->restored = true;
+            }
+            catch (...)
+            {
+                DBG("PluginInstancePool: state restore failed — " + handoff->instance->getName());
+            }
+        }
+
+        juce::MessageManager::callAsync([handoff, weakThis, onReady]
+        {
+            if (weakThis == nullptr)
+            {
+                destroy(std::move(handoff->instance));
+                return;
+            }
+            onReady(std::move(handoff->instance), handoff->restored);
+        });
+    });
+}
+
+//==============================================================================
+void PluginInstancePool::clear()
+{
+    std::vector<Idle> toDestroy;
+    {
+        const juce::ScopedLock sl(idleLock);
+        toDestroy.swap(idle);
+    }
+
+    for (auto& entry : toDestroy)
+        destroy(std::move(entry.instance));
+}
+
+int PluginInstancePool::getNumIdle() const
+{
+    const juce::ScopedLock sl(idleLock);
+    return static_cast<int>(idle.size());
+}
+
+void PluginInstancePool::destroy(Instance instance)
+{
+    // Parked instances are still prepared from their last channel
+    if (instance)
+        instance->releaseResources();
+}
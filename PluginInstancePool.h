@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <future>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file PluginInstancePool.h
+ * @brief Keeps plugin instances alive between songs so a song switch can reuse them
+ *
+ * Creating a heavy sampler takes seconds; pushing a new state into an instance
+ * that already exists is usually much cheaper.  Instead of destroying plugins
+ * that are replaced or removed, the engine parks them here, keyed by their
+ * PluginDescription identifier.  The next load of the same plugin takes an idle
+ * instance out of the pool and restores its saved state on the pool's worker
+ * thread; the instance is handed back on the message thread, ready to be
+ * installed into a channel (which prepares it for the audio thread).
+ *
+ * The pool holds at most maxIdle instances — the oldest is destroyed first.
+ *
+ * Thread-safety:
+ *   Message thread: park(), take(), restoreStateAsync(), clear()
+ *   Worker thread : setStateInformation() of instances in flight
+ */
+class PluginInstancePool
+{
+public:
+    using Instance      = std::unique_ptr<juce::AudioPluginInstance>;
+    using ReadyCallback = std::function<void(Instance, bool stateRestored)>;
+
+    static constexpr int kDefaultMaxIdle = 8;
+
+    explicit PluginInstancePool(int maxIdleInstances = kDefaultMaxIdle);
+    ~PluginInstancePool();
+
+    /** Identifier an instance is pooled under (matches KnownPluginList identifiers). */
+    static juce::String identifierOf(const juce::AudioPluginInstance& instance);
+
+    /** Keep an instance for reuse. Null is ignored. */
+    void park(Instance instance);
+
+    /** Take an idle instance of this plugin, or nullptr if none is parked. */
+    Instance take(const juce::String& identifier);
+
+    /**
+     * @brief Restore state on the worker thread, then call onReady on the message thread.
+     *
+     * The state may still be on its way (read from disk while the instance was
+     * created); the worker waits for it.  If the pool is destroyed first the
+     * instance is destroyed and onReady is never called.
+     */
+    void restoreStateAsync(Instance instance, std::shared_future<juce::MemoryBlock> state,
+                           ReadyCallback onReady);
+
+    /** Destroy all idle instances. */
+    void clear();
+
+    int getNumIdle() const;
+
+private:
+    struct Idle
+    {
+        juce::String identifier;
+        Instance     instance;
+    };
+
+    const int maxIdle;
+    std::vector<Idle> idle;              // oldest first
+    mutable juce::CriticalSection idleLock;
+    juce::ThreadPool workers;
+
+    static void destroy(Instance instance);
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE(PluginInstancePool)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PluginInstancePool)
+};
@@ -0,0 +1,152 @@
+#include "PolyphaseResampler.h"
+#include <cmath>
+
+namespace
+{
+    double besselI0(double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+        for (int k = 1; k < 50; ++k)
+        {
+            term *= (x / (2.0 * k)) * (x / (2.0 * k));
+            sum  += term;
+            if (term < sum * 1.0e-12) break;
+        }
+        return sum;
+    }
+
+    struct QualitySettings { int taps; int phases; double rolloff; double beta; };
+
+    QualitySettings settingsFor(PolyphaseResampler::Quality q) noexcept
+    {
+        switch (q)
+        {
+            case PolyphaseResampler::Quality::Fast:   return { 16, 128, 0.90,  6.0 };
+            case PolyphaseResampler::Quality::Best:   return { 64, 512, 0.97, 10.0 };
+            case PolyphaseResampler::Quality::Normal: break;
+        }
+        return { 32, 256, 0.94, 8.0 };
+    }
+}
+
+//==============================================================================
+PolyphaseResampler::PolyphaseResampler(double source, double target, Quality quality)
+    : sourceRate(source), targetRate(target)
+{
+    jassert(sourceRate > 0.0 && targetRate > 0.0);
+    buildTable(quality);
+}
+
+void PolyphaseResampler::buildTable(Quality quality)
+{
+    const auto q = settingsFor(quality);
+
+    // Downsampling: lower cutoff, and a filter that is wider by the same factor
+    const double ratio  = targetRate / sourceRate;
+    const double scale  = juce::jmin(1.0, ratio);
+    const double cutoff = 0.5 * scale * q.rolloff;          // cycles per input sample
+    const int    widen  = static_cast<int>(std::ceil(1.0 / scale));
+
+    numTaps   = q.taps * widen;
+    numPhases = q.phases;
+    table.assign(static_cast<size_t>((numPhases + 1) * numTaps), 0.0f);
+
+    const int    half   = numTaps / 2;
+    const double i0Beta = besselI0(q.beta);
+
+    for (int p = 0; p <= numPhases; ++p)
+    {
+        const double frac = static_cast<double>(p) / numPhases;
+        float* row = table.data() + static_cast<size_t>(p * numTaps);
+        double sum = 0.0;
+
+        for (int k = 0; k < numTaps; ++k)
+        {
+            // Distance from the output position to input sample (base + k - half + 1)
+            const double t = static_cast<double>(k - half + 1) - frac;
+            const double x = 2.0 * cutoff * t;
+            const double sinc = (std::abs(x) < 1.0e-9) ? 1.0
+                              : std::sin(juce::MathConstants<double>::pi * x) / (juce::MathConstants<double>::pi * x);
+
+            const double w = t / half;
+            const double window = (std::abs(w) >= 1.0) ? 0.0
+                                : besselI0(q.beta * std::sqrt(1.0 - w * w)) / i0Beta;
+
+            const double c = 2.0 * cutoff * sinc * window;
+            row[k] = static_cast<float>(c);
+            sum   += c;
+        }
+
+        // Unity gain at DC for every phase
+        if (sum != 0.0)
+            for (int k = 0; k < numTaps; ++k)
+                row[k] = static_cast<float>(row[k] / sum);
+    }
+}
+
+//==============================================================================
+juce::int64 PolyphaseResampler::scaleLength(juce::int64 numSamples, double source, double target) noexcept
+{
+    if (numSamples <= 0 || source <= 0.0 || target <= 0.0) return numSamples;
+    return static_cast<juce::int64>(std::llround(static_cast<double>(numSamples) * target / source));
+}
+
+juce::int64 PolyphaseResampler::getOutputLength(juce::int64 numInputSamples) const noexcept
+{
+    return scaleLength(numInputSamples, sourceRate, targetRate);
+}
+
+void PolyphaseResampler::process(const float* input, juce::int64 numInput,
+                                 float* output, juce::int64 numOutput, bool wrap) const noexcept
+{
+    if (numInput <= 0 || numOutput <= 0) return;
+
+    const double step = sourceRate / targetRate;   // input samples per output sample
+    const int    half = numTaps / 2;
+
+    for (juce::int64 i = 0; i < numOutput; ++i)
+    {
+        const double      pos  = static_cast<double>(i) * step;
+        const juce::int64 base = static_cast<juce::int64>(pos);
+        const double      ph   = (pos - static_cast<double>(base)) * numPhases;
+        const int         p0   = juce::jmin(numPhases - 1, static_cast<int>(ph));
+        const float       mix  = static_cast<float>(ph - p0);
+
+        const float* c0 = table.data() + static_cast<size_t>(p0 * numTaps);
+        const float* c1 = c0 + numTaps;
+
+        const juce::int64 first = base - half + 1;
+        float acc0 = 0.0f, acc1 = 0.0f;
+
+        if (first >= 0 && first + numTaps <= numInput)
+        {
+            // Fast path: whole filter inside the buffer
+            const float* in = input + first;
+            for (int k = 0; k < numTaps; ++k)
+            {
+                acc0 += in[k] * c0[k];
+                acc1 += in[k] * c1[k];
+            }
+        }
+        else
+        {
+            for (int k = 0; k < numTaps; ++k)
+            {
+                juce::int64 idx = first + k;
+                if (wrap)
+                {
+                    idx %= numInput;
+                    if (idx < 0) idx += numInput;
+                }
+                else if (idx < 0 || idx >= numInput)
+                {
+                    continue;
+                }
+                acc0 += input[idx] * c0[k];
+                acc1 += input[idx] * c1[k];
+            }
+        }
+
+        output[i] = acc0 + (acc1 - acc0) * mix;
+    }
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file PolyphaseResampler.h
+ * @brief Windowed-sinc sample rate conversion for loop files
+ *
+ * Converts whole buffers from one sample rate to another with a bank of
+ * Kaiser-windowed sinc filters (one per fractional phase, coefficients
+ * interpolated between neighbouring phases).  When converting down, the
+ * cutoff follows the target rate so nothing aliases.
+ *
+ * Loops are cyclic: with wrap = true the filter reads across the loop end
+ * into the start (and vice versa), so the converted loop stays seamless.
+ *
+ * Immutable after construction — one instance can be shared by several
+ * threads converting different files.
+ */
+class PolyphaseResampler
+{
+public:
+    enum class Quality
+    {
+        Fast   = 0,   // 16 taps — previews, very long songs
+        Normal,       // 32 taps
+        Best          // 64 taps, steepest rolloff
+    };
+
+    PolyphaseResampler(double sourceRate, double targetRate, Quality quality);
+
+    /** Output length for numInputSamples (same rounding everywhere lengths are scaled). */
+    juce::int64 getOutputLength(juce::int64 numInputSamples) const noexcept;
+
+    /** Scale a length in samples from the source to the target rate. */
+    static juce::int64 scaleLength(juce::int64 numSamples, double sourceRate, double targetRate) noexcept;
+
+    /** Convert one channel: numOutput = getOutputLength(numInput). */
+    void process(const float* input, juce::int64 numInput,
+                 float* output, juce::int64 numOutput, bool wrap) const noexcept;
+
+    double getSourceRate() const noexcept { return sourceRate; }
+    double getTargetRate() const noexcept { return targetRate; }
+
+private:
+    const double sourceRate, targetRate;
+    int numTaps   {0};                 // per phase, even
+    int numPhases {0};
+    std::vector<float> table;          // (numPhases + 1) rows of numTaps coefficients
+
+    void buildTable(Quality quality);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PolyphaseResampler)
+};
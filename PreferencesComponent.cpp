@@ -6,17 +6,74 @@ static const juce::Colour sectionColour { 0xFF2A2A2A };
 static const juce::Colour accentColour  { 0xFF4A8FCC };
 static const juce::Colour mutedColour   { 0xFF3A3A3A };
 
+// Locked loop memory choices in MB; item id = index + 1
+static const int lockedMemoryChoicesMb[] = { 0, 256, 512, 1024, 2048, 4096 };
+
 //==============================================================================
 PreferencesComponent::PreferencesComponent(MidiLearnManager& mlm,
                                            std::function<bool()>    getAutoRecall,
                                            std::function<void(bool)> setAutoRecall,
                                            std::function<juce::String()>            getMasterRecordPath,
-                                           std::function<void(const juce::String&)> setMasterRecordPath)
+                                           std::function<void(const juce::String&)> setMasterRecordPath,
+                                           std::function<bool()>    getParallelProcessing,
+                                           std::function<void(bool)> setParallelProcessing,
+                                           std::function<int()>      getUndoDepth,
+                                           std::function<void(int)>  setUndoDepth,
+                                           std::function<bool()>    getFlushDenormals,
+                                           std::function<void(bool)> setFlushDenormals,
+                                           std::function<bool()>    getPackSections,
+                                           std::function<void(bool)> setPackSections,
+                                           std::function<int()>      getLockedMemoryMb,
+                                           std::function<void(int)>  setLockedMemoryMb,
+                                           std::function<bool()>    getRecordStems,
+                                           std::function<void(bool)> setRecordStems,
+                                           std::function<int()>      getNumChannels,
+                                           std::function<void(int)>  setNumChannels,
+                                           std::function<int()>      getRecordLatency,
+                                           std::function<void(int)>  setRecordLatency,
+                                           std::function<void()>     startLatencyMeasurement,
+                                           std::function<int()>      pollLatencyMeasurement,
+                                           std::function<juce::String()>              getMidiClockOutput,
+                                           std::function<juce::Result(const juce::String&)> setMidiClockOutput,
+                                           std::function<MidiClockGenerator::Stats()> getMidiClockStats,
+                                           std::function<juce::String()>              getMetricsTarget,
+                                           std::function<juce::Result(const juce::String&)> setMetricsTarget,
+                                           std::function<int()>      getResampleQuality,
+                                           std::function<void(int)>  setResampleQuality,
+                                           std::function<juce::String()>              getWorkerCores,
+                                           std::function<juce::Result(const juce::String&)> setWorkerCores)
     : midiLearnManager(mlm)
     , autoRecallGetter(std::move(getAutoRecall))
     , autoRecallSetter(std::move(setAutoRecall))
     , masterRecordPathGetter(std::move(getMasterRecordPath))
     , masterRecordPathSetter(std::move(setMasterRecordPath))
+    , parallelProcessingGetter(std::move(getParallelProcessing))
+    , parallelProcessingSetter(std::move(setParallelProcessing))
+    , undoDepthGetter(std::move(getUndoDepth))
+    , undoDepthSetter(std::move(setUndoDepth))
+    , flushDenormalsGetter(std::move(getFlushDenormals))
+    , flushDenormalsSetter(std::move(setFlushDenormals))
+    , packSectionsGetter(std::move(getPackSections))
+    , packSectionsSetter(std::move(setPackSections))
+    , lockedMemoryGetter(std::move(getLockedMemoryMb))
+    , lockedMemorySetter(std::move(setLockedMemoryMb))
+    , recordStemsGetter(std::move(getRecordStems))
+    , recordStemsSetter(std::move(setRecordStems))
+    , numChannelsGetter(std::move(getNumChannels))
+    , numChannelsSetter(std::move(setNumChannels))
+    , recordLatencyGetter(std::move(getRecordLatency))
+    , recordLatencySetter(std::move(setRecordLatency))
+    , latencyMeasureStarter(std::move(startLatencyMeasurement))
+    , latencyMeasurePoller(std::move(pollLatencyMeasurement))
+    , midiClockOutputGetter(std::move(getMidiClockOutput))
+    , midiClockOutputSetter(std::move(setMidiClockOutput))
+    , midiClockStatsGetter(std::move(getMidiClockStats))
+    , metricsTargetGetter(std::move(getMetricsTarget))
+    , metricsTargetSetter(std::move(setMetricsTarget))
+    , resampleQualityGetter(std::move(getResampleQuality))
+    , resampleQualitySetter(std::move(setResampleQuality))
+    , workerCoresGetter(std::move(getWorkerCores))
+    , workerCoresSetter(std::move(setWorkerCores))
 {
     //--------------------------------------------------------------------------
     // Section header: MIDI Learn Mode
@@ -54,6 +111,45 @@ PreferencesComponent::PreferencesComponent(MidiLearnManager& mlm,
 
     updateMidiLearnModeButtons();
 
+    // MIDI clock out: "Off" plus every output present now
+    midiClockLabel.setFont(juce::Font(12.0f));
+    midiClockLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    midiClockStatsLabel.setFont(juce::Font(11.0f));
+    midiClockStatsLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+
+    midiClockBox.addItem("Off", 1);
+    const auto current = midiClockOutputGetter ? midiClockOutputGetter() : juce::String();
+    for (const auto& device : juce::MidiOutput::getAvailableDevices())
+    {
+        midiClockIdentifiers.add(device.identifier);
+        midiClockBox.addItem(device.name, midiClockIdentifiers.size() + 1);
+    }
+    midiClockBox.setSelectedId(midiClockIdentifiers.indexOf(current) + 2, juce::dontSendNotification);
+    midiClockBox.setTooltip("Send MIDI clock (24 PPQN), song position and start/stop to slaved gear. "
+                            "The tempo follows the metronome, fitted to the loop so it stays locked "
+                            "across loop wraps.");
+    midiClockBox.onChange = [this]
+    {
+        const int index = midiClockBox.getSelectedId() - 2;
+        const auto id   = juce::isPositiveAndBelow(index, midiClockIdentifiers.size())
+                        ? midiClockIdentifiers[index] : juce::String();
+        const auto result = midiClockOutputSetter ? midiClockOutputSetter(id) : juce::Result::ok();
+        if (result.failed())
+        {
+            midiClockBox.setSelectedId(1, juce::dontSendNotification);
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "MIDI Clock", result.getErrorMessage());
+        }
+        updateMidiClockStats();
+    };
+    if (midiClockOutputGetter && midiClockOutputSetter)
+    {
+        addAndMakeVisible(midiClockLabel);
+        addAndMakeVisible(midiClockBox);
+        addAndMakeVisible(midiClockStatsLabel);
+        if (midiClockStatsGetter)
+            pollMidiClockStats();
+    }
+
     //--------------------------------------------------------------------------
     // Section header: Session
     sectionSessionLabel.setText("Session", juce::dontSendNotification);
@@ -70,6 +166,233 @@ PreferencesComponent::PreferencesComponent(MidiLearnManager& mlm,
     };
     addAndMakeVisible(autoRecallButton);
 
+    //--------------------------------------------------------------------------
+    // Section header: Engine
+    sectionEngineLabel.setText("Engine", juce::dontSendNotification);
+    sectionEngineLabel.setFont(juce::Font(14.0f, juce::Font::bold));
+    sectionEngineLabel.setColour(juce::Label::textColourId, juce::Colours::white);
+    addAndMakeVisible(sectionEngineLabel);
+
+    parallelProcessingButton.setTooltip("Spread channel and plugin processing over several CPU cores. "
+                                        "Helps with many plugins at small buffer sizes.");
+    parallelProcessingButton.setToggleState(parallelProcessingGetter ? parallelProcessingGetter() : false,
+                                            juce::dontSendNotification);
+    parallelProcessingButton.onClick = [this]
+    {
+        if (parallelProcessingSetter)
+            parallelProcessingSetter(parallelProcessingButton.getToggleState());
+    };
+    addAndMakeVisible(parallelProcessingButton);
+
+    // Render worker pinning; applied on Return or when the field loses focus
+    workerCoresLabel.setFont(juce::Font(12.0f));
+    workerCoresLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+
+    workerCoresEditor.setFont(juce::Font(12.0f));
+    workerCoresEditor.setTextToShowWhenEmpty("any (e.g. 2-5)", juce::Colour(0xFF777777));
+    workerCoresEditor.setText(workerCoresGetter ? workerCoresGetter() : juce::String(),
+                              juce::dontSendNotification);
+    workerCoresEditor.setTooltip("Pin the parallel render workers to these CPU cores, one worker each. "
+                                 "Only useful with cores the audio driver and the OS leave free. "
+                                 "Leave empty to let the OS place them.");
+    auto applyWorkerCores = [this]
+    {
+        if (!workerCoresSetter || !workerCoresGetter) return;
+        const auto text = workerCoresEditor.getText().trim();
+        if (text == workerCoresGetter()) return;
+
+        const auto result = workerCoresSetter(text);
+        if (result.failed())
+        {
+            workerCoresEditor.setText(workerCoresGetter(), juce::dontSendNotification);
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Worker Cores",
+                                                   result.getErrorMessage());
+        }
+    };
+    workerCoresEditor.onReturnKey = applyWorkerCores;
+    workerCoresEditor.onFocusLost = applyWorkerCores;
+    if (workerCoresGetter && workerCoresSetter)
+    {
+        addAndMakeVisible(workerCoresLabel);
+        addAndMakeVisible(workerCoresEditor);
+    }
+
+    flushDenormalsButton.setTooltip("Treat tiny floating point values as zero while rendering. "
+                                    "Prevents CPU spikes when reverb tails and loops fade out.");
+    flushDenormalsButton.setToggleState(flushDenormalsGetter ? flushDenormalsGetter() : true,
+                                        juce::dontSendNotification);
+    flushDenormalsButton.onClick = [this]
+    {
+        if (flushDenormalsSetter)
+            flushDenormalsSetter(flushDenormalsButton.getToggleState());
+    };
+    addAndMakeVisible(flushDenormalsButton);
+
+    packSectionsButton.setTooltip("Sections that have not played for a while are packed losslessly "
+                                  "and unpacked when you select them. Saves RAM with large shows.");
+    packSectionsButton.setToggleState(packSectionsGetter ? packSectionsGetter() : true,
+                                      juce::dontSendNotification);
+    packSectionsButton.onClick = [this]
+    {
+        if (packSectionsSetter)
+            packSectionsSetter(packSectionsButton.getToggleState());
+    };
+    addAndMakeVisible(packSectionsButton);
+
+    undoDepthLabel.setFont(juce::Font(12.0f));
+    undoDepthLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    addAndMakeVisible(undoDepthLabel);
+
+    // Item id == depth. Older layers are merged into the base loop in the background.
+    for (int depth : { 2, 4, 8, 16, 24 })
+        undoDepthBox.addItem(juce::String(depth) + " layers", depth);
+    undoDepthBox.setTooltip("Number of recent overdubs that stay undoable. Older overdubs are "
+                            "merged into the loop to keep playback light.");
+    undoDepthBox.setSelectedId(undoDepthGetter ? undoDepthGetter() : 8, juce::dontSendNotification);
+    undoDepthBox.onChange = [this]
+    {
+        if (undoDepthSetter && undoDepthBox.getSelectedId() > 0)
+            undoDepthSetter(undoDepthBox.getSelectedId());
+    };
+    addAndMakeVisible(undoDepthBox);
+
+    lockedMemoryLabel.setFont(juce::Font(12.0f));
+    lockedMemoryLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    addAndMakeVisible(lockedMemoryLabel);
+
+    const int currentLockMb = lockedMemoryGetter ? lockedMemoryGetter() : 1024;
+    for (int i = 0; i < juce::numElementsInArray(lockedMemoryChoicesMb); ++i)
+    {
+        const int mb = lockedMemoryChoicesMb[i];
+        lockedMemoryBox.addItem(mb == 0 ? juce::String("Off")
+                                        : (mb >= 1024 ? juce::String(mb / 1024) + " GB" : juce::String(mb) + " MB"),
+                                i + 1);
+        if (mb == currentLockMb)
+            lockedMemoryBox.setSelectedId(i + 1, juce::dontSendNotification);
+    }
+    lockedMemoryBox.setTooltip("Loop audio up to this size is locked in RAM so the system cannot "
+                               "swap out a section that has been idle. Needs enough locked-memory "
+                               "allowance from the OS (ulimit -l on Linux/macOS).");
+    lockedMemoryBox.onChange = [this]
+    {
+        const int id = lockedMemoryBox.getSelectedId();
+        if (lockedMemorySetter && id > 0)
+            lockedMemorySetter(lockedMemoryChoicesMb[id - 1]);
+    };
+    addAndMakeVisible(lockedMemoryBox);
+
+    // Item id == channel count. The engine is sized for it at startup only.
+    numChannelsLabel.setFont(juce::Font(12.0f));
+    numChannelsLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    for (int n : { 2, 4, 6, 8, 12, 16 })
+        numChannelsBox.addItem(juce::String(n) + " channels", n);
+    numChannelsBox.setTooltip("Number of looper channels. Takes effect at the next start.");
+    numChannelsBox.setSelectedId(numChannelsGetter ? numChannelsGetter() : 6, juce::dontSendNotification);
+    numChannelsBox.onChange = [this]
+    {
+        if (numChannelsSetter && numChannelsBox.getSelectedId() > 0)
+            numChannelsSetter(numChannelsBox.getSelectedId());
+    };
+    if (numChannelsGetter)
+    {
+        addAndMakeVisible(numChannelsLabel);
+        addAndMakeVisible(numChannelsBox);
+    }
+
+    // Item id == quality + 1. Converted copies are kept per quality, so a change reconverts.
+    resampleQualityLabel.setFont(juce::Font(12.0f));
+    resampleQualityLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    resampleQualityBox.addItem("Fast (16 taps)",   1);
+    resampleQualityBox.addItem("Normal (32 taps)", 2);
+    resampleQualityBox.addItem("Best (64 taps)",   3);
+    resampleQualityBox.setTooltip("Filter used to convert songs recorded at another sample rate. "
+                                  "Takes effect the next time such a song is loaded.");
+    resampleQualityBox.setSelectedId((resampleQualityGetter ? resampleQualityGetter() : 1) + 1,
+                                     juce::dontSendNotification);
+    resampleQualityBox.onChange = [this]
+    {
+        if (resampleQualitySetter && resampleQualityBox.getSelectedId() > 0)
+            resampleQualitySetter(resampleQualityBox.getSelectedId() - 1);
+    };
+    if (resampleQualityGetter)
+    {
+        addAndMakeVisible(resampleQualityLabel);
+        addAndMakeVisible(resampleQualityBox);
+    }
+
+    // Round trip moved off recordings; -1 shows as "Driver" (input + output as reported)
+    recordLatencyLabel.setFont(juce::Font(12.0f));
+    recordLatencyLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+    addAndMakeVisible(recordLatencyLabel);
+
+    recordLatencySlider.setSliderStyle(juce::Slider::IncDecButtons);
+    recordLatencySlider.setTextBoxStyle(juce::Slider::TextBoxLeft, false, 80, 22);
+    recordLatencySlider.setRange(-1.0, 16384.0, 1.0);
+    recordLatencySlider.textFromValueFunction = [](double v)
+    {
+        return v < 0.0 ? juce::String("Driver") : juce::String(static_cast<int>(v)) + " smp";
+    };
+    recordLatencySlider.valueFromTextFunction = [](const juce::String& text)
+    {
+        return text.trim().equalsIgnoreCase("driver") ? -1.0 : text.getDoubleValue();
+    };
+    recordLatencySlider.setValue(recordLatencyGetter ? recordLatencyGetter() : -1, juce::dontSendNotification);
+    recordLatencySlider.setTooltip("Interface round trip taken off recordings and overdubs so they land "
+                                   "where you heard the loop. \"Driver\" uses the latency the audio "
+                                   "driver reports; type a value or measure it if takes still land late.");
+    recordLatencySlider.onValueChange = [this]
+    {
+        if (recordLatencySetter)
+            recordLatencySetter(static_cast<int>(recordLatencySlider.getValue()));
+    };
+    addAndMakeVisible(recordLatencySlider);
+
+    measureLatencyButton.setTooltip("Connect the metronome output to the active channel's input, then "
+                                    "click: a short pulse is sent and timed on its way back.");
+    measureLatencyButton.onClick = [this]
+    {
+        if (!latencyMeasureStarter) return;
+        latencyMeasureStarter();
+        measureLatencyButton.setEnabled(false);
+        measureLatencyButton.setButtonText("...");
+        pollLatencyMeasurement();
+    };
+    if (latencyMeasureStarter && latencyMeasurePoller)
+        addAndMakeVisible(measureLatencyButton);
+
+    // Engine counters to a collector over UDP; applied on Return or when the field loses focus
+    metricsTargetLabel.setFont(juce::Font(12.0f));
+    metricsTargetLabel.setColour(juce::Label::textColourId, juce::Colour(0xFFAAAAAA));
+
+    metricsTargetEditor.setFont(juce::Font(12.0f));
+    metricsTargetEditor.setTextToShowWhenEmpty("off (host:port)", juce::Colour(0xFF777777));
+    metricsTargetEditor.setText(metricsTargetGetter ? metricsTargetGetter() : juce::String(),
+                                juce::dontSendNotification);
+    metricsTargetEditor.setTooltip("Send xruns, callback timing, command queue, channel states, loop memory "
+                                   "and disk backlog as OSC bundles over UDP, once a second. "
+                                   "Leave empty to turn it off.");
+    auto applyMetricsTarget = [this]
+    {
+        if (!metricsTargetSetter || !metricsTargetGetter) return;
+        const auto text = metricsTargetEditor.getText().trim();
+        if (text == metricsTargetGetter()) return;
+
+        const auto result = metricsTargetSetter(text);
+        if (result.failed())
+        {
+            metricsTargetEditor.setText(metricsTargetGetter(), juce::dontSendNotification);
+            juce::AlertWindow::showMessageBoxAsync(juce::AlertWindow::WarningIcon, "Metrics Export",
+                                                   result.getErrorMessage());
+        }
+    };
+    metricsTargetEditor.onReturnKey = applyMetricsTarget;
+    metricsTargetEditor.onFocusLost = applyMetricsTarget;
+    if (metricsTargetGetter && metricsTargetSetter)
+    {
+        addAndMakeVisible(metricsTargetLabel);
+        addAndMakeVisible(metricsTargetEditor);
+    }
+
     //--------------------------------------------------------------------------
     // Section header: Paths
     sectionPathsLabel.setText("Paths", juce::dontSendNotification);
@@ -101,6 +424,17 @@ PreferencesComponent::PreferencesComponent(MidiLearnManager& mlm,
     };
     addAndMakeVisible(masterRecordResetButton);
 
+    recordStemsButton.setToggleState(recordStemsGetter ? recordStemsGetter() : false,
+                                     juce::dontSendNotification);
+    recordStemsButton.setTooltip("Master recording also writes one WAV per channel before and after "
+                                 "its FX chain into a stems folder next to the master file.");
+    recordStemsButton.onClick = [this]
+    {
+        if (recordStemsSetter)
+            recordStemsSetter(recordStemsButton.getToggleState());
+    };
+    addAndMakeVisible(recordStemsButton);
+
     updateMasterRecordPathLabel();
 
     // App data path (read-only info)
@@ -125,7 +459,7 @@ PreferencesComponent::PreferencesComponent(MidiLearnManager& mlm,
     };
     addAndMakeVisible(appDataOpenButton);
 
-    setSize(520, 430);
+    setSize(520, 820);
 }
 
 //==============================================================================
@@ -134,7 +468,7 @@ void PreferencesComponent::paint(juce::Graphics& g)
     g.fillAll(bgColour);
 
     // MIDI section background panel
-    auto midiSection = getLocalBounds().reduced(12).withHeight(140);
+    auto midiSection = getLocalBounds().reduced(12).withHeight(172);
     g.setColour(sectionColour);
     g.fillRoundedRectangle(midiSection.toFloat(), 6.0f);
     g.setColour(juce::Colours::grey.withAlpha(0.4f));
@@ -152,9 +486,19 @@ void PreferencesComponent::paint(juce::Graphics& g)
                          static_cast<float>(sessionSection.getX() + 6),
                          static_cast<float>(sessionSection.getRight() - 6));
 
+    // Engine section background panel
+    auto engineSection = getLocalBounds().reduced(12).withTop(sessionSection.getBottom() + 8)
+                                         .withHeight(324);
+    g.setColour(sectionColour);
+    g.fillRoundedRectangle(engineSection.toFloat(), 6.0f);
+    g.setColour(juce::Colours::grey.withAlpha(0.4f));
+    g.drawHorizontalLine(engineSection.getY() + 28,
+                         static_cast<float>(engineSection.getX() + 6),
+                         static_cast<float>(engineSection.getRight() - 6));
+
     // Paths section background panel
-    auto pathsSection = getLocalBounds().reduced(12).withTop(sessionSection.getBottom() + 8)
-                                        .withHeight(120);
+    auto pathsSection = getLocalBounds().reduced(12).withTop(engineSection.getBottom() + 8)
+                                        .withHeight(146);
     g.setColour(sectionColour);
     g.fillRoundedRectangle(pathsSection.toFloat(), 6.0f);
     g.setColour(juce::Colours::grey.withAlpha(0.4f));
@@ -175,6 +519,14 @@ void PreferencesComponent::resized()
     auto buttonRow = area.removeFromTop(30);
     perChannelButton   .setBounds(buttonRow.removeFromLeft(150).reduced(2));
     activeChannelButton.setBounds(buttonRow.removeFromLeft(150).reduced(2));
+    area.removeFromTop(4);
+    {
+        auto row = area.removeFromTop(26);
+        midiClockLabel     .setBounds(row.removeFromLeft(140));
+        midiClockBox       .setBounds(row.removeFromLeft(180).reduced(1));
+        row.removeFromLeft(6);
+        midiClockStatsLabel.setBounds(row);
+    }
 
     area.removeFromTop(18);  // gap between sections
 
@@ -185,6 +537,61 @@ void PreferencesComponent::resized()
 
     area.removeFromTop(18);  // gap between sections
 
+    // --- Engine section ---
+    sectionEngineLabel.setBounds(area.removeFromTop(24));
+    area.removeFromTop(8);
+    parallelProcessingButton.setBounds(area.removeFromTop(28));
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        workerCoresLabel .setBounds(row.removeFromLeft(140));
+        workerCoresEditor.setBounds(row.removeFromLeft(120).reduced(1));
+    }
+    area.removeFromTop(2);
+    flushDenormalsButton.setBounds(area.removeFromTop(28));
+    area.removeFromTop(2);
+    packSectionsButton.setBounds(area.removeFromTop(28));
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        undoDepthLabel.setBounds(row.removeFromLeft(140));
+        undoDepthBox  .setBounds(row.removeFromLeft(120).reduced(1));
+    }
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        lockedMemoryLabel.setBounds(row.removeFromLeft(140));
+        lockedMemoryBox  .setBounds(row.removeFromLeft(120).reduced(1));
+    }
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        numChannelsLabel.setBounds(row.removeFromLeft(140));
+        numChannelsBox  .setBounds(row.removeFromLeft(120).reduced(1));
+    }
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        resampleQualityLabel.setBounds(row.removeFromLeft(140));
+        resampleQualityBox  .setBounds(row.removeFromLeft(120).reduced(1));
+    }
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        recordLatencyLabel  .setBounds(row.removeFromLeft(140));
+        recordLatencySlider .setBounds(row.removeFromLeft(160).reduced(1));
+        row.removeFromLeft(6);
+        measureLatencyButton.setBounds(row.removeFromLeft(80).reduced(1));
+    }
+    area.removeFromTop(2);
+    {
+        auto row = area.removeFromTop(26);
+        metricsTargetLabel .setBounds(row.removeFromLeft(140));
+        metricsTargetEditor.setBounds(row.removeFromLeft(246).reduced(1));
+    }
+
+    area.removeFromTop(18);  // gap between sections
+
     // --- Paths section ---
     sectionPathsLabel.setBounds(area.removeFromTop(24));
     area.removeFromTop(8);
@@ -197,6 +604,8 @@ void PreferencesComponent::resized()
         masterRecordBrowseButton.setBounds(row.removeFromRight(30).reduced(1));
         masterRecordPathValue   .setBounds(row.reduced(2, 0));
     }
+    area.removeFromTop(2);
+    recordStemsButton.setBounds(area.removeFromTop(24));
     area.removeFromTop(6);
 
     // App data path
@@ -241,6 +650,61 @@ void PreferencesComponent::updateMasterRecordPathLabel()
     masterRecordPathValue.setText(path, juce::dontSendNotification);
 }
 
+void PreferencesComponent::pollLatencyMeasurement()
+{
+    const int result = latencyMeasurePoller ? latencyMeasurePoller() : -1;
+    if (result == -2)
+    {
+        juce::Timer::callAfterDelay(50, [safe = juce::Component::SafePointer<PreferencesComponent>(this)]
+        {
+            if (safe != nullptr)
+                safe->pollLatencyMeasurement();
+        });
+        return;
+    }
+
+    measureLatencyButton.setEnabled(true);
+    measureLatencyButton.setButtonText("Measure");
+
+    if (result < 0)
+    {
+        juce::AlertWindow::showMessageBoxAsync(
+            juce::AlertWindow::WarningIcon, "Latency Measurement",
+            "The pulse did not come back. Connect the metronome output to the active "
+            "channel's input and turn the input up, then try again.");
+        return;
+    }
+
+    recordLatencySlider.setValue(result, juce::sendNotificationSync);   // stores it via the setter
+}
+
+void PreferencesComponent::updateMidiClockStats()
+{
+    if (midiClockStatsGetter == nullptr || midiClockBox.getSelectedId() <= 1)
+    {
+        midiClockStatsLabel.setText({}, juce::dontSendNotification);
+        return;
+    }
+
+    // Send-time error of the ticks so far
+    const auto stats = midiClockStatsGetter();
+    midiClockStatsLabel.setText(stats.eventsSent == 0
+                                    ? juce::String("no ticks sent yet")
+                                    : "jitter " + juce::String(stats.meanErrorUs, 0) + " / "
+                                      + juce::String(stats.maxErrorUs, 0) + " us (mean / max)",
+                                juce::dontSendNotification);
+}
+
+void PreferencesComponent::pollMidiClockStats()
+{
+    updateMidiClockStats();
+    juce::Timer::callAfterDelay(500, [safe = juce::Component::SafePointer<PreferencesComponent>(this)]
+    {
+        if (safe != nullptr)
+            safe->pollMidiClockStats();
+    });
+}
+
 void PreferencesComponent::browseForMasterRecordPath()
 {
     juce::String currentPath;
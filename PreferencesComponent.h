@@ -1,6 +1,7 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "MidiClockGenerator.h"
 #include "MidiLearnManager.h"
 
 /**
@@ -15,12 +16,66 @@ public:
     /** @param getAutoRecall  Getter that returns the current "auto-recall last session" flag.
      *  @param setAutoRecall  Setter called when the user toggles the option.
      *  @param getMasterRecordPath  Getter for master recording output path (empty = default).
-     *  @param setMasterRecordPath  Setter called when the user changes the path. */
+     *  @param setMasterRecordPath  Setter called when the user changes the path.
+     *  @param getParallelProcessing  Getter for the parallel channel rendering flag.
+     *  @param setParallelProcessing  Setter called when the user toggles it.
+     *  @param getUndoDepth  Getter for the number of overdub layers kept undoable.
+     *  @param setUndoDepth  Setter called when the user picks a new depth.
+     *  @param getFlushDenormals  Getter for the FTZ/DAZ flag of the audio threads.
+     *  @param setFlushDenormals  Setter called when the user toggles it.
+     *  @param getPackSections  Getter for packing idle sections in RAM.
+     *  @param setPackSections  Setter called when the user toggles it.
+     *  @param getLockedMemoryMb  Getter for the locked loop memory budget in MB (0 = off).
+     *  @param setLockedMemoryMb  Setter called when the user picks a new budget.
+     *  @param getRecordStems  Getter for recording channel stems with the master.
+     *  @param setRecordStems  Setter called when the user toggles it.
+     *  @param getNumChannels  Getter for the channel count (nullptr hides the option).
+     *  @param setNumChannels  Setter called when the user picks a count; applies at the next start.
+     *  @param getRecordLatency  Getter for the recording round trip in samples (-1 = driver-reported).
+     *  @param setRecordLatency  Setter called when the user edits or measures it.
+     *  @param startLatencyMeasurement  Starts the ping-loopback measurement (nullptr hides the button).
+     *  @param pollLatencyMeasurement   -2 while measuring, -1 failed, else the round trip in samples.
+     *  @param getMidiClockOutput  Getter for the MIDI clock output identifier (nullptr hides the option).
+     *  @param setMidiClockOutput  Opens the picked output (empty = off) and reports why it could not.
+     *  @param getMidiClockStats   Send-time error of the clock, shown next to the output.
+     *  @param getMetricsTarget    Getter for the OSC metrics collector "host:port" (nullptr hides the option).
+     *  @param setMetricsTarget    Starts or stops the export (empty = off) and reports a malformed target.
+     *  @param getResampleQuality  Getter for the song conversion filter, 0 = fast .. 2 = best (nullptr hides it).
+     *  @param setResampleQuality  Setter called when the user picks one; used by the next conversion.
+     *  @param getWorkerCores      Getter for the cores the render workers are pinned to (nullptr hides it).
+     *  @param setWorkerCores      Applies a core list like "2-5" (empty = not pinned) and reports a bad one. */
     PreferencesComponent(MidiLearnManager& midiLearnManager,
                          std::function<bool()>    getAutoRecall,
                          std::function<void(bool)> setAutoRecall,
                          std::function<juce::String()>              getMasterRecordPath = nullptr,
-                         std::function<void(const juce::String&)>   setMasterRecordPath = nullptr);
+                         std::function<void(const juce::String&)>   setMasterRecordPath = nullptr,
+                         std::function<bool()>                      getParallelProcessing = nullptr,
+                         std::function<void(bool)>                  setParallelProcessing = nullptr,
+                         std::function<int()>                       getUndoDepth = nullptr,
+                         std::function<void(int)>                   setUndoDepth = nullptr,
+                         std::function<bool()>                      getFlushDenormals = nullptr,
+                         std::function<void(bool)>                  setFlushDenormals = nullptr,
+                         std::function<bool()>                      getPackSections = nullptr,
+                         std::function<void(bool)>                  setPackSections = nullptr,
+                         std::function<int()>                       getLockedMemoryMb = nullptr,
+                         std::function<void(int)>                   setLockedMemoryMb = nullptr,
+                         std::function<bool()>                      getRecordStems = nullptr,
+                         std::function<void(bool)>                  setRecordStems = nullptr,
+                         std::function<int()>                       getNumChannels = nullptr,
+                         std::function<void(int)>                   setNumChannels = nullptr,
+                         std::function<int()>                       getRecordLatency = nullptr,
+                         std::function<void(int)>                   setRecordLatency = nullptr,
+                         std::function<void()>                      startLatencyMeasurement = nullptr,
+                         std::function<int()>                       pollLatencyMeasurement = nullptr,
+                         std::function<juce::String()>              getMidiClockOutput = nullptr,
+                         std::function<juce::Result(const juce::String&)> setMidiClockOutput = nullptr,
+                         std::function<MidiClockGenerator::Stats()> getMidiClockStats = nullptr,
+                         std::function<juce::String()>              getMetricsTarget = nullptr,
+                         std::function<juce::Result(const juce::String&)> setMetricsTarget = nullptr,
+                         std::function<int()>                       getResampleQuality = nullptr,
+                         std::function<void(int)>                   setResampleQuality = nullptr,
+                         std::function<juce::String()>              getWorkerCores = nullptr,
+                         std::function<juce::Result(const juce::String&)> setWorkerCores = nullptr);
     ~PreferencesComponent() override = default;
 
     void paint(juce::Graphics& g) override;
@@ -33,6 +88,33 @@ private:
     std::function<void(bool)> autoRecallSetter;
     std::function<juce::String()>            masterRecordPathGetter;
     std::function<void(const juce::String&)> masterRecordPathSetter;
+    std::function<bool()>     parallelProcessingGetter;
+    std::function<void(bool)> parallelProcessingSetter;
+    std::function<int()>      undoDepthGetter;
+    std::function<void(int)>  undoDepthSetter;
+    std::function<bool()>     flushDenormalsGetter;
+    std::function<void(bool)> flushDenormalsSetter;
+    std::function<bool()>     packSectionsGetter;
+    std::function<void(bool)> packSectionsSetter;
+    std::function<int()>      lockedMemoryGetter;
+    std::function<void(int)>  lockedMemorySetter;
+    std::function<bool()>     recordStemsGetter;
+    std::function<void(bool)> recordStemsSetter;
+    std::function<int()>      numChannelsGetter;
+    std::function<void(int)>  numChannelsSetter;
+    std::function<int()>      recordLatencyGetter;
+    std::function<void(int)>  recordLatencySetter;
+    std::function<void()>     latencyMeasureStarter;
+    std::function<int()>      latencyMeasurePoller;
+    std::function<juce::String()>                    midiClockOutputGetter;
+    std::function<juce::Result(const juce::String&)> midiClockOutputSetter;
+    std::function<MidiClockGenerator::Stats()>       midiClockStatsGetter;
+    std::function<juce::String()>                    metricsTargetGetter;
+    std::function<juce::Result(const juce::String&)> metricsTargetSetter;
+    std::function<int()>      resampleQualityGetter;
+    std::function<void(int)>  resampleQualitySetter;
+    std::function<juce::String()>                    workerCoresGetter;
+    std::function<juce::Result(const juce::String&)> workerCoresSetter;
 
     //==========================================================================
     // Section: MIDI Learn Mode
@@ -40,12 +122,38 @@ private:
     juce::Label  midiLearnDescLabel;
     juce::TextButton perChannelButton    {"Per Channel"};
     juce::TextButton activeChannelButton {"Active Channel"};
+    juce::Label      midiClockLabel {"", "MIDI clock out:"};
+    juce::ComboBox   midiClockBox;
+    juce::Label      midiClockStatsLabel;
+    juce::StringArray midiClockIdentifiers;   // item id = index + 2, 1 = off
 
     //==========================================================================
     // Section: Session
     juce::Label      sectionSessionLabel;
     juce::ToggleButton autoRecallButton {"Auto-recall last session on startup"};
 
+    //==========================================================================
+    // Section: Engine
+    juce::Label      sectionEngineLabel;
+    juce::ToggleButton parallelProcessingButton {"Render channels in parallel (multi-core)"};
+    juce::Label      workerCoresLabel {"", "Worker cores:"};
+    juce::TextEditor workerCoresEditor;
+    juce::ToggleButton flushDenormalsButton {"Flush denormals to zero on audio threads (FTZ/DAZ)"};
+    juce::ToggleButton packSectionsButton   {"Compress idle sections in RAM (lossless)"};
+    juce::Label      undoDepthLabel {"", "Overdub undo depth:"};
+    juce::ComboBox   undoDepthBox;
+    juce::Label      lockedMemoryLabel {"", "Lock loop memory:"};
+    juce::ComboBox   lockedMemoryBox;
+    juce::Label      numChannelsLabel {"", "Channels:"};
+    juce::ComboBox   numChannelsBox;
+    juce::Label      resampleQualityLabel {"", "Resample quality:"};
+    juce::ComboBox   resampleQualityBox;
+    juce::Label      recordLatencyLabel {"", "Record offset:"};
+    juce::Slider     recordLatencySlider;
+    juce::TextButton measureLatencyButton {"Measure"};
+    juce::Label      metricsTargetLabel {"", "Metrics to (OSC):"};
+    juce::TextEditor metricsTargetEditor;
+
     //==========================================================================
     // Section: Paths
     juce::Label      sectionPathsLabel;
@@ -54,6 +162,7 @@ private:
     juce::Label      masterRecordPathValue;
     juce::TextButton masterRecordBrowseButton {"..."};
     juce::TextButton masterRecordResetButton  {"Reset"};
+    juce::ToggleButton recordStemsButton {"Also record stems (every channel dry + post-FX)"};
 
     juce::Label      appDataLabel  {"", "App Data:"};
     juce::Label      appDataValue;
@@ -64,6 +173,9 @@ private:
     void updateMidiLearnModeButtons();
     void updateMasterRecordPathLabel();
     void browseForMasterRecordPath();
+    void pollLatencyMeasurement();
+    void updateMidiClockStats();
+    void pollMidiClockStats();   // refreshes the stats while the dialog is open
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PreferencesComponent)
 };
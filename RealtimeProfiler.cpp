@@ -0,0 +1,224 @@
+#include "RealtimeProfiler.h"
+
+namespace
+{
+    constexpr double kSlotSeconds = 0.25;
+
+    bool isAggregateStage(int stage) noexcept
+    {
+        return stage == RealtimeProfiler::Channels || stage == RealtimeProfiler::Total;
+    }
+}
+
+//==============================================================================
+RealtimeProfiler::RealtimeProfiler()
+    : slots(new Slot[kRingSlots])
+    , ticksPerUs(static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / 1.0e6)
+{
+    for (int i = 0; i < kRingSlots; ++i)
+        clearSlot(slots[static_cast<size_t>(i)]);
+
+    for (int s = 0; s < kNumStages; ++s)
+    {
+        blockTicks  [static_cast<size_t>(s)].store(0, std::memory_order_relaxed);
+        xrunsByStage[static_cast<size_t>(s)].store(0, std::memory_order_relaxed);
+    }
+}
+
+void RealtimeProfiler::prepare(double newSampleRate)
+{
+    sampleRate = newSampleRate > 0.0 ? newSampleRate : 44100.0;
+    samplesInSlot = 0;
+}
+
+juce::String RealtimeProfiler::getStageName(int stage)
+{
+    static const char* const globalNames[kNumGlobalStages] =
+        { "Commands", "Transport", "Bar End", "Section Switch", "Song Swap", "Count In",
+          "MIDI", "Channels", "Master Rec", "Metronome", "Output", "Total" };
+    static const char* const channelNames[kStagesPerChannel] =
+        { "Input", "Record", "Playback", "FX1", "FX2", "FX3" };
+
+    if (stage >= 0 && stage < kNumGlobalStages)
+        return globalNames[stage];
+
+    const int local = stage - kNumGlobalStages;
+    if (local >= 0 && local < kNumChannels * kStagesPerChannel)
+        return "Ch" + juce::String(local / kStagesPerChannel + 1) + " "
+             + channelNames[local % kStagesPerChannel];
+
+    return "?";
+}
+
+//==============================================================================
+// Audio thread
+//==============================================================================
+
+void RealtimeProfiler::beginBlock(int numSamples) noexcept
+{
+    if (paused.load(std::memory_order_relaxed)) return;
+
+    for (auto& t : blockTicks)
+        t.store(0, std::memory_order_relaxed);
+
+    blockBudget = static_cast<juce::int64>(numSamples / sampleRate * 1.0e6 * ticksPerUs);
+    budgetUs.store(numSamples / sampleRate * 1.0e6, std::memory_order_relaxed);
+
+    // Move to the next slot every kSlotSeconds; it is cleared before use
+    samplesInSlot += numSamples;
+    if (samplesInSlot >= static_cast<juce::int64>(sampleRate * kSlotSeconds))
+    {
+        samplesInSlot = 0;
+        const int next = (writeSlot.load(std::memory_order_relaxed) + 1) % kRingSlots;
+        clearSlot(slots[static_cast<size_t>(next)]);
+        writeSlot.store(next, std::memory_order_release);
+    }
+
+    blockStart = juce::Time::getHighResolutionTicks();
+}
+
+void RealtimeProfiler::endBlock() noexcept
+{
+    if (paused.load(std::memory_order_relaxed)) return;
+
+    const juce::int64 total = juce::Time::getHighResolutionTicks() - blockStart;
+    record(Total, total);
+
+    if (blockBudget <= 0 || total <= blockBudget)
+        return;
+
+    numXruns.fetch_add(1, std::memory_order_relaxed);
+
+    int culprit = -1;
+    juce::int64 longest = 0;
+    for (int s = 0; s < kNumStages; ++s)
+    {
+        if (isAggregateStage(s)) continue;
+        const auto t = blockTicks[static_cast<size_t>(s)].load(std::memory_order_relaxed);
+        if (t > longest) { longest = t; culprit = s; }
+    }
+    if (culprit >= 0)
+        xrunsByStage[static_cast<size_t>(culprit)].fetch_add(1, std::memory_order_relaxed);
+}
+
+void RealtimeProfiler::record(int stage, juce::int64 ticks) noexcept
+{
+    if (stage < 0 || stage >= kNumStages || ticks < 0 || paused.load(std::memory_order_relaxed)) return;
+    const auto s = static_cast<size_t>(stage);
+
+    blockTicks[s].fetch_add(ticks, std::memory_order_relaxed);
+
+    auto& slot = slots[static_cast<size_t>(writeSlot.load(std::memory_order_acquire))];
+    const auto micros = static_cast<juce::int64>(static_cast<double>(ticks) / ticksPerUs);
+
+    slot.buckets[s][static_cast<size_t>(bucketFor(micros))].fetch_add(1, std::memory_order_relaxed);
+    slot.sumTicks[s].fetch_add(ticks, std::memory_order_relaxed);
+
+    auto prev = slot.maxTicks[s].load(std::memory_order_relaxed);
+    while (ticks > prev
+           && !slot.maxTicks[s].compare_exchange_weak(prev, ticks, std::memory_order_relaxed))
+    {}
+}
+
+void RealtimeProfiler::clearSlot(Slot& slot) noexcept
+{
+    for (int s = 0; s < kNumStages; ++s)
+    {
+        for (auto& b : slot.buckets[static_cast<size_t>(s)])
+            b.store(0, std::memory_order_relaxed);
+        slot.sumTicks[static_cast<size_t>(s)].store(0, std::memory_order_relaxed);
+        slot.maxTicks[static_cast<size_t>(s)].store(0, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+// Buckets: 0..3 µs exact, then four buckets per octave
+//==============================================================================
+
+int RealtimeProfiler::bucketFor(juce::int64 micros) noexcept
+{
+    if (micros < 4) return static_cast<int>(juce::jmax<juce::int64>(0, micros));
+
+    const auto us  = static_cast<juce::uint32>(juce::jmin<juce::int64>(micros, 0x7fffffff));
+    const int  msb = juce::findHighestSetBit(us);
+    const int  b   = (msb - 1) * 4 + static_cast<int>((us >> (msb - 2)) & 3u);
+    return juce::jmin(b, kNumBuckets - 1);
+}
+
+double RealtimeProfiler::bucketUpperUs(int bucket) noexcept
+{
+    const int b = bucket + 1;
+    if (b < 4) return static_cast<double>(b);
+
+    const int msb  = b / 4 + 1;
+    const int frac = b % 4;
+    return static_cast<double>(static_cast<juce::int64>(4 + frac) << (msb - 2));
+}
+
+//==============================================================================
+// Message thread
+//==============================================================================
+
+RealtimeProfiler::StageStats RealtimeProfiler::getStats(int stage) const
+{
+    StageStats st;
+    if (stage < 0 || stage >= kNumStages) return st;
+    const auto s = static_cast<size_t>(stage);
+
+    // Sum every slot except the one being written. A slot rotating while we
+    // read may be counted half-cleared — acceptable for a diagnostic display.
+    const int current = writeSlot.load(std::memory_order_acquire);
+
+    std::array<juce::uint64, kNumBuckets> hist {};
+    juce::int64 sum = 0, worst = 0;
+
+    for (int i = 0; i < kRingSlots; ++i)
+    {
+        if (i == current) continue;
+        const auto& slot = slots[static_cast<size_t>(i)];
+
+        for (int b = 0; b < kNumBuckets; ++b)
+            hist[static_cast<size_t>(b)] += slot.buckets[s][static_cast<size_t>(b)].load(std::memory_order_relaxed);
+        sum   += slot.sumTicks[s].load(std::memory_order_relaxed);
+        worst  = juce::jmax(worst, slot.maxTicks[s].load(std::memory_order_relaxed));
+    }
+
+    for (auto h : hist) st.count += static_cast<juce::int64>(h);
+
+    st.xruns   = xrunsByStage[s].load(std::memory_order_relaxed);
+    st.worstUs = static_cast<double>(worst) / ticksPerUs;
+    if (st.count == 0) return st;
+
+    st.meanUs = static_cast<double>(sum) / ticksPerUs / static_cast<double>(st.count);
+
+    const auto median = static_cast<juce::uint64>(std::ceil(0.50 * static_cast<double>(st.count)));
+    const auto target = static_cast<juce::uint64>(std::ceil(0.99 * static_cast<double>(st.count)));
+    juce::uint64 seen = 0;
+    for (int b = 0; b < kNumBuckets; ++b)
+    {
+        const auto before = seen;
+        seen += hist[static_cast<size_t>(b)];
+        if (before < median && seen >= median)
+            st.p50Us = juce::jmin(bucketUpperUs(b), st.worstUs);
+        if (seen >= target)
+        {
+            st.p99Us = juce::jmin(bucketUpperUs(b), st.worstUs);
+            break;
+        }
+    }
+    return st;
+}
+
+int RealtimeProfiler::getWorstStage() const
+{
+    int    worstStage = -1;
+    double worstUs    = 0.0;
+
+    for (int s = 0; s < kNumStages; ++s)
+    {
+        if (isAggregateStage(s)) continue;
+        const double w = getStats(s).worstUs;
+        if (w > worstUs) { worstUs = w; worstStage = s; }
+    }
+    return worstStage;
+}
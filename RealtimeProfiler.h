@@ -0,0 +1,172 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+ * @file RealtimeProfiler.h
+ * @brief Lock-free per-stage timing of the audio callback
+ *
+ * Every stage of the callback (commands, transport, each channel's input,
+ * record, playback and FX slots, metronome, master record) is timed with
+ * the high-resolution counter and counted into a log-spaced histogram.
+ *
+ * Histograms live in a small ring of time slots (~250 ms each).  The audio
+ * thread only ever writes the current slot and clears a slot when it moves
+ * on; the UI sums the other slots, so statistics cover the last ~2 s.
+ *
+ * A block that takes longer than its real-time budget counts as an xrun and
+ * is attributed to the leaf stage that took longest in that block.
+ *
+ * Thread-safety:
+ *   Device start                 : prepare()
+ *   Audio thread / render workers: beginBlock(), Scope, lap(), endBlock()
+ *   Message thread / exporter    : getStats(), getWorstStage(), getNumXruns()
+ */
+class RealtimeProfiler
+{
+public:
+    //==========================================================================
+    // Stage ids
+    enum GlobalStage
+    {
+        Commands = 0,
+        Transport,      // playhead, MIDI clock, stop-all, solo
+        BarEnd,         // metronome first-recording bar-end stop
+        SectionSwitch,  // latched section switch and section storage tiers
+        SongSwap,       // standby song install
+        CountIn,        // count-in countdown and fixed-length auto-stop
+        Midi,
+        Channels,       // all channels together (aggregate)
+        MasterRecord,
+        Metronome,
+        Output,         // master gain
+        Total,          // whole callback (aggregate)
+        kNumGlobalStages
+    };
+
+    enum ChannelStage
+    {
+        ChannelInput = 0,   // hardware input routing or VSTi instrument
+        ChannelRecord,
+        ChannelPlayback,
+        ChannelFx1,
+        ChannelFx2,
+        ChannelFx3,
+        kStagesPerChannel
+    };
+
+    static constexpr int kNumChannels = 16;   // MAX_CHANNELS (Channel.h)
+    static constexpr int kNumStages   = kNumGlobalStages + kNumChannels * kStagesPerChannel;
+    static constexpr int kNumBuckets  = 64;   // quarter-octave buckets in µs, up to ~65 ms
+    static constexpr int kRingSlots   = 8;
+
+    static constexpr int channelStage(int channel, int stage) noexcept
+    {
+        return kNumGlobalStages + channel * kStagesPerChannel + stage;
+    }
+
+    static juce::String getStageName(int stage);
+
+    //==========================================================================
+    RealtimeProfiler();
+
+    /** Set the sample rate for the callback budget. Before audio starts (audioDeviceAboutToStart). */
+    void prepare(double sampleRate);
+
+    /** Non-realtime blocks (offline bounce) are not measured while paused. Between blocks. */
+    void setPaused(bool shouldPause) noexcept { paused.store(shouldPause, std::memory_order_release); }
+
+    /** Start timing a callback, rotating the ring slot when due. Audio thread. */
+    void beginBlock(int numSamples) noexcept;
+
+    /** Finish the callback: total time and xrun attribution. Audio thread. */
+    void endBlock() noexcept;
+
+    /** Add one measurement for a stage. Any audio-side thread, lock-free. */
+    void record(int stage, juce::int64 ticks) noexcept;
+
+    /** Record the time since `since` into a stage; returns now for the next back-to-back stage. */
+    juce::int64 lap(int stage, juce::int64 since) noexcept
+    {
+        const auto now = juce::Time::getHighResolutionTicks();
+        record(stage, now - since);
+        return now;
+    }
+
+    /** Times a scope into a stage; a null profiler makes it a no-op. */
+    class Scope
+    {
+    public:
+        Scope(RealtimeProfiler* p, int stageId) noexcept
+            : profiler(p), stage(stageId),
+              start(p != nullptr ? juce::Time::getHighResolutionTicks() : 0) {}
+
+        ~Scope() noexcept
+        {
+            if (profiler != nullptr)
+                profiler->record(stage, juce::Time::getHighResolutionTicks() - start);
+        }
+
+    private:
+        RealtimeProfiler* profiler;
+        int               stage;
+        juce::int64       start;
+
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    //==========================================================================
+    // UI side
+    struct StageStats
+    {
+        juce::int64 count   {0};
+        double      meanUs  {0.0};
+        double      p50Us   {0.0};
+        double      p99Us   {0.0};
+        double      worstUs {0.0};
+        int         xruns   {0};   // blocks over budget attributed to this stage (since start)
+    };
+
+    /** Statistics over the completed ring slots. Any thread but the audio side. */
+    StageStats getStats(int stage) const;
+
+    /** Leaf stage with the highest worst-case time in the window, or -1. */
+    int getWorstStage() const;
+
+    int    getNumXruns()    const { return numXruns.load(std::memory_order_relaxed); }
+    double getBudgetUs()    const { return budgetUs.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot
+    {
+        std::array<std::array<std::atomic<juce::uint32>, kNumBuckets>, kNumStages> buckets;
+        std::array<std::atomic<juce::int64>, kNumStages> sumTicks;
+        std::array<std::atomic<juce::int64>, kNumStages> maxTicks;
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<int>        writeSlot {0};
+
+    // Per-block times for xrun attribution (each stage has one writer per block)
+    std::array<std::atomic<juce::int64>, kNumStages> blockTicks;
+    std::array<std::atomic<int>, kNumStages>         xrunsByStage;
+
+    const double      ticksPerUs;
+    std::atomic<double> budgetUs      {0.0};
+    double            sampleRate     {44100.0};    // audio thread reads after prepare()
+    juce::int64       blockStart     {0};
+    juce::int64       blockBudget    {0};           // ticks
+    juce::int64       samplesInSlot  {0};
+    std::atomic<int>  numXruns       {0};
+    std::atomic<bool> paused         {false};
+
+    static int    bucketFor(juce::int64 micros) noexcept;
+    static double bucketUpperUs(int bucket) noexcept;
+    void          clearSlot(Slot& slot) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RealtimeProfiler)
+};
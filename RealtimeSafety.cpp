@@ -0,0 +1,424 @@
+#include "RealtimeSafety.h"
+
+#if CHIEF_RT_SAFETY_CHECKS
+ #if JUCE_WINDOWS
+  #ifndef NOMINMAX
+   #define NOMINMAX
+  #endif
+  #include <windows.h>
+  #include <dbghelp.h>
+  #include <crtdbg.h>
+  #pragma comment(lib, "DbgHelp.lib")
+ #else
+  #include <execinfo.h>
+ #endif
+ #include <cstdlib>
+ #include <new>
+#endif
+
+#if CHIEF_RT_SAFETY_LIBC_HOOKS
+ #include <cerrno>
+ #include <dlfcn.h>
+ #include <pthread.h>
+ #include <semaphore.h>
+ #include <cstdio>
+ #include <cstring>
+ #include <ctime>
+ #include <unistd.h>
+#endif
+
+std::atomic<int> RealtimeSafety::numViolations {0};
+std::atomic<int> RealtimeSafety::nextEntry     {0};
+
+#if !CHIEF_RT_SAFETY_CHECKS
+
+//==============================================================================
+// Checks compiled out: nothing is ever logged
+//==============================================================================
+
+void RealtimeSafety::reset() noexcept {}
+juce::String RealtimeSafety::getReport(int, int) { return {}; }
+bool RealtimeSafety::isCheckedThread() noexcept { return false; }
+void RealtimeSafety::noteViolation(Kind, const char*) noexcept {}
+void RealtimeSafety::enter() noexcept {}
+void RealtimeSafety::leave() noexcept {}
+void RealtimeSafety::allow(int) noexcept {}
+
+#else
+
+//==============================================================================
+// Log (static storage: nothing here may allocate)
+//==============================================================================
+
+namespace
+{
+    struct LogEntry
+    {
+        std::atomic<bool>    ready     {false};
+        RealtimeSafety::Kind kind      {RealtimeSafety::Kind::Allocation};
+        const char*          what      {nullptr};
+        juce::uint32         timeMs    {0};
+        void*                threadId  {nullptr};
+        int                  numFrames {0};
+        void*                frames[RealtimeSafety::kMaxFrames] {};
+    };
+
+    LogEntry violationLog[RealtimeSafety::kLogSize];
+
+    // Plain thread_locals: no constructor, so reading them never allocates
+    thread_local int  realtimeDepth = 0;
+    thread_local int  allowDepth    = 0;
+    thread_local bool reporting     = false;   // the checks themselves must not recurse
+
+    std::atomic<bool> unwinderPrimed {false};
+
+    int captureFrames(void** frames, int maxFrames) noexcept
+    {
+       #if JUCE_WINDOWS
+        return static_cast<int>(CaptureStackBackTrace(2, static_cast<DWORD>(maxFrames), frames, nullptr));
+       #else
+        return backtrace(frames, maxFrames);
+       #endif
+    }
+
+    const char* kindName(RealtimeSafety::Kind kind) noexcept
+    {
+        switch (kind)
+        {
+            case RealtimeSafety::Kind::Allocation:   return "allocation";
+            case RealtimeSafety::Kind::Deallocation: return "free";
+            case RealtimeSafety::Kind::Lock:         return "lock";
+            case RealtimeSafety::Kind::BlockingCall: return "blocking call";
+        }
+        return "?";
+    }
+
+    juce::String symbolise(void* const* frames, int numFrames)
+    {
+        juce::String text;
+
+       #if JUCE_WINDOWS
+        HANDLE process = GetCurrentProcess();
+        static const bool symbolsLoaded = SymInitialize(process, nullptr, TRUE) != FALSE;
+
+        alignas(SYMBOL_INFO) char buffer[sizeof(SYMBOL_INFO) + 256] {};
+        auto* symbol = reinterpret_cast<SYMBOL_INFO*>(buffer);
+        symbol->SizeOfStruct = sizeof(SYMBOL_INFO);
+        symbol->MaxNameLen   = 255;
+
+        for (int i = 0; i < numFrames; ++i)
+        {
+            DWORD64 displacement = 0;
+            const auto address = reinterpret_cast<DWORD64>(frames[i]);
+            text << "    " << i << ": ";
+            if (symbolsLoaded && SymFromAddr(process, address, &displacement, symbol))
+                text << symbol->Name << " + 0x" << juce::String::toHexString(static_cast<juce::int64>(displacement));
+            else
+                text << "0x" << juce::String::toHexString(static_cast<juce::int64>(address));
+            text << juce::newLine;
+        }
+       #else
+        if (char** names = backtrace_symbols(frames, numFrames))
+        {
+            for (int i = 0; i < numFrames; ++i)
+                text << "    " << i << ": " << names[i] << juce::newLine;
+            std::free(names);
+        }
+       #endif
+        return text;
+    }
+}
+
+//==============================================================================
+// Scopes
+//==============================================================================
+
+void RealtimeSafety::enter() noexcept
+{
+    // The first unwind loads the unwinder (and allocates) — do it unchecked
+    if (!unwinderPrimed.exchange(true, std::memory_order_acq_rel))
+    {
+        reporting = true;
+        void* frames[2];
+        captureFrames(frames, 2);
+        reporting = false;
+    }
+    ++realtimeDepth;
+}
+
+void RealtimeSafety::leave() noexcept
+{
+    --realtimeDepth;
+}
+
+void RealtimeSafety::allow(int delta) noexcept
+{
+    allowDepth += delta;
+}
+
+bool RealtimeSafety::isCheckedThread() noexcept
+{
+    return realtimeDepth > 0 && allowDepth == 0 && !reporting;
+}
+
+//==============================================================================
+// Violations
+//==============================================================================
+
+void RealtimeSafety::noteViolation(Kind kind, const char* what) noexcept
+{
+    reporting = true;
+    numViolations.fetch_add(1, std::memory_order_relaxed);
+
+    // Claim a slot only while there are any: the index never runs away
+    int index = nextEntry.load(std::memory_order_relaxed);
+    while (index < kLogSize
+           && !nextEntry.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel))
+    {}
+
+    if (index < kLogSize)
+    {
+        auto& e     = violationLog[index];
+        e.kind      = kind;
+        e.what      = what;
+        e.timeMs    = juce::Time::getMillisecondCounter();
+        e.threadId  = juce::Thread::getCurrentThreadId();
+        e.numFrames = captureFrames(e.frames, kMaxFrames);
+        e.ready.store(true, std::memory_order_release);
+    }
+
+    reporting = false;
+}
+
+void RealtimeSafety::reset() noexcept
+{
+    for (auto& e : violationLog)
+        e.ready.store(false, std::memory_order_relaxed);
+    nextEntry    .store(0, std::memory_order_release);
+    numViolations.store(0, std::memory_order_relaxed);
+}
+
+juce::String RealtimeSafety::getReport(int firstEntry, int maxEntries)
+{
+    juce::String report;
+    const int logged = getNumLogged();
+
+    for (int i = juce::jmax(0, firstEntry); i < logged && i < firstEntry + maxEntries; ++i)
+    {
+        const auto& e = violationLog[i];
+        if (!e.ready.load(std::memory_order_acquire))
+            continue;   // still being written
+
+        report << "RT violation #" << (i + 1) << ": " << kindName(e.kind) << " (" << e.what << ") on thread 0x"
+               << juce::String::toHexString(static_cast<juce::pointer_sized_int>(
+                      reinterpret_cast<juce::pointer_sized_uint>(e.threadId)))
+               << " at " << static_cast<juce::int64>(e.timeMs) << " ms" << juce::newLine
+               << symbolise(e.frames, e.numFrames);
+    }
+
+    const int unlogged = getNumViolations() - logged;
+    if (unlogged > 0 && firstEntry + maxEntries >= logged)
+        report << unlogged << " further violation(s) counted, not logged" << juce::newLine;
+
+    return report;
+}
+
+//==============================================================================
+// Interposers
+//==============================================================================
+
+namespace
+{
+    inline void check(RealtimeSafety::Kind kind, const char* what) noexcept
+    {
+        if (RealtimeSafety::isCheckedThread())
+            RealtimeSafety::noteViolation(kind, what);
+    }
+}
+
+#if CHIEF_RT_SAFETY_LIBC_HOOKS
+
+//--- glibc: the malloc family forwards to its __libc_ entry points -----------
+extern "C"
+{
+    void* __libc_malloc(size_t);
+    void* __libc_calloc(size_t, size_t);
+    void* __libc_realloc(void*, size_t);
+    void* __libc_memalign(size_t, size_t);
+    void  __libc_free(void*);
+
+    void* malloc(size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "malloc");
+        return __libc_malloc(size);
+    }
+
+    void* calloc(size_t count, size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "calloc");
+        return __libc_calloc(count, size);
+    }
+
+    void* realloc(void* p, size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "realloc");
+        return __libc_realloc(p, size);
+    }
+
+    void* memalign(size_t alignment, size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "memalign");
+        return __libc_memalign(alignment, size);
+    }
+
+    void* aligned_alloc(size_t alignment, size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "aligned_alloc");
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void** result, size_t alignment, size_t size) __THROW
+    {
+        check(RealtimeSafety::Kind::Allocation, "posix_memalign");
+        if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+
+        void* p = __libc_memalign(alignment, size);
+        if (p == nullptr)
+            return ENOMEM;
+        *result = p;
+        return 0;
+    }
+
+    void free(void* p) __THROW
+    {
+        if (p != nullptr)
+            check(RealtimeSafety::Kind::Deallocation, "free");
+        __libc_free(p);
+    }
+}
+
+//--- Locks and blocking calls: checked, then the next definition (libc) ------
+namespace
+{
+    template <typename Fn>
+    Fn nextSymbol(std::atomic<Fn>& cache, const char* name) noexcept
+    {
+        auto fn = cache.load(std::memory_order_relaxed);
+        if (fn == nullptr)
+        {
+            // Plain dlsym finds the pre-2.3.2 condition variables on x86-64
+            if (std::strncmp(name, "pthread_cond_", 13) == 0)
+                fn = reinterpret_cast<Fn>(dlvsym(RTLD_NEXT, name, "GLIBC_2.3.2"));
+            if (fn == nullptr)
+                fn = reinterpret_cast<Fn>(dlsym(RTLD_NEXT, name));
+            cache.store(fn, std::memory_order_relaxed);
+        }
+        return fn;
+    }
+}
+
+// Same signature and exception specification as the libc declaration
+#define CHIEF_RT_CHECKED_CALL(kind, ret, name, params, args, spec) \
+    ret name params spec \
+    { \
+        static std::atomic<ret (*) params> next {nullptr}; \
+        check(RealtimeSafety::Kind::kind, #name); \
+        return nextSymbol(next, #name) args; \
+    }
+
+extern "C"
+{
+    CHIEF_RT_CHECKED_CALL(Lock, int, pthread_mutex_lock,  (pthread_mutex_t* m),  (m), __THROWNL)
+    CHIEF_RT_CHECKED_CALL(Lock, int, pthread_rwlock_rdlock, (pthread_rwlock_t* l), (l), __THROWNL)
+    CHIEF_RT_CHECKED_CALL(Lock, int, pthread_rwlock_wrlock, (pthread_rwlock_t* l), (l), __THROWNL)
+    CHIEF_RT_CHECKED_CALL(Lock, int, pthread_cond_wait,
+                          (pthread_cond_t* __restrict c, pthread_mutex_t* __restrict m), (c, m), )
+    CHIEF_RT_CHECKED_CALL(Lock, int, pthread_cond_timedwait,
+                          (pthread_cond_t* __restrict c, pthread_mutex_t* __restrict m,
+                           const struct timespec* __restrict t), (c, m, t), )
+    CHIEF_RT_CHECKED_CALL(Lock, int, sem_wait,      (sem_t* s), (s), )
+    CHIEF_RT_CHECKED_CALL(Lock, int, sem_timedwait, (sem_t* __restrict s, const struct timespec* __restrict t), (s, t), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int, pthread_join, (pthread_t t, void** r), (t, r), )
+
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int, nanosleep, (const struct timespec* t, struct timespec* r), (t, r), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int, clock_nanosleep,
+                          (clockid_t c, int f, const struct timespec* t, struct timespec* r), (c, f, t, r), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int, usleep, (__useconds_t us), (us), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, unsigned int, sleep, (unsigned int s), (s), )
+
+    CHIEF_RT_CHECKED_CALL(BlockingCall, FILE*,   fopen, (const char* __restrict p, const char* __restrict m), (p, m), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, ssize_t, write, (int fd, const void* b, size_t n), (fd, b, n), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int,     fsync, (int fd), (fd), )
+    CHIEF_RT_CHECKED_CALL(BlockingCall, int,     fdatasync, (int fd), (fd), )
+}
+
+#undef CHIEF_RT_CHECKED_CALL
+
+#elif CHIEF_RT_SAFETY_CRT_HOOK
+
+//--- Windows debug CRT: every heap call passes the allocation hook -----------
+namespace
+{
+    int __cdecl crtAllocHook(int allocType, void*, size_t, int, long, const unsigned char*, int)
+    {
+        check(allocType == _HOOK_FREE ? RealtimeSafety::Kind::Deallocation : RealtimeSafety::Kind::Allocation,
+              allocType == _HOOK_FREE ? "free" : allocType == _HOOK_REALLOC ? "realloc" : "malloc");
+        return TRUE;   // report, never refuse
+    }
+
+    const struct CrtHookInstaller
+    {
+        CrtHookInstaller() { _CrtSetAllocHook(crtAllocHook); }
+    } crtHookInstaller;
+}
+
+#elif CHIEF_RT_SAFETY_REPLACES_NEW
+
+//--- Elsewhere: the global operator new/delete -------------------------------
+void* operator new(std::size_t size)
+{
+    check(RealtimeSafety::Kind::Allocation, "operator new");
+    if (auto* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    check(RealtimeSafety::Kind::Allocation, "operator new[]");
+    if (auto* p = std::malloc(size != 0 ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    check(RealtimeSafety::Kind::Allocation, "operator new");
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    check(RealtimeSafety::Kind::Allocation, "operator new[]");
+    return std::malloc(size != 0 ? size : 1);
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p != nullptr) check(RealtimeSafety::Kind::Deallocation, "operator delete");
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    if (p != nullptr) check(RealtimeSafety::Kind::Deallocation, "operator delete[]");
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept   { operator delete(p); }
+void operator delete[](void* p, std::size_t) noexcept { operator delete[](p); }
+
+#endif
+
+#endif   // CHIEF_RT_SAFETY_CHECKS
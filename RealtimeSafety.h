@@ -0,0 +1,129 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+
+#ifndef CHIEF_RT_SAFETY_CHECKS
+ #define CHIEF_RT_SAFETY_CHECKS 0
+#endif
+
+// How allocations are caught (see RealtimeSafety.cpp)
+#if CHIEF_RT_SAFETY_CHECKS && defined(__GLIBC__)
+ #define CHIEF_RT_SAFETY_LIBC_HOOKS 1      // malloc family, pthread locks and blocking calls
+#else
+ #define CHIEF_RT_SAFETY_LIBC_HOOKS 0
+#endif
+
+#if CHIEF_RT_SAFETY_CHECKS && JUCE_WINDOWS && defined(_DEBUG)
+ #define CHIEF_RT_SAFETY_CRT_HOOK 1        // debug CRT allocation hook
+#else
+ #define CHIEF_RT_SAFETY_CRT_HOOK 0
+#endif
+
+#if CHIEF_RT_SAFETY_CHECKS && !CHIEF_RT_SAFETY_LIBC_HOOKS && !CHIEF_RT_SAFETY_CRT_HOOK
+ #define CHIEF_RT_SAFETY_REPLACES_NEW 1    // global operator new/delete only
+#else
+ #define CHIEF_RT_SAFETY_REPLACES_NEW 0
+#endif
+
+//==============================================================================
+/**
+ * @file RealtimeSafety.h
+ * @brief Diagnostic build mode that catches allocations, locks and blocking calls on audio threads
+ *
+ * Built with CHIEF_RT_SAFETY_CHECKS=1, the device callback and every channel
+ * render job run inside a Scope.  Any heap allocation or free, mutex lock or
+ * blocking system call made while a Scope is open on the calling thread is
+ * a violation.  It is counted, and the first kLogSize are logged with their
+ * raw stack frames in a lock-free log.  The frames are symbolised only when
+ * the message thread asks for getReport().
+ *
+ * What is caught depends on the platform:
+ *   - glibc (Linux): malloc/calloc/realloc/free and the aligned variants,
+ *     pthread mutex/rwlock/condition waits, semaphores, joins, sleeps and
+ *     file calls (fopen, write, fsync; read/open are fortified inlines).
+ *   - Windows debug CRT: every CRT heap call (operator new included), via
+ *     the CRT allocation hook.  Locks are not seen there.
+ *   - elsewhere: the global operator new/delete only.
+ * On Linux, link with -rdynamic so the report shows function names.
+ *
+ * Known, accepted cases are wrapped in a ScopedAllow with the reason next to it.
+ * With the flag off (the default) Scope and ScopedAllow are empty and cost nothing.
+ *
+ * Thread-safety: Scope, ScopedAllow and noteViolation() on any thread;
+ * getReport() allocates — message thread or the benchmark only.
+ */
+class RealtimeSafety
+{
+public:
+    enum class Kind { Allocation, Deallocation, Lock, BlockingCall };
+
+    static constexpr int kLogSize   = 256;
+    static constexpr int kMaxFrames = 24;
+
+    static constexpr bool isEnabled() noexcept { return CHIEF_RT_SAFETY_CHECKS != 0; }
+
+    /** The current thread is realtime until the Scope closes. Nests. */
+    class Scope
+    {
+    public:
+       #if CHIEF_RT_SAFETY_CHECKS
+        Scope() noexcept  { enter(); }
+        ~Scope() noexcept { leave(); }
+       #else
+        Scope() noexcept {}
+       #endif
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(Scope)
+    };
+
+    /** Suspends the checks on this thread — for known, accepted cases only. Nests. */
+    class ScopedAllow
+    {
+    public:
+       #if CHIEF_RT_SAFETY_CHECKS
+        ScopedAllow() noexcept  { allow(+1); }
+        ~ScopedAllow() noexcept { allow(-1); }
+       #else
+        ScopedAllow() noexcept {}
+       #endif
+
+    private:
+        JUCE_DECLARE_NON_COPYABLE(ScopedAllow)
+    };
+
+    /** Violations since the start (or reset()), logged or not. */
+    static int  getNumViolations() noexcept { return numViolations.load(std::memory_order_relaxed); }
+
+    /** Forget the count and the log. Only while no audio thread is running. */
+    static void reset() noexcept;
+
+    /**
+     * @brief Logged violations from firstEntry on, one block of symbolised frames each.
+     * Allocates; never on an audio thread.
+     */
+    static juce::String getReport(int firstEntry = 0, int maxEntries = 16);
+
+    /** Number of violations with a log entry (at most kLogSize). */
+    static int getNumLogged() noexcept
+    {
+        return juce::jmin(kLogSize, nextEntry.load(std::memory_order_acquire));
+    }
+
+    /** True while the calling thread is inside a Scope and not allowed. Interposers only. */
+    static bool isCheckedThread() noexcept;
+
+    /** Count and log a violation of the calling thread. Lock- and allocation-free. */
+    static void noteViolation(Kind kind, const char* what) noexcept;
+
+private:
+    static void enter() noexcept;
+    static void leave() noexcept;
+    static void allow(int delta) noexcept;
+
+    static std::atomic<int> numViolations;
+    static std::atomic<int> nextEntry;
+
+    RealtimeSafety() = delete;
+};
@@ -0,0 +1,780 @@
+#include "RecordJournal.h"
+#include <algorithm>
+
+namespace
+{
+    constexpr juce::uint32 kFileMagic   = 0x524a4c43;   // "CLJR"
+    constexpr int          kFileVersion = 1;
+    constexpr int          kHeaderFlagComplete = 1;
+
+    // Per record: type, channel, section, flags (1 byte each), count (int32), value (int64)
+    constexpr int kRecordBytes   = 16;
+    constexpr int kMaxAudioFrames = 1 << 20;   // sanity limit when reading
+
+    struct SegmentHeader
+    {
+        double      sampleRate {0.0};
+        juce::int64 id {0};
+        bool        complete {false};
+        juce::String baseSong;
+    };
+
+    constexpr int kHeaderBytes = 4 + 4 + 8 + 8 + 4;   // without the base song path
+
+    bool readHeader(juce::InputStream& in, SegmentHeader& h)
+    {
+        if (in.getNumBytesRemaining() < kHeaderBytes + 1) return false;
+        if (static_cast<juce::uint32>(in.readInt()) != kFileMagic || in.readInt() != kFileVersion)
+            return false;
+        h.sampleRate = in.readDouble();
+        h.id         = in.readInt64();
+        h.complete   = (in.readInt() & kHeaderFlagComplete) != 0;
+        h.baseSong   = in.readString();
+        return true;
+    }
+
+    juce::int64 parseSegmentId(const juce::File& f)
+    {
+        return f.getFileNameWithoutExtension().fromFirstOccurrenceOf("segment_", false, false).getLargeIntValue();
+    }
+
+    /** Grow b to hold frames (geometric, capped at maxFrames); new space is silent. */
+    void ensureFrames(juce::AudioBuffer<float>& b, juce::int64 frames, juce::int64 maxFrames)
+    {
+        frames = juce::jmin(frames, maxFrames);
+        if (b.getNumSamples() >= frames) return;
+        const auto size = juce::jmin(maxFrames, juce::jmax<juce::int64>(frames, 2 * static_cast<juce::int64>(b.getNumSamples())));
+        b.setSize(2, static_cast<int>(size), true, true, true);
+    }
+
+    /** Write (or add) planar audio at pos, wrapping at wrapLength. */
+    void writeWrapped(juce::AudioBuffer<float>& dest, const float* l, const float* r, int n,
+                      juce::int64 pos, juce::int64 wrapLength, bool add)
+    {
+        if (wrapLength <= 0) return;
+        for (int done = 0; done < n;)
+        {
+            const juce::int64 p = (pos + done) % wrapLength;
+            const int k = static_cast<int>(juce::jmin<juce::int64>(n - done, wrapLength - p));
+            ensureFrames(dest, p + k, wrapLength);
+
+            const int at = static_cast<int>(p);
+            if (add)
+            {
+                dest.addFrom(0, at, l + done, k);
+                dest.addFrom(1, at, r + done, k);
+            }
+            else
+            {
+                dest.copyFrom(0, at, l + done, k);
+                dest.copyFrom(1, at, r + done, k);
+            }
+            done += k;
+        }
+    }
+}
+
+//==============================================================================
+RecordJournal::RecordJournal()
+    : juce::Thread("Record Journal")
+{
+    for (auto& len : sectionLengths)
+        len.store(0, std::memory_order_relaxed);
+}
+
+RecordJournal::~RecordJournal()
+{
+    stop(false);
+}
+
+juce::File RecordJournal::getDefaultDirectory()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("chief")
+        .getChildFile("journal");
+}
+
+juce::File RecordJournal::getSegmentFile(const juce::File& dir, juce::int64 id)
+{
+    return dir.getChildFile("segment_" + juce::String(id).paddedLeft('0', 8) + ".journal");
+}
+
+juce::Array<juce::File> RecordJournal::findSegments(const juce::File& dir)
+{
+    auto files = dir.findChildFiles(juce::File::findFiles, false, "segment_*.journal");
+    std::sort(files.begin(), files.end(), [](const juce::File& a, const juce::File& b)
+    {
+        return parseSegmentId(a) < parseSegmentId(b);
+    });
+    return files;
+}
+
+//==============================================================================
+// Message thread
+//==============================================================================
+
+juce::Result RecordJournal::start(const juce::File& dir, double rate, int numChannels, bool keepExisting)
+{
+    if (active.load(std::memory_order_relaxed) || isThreadRunning())
+        return juce::Result::fail("Record journal already running");
+    if (rate <= 0.0)
+        return juce::Result::fail("No audio device");
+    if (!dir.createDirectory())
+        return juce::Result::fail("Cannot create: " + dir.getFullPathName());
+
+    const auto existing = findSegments(dir);
+    if (!keepExisting)
+        for (auto& f : existing)
+            f.deleteFile();
+
+    const int ringFrames = juce::roundToInt(rate * kRingSeconds);
+    for (int ch = 0; ch < kNumChannels; ++ch)
+    {
+        // Channels beyond numChannels do not exist in this session: no audio ring
+        auto& lane = lanes[static_cast<size_t>(ch)];
+        const int frames = ch < numChannels ? ringFrames : 0;
+        lane.audioRing.setSize(2, frames, false, true);
+        lane.audio.setTotalSize(juce::jmax(1, frames));
+        lane.audio.reset();
+        lane.events.reset();
+        lane.takeOpen = false;
+    }
+
+    juce::File base;
+    bool complete = false;
+    juce::int64 id = 0;
+    {
+        const juce::ScopedLock sl(controlLock);
+        directory  = dir;
+        sampleRate = rate;
+        if (keepExisting && !existing.isEmpty())
+            nextSegmentId = juce::jmax(nextSegmentId, parseSegmentId(existing.getLast()) + 1);
+        else
+        {
+            base     = pendingBase;     // the replay of a kept journal takes the base of its first segment
+            complete = pendingComplete;
+        }
+        id = nextSegmentId++;
+        requestedSegment = id;
+        committedSegment = keepExisting ? 0 : id;
+    }
+
+    currentSegment = 0;
+    deletedBelow   = keepExisting ? 0 : id;
+    switchSegment(id, base, complete);
+    if (out == nullptr)
+        return juce::Result::fail("Cannot create: " + getSegmentFile(dir, id).getFullPathName());
+
+    dropouts.store(0, std::memory_order_relaxed);
+    bytesWritten.store(0, std::memory_order_relaxed);
+    fill.store(0.0f, std::memory_order_relaxed);
+
+    startThread(juce::Thread::Priority::normal);
+    active.store(true, std::memory_order_release);
+    DBG("Record journal started: " + getSegmentFile(dir, id).getFullPathName());
+    return juce::Result::ok();
+}
+
+void RecordJournal::stop(bool deleteFiles)
+{
+    active.store(false, std::memory_order_release);
+    if (isThreadRunning())
+        stopThread(10000);   // run() writes what is left before it returns
+
+    if (out != nullptr)
+    {
+        out->flush();
+        out.reset();
+    }
+
+    if (deleteFiles && directory != juce::File())
+    {
+        for (auto& f : findSegments(directory))
+            f.deleteFile();
+        DBG("Record journal closed cleanly");
+    }
+}
+
+//==============================================================================
+// Segments
+//==============================================================================
+
+juce::int64 RecordJournal::beginSegment(const juce::File& baseSong, bool baseIsComplete)
+{
+    juce::int64 id = 0;
+    {
+        const juce::ScopedLock sl(controlLock);
+        id = nextSegmentId++;
+        pendingBase     = baseSong;
+        pendingComplete = baseIsComplete;
+        if (!active.load(std::memory_order_acquire))
+            return id;   // start() opens its first segment on this base
+
+        requestedSegment = id;
+        segmentSwitched.reset();
+    }
+
+    notify();
+    if (!segmentSwitched.wait(200))
+        DBG("RecordJournal: segment switch timed out");
+    return id;
+}
+
+void RecordJournal::commitSegment(juce::int64 segmentId)
+{
+    {
+        const juce::ScopedLock sl(controlLock);
+        committedSegment = juce::jmax(committedSegment, segmentId);
+    }
+    notify();
+}
+
+//==============================================================================
+// Producers (audio/render threads)
+//==============================================================================
+
+void RecordJournal::pushEvent(int channel, const Event& e) noexcept
+{
+    if (channel < 0 || channel >= kNumChannels || !active.load(std::memory_order_acquire)) return;
+
+    auto& lane = lanes[static_cast<size_t>(channel)];
+    int s1, n1, s2, n2;
+    lane.events.prepareToWrite(1, s1, n1, s2, n2);
+    if (n1 <= 0)
+    {
+        dropouts.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    lane.eventRing[static_cast<size_t>(s1)] = e;
+    lane.events.finishedWrite(1);
+}
+
+void RecordJournal::takeStarted(int channel, int section, bool overdub, juce::int64 layerLength) noexcept
+{
+    Event e;
+    e.type    = Type::TakeStart;
+    e.section = static_cast<juce::uint8>(section);
+    e.flags   = overdub ? kFlagOverdub : 0;
+    e.value   = layerLength;
+    pushEvent(channel, e);
+}
+
+void RecordJournal::takeEnded(int channel, int section) noexcept
+{
+    Event e;
+    e.type    = Type::TakeEnd;
+    e.section = static_cast<juce::uint8>(section);
+    pushEvent(channel, e);
+}
+
+void RecordJournal::audioWritten(int channel, int section, bool overdub,
+                                 const juce::AudioBuffer<float>& source, int sourceStart,
+                                 juce::int64 startPos, int numSamples) noexcept
+{
+    if (channel < 0 || channel >= kNumChannels || !active.load(std::memory_order_acquire)) return;
+    if (numSamples <= 0 || sourceStart < 0 || source.getNumChannels() < 2
+        || source.getNumSamples() < sourceStart + numSamples) return;
+
+    // Audio first, record second: the writer only sees a record whose frames are ready.
+    // Single producer, so the free space checked here can only grow before we write.
+    auto& lane = lanes[static_cast<size_t>(channel)];
+    if (lane.events.getFreeSpace() < 1 || lane.audio.getFreeSpace() < numSamples)
+    {
+        dropouts.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    int s1, n1, s2, n2;
+    lane.audio.prepareToWrite(numSamples, s1, n1, s2, n2);
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        if (n1 > 0) lane.audioRing.copyFrom(ch, s1, source, ch, sourceStart,      n1);
+        if (n2 > 0) lane.audioRing.copyFrom(ch, s2, source, ch, sourceStart + n1, n2);
+    }
+    lane.audio.finishedWrite(n1 + n2);
+
+    Event e;
+    e.type    = Type::Audio;
+    e.section = static_cast<juce::uint8>(section);
+    e.flags   = overdub ? kFlagOverdub : 0;
+    e.count   = numSamples;
+    e.value   = startPos;
+    pushEvent(channel, e);
+}
+
+void RecordJournal::layerUndone(int channel, int section) noexcept
+{
+    Event e;
+    e.type    = Type::Undo;
+    e.section = static_cast<juce::uint8>(section);
+    pushEvent(channel, e);
+}
+
+void RecordJournal::sectionCleared(int channel, int section) noexcept
+{
+    Event e;
+    e.type    = Type::Clear;
+    e.section = static_cast<juce::uint8>(section);
+    pushEvent(channel, e);
+}
+
+void RecordJournal::sectionDoubled(int channel, int section, juce::int64 loopLength) noexcept
+{
+    Event e;
+    e.type    = Type::Double;
+    e.section = static_cast<juce::uint8>(section);
+    e.value   = loopLength;
+    pushEvent(channel, e);
+}
+
+void RecordJournal::layersFlattened(int channel, int section, int numMerged) noexcept
+{
+    Event e;
+    e.type    = Type::Flatten;
+    e.section = static_cast<juce::uint8>(section);
+    e.count   = numMerged;
+    pushEvent(channel, e);
+}
+
+//==============================================================================
+// Writer thread
+//==============================================================================
+
+void RecordJournal::run()
+{
+    while (!threadShouldExit())
+    {
+        //--- 1. Segment requests: everything queued so far still goes to the old segment ---
+        juce::int64 requested = 0, committed = 0;
+        juce::File base;
+        bool complete = false;
+        {
+            const juce::ScopedLock sl(controlLock);
+            requested = requestedSegment;
+            committed = committedSegment;
+            base      = pendingBase;
+            complete  = pendingComplete;
+        }
+
+        if (requested > currentSegment)
+        {
+            for (int ch = 0; ch < kNumChannels; ++ch)
+                while (drainLane(ch)) {}
+            writeLengths();
+            switchSegment(requested, base, complete);
+            segmentSwitched.signal();
+        }
+        if (committed > deletedBelow && committed <= currentSegment)
+        {
+            deleteSegmentsBelow(committed);
+            deletedBelow = committed;
+        }
+
+        //--- 2. Records ---
+        bool  wrote   = false;
+        float current = 0.0f;
+        for (int ch = 0; ch < kNumChannels; ++ch)
+        {
+            const auto& audio = lanes[static_cast<size_t>(ch)].audio;
+            current = juce::jmax(current, static_cast<float>(audio.getNumReady())
+                                          / static_cast<float>(juce::jmax(1, audio.getTotalSize() - 1)));
+            wrote |= drainLane(ch);
+        }
+        fill.store(current, std::memory_order_relaxed);
+        writeLengths();
+
+        //--- 3. To disk once per interval (flush() syncs the file) ---
+        const auto now = juce::Time::getMillisecondCounter();
+        if (out != nullptr && now - lastFlushMs >= static_cast<juce::uint32>(kFlushIntervalMs))
+        {
+            out->flush();
+            lastFlushMs = now;
+        }
+
+        if (!wrote)
+            wait(10);
+    }
+
+    for (int ch = 0; ch < kNumChannels; ++ch)
+        while (drainLane(ch)) {}
+    writeLengths();
+    if (out != nullptr)
+        out->flush();
+}
+
+bool RecordJournal::drainLane(int channel)
+{
+    auto& lane = lanes[static_cast<size_t>(channel)];
+    const int ready = lane.events.getNumReady();
+    if (ready <= 0) return false;
+
+    auto handle = [this, &lane, channel](int index)
+    {
+        const auto& e = lane.eventRing[static_cast<size_t>(index)];
+
+        switch (e.type)
+        {
+            case Type::TakeStart:
+                lane.openTake = e;
+                lane.takeOpen = true;
+                break;
+            case Type::TakeEnd:
+            case Type::Clear:
+                if (lane.openTake.section == e.section) lane.takeOpen = false;
+                break;
+            case Type::Undo:
+                if (lane.openTake.section == e.section && (lane.openTake.flags & kFlagOverdub) != 0)
+                    lane.takeOpen = false;
+                break;
+            default:
+                break;
+        }
+
+        writeRecord(e, channel);
+
+        if (e.type != Type::Audio) return;
+
+        // Planar payload: all left frames, then all right frames (native float layout)
+        int s1, n1, s2, n2;
+        lane.audio.prepareToRead(e.count, s1, n1, s2, n2);
+        if (out != nullptr)
+        {
+            for (int ch = 0; ch < 2; ++ch)
+            {
+                if (n1 > 0) out->write(lane.audioRing.getReadPointer(ch, s1), static_cast<size_t>(n1) * sizeof(float));
+                if (n2 > 0) out->write(lane.audioRing.getReadPointer(ch, s2), static_cast<size_t>(n2) * sizeof(float));
+            }
+            bytesWritten.fetch_add(static_cast<juce::int64>(n1 + n2) * 2 * static_cast<juce::int64>(sizeof(float)),
+                                   std::memory_order_relaxed);
+        }
+        lane.audio.finishedRead(n1 + n2);
+    };
+
+    int s1, n1, s2, n2;
+    lane.events.prepareToRead(ready, s1, n1, s2, n2);
+    for (int i = 0; i < n1; ++i) handle(s1 + i);
+    for (int i = 0; i < n2; ++i) handle(s2 + i);
+    lane.events.finishedRead(n1 + n2);
+    return true;
+}
+
+void RecordJournal::writeLengths()
+{
+    for (int s = 0; s < kNumSections; ++s)
+    {
+        const auto len = sectionLengths[static_cast<size_t>(s)].load(std::memory_order_relaxed);
+        if (len == writtenLengths[static_cast<size_t>(s)]) continue;
+
+        Event e;
+        e.type    = Type::Length;
+        e.section = static_cast<juce::uint8>(s);
+        e.value   = len;
+        writeRecord(e, 0);
+        writtenLengths[static_cast<size_t>(s)] = len;
+    }
+}
+
+void RecordJournal::writeRecord(const Event& e, int channel)
+{
+    if (out == nullptr) return;
+    out->writeByte(static_cast<char>(e.type));
+    out->writeByte(static_cast<char>(channel));
+    out->writeByte(static_cast<char>(e.section));
+    out->writeByte(static_cast<char>(e.flags));
+    out->writeInt(e.count);
+    out->writeInt64(e.value);
+    bytesWritten.fetch_add(kRecordBytes, std::memory_order_relaxed);
+}
+
+void RecordJournal::switchSegment(juce::int64 id, const juce::File& base, bool baseIsComplete)
+{
+    if (out != nullptr)
+    {
+        out->flush();
+        out.reset();
+    }
+
+    const auto file = getSegmentFile(directory, id);
+    file.deleteFile();
+    out = std::make_unique<juce::FileOutputStream>(file, kDiskBufferBytes);
+    if (!out->openedOk())
+    {
+        DBG("RecordJournal: cannot create " + file.getFullPathName());
+        out.reset();
+    }
+    currentSegment = id;
+    if (out == nullptr) return;
+
+    out->writeInt(static_cast<int>(kFileMagic));
+    out->writeInt(kFileVersion);
+    out->writeDouble(sampleRate);
+    out->writeInt64(id);
+    out->writeInt(baseIsComplete ? kHeaderFlagComplete : 0);
+    out->writeString(base.getFullPathName());
+
+    // Takes still running continue in this segment
+    for (int ch = 0; ch < kNumChannels; ++ch)
+    {
+        const auto& lane = lanes[static_cast<size_t>(ch)];
+        if (!lane.takeOpen) continue;
+        auto e = lane.openTake;
+        e.flags |= kFlagContinued;
+        writeRecord(e, ch);
+    }
+
+    writtenLengths.fill(-1);   // every segment states the lengths it starts from
+    writeLengths();
+    out->flush();
+    lastFlushMs = juce::Time::getMillisecondCounter();
+}
+
+void RecordJournal::deleteSegmentsBelow(juce::int64 id)
+{
+    for (auto& f : findSegments(directory))
+        if (parseSegmentId(f) < id)
+            f.deleteFile();
+}
+
+//==============================================================================
+// Recovery (message thread)
+//==============================================================================
+
+namespace
+{
+    /** Segments from the newest one whose base is complete (or the first one). */
+    juce::Array<juce::File> findReplaySegments(const juce::Array<juce::File>& all)
+    {
+        int first = 0;
+        for (int i = 0; i < all.size(); ++i)
+        {
+            juce::FileInputStream in(all[i]);
+            SegmentHeader h;
+            if (in.openedOk() && readHeader(in, h) && h.complete)
+                first = i;
+        }
+
+        juce::Array<juce::File> result;
+        for (int i = first; i < all.size(); ++i)
+            result.add(all[i]);
+        return result;
+    }
+}
+
+bool RecordJournal::hasUnfinishedSession(const juce::File& dir)
+{
+    for (auto& f : findReplaySegments(findSegments(dir)))
+    {
+        juce::FileInputStream in(f);
+        SegmentHeader h;
+        if (!in.openedOk() || !readHeader(in, h)) continue;
+
+        // Lengths alone are what every segment starts with — anything else was recorded
+        while (in.getNumBytesRemaining() >= kRecordBytes)
+        {
+            const auto type = static_cast<Type>(in.readByte());
+            if (type != Type::Length)
+                return true;
+            in.skipNextBytes(kRecordBytes - 1);
+        }
+    }
+    return false;
+}
+
+juce::File RecordJournal::readBaseSong(const juce::File& dir)
+{
+    const auto segments = findReplaySegments(findSegments(dir));
+    if (segments.isEmpty()) return {};
+
+    juce::FileInputStream in(segments.getFirst());
+    SegmentHeader h;
+    if (!in.openedOk() || !readHeader(in, h) || h.baseSong.isEmpty())
+        return {};
+    return juce::File(h.baseSong);
+}
+
+juce::Result RecordJournal::readRecovery(const juce::File& dir, juce::int64 maxFrames,
+                                         const SeedFunction& seed, Recovery& out)
+{
+    const auto segments = findReplaySegments(findSegments(dir));
+    if (segments.isEmpty())
+        return juce::Result::fail("No record journal in " + dir.getFullPathName());
+    if (maxFrames <= 0)
+        return juce::Result::fail("Channels not prepared");
+
+    out = {};
+    out.sectionLengths.fill(-1);
+
+    // First record that builds on the base song's audio pulls it in
+    auto touch = [&](int ch, int s, bool fromSong) -> RecoveredSection&
+    {
+        auto& sec = out.sections[static_cast<size_t>(ch)][static_cast<size_t>(s)];
+        if (!sec.touched)
+        {
+            sec.touched = true;
+            if (fromSong && seed)
+                seed(ch, s, sec.base, sec.baseLength);
+        }
+        return sec;
+    };
+
+    auto reset = [](RecoveredSection& sec)
+    {
+        sec.base.setSize(2, 0);
+        sec.baseLength = 0;
+        sec.layers.clear();
+    };
+
+    juce::HeapBlock<float> audio;
+    int audioCapacity = 0;
+
+    for (int segIdx = 0; segIdx < segments.size(); ++segIdx)
+    {
+        juce::FileInputStream in(segments[segIdx]);
+        SegmentHeader h;
+        if (!in.openedOk() || !readHeader(in, h))
+        {
+            DBG("RecordJournal: damaged segment " + segments[segIdx].getFileName() + " skipped");
+            continue;
+        }
+        if (segIdx == 0)
+        {
+            out.sampleRate = h.sampleRate;
+            if (h.baseSong.isNotEmpty())
+                out.baseSong = juce::File(h.baseSong);
+        }
+
+        while (in.getNumBytesRemaining() >= kRecordBytes)
+        {
+            const auto type  = static_cast<Type>(in.readByte());
+            const int  ch    = static_cast<juce::uint8>(in.readByte());
+            const int  s     = static_cast<juce::uint8>(in.readByte());
+            const auto flags = static_cast<juce::uint8>(in.readByte());
+            const int  count = in.readInt();
+            const auto value = in.readInt64();
+
+            if (ch >= kNumChannels || s >= kNumSections) break;   // damaged tail
+            const bool overdub = (flags & kFlagOverdub) != 0;
+
+            if (type == Type::Audio)
+            {
+                if (count <= 0 || count > kMaxAudioFrames || value < 0) break;
+                const auto bytes = static_cast<juce::int64>(count) * 2 * static_cast<juce::int64>(sizeof(float));
+                if (in.getNumBytesRemaining() < bytes) break;      // crash during this record
+
+                if (count > audioCapacity)
+                {
+                    audio.allocate(static_cast<size_t>(count) * 2, false);
+                    audioCapacity = count;
+                }
+                in.read(audio.getData(), static_cast<int>(bytes));
+                const float* l = audio.getData();
+                const float* r = audio.getData() + count;
+
+                auto& sec = touch(ch, s, true);
+                if (overdub)
+                {
+                    if (sec.layers.empty())   // its take start was dropped
+                        sec.layers.push_back({ {}, maxFrames, false });
+                    auto& layer = sec.layers.back();
+                    writeWrapped(layer.audio, l, r, count, value, layer.length, true);
+                    layer.written = true;
+                }
+                else
+                {
+                    writeWrapped(sec.base, l, r, count, value, maxFrames, false);
+                    sec.baseLength = juce::jmin(maxFrames, juce::jmax(sec.baseLength, value + count));
+                }
+                ++out.numRecords;
+                continue;
+            }
+
+            switch (type)
+            {
+                case Type::TakeStart:
+                {
+                    const bool continued = (flags & kFlagContinued) != 0;
+                    auto& sec = touch(ch, s, overdub || continued);
+                    if (overdub)
+                        sec.layers.push_back({ {}, value > 0 ? juce::jmin(value, maxFrames) : maxFrames, false });
+                    else if (!continued)
+                        reset(sec);
+                    break;
+                }
+
+                case Type::Undo:
+                {
+                    auto& sec = out.sections[static_cast<size_t>(ch)][static_cast<size_t>(s)];
+                    if (sec.touched && !sec.layers.empty())
+                        sec.layers.pop_back();   // layers of the base song are baked in, not undoable
+                    break;
+                }
+
+                case Type::Clear:
+                    reset(touch(ch, s, false));
+                    break;
+
+                case Type::Double:
+                {
+                    auto& sec = touch(ch, s, true);
+                    if (value <= 0 || value * 2 > maxFrames) break;
+
+                    ensureFrames(sec.base, value * 2, maxFrames);
+                    const int len = static_cast<int>(value);
+                    for (int c = 0; c < 2; ++c)
+                        sec.base.copyFrom(c, len, sec.base, c, 0, len);
+                    sec.baseLength = value * 2;
+
+                    for (auto& layer : sec.layers)
+                    {
+                        const auto layerLen = juce::jmin(value, layer.length);
+                        ensureFrames(layer.audio, layerLen * 2, layerLen * 2);
+                        for (int c = 0; c < 2; ++c)
+                            layer.audio.copyFrom(c, static_cast<int>(layerLen), layer.audio, c, 0, static_cast<int>(layerLen));
+                        layer.length = layerLen * 2;
+                    }
+                    break;
+                }
+
+                case Type::Flatten:
+                {
+                    auto& sec = out.sections[static_cast<size_t>(ch)][static_cast<size_t>(s)];
+                    if (!sec.touched) break;   // the base song has its layers mixed in already
+
+                    const int merge = juce::jmin(count, static_cast<int>(sec.layers.size()));
+                    for (int i = 0; i < merge; ++i)
+                    {
+                        const auto& layer = sec.layers[static_cast<size_t>(i)];
+                        if (!layer.written || layer.length <= 0) continue;
+                        for (juce::int64 pos = 0; pos < sec.baseLength;)
+                        {
+                            const auto p = pos % layer.length;
+                            const int  k = static_cast<int>(juce::jmin(sec.baseLength - pos,
+                                                            juce::jmin<juce::int64>(layer.length - p,
+                                                                layer.audio.getNumSamples() - p)));
+                            if (k <= 0) { pos += layer.length - p; continue; }
+                            for (int c = 0; c < 2; ++c)
+                                sec.base.addFrom(c, static_cast<int>(pos), layer.audio, c, static_cast<int>(p), k);
+                            pos += k;
+                        }
+                    }
+                    sec.layers.erase(sec.layers.begin(), sec.layers.begin() + merge);
+                    break;
+                }
+
+                case Type::Length:
+                    out.sectionLengths[static_cast<size_t>(s)] = value;
+                    break;
+
+                case Type::TakeEnd:
+                case Type::Audio:
+                default:
+                    break;
+            }
+            ++out.numRecords;
+        }
+    }
+
+    DBG("Record journal: " + juce::String(out.numRecords) + " records in "
+        + juce::String(segments.size()) + " segment(s) replayed");
+    return juce::Result::ok();
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file RecordJournal.h
+ * @brief Append-only crash-recovery journal of everything recorded into the loops
+ *
+ * Loop audio only reaches the song directory when a song is saved.  The
+ * journal closes that gap: every take start, every block written by
+ * Channel::recordToLoop(), undo, clear, double and flatten is pushed by the
+ * channel into its own lock-free ring (one producer: the thread rendering the
+ * channel, one consumer: the "Record Journal" thread).  The writer appends the
+ * records to the current segment file through a large stream buffer and
+ * flushes it to disk about once per second (kFlushIntervalMs).
+ *
+ * Segments: the first record of a segment names its base song (the song.json
+ * whose state the records apply to).  Loading a song rebases the journal —
+ * earlier segments are deleted.  Saving rotates to a new segment before the
+ * snapshot is taken and deletes the older ones once the save has finished;
+ * until then recovery replays all of them on top of the older base.  A take
+ * that is running across the rotation is continued in the new segment, so
+ * the few milliseconds between rotation and snapshot may be replayed twice.
+ *
+ * Recovery (startup, message thread): readRecovery() replays the segments
+ * into plain AudioBuffers per channel/section; SongManager loads the base
+ * song and applies the result.  Only loop audio and section lengths are
+ * journaled — channel settings and plugins come from the base song.
+ *
+ * If a ring is full the block is dropped and counted (getNumDropouts()); the
+ * recovered take then has silence there.  The live loop is never affected.
+ *
+ * Thread-safety:
+ *   Audio/render threads: the producer functions (takeStarted() … publishSectionLength())
+ *   Message thread      : start(), stop(), readRecovery()
+ *   Any non-audio thread: beginSegment(), commitSegment(), rebase()
+ */
+class RecordJournal : private juce::Thread
+{
+public:
+    static constexpr int    kNumChannels     = 16;     // MAX_CHANNELS (Channel.h)
+    static constexpr int    kNumSections     = 3;
+    static constexpr double kRingSeconds     = 2.0;
+    static constexpr int    kEventCapacity   = 4096;      // records per channel ring
+    static constexpr int    kFlushIntervalMs = 1000;
+    static constexpr size_t kDiskBufferBytes = 1 << 20;
+
+    RecordJournal();
+    ~RecordJournal() override;
+
+    /** chief/journal in the application data folder. */
+    static juce::File getDefaultDirectory();
+
+    /** true if the directory holds segments with records a crash left behind. */
+    static bool hasUnfinishedSession(const juce::File& directory);
+
+    //==========================================================================
+    // Message thread
+
+    /**
+     * @brief Allocate the rings and start journaling into directory.
+     * @param numChannels   Channels that get a ring; records of the others are dropped
+     * @param keepExisting  true after a recovery: the old segments stay and the
+     *                      journal continues after them; false deletes them and
+     *                      starts a segment based on the last rebase() song.
+     */
+    juce::Result start(const juce::File& directory, double sampleRate, int numChannels, bool keepExisting);
+
+    /** Write what is left and close the segment. deleteFiles after a clean shutdown. */
+    void stop(bool deleteFiles);
+
+    bool isRunning() const noexcept { return active.load(std::memory_order_acquire); }
+
+    //==========================================================================
+    // Segments (message thread or save thread)
+
+    /**
+     * @brief Continue in a new segment whose records apply on top of baseSong.
+     *
+     * Blocks until the writer has switched (a few ms).  Before start() it only
+     * sets the base of the first segment.
+     * @param baseIsComplete  baseSong already holds everything (a loaded song):
+     *                        recovery ignores the segments before this one
+     * @return Segment id for commitSegment()
+     */
+    juce::int64 beginSegment(const juce::File& baseSong, bool baseIsComplete = false);
+
+    /** baseSong of that segment is complete on disk: drop every older segment. */
+    void commitSegment(juce::int64 segmentId);
+
+    /** A song was loaded: the journal restarts from it. */
+    void rebase(const juce::File& loadedSong) { commitSegment(beginSegment(loadedSong, true)); }
+
+    //==========================================================================
+    // Producers (audio/render threads, lock-free, never block)
+
+    void takeStarted(int channel, int section, bool overdub, juce::int64 layerLength) noexcept;
+    void takeEnded(int channel, int section) noexcept;
+    /** numSamples frames of source from sourceStart, written to the loop at startPos. */
+    void audioWritten(int channel, int section, bool overdub,
+                      const juce::AudioBuffer<float>& source, int sourceStart,
+                      juce::int64 startPos, int numSamples) noexcept;
+    void layerUndone(int channel, int section) noexcept;
+    void sectionCleared(int channel, int section) noexcept;
+    void sectionDoubled(int channel, int section, juce::int64 loopLength) noexcept;
+    void layersFlattened(int channel, int section, int numMerged) noexcept;
+
+    /** Audio thread, once per callback: the writer journals lengths that changed. */
+    void publishSectionLength(int section, juce::int64 length) noexcept
+    {
+        if (section >= 0 && section < kNumSections)
+            sectionLengths[static_cast<size_t>(section)].store(length, std::memory_order_relaxed);
+    }
+
+    //==========================================================================
+    // Recovery
+
+    struct RecoveredLayer
+    {
+        juce::AudioBuffer<float> audio;
+        juce::int64 length {0};       // wrap length of the layer
+        bool        written {false};
+    };
+
+    struct RecoveredSection
+    {
+        bool touched {false};         // the journal changed this section
+        juce::AudioBuffer<float> base;
+        juce::int64 baseLength {0};   // frames of base holding audio
+        std::vector<RecoveredLayer> layers;
+    };
+
+    struct Recovery
+    {
+        juce::File  baseSong;         // empty: no song was loaded or saved
+        double      sampleRate {0.0};
+        int         numRecords {0};
+        std::array<juce::int64, kNumSections> sectionLengths;   // -1 = as in the base song
+        std::array<std::array<RecoveredSection, kNumSections>, kNumChannels> sections;
+    };
+
+    /** Fills base with the section as the base song has it (the replay starts from there). */
+    using SeedFunction = std::function<void(int channel, int section, juce::AudioBuffer<float>& base,
+                                            juce::int64& baseLength)>;
+
+    /** Read the unfinished session's base song only (to load it before the replay). */
+    static juce::File readBaseSong(const juce::File& directory);
+
+    /**
+     * @brief Replay every segment of directory into out.
+     * @param maxFrames  Loop buffer capacity; nothing is rebuilt beyond it
+     * @param seed       Called the first time a record builds on the base song's audio
+     */
+    static juce::Result readRecovery(const juce::File& directory, juce::int64 maxFrames,
+                                     const SeedFunction& seed, Recovery& out);
+
+    //==========================================================================
+    // Diagnostics (any thread)
+    int         getNumDropouts()   const noexcept { return dropouts.load(std::memory_order_relaxed); }
+    juce::int64 getBytesWritten()  const noexcept { return bytesWritten.load(std::memory_order_relaxed); }
+    float       getFill()          const noexcept { return fill.load(std::memory_order_relaxed); }   // 0..1, fullest audio ring
+
+private:
+    enum class Type : juce::uint8
+    {
+        TakeStart = 1, TakeEnd, Audio, Undo, Clear, Double, Flatten, Length
+    };
+
+    static constexpr juce::uint8 kFlagOverdub   = 1;
+    static constexpr juce::uint8 kFlagContinued = 2;
+
+    struct Event
+    {
+        Type        type {Type::Audio};
+        juce::uint8 section {0};
+        juce::uint8 flags {0};
+        juce::int32 count {0};        // Audio: frames (in the audio ring), Flatten: layers merged
+        juce::int64 value {0};        // Audio: start position, TakeStart: layer length, Double: loop length
+    };
+
+    struct Lane
+    {
+        juce::AbstractFifo events {kEventCapacity};
+        std::array<Event, kEventCapacity> eventRing;
+        juce::AbstractFifo audio {1};
+        juce::AudioBuffer<float> audioRing;
+
+        // Writer thread: the take that is open, re-announced in a new segment
+        bool  takeOpen {false};
+        Event openTake;
+    };
+
+    std::array<Lane, kNumChannels> lanes;
+    std::array<std::atomic<juce::int64>, kNumSections> sectionLengths;
+    std::array<juce::int64, kNumSections> writtenLengths {};   // writer thread
+
+    std::atomic<bool> active {false};
+    std::atomic<int>         dropouts     {0};
+    std::atomic<juce::int64> bytesWritten {0};
+    std::atomic<float>       fill         {0.0f};   // writer thread, once per pass
+
+    // Segment control (controlLock): requested by beginSegment()/commitSegment(), done by the writer
+    juce::CriticalSection controlLock;
+    juce::File       directory;
+    juce::File       pendingBase;
+    bool             pendingComplete {false};
+    juce::int64      nextSegmentId {1};
+    juce::int64      requestedSegment {0};    // > currentSegment: switch
+    juce::int64      committedSegment {0};    // delete segments below this one
+    juce::WaitableEvent segmentSwitched;
+
+    // Writer thread
+    std::unique_ptr<juce::FileOutputStream> out;
+    juce::int64  currentSegment {0};
+    juce::int64  deletedBelow {0};
+    juce::uint32 lastFlushMs {0};
+    double       sampleRate {0.0};
+
+    void run() override;
+    bool drainLane(int channel);                            // true if records were written
+    void writeLengths();
+    void switchSegment(juce::int64 id, const juce::File& base, bool baseIsComplete);
+    void deleteSegmentsBelow(juce::int64 id);
+    void writeRecord(const Event& e, int channel);
+
+    void pushEvent(int channel, const Event& e) noexcept;
+
+    static juce::File getSegmentFile(const juce::File& dir, juce::int64 id);
+    static juce::Array<juce::File> findSegments(const juce::File& dir);   // oldest first
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(RecordJournal)
+};
@@ -4,10 +4,13 @@
 //==============================================================================
 ShowComponent::ShowComponent(AudioEngine& engine,
                              SongManager& songMgr,
-                             ShowManager& showMgr)
+                             ShowManager& showMgr,
+                             UiRefreshClock& refreshClock)
     : audioEngine(engine)
     , songManager(songMgr)
     , showManager(showMgr)
+    , uiClock(refreshClock)
+    , songPreloader(songMgr, engine.getLoopPagePool())
 {
     //--------------------------------------------------------------------------
     // New button — context menu
@@ -54,10 +57,10 @@ ShowComponent::ShowComponent(AudioEngine& engine,
     audioEngine.getMidiLearnManager().onPrevSong = [this] { prevSongClicked(); };
 
     updateSongPositionLabel();
-    startTimer(500);
+    uiClock.addClient(*this, kRefreshHz);
 }
 
-ShowComponent::~ShowComponent() { stopTimer(); }
+ShowComponent::~ShowComponent() { uiClock.removeClient(*this); }
 
 //==============================================================================
 void ShowComponent::paint(juce::Graphics& g)
@@ -98,8 +101,15 @@ void ShowComponent::resized()
 }
 
 //==============================================================================
-void ShowComponent::timerCallback()
+void ShowComponent::uiRefresh()
 {
+    if (songWaitingForPreload >= 0)
+    {
+        const int index = std::exchange(songWaitingForPreload, -1);
+        uiClock.addClient(*this, kRefreshHz);
+        loadAndApplySong(index);   // waits again if the preload is still running
+    }
+
     updateSongPositionLabel();
 
     // Enable +Show only when a show is loaded
@@ -108,6 +118,27 @@ void ShowComponent::timerCallback()
 
 void ShowComponent::updateSongPositionLabel()
 {
+    if (saveProgress >= 0.0f)
+    {
+        songPositionLabel.setText("Saving... " + juce::String(juce::roundToInt(saveProgress * 100.0f)) + "%",
+                                  juce::dontSendNotification);
+        return;
+    }
+
+    if (convertProgress >= 0.0f)
+    {
+        songPositionLabel.setText("Converting... " + juce::String(juce::roundToInt(convertProgress * 100.0f)) + "%",
+                                  juce::dontSendNotification);
+        return;
+    }
+
+    if (songWaitingForPreload >= 0 && songWaitingForPreload < currentShow.songPaths.size())
+    {
+        songPositionLabel.setText("Loading " + currentShow.songPaths[songWaitingForPreload].getFileName() + "...",
+                                  juce::dontSendNotification);
+        return;
+    }
+
     if (!showLoaded || currentShow.songPaths.isEmpty())
     {
         songPositionLabel.setText("No Song", juce::dontSendNotification);
@@ -200,6 +231,7 @@ void ShowComponent::newSongClicked()
     if (!audioIsReady) return;
 
     // Reset everything first
+    songWaitingForPreload = -1;
     audioEngine.setPlaying(false);
     audioEngine.resetSong();
 
@@ -223,6 +255,8 @@ void ShowComponent::newSongClicked()
 
 void ShowComponent::newShowClicked()
 {
+    songPreloader.cancel();
+    songWaitingForPreload = -1;
     currentShow = Show();
     showLoaded = true;
     currentSongIndex = -1;
@@ -379,31 +413,86 @@ bool ShowComponent::loadAndApplySong(int showSongIndex)
         return false;
     }
 
+    // Preloaded: loop audio and mix swapped in by the audio thread at the loop boundary
+    songWaitingForPreload = -1;
     Song song;
-    auto result = songManager.loadSong(songFile, song);
-    if (!result.wasOk())
+    std::unique_ptr<StandbySong> preloaded;
+    const auto taken = songPreloader.take(songDir, song, preloaded);
+    if (taken == SongPreloader::TakeResult::StillLoading)
     {
-        juce::AlertWindow::showMessageBoxAsync(
-            juce::AlertWindow::WarningIcon, "Load Song",
-            "Failed to load: " + result.getErrorMessage());
-        return false;
+        // Still decoding: take it from a later tick instead of blocking here
+        songWaitingForPreload = showSongIndex;
+        uiClock.addClient(*this, kPreloadPollHz);
+        updateSongPositionLabel();
+        return true;
     }
 
-    result = songManager.applySongToEngine(song, audioEngine);
-    if (!result.wasOk())
+    bool applied = taken == SongPreloader::TakeResult::Taken
+                && songManager.applyPreloadedSong(song, std::move(preloaded), audioEngine).wasOk();
+
+    if (!applied)
     {
-        juce::AlertWindow::showMessageBoxAsync(
-            juce::AlertWindow::WarningIcon, "Apply Song",
-            "Failed to apply song: " + result.getErrorMessage());
-        return false;
+        song = Song();
+        auto result = songManager.loadSong(songFile, song);
+        if (!result.wasOk())
+        {
+            juce::AlertWindow::showMessageBoxAsync(
+                juce::AlertWindow::WarningIcon, "Load Song",
+                "Failed to load: " + result.getErrorMessage());
+            return false;
+        }
+
+        applySongAsync(song, "Apply Song");   // converts off this thread if the rate differs
     }
 
     lastBrowseLocation = songDir;
     currentSongIndex = showSongIndex;
     updateSongPositionLabel();
+    preloadNextSong();
     return true;
 }
 
+void ShowComponent::applySongAsync(const Song& song, const juce::String& title)
+{
+    // Converted in the background when recorded at another rate; the label shows progress
+    juce::Component::SafePointer<ShowComponent> safeThis(this);
+    songManager.applySongToEngineAsync(song, audioEngine,
+        [safeThis](float progress)
+        {
+            if (safeThis != nullptr)
+            {
+                safeThis->convertProgress = progress;
+                safeThis->updateSongPositionLabel();
+            }
+        },
+        [safeThis, title](juce::Result result)
+        {
+            if (safeThis != nullptr)
+            {
+                safeThis->convertProgress = -1.0f;
+                safeThis->updateSongPositionLabel();
+            }
+
+            if (!result.wasOk())
+            {
+                juce::AlertWindow::showMessageBoxAsync(
+                    juce::AlertWindow::WarningIcon, title,
+                    "Failed to apply song: " + result.getErrorMessage());
+            }
+        });
+}
+
+void ShowComponent::preloadNextSong()
+{
+    const int total = currentShow.songPaths.size();
+    if (!showLoaded || total < 2 || currentSongIndex < 0) return;
+
+    const int next = (currentSongIndex >= total - 1) ? 0 : currentSongIndex + 1;
+    auto* ch = audioEngine.getChannel(0);
+    songPreloader.preload(currentShow.songPaths[next], ch ? ch->getLoopBufferSize() : 0,
+                          audioEngine.getSampleRate());
+}
+
 //==============================================================================
 // Individual song handlers
 //==============================================================================
@@ -430,13 +519,13 @@ void ShowComponent::loadSongClicked()
         if (!file.existsAsFile()) return;
 
         lastBrowseLocation = file.getParentDirectory();
+        songWaitingForPreload = -1;   // this one replaces a show song still waiting
 
         Song song;
         auto result = songManager.loadSong(file, song);
         if (result.wasOk())
-            result = songManager.applySongToEngine(song, audioEngine);
-
-        if (!result.wasOk())
+            applySongAsync(song, "Load Song");
+        else
         {
             juce::AlertWindow::showMessageBoxAsync(
                 juce::AlertWindow::WarningIcon, "Load Song",
@@ -470,14 +559,35 @@ void ShowComponent::saveSongClicked()
         song.songName      = songName;
         song.songDirectory = dir;
 
-        const auto saveResult = songManager.saveSong(song, audioEngine);
+        // Loop audio is mixed and written in the background; the label shows progress
+        juce::Component::SafePointer<ShowComponent> safeThis(this);
+        saveProgress = 0.0f;
+        updateSongPositionLabel();
 
-        if (!saveResult.wasOk())
-        {
-            juce::AlertWindow::showMessageBoxAsync(
-                juce::AlertWindow::WarningIcon, "Save Song",
-                "Failed to save: " + saveResult.getErrorMessage());
-        }
+        songManager.saveSongAsync(song, audioEngine,
+            [safeThis](float progress)
+            {
+                if (safeThis != nullptr)
+                {
+                    safeThis->saveProgress = progress;
+                    safeThis->updateSongPositionLabel();
+                }
+            },
+            [safeThis](juce::Result saveResult)
+            {
+                if (safeThis != nullptr)
+                {
+                    safeThis->saveProgress = -1.0f;
+                    safeThis->updateSongPositionLabel();
+                }
+
+                if (!saveResult.wasOk())
+                {
+                    juce::AlertWindow::showMessageBoxAsync(
+                        juce::AlertWindow::WarningIcon, "Save Song",
+                        "Failed to save: " + saveResult.getErrorMessage());
+                }
+            });
     });
 }
 
@@ -507,6 +617,7 @@ void ShowComponent::loadSongTemplateClicked()
         if (!file.existsAsFile()) return;
 
         lastBrowseLocation = file.getParentDirectory();
+        songWaitingForPreload = -1;   // this one replaces a show song still waiting
 
         Song song;
         auto result = songManager.loadSong(file, song);
@@ -4,8 +4,10 @@
 #include "AudioEngine.h"
 #include "SongManager.h"
 #include "ShowManager.h"
+#include "SongPreloader.h"
 #include "Song.h"
 #include "ContextMenuControls.h"
+#include "UiRefreshClock.h"
 
 /**
  * @file ShowComponent.h
@@ -19,12 +21,13 @@
  * Save button context menu: Save Show, Save Song, Save Song Template, Save as Default Template
  */
 class ShowComponent : public juce::Component,
-                      private juce::Timer
+                      private UiRefreshClock::Client
 {
 public:
     ShowComponent(AudioEngine& engine,
                   SongManager& songMgr,
-                  ShowManager& showMgr);
+                  ShowManager& showMgr,
+                  UiRefreshClock& refreshClock);
     ~ShowComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -46,6 +49,7 @@ private:
     AudioEngine&  audioEngine;
     SongManager&  songManager;
     ShowManager&  showManager;
+    UiRefreshClock& uiClock;
 
     bool audioIsReady {false};
 
@@ -55,6 +59,14 @@ private:
     bool         showLoaded      {false};
     int          currentSongIndex{-1};
 
+    // Next song of the show, decoded in the background
+    SongPreloader songPreloader;
+    int           songWaitingForPreload {-1};   // show index to take once its preload is done
+    void preloadNextSong();
+
+    static constexpr int kRefreshHz     = 2;
+    static constexpr int kPreloadPollHz = 50;   // while a song waits for its preload
+
     //==========================================================================
     // Remembered last file-browser location
     juce::File lastBrowseLocation;
@@ -84,11 +96,17 @@ private:
 
     juce::TextButton addToShowButton {"+ Show"};
 
+    // Background song save: 0..1 while running, -1 when idle
+    float saveProgress {-1.0f};
+
+    // Song recorded at another rate being converted before it is applied: 0..1, -1 when idle
+    float convertProgress {-1.0f};
+
     // File chooser (must outlive dialog)
     std::unique_ptr<juce::FileChooser> fileChooser;
 
     //==========================================================================
-    void timerCallback() override;
+    void uiRefresh() override;
     void updateSongPositionLabel();
 
     // Context menu handlers
@@ -111,6 +129,7 @@ private:
     void addToShowClicked();
 
     bool loadAndApplySong(int showSongIndex);
+    void applySongAsync(const Song& song, const juce::String& title);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ShowComponent)
 };
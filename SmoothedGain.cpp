@@ -0,0 +1,109 @@
+#include "SmoothedGain.h"
+
+//==============================================================================
+void SmoothedGain::prepare(double sampleRate, int maxBlockSize, double rampSeconds, Curve newCurve)
+{
+    capacity = juce::jmax(1, maxBlockSize);
+    rampBuffer.allocate(static_cast<size_t>(capacity), true);
+    indexRamp .allocate(static_cast<size_t>(capacity), false);
+    for (int i = 0; i < capacity; ++i)
+        indexRamp[i] = static_cast<float>(i + 1);
+
+    curve       = newCurve;
+    rampSamples = juce::jmax(1, static_cast<int>(rampSeconds * sampleRate));
+
+    // ~5 time constants per ramp time: within 0.7 % of the target when it ends
+    const double tau = juce::jmax(1.0, rampSamples / 5.0);
+    poleCoeff = static_cast<float>(std::exp(-1.0 / tau));
+
+    reset(target);
+}
+
+void SmoothedGain::reset(float value) noexcept
+{
+    current = target = value;
+    remaining = 0;
+    ramping   = false;
+}
+
+//==============================================================================
+const float* SmoothedGain::process(float newTarget, int numSamples) noexcept
+{
+    if (newTarget != target)
+    {
+        target    = newTarget;
+        ramping   = (current != target);
+        remaining = rampSamples;
+        step      = (target - current) / static_cast<float>(rampSamples);
+    }
+
+    if (!ramping || numSamples <= 0)
+        return nullptr;
+
+    // Block larger than prepared for: no ramp buffer — jump
+    if (numSamples > capacity)
+    {
+        reset(target);
+        return nullptr;
+    }
+
+    float* out = rampBuffer.getData();
+
+    if (curve == Curve::Linear)
+    {
+        const int   n   = juce::jmin(numSamples, remaining);
+        const float end = (n == remaining) ? target : current + step * static_cast<float>(n);
+        writeLine(out, current, end, n);
+        if (n < numSamples)
+            juce::FloatVectorOperations::fill(out + n, target, numSamples - n);
+
+        remaining -= n;
+        current    = end;
+        if (remaining <= 0)
+            reset(target);
+        return out;
+    }
+
+    // Exponential: follow the one-pole curve in short straight segments
+    int done = 0;
+    while (done < numSamples)
+    {
+        const int   len = juce::jmin(kSegment, numSamples - done);
+        float       end = target + (current - target) * std::pow(poleCoeff, static_cast<float>(len));
+        const bool  arrived = std::abs(end - target) < 1.0e-5f;
+        if (arrived) end = target;
+
+        writeLine(out + done, current, end, len);
+        current = end;
+        done   += len;
+
+        if (arrived)
+        {
+            if (done < numSamples)
+                juce::FloatVectorOperations::fill(out + done, target, numSamples - done);
+            reset(target);
+            break;
+        }
+    }
+    return out;
+}
+
+void SmoothedGain::writeLine(float* dest, float from, float to, int numSamples) const noexcept
+{
+    // dest[i] = from + (to - from) * (i + 1) / numSamples
+    juce::FloatVectorOperations::copyWithMultiply(dest, indexRamp.getData(),
+                                                  (to - from) / static_cast<float>(numSamples), numSamples);
+    juce::FloatVectorOperations::add(dest, from, numSamples);
+}
+
+void SmoothedGain::apply(float* dest, const float* ramp, float steady, int numSamples) noexcept
+{
+    if (dest == nullptr || numSamples <= 0) return;
+
+    if (ramp != nullptr)
+        juce::FloatVectorOperations::multiply(dest, ramp, numSamples);
+    else if (steady == 0.0f)
+        juce::FloatVectorOperations::clear(dest, numSamples);
+    else if (steady != 1.0f)
+        juce::FloatVectorOperations::multiply(dest, steady, numSamples);
+}
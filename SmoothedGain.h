@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+ * @file SmoothedGain.h
+ * @brief Per-block gain ramps for faders and mute fades
+ *
+ * The audio thread passes the latest target (usually read from an atomic the
+ * message thread writes) once per block and gets back either nullptr — the
+ * value is steady, use getCurrent() as a scalar — or a per-sample gain curve
+ * for this block.  Ramps are built with FloatVectorOperations; once a ramp has
+ * arrived no per-sample work is left.
+ *
+ *   Linear      — fixed-time straight ramp (mute/solo fades, reaches 0 exactly)
+ *   Exponential — one-pole approach, piecewise linear every kSegment samples
+ *                 (faders: constant perceived speed, no zipper on CC steps)
+ *
+ * Thread-safety:
+ *   Device start : prepare()
+ *   Audio thread : reset(), process(), apply()
+ */
+class SmoothedGain
+{
+public:
+    enum class Curve { Linear, Exponential };
+
+    /** Size the ramp buffer and set the ramp time. Not audio thread. */
+    void prepare(double sampleRate, int maxBlockSize, double rampSeconds, Curve newCurve);
+
+    /** Jump to value without a ramp. */
+    void reset(float value) noexcept;
+
+    /**
+     * @brief Advance one block towards target.
+     * @return Per-sample gains for numSamples, or nullptr when steady.
+     */
+    const float* process(float target, int numSamples) noexcept;
+
+    float getCurrent()  const noexcept { return current; }
+    bool  isSmoothing() const noexcept { return ramping; }
+
+    /** dest *= ramp, or *= steady when ramp is nullptr (nothing for 1, clear for 0). */
+    static void apply(float* dest, const float* ramp, float steady, int numSamples) noexcept;
+
+private:
+    static constexpr int kSegment = 32;
+
+    juce::HeapBlock<float> rampBuffer;
+    juce::HeapBlock<float> indexRamp;    // 1, 2, 3, ... for vectorised line segments
+    int   capacity    {0};
+    Curve curve       {Curve::Linear};
+    int   rampSamples {1};
+    float poleCoeff   {0.0f};            // per-sample decay for Exponential
+
+    float current     {1.0f};
+    float target      {1.0f};
+    float step        {0.0f};            // Linear: per-sample increment
+    int   remaining   {0};               // Linear: samples left in the ramp
+    bool  ramping     {false};
+
+    void writeLine(float* dest, float from, float to, int numSamples) const noexcept;
+};
@@ -27,7 +27,9 @@ struct PluginData
     juce::String identifier;              ///< Plugin unique identifier
     juce::String name;                    ///< Plugin display name
     juce::String manufacturer;            ///< Plugin manufacturer
-    juce::String stateBase64;             ///< Plugin state as Base64
+    juce::String stateBase64;             ///< Plugin state as Base64 (songs before 1.2.0, templates)
+    juce::String stateFileName;           ///< Binary sidecar in the song directory (since 1.2.0)
+    juce::MemoryBlock state;              ///< Raw state while saving (not serialized)
     bool bypassed{false};                 ///< Is plugin bypassed
     
     PluginData() = default;
@@ -84,7 +86,7 @@ struct ChannelConfig
  */
 struct Song
 {
-    static constexpr const char* FORMAT_VERSION = "1.1.0";
+    static constexpr const char* FORMAT_VERSION = "1.2.0";
     
     // Metadata
     juce::String formatVersion{FORMAT_VERSION};
@@ -104,8 +106,9 @@ struct Song
     int activeSection {0};
     std::array<juce::int64, NUM_SECTIONS> sectionLoopLengths {0, 0, 0};
 
-    // Channel configurations
-    std::array<ChannelConfig, 6> channels;
+    // Channel configurations — [0, numChannels) saved, the rest at defaults
+    std::array<ChannelConfig, MAX_CHANNELS> channels;
+    int numChannels {DEFAULT_CHANNELS};
     
     // Metronome settings
     bool  metronomeEnabled{false};
@@ -191,6 +194,16 @@ struct Song
         return songDirectory.getChildFile(name);
     }
 
+    /**
+     * @brief Binary plugin state sidecar for a channel's FX slot (slotIndex -1 = VSTi)
+     */
+    juce::File getPluginStateFile(int channelIndex, int slotIndex) const
+    {
+        return songDirectory.getChildFile(
+            "channel_" + juce::String(channelIndex) +
+            (slotIndex < 0 ? juce::String("_vsti") : "_fx_" + juce::String(slotIndex)) + ".state");
+    }
+
     /**
      * @brief Check if song directory exists and is valid
      */
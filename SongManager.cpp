@@ -1,23 +1,237 @@
 #include "SongManager.h"
 #include "AppConfig.h"
+#include "DenormalPolicy.h"
 #include "PluginHostWrapper.h"
 #include "VSTiChannel.h"
+#include <limits>
 
 //==============================================================================
-SongManager::SongManager()  {}
-SongManager::~SongManager() {}
+SongManager::SongManager()
+    : savePool(juce::ThreadPoolOptions{}
+                   .withThreadName("Song Save")
+                   .withNumberOfThreads(juce::jlimit(1, 4, juce::SystemStats::getNumCpus() - 1)))
+    , resamplePool(juce::ThreadPoolOptions{}
+                       .withThreadName("Song Resample")
+                       .withNumberOfThreads(juce::jlimit(1, 8, juce::SystemStats::getNumCpus() - 1)))
+{
+    saveDone.signal();   // no save running yet
+}
+
+SongManager::~SongManager()
+{
+    waitForPendingSaves();
+
+    // Conversion jobs call into this object: drop the queued ones, let running ones finish
+    cancelPendingConversion();
+    resamplePool.removeAllJobs(true, -1);
+}
 
 //==============================================================================
 // Save
 //==============================================================================
 
+//
+// Saving runs in three steps:
+//   1. beginSave()  — message thread: engine state, plugin states and a
+//                     copy-on-write snapshot of every section with audio
+//   2. runSaveJob() — one job per channel/section: hash pass, then mixdown streamed
+//                     into the WAV writer (both in kMixdownChunk pieces, so memory
+//                     stays flat however long the loop is)
+//   3. finishSave() — after the last job: stale files, song.json
+//
+// saveSong() runs the jobs inline, saveSongAsync() on savePool.
+
+namespace
+{
+    /** The instrument and the FX slots of a channel, for per-plugin passes. */
+    std::array<PluginData*, 4> pluginsOf(ChannelConfig& ch)
+    {
+        return { &ch.vstInstrument, &ch.fxPlugins[0], &ch.fxPlugins[1], &ch.fxPlugins[2] };
+    }
+
+    /** Sidecar file of a saved song, or the inline Base64 of an older song / template.
+        song.json only ever names a file beside it: anything else loads the default state. */
+    PluginStateSource stateSourceOf(const Song& song, const PluginData& pd)
+    {
+        PluginStateSource source;
+        if (pd.stateFileName.isEmpty())
+        {
+            source.base64 = pd.stateBase64;
+            return source;
+        }
+
+        const auto file = song.songDirectory.getChildFile(pd.stateFileName);
+        if (pd.stateFileName == juce::File::createLegalFileName(pd.stateFileName)
+            && !pd.stateFileName.startsWithChar('.')
+            && file.getParentDirectory() == song.songDirectory)
+            source.file = file;
+        else
+            DBG("WARNING: plugin state file \"" + pd.stateFileName + "\" is not in the song folder, "
+                "loading the default state");
+        return source;
+    }
+
+    /** 64-bit FNV-1a over the sample bits — detects sections unchanged since the last save. */
+    struct AudioHash
+    {
+        juce::uint64 h = 14695981039346656037ull;
+
+        void mix(juce::uint64 v) noexcept
+        {
+            h ^= v;
+            h *= 1099511628211ull;
+        }
+
+        void addChunk(const juce::AudioBuffer<float>& chunk, int numSamples) noexcept
+        {
+            for (int ch = 0; ch < chunk.getNumChannels(); ++ch)
+            {
+                const auto* words = reinterpret_cast<const juce::uint32*>(chunk.getReadPointer(ch));
+                for (int i = 0; i < numSamples; ++i)
+                    mix(words[i]);
+            }
+        }
+
+        void addBytes(const juce::MemoryBlock& block) noexcept
+        {
+            const auto* bytes = static_cast<const juce::uint8*>(block.getData());
+            for (size_t i = 0; i < block.getSize(); ++i)
+                mix(bytes[i]);
+        }
+    };
+}
+
+struct SongManager::SaveSession
+{
+    struct Job
+    {
+        int             channel    {0};
+        int             section    {0};
+        juce::int64     numSamples {0};
+        juce::File      wavFile;
+        SectionSnapshot snapshot;
+        juce::Result    result     {juce::Result::ok()};
+    };
+
+    Song song;
+    std::vector<std::unique_ptr<Job>> jobs;
+    std::atomic<int> jobsDone {0};
+
+    RecordJournal* journal {nullptr};   // committed once song.json is written
+    juce::int64    journalSegment {0};
+
+    juce::WeakReference<SongManager>   owner;
+    std::function<void(float)>         onProgress;
+    std::function<void(juce::Result)>  onComplete;
+};
+
 juce::Result SongManager::saveSong(Song& song, AudioEngine& audioEngine)
 {
+    waitForPendingSaves();
+
+    SaveSession session;
+    session.song = song;
+
+    auto result = beginSave(session, audioEngine);
+    if (result.failed()) return result;
+
+    for (int j = 0; j < static_cast<int>(session.jobs.size()); ++j)
+        runSaveJob(session, j);
+
+    result = finishSave(session);
+    song = session.song;
+    return result;
+}
+
+void SongManager::saveSongAsync(const Song& song,
+                                AudioEngine& audioEngine,
+                                std::function<void(float)> onProgress,
+                                std::function<void(juce::Result)> onComplete)
+{
+    auto complete = [onComplete](juce::Result r) { if (onComplete) onComplete(r); };
+
+    if (saveInProgress.exchange(true, std::memory_order_acq_rel))
+    {
+        complete(juce::Result::fail("A song is already being saved"));
+        return;
+    }
+
+    saveDone.reset();   // signalled again by the last job
+
+    auto session = std::make_shared<SaveSession>();
+    session->song       = song;
+    session->owner      = this;
+    session->onProgress = std::move(onProgress);
+    session->onComplete = std::move(onComplete);
+
+    const auto result = beginSave(*session, audioEngine);
+    if (result.failed())
+    {
+        saveInProgress.store(false, std::memory_order_release);
+        saveDone.signal();
+        complete(result);
+        return;
+    }
+
+    const int numJobs = static_cast<int>(session->jobs.size());
+
+    // Signalling saveDone is the last use of `this`: waitForPendingSaves() may return then
+    auto finish = [this, session]
+    {
+        const auto r = finishSave(*session);
+        juce::MessageManager::callAsync([session, r]
+        {
+            if (session->owner != nullptr)
+                session->owner->saveInProgress.store(false, std::memory_order_release);
+            if (session->onComplete) session->onComplete(r);
+        });
+        saveDone.signal();
+    };
+
+    if (numJobs == 0)
+    {
+        savePool.addJob(finish);
+        return;
+    }
+
+    for (int j = 0; j < numJobs; ++j)
+    {
+        savePool.addJob([this, session, j, numJobs, finish]
+        {
+            runSaveJob(*session, j);
+
+            const int done = session->jobsDone.fetch_add(1, std::memory_order_acq_rel) + 1;
+            juce::MessageManager::callAsync([session, done, numJobs]
+            {
+                if (session->owner != nullptr && session->onProgress)
+                    session->onProgress(static_cast<float>(done) / static_cast<float>(numJobs));
+            });
+
+            if (done == numJobs)
+                finish();
+        });
+    }
+}
+
+void SongManager::waitForPendingSaves()
+{
+    // Jobs of an async save are queued, not running — removeAllJobs() would drop them.
+    // No time limit: they all use this object, so it must outlive them.
+    saveDone.wait(-1);
+}
+
+juce::Result SongManager::beginSave(SaveSession& session, AudioEngine& audioEngine)
+{
+    auto& song = session.song;
     song.lastModified = juce::Time::getCurrentTime();
 
     auto result = song.createDirectory();
     if (result.failed()) return result;
 
+    // Journal records from here on apply to this save; older segments go once it finished
+    session.journal        = &audioEngine.getRecordJournal();
+    session.journalSegment = session.journal->beginSegment(song.getSongFile());
+
     // Global state
     song.loopLengthSamples    = audioEngine.getLoopEngine().getLoopLength();
     song.bpm                  = audioEngine.getLoopEngine().getBPM();
@@ -45,60 +259,142 @@ juce::Result SongManager::saveSong(Song& song, AudioEngine& audioEngine)
                         .replaceCharacters("/\\:*?\"<>|", "_________");
     }
 
-    juce::StringArray writtenFiles;
-
-    for (int i = 0; i < 6; ++i)
+    song.numChannels = audioEngine.getNumChannels();
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
     {
         auto* channel = audioEngine.getChannel(i);
         if (!channel) continue;
 
         song.channels[i] = readChannelState(channel, audioEngine, i);
 
-        // Save loop data for all sections as mixed-down WAV
+        // Loop data for all sections is saved as mixed-down WAV by the jobs
         for (int s = 0; s < NUM_SECTIONS; ++s)
         {
             auto& sd = song.channels[i].sectionData[s];
             const juce::int64 secLoopLen = song.sectionLoopLengths[s];
 
+            sd.hasLoopData = false;
+            sd.loopFileName = {};
+            sd.overdubLayerCount = 0; // overdubs baked into WAV
+
             if constexpr (!kFreeVersion)
             {
                 if (channel->sectionHasContent(s) && secLoopLen > 0)
                 {
-                    auto wavFile = song.getWavFile(i, s, wavPrefix);
-                    auto mixed = mixDownChannel(channel->getSectionLoopBuffer(s),
-                                                channel->getSectionOverdubLayers(s),
-                                                secLoopLen);
-                    auto saveResult = saveWavFile(wavFile, mixed, secLoopLen, song.sampleRate);
-
-                    if (saveResult.failed())
-                    {
-                        DBG("WARNING: WAV save failed for ch " + juce::String(i) +
-                            " sec " + juce::String(s) + ": " + saveResult.getErrorMessage());
-                        sd.hasLoopData = false;
-                        sd.loopFileName = {};
-                    }
+                    auto job = std::make_unique<SaveSession::Job>();
+                    job->channel    = i;
+                    job->section    = s;
+                    job->numSamples = secLoopLen;
+                    job->wavFile    = song.getWavFile(i, s, wavPrefix);
+
+                    if (channel->snapshotSection(s, job->snapshot))
+                        session.jobs.push_back(std::move(job));
                     else
-                    {
-                        sd.hasLoopData = true;
-                        sd.loopFileName = wavFile.getFileName();
-                        writtenFiles.add(wavFile.getFileName());
-                    }
-
-                    sd.overdubLayerCount = 0; // overdubs baked into WAV
-                }
-                else
-                {
-                    sd.hasLoopData = false;
-                    sd.loopFileName = {};
-                    sd.overdubLayerCount = 0;
+                        DBG("WARNING: no consistent snapshot for ch " + juce::String(i) +
+                            " sec " + juce::String(s) + " — section skipped");
                 }
             }
+        }
+    }
+
+    return juce::Result::ok();
+}
+
+void SongManager::runSaveJob(SaveSession& session, int jobIndex)
+{
+    auto& job = *session.jobs[static_cast<size_t>(jobIndex)];
+    const DenormalPolicy::Scope noDenormals;
+
+    //--- 1. Hash pass: mix chunk by chunk, nothing the size of the loop is allocated ---
+    juce::AudioBuffer<float> chunk(2, kMixdownChunk);
+    AudioHash hash;
+    hash.mix(static_cast<juce::uint64>(job.numSamples));
+    hash.mix(static_cast<juce::uint64>(session.song.sampleRate));
+    for (juce::int64 pos = 0; pos < job.numSamples; pos += kMixdownChunk)
+    {
+        const int n = static_cast<int>(juce::jmin<juce::int64>(kMixdownChunk, job.numSamples - pos));
+        mixDownChunk(job.snapshot, chunk, pos, n);
+        hash.addChunk(chunk, n);
+    }
+
+    const auto key = job.wavFile.getFullPathName();
+    {
+        const juce::ScopedLock sl(hashLock);
+        auto it = savedSectionHashes.find(key);
+        if (it != savedSectionHashes.end() && it->second == hash.h && job.wavFile.existsAsFile()
+            && getOverviewFile(job.wavFile).existsAsFile())
+        {
+            DBG("WAV unchanged, skipped: " + job.wavFile.getFileName());
+            job.snapshot.base.clear();
+            job.snapshot.layers.clear();
+            job.result = juce::Result::ok();
+            return;
+        }
+    }
+
+    //--- 2. Write pass: mix again straight into the writer, overview on the way ---
+    WaveformOverview overview;
+    job.result = saveWavFile(job.wavFile, job.snapshot, job.numSamples,
+                             session.song.sampleRate, &overview);
+
+    // Pages go back to the live buffers (or the pool) once the file is written
+    job.snapshot.base.clear();
+    job.snapshot.layers.clear();
+
+    // Waveform overview next to the WAV — loading the song then skips the rescan
+    if (job.result.wasOk() && !overview.writeTo(getOverviewFile(job.wavFile)))
+        DBG("WARNING: waveform overview not written for " + job.wavFile.getFileName());
+
+    const juce::ScopedLock sl(hashLock);
+    if (job.result.wasOk())
+        savedSectionHashes[key] = hash.h;
+    else
+        savedSectionHashes.erase(key);
+}
+
+juce::Result SongManager::finishSave(SaveSession& session)
+{
+    auto& song = session.song;
+    juce::StringArray writtenFiles;
+
+    for (auto& job : session.jobs)
+    {
+        auto& sd = song.channels[job->channel].sectionData[job->section];
+
+        if (job->result.failed())
+        {
+            DBG("WARNING: WAV save failed for ch " + juce::String(job->channel) +
+                " sec " + juce::String(job->section) + ": " + job->result.getErrorMessage());
+            continue;
+        }
+
+        sd.hasLoopData = true;
+        sd.loopFileName = job->wavFile.getFileName();
+        writtenFiles.add(job->wavFile.getFileName());
+        writtenFiles.add(getOverviewFile(job->wavFile).getFileName());
+    }
+
+    // Plugin states: one binary sidecar per slot, song.json only names it
+    for (int i = 0; i < song.numChannels; ++i)
+    {
+        for (auto* pd : pluginsOf(song.channels[static_cast<size_t>(i)]))
+        {
+            if (pd->identifier.isEmpty() || pd->state.getSize() == 0) continue;
+
+            const auto file = song.getPluginStateFile(i, pd->slotIndex);
+            if (writePluginState(file, pd->state))
+            {
+                pd->stateFileName = file.getFileName();
+                pd->stateBase64   = {};
+                writtenFiles.add(pd->stateFileName);
+            }
             else
             {
-                sd.hasLoopData = false;
-                sd.loopFileName = {};
-                sd.overdubLayerCount = 0;
+                DBG("WARNING: plugin state not written, kept inline: " + file.getFileName());
+                pd->stateFileName = {};
+                pd->stateBase64   = PluginHostWrapper::memoryBlockToBase64(pd->state);
             }
+            pd->state.reset();
         }
     }
 
@@ -127,10 +423,10 @@ juce::Result SongManager::saveSong(Song& song, AudioEngine& audioEngine)
             writtenFiles.add(f.getFileName());
     }
 
-    // Clean up stale .wav and .loop files no longer referenced
+    // Clean up stale .wav, .loop and overview files no longer referenced
     {
         auto staleFiles = song.songDirectory.findChildFiles(
-            juce::File::findFiles, false, "*.wav;*.loop");
+            juce::File::findFiles, false, "*.wav;*.loop;*.peaks;*.state");
         for (auto& f : staleFiles)
             if (!writtenFiles.contains(f.getFileName()))
                 f.deleteFile();
@@ -147,10 +443,37 @@ juce::Result SongManager::saveSong(Song& song, AudioEngine& audioEngine)
     if (!tmpJsonFile.moveFileTo(songFile))
         return juce::Result::fail("Failed to rename temp song.json: " + tmpJsonFile.getFullPathName());
 
+    if (session.journal != nullptr)
+        session.journal->commitSegment(session.journalSegment);
+
     DBG("Song saved: " + songFile.getFullPathName());
     return juce::Result::ok();
 }
 
+bool SongManager::writePluginState(const juce::File& file, const juce::MemoryBlock& state)
+{
+    AudioHash hash;
+    hash.mix(static_cast<juce::uint64>(state.getSize()));
+    hash.addBytes(state);
+
+    const auto key = file.getFullPathName();
+    {
+        const juce::ScopedLock sl(hashLock);
+        auto it = savedSectionHashes.find(key);
+        if (it != savedSectionHashes.end() && it->second == hash.h && file.existsAsFile()
+            && file.getSize() == static_cast<juce::int64>(state.getSize()))
+            return true;
+    }
+
+    // replaceWithData() writes a temp file and renames it — a crash keeps the old state
+    const bool ok = file.replaceWithData(state.getData(), state.getSize());
+
+    const juce::ScopedLock sl(hashLock);
+    if (ok) savedSectionHashes[key] = hash.h;
+    else    savedSectionHashes.erase(key);
+    return ok;
+}
+
 //==============================================================================
 // Load
 //==============================================================================
@@ -181,18 +504,29 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
 {
     DBG("Applying song to engine: " + song.songName);
 
+    // A preloaded song still waiting for its loop boundary must not land on top of this one
+    audioEngine.cancelStandbySong();
+    cancelDeferredPlugins();
+    cancelPendingConversion();
+
     bool wasPlaying = audioEngine.isPlaying();
     if (wasPlaying) audioEngine.setPlaying(false);
 
-    // Warn if sample rate differs from when the song was recorded
+    // Song recorded at another rate: play the converted copies (applySongToEngineAsync() makes them)
     const double currentSR = audioEngine.getSampleRate();
-    if (song.sampleRate > 0.0 && currentSR > 0.0 &&
-        std::abs(song.sampleRate - currentSR) > 1.0)
+    bool resampled = false;
+    if (needsResampling(song, currentSR))
     {
-        DBG("WARNING: Song was recorded at " + juce::String(song.sampleRate) +
-            " Hz but current device is " + juce::String(currentSR) +
-            " Hz — loops may play at wrong speed/pitch!");
+        resampled = getFilesToResample(song, currentSR).isEmpty();
+        if (!resampled)
+            DBG("WARNING: Song was recorded at " + juce::String(song.sampleRate) +
+                " Hz but current device is " + juce::String(currentSR) +
+                " Hz and is not converted — loops may play at wrong speed/pitch!");
     }
+    const auto atDeviceRate = [&](juce::int64 n)
+    {
+        return resampled ? PolyphaseResampler::scaleLength(n, song.sampleRate, currentSR) : n;
+    };
 
     // Global loop settings
     audioEngine.getLoopEngine().setBPM(song.bpm);
@@ -202,7 +536,7 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
     // Restore the saved loop length exactly.  In metronome mode the loop length
     // is now established by the first recording (bar-rounded), not from BPM,
     // so we never call calculateLoopLengthFromBPM() here.
-    audioEngine.getLoopEngine().setLoopLength(song.loopLengthSamples);
+    audioEngine.getLoopEngine().setLoopLength(atDeviceRate(song.loopLengthSamples));
 
     // Metronome
     audioEngine.getMetronome().setEnabled(song.metronomeEnabled);
@@ -214,7 +548,7 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
     audioEngine.setFixedLengthBars(song.fixedLengthBars);
     audioEngine.setMasterGain(song.masterGain);
 
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
     {
         const auto& cfg = song.channels[i];
 
@@ -236,11 +570,13 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
         for (int s = 0; s < NUM_SECTIONS; ++s)
         {
             const auto& sd = cfg.sectionData[s];
-            const juce::int64 secLoopLen = song.sectionLoopLengths[s];
+            const juce::int64 secLoopLen = atDeviceRate(song.sectionLoopLengths[s]);
 
             if (sd.hasLoopData && !sd.loopFileName.isEmpty())
             {
                 auto loopFile = song.songDirectory.getChildFile(sd.loopFileName);
+                if (resampled)
+                    loopFile = resolveLoopFile(song, loopFile, currentSR);
 
                 if (loopFile.existsAsFile())
                 {
@@ -253,18 +589,25 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
                     {
                         channel->allocateSection(s);
                         const juce::int64 maxSamples = channel->getLoopBufferSize();
-                        juce::AudioBuffer<float> tmp(2, static_cast<int>(maxSamples));
-                        tmp.clear();
 
                         // Detect format by file extension
-                        const juce::int64 loaded = loopFile.hasFileExtension(".wav")
-                            ? loadWavFile(loopFile, tmp, maxSamples)
-                            : loadLoopFile(loopFile, tmp, maxSamples);
-                        if (loaded > 0)
+                        if (loopFile.hasFileExtension(".wav"))
+                        {
+                            juce::AudioBuffer<float> tmp(2, static_cast<int>(maxSamples));
+                            tmp.clear();
+
+                            const juce::int64 loaded = loadWavFile(loopFile, tmp, maxSamples);
+                            if (loaded > 0)
+                            {
+                                if (!channel->loadLoopData(s, tmp, loaded))
+                                    DBG("WARNING: ch " + juce::String(i) + " sec " +
+                                        juce::String(s) + " loadLoopData failed");
+                            }
+                        }
+                        else if (loadLoopFileIntoSection(loopFile, *channel, s, false, maxSamples) <= 0)
                         {
-                            if (!channel->loadLoopData(s, tmp, loaded))
-                                DBG("WARNING: ch " + juce::String(i) + " sec " +
-                                    juce::String(s) + " loadLoopData failed");
+                            DBG("WARNING: ch " + juce::String(i) + " sec " +
+                                juce::String(s) + " loop file not loaded");
                         }
                     }
                 }
@@ -274,17 +617,19 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
             for (int layer = 0; layer < sd.overdubLayerCount; ++layer)
             {
                 auto layerFile = song.getSectionOverdubLayerFile(i, s, layer);
+                if (resampled)
+                    layerFile = resolveLoopFile(song, layerFile, currentSR);
                 if (layerFile.existsAsFile())
                 {
                     const juce::int64 maxSamples = juce::jmax(secLoopLen,
                                                                channel->getLoopBufferSize());
-                    juce::AudioBuffer<float> tmp(2, static_cast<int>(maxSamples));
-                    tmp.clear();
-                    const juce::int64 loaded = loadLoopFile(layerFile, tmp, maxSamples);
-                    if (loaded > 0)
-                        channel->loadOverdubLayer(s, tmp, loaded);
+                    loadLoopFileIntoSection(layerFile, *channel, s, true, maxSamples);
                 }
             }
+
+            // Saved waveform overview instead of a rescan (converted files are rescanned)
+            if (!resampled && sd.hasLoopData && !sd.loopFileName.isEmpty())
+                channel->loadWaveformOverview(s, getOverviewFile(song.songDirectory.getChildFile(sd.loopFileName)));
         }
 
         // Set active section on channel
@@ -295,20 +640,20 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
         {
             audioEngine.loadPluginAsync(i, -1,
                                         cfg.vstInstrument.identifier,
-                                        cfg.vstInstrument.stateBase64);
+                                        stateSourceOf(song, cfg.vstInstrument));
         }
 
         for (int slot = 0; slot < 3; ++slot)
         {
             const auto& pd = cfg.fxPlugins[slot];
             if (!pd.identifier.isEmpty())
-                audioEngine.loadPluginAsync(i, slot, pd.identifier, pd.stateBase64, pd.bypassed);
+                audioEngine.loadPluginAsync(i, slot, pd.identifier, stateSourceOf(song, pd), pd.bypassed);
         }
     }
 
     // Restore section loop lengths
     for (int s = 0; s < NUM_SECTIONS; ++s)
-        audioEngine.setSectionLoopLength(s, song.sectionLoopLengths[s]);
+        audioEngine.setSectionLoopLength(s, atDeviceRate(song.sectionLoopLengths[s]));
 
     // Set active section via command if not already at 0
     if (song.activeSection != 0)
@@ -319,18 +664,534 @@ juce::Result SongManager::applySongToEngine(const Song& song, AudioEngine& audio
         audioEngine.sendCommand(cmd);
     }
 
+    // Every section of the song is reachable now
+    audioEngine.requestSectionAllocation();
+
+    // The crash journal starts over from this song
+    audioEngine.getRecordJournal().rebase(song.getSongFile());
+
     if (wasPlaying) audioEngine.setPlaying(true);
 
     return juce::Result::ok();
 }
 
+//==============================================================================
+// Preloaded Songs
+//==============================================================================
+
+juce::Result SongManager::prepareStandbySong(const Song& song,
+                                             StandbySong& standby,
+                                             LoopPagePool& pool,
+                                             juce::int64 loopBufferSize,
+                                             double sampleRate,
+                                             const std::function<bool()>& shouldCancel)
+{
+    if (loopBufferSize <= 0)
+        return juce::Result::fail("Audio not prepared");
+
+    // Recorded at another rate: convert first, then decode the converted files
+    const bool resampled = needsResampling(song, sampleRate);
+    if (resampled)
+    {
+        auto conversion = resampleSongFiles(song, sampleRate, shouldCancel);
+        if (conversion.failed())
+            return conversion;
+    }
+    const auto atDeviceRate = [&](juce::int64 n)
+    {
+        return resampled ? PolyphaseResampler::scaleLength(n, song.sampleRate, sampleRate) : n;
+    };
+
+    standby.loopBufferSize = loopBufferSize;
+    standby.sampleRate    = resampled ? sampleRate : 0.0;
+    standby.loopLength    = atDeviceRate(song.loopLengthSamples);
+    standby.activeSection = juce::jlimit(0, NUM_SECTIONS - 1, song.activeSection);
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        standby.sectionLoopLengths[static_cast<size_t>(s)] = atDeviceRate(song.sectionLoopLengths[s]);
+
+    juce::AudioBuffer<float> scratch;   // grows to the longest file, reused
+
+    for (int i = 0; i < song.numChannels; ++i)
+    {
+        const auto& cfg = song.channels[i];
+
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            if (shouldCancel && shouldCancel())
+                return juce::Result::fail("Cancelled");
+
+            auto& sb = standby.channels[static_cast<size_t>(i)][static_cast<size_t>(s)];
+            const auto& sd = cfg.sectionData[s];
+
+            // Same table size as the live channel so the audio thread only swaps pointers
+            sb.base.setPool(&pool);
+            sb.base.setCapacity(loopBufferSize);
+            for (auto& layer : sb.layers)
+            {
+                layer.setPool(&pool);
+                layer.setCapacity(loopBufferSize);   // free slot: full table, like the live channel
+            }
+
+            if (sd.hasLoopData && !sd.loopFileName.isEmpty())
+            {
+                auto loopFile = song.songDirectory.getChildFile(sd.loopFileName);
+                if (resampled)
+                    loopFile = resolveLoopFile(song, loopFile, sampleRate);
+                if (loadAudioFileInto(loopFile, sb.base, scratch, loopBufferSize) > 0)
+                    sb.hasContent = true;
+            }
+
+            for (int layer = 0; layer < sd.overdubLayerCount && sb.numLayers < MAX_OVERDUB_LAYERS; ++layer)
+            {
+                // Layers wrap at their own length, like Channel::loadOverdubLayer()
+                auto& dest = sb.layers[static_cast<size_t>(sb.numLayers)];
+                dest.setCapacity(loopBufferSize);
+                auto layerFile = song.getSectionOverdubLayerFile(i, s, layer);
+                if (resampled)
+                    layerFile = resolveLoopFile(song, layerFile, sampleRate);
+                const juce::int64 loaded = loadAudioFileInto(layerFile, dest, scratch, loopBufferSize);
+                dest.setLength(juce::jmax<juce::int64>(0, loaded));
+                if (loaded > 0)
+                    ++sb.numLayers;
+            }
+        }
+    }
+
+    DBG("Song preloaded: " + song.songName);
+    return juce::Result::ok();
+}
+
+juce::Result SongManager::applyPreloadedSong(const Song& song,
+                                             std::unique_ptr<StandbySong> standby,
+                                             AudioEngine& audioEngine)
+{
+    if (!standby)
+        return juce::Result::fail("No preloaded audio");
+
+    // Preloaded for another device rate: let the caller load it normally (converted)
+    const double currentSR = audioEngine.getSampleRate();
+    if (needsResampling(song, currentSR) && std::abs(standby->sampleRate - currentSR) > 1.0)
+        return juce::Result::fail("Preloaded audio does not match the current sample rate");
+
+    // Standby tables were sized for one buffer size; a changed device invalidates them
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
+        if (auto* channel = audioEngine.getChannel(i))
+            if (channel->getLoopBufferSize() != standby->loopBufferSize)
+                return juce::Result::fail("Preloaded audio does not match the current device");
+
+    // Now: what does not change the sound of the song still playing
+    cancelDeferredPlugins();
+    cancelPendingConversion();   // a song still converting would be applied over this one
+    audioEngine.setLatchMode(song.latchModeEnabled);
+    audioEngine.setFixedLengthBars(song.fixedLengthBars);
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
+    {
+        const auto& cfg = song.channels[i];
+        audioEngine.setChannelType(i, cfg.type);   // a new channel is empty until the swap anyway
+        audioEngine.setChannelName(i, cfg.channelName);
+        audioEngine.setChannelMuteGroup(i, cfg.muteGroup);
+
+        if (auto* channel = audioEngine.getChannel(i))
+            for (int s = 0; s < NUM_SECTIONS; ++s)
+                channel->allocateSection(s);
+    }
+
+    // At the loop boundary, in the block that swaps the audio: tempo and mix
+    standby->hasSettings = true;
+    auto& settings = standby->settings;
+    settings.bpm                  = song.bpm;
+    settings.beatsPerLoop         = song.beatsPerLoop;
+    settings.metronomeEnabled     = song.metronomeEnabled;
+    settings.metronomeOutputL     = song.metronomeOutputLeft;
+    settings.metronomeOutputR     = song.metronomeOutputRight;
+    settings.metronomeBeatsPerBar = song.metronomeBeatsPerBar;
+    settings.metronomeGain        = song.metronomeGain;
+    settings.masterGain           = song.masterGain;
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
+    {
+        const auto& cfg = song.channels[i];
+        auto& mix = settings.channels[static_cast<size_t>(i)];
+        mix.gainDb      = cfg.gainDb;
+        mix.monitorMode = cfg.monitorMode;
+        mix.muted       = cfg.muted;
+        mix.solo        = cfg.solo;
+        mix.oneShot     = cfg.oneShot;
+        mix.routing     = cfg.routing;
+    }
+
+    audioEngine.queueStandbySong(std::move(standby));
+    audioEngine.getRecordJournal().rebase(song.getSongFile());
+
+    // Once the swap has fired: plugins (they load asynchronously from there)
+    deferredPluginSong   = song;
+    deferredPluginEngine = &audioEngine;
+    startTimer(kDeferredPluginPollMs);
+    return juce::Result::ok();
+}
+
+void SongManager::loadSongPlugins(const Song& song, AudioEngine& audioEngine)
+{
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
+    {
+        const auto& cfg = song.channels[i];
+        if (audioEngine.getChannel(i) == nullptr) continue;
+
+        if (cfg.type == ChannelType::VSTi && !cfg.vstInstrument.identifier.isEmpty())
+            audioEngine.loadPluginAsync(i, -1, cfg.vstInstrument.identifier,
+                                        stateSourceOf(song, cfg.vstInstrument));
+
+        for (int slot = 0; slot < 3; ++slot)
+        {
+            const auto& pd = cfg.fxPlugins[slot];
+            if (!pd.identifier.isEmpty())
+                audioEngine.loadPluginAsync(i, slot, pd.identifier, stateSourceOf(song, pd), pd.bypassed);
+        }
+    }
+}
+
+void SongManager::cancelDeferredPlugins()
+{
+    stopTimer();
+    deferredPluginEngine = nullptr;
+    deferredPluginSong   = Song();
+}
+
+void SongManager::timerCallback()
+{
+    if (deferredPluginEngine == nullptr)
+    {
+        stopTimer();
+        return;
+    }
+    if (deferredPluginEngine->isStandbySongPending())
+        return;
+
+    auto* engine    = deferredPluginEngine;
+    const auto song = std::move(deferredPluginSong);
+    cancelDeferredPlugins();
+    loadSongPlugins(song, *engine);
+}
+
+//==============================================================================
+// Sample Rate Conversion
+//==============================================================================
+//
+// A song recorded at another rate is converted file by file on resamplePool
+// before it is loaded.  Converted files live in <song>/resampled/<rate>-<quality>/
+// (outside the song's own file set, so saving never touches them) and are used
+// until their source file is newer.
+
+struct SongManager::ResampleBatch
+{
+    ResampleBatch(double sourceRate, double targetRate, PolyphaseResampler::Quality quality)
+        : resampler(sourceRate, targetRate, quality) {}
+
+    const PolyphaseResampler resampler;   // filter bank shared by the jobs (immutable)
+    int                      numFiles {0};
+    std::atomic<int>         remaining {0};
+    std::atomic<int>         failures  {0};
+    std::atomic<bool>        cancelled {false};
+    juce::WaitableEvent      done;        // signalled by the last job
+    std::function<void(int)> onFileDone;  // files done so far, on the job's thread
+};
+
+namespace
+{
+    const char* getQualityName(PolyphaseResampler::Quality quality) noexcept
+    {
+        switch (quality)
+        {
+            case PolyphaseResampler::Quality::Fast:   return "fast";
+            case PolyphaseResampler::Quality::Best:   return "best";
+            case PolyphaseResampler::Quality::Normal: break;
+        }
+        return "normal";
+    }
+}
+
+bool SongManager::needsResampling(const Song& song, double deviceRate)
+{
+    return song.sampleRate > 0.0 && deviceRate > 0.0
+        && std::abs(song.sampleRate - deviceRate) > 1.0;
+}
+
+juce::File SongManager::getResampledFile(const Song& song, const juce::File& source, double targetRate) const
+{
+    // Quality is part of the key: a copy made with another filter is not reused
+    return song.songDirectory.getChildFile("resampled")
+                             .getChildFile(juce::String(juce::roundToInt(targetRate)) + "-"
+                                           + getQualityName(getResampleQuality()))
+                             .getChildFile(source.getFileNameWithoutExtension() + ".loop");
+}
+
+juce::File SongManager::resolveLoopFile(const Song& song, const juce::File& source, double targetRate) const
+{
+    const auto converted = getResampledFile(song, source, targetRate);
+    return converted.existsAsFile() ? converted : source;
+}
+
+juce::File SongManager::getOverviewFile(const juce::File& loopFile)
+{
+    return loopFile.withFileExtension(".peaks");
+}
+
+juce::Array<juce::File> SongManager::getFilesToResample(const Song& song, double targetRate) const
+{
+    juce::Array<juce::File> todo;
+    if (!needsResampling(song, targetRate))
+        return todo;
+
+    for (int i = 0; i < song.numChannels; ++i)
+    {
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            const auto& sd = song.channels[i].sectionData[s];
+            juce::Array<juce::File> sources;
+            if (sd.hasLoopData && !sd.loopFileName.isEmpty())
+                sources.add(song.songDirectory.getChildFile(sd.loopFileName));
+            for (int layer = 0; layer < sd.overdubLayerCount; ++layer)
+                sources.add(song.getSectionOverdubLayerFile(i, s, layer));
+
+            for (const auto& source : sources)
+            {
+                if (!source.existsAsFile()) continue;
+                const auto dest = getResampledFile(song, source, targetRate);
+                if (!dest.existsAsFile() || dest.getLastModificationTime() < source.getLastModificationTime())
+                    todo.add(source);
+            }
+        }
+    }
+    return todo;
+}
+
+std::shared_ptr<SongManager::ResampleBatch> SongManager::startResampleJobs(const Song& song, double targetRate,
+                                                                           std::function<void(int)> onFileDone,
+                                                                           juce::Result& error)
+{
+    error = juce::Result::ok();
+    const auto todo = getFilesToResample(song, targetRate);
+    if (todo.isEmpty())
+        return nullptr;
+
+    const auto destDir = getResampledFile(song, todo.getFirst(), targetRate).getParentDirectory();
+    if (!destDir.createDirectory())
+    {
+        error = juce::Result::fail("Cannot create " + destDir.getFullPathName());
+        return nullptr;
+    }
+
+    DBG("Resampling " + juce::String(todo.size()) + " files: " + juce::String(song.sampleRate) +
+        " Hz -> " + juce::String(targetRate) + " Hz (" + getQualityName(getResampleQuality()) + ")");
+
+    // --- One job per file; the jobs share the batch, not the caller's frame ---
+    auto batch = std::make_shared<ResampleBatch>(song.sampleRate, targetRate, getResampleQuality());
+    batch->numFiles = todo.size();
+    batch->remaining.store(todo.size());
+    batch->onFileDone = std::move(onFileDone);
+
+    for (const auto& source : todo)
+    {
+        const auto dest = getResampledFile(song, source, targetRate);
+        resamplePool.addJob([this, source, dest, batch]
+        {
+            if (!batch->cancelled.load() && resampleFile(source, dest, batch->resampler).failed())
+                batch->failures.fetch_add(1);
+
+            const int left = batch->remaining.fetch_sub(1) - 1;
+            if (left == 0)
+                batch->done.signal();
+            if (batch->onFileDone)
+                batch->onFileDone(batch->numFiles - left);
+        });
+    }
+    return batch;
+}
+
+juce::Result SongManager::getBatchResult(const ResampleBatch& batch)
+{
+    if (batch.cancelled.load())
+        return juce::Result::fail("Cancelled");
+    if (batch.failures.load() > 0)
+        return juce::Result::fail(juce::String(batch.failures.load()) + " files could not be resampled");
+    return juce::Result::ok();
+}
+
+juce::Result SongManager::resampleSongFiles(const Song& song, double targetRate,
+                                            const std::function<bool()>& shouldCancel)
+{
+    auto error = juce::Result::ok();
+    const auto batch = startResampleJobs(song, targetRate, nullptr, error);
+    if (batch == nullptr)
+        return error;
+
+    // Woken by the last job; the timeout only bounds how late a cancel is seen
+    constexpr int kCancelCheckMs = 50;
+    while (!batch->done.wait(kCancelCheckMs))
+    {
+        if (shouldCancel && shouldCancel())
+        {
+            batch->cancelled.store(true);   // jobs not started yet skip their file
+            return juce::Result::fail("Cancelled");
+        }
+    }
+    return getBatchResult(*batch);
+}
+
+void SongManager::applySongToEngineAsync(const Song& song,
+                                         AudioEngine& audioEngine,
+                                         std::function<void(float)> onProgress,
+                                         std::function<void(juce::Result)> onComplete)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+    cancelPendingConversion();
+    const int generation = ++conversionGeneration;
+
+    // Posted to the message thread by the jobs, like the save pipeline's progress
+    juce::WeakReference<SongManager> owner(this);
+    auto* engine = &audioEngine;
+    auto onFileDone = [owner, generation, song, engine, onProgress, onComplete](int filesDone)
+    {
+        juce::MessageManager::callAsync([owner, generation, song, engine, onProgress, onComplete, filesDone]
+        {
+            if (owner == nullptr || owner->conversionGeneration != generation) return;   // superseded
+            auto& self  = *owner.get();
+            auto  batch = self.pendingConversion;
+            if (batch == nullptr) return;
+
+            if (onProgress)
+                onProgress(static_cast<float>(filesDone) / static_cast<float>(batch->numFiles));
+            if (filesDone < batch->numFiles) return;
+
+            self.pendingConversion.reset();
+            const auto conversion = getBatchResult(*batch);
+            if (conversion.failed())
+                DBG("Song conversion: " + conversion.getErrorMessage());
+
+            const auto result = self.applySongToEngine(song, *engine);
+            if (onComplete) onComplete(result);
+        });
+    };
+
+    auto error = juce::Result::ok();
+    pendingConversion = startResampleJobs(song, audioEngine.getSampleRate(), onFileDone, error);
+    if (pendingConversion == nullptr)
+    {
+        if (error.failed())
+            DBG("Song conversion: " + error.getErrorMessage());
+        const auto result = applySongToEngine(song, audioEngine);
+        if (onComplete) onComplete(result);
+        return;
+    }
+
+    if (onProgress) onProgress(0.0f);
+}
+
+void SongManager::cancelPendingConversion()
+{
+    if (pendingConversion == nullptr) return;
+
+    pendingConversion->cancelled.store(true);   // running files finish, the rest are skipped
+    pendingConversion.reset();
+    ++conversionGeneration;                     // its completion finds nothing to apply
+}
+
+juce::Result SongManager::resampleFile(const juce::File& source, const juce::File& dest,
+                                       const PolyphaseResampler& resampler)
+{
+    const DenormalPolicy::Scope noDenormals;
+    const juce::int64 numIn = getAudioFileLength(source);
+    if (numIn <= 0 || numIn > std::numeric_limits<int>::max())
+        return juce::Result::fail("Unreadable: " + source.getFullPathName());
+
+    juce::AudioBuffer<float> in(2, static_cast<int>(numIn));
+    const juce::int64 loaded = source.hasFileExtension(".wav") ? loadWavFile(source, in, numIn)
+                                                                : loadLoopFile(source, in, numIn);
+    if (loaded <= 0)
+        return juce::Result::fail("Unreadable: " + source.getFullPathName());
+
+    const juce::int64 numOut = resampler.getOutputLength(loaded);
+    juce::AudioBuffer<float> out(2, static_cast<int>(numOut));
+
+    // Loops and layers both wrap, so convert cyclically
+    for (int ch = 0; ch < 2; ++ch)
+        resampler.process(in.getReadPointer(ch), loaded, out.getWritePointer(ch), numOut, true);
+
+    return saveLoopFile(dest, out, numOut, resampler.getTargetRate());
+}
+
 //==============================================================================
 // Loop File I/O
 //==============================================================================
+//
+// .loop format (all fields little-endian):
+//   v1: magic "LOOP", int32 version, int64 numSamples, int32 numChannels,
+//       float sampleRate, then interleaved L/R float32 frames.
+//   v2: same first 24 bytes, then int64 channelStride (samples per channel
+//       block, multiple of 16), int32 dataOffset (64). Body: planar float32 —
+//       channel c starts at dataOffset + c * channelStride * 4, 64-byte aligned,
+//       so a memory-mapped file can be read in place.
+
+namespace
+{
+    constexpr int kLoopMagic        = 0x4C4F4F50;   // "LOOP"
+    constexpr int kLoopVersionV1    = 1;
+    constexpr int kLoopVersionV2    = 2;
+    constexpr int kLoopV2DataOffset = 64;
+    constexpr int kLoopV2Alignment  = 16;           // samples (= 64 bytes)
+
+    struct LoopFileHeader
+    {
+        int         version       {0};
+        juce::int64 numSamples    {0};
+        int         numChannels   {0};
+        juce::int64 channelStride {0};   // v2 only
+        int         dataOffset    {0};
+    };
+
+    bool readLoopFileHeader(juce::InputStream& in, LoopFileHeader& h)
+    {
+        if (in.readInt() != kLoopMagic) return false;
+
+        h.version     = in.readInt();
+        h.numSamples  = in.readInt64();
+        h.numChannels = in.readInt();
+        /*sampleRate*/  in.readFloat();
+
+        if (h.version == kLoopVersionV1)
+        {
+            h.dataOffset = static_cast<int>(in.getPosition());
+        }
+        else if (h.version == kLoopVersionV2)
+        {
+            h.channelStride = in.readInt64();
+            h.dataOffset    = in.readInt();
+            if (h.channelStride < h.numSamples || h.dataOffset < 36) return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        return h.numChannels == 2 && h.numSamples > 0 && !in.isExhausted();
+    }
+
+    /** Write n floats as little-endian float32 in large blocks. */
+    bool writeFloatBlock(juce::OutputStream& out, const float* data, juce::int64 n)
+    {
+       #if JUCE_LITTLE_ENDIAN
+        return out.write(data, static_cast<size_t>(n) * sizeof(float));
+       #else
+        for (juce::int64 i = 0; i < n; ++i)
+            if (!out.writeFloat(data[i])) return false;
+        return true;
+       #endif
+    }
+}
 
 juce::Result SongManager::saveLoopFile(const juce::File& file,
                                        const juce::AudioBuffer<float>& buffer,
-                                       juce::int64 numSamples)
+                                       juce::int64 numSamples,
+                                       double sampleRate)
 {
     if (numSamples <= 0 || buffer.getNumChannels() < 2)
         return juce::Result::fail("Invalid buffer");
@@ -339,26 +1200,36 @@ juce::Result SongManager::saveLoopFile(const juce::File& file,
 
     // Write to a temp file first, then rename for crash-safety
     auto tmpFile = file.getSiblingFile(file.getFileName() + ".tmp");
+    tmpFile.deleteFile();   // FileOutputStream appends to an existing file
 
     std::unique_ptr<juce::FileOutputStream> stream(tmpFile.createOutputStream());
     if (!stream)
         return juce::Result::fail("Cannot create: " + tmpFile.getFullPathName());
 
-    stream->writeInt  (0x4C4F4F50);  // "LOOP" magic
-    stream->writeInt  (1);            // version
+    const juce::int64 stride = (numSamples + kLoopV2Alignment - 1)
+                             / kLoopV2Alignment * kLoopV2Alignment;
+
+    stream->writeInt  (kLoopMagic);
+    stream->writeInt  (kLoopVersionV2);
     stream->writeInt64(numSamples);
     stream->writeInt  (2);            // always stereo
-    stream->writeFloat(44100.0f);     // informational
-
-    const float* L = buffer.getReadPointer(0);
-    const float* R = buffer.getReadPointer(1);
-    for (juce::int64 i = 0; i < numSamples; ++i)
+    stream->writeFloat(static_cast<float>(sampleRate));   // informational
+    stream->writeInt64(stride);
+    stream->writeInt  (kLoopV2DataOffset);
+    stream->writeRepeatedByte(0, static_cast<size_t>(kLoopV2DataOffset - stream->getPosition()));
+
+    // Planar body: one bulk write per channel, zero-padded to the stride
+    const size_t padBytes = static_cast<size_t>(stride - numSamples) * sizeof(float);
+    bool ok = true;
+    for (int ch = 0; ch < 2 && ok; ++ch)
     {
-        stream->writeFloat(L[i]);
-        stream->writeFloat(R[i]);
+        ok = writeFloatBlock(*stream, buffer.getReadPointer(ch), numSamples);
+        if (ok && padBytes > 0)
+            ok = stream->writeRepeatedByte(0, padBytes);
     }
+
     stream->flush();
-    if (stream->getStatus().failed())
+    if (!ok || stream->getStatus().failed())
         return juce::Result::fail("Write failed: " + tmpFile.getFullPathName());
 
     stream.reset();  // close file handle before rename
@@ -385,19 +1256,14 @@ juce::int64 SongManager::loadLoopFile(const juce::File& file,
     std::unique_ptr<juce::FileInputStream> stream(file.createInputStream());
     if (!stream) return -1;
 
-    if (stream->readInt() != 0x4C4F4F50)
+    LoopFileHeader h;
+    if (!readLoopFileHeader(*stream, h))
     {
-        DBG("Invalid loop file magic: " + file.getFullPathName());
+        DBG("Invalid loop file header: " + file.getFullPathName());
         return -1;
     }
-    /*version*/      stream->readInt();
-    const juce::int64 numSamples  = stream->readInt64();
-    const int         numChannels = stream->readInt();
-    /*sampleRate*/   stream->readFloat();
 
-    if (numChannels != 2 || numSamples <= 0) return -1;
-
-    const juce::int64 samplesToRead = juce::jmin(numSamples, maxSamples);
+    const juce::int64 samplesToRead = juce::jmin(h.numSamples, maxSamples);
     if (buffer.getNumSamples() < static_cast<int>(samplesToRead) ||
         buffer.getNumChannels() < 2)
     {
@@ -407,51 +1273,173 @@ juce::int64 SongManager::loadLoopFile(const juce::File& file,
 
     float* L = buffer.getWritePointer(0);
     float* R = buffer.getWritePointer(1);
-    for (juce::int64 i = 0; i < samplesToRead; ++i)
+
+    if (h.version == kLoopVersionV2)
+    {
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            stream->setPosition(h.dataOffset + ch * h.channelStride
+                                               * static_cast<juce::int64>(sizeof(float)));
+            float* dest = ch == 0 ? L : R;
+            const auto bytes = static_cast<int>(samplesToRead * static_cast<juce::int64>(sizeof(float)));
+            if (stream->read(dest, bytes) != bytes) return -1;
+
+           #if JUCE_BIG_ENDIAN
+            for (juce::int64 i = 0; i < samplesToRead; ++i)
+                dest[i] = juce::ByteOrder::swapIfBigEndian(dest[i]);
+           #endif
+        }
+    }
+    else
     {
-        L[i] = stream->readFloat();
-        R[i] = stream->readFloat();
+        // v1: interleaved — read in blocks and de-interleave
+        constexpr int kFramesPerBlock = 8192;
+        juce::HeapBlock<float> block(static_cast<size_t>(kFramesPerBlock) * 2);
+
+        for (juce::int64 done = 0; done < samplesToRead; )
+        {
+            const int n     = static_cast<int>(juce::jmin<juce::int64>(kFramesPerBlock, samplesToRead - done));
+            const int bytes = n * 2 * static_cast<int>(sizeof(float));
+            if (stream->read(block.get(), bytes) != bytes) return -1;
+
+            for (int i = 0; i < n; ++i)
+            {
+                L[done + i] = juce::ByteOrder::swapIfBigEndian(block[2 * i]);
+                R[done + i] = juce::ByteOrder::swapIfBigEndian(block[2 * i + 1]);
+            }
+            done += n;
+        }
     }
 
     DBG("Loop loaded: " + file.getFileName() +
-        " (" + juce::String(samplesToRead) + "/" + juce::String(numSamples) + " samples)");
+        " (" + juce::String(samplesToRead) + "/" + juce::String(h.numSamples) + " samples)");
     return samplesToRead;
 }
 
+juce::int64 SongManager::loadLoopFileIntoSection(const juce::File& file,
+                                                 Channel& channel,
+                                                 int section,
+                                                 bool asOverdubLayer,
+                                                 juce::int64 maxSamples)
+{
+    if (!file.existsAsFile() || maxSamples <= 0) return -1;
+
+   #if JUCE_LITTLE_ENDIAN
+    {
+        juce::MemoryMappedFile mapped(file, juce::MemoryMappedFile::readOnly);
+        if (mapped.getData() != nullptr)
+        {
+            juce::MemoryInputStream in(mapped.getData(), mapped.getSize(), false);
+            LoopFileHeader h;
+            if (readLoopFileHeader(in, h) && h.version == kLoopVersionV2)
+            {
+                const juce::int64 required = h.dataOffset + 2 * h.channelStride
+                                                          * static_cast<juce::int64>(sizeof(float));
+                if (static_cast<juce::int64>(mapped.getSize()) < required)
+                {
+                    DBG("Truncated loop file: " + file.getFullPathName());
+                    return -1;
+                }
+
+                // Refer to the mapped pages directly; the section copies them into its own storage
+                auto* body = static_cast<char*>(mapped.getData()) + h.dataOffset;
+                float* planes[2] = { reinterpret_cast<float*>(body),
+                                     reinterpret_cast<float*>(body) + h.channelStride };
+                const juce::int64 n = juce::jmin(h.numSamples, maxSamples);
+                const juce::AudioBuffer<float> view(planes, 2, static_cast<int>(n));
+
+                const bool ok = asOverdubLayer ? channel.loadOverdubLayer(section, view, n)
+                                               : channel.loadLoopData(section, view, n);
+                DBG("Loop mapped: " + file.getFileName() + " (" + juce::String(n) + " samples)");
+                return ok ? n : -1;
+            }
+        }
+    }
+   #endif
+
+    // v1 (or no mapping available): read through a temporary buffer
+    juce::int64 numSamples = maxSamples;
+    {
+        std::unique_ptr<juce::FileInputStream> stream(file.createInputStream());
+        LoopFileHeader h;
+        if (stream && readLoopFileHeader(*stream, h))
+            numSamples = juce::jmin(h.numSamples, maxSamples);
+    }
+
+    juce::AudioBuffer<float> tmp(2, static_cast<int>(numSamples));
+    const juce::int64 loaded = loadLoopFile(file, tmp, numSamples);
+    if (loaded <= 0) return -1;
+
+    const bool ok = asOverdubLayer ? channel.loadOverdubLayer(section, tmp, loaded)
+                                   : channel.loadLoopData(section, tmp, loaded);
+    return ok ? loaded : -1;
+}
+
 //==============================================================================
 // WAV helpers
 //==============================================================================
 
-juce::AudioBuffer<float> SongManager::mixDownChannel(
-    const juce::AudioBuffer<float>& baseLoop,
-    const std::vector<juce::AudioBuffer<float>>& overdubLayers,
-    juce::int64 numSamples)
+juce::int64 SongManager::loadAudioFileInto(const juce::File& file,
+                                           PagedLoopBuffer& dest,
+                                           juce::AudioBuffer<float>& scratch,
+                                           juce::int64 maxSamples)
 {
-    const int n = static_cast<int>(numSamples);
-    juce::AudioBuffer<float> mixed(2, n);
-    mixed.clear();
+    if (!file.existsAsFile()) return -1;
 
-    // Copy base loop
-    for (int ch = 0; ch < juce::jmin(2, baseLoop.getNumChannels()); ++ch)
-        mixed.copyFrom(ch, 0, baseLoop, ch, 0, juce::jmin(n, baseLoop.getNumSamples()));
+    // Find the length first so the scratch buffer is only as large as the file
+    const bool isWav = file.hasFileExtension(".wav");
+    const juce::int64 n = juce::jmin(getAudioFileLength(file), maxSamples);
+    if (n <= 0) return -1;
+
+    scratch.setSize(2, static_cast<int>(n), false, false, true);
+    const juce::int64 loaded = isWav ? loadWavFile(file, scratch, n)
+                                     : loadLoopFile(file, scratch, n);
+    if (loaded <= 0) return -1;
+
+    dest.write(scratch, 0, 0, static_cast<int>(loaded), false, false);
+    return loaded;
+}
 
-    // Sum overdub layers
-    for (const auto& layer : overdubLayers)
-        for (int ch = 0; ch < juce::jmin(2, layer.getNumChannels()); ++ch)
-            mixed.addFrom(ch, 0, layer, ch, 0, juce::jmin(n, layer.getNumSamples()));
+juce::int64 SongManager::getAudioFileLength(const juce::File& file)
+{
+    if (file.hasFileExtension(".wav"))
+    {
+        juce::AudioFormatManager fm;
+        fm.registerBasicFormats();
+        std::unique_ptr<juce::AudioFormatReader> reader(fm.createReaderFor(file));
+        return reader ? static_cast<juce::int64>(reader->lengthInSamples) : 0;
+    }
 
-    return mixed;
+    std::unique_ptr<juce::FileInputStream> stream(file.createInputStream());
+    LoopFileHeader h;
+    return (stream && readLoopFileHeader(*stream, h)) ? h.numSamples : 0;
+}
+
+void SongManager::mixDownChunk(const SectionSnapshot& snapshot, juce::AudioBuffer<float>& chunk,
+                               juce::int64 pos, int numSamples)
+{
+    chunk.clear(0, numSamples);
+
+    // Base loop, then overdub layers summed on top (unmapped pages read as silence)
+    auto addBuffer = [&](const PagedLoopBuffer& buf)
+    {
+        const int n = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, buf.getCapacity() - pos));
+        if (n > 0) buf.read(chunk, 0, pos, n, true);
+    };
+
+    addBuffer(snapshot.base);
+    for (const auto& layer : snapshot.layers)
+        addBuffer(*layer);
 }
 
 juce::Result SongManager::saveWavFile(const juce::File& file,
-                                       const juce::AudioBuffer<float>& buffer,
+                                       const SectionSnapshot& snapshot,
                                        juce::int64 numSamples,
-                                       double sampleRate)
+                                       double sampleRate,
+                                       WaveformOverview* overview)
 {
-    if (numSamples <= 0 || buffer.getNumChannels() < 2)
-        return juce::Result::fail("Invalid buffer for WAV save");
-    if (buffer.getNumSamples() < static_cast<int>(numSamples))
-        return juce::Result::fail("Buffer smaller than numSamples");
+    if (numSamples <= 0)
+        return juce::Result::fail("Invalid length for WAV save");
 
     auto tmpFile = file.getSiblingFile(file.getFileName() + ".tmp");
 
@@ -469,14 +1457,26 @@ juce::Result SongManager::saveWavFile(const juce::File& file,
         return juce::Result::fail("Cannot create WAV writer for: " + tmpFile.getFullPathName());
     // stream ownership transferred to writer on success
 
-    if (!writer->writeFromAudioSampleBuffer(buffer, 0, static_cast<int>(numSamples)))
+    if (overview) overview->beginBuild(numSamples);
+
+    juce::AudioBuffer<float> chunk(2, kMixdownChunk);
+    for (juce::int64 pos = 0; pos < numSamples; pos += kMixdownChunk)
     {
-        writer.reset();
-        tmpFile.deleteFile();
-        return juce::Result::fail("WAV write failed: " + tmpFile.getFullPathName());
+        const int n = static_cast<int>(juce::jmin<juce::int64>(kMixdownChunk, numSamples - pos));
+        mixDownChunk(snapshot, chunk, pos, n);
+
+        if (!writer->writeFromAudioSampleBuffer(chunk, 0, n))
+        {
+            writer.reset();
+            tmpFile.deleteFile();
+            if (overview) overview->clear();
+            return juce::Result::fail("WAV write failed: " + tmpFile.getFullPathName());
+        }
+        if (overview) overview->addChunk(chunk, pos, n);
     }
 
     writer.reset(); // flush & close
+    if (overview) overview->endBuild();
 
     if (!tmpFile.moveFileTo(file))
         return juce::Result::fail("Rename failed: " + tmpFile.getFullPathName() +
@@ -566,11 +1566,8 @@ ChannelConfig SongManager::readChannelState(Channel* channel,
             cfg.vstInstrument.slotIndex  = -1;
             cfg.vstInstrument.bypassed   = false;
 
-            // Save plugin state as Base64
-            const auto block = audioEngine.getPluginHost().savePluginState(vsti);
-            if (block.getSize() > 0)
-                cfg.vstInstrument.stateBase64 =
-                    PluginHostWrapper::memoryBlockToBase64(block);
+            // Raw state: finishSave() writes it to a sidecar file
+            cfg.vstInstrument.state = audioEngine.getPluginHost().savePluginState(vsti);
         }
     }
 
@@ -587,10 +1584,8 @@ ChannelConfig SongManager::readChannelState(Channel* channel,
         pd.manufacturer = plugin->getPluginDescription().manufacturerName;
         pd.bypassed     = channel->isPluginBypassed(slot);
 
-        // Save plugin state as Base64
-        const auto block = audioEngine.getPluginHost().savePluginState(plugin);
-        if (block.getSize() > 0)
-            pd.stateBase64 = PluginHostWrapper::memoryBlockToBase64(block);
+        // Raw state: finishSave() writes it to a sidecar file
+        pd.state = audioEngine.getPluginHost().savePluginState(plugin);
     }
 
     return cfg;
@@ -629,8 +1624,8 @@ juce::var SongManager::songToJSON(const Song& song)
     obj->setProperty("section_loop_lengths",    secLenArr);
 
     juce::Array<juce::var> chArr;
-    for (const auto& ch : song.channels)
-        chArr.add(channelToJSON(ch));
+    for (int i = 0; i < song.numChannels; ++i)
+        chArr.add(channelToJSON(song.channels[static_cast<size_t>(i)]));
     obj->setProperty("channels", chArr);
 
     return juce::var(obj);
@@ -689,10 +1684,14 @@ juce::Result SongManager::jsonToSong(const juce::var& json, Song& song)
         song.sectionLoopLengths[0] = song.loopLengthSamples;
     }
 
+    // As many channels as were saved (6 before the count was configurable)
     auto* chArr = obj->getProperty("channels").getArray();
-    if (chArr && chArr->size() >= 6)
-        for (int i = 0; i < 6; ++i)
+    if (chArr && !chArr->isEmpty())
+    {
+        song.numChannels = juce::jmin(chArr->size(), MAX_CHANNELS);
+        for (int i = 0; i < song.numChannels; ++i)
             jsonToChannel(chArr->getReference(i), song.channels[i]);
+    }
 
     return juce::Result::ok();
 }
@@ -811,7 +1810,10 @@ juce::var SongManager::pluginToJSON(const PluginData& p)
     obj->setProperty("identifier",   p.identifier);
     obj->setProperty("name",         p.name);
     obj->setProperty("manufacturer", p.manufacturer);
-    obj->setProperty("state_base64", p.stateBase64);
+    if (p.stateFileName.isNotEmpty())
+        obj->setProperty("state_file",   p.stateFileName);
+    else if (p.stateBase64.isNotEmpty())
+        obj->setProperty("state_base64", p.stateBase64);
     obj->setProperty("bypassed",     p.bypassed);
     return juce::var(obj);
 }
@@ -824,7 +1826,8 @@ juce::Result SongManager::jsonToPlugin(const juce::var& json, PluginData& p)
     p.identifier   = obj->getProperty("identifier")  .toString();
     p.name         = obj->getProperty("name")         .toString();
     p.manufacturer = obj->getProperty("manufacturer") .toString();
-    p.stateBase64  = obj->getProperty("state_base64") .toString();
+    p.stateFileName = obj->getProperty("state_file")  .toString();
+    p.stateBase64  = obj->getProperty("state_base64") .toString();   // songs before 1.2.0
     p.bypassed     = obj->getProperty("bypassed");
     return juce::Result::ok();
 }
@@ -848,7 +1851,7 @@ juce::Result SongManager::jsonToRouting(const juce::var& json, RoutingConfig& r)
     r.inputChannelRight  = obj->getProperty("input_right");
     r.outputChannelLeft  = obj->getProperty("output_left");
     r.outputChannelRight = obj->getProperty("output_right");
-    r.midiChannelFilter  = obj->getProperty("midi_filter");
+    r.midiChannelFilter  = juce::jlimit(0, 16, static_cast<int>(obj->getProperty("midi_filter")));   // 0 = omni
     return juce::Result::ok();
 }
 
@@ -914,7 +1917,114 @@ juce::Result SongManager::loadCurrentSong(AudioEngine& audioEngine)
     Song song;
     auto result = loadSong(songFile, song);
     if (result.failed()) return result;
-    return applySongToEngine(song, audioEngine);
+
+    applySongToEngineAsync(song, audioEngine, nullptr, [](juce::Result applied)
+    {
+        if (applied.failed())
+            DBG("Auto-recall: " + applied.getErrorMessage());
+    });
+    return juce::Result::ok();
+}
+
+juce::Result SongManager::recoverFromJournal(AudioEngine& audioEngine)
+{
+    const auto dir = RecordJournal::getDefaultDirectory();
+
+    auto* first = audioEngine.getChannel(0);
+    const juce::int64 maxFrames = first != nullptr ? first->getLoopBufferSize() : 0;
+    if (maxFrames <= 0)
+        return juce::Result::fail("Channels not prepared — journal kept for the next start");
+
+    //--- 1. Base song: settings, plugins and the audio the records build on ---
+    Song song;
+    bool haveSong = false;
+    const auto baseSong = RecordJournal::readBaseSong(dir);
+    if (baseSong.existsAsFile())
+    {
+        auto result = loadSong(baseSong, song);
+        if (result.wasOk())
+            result = applySongToEngine(song, audioEngine);
+        if (result.failed())
+            return juce::Result::fail("Base song of the journal not loaded: " + result.getErrorMessage());
+        haveSong = true;
+    }
+    else if (baseSong != juce::File())
+    {
+        DBG("Journal base song missing, replaying on an empty session: " + baseSong.getFullPathName());
+    }
+
+    //--- 2. Replay: a section the journal builds on starts as its mixdown ---
+    auto seed = [&audioEngine, maxFrames](int ch, int s, juce::AudioBuffer<float>& base, juce::int64& baseLength)
+    {
+        auto* channel = audioEngine.getChannel(ch);
+        const juce::int64 len = juce::jmin(maxFrames, audioEngine.getSectionLoopLength(s));
+        if (channel == nullptr || len <= 0 || !channel->sectionHasContent(s)) return;
+
+        SectionSnapshot snapshot;
+        if (!channel->snapshotSection(s, snapshot)) return;
+
+        base.setSize(2, static_cast<int>(len));
+        juce::AudioBuffer<float> chunk(2, kMixdownChunk);
+        for (juce::int64 pos = 0; pos < len; pos += kMixdownChunk)
+        {
+            const int n = static_cast<int>(juce::jmin<juce::int64>(kMixdownChunk, len - pos));
+            mixDownChunk(snapshot, chunk, pos, n);
+            for (int c = 0; c < 2; ++c)
+                base.copyFrom(c, static_cast<int>(pos), chunk, c, 0, n);
+        }
+        baseLength = len;
+    };
+
+    RecordJournal::Recovery recovery;
+    auto result = RecordJournal::readRecovery(dir, maxFrames, seed, recovery);
+    if (result.failed()) return result;
+
+    if (recovery.sampleRate > 0.0 && std::abs(recovery.sampleRate - audioEngine.getSampleRate()) > 1.0)
+        return juce::Result::fail("Journal was recorded at " + juce::String(recovery.sampleRate, 0)
+                                  + " Hz — switch the device to that rate to recover it");
+
+    //--- 3. Load the rebuilt sections ---
+    const bool wasPlaying = audioEngine.isPlaying();
+    if (wasPlaying) audioEngine.setPlaying(false);
+
+    int numSections = 0;
+    for (int ch = 0; ch < RecordJournal::kNumChannels; ++ch)
+    {
+        auto* channel = audioEngine.getChannel(ch);
+        if (channel == nullptr) continue;
+
+        for (int s = 0; s < NUM_SECTIONS; ++s)
+        {
+            auto& sec = recovery.sections[static_cast<size_t>(ch)][static_cast<size_t>(s)];
+            if (!sec.touched) continue;
+
+            channel->clearSection(s);
+            if (sec.baseLength > 0 && !channel->loadLoopData(s, sec.base, sec.baseLength))
+                DBG("WARNING: ch " + juce::String(ch) + " sec " + juce::String(s) + " recovered take not loaded");
+
+            for (auto& layer : sec.layers)
+            {
+                if (!layer.written) continue;
+                if (layer.audio.getNumSamples() < layer.length)
+                    layer.audio.setSize(2, static_cast<int>(layer.length), true, true);
+                channel->loadOverdubLayer(s, layer.audio, layer.length);
+            }
+            ++numSections;
+        }
+    }
+
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+        if (recovery.sectionLengths[static_cast<size_t>(s)] >= 0)
+            audioEngine.setSectionLoopLength(s, recovery.sectionLengths[static_cast<size_t>(s)]);
+
+    const int active = haveSong ? song.activeSection : 0;
+    audioEngine.getLoopEngine().setLoopLength(audioEngine.getSectionLoopLength(active));
+    audioEngine.requestSectionAllocation();
+
+    if (wasPlaying) audioEngine.setPlaying(true);
+
+    DBG("Recovered " + juce::String(numSections) + " section(s) from the record journal");
+    return juce::Result::ok();
 }
 
 //==============================================================================
@@ -943,13 +2053,19 @@ juce::Result SongManager::saveSongTemplate(Song& song, AudioEngine& audioEngine)
     for (int s = 0; s < NUM_SECTIONS; ++s)
         song.sectionLoopLengths[s] = 0;
 
-    for (int i = 0; i < 6; ++i)
+    song.numChannels = audioEngine.getNumChannels();
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
     {
         auto* channel = audioEngine.getChannel(i);
         if (!channel) continue;
 
         song.channels[i] = readChannelState(channel, audioEngine, i);
 
+        // A template is a single file: its plugin states stay inline
+        for (auto* pd : pluginsOf(song.channels[i]))
+            if (pd->state.getSize() > 0)
+                pd->stateBase64 = PluginHostWrapper::memoryBlockToBase64(pd->state);
+
         for (int s = 0; s < NUM_SECTIONS; ++s)
         {
             song.channels[i].sectionData[s].hasLoopData = false;
@@ -977,6 +2093,8 @@ juce::Result SongManager::saveSongTemplate(Song& song, AudioEngine& audioEngine)
 juce::Result SongManager::applySongTemplateToEngine(const Song& song, AudioEngine& audioEngine)
 {
     DBG("Applying song template to engine: " + song.songName);
+    cancelDeferredPlugins();   // an earlier preloaded song's plugins would land on top
+    cancelPendingConversion();
 
     // Global settings
     audioEngine.getLoopEngine().setBPM(song.bpm);
@@ -994,7 +2112,7 @@ juce::Result SongManager::applySongTemplateToEngine(const Song& song, AudioEngin
     audioEngine.setMasterGain(song.masterGain);
 
     // Per-channel settings (no loop data — preserve existing recordings)
-    for (int i = 0; i < 6; ++i)
+    for (int i = 0; i < audioEngine.getNumChannels(); ++i)
     {
         const auto& cfg = song.channels[i];
 
@@ -1011,19 +2129,9 @@ juce::Result SongManager::applySongTemplateToEngine(const Song& song, AudioEngin
         channel->setSolo       (cfg.solo);
         channel->setRouting    (cfg.routing);
         channel->setOneShot    (cfg.oneShot);
-
-        // Load plugins (async)
-        if (cfg.type == ChannelType::VSTi && !cfg.vstInstrument.identifier.isEmpty())
-            audioEngine.loadPluginAsync(i, -1, cfg.vstInstrument.identifier,
-                                        cfg.vstInstrument.stateBase64);
-
-        for (int slot = 0; slot < 3; ++slot)
-        {
-            const auto& pd = cfg.fxPlugins[slot];
-            if (!pd.identifier.isEmpty())
-                audioEngine.loadPluginAsync(i, slot, pd.identifier, pd.stateBase64, pd.bypassed);
-        }
     }
 
+    loadSongPlugins(song, audioEngine);   // async
+    audioEngine.requestSectionAllocation();
     return juce::Result::ok();
 }
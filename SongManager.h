@@ -1,9 +1,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
 #include "Song.h"
 #include "Channel.h"
 #include "AudioEngine.h"
+#include "PolyphaseResampler.h"
 
 /**
  * @file SongManager.h
@@ -23,9 +28,9 @@
  * Manages complete song save/load including:
  * - song.json metadata
  * - channel_N.loop audio files
- * - Plugin states (Base64 in JSON)
+ * - Plugin states (binary .state sidecars, referenced from song.json)
  */
-class SongManager
+class SongManager : private juce::Timer
 {
 public:
     SongManager();
@@ -42,6 +47,25 @@ public:
      * @return Result with error message if failed
      */
     juce::Result saveSong(Song& song, AudioEngine& audioEngine);
+
+    /**
+     * @brief Save complete song without blocking the message or audio thread
+     *
+     * Engine and plugin state are read immediately; loop audio is snapshotted
+     * copy-on-write and mixed/encoded on worker threads, one job per
+     * channel/section. Sections whose audio hasn't changed since the last save
+     * to the same file are not re-encoded.
+     *
+     * @param onProgress Called on the message thread with 0..1 as jobs finish
+     * @param onComplete Called on the message thread with the final result
+     */
+    void saveSongAsync(const Song& song,
+                       AudioEngine& audioEngine,
+                       std::function<void(float)> onProgress,
+                       std::function<void(juce::Result)> onComplete);
+
+    /** true while a saveSongAsync() is running. */
+    bool isSaving() const { return saveInProgress.load(std::memory_order_acquire); }
     
     /**
      * @brief Load complete song from directory
@@ -56,26 +80,78 @@ public:
      * @param song Song data to apply
      * @param audioEngine Audio engine to configure
      * @return Result with error message if failed
+     *
+     * Does not convert: a song recorded at another sample rate plays its
+     * converted copies if resampleSongFiles() has made them, else the
+     * originals (at the wrong speed).  Use applySongToEngineAsync() to convert.
      */
     juce::Result applySongToEngine(const Song& song, AudioEngine& audioEngine);
+
+    /**
+     * @brief applySongToEngine() once the song's loops are at the device rate.
+     *
+     * A song that needs no conversion (or is converted already) is applied
+     * before this returns.  Otherwise its files are converted on the resample
+     * pool first and the song is applied on the message thread afterwards;
+     * a later apply supersedes one still converting.
+     * @param onProgress  Message thread, 0..1 as files are converted (may be null)
+     * @param onComplete  Message thread, with the result of the apply
+     */
+    void applySongToEngineAsync(const Song& song,
+                                AudioEngine& audioEngine,
+                                std::function<void(float)> onProgress,
+                                std::function<void(juce::Result)> onComplete);
+
+    /** true while applySongToEngineAsync() is converting. */
+    bool isConvertingSong() const { return pendingConversion != nullptr; }
+
+    /**
+     * @brief Decode all loop audio of a song into standby storage (any thread).
+     *
+     * Touches no engine state, so a show can preload the next song in the
+     * background while the current one plays.
+     * @param loopBufferSize  Channel loop buffer size — standby page tables must match it
+     * @param sampleRate      Device rate; loops recorded at another rate are converted (0 = as recorded)
+     * @param shouldCancel    Polled between files; returning true aborts with a failed Result
+     */
+    juce::Result prepareStandbySong(const Song& song,
+                                    StandbySong& standby,
+                                    LoopPagePool& pool,
+                                    juce::int64 loopBufferSize,
+                                    double sampleRate = 0.0,
+                                    const std::function<bool()>& shouldCancel = nullptr);
+
+    /**
+     * @brief Apply a song whose audio was preloaded with prepareStandbySong().
+     *
+     * The loop audio is swapped in by the audio thread at the next loop
+     * boundary, without stopping playback; tempo, metronome and channel mix
+     * change in the same block.  Channel types, names and mute groups are set
+     * right away, plugins start loading once the swap has fired.
+     */
+    juce::Result applyPreloadedSong(const Song& song,
+                                    std::unique_ptr<StandbySong> standby,
+                                    AudioEngine& audioEngine);
     
     //==========================================================================
     // Loop File I/O
     //==========================================================================
     
     /**
-     * @brief Save loop buffer to .loop file
+     * @brief Save loop buffer to .loop file (format v2: planar, 64-byte aligned body)
      * @param file File to write to
      * @param buffer Audio buffer containing loop data
      * @param numSamples Number of samples to save
+     * @param sampleRate Stored for information only
      * @return Result with error message if failed
      */
     juce::Result saveLoopFile(const juce::File& file,
                              const juce::AudioBuffer<float>& buffer,
-                             juce::int64 numSamples);
+                             juce::int64 numSamples,
+                             double sampleRate = 44100.0);
     
     /**
-     * @brief Load loop buffer from .loop file
+     * @brief Load loop buffer from .loop file (v1 interleaved or v2 planar)
      * @param file File to read from
      * @param buffer Output: audio buffer to fill
      * @param maxSamples Maximum samples to read
@@ -84,7 +160,47 @@ public:
     juce::int64 loadLoopFile(const juce::File& file,
                       juce::AudioBuffer<float>& buffer,
                       juce::int64 maxSamples);
+
+    /**
+     * @brief Load a .loop file directly into a channel section
+     *
+     * v2 files are memory-mapped and copied straight into the section's pages —
+     * no intermediate buffer.  v1 files fall back to loadLoopFile().
+     * @param asOverdubLayer  true = append as overdub layer, false = replace base loop
+     * @return Number of samples loaded, or -1 if failed
+     */
+    juce::int64 loadLoopFileIntoSection(const juce::File& file,
+                                        Channel& channel,
+                                        int section,
+                                        bool asOverdubLayer,
+                                        juce::int64 maxSamples);
     
+    //==========================================================================
+    // Sample Rate Conversion
+    //==========================================================================
+
+    /** Filter quality for converting songs recorded at another sample rate. */
+    void setResampleQuality(PolyphaseResampler::Quality q) { resampleQuality.store(static_cast<int>(q)); }
+    PolyphaseResampler::Quality getResampleQuality() const
+    {
+        return static_cast<PolyphaseResampler::Quality>(resampleQuality.load());
+    }
+
+    /**
+     * @brief Convert all loop and layer files of a song to targetRate (any thread but message).
+     *
+     * One job per file on the resample pool; blocks until all are done.  The
+     * results go to <song>/resampled/<rate>-<quality>/ as .loop files and are
+     * reused by later loads at that rate and quality until the source file
+     * changes.  Loops are converted cyclically so they stay seamless.
+     * @param shouldCancel  Checked while waiting; files not started yet are skipped
+     */
+    juce::Result resampleSongFiles(const Song& song, double targetRate,
+                                   const std::function<bool()>& shouldCancel = nullptr);
+
+    /** True if the song's loops must be converted to play correctly at deviceRate. */
+    static bool needsResampling(const Song& song, double deviceRate);
+
     //==========================================================================
     // Utilities
     //==========================================================================
@@ -122,10 +238,22 @@ public:
     /**
      * @brief Restore the last auto-saved session from the "currentSong" slot.
      * Call from the message thread after audio is initialised.
-     * Silently fails if no auto-save exists yet.
+     * Silently fails if no auto-save exists yet.  Applied through
+     * applySongToEngineAsync(); a failure there is only logged.
      */
     juce::Result loadCurrentSong(AudioEngine& audioEngine);
 
+    /**
+     * @brief Rebuild the session a crash left in the record journal.
+     *
+     * Loads the journal's base song (if any), replays the recorded takes on top
+     * of it and loads the result into the channels.  Call from the message
+     * thread after audio is initialised and before the journal is started
+     * (then with keepExisting = true, so the replayed segments stay until the
+     * next save).  See RecordJournal.
+     */
+    juce::Result recoverFromJournal(AudioEngine& audioEngine);
+
     //==========================================================================
     // Song Template (settings only, no recordings)
     //==========================================================================
@@ -141,6 +269,71 @@ public:
     juce::Result applySongTemplateToEngine(const Song& song, AudioEngine& audioEngine);
 
 private:
+    //==========================================================================
+    // Save pipeline (see SongManager.cpp)
+    //==========================================================================
+
+    struct SaveSession;
+
+    juce::Result beginSave (SaveSession& session, AudioEngine& audioEngine);
+    void         runSaveJob(SaveSession& session, int jobIndex);
+    juce::Result finishSave(SaveSession& session);
+
+    /** Write a plugin state sidecar unless the file already holds exactly this state. */
+    bool writePluginState(const juce::File& file, const juce::MemoryBlock& state);
+    void         waitForPendingSaves();
+
+    juce::ThreadPool  savePool;
+    std::atomic<bool> saveInProgress {false};
+    juce::WaitableEvent saveDone {true};   // manual reset, signalled while no async save runs
+
+    // Plugins of a preloaded song, loaded once its audio swap has fired (message thread)
+    static constexpr int kDeferredPluginPollMs = 10;
+    Song         deferredPluginSong;
+    AudioEngine* deferredPluginEngine {nullptr};
+
+    void loadSongPlugins(const Song& song, AudioEngine& audioEngine);
+    void cancelDeferredPlugins();
+    void timerCallback() override;
+
+    // Sample rate conversion of loaded songs (see resampleSongFiles())
+    juce::ThreadPool resamplePool;
+    std::atomic<int> resampleQuality {static_cast<int>(PolyphaseResampler::Quality::Normal)};
+
+    struct ResampleBatch;
+
+    /** Queue one job per file still to convert; onFileDone runs on each job's thread. Null: nothing to do. */
+    std::shared_ptr<ResampleBatch> startResampleJobs(const Song& song, double targetRate,
+                                                     std::function<void(int)> onFileDone, juce::Result& error);
+    static juce::Result getBatchResult(const ResampleBatch& batch);
+
+    // applySongToEngineAsync() waiting for its conversion (message thread)
+    std::shared_ptr<ResampleBatch> pendingConversion;
+    int                            conversionGeneration {0};
+    void cancelPendingConversion();
+
+    /** Loop and layer files that have no up-to-date converted copy for targetRate. */
+    juce::Array<juce::File> getFilesToResample(const Song& song, double targetRate) const;
+
+    /** Converted copy of a source file for targetRate at the current quality (may not exist yet). */
+    juce::File getResampledFile(const Song& song, const juce::File& source, double targetRate) const;
+
+    /** The file to load: the converted copy if the song needs it and it exists, else source. */
+    juce::File resolveLoopFile(const Song& song, const juce::File& source, double targetRate) const;
+
+    /** Waveform overview saved next to a loop file (see WaveformOverview). */
+    static juce::File getOverviewFile(const juce::File& loopFile);
+
+    juce::Result resampleFile(const juce::File& source, const juce::File& dest,
+                              const PolyphaseResampler& resampler);
+
+    /** Length in samples of a .wav or .loop file, 0 if unreadable. */
+    juce::int64 getAudioFileLength(const juce::File& file);
+
+    // Content hash of the last WAV (or plugin state sidecar) written per file path
+    std::map<juce::String, juce::uint64> savedSectionHashes;
+    juce::CriticalSection                hashLock;
+
     //==========================================================================
     // JSON Serialization
     //==========================================================================
@@ -196,21 +389,26 @@ private:
                                    AudioEngine& audioEngine,
                                    int channelIndex);
 
+    /** Frames mixed per step on save: 2 x 8192 floats stay in L2 across all layers. */
+    static constexpr int kMixdownChunk = 8192;
+
     /**
-     * @brief Mix down base loop + overdub layers into a single buffer
+     * @brief Mix [pos, pos + numSamples) of a snapshot's base loop + overdub layers into chunk
      */
-    juce::AudioBuffer<float> mixDownChannel(
-        const juce::AudioBuffer<float>& baseLoop,
-        const std::vector<juce::AudioBuffer<float>>& overdubLayers,
-        juce::int64 numSamples);
+    static void mixDownChunk(const SectionSnapshot& snapshot, juce::AudioBuffer<float>& chunk,
+                             juce::int64 pos, int numSamples);
 
     /**
-     * @brief Save audio buffer to WAV file (24-bit, crash-safe via temp rename)
+     * @brief Mix a snapshot down into a WAV file (24-bit, crash-safe via temp rename)
+     *
+     * Streams kMixdownChunk frames at a time into the writer; the full-length
+     * mix never exists in memory.  overview (optional) is built on the way.
      */
     juce::Result saveWavFile(const juce::File& file,
-                             const juce::AudioBuffer<float>& buffer,
+                             const SectionSnapshot& snapshot,
                              juce::int64 numSamples,
-                             double sampleRate);
+                             double sampleRate,
+                             WaveformOverview* overview = nullptr);
 
     /**
      * @brief Load audio from WAV file into buffer
@@ -219,6 +417,16 @@ private:
     juce::int64 loadWavFile(const juce::File& file,
                             juce::AudioBuffer<float>& buffer,
                             juce::int64 maxSamples);
+
+    /**
+     * @brief Decode a .wav or .loop file into a paged buffer via a reusable scratch buffer
+     * @return Number of samples written, or -1 on failure
+     */
+    juce::int64 loadAudioFileInto(const juce::File& file,
+                                  PagedLoopBuffer& dest,
+                                  juce::AudioBuffer<float>& scratch,
+                                  juce::int64 maxSamples);
     
+    JUCE_DECLARE_WEAK_REFERENCEABLE(SongManager)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SongManager)
 };
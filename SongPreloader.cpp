@@ -0,0 +1,91 @@
+#include "SongPreloader.h"
+
+//==============================================================================
+SongPreloader::SongPreloader(SongManager& sm, LoopPagePool& pool)
+    : juce::Thread("Song Preload")
+    , songManager(sm)
+    , pagePool(pool)
+{}
+
+SongPreloader::~SongPreloader()
+{
+    cancel();
+}
+
+//==============================================================================
+// Message Thread
+//==============================================================================
+
+void SongPreloader::preload(const juce::File& songDirectory, juce::int64 loopBufferSize,
+                            double sampleRate)
+{
+    cancel();
+    if (loopBufferSize <= 0 || !songDirectory.getChildFile("song.json").existsAsFile())
+        return;
+
+    targetDirectory  = songDirectory;
+    targetBufferSize = loopBufferSize;
+    targetSampleRate = sampleRate;
+    startThread(juce::Thread::Priority::low);
+}
+
+SongPreloader::TakeResult SongPreloader::take(const juce::File& songDirectory, Song& song,
+                                              std::unique_ptr<StandbySong>& audio)
+{
+    if (songDirectory != targetDirectory)
+    {
+        cancel();
+        return TakeResult::Unavailable;
+    }
+
+    if (isThreadRunning())
+        return TakeResult::StillLoading;
+
+    const bool ok = ready.exchange(false) && preloadedAudio != nullptr
+                 && songDirectory.getChildFile("song.json").getLastModificationTime() == songFileTime;
+    if (ok)
+    {
+        song  = std::move(preloadedSong);
+        audio = std::move(preloadedAudio);
+    }
+
+    cancel();
+    return ok ? TakeResult::Taken : TakeResult::Unavailable;
+}
+
+void SongPreloader::cancel()
+{
+    stopThread(10000);   // decoding checks threadShouldExit() between files
+    ready.store(false);
+    preloadedAudio.reset();
+    preloadedSong   = Song();
+    targetDirectory = juce::File();
+}
+
+//==============================================================================
+// Preload Thread
+//==============================================================================
+
+void SongPreloader::run()
+{
+    const auto songFile = targetDirectory.getChildFile("song.json");
+    songFileTime = songFile.getLastModificationTime();
+
+    auto result = songManager.loadSong(songFile, preloadedSong);
+    if (result.failed() || threadShouldExit())
+        return;
+
+    auto audio = std::make_unique<StandbySong>();
+    result = songManager.prepareStandbySong(preloadedSong, *audio, pagePool, targetBufferSize,
+                                            targetSampleRate,
+                                            [this] { return threadShouldExit(); });
+    if (result.failed())
+    {
+        DBG("Song preload failed: " + result.getErrorMessage());
+        return;
+    }
+
+    preloadedAudio = std::move(audio);
+    ready.store(true);
+    DBG("Song preload ready: " + targetDirectory.getFileName());
+}
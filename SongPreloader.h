@@ -0,0 +1,67 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include "Song.h"
+#include "SongManager.h"
+
+//==============================================================================
+/**
+ * @file SongPreloader.h
+ * @brief Loads the next song of a show in the background
+ *
+ * Parses song.json and decodes every loop file into a StandbySong while the
+ * current song keeps playing.  When the user moves on, take() hands the result
+ * over and SongManager::applyPreloadedSong() lets the audio thread swap it in.
+ *
+ * Thread-safety:
+ *   Message thread: preload(), take(), cancel()
+ *   Preload thread: run()
+ */
+class SongPreloader : private juce::Thread
+{
+public:
+    SongPreloader(SongManager& songManager, LoopPagePool& pool);
+    ~SongPreloader() override;
+
+    /** Start loading songDirectory (replaces any earlier preload), converted to sampleRate if needed. */
+    void preload(const juce::File& songDirectory, juce::int64 loopBufferSize, double sampleRate);
+
+    enum class TakeResult
+    {
+        Taken,         ///< song and audio handed over
+        StillLoading,  ///< that song is still being read: ask again later, the preload is kept
+        Unavailable    ///< another song, failed, or saved again since it was read (discarded)
+    };
+
+    /**
+     * @brief Hand over the preloaded song if it is for songDirectory.
+     *
+     * Never waits: a preload of that song that is still running is left to
+     * finish (finishing it is still faster than starting over).
+     */
+    TakeResult take(const juce::File& songDirectory, Song& song, std::unique_ptr<StandbySong>& audio);
+
+    /** Abort and discard the current preload. */
+    void cancel();
+
+private:
+    SongManager&  songManager;
+    LoopPagePool& pagePool;
+
+    // Written by the message thread while the preload thread is stopped
+    juce::File  targetDirectory;
+    juce::int64 targetBufferSize {0};
+    double      targetSampleRate {0.0};
+
+    // Written by the preload thread, read after it has finished
+    Song                         preloadedSong;
+    std::unique_ptr<StandbySong> preloadedAudio;
+    juce::Time                   songFileTime;
+    std::atomic<bool>            ready {false};
+
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SongPreloader)
+};
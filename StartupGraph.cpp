@@ -0,0 +1,153 @@
+#include "StartupGraph.h"
+
+//==============================================================================
+StartupGraph::TaskId StartupGraph::addTask(const juce::String& name, std::function<void()> work,
+                                           std::initializer_list<TaskId> dependencies)
+{
+    return add(name, std::move(work), dependencies, false);
+}
+
+StartupGraph::TaskId StartupGraph::addMessageTask(const juce::String& name, std::function<void()> work,
+                                                  std::initializer_list<TaskId> dependencies)
+{
+    return add(name, std::move(work), dependencies, true);
+}
+
+StartupGraph::TaskId StartupGraph::add(const juce::String& name, std::function<void()> work,
+                                       std::initializer_list<TaskId> dependencies, bool onMessageThread)
+{
+    const auto id = static_cast<TaskId>(tasks.size());
+
+    Task t;
+    t.name            = name;
+    t.work            = std::move(work);
+    t.onMessageThread = onMessageThread;
+    for (const auto dep : dependencies)
+    {
+        // Dependencies first: no task can wait on itself or a later one
+        jassert(dep >= 0 && dep < id);
+        if (dep < 0 || dep >= id) continue;
+        tasks[static_cast<size_t>(dep)].dependents.push_back(id);
+        ++t.numDependencies;
+    }
+    tasks.push_back(std::move(t));
+    return id;
+}
+
+//==============================================================================
+void StartupGraph::run(const std::function<void(const juce::String&)>& onProgress)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    originMs = juce::Time::getMillisecondCounterHiRes();
+    numDone  = 0;
+    pool = std::make_unique<juce::ThreadPool>(juce::jlimit(2, 8, juce::SystemStats::getNumCpus() - 1));
+
+    juce::String lastProgress;
+    auto report = [&]
+    {
+        juce::String text;
+        {
+            const juce::ScopedLock sl(lock);
+            text = describeProgress();
+        }
+        if (text != lastProgress && onProgress)
+            onProgress(text);
+        lastProgress = text;
+    };
+
+    {
+        const juce::ScopedLock sl(lock);
+        for (auto& t : tasks)
+        {
+            t.pending = t.numDependencies;
+            t.state   = State::Waiting;
+        }
+        submitReadyPoolTasks();
+    }
+
+    for (;;)
+    {
+        TaskId next = -1;
+        {
+            const juce::ScopedLock sl(lock);
+            if (numDone == static_cast<int>(tasks.size()))
+                break;
+
+            for (size_t i = 0; i < tasks.size() && next < 0; ++i)
+            {
+                auto& t = tasks[i];
+                if (t.onMessageThread && t.state == State::Waiting && t.pending == 0)
+                {
+                    t.state = State::Running;
+                    next = static_cast<TaskId>(i);
+                }
+            }
+        }
+
+        report();
+        if (next >= 0)
+            execute(next);
+        else
+            taskFinished.wait(20);
+    }
+
+    pool.reset();   // every job has returned by now
+    totalMs = juce::Time::getMillisecondCounterHiRes() - originMs;
+    logTimings();
+}
+
+void StartupGraph::execute(TaskId id)
+{
+    auto& t = tasks[static_cast<size_t>(id)];
+    t.startMs = juce::Time::getMillisecondCounterHiRes() - originMs;
+    if (t.work)
+        t.work();
+    t.endMs = juce::Time::getMillisecondCounterHiRes() - originMs;
+
+    {
+        const juce::ScopedLock sl(lock);
+        t.state = State::Done;
+        ++numDone;
+        for (const auto dep : t.dependents)
+            --tasks[static_cast<size_t>(dep)].pending;
+        submitReadyPoolTasks();
+    }
+    taskFinished.signal();
+}
+
+void StartupGraph::submitReadyPoolTasks()
+{
+    for (size_t i = 0; i < tasks.size(); ++i)
+    {
+        auto& t = tasks[i];
+        if (t.onMessageThread || t.state != State::Waiting || t.pending != 0)
+            continue;
+
+        t.state = State::Running;
+        const auto id = static_cast<TaskId>(i);
+        pool->addJob([this, id] { execute(id); });
+    }
+}
+
+juce::String StartupGraph::describeProgress() const
+{
+    juce::StringArray running;
+    for (const auto& t : tasks)
+        if (t.state == State::Running)
+            running.add(t.name);
+
+    return (running.isEmpty() ? juce::String("Starting") : running.joinIntoString(", "))
+         + "... (" + juce::String(numDone) + "/" + juce::String(static_cast<int>(tasks.size())) + ")";
+}
+
+void StartupGraph::logTimings() const
+{
+    // Logged in release builds too: cold-start time is measured on the show machine
+    juce::Logger::writeToLog("Startup: " + juce::String(totalMs, 0) + " ms");
+    for (const auto& t : tasks)
+        juce::Logger::writeToLog("  " + t.name.paddedRight(' ', 18)
+                                 + " +" + juce::String(t.startMs, 0).paddedLeft(' ', 5) + " ms  "
+                                 + juce::String(t.endMs - t.startMs, 0).paddedLeft(' ', 5) + " ms  "
+                                 + (t.onMessageThread ? "message" : "pool"));
+}
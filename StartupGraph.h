@@ -0,0 +1,79 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file StartupGraph.h
+ * @brief Application start as a small task graph (file work on a pool, UI work here)
+ *
+ * Each task names the tasks it needs; everything else runs concurrently.
+ * Pool tasks run on a juce::ThreadPool, message tasks on the thread that
+ * called run() — device and component work stays on the message thread,
+ * which picks up ready message tasks while the pool works.
+ *
+ * run() blocks until every task has finished, reports the running tasks to
+ * the progress callback (splash screen) and logs a start/duration line per
+ * task.  Dependencies must be added before their dependents, so the graph
+ * cannot have cycles.
+ *
+ * Thread-safety: add*() and run() on the message thread.  Tasks must not
+ * throw; a task that fails leaves its result for its dependents to check.
+ */
+class StartupGraph
+{
+public:
+    using TaskId = int;
+
+    StartupGraph() = default;
+
+    /** Task for the thread pool. */
+    TaskId addTask(const juce::String& name, std::function<void()> work,
+                   std::initializer_list<TaskId> dependencies = {});
+
+    /** Task for the message thread (devices, components, anything JUCE wants there). */
+    TaskId addMessageTask(const juce::String& name, std::function<void()> work,
+                          std::initializer_list<TaskId> dependencies = {});
+
+    /** Run every task; returns when the last one has finished. Message thread. */
+    void run(const std::function<void(const juce::String&)>& onProgress);
+
+    /** Wall time of the last run() in ms. */
+    double getTotalMs() const noexcept { return totalMs; }
+
+private:
+    enum class State { Waiting, Running, Done };
+
+    struct Task
+    {
+        juce::String          name;
+        std::function<void()> work;
+        std::vector<TaskId>   dependents;
+        int   numDependencies  {0};
+        int   pending          {0};      // dependencies not done yet
+        bool  onMessageThread  {false};
+        State state            {State::Waiting};
+        double startMs {0.0};
+        double endMs   {0.0};
+    };
+
+    std::vector<Task> tasks;
+    juce::CriticalSection lock;        // task states while run() is going
+    juce::WaitableEvent   taskFinished;
+    std::unique_ptr<juce::ThreadPool> pool;
+    int    numDone {0};
+    double originMs {0.0};
+    double totalMs  {0.0};
+
+    TaskId add(const juce::String& name, std::function<void()> work,
+               std::initializer_list<TaskId> dependencies, bool onMessageThread);
+    void execute(TaskId id);
+    void submitReadyPoolTasks();                     // under lock
+    juce::String describeProgress() const;           // under lock
+    void logTimings() const;
+
+    JUCE_DECLARE_NON_COPYABLE(StartupGraph)
+};
@@ -0,0 +1,250 @@
+#include "StemRecorder.h"
+#include <limits>
+
+//==============================================================================
+StemRecorder::StemRecorder()
+    : juce::Thread("Stem Writer")
+{
+}
+
+StemRecorder::~StemRecorder()
+{
+    stop();
+    waitUntilClosed(-1);
+}
+
+//==============================================================================
+// Message thread
+//==============================================================================
+
+juce::Result StemRecorder::start(const juce::File& dir, const juce::String& prefix, double sampleRate,
+                                 int numChannels)
+{
+    if (active.load(std::memory_order_relaxed))
+        return juce::Result::fail("Stem recording already running");
+    if (isThreadRunning())
+        return juce::Result::fail("Stem recording still closing the previous files");
+    if (sampleRate <= 0.0)
+        return juce::Result::fail("No audio device");
+    if (!dir.createDirectory())
+        return juce::Result::fail("Cannot create: " + dir.getFullPathName());
+
+    directory = dir;
+    numStems  = juce::jlimit(0, kNumStems, numChannels * 2);
+    const int ringFrames = juce::roundToInt(sampleRate * kRingSeconds) + kWriteChunk;
+
+    juce::WavAudioFormat wavFormat;
+    for (int i = 0; i < numStems; ++i)
+    {
+        auto& stem = stems[static_cast<size_t>(i)];
+        const auto file = dir.getChildFile(prefix + "_ch" + juce::String(i / 2 + 1)
+                                           + ((i & 1) != 0 ? "_fx.wav" : "_dry.wav"));
+
+        // Large stream buffer: the disk sees MB-sized writes, not one per chunk
+        auto fileStream = file.createOutputStream(kDiskBufferBytes);
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        if (fileStream)
+            writer.reset(wavFormat.createWriterFor(fileStream.get(), sampleRate, 2, 24, {}, 0));
+
+        if (!writer)
+        {
+            for (auto& s : stems) s.writer.reset();
+            return juce::Result::fail("Cannot create: " + file.getFullPathName());
+        }
+        fileStream.release();   // writer now owns the stream
+
+        stem.ring.setSize(2, ringFrames, false, true);
+        stem.fifo.setTotalSize(ringFrames);
+        stem.fifo.reset();
+        stem.written.store(false, std::memory_order_relaxed);
+        stem.pendingGap = 0;
+        stem.writer = std::move(writer);
+    }
+
+    dropouts.store(0, std::memory_order_relaxed);
+    droppedFrames.store(0, std::memory_order_relaxed);
+    maxFill.store(0.0f, std::memory_order_relaxed);
+    fill.store(0.0f, std::memory_order_relaxed);
+
+    startThread(juce::Thread::Priority::normal);
+    active.store(true, std::memory_order_release);   // capture begins with the next block
+    DBG("Stem recording started: " + dir.getFullPathName());
+    return juce::Result::ok();
+}
+
+void StemRecorder::stop()
+{
+    if (!active.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    // The writer waits for the audio thread's last block, writes the tail and
+    // closes the files on its own; nothing here blocks the caller
+    notify();
+    DBG("Stem recording stopping");
+}
+
+bool StemRecorder::waitUntilClosed(int timeoutMs)
+{
+    return waitForThreadToExit(timeoutMs);
+}
+
+//==============================================================================
+// Audio / render threads
+//==============================================================================
+
+void StemRecorder::write(int stem, const juce::AudioBuffer<float>& source, int numSamples) noexcept
+{
+    if (stem < 0 || stem >= numStems || !isCapturing()) return;
+    if (source.getNumChannels() < 2 || source.getNumSamples() < numSamples) return;
+
+    auto& s = stems[static_cast<size_t>(stem)];
+    push(s, &source, numSamples);
+    s.written.store(true, std::memory_order_relaxed);
+}
+
+void StemRecorder::endBlock(int numSamples) noexcept
+{
+    if (isCapturing())
+        for (int i = 0; i < numStems; ++i)
+            if (auto& s = stems[static_cast<size_t>(i)]; !s.written.exchange(false, std::memory_order_relaxed))
+                push(s, nullptr, numSamples);
+
+    // Start/stop take effect between blocks so every stem gets the same blocks
+    const bool wanted = active.load(std::memory_order_acquire);
+    if (wanted != capturing.load(std::memory_order_relaxed))
+        capturing.store(wanted, std::memory_order_release);
+}
+
+int StemRecorder::getMinFreeSpace() const noexcept
+{
+    int space = std::numeric_limits<int>::max();
+    for (int i = 0; i < numStems; ++i)
+        space = juce::jmin(space, stems[static_cast<size_t>(i)].fifo.getFreeSpace());
+    return space;
+}
+
+bool StemRecorder::push(Stem& s, const juce::AudioBuffer<float>* source, int numSamples) noexcept
+{
+    if (numSamples <= 0) return true;
+
+    auto put = [&s](const juce::AudioBuffer<float>* src, int srcStart, int num)
+    {
+        int s1, n1, s2, n2;
+        s.fifo.prepareToWrite(num, s1, n1, s2, n2);
+        for (int ch = 0; ch < 2; ++ch)
+        {
+            if (src != nullptr)
+            {
+                if (n1 > 0) s.ring.copyFrom(ch, s1, *src, ch, srcStart,      n1);
+                if (n2 > 0) s.ring.copyFrom(ch, s2, *src, ch, srcStart + n1, n2);
+            }
+            else
+            {
+                if (n1 > 0) s.ring.clear(ch, s1, n1);
+                if (n2 > 0) s.ring.clear(ch, s2, n2);
+            }
+        }
+        s.fifo.finishedWrite(n1 + n2);
+    };
+
+    // Silence owed for earlier drops goes first, as much as fits
+    int freeSpace = s.fifo.getFreeSpace();
+    if (s.pendingGap > 0)
+    {
+        const int gap = juce::jmin(s.pendingGap, freeSpace);
+        put(nullptr, 0, gap);
+        s.pendingGap -= gap;
+        freeSpace    -= gap;
+    }
+
+    // Full: drop this block too and owe it as silence, the file length stays in step
+    if (s.pendingGap > 0 || freeSpace < numSamples)
+    {
+        s.pendingGap += numSamples;
+        dropouts.fetch_add(1, std::memory_order_relaxed);
+        droppedFrames.fetch_add(numSamples, std::memory_order_relaxed);
+        return false;
+    }
+
+    put(source, 0, numSamples);
+    return true;
+}
+
+//==============================================================================
+// Writer thread
+//==============================================================================
+
+void StemRecorder::run()
+{
+    juce::uint32 stopSeenMs = 0;
+    while (!threadShouldExit())
+    {
+        // Stopped: done once the audio thread has latched it (or, with the device
+        // gone, nobody is left to latch it)
+        if (!active.load(std::memory_order_acquire))
+        {
+            const auto now = juce::Time::getMillisecondCounter();
+            if (stopSeenMs == 0)
+                stopSeenMs = juce::jmax<juce::uint32>(1, now);
+            if (!capturing.load(std::memory_order_acquire)
+                || now - stopSeenMs >= static_cast<juce::uint32>(kStopLatchMs))
+                break;
+        }
+
+        bool wrote = false;
+        float current = 0.0f;
+        for (auto& stem : stems)
+        {
+            current = juce::jmax(current, static_cast<float>(stem.fifo.getNumReady())
+                                          / static_cast<float>(juce::jmax(1, stem.fifo.getTotalSize() - 1)));
+            wrote |= drain(stem, kWriteChunk);
+        }
+
+        fill.store(current, std::memory_order_relaxed);
+        if (current > maxFill.load(std::memory_order_relaxed))
+            maxFill.store(current, std::memory_order_relaxed);
+
+        // Sleep only when no full chunk is waiting anywhere
+        if (!wrote)
+            wait(10);
+    }
+
+    capturing.store(false, std::memory_order_release);
+
+    // Stopped: the tail of every stem, whatever its size
+    for (auto& stem : stems)
+        while (drain(stem, 1)) {}
+
+    for (auto& stem : stems)
+        stem.writer.reset();   // flush & close
+
+    DBG("Stem recording stopped, " + juce::String(getNumDropouts()) + " dropouts");
+}
+
+bool StemRecorder::drain(Stem& s, int minFrames)
+{
+    if (s.writer == nullptr) return false;
+
+    const int ready = s.fifo.getNumReady();
+    if (ready < minFrames || ready <= 0) return false;
+
+    int s1, n1, s2, n2;
+    s.fifo.prepareToRead(juce::jmin(ready, kWriteChunk), s1, n1, s2, n2);
+
+    bool ok = true;
+    if (n1 > 0)
+    {
+        const float* part[] = { s.ring.getReadPointer(0, s1), s.ring.getReadPointer(1, s1) };
+        ok &= s.writer->writeFromFloatArrays(part, 2, n1);
+    }
+    if (n2 > 0)
+    {
+        const float* part[] = { s.ring.getReadPointer(0, s2), s.ring.getReadPointer(1, s2) };
+        ok &= s.writer->writeFromFloatArrays(part, 2, n2);
+    }
+    s.fifo.finishedRead(n1 + n2);
+
+    if (!ok)
+        DBG("StemRecorder: write failed");
+    return true;
+}
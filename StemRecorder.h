@@ -0,0 +1,121 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <array>
+#include <atomic>
+#include <memory>
+
+//==============================================================================
+/**
+ * @file StemRecorder.h
+ * @brief Per-channel stem recording (dry and post-FX) next to the master recorder
+ *
+ * Every stem has its own preallocated stereo ring (single producer: the
+ * thread rendering that channel, single consumer: the writer thread).  One
+ * "Stem Writer" thread serves all stems: it waits until a ring holds at
+ * least kWriteChunk frames and hands them to the WAV writer in one call.
+ * The files are opened with a kDiskBufferBytes stream buffer, so the disk
+ * sees few large writes instead of twelve streams of block-sized ones.
+ *
+ * Backpressure: the writer only sleeps when no ring holds a full chunk, so
+ * it keeps pace as long as the disk does.  If a ring is full anyway, the
+ * audio thread drops the block and counts it (getNumDropouts()); the gap is
+ * written as silence with the next block that fits, so all stems keep the
+ * same length and stay sample-aligned.
+ *
+ * A stem that is not written in a block (channel idle, FX chain skipped)
+ * gets silence from endBlock() for the same reason.  Capture starts and
+ * ends on block boundaries (endBlock() latches the start/stop), so no stem
+ * gets a partial first or last block.
+ *
+ * Thread-safety:
+ *   Audio/render threads: write(), endBlock()
+ *   Message thread      : start(), stop()
+ *   Writer thread       : finishes a stopped take and closes its files
+ */
+class StemRecorder : private juce::Thread
+{
+public:
+    static constexpr int    kNumChannels     = 16;                 // MAX_CHANNELS (Channel.h)
+    static constexpr int    kNumStems        = kNumChannels * 2;   // dry + post-FX per channel
+    static constexpr double kRingSeconds     = 2.0;
+    static constexpr int    kWriteChunk      = 16384;              // frames per writer call
+    static constexpr size_t kDiskBufferBytes = 1 << 20;
+    static constexpr int    kStopLatchMs     = 200;                // device gone: stop without its block
+
+    static int getStemIndex(int channel, bool postFx) noexcept { return channel * 2 + (postFx ? 1 : 0); }
+
+    StemRecorder();
+    ~StemRecorder() override;
+
+    /**
+     * @brief Open one 24-bit WAV per stem in directory and start the writer thread.
+     *
+     * Files are named `<prefix>_chN_dry.wav` / `<prefix>_chN_fx.wav`, for the
+     * first numChannels channels.  Rings are allocated here, never on the audio
+     * thread.  Message thread.
+     */
+    juce::Result start(const juce::File& directory, const juce::String& prefix, double sampleRate,
+                       int numChannels = kNumChannels);
+
+    /**
+     * @brief Stop accepting audio; the writer thread writes what is left and closes the files.
+     *
+     * Returns at once.  Capture ends with the audio thread's next block; until the
+     * files are closed start() refuses a new take.  Message thread.
+     */
+    void stop();
+
+    /** Wait until the files of a stopped take are closed (-1 = no deadline); false on timeout. */
+    bool waitUntilClosed(int timeoutMs);
+
+    bool isRecording() const noexcept { return active.load(std::memory_order_acquire); }
+
+    /** true from the block after start() to the block that saw stop(). Audio/render threads. */
+    bool isCapturing() const noexcept { return capturing.load(std::memory_order_acquire); }
+
+    /** Append numSamples of a stereo buffer to a stem (while capturing). Lock-free, never blocks. */
+    void write(int stem, const juce::AudioBuffer<float>& source, int numSamples) noexcept;
+
+    /** End of a render (sub-)block: silence for every stem nobody wrote. Audio thread. */
+    void endBlock(int numSamples) noexcept;
+
+    /** Frames every ring can still take — an offline render waits on this instead of dropping. */
+    int getMinFreeSpace() const noexcept;
+
+    //==========================================================================
+    // Diagnostics (any thread)
+    int         getNumDropouts()     const noexcept { return dropouts.load(std::memory_order_relaxed); }
+    juce::int64 getDroppedFrames()   const noexcept { return droppedFrames.load(std::memory_order_relaxed); }
+    float       getMaxFill()         const noexcept { return maxFill.load(std::memory_order_relaxed); }   // 0..1 since start
+    float       getFill()            const noexcept { return fill.load(std::memory_order_relaxed); }      // 0..1, fullest ring now
+    juce::File  getDirectory()       const          { return directory; }
+
+private:
+    struct Stem
+    {
+        juce::AbstractFifo fifo {1};
+        juce::AudioBuffer<float> ring;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+        std::atomic<bool> written {false};   // this block
+        int pendingGap {0};                  // frames dropped, owed as silence (producer only)
+    };
+
+    std::array<Stem, kNumStems> stems;
+    int numStems {0};                      // stems with a file, set before active
+    std::atomic<bool> active    {false};   // message thread's intent
+    std::atomic<bool> capturing {false};   // latched by endBlock()
+
+    std::atomic<int>         dropouts      {0};
+    std::atomic<juce::int64> droppedFrames {0};
+    std::atomic<float>       maxFill       {0.0f};
+    std::atomic<float>       fill          {0.0f};   // writer thread, once per pass
+
+    juce::File directory;   // message thread
+
+    void run() override;
+    bool drain(Stem& stem, int minFrames);   // writer thread; true if frames were written
+    bool push(Stem& stem, const juce::AudioBuffer<float>* source, int numSamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StemRecorder)
+};
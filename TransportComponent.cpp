@@ -3,8 +3,9 @@
 #include "AppConfig.h"
 
 //==============================================================================
-TransportComponent::TransportComponent(AudioEngine& engine)
+TransportComponent::TransportComponent(AudioEngine& engine, UiRefreshClock& refreshClock)
     : audioEngine(engine)
+    , uiClock(refreshClock)
 {
     //--------------------------------------------------------------------------
     // Transport
@@ -231,6 +232,12 @@ TransportComponent::TransportComponent(AudioEngine& engine)
     if (!kFreeVersion)
         addAndMakeVisible(masterRecordButton);
 
+    bounceButton.setTooltip("Render the song offline, faster than real time, through all FX "
+                            "(mixdown, optionally stems).");
+    bounceButton.onClick = [this] { bounceClicked(); };
+    if (!kFreeVersion)
+        addAndMakeVisible(bounceButton);
+
     //--------------------------------------------------------------------------
     // Reset
     resetButton.setColour(juce::TextButton::buttonColourId, juce::Colours::darkred);
@@ -277,7 +284,7 @@ TransportComponent::TransportComponent(AudioEngine& engine)
     fixedLenSlider   .setLookAndFeel(&filledBarLnF);
 
     updateMetronomeButtonStates();
-    startTimer(50);  // 20 Hz
+    uiClock.addClient(*this, 20);
 }
 
 TransportComponent::~TransportComponent()
@@ -289,7 +296,7 @@ TransportComponent::~TransportComponent()
     fixedLenSlider   .setLookAndFeel(nullptr);
     for (int g = 0; g < kMaxMuteGroups; ++g)
         muteGroupToggleButtons[g].setLookAndFeel(nullptr);
-    stopTimer();
+    uiClock.removeClient(*this);
 }
 
 //==============================================================================
@@ -394,10 +401,17 @@ void TransportComponent::resized()
     area.removeFromTop(2);
     {
         auto row = area.removeFromTop(26);
-        const int half = row.getWidth() / 2;
-        doubleLoopButton.setBounds(row.removeFromLeft(half).reduced(0, 1));
         if (!kFreeVersion)
-            masterRecordButton.setBounds(row.reduced(0, 1));
+        {
+            const int third = row.getWidth() / 3;
+            doubleLoopButton  .setBounds(row.removeFromLeft(third).reduced(0, 1));
+            masterRecordButton.setBounds(row.removeFromLeft(third).reduced(0, 1));
+            bounceButton      .setBounds(row.reduced(0, 1));
+        }
+        else
+        {
+            doubleLoopButton.setBounds(row.removeFromLeft(row.getWidth() / 2).reduced(0, 1));
+        }
     }
     area.removeFromTop(16);
 
@@ -513,10 +527,10 @@ void TransportComponent::resized()
 }
 
 //==============================================================================
-// Timer (20 Hz)
+// Refresh (20 Hz)
 //==============================================================================
 
-void TransportComponent::timerCallback()
+void TransportComponent::uiRefresh()
 {
     updateDisplay();
     updateMetronomeButtonStates();
@@ -825,7 +839,7 @@ void TransportComponent::resetClicked()
         }
         else if (id == 2)
         {
-            for (int i = 0; i < 6; ++i)
+            for (int i = 0; i < audioEngine.getNumChannels(); ++i)
             {
                 for (int slot = 0; slot < 3; ++slot)
                     audioEngine.removePlugin(i, slot);
@@ -834,7 +848,7 @@ void TransportComponent::resetClicked()
         }
         else if (id == 3)
         {
-            for (int i = 0; i < 6; ++i)
+            for (int i = 0; i < audioEngine.getNumChannels(); ++i)
             {
                 auto* ch = audioEngine.getChannel(i);
                 if (ch)
@@ -948,18 +962,106 @@ void TransportComponent::masterRecordClicked()
     }
     else
     {
-        juce::File dir;
-        if (getMasterRecordPath)
+        if (!audioEngine.startMasterRecording(getRecordDirectory()))
+            DBG("Master recording failed to start");
+    }
+}
+
+juce::File TransportComponent::getRecordDirectory() const
+{
+    if (getMasterRecordPath)
+    {
+        auto customPath = getMasterRecordPath();
+        if (customPath.isNotEmpty())
+            return juce::File(customPath);
+    }
+    return SongManager::getCurrentSongDirectory();
+}
+
+namespace
+{
+    /** Runs AudioEngine::bounceOffline() behind a progress bar, reports and deletes itself. */
+    class BounceProgressWindow : public juce::ThreadWithProgressWindow
+    {
+    public:
+        BounceProgressWindow(AudioEngine& e, const BounceSettings& s)
+            : juce::ThreadWithProgressWindow("Bouncing song...", true, true, 60000)
+            , engine(e), settings(s)
         {
-            auto customPath = getMasterRecordPath();
-            if (customPath.isNotEmpty())
-                dir = juce::File(customPath);
         }
-        if (dir == juce::File())
-            dir = SongManager::getCurrentSongDirectory();
-        if (!audioEngine.startMasterRecording(dir))
-            DBG("Master recording failed to start");
+
+        void run() override
+        {
+            result = engine.bounceOffline(settings, [this](double p)
+            {
+                setProgress(p);
+                return !threadShouldExit();
+            });
+        }
+
+        void threadComplete(bool userPressedCancel) override
+        {
+            if (result.wasOk())
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Bounce",
+                                                       "Written to:\n" + engine.getBounceFile().getFullPathName());
+            else if (!userPressedCancel)
+                juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::WarningIcon, "Bounce failed",
+                                                       result.getErrorMessage());
+            delete this;
+        }
+
+    private:
+        AudioEngine&   engine;
+        BounceSettings settings;
+        juce::Result   result {juce::Result::ok()};
+    };
+}
+
+void TransportComponent::bounceClicked()
+{
+    if (audioEngine.isPlaying() || audioEngine.isMasterRecording())
+    {
+        juce::AlertWindow::showMessageBoxAsync(juce::MessageBoxIconType::InfoIcon, "Bounce",
+                                               "Stop the transport and the master recording first.");
+        return;
+    }
+
+    // Default: every section with a loop, once
+    juce::StringArray defaults;
+    for (int s = 0; s < NUM_SECTIONS; ++s)
+    {
+        const bool hasLoop = s == audioEngine.getActiveSection() ? audioEngine.getLoopEngine().getLoopLength() > 0
+                                                                 : audioEngine.getSectionLoopLength(s) > 0;
+        defaults.add(hasLoop ? "1" : "0");
     }
+
+    auto* dialog = new juce::AlertWindow("Bounce Song",
+                                         "Renders the sections back to back through all FX, "
+                                         "faster than real time.",
+                                         juce::MessageBoxIconType::NoIcon);
+    dialog->addTextEditor("loops", defaults.joinIntoString(", "), "Loops per section (A, B, C):");
+    dialog->addTextEditor("tail", "2", "Tail (seconds):");
+    dialog->addComboBox("output", { "Mixdown", "Mixdown + stems" }, "Output:");
+    dialog->addButton("Bounce", 1, juce::KeyPress(juce::KeyPress::returnKey));
+    dialog->addButton("Cancel", 0, juce::KeyPress(juce::KeyPress::escapeKey));
+
+    dialog->enterModalState(true, juce::ModalCallbackFunction::create([this, dialog](int button)
+    {
+        if (button != 1) return;
+
+        BounceSettings settings;
+        settings.directory   = getRecordDirectory();
+        settings.tailSeconds = juce::jlimit(0.0, 30.0, dialog->getTextEditorContents("tail").getDoubleValue());
+        settings.stems       = dialog->getComboBoxComponent("output")->getSelectedItemIndex() == 1;
+
+        const auto loops = juce::StringArray::fromTokens(dialog->getTextEditorContents("loops"), ", ", "");
+        int s = 0;
+        for (auto& t : loops)
+            if (t.isNotEmpty() && s < NUM_SECTIONS)
+                settings.loops[static_cast<size_t>(s++)] = juce::jlimit(0, 999, t.getIntValue());
+
+        (new BounceProgressWindow(audioEngine, settings))->launchThread();
+    }), true);
 }
 
 void TransportComponent::masterGainChanged()
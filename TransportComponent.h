@@ -5,6 +5,7 @@
 #include "SongManager.h"
 #include "ContextMenuControls.h"
 #include "CustomLookAndFeel.h"
+#include "UiRefreshClock.h"
 
 /**
  * @file TransportComponent.h
@@ -21,10 +22,10 @@
  *      damit metroOutputBox die tatsächliche Kanal-Anzahl kennt.
  */
 class TransportComponent : public juce::Component,
-                           private juce::Timer
+                           private UiRefreshClock::Client
 {
 public:
-    explicit TransportComponent(AudioEngine& engine);
+    TransportComponent(AudioEngine& engine, UiRefreshClock& refreshClock);
     ~TransportComponent() override;
 
     void paint(juce::Graphics& g) override;
@@ -43,6 +44,7 @@ public:
 
 private:
     AudioEngine& audioEngine;
+    UiRefreshClock& uiClock;
 
     struct SectionHeader { int y; int height; const char* label; };
     juce::Array<SectionHeader> sectionHeaders;
@@ -101,8 +103,9 @@ private:
     // Loop manipulation
     ContextMenuButton doubleLoopButton{"x2"};
 
-    // Master Recording
+    // Master Recording / offline bounce
     ContextMenuButton masterRecordButton {"Rec"};
+    juce::TextButton  bounceButton       {"Bounce"};
 
     // Reset
     juce::TextButton resetButton{"Reset"};
@@ -122,7 +125,7 @@ private:
     bool lastHasRecordings { false };
     std::vector<juce::int64> tapTimes;
 
-    void timerCallback() override;
+    void uiRefresh() override;
     void updateDisplay();
     void updateMetronomeButtonStates();
 
@@ -145,6 +148,8 @@ private:
     void fixedLenSliderChanged();
     void resetClicked();
     void masterRecordClicked();
+    void bounceClicked();
+    juce::File getRecordDirectory() const;
     void masterGainChanged();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TransportComponent)
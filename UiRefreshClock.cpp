@@ -0,0 +1,61 @@
+#include "UiRefreshClock.h"
+#include <algorithm>
+
+UiRefreshClock::UiRefreshClock(juce::Component& host)
+    : vblank(&host, [this] { onVBlank(); })
+{
+}
+
+void UiRefreshClock::addClient(Client& client, int rateHz)
+{
+    const double interval = 1000.0 / juce::jlimit(1, 240, rateHz);
+    const double now      = juce::Time::getMillisecondCounterHiRes();
+
+    for (auto& e : clients)
+    {
+        if (e.client == &client)
+        {
+            e.intervalMs = interval;
+            e.nextDueMs  = now;
+            return;
+        }
+    }
+    clients.push_back({ &client, interval, now });
+}
+
+void UiRefreshClock::removeClient(Client& client)
+{
+    for (auto& e : clients)
+        if (e.client == &client)
+            e.client = nullptr;
+
+    if (!ticking)
+        clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                     [](const Entry& e) { return e.client == nullptr; }),
+                      clients.end());
+}
+
+void UiRefreshClock::onVBlank()
+{
+    const double now = juce::Time::getMillisecondCounterHiRes();
+
+    ticking = true;
+    for (size_t i = 0; i < clients.size(); ++i)
+    {
+        auto& e = clients[i];
+        if (e.client == nullptr || now < e.nextDueMs)
+            continue;
+
+        // Stay on the grid; after a stall (window hidden) restart from now
+        e.nextDueMs += e.intervalMs;
+        if (e.nextDueMs <= now)
+            e.nextDueMs = now + e.intervalMs;
+
+        clients[i].client->uiRefresh();
+    }
+    ticking = false;
+
+    clients.erase(std::remove_if(clients.begin(), clients.end(),
+                                 [](const Entry& e) { return e.client == nullptr; }),
+                  clients.end());
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+//==============================================================================
+/**
+ * @file UiRefreshClock.h
+ * @brief One display-synced clock for all GUI polling
+ *
+ * Instead of one juce::Timer per channel strip, transport and info bar, every
+ * component that polls the engine registers here with the rate it needs.
+ * The clock is driven by the display's vertical blank of the host component's
+ * window (juce::VBlankAttachment), so all polling happens in one burst right
+ * before the frame is composed, and stops while the window has no peer.
+ *
+ * Clients are expected to compare against what they last showed and repaint
+ * only if something changed — the clock itself never repaints anything.
+ *
+ * Message thread only.
+ */
+class UiRefreshClock
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+        /** Called on the message thread at (at most) the registered rate. */
+        virtual void uiRefresh() = 0;
+    };
+
+    explicit UiRefreshClock(juce::Component& host);
+
+    /** Register (or re-register with a new rate). */
+    void addClient(Client& client, int rateHz);
+
+    /** Safe to call from inside uiRefresh(). */
+    void removeClient(Client& client);
+
+private:
+    struct Entry
+    {
+        Client* client;          // nullptr = removed during a tick
+        double  intervalMs;
+        double  nextDueMs;
+    };
+
+    std::vector<Entry> clients;
+    bool ticking {false};
+
+    juce::VBlankAttachment vblank;
+
+    void onVBlank();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(UiRefreshClock)
+};
@@ -48,8 +48,8 @@ static bool pluginCallProcessBlock (juce::AudioPluginInstance* p,
 #endif
 
 //==============================================================================
-VSTiChannel::VSTiChannel(int index)
-    : Channel(index, ChannelType::VSTi)
+VSTiChannel::VSTiChannel(int index, ChannelHotState& hot, int slot)
+    : Channel(index, ChannelType::VSTi, hot, slot)
 {
     // VSTi channels have no audio input
     routing.inputChannelLeft = -1;
@@ -60,70 +60,61 @@ VSTiChannel::VSTiChannel(int index)
 // VSTi Management
 //==============================================================================
 
-void VSTiChannel::setVSTi(std::unique_ptr<juce::AudioPluginInstance> instrument)
+std::unique_ptr<juce::AudioPluginInstance> VSTiChannel::setVSTi(std::unique_ptr<juce::AudioPluginInstance> instrument)
 {
-    // Block audio thread from accessing vsti during the swap.
-    vstiCrashed.store(true, std::memory_order_release);
-
-    // Wait long enough for the audio thread to finish any in-flight processBlock().
-    // Use the actual block duration rather than a hardcoded 10 ms, which can be
-    // shorter than one block at small buffer sizes (e.g. 512 @ 44100 Hz = ~11.6 ms).
-    const int blockMs = (sampleRate > 0.0 && maxBlockSize > 0)
-                      ? static_cast<int>(maxBlockSize * 1000.0 / sampleRate) + 5
-                      : 20;
-    juce::Thread::sleep(blockMs);
-
-    // Release old VSTi if present.
-    if (vsti)
-        vsti->releaseResources();
-
-    // Install new VSTi.
-    vsti = std::move(instrument);
-
-    // Prepare the new plugin BEFORE clearing vstiCrashed.  The audio thread stays
-    // blocked (vstiCrashed == true) until prepareToPlay() completes, so it can
-    // never call processBlock() on an uninitialised plugin.
-    if (vsti)
+    // Prepare the new plugin while the audio thread cannot see it yet, so it
+    // never calls processBlock() on an uninitialised plugin.
+    if (instrument && !pluginCallPrepareToPlay (instrument.get(), sampleRate, maxBlockSize))
     {
-        if (pluginCallPrepareToPlay (vsti.get(), sampleRate, maxBlockSize))
-        {
-            // Resize output buffer to the plugin's actual channel count while
-            // the audio thread is still blocked (vstiCrashed == true).
-            const int numOut = juce::jmax(2, vsti->getTotalNumOutputChannels());
-            vstiOutputBuffer.setSize(numOut, maxBlockSize * 2, false, true, false);
+        DBG("VSTi crashed during prepareToPlay() on channel " +
+            juce::String(channelIndex));
+        instrument.reset();   // don't expose a broken plugin to the audio thread
+    }
 
-            DBG("VSTi loaded on channel " + juce::String(channelIndex) +
-                ": " + vsti->getName() + " (" + juce::String(numOut) + " out ch)");
-        }
-        else
-        {
-            DBG("VSTi crashed during prepareToPlay() on channel " +
-                juce::String(channelIndex));
-            vsti.reset();   // don't expose a broken plugin to the audio thread
-        }
+    // The output buffer must have one channel per plugin output.  A wider one
+    // is built aside and published before the instrument: the audio thread
+    // loads the instrument first, so it never pairs it with a narrower buffer.
+    // The old buffer may still be in the running block — retired, not resized.
+    const int numOut = instrument ? juce::jmax(2, instrument->getTotalNumOutputChannels()) : 2;
+    if (numOut > vstiOutputBuffer->getNumChannels())
+    {
+        auto wider = std::make_unique<juce::AudioBuffer<float>>(numOut, maxBlockSize * 2);
+        wider->clear();
+        activeOutput.store(wider.get(), std::memory_order_release);
+        std::swap(vstiOutputBuffer, wider);
+        if (reclaimer != nullptr)
+            reclaimer->retire(std::move(wider));
     }
 
+    // Keep the old VSTi for the caller (it decides whether to release or reuse it).
+    auto previous = std::move(vsti);
+    vsti = std::move(instrument);
+
     vstiCrashed.store(false, std::memory_order_release);
+    vstiTailSamples.store(vsti ? pluginTailSamples(*vsti, sampleRate) : 0, std::memory_order_relaxed);
+    vstiWakeRequested.store(true, std::memory_order_release);
+    activeVSTi.store(vsti.get(), std::memory_order_release);
+
+    if (vsti)
+        DBG("VSTi loaded on channel " + juce::String(channelIndex) +
+            ": " + vsti->getName() + " (" + juce::String(numOut) + " out ch)");
+
+    return previous;
 }
 
-void VSTiChannel::removeVSTi()
+std::unique_ptr<juce::AudioPluginInstance> VSTiChannel::detachVSTi()
 {
-    if (!vsti) return;
-    vstiCrashed.store(true, std::memory_order_release);
-    const int blockMs = (sampleRate > 0.0 && maxBlockSize > 0)
-                      ? static_cast<int>(maxBlockSize * 1000.0 / sampleRate) + 5
-                      : 20;
-    juce::Thread::sleep(blockMs);
-    vsti->releaseResources();
-    vsti.reset();
+    if (!vsti) return nullptr;
+    activeVSTi.store(nullptr, std::memory_order_release);
+    auto instrument = std::move(vsti);
     vstiCrashed.store(false, std::memory_order_release);
-    DBG("VSTi removed from channel " + juce::String(channelIndex));
+    return instrument;
 }
 
 void VSTiChannel::setMIDIChannelFilter(int channel)
 {
     jassert(channel >= 0 && channel <= 16);
-    routing.midiChannelFilter = channel;
+    routing.midiChannelFilter = juce::jlimit(0, 16, channel);
 }
 
 //==============================================================================
@@ -155,8 +146,14 @@ void VSTiChannel::prepareToPlay(double newSampleRate,
     const int numVstiOut = (vsti && !vstiCrashed.load(std::memory_order_relaxed))
                          ? juce::jmax(2, vsti->getTotalNumOutputChannels())
                          : 2;
-    vstiOutputBuffer.setSize(numVstiOut, maxBlockSize * 2, false, true, true);
-    vstiOutputBuffer.clear();
+    // Device stopped: nothing reads the buffer, so it is resized in place
+    vstiOutputBuffer->setSize(numVstiOut, maxBlockSize * 2, false, true, true);
+    vstiOutputBuffer->clear();
+
+    instrumentIdle.wake();
+    vstiTailSamples.store((vsti && !vstiCrashed.load(std::memory_order_relaxed))
+                              ? pluginTailSamples(*vsti, newSampleRate) : 0,
+                          std::memory_order_relaxed);
 }
 
 void VSTiChannel::releaseResources()
@@ -177,7 +174,7 @@ void VSTiChannel::releaseResources()
     }
     
     // Clear VSTi buffers
-    vstiOutputBuffer.setSize(0, 0);
+    vstiOutputBuffer->setSize(0, 0);
     
     // Call base class cleanup
     Channel::releaseResources();
@@ -189,21 +186,26 @@ void VSTiChannel::releaseResources()
 
 void VSTiChannel::processBlock(const float* const* inputChannelData,
                                float* const* outputChannelData,
-                               const juce::MidiBuffer& midiBuffer,
+                               juce::MidiBuffer& midiBuffer,
                                int numSamples,
                                juce::int64 playheadPosition,
                                juce::int64 loopLength,
                                int numInputChannels,
                                int numOutputChannels)
 {
+    beginGainBlock(numSamples);
     checkAndExecutePendingStop(playheadPosition, loopLength, numSamples);
+    applyPendingConsolidation(playheadPosition, loopLength, numSamples);
     checkOneShotStop(playheadPosition, loopLength, numSamples);
 
+    // Instrument before buffer: a published instrument implies its output buffer
+    auto* instrument = activeVSTi.load(std::memory_order_acquire);
+    auto& vstiOutput = *activeOutput.load(std::memory_order_acquire);
+
     // Clear all working buffers
     workingBuffer.clear(0, numSamples);
-    vstiOutputBuffer.clear(0, numSamples);
+    vstiOutput.clear(0, numSamples);
     fxBuffer.clear(0, numSamples);
-    filteredMidiBuffer.clear();
 
     // Check if muted (user mute OR silenced by another channel's solo)
     const bool isMutedNow = muted.load(std::memory_order_relaxed)
@@ -211,85 +213,106 @@ void VSTiChannel::processBlock(const float* const* inputChannelData,
     const ChannelState currentState = state.load(std::memory_order_relaxed);
 
     //==========================================================================
-    // 1. FILTER MIDI BY CHANNEL (if configured)
+    // 1. MIDI — already filtered by channel: the engine demultiplexes incoming
+    //    MIDI once per block using each channel's midiChannelFilter
     //==========================================================================
-    const int midiFilter = routing.midiChannelFilter;
-    filterMIDI(midiBuffer, filteredMidiBuffer, midiFilter);
 
     //==========================================================================
     // 2. PROCESS VSTi → vstiOutputBuffer (dry instrument signal)
+    //    Skipped while the instrument is silent and no MIDI arrives; any event wakes it.
     //==========================================================================
-    processVSTi(vstiOutputBuffer, filteredMidiBuffer, numSamples);
+    if (!midiBuffer.isEmpty()
+        || (vstiWakeRequested.load(std::memory_order_relaxed)
+            && vstiWakeRequested.exchange(false, std::memory_order_acq_rel)))
+        instrumentIdle.wake();
+
+    if (!instrumentIdle.asleep)
+    {
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelInput));
+        processVSTi(instrument, vstiOutput, midiBuffer, numSamples);
+    }
 
     // Copy dry VSTi output to workingBuffer (allocation-free, audio-thread safe)
     const int chsToCopy = juce::jmin(workingBuffer.getNumChannels(),
-                                     vstiOutputBuffer.getNumChannels());
+                                     vstiOutput.getNumChannels());
     for (int ch = 0; ch < chsToCopy; ++ch)
-        workingBuffer.copyFrom(ch, 0, vstiOutputBuffer, ch, 0, numSamples);
+        workingBuffer.copyFrom(ch, 0, vstiOutput, ch, 0, numSamples);
 
-    // Compute input peaks (VSTi output = "input" for this channel)
-    {
-        auto rangeL = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(0), numSamples);
-        auto rangeR = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(1), numSamples);
-        inputPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-        inputPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
-    }
+    // Compute input levels (VSTi output = "input" for this channel)
+    meterInput(numSamples);
+
+    if (!instrumentIdle.asleep)
+        instrumentIdle.update(juce::jmax(inputPeakL.load(std::memory_order_relaxed),
+                                         inputPeakR.load(std::memory_order_relaxed)),
+                              numSamples,
+                              idleDelaySamples(vstiTailSamples.load(std::memory_order_relaxed)));
 
     //==========================================================================
     // 3. RECORD DRY SIGNAL (before FX — loop always stores clean audio)
     //==========================================================================
     if (currentState == ChannelState::Recording)
-        recordToLoop(workingBuffer, playheadPosition, numSamples, false);
+    {
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelRecord));
+        recordToLoop(workingBuffer, recordPosition(playheadPosition, loopLength), numSamples, false, loopLength);
+    }
     else if (currentState == ChannelState::Overdubbing && loopLength > 0)
-        recordToLoop(workingBuffer, playheadPosition, numSamples, true);
+    {
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelRecord));
+        recordToLoop(workingBuffer, recordPosition(playheadPosition, loopLength), numSamples, true, loopLength);
+    }
 
     //==========================================================================
     // 4. BUILD OUTPUT MIX IN fxBuffer
     //    Monitoring: add dry VSTi; Playback: add loop signal with gain.
     //    Both paths are combined before FX so the chain runs exactly once.
     //==========================================================================
+    float mixPeak = 0.0f;
     if (shouldMonitor())
     {
         for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
             fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
+        mixPeak = juce::jmax(inputPeakL.load(std::memory_order_relaxed),
+                             inputPeakR.load(std::memory_order_relaxed));
     }
 
     if ((currentState == ChannelState::Playing ||
          currentState == ChannelState::Overdubbing) &&
         loopLength > 0)
     {
-        // Reuse workingBuffer as a temporary read target for the loop
-        workingBuffer.clear(0, numSamples);
-        playFromLoop(workingBuffer, playheadPosition, numSamples);
-        applyGain(workingBuffer, numSamples);
-
-        // Compute loop peaks
-        {
-            auto rangeL = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(0), numSamples);
-            auto rangeR = juce::FloatVectorOperations::findMinAndMax(workingBuffer.getReadPointer(1), numSamples);
-            loopPeakL.store(juce::jmax(std::abs(rangeL.getStart()), std::abs(rangeL.getEnd())), std::memory_order_relaxed);
-            loopPeakR.store(juce::jmax(std::abs(rangeR.getStart()), std::abs(rangeR.getEnd())), std::memory_order_relaxed);
-        }
+        // Reuse workingBuffer as the loop read target — layers, gain and peaks in one pass
+        RealtimeProfiler::Scope timing(profiler, profileStage(RealtimeProfiler::ChannelPlayback));
+        float peakL = 0.0f, peakR = 0.0f;
+        playFromLoopSmoothed(workingBuffer, playheadPosition, numSamples, peakL, peakR);
+        meterLoop(workingBuffer, numSamples, peakL, peakR);
+        mixPeak = juce::jmax(mixPeak, peakL, peakR);
 
         for (int ch = 0; ch < fxBuffer.getNumChannels(); ++ch)
             fxBuffer.addFrom(ch, 0, workingBuffer, ch, 0, numSamples);
     }
     else
     {
-        loopPeakL.store(0.0f, std::memory_order_relaxed);
-        loopPeakR.store(0.0f, std::memory_order_relaxed);
+        meterLoopSilent();
     }
+    publishMeters(playheadPosition, numSamples);
 
     //==========================================================================
     // 5. PROCESS FX CHAIN (applied once to combined output signal)
+    //    Skipped with the output routing once the channel has gone quiet.
     //==========================================================================
-    juce::MidiBuffer emptyMidi;
-    processFXChain(fxBuffer, numSamples, emptyMidi);
+    tapStem(false, numSamples);
+    if (isFxChainIdle(mixPeak, currentState))
+        return;
+
+    fxMidiBuffer.clear();
+    processFXChain(fxBuffer, numSamples, fxMidiBuffer);
+    compensateLatency(numSamples);
+    trackFxOutput(numSamples);
+    tapStem(true, numSamples);
 
     //==========================================================================
     // 6. ROUTE TO OUTPUT
     //==========================================================================
-    if (!isMutedNow)
+    if (applyMuteFade(fxBuffer, numSamples, isMutedNow))
         routeOutput(outputChannelData, fxBuffer, numOutputChannels, numSamples);
 }
 
@@ -297,42 +320,10 @@ void VSTiChannel::processBlock(const float* const* inputChannelData,
 // Private Processing Stages
 //==============================================================================
 
-void VSTiChannel::filterMIDI(const juce::MidiBuffer& source,
-                            juce::MidiBuffer& dest,
-                            int filterChannel)
-{
-    dest.clear();
-    
-    // filterChannel: 0 = all channels, 1-16 = specific MIDI channel
-    if (filterChannel == 0)
-    {
-        // No filtering - copy all events
-        dest = source;
-        return;
-    }
-    
-    // Filter by MIDI channel
-    // Note: juce::MidiMessage::getChannel() returns 1-16 (not 0-15)
-    for (const auto metadata : source)
-    {
-        const juce::MidiMessage& msg = metadata.getMessage();
-        
-        // Pass through non-channel messages (SysEx, etc.)
-        if (msg.getChannel() == 0)
-        {
-            dest.addEvent(msg, metadata.samplePosition);
-        }
-        // Filter by specific channel
-        else if (msg.getChannel() == filterChannel)
-        {
-            dest.addEvent(msg, metadata.samplePosition);
-        }
-    }
-}
-
-void VSTiChannel::processVSTi(juce::AudioBuffer<float>& outputBuffer,
-                             juce::MidiBuffer& midiBuffer,
-                             int numSamples)
+void VSTiChannel::processVSTi(juce::AudioPluginInstance* instrument,
+                              juce::AudioBuffer<float>& outputBuffer,
+                              juce::MidiBuffer& midiBuffer,
+                              int numSamples)
 {
     // Check buffer size
     if (outputBuffer.getNumSamples() < numSamples)
@@ -345,7 +336,7 @@ void VSTiChannel::processVSTi(juce::AudioBuffer<float>& outputBuffer,
     outputBuffer.clear(0, numSamples);
     
     // Skip if no VSTi loaded
-    if (!vsti)
+    if (instrument == nullptr)
         return;
     
     // Skip if VSTi has crashed
@@ -355,11 +346,14 @@ void VSTiChannel::processVSTi(juce::AudioBuffer<float>& outputBuffer,
     // Process VSTi with crash protection (SEH on Windows, C++ catch elsewhere).
     // Pass a non-owning view of exactly numSamples so the plugin advances its
     // internal state by exactly one real block, not by the over-allocated size.
+    // The buffer may be wider than this plugin needs (never shrunk on a swap).
     {
+        const int numChannels = juce::jmin(outputBuffer.getNumChannels(),
+                                           juce::jmax(2, instrument->getTotalNumOutputChannels()));
         juce::AudioBuffer<float> view (outputBuffer.getArrayOfWritePointers(),
-                                       outputBuffer.getNumChannels(),
+                                       numChannels,
                                        numSamples);
-        if (!pluginCallProcessBlock (vsti.get(), view, midiBuffer))
+        if (!pluginCallProcessBlock (instrument, view, midiBuffer))
         {
             vstiCrashed.store (true, std::memory_order_release);
             outputBuffer.clear (0, numSamples);
@@ -406,20 +400,3 @@ void VSTiChannel::routeOutput(float* const* outputChannelData,
                                          numSamples);
     }
 }
-
-void VSTiChannel::applyGain(juce::AudioBuffer<float>& buffer, int numSamples)
-{
-    const float gain = gainLinear.load(std::memory_order_relaxed);
-    
-    if (gain == 0.0f)
-    {
-        buffer.clear(0, numSamples);
-        return;
-    }
-    
-    if (gain == 1.0f)
-        return;  // Unity gain, no processing needed
-    
-    // Apply gain to both channels
-    buffer.applyGain(0, numSamples, gain);
-}
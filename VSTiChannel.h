@@ -32,8 +32,9 @@ public:
     /**
      * @brief Construct VSTi channel
      * @param channelIndex Channel number (0-5)
+     * @param hotSlot Slot of hotState this channel binds
      */
-    explicit VSTiChannel(int channelIndex);
+    VSTiChannel(int channelIndex, ChannelHotState& hotState, int hotSlot);
     
     ~VSTiChannel() override = default;
     
@@ -43,14 +44,24 @@ public:
     
     /**
      * @brief Set the virtual instrument plugin
+     *
+     * The new instrument is prepared before the audio thread can see it, so the
+     * swap does not wait.  A wider output buffer, if it needs one, is published
+     * alongside it and the old buffer is retired through EpochReclaimer.
+     *
      * @param instrument Plugin instance (takes ownership)
+     * @return The instrument it replaced, still prepared (for reuse).  It may
+     *         still be in the current audio block — retire it through
+     *         EpochReclaimer before touching it.
      */
-    void setVSTi(std::unique_ptr<juce::AudioPluginInstance> instrument);
+    std::unique_ptr<juce::AudioPluginInstance> setVSTi(std::unique_ptr<juce::AudioPluginInstance> instrument);
     
     /**
-     * @brief Remove the virtual instrument
+     * @brief Take the instrument out without releasing it (for reuse)
+     *
+     * Same rules as the instance returned by setVSTi().
      */
-    void removeVSTi();
+    std::unique_ptr<juce::AudioPluginInstance> detachVSTi();
     
     /**
      * @brief Get the VSTi plugin instance
@@ -88,7 +99,7 @@ public:
      * @brief Process one audio block
      * 
      * Processing steps:
-     * 1. Filter MIDI by channel (if configured)
+     * 1. MIDI arrives filtered by channel (engine demultiplexes per block)
      * 2. Process VSTi with MIDI
      * 3. Process FX chain
      * 4. Live monitoring (always for VSTi)
@@ -99,7 +110,7 @@ public:
      */
     void processBlock(const float* const* inputChannelData,
                      float* const* outputChannelData,
-                     const juce::MidiBuffer& midiBuffer,
+                     juce::MidiBuffer& midiBuffer,
                      int numSamples,
                      juce::int64 playheadPosition,
                      juce::int64 loopLength,
@@ -121,35 +132,34 @@ public:
 private:
     //==============================================================================
     // VSTi instance
-    std::unique_ptr<juce::AudioPluginInstance> vsti;
+    std::unique_ptr<juce::AudioPluginInstance> vsti;                   // owner, message thread
+    std::atomic<juce::AudioPluginInstance*>    activeVSTi {nullptr};   // what the audio thread processes
     std::atomic<bool> vstiCrashed{false};
+
+    // Instrument idle detection: a silent instrument without incoming MIDI is
+    // not called once its tail has died away (see SilenceTracker)
+    SilenceTracker    instrumentIdle;
+    std::atomic<int>  vstiTailSamples     {0};       // -1 = infinite
+    std::atomic<bool> vstiWakeRequested   {false};   // instrument swapped on the message thread
     
-    // Working buffers
-    juce::AudioBuffer<float> vstiOutputBuffer;
-    juce::MidiBuffer filteredMidiBuffer;
+    // Working buffers: the owner (message thread) and what the audio thread writes
+    std::unique_ptr<juce::AudioBuffer<float>> vstiOutputBuffer {std::make_unique<juce::AudioBuffer<float>>()};
+    std::atomic<juce::AudioBuffer<float>*>    activeOutput {vstiOutputBuffer.get()};
     
     //==============================================================================
     // Private Processing Stages
     
-    /**
-     * @brief Filter MIDI events by channel
-     * @param source Input MIDI buffer
-     * @param dest Output MIDI buffer (filtered)
-     * @param filterChannel 0 = all, 1-16 = specific channel
-     */
-    void filterMIDI(const juce::MidiBuffer& source,
-                   juce::MidiBuffer& dest,
-                   int filterChannel);
-    
     /**
      * @brief Process VSTi with MIDI input
+     * @param instrument The published instrument, loaded once per block (may be null)
      * @param outputBuffer Buffer to fill with VSTi output
      * @param midiBuffer MIDI events to send to VSTi
      * @param numSamples Number of samples to process
      */
-    void processVSTi(juce::AudioBuffer<float>& outputBuffer,
-                    juce::MidiBuffer& midiBuffer,
-                    int numSamples);
+    void processVSTi(juce::AudioPluginInstance* instrument,
+                     juce::AudioBuffer<float>& outputBuffer,
+                     juce::MidiBuffer& midiBuffer,
+                     int numSamples);
     
     /**
      * @brief Mix processed audio to hardware output
@@ -159,10 +169,5 @@ private:
                     int numOutputChannels,
                     int numSamples);
     
-    /**
-     * @brief Apply channel gain to buffer
-     */
-    void applyGain(juce::AudioBuffer<float>& buffer, int numSamples);
-    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(VSTiChannel)
 };
@@ -0,0 +1,220 @@
+#include "WaveformOverview.h"
+#include "LoopPagePool.h"
+
+namespace
+{
+    constexpr juce::uint32 kFileMagic   = 0x4b504c43;   // "CLPK"
+    constexpr int          kFileVersion = 1;
+}
+
+//==============================================================================
+void WaveformOverview::clear()
+{
+    length = 0;
+    levels.clear();
+}
+
+void WaveformOverview::ensureLength(juce::int64 numSamples)
+{
+    if (numSamples > length)
+        resizeLevels(numSamples);
+}
+
+void WaveformOverview::resizeLevels(juce::int64 numSamples)
+{
+    length = numSamples;
+
+    size_t bins = static_cast<size_t>((numSamples + kBaseBin - 1) / kBaseBin);
+    size_t level = 0;
+    for (;;)
+    {
+        if (levels.size() <= level)
+            levels.emplace_back();
+        levels[level].resize(bins);   // keeps existing bins, new ones silent
+
+        if (bins <= 1) break;
+        bins = (bins + 1) / 2;
+        ++level;
+    }
+    levels.resize(level + 1);
+}
+
+void WaveformOverview::propagate(size_t firstBin, size_t lastBin)
+{
+    for (size_t l = 1; l < levels.size(); ++l)
+    {
+        firstBin /= 2;
+        lastBin  /= 2;
+
+        const auto& below = levels[l - 1];
+        auto&       here  = levels[l];
+        for (size_t b = firstBin; b <= lastBin && b < here.size(); ++b)
+        {
+            Bin out = below[2 * b];
+            if (2 * b + 1 < below.size())
+            {
+                out.lo = juce::jmin(out.lo, below[2 * b + 1].lo);
+                out.hi = juce::jmax(out.hi, below[2 * b + 1].hi);
+            }
+            here[b] = out;
+        }
+    }
+}
+
+//==============================================================================
+void WaveformOverview::update(const PagedLoopBuffer& buf, juce::int64 start, juce::int64 num)
+{
+    if (num <= 0 || start < 0) return;
+    ensureLength(start + num);
+
+    // Whole bins only: widen to bin edges and rescan them from the buffer
+    const size_t first = static_cast<size_t>(start / kBaseBin);
+    const size_t last  = static_cast<size_t>((start + num - 1) / kBaseBin);
+    const juce::int64 end = juce::jmin(length, buf.getCapacity());
+
+    auto& base = levels[0];
+    for (size_t b = first; b <= last; ++b)
+    {
+        Bin bin;
+        juce::int64 pos = static_cast<juce::int64>(b) * kBaseBin;
+        const juce::int64 binEnd = juce::jmin(pos + kBaseBin, end);
+
+        while (pos < binEnd)
+        {
+            int avail = 0;
+            const float* l = buf.getReadSpan(0, pos, avail);
+            const int n = static_cast<int>(juce::jmin<juce::int64>(avail, binEnd - pos));
+            if (n <= 0) break;
+
+            if (l != nullptr)   // unmapped = silence
+            {
+                int unused = 0;
+                const float* r = buf.getReadSpan(1, pos, unused);
+                const auto rl = juce::FloatVectorOperations::findMinAndMax(l, n);
+                const auto rr = juce::FloatVectorOperations::findMinAndMax(r, n);
+                bin.lo = juce::jmin(bin.lo, rl.getStart(), rr.getStart());
+                bin.hi = juce::jmax(bin.hi, rl.getEnd(),   rr.getEnd());
+            }
+            pos += n;
+        }
+        base[b] = bin;
+    }
+
+    propagate(first, last);
+}
+
+void WaveformOverview::beginBuild(juce::int64 numSamples)
+{
+    clear();
+    if (numSamples > 0)
+        resizeLevels(numSamples);
+}
+
+void WaveformOverview::addChunk(const juce::AudioBuffer<float>& chunk, juce::int64 pos, int numSamples)
+{
+    if (levels.empty() || pos < 0) return;
+    numSamples = static_cast<int>(juce::jmin<juce::int64>(numSamples, length - pos));
+
+    // A chunk edge may split a bin: fold into what the previous chunk left there
+    auto& base = levels[0];
+    for (int i = 0; i < numSamples;)
+    {
+        const auto b = static_cast<size_t>((pos + i) / kBaseBin);
+        const int  n = static_cast<int>(juce::jmin<juce::int64>(numSamples - i,
+                                            static_cast<juce::int64>(b + 1) * kBaseBin - (pos + i)));
+        auto& bin = base[b];
+        for (int ch = 0; ch < chunk.getNumChannels(); ++ch)
+        {
+            const auto r = juce::FloatVectorOperations::findMinAndMax(chunk.getReadPointer(ch, i), n);
+            bin.lo = juce::jmin(bin.lo, r.getStart());
+            bin.hi = juce::jmax(bin.hi, r.getEnd());
+        }
+        i += n;
+    }
+}
+
+void WaveformOverview::endBuild()
+{
+    if (!levels.empty())
+        propagate(0, levels[0].size() - 1);
+}
+
+//==============================================================================
+juce::Range<float> WaveformOverview::getRange(juce::int64 start, juce::int64 end) const
+{
+    start = juce::jmax<juce::int64>(0, start);
+    end   = juce::jmin(end, length);
+    if (levels.empty() || end <= start) return {};
+
+    // Coarsest level whose bins are no wider than the span
+    size_t l = 0;
+    while (l + 1 < levels.size()
+           && (static_cast<juce::int64>(kBaseBin) << (l + 1)) <= end - start)
+        ++l;
+
+    const juce::int64 binSize = static_cast<juce::int64>(kBaseBin) << l;
+    const auto& bins = levels[l];
+    const size_t first = static_cast<size_t>(start / binSize);
+    const size_t last  = juce::jmin(bins.size() - 1, static_cast<size_t>((end - 1) / binSize));
+
+    float lo = 0.0f, hi = 0.0f;
+    for (size_t b = first; b <= last; ++b)
+    {
+        lo = juce::jmin(lo, bins[b].lo);
+        hi = juce::jmax(hi, bins[b].hi);
+    }
+    return { lo, hi };
+}
+
+//==============================================================================
+bool WaveformOverview::writeTo(const juce::File& file) const
+{
+    if (levels.empty()) return false;
+
+    const juce::File tmp = file.getSiblingFile(file.getFileName() + ".tmp");
+    {
+        juce::FileOutputStream out(tmp);
+        if (!out.openedOk()) return false;
+        out.setPosition(0);
+        out.truncate();
+
+        out.writeInt(static_cast<int>(kFileMagic));
+        out.writeInt(kFileVersion);
+        out.writeInt(kBaseBin);
+        out.writeInt64(length);
+        for (const auto& bin : levels[0])
+        {
+            out.writeFloat(bin.lo);
+            out.writeFloat(bin.hi);
+        }
+        out.flush();
+        if (out.getStatus().failed()) return false;
+    }
+    return tmp.moveFileTo(file);
+}
+
+bool WaveformOverview::readFrom(const juce::File& file)
+{
+    juce::FileInputStream in(file);
+    if (!in.openedOk()) return false;
+
+    if (static_cast<juce::uint32>(in.readInt()) != kFileMagic
+        || in.readInt() != kFileVersion
+        || in.readInt() != kBaseBin)
+        return false;
+
+    const juce::int64 len = in.readInt64();
+    const juce::int64 numBins = (len + kBaseBin - 1) / kBaseBin;
+    if (len <= 0 || in.getNumBytesRemaining() < numBins * 2 * static_cast<juce::int64>(sizeof(float)))
+        return false;
+
+    clear();
+    resizeLevels(len);
+    for (auto& bin : levels[0])
+    {
+        bin.lo = in.readFloat();
+        bin.hi = in.readFloat();
+    }
+    propagate(0, levels[0].size() - 1);
+    return true;
+}
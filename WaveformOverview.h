@@ -0,0 +1,64 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+class PagedLoopBuffer;
+
+//==============================================================================
+/**
+ * @file WaveformOverview.h
+ * @brief Min/max pyramid of one loop buffer for drawing waveforms
+ *
+ * Level 0 holds one min/max pair (both channels folded) per kBaseBin samples;
+ * every level above halves the resolution.  A query for a pixel column picks
+ * the coarsest level whose bins still fit inside the column, so drawing costs
+ * O(pixels) whatever the loop length.
+ *
+ * update() rescans only the written range and the parent bins above it —
+ * the channel feeds it the ranges recordToLoop() touched.  The pyramid can be
+ * saved next to a song's WAV and loaded instead of rescanning the audio.
+ *
+ * Not thread-safe; Channel guards its overviews with a lock.
+ */
+class WaveformOverview
+{
+public:
+    static constexpr int kBaseBin = 256;   // samples per level-0 bin
+
+    /** Drop all bins. */
+    void clear();
+
+    /** Samples covered (bins past the end read as silence). */
+    juce::int64 getLength() const { return length; }
+
+    /** Grow (never shrink) the covered length; new bins are silent. */
+    void ensureLength(juce::int64 numSamples);
+
+    /** Rescan [start, start + num) of buf (no wrap) and the parents above it. */
+    void update(const PagedLoopBuffer& buf, juce::int64 start, juce::int64 num);
+
+    /**
+     * Rebuild chunk by chunk (save path): beginBuild(), then addChunk() for
+     * consecutive ranges in any chunk size, then endBuild() fills the levels above.
+     */
+    void beginBuild(juce::int64 numSamples);
+    void addChunk(const juce::AudioBuffer<float>& chunk, juce::int64 pos, int numSamples);
+    void endBuild();
+
+    /** Min and max over [start, end); empty range (0, 0) past the end. */
+    juce::Range<float> getRange(juce::int64 start, juce::int64 end) const;
+
+    /** Binary file: level 0 only, the rest is rebuilt on load. */
+    bool writeTo(const juce::File& file) const;
+    bool readFrom(const juce::File& file);
+
+private:
+    struct Bin { float lo {0.0f}, hi {0.0f}; };
+
+    juce::int64 length {0};
+    std::vector<std::vector<Bin>> levels;   // [0] = finest
+
+    void resizeLevels(juce::int64 numSamples);
+    void propagate(size_t firstBin, size_t lastBin);   // level-0 bin range, inclusive
+};